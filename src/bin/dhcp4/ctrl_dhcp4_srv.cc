@@ -19,6 +19,7 @@
 #include <hooks/hooks_manager.h>
 #include <dhcp4/json_config_parser.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/stats_mgr.h>
 
 using namespace isc::data;
 using namespace isc::hooks;
@@ -67,6 +68,61 @@ ControlledDhcpv4Srv::commandConfigReloadHandler(const string&,
     return (processConfig(args));
 }
 
+ConstElementPtr
+ControlledDhcpv4Srv::commandStatisticGetHandler(const string&,
+                                                ConstElementPtr args) {
+    return (isc::config::createAnswer(0, StatsMgr::instance().
+                                      get(getStatisticName(args))));
+}
+
+ConstElementPtr
+ControlledDhcpv4Srv::commandStatisticGetAllHandler(const string&,
+                                                   ConstElementPtr) {
+    return (isc::config::createAnswer(0, StatsMgr::instance().getAll()));
+}
+
+ConstElementPtr
+ControlledDhcpv4Srv::commandStatisticResetHandler(const string&,
+                                                  ConstElementPtr args) {
+    const string name = getStatisticName(args);
+    if (!StatsMgr::instance().reset(name)) {
+        return (isc::config::createAnswer(1, "No '" + name +
+                                          "' statistic found."));
+    }
+    return (isc::config::createAnswer(0, "Statistic '" + name +
+                                      "' reset."));
+}
+
+ConstElementPtr
+ControlledDhcpv4Srv::commandStatisticResetAllHandler(const string&,
+                                                     ConstElementPtr) {
+    StatsMgr::instance().resetAll();
+    return (isc::config::createAnswer(0, "All statistics reset."));
+}
+
+string
+ControlledDhcpv4Srv::getStatisticName(ConstElementPtr args) {
+    if (!args || (args->getType() != Element::map)) {
+        isc_throw(BadValue, "arguments must be a map");
+    }
+    ConstElementPtr name = args->get("name");
+    if (!name || (name->getType() != Element::string)) {
+        isc_throw(BadValue, "'name' parameter must be a string");
+    }
+    return (name->stringValue());
+}
+
+ConstElementPtr
+ControlledDhcpv4Srv::commandLatencyGetHandler(const string&, ConstElementPtr) {
+    return (isc::config::createAnswer(0, getLatencyStats().toElement()));
+}
+
+ConstElementPtr
+ControlledDhcpv4Srv::commandLatencyResetHandler(const string&, ConstElementPtr) {
+    getLatencyStats().reset();
+    return (isc::config::createAnswer(0, "Latency histograms reset."));
+}
+
 ConstElementPtr
 ControlledDhcpv4Srv::processCommand(const string& command,
                                     ConstElementPtr args) {
@@ -92,6 +148,24 @@ ControlledDhcpv4Srv::processCommand(const string& command,
         } else if (command == "config-reload") {
             return (srv->commandConfigReloadHandler(command, args));
 
+        } else if (command == "statistic-get") {
+            return (srv->commandStatisticGetHandler(command, args));
+
+        } else if (command == "statistic-get-all") {
+            return (srv->commandStatisticGetAllHandler(command, args));
+
+        } else if (command == "statistic-reset") {
+            return (srv->commandStatisticResetHandler(command, args));
+
+        } else if (command == "statistic-reset-all") {
+            return (srv->commandStatisticResetAllHandler(command, args));
+
+        } else if (command == "latency-get") {
+            return (srv->commandLatencyGetHandler(command, args));
+
+        } else if (command == "latency-reset") {
+            return (srv->commandLatencyResetHandler(command, args));
+
         }
         ConstElementPtr answer = isc::config::createAnswer(1,
                                  "Unrecognized command:" + command);
@@ -119,6 +193,11 @@ ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config) {
         return (isc::config::createAnswer(1, err.str()));
     }
 
+    // The worker threads use the current configuration and the lease
+    // database, so let them finish processing queued packets before
+    // these are replaced.
+    srv->thread_pool_.wait();
+
     ConstElementPtr answer = configureDhcp4Server(*srv, config);
 
 
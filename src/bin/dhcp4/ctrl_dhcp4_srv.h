@@ -80,6 +80,12 @@ public:
     /// - shutdown
     /// - libreload
     /// - config-reload
+    /// - statistic-get
+    /// - statistic-get-all
+    /// - statistic-reset
+    /// - statistic-reset-all
+    /// - latency-get
+    /// - latency-reset
     ///
     /// @note It never throws.
     ///
@@ -129,9 +135,6 @@ protected:
     /// sender if the backend is JSON file).
     static void sessionReader(void);
 
-    /// @brief IOService object, used for all ASIO operations.
-    isc::asiolink::IOService io_service_;
-
     /// @brief Handler for processing 'shutdown' command
     ///
     /// This handler processes shutdown command, which initializes shutdown
@@ -169,6 +172,98 @@ protected:
     isc::data::ConstElementPtr
     commandConfigReloadHandler(const std::string& command,
                                isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'statistic-get' command
+    ///
+    /// This handler returns the current value and the recorded history
+    /// of the statistic specified by the "name" parameter in args. An
+    /// empty map is returned if there is no such statistic.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args map holding the "name" of the statistic
+    ///
+    /// @return status of the command with the statistic
+    isc::data::ConstElementPtr
+    commandStatisticGetHandler(const std::string& command,
+                               isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'statistic-get-all' command
+    ///
+    /// This handler returns the current values and the recorded history
+    /// of all statistics.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command with the statistics
+    isc::data::ConstElementPtr
+    commandStatisticGetAllHandler(const std::string& command,
+                                  isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'statistic-reset' command
+    ///
+    /// This handler resets the statistic specified by the "name" parameter
+    /// in args. The counters are set to 0, the gauges (e.g. the number of
+    /// addresses assigned in a subnet) retain their values. The history of
+    /// the statistic is cleared.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args map holding the "name" of the statistic
+    ///
+    /// @return status of the command
+    isc::data::ConstElementPtr
+    commandStatisticResetHandler(const std::string& command,
+                                 isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'statistic-reset-all' command
+    ///
+    /// This handler resets all statistics in the same way as the
+    /// 'statistic-reset' command.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command
+    isc::data::ConstElementPtr
+    commandStatisticResetAllHandler(const std::string& command,
+                                    isc::data::ConstElementPtr args);
+
+    /// @brief Returns the name of the statistic specified in the command
+    /// arguments.
+    ///
+    /// @param args map holding the "name" of the statistic
+    ///
+    /// @throw isc::BadValue if the name is not specified.
+    /// @return name of the statistic
+    static std::string getStatisticName(isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'latency-get' command
+    ///
+    /// This handler returns the summaries of the histograms of the time
+    /// spent by the packets in the processing stages, by the message type.
+    /// The histograms are updated when the latency-histograms parameter is
+    /// enabled.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command with the histograms
+    isc::data::ConstElementPtr
+    commandLatencyGetHandler(const std::string& command,
+                             isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'latency-reset' command
+    ///
+    /// This handler removes the values recorded in the histograms of the
+    /// time spent by the packets in the processing stages.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command
+    isc::data::ConstElementPtr
+    commandLatencyResetHandler(const std::string& command,
+                               isc::data::ConstElementPtr args);
 };
 
 }; // namespace isc::dhcp
@@ -189,7 +189,8 @@ const std::string Dhcpv4Srv::VENDOR_CLASS_PREFIX("VENDOR_CLASS_");
 
 Dhcpv4Srv::Dhcpv4Srv(uint16_t port, const bool use_bcast,
                      const bool direct_response_desired)
-    : shutdown_(true), alloc_engine_(), port_(port),
+    : shutdown_(true), alloc_engine_(), batch_responses_(false),
+      reclaim_timer_(io_service_), last_sample_time_(time(NULL)), port_(port),
       use_bcast_(use_bcast), hook_index_pkt4_receive_(-1),
       hook_index_subnet4_select_(-1), hook_index_pkt4_send_(-1) {
 
@@ -209,15 +210,49 @@ Dhcpv4Srv::Dhcpv4Srv(uint16_t port, const bool use_bcast,
             IfaceMgr::instance().setMatchingPacketFilter(direct_response_desired);
         }
 
-        // Instantiate allocation engine
+        // Instantiate allocation engine. The allocator selected in the
+        // configuration is used when the server starts processing packets.
         alloc_engine_.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 100,
                                             false /* false = IPv4 */));
+        allocator_ = "iterative";
 
         // Register hook points
         hook_index_pkt4_receive_   = Hooks.hook_index_pkt4_receive_;
         hook_index_subnet4_select_ = Hooks.hook_index_subnet4_select_;
         hook_index_pkt4_send_      = Hooks.hook_index_pkt4_send_;
 
+        // Obtain the statistics updated for each packet, so as they are
+        // not looked up by name when the packets are processed.
+        StatsMgr& stats_mgr = StatsMgr::instance();
+        stat_pkt4_received_ = stats_mgr.getCounter("pkt4-received");
+        stat_pkt4_parse_failed_ = stats_mgr.getCounter("pkt4-parse-failed");
+        stat_pkt4_receive_drop_ = stats_mgr.getCounter("pkt4-receive-drop");
+        stat_pkt4_unknown_received_ =
+            stats_mgr.getCounter("pkt4-unknown-received");
+        stat_pkt4_sent_ = stats_mgr.getCounter("pkt4-sent");
+        stat_pkt4_other_sent_ = stats_mgr.getCounter("pkt4-other-sent");
+        stats_received_[DHCPDISCOVER] =
+            stats_mgr.getCounter("pkt4-discover-received");
+        stats_received_[DHCPREQUEST] =
+            stats_mgr.getCounter("pkt4-request-received");
+        stats_received_[DHCPRELEASE] =
+            stats_mgr.getCounter("pkt4-release-received");
+        stats_received_[DHCPDECLINE] =
+            stats_mgr.getCounter("pkt4-decline-received");
+        stats_received_[DHCPINFORM] =
+            stats_mgr.getCounter("pkt4-inform-received");
+        stats_sent_[DHCPOFFER] = stats_mgr.getCounter("pkt4-offer-sent");
+        stats_sent_[DHCPACK] = stats_mgr.getCounter("pkt4-ack-sent");
+        stats_sent_[DHCPNAK] = stats_mgr.getCounter("pkt4-nak-sent");
+
+        PacketLatencyStats::TypeNames latency_types;
+        latency_types[DHCPDISCOVER] = "DHCPDISCOVER";
+        latency_types[DHCPREQUEST] = "DHCPREQUEST";
+        latency_types[DHCPRELEASE] = "DHCPRELEASE";
+        latency_types[DHCPDECLINE] = "DHCPDECLINE";
+        latency_types[DHCPINFORM] = "DHCPINFORM";
+        latency_stats_.reset(new PacketLatencyStats(latency_types));
+
         /// @todo call loadLibraries() when handling configuration changes
 
     } catch (const std::exception &e) {
@@ -230,6 +265,7 @@ Dhcpv4Srv::Dhcpv4Srv(uint16_t port, const bool use_bcast,
 }
 
 Dhcpv4Srv::~Dhcpv4Srv() {
+    stopThreadPool();
     IfaceMgr::instance().closeSockets();
 }
 
@@ -294,17 +330,46 @@ Dhcpv4Srv::receivePacket(int timeout) {
     return (IfaceMgr::instance().receive4(timeout));
 }
 
+void
+Dhcpv4Srv::receivePackets(int timeout, Pkt4Collection& queries) {
+    IfaceMgr::instance().receive4Batch(queries, RECEIVE_BATCH_SIZE, timeout);
+}
+
 void
 Dhcpv4Srv::sendPacket(const Pkt4Ptr& packet) {
-    IfaceMgr::instance().send(packet);
+    if (batch_responses_) {
+        batched_responses_.push_back(packet);
+    } else {
+        IfaceMgr::instance().send(packet);
+    }
+}
+
+void
+Dhcpv4Srv::sendBatchedResponses() {
+    if (batched_responses_.empty()) {
+        return;
+    }
+    // The responses which can't be sent are logged one by one and don't
+    // prevent sending the remaining responses.
+    try {
+        IfaceMgr::instance().sendBatch(batched_responses_,
+                                       &Dhcpv4Srv::logBatchSendError);
+    } catch (const std::exception& e) {
+        LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL).arg(e.what());
+    }
+    batched_responses_.clear();
+}
+
+void
+Dhcpv4Srv::logBatchSendError(const Pkt4Ptr&, const std::string& errmsg) {
+    LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL).arg(errmsg);
 }
 
 bool
 Dhcpv4Srv::run() {
     while (!shutdown_) {
-        // client's message and server's response
-        Pkt4Ptr query;
-        Pkt4Ptr rsp;
+        // clients' messages
+        Pkt4Collection queries;
 
         try {
             // The lease database backend may install some timers for which
@@ -317,7 +382,19 @@ Dhcpv4Srv::run() {
             if (timeout == 0) {
                 timeout = 1000;
             }
-            query = receivePacket(timeout);
+            // Wake up in time to reclaim expired leases.
+            uint32_t reclaim_wait_time = CfgMgr::instance().getCurrentCfg()->
+                getReclaimTimerWaitTime();
+            if ((reclaim_wait_time > 0) && (reclaim_wait_time < timeout)) {
+                timeout = reclaim_wait_time;
+            }
+            // Likewise, wake up in time to sample the statistics.
+            uint32_t sample_interval = CfgMgr::instance().getCurrentCfg()->
+                getStatisticsSampleInterval();
+            if ((sample_interval > 0) && (sample_interval < timeout)) {
+                timeout = sample_interval;
+            }
+            receivePackets(timeout, queries);
 
         } catch (const SignalInterruptOnSelect) {
             // Packet reception interrupted because a signal has been received.
@@ -342,6 +419,23 @@ Dhcpv4Srv::run() {
         // of select() to terminate.
         handleSignal();
 
+        // The configuration may have been changed as a result of handling
+        // the signal, so make sure that the number of worker threads
+        // matches the current configuration.
+        updateThreadPool();
+        updateAllocEngine();
+        updateReclaimTimer();
+
+        // Execute ready timers, e.g. the reclamation of expired leases.
+        // The IOService is only polled when there is a timer, because
+        // polling it without pending work stops it.
+        if (reclaim_timer_.getInterval() > 0) {
+            io_service_.poll();
+        }
+
+        // Record the history of the statistics if it is time to do so.
+        sampleStatistics();
+
         // Execute ready timers for the lease database, e.g. Lease File Cleanup.
         try {
             LeaseMgrFactory::instance().getIOService()->poll();
@@ -353,244 +447,459 @@ Dhcpv4Srv::run() {
 
         // Timeout may be reached or signal received, which breaks select()
         // with no reception occurred
-        if (!query) {
+        if (queries.empty()) {
             continue;
         }
 
-        // In order to parse the DHCP options, the server needs to use some
-        // configuration information such as: existing option spaces, option
-        // definitions etc. This is the kind of information which is not
-        // available in the libdhcp, so we need to supply our own implementation
-        // of the option parsing function here, which would rely on the
-        // configuration data.
-        query->setCallback(boost::bind(&Dhcpv4Srv::unpackOptions, this,
-                                       _1, _2, _3));
+        stat_pkt4_received_->add(queries.size());
+
+        // If the thread pool is running, the packets are processed by the
+        // worker threads. If the queue is full, the packet is dropped and
+        // the client will retransmit it.
+        if (thread_pool_.isRunning()) {
+            for (Pkt4Collection::const_iterator query = queries.begin();
+                 query != queries.end(); ++query) {
+                if (!thread_pool_.add(boost::bind(&Dhcpv4Srv::processPacket,
+                                                  this, *query))) {
+                    stat_pkt4_receive_drop_->add(1);
+                    LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL,
+                              DHCP4_PACKET_QUEUE_FULL)
+                        .arg(thread_pool_.getQueueSize());
+                }
+            }
 
-        bool skip_unpack = false;
+        } else {
+            // The responses to the packets received together are sent
+            // together when all packets have been processed.
+            batch_responses_ = true;
+            for (Pkt4Collection::iterator query = queries.begin();
+                 query != queries.end(); ++query) {
+                processPacket(*query);
+            }
+            batch_responses_ = false;
+            sendBatchedResponses();
+        }
+    }
 
-        // The packet has just been received so contains the uninterpreted wire
-        // data; execute callouts registered for buffer4_receive.
-        if (HooksManager::calloutsPresent(Hooks.hook_index_buffer4_receive_)) {
-            CalloutHandlePtr callout_handle = getCalloutHandle(query);
+    // Don't leave the worker threads running when the server is shut down.
+    stopThreadPool();
 
-            // Delete previously set arguments
-            callout_handle->deleteAllArguments();
+    return (true);
+}
 
-            // Pass incoming packet as argument
-            callout_handle->setArgument("query4", query);
+void
+Dhcpv4Srv::updateThreadPool() {
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    size_t thread_count = cfg->getThreadPoolSize();
+    size_t queue_size = cfg->getPacketQueueSize();
+
+    // Nothing to do if the pool already runs with the configured parameters.
+    if ((thread_count == thread_pool_.getThreadCount()) &&
+        ((thread_count == 0) || (queue_size == thread_pool_.getQueueSize()))) {
+        return;
+    }
 
-            // Call callouts
-            HooksManager::callCallouts(Hooks.hook_index_buffer4_receive_,
-                                       *callout_handle);
+    stopThreadPool();
 
-            // Callouts decided to skip the next processing step. The next
-            // processing step would to parse the packet, so skip at this
-            // stage means that callouts did the parsing already, so server
-            // should skip parsing.
-            if (callout_handle->getSkip()) {
-                LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_BUFFER_RCVD_SKIP);
-                skip_unpack = true;
-            }
+    if (thread_count > 0) {
+        try {
+            thread_pool_.start(thread_count, queue_size);
+            LOG_INFO(dhcp4_logger, DHCP4_THREAD_POOL_STARTED)
+                .arg(thread_count).arg(queue_size);
 
-            callout_handle->getArgument("query4", query);
+        } catch (const std::exception& ex) {
+            // Fall back to processing packets on the main thread.
+            LOG_ERROR(dhcp4_logger, DHCP4_THREAD_POOL_START_FAIL)
+                .arg(ex.what());
+            stopThreadPool();
         }
+    }
+}
 
-        // Unpack the packet information unless the buffer4_receive callouts
-        // indicated they did it
-        if (!skip_unpack) {
-            try {
-                query->unpack();
-            } catch (const std::exception& e) {
-                // Failed to parse the packet.
-                LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL,
-                          DHCP4_PACKET_PARSE_FAIL).arg(e.what());
-                continue;
+void
+Dhcpv4Srv::updateAllocEngine() {
+    const std::string allocator =
+        CfgMgr::instance().getCurrentCfg()->getAllocator();
+    if (alloc_engine_ && (allocator == allocator_)) {
+        return;
+    }
+
+    // The worker threads use the allocation engine, so let them finish
+    // processing queued packets before it is replaced.
+    if (thread_pool_.isRunning()) {
+        thread_pool_.wait();
+    }
+    AllocEngine::AllocType type = (allocator == "bitmap") ?
+        AllocEngine::ALLOC_BITMAP : AllocEngine::ALLOC_ITERATIVE;
+    alloc_engine_.reset(new AllocEngine(type, 100, false /* false = IPv4 */));
+    allocator_ = allocator;
+    LOG_INFO(dhcp4_logger, DHCP4_ALLOCATOR_SELECTED).arg(allocator);
+}
+
+void
+Dhcpv4Srv::updateReclaimTimer() {
+    const long interval = static_cast<long>(CfgMgr::instance().getCurrentCfg()->
+                                            getReclaimTimerWaitTime()) * 1000;
+    if (interval == reclaim_timer_.getInterval()) {
+        return;
+    }
+
+    if (interval == 0) {
+        reclaim_timer_.cancel();
+    } else {
+        reclaim_timer_.setup(boost::bind(&Dhcpv4Srv::reclaimExpiredLeases,
+                                         this), interval);
+    }
+}
+
+void
+Dhcpv4Srv::reclaimExpiredLeases() {
+    if (!alloc_engine_) {
+        return;
+    }
+
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    try {
+        Lease4Collection leases = alloc_engine_->
+            reclaimExpiredLeases4(cfg->getMaxReclaimLeases());
+        if (CfgMgr::instance().ddnsEnabled()) {
+            for (Lease4Collection::const_iterator lease = leases.begin();
+                 lease != leases.end(); ++lease) {
+                // Remove existing DNS entries for the lease, if any.
+                queueNameChangeRequest(isc::dhcp_ddns::CHG_REMOVE, *lease);
             }
         }
+        if (!leases.empty()) {
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_BASIC, DHCP4_LEASES_RECLAIMED)
+                .arg(leases.size());
+        }
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcp4_logger, DHCP4_LEASES_RECLAIM_FAIL).arg(ex.what());
+    }
+}
+
+void
+Dhcpv4Srv::sampleStatistics() {
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    uint32_t interval = cfg->getStatisticsSampleInterval();
+    if (interval == 0) {
+        return;
+    }
+
+    // The clock may have been moved backwards, in which case the sample
+    // is recorded right away.
+    time_t now = time(NULL);
+    if ((now >= last_sample_time_) &&
+        (now - last_sample_time_ < static_cast<time_t>(interval))) {
+        return;
+    }
+    last_sample_time_ = now;
+
+    StatsMgr::instance().sample(cfg->getStatisticsMaxSamples());
+}
+
+const StatsCounterPtr&
+Dhcpv4Srv::getPacketStat(const PacketStats& stats, const uint8_t type,
+                         const StatsCounterPtr& other) {
+    PacketStats::const_iterator stat = stats.find(type);
+    return (stat != stats.end() ? stat->second : other);
+}
+
+void
+Dhcpv4Srv::stopThreadPool() {
+    if (thread_pool_.isRunning()) {
+        // Let the worker threads complete processing of the queued packets.
+        thread_pool_.wait();
+        thread_pool_.stop();
+        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_START, DHCP4_THREAD_POOL_STOPPED);
+    }
+}
+
+void
+Dhcpv4Srv::processPacket(Pkt4Ptr& query) {
+    Pkt4Ptr rsp;
+
+    // If enabled, record the times at which the packet completes the
+    // processing stages. They are recorded in the histograms when this
+    // method returns.
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    PacketLatencyStats* latency_stats = NULL;
+    if (cfg->getLatencyHistograms()) {
+        query->enableStageTimes(PacketLatencyStats::NUM_STAGES);
+        query->setStageTime(PacketLatencyStats::RECEIVE);
+        latency_stats = latency_stats_.get();
+    }
+    PacketLatencyRecorder<Pkt4Ptr> latency_recorder(latency_stats, query);
+
+    // In order to parse the DHCP options, the server needs to use some
+    // configuration information such as: existing option spaces, option
+    // definitions etc. This is the kind of information which is not
+    // available in the libdhcp, so we need to supply our own implementation
+    // of the option parsing function here, which would rely on the
+    // configuration data.
+    query->setCallback(boost::bind(&Dhcpv4Srv::unpackOptions, this,
+                                   _1, _2, _3));
+
+    // If enabled, the options are only located when the packet is unpacked.
+    // The option objects are created by the callback above when they are
+    // retrieved, by the server or by the callouts.
+    query->setLazyUnpack(cfg->getLazyOptionParsing());
+
+    bool skip_unpack = false;
+
+    // The packet has just been received so contains the uninterpreted wire
+    // data; execute callouts registered for buffer4_receive.
+    if (HooksManager::calloutsPresent(Hooks.hook_index_buffer4_receive_)) {
+        CalloutHandlePtr callout_handle = getCalloutHandle(query);
+
+        // Delete previously set arguments
+        callout_handle->deleteAllArguments();
+
+        // Pass incoming packet as argument
+        callout_handle->setArgument("query4", query);
+
+        // Call callouts
+        HooksManager::callCallouts(Hooks.hook_index_buffer4_receive_,
+                                   *callout_handle);
+
+        // Callouts decided to skip the next processing step. The next
+        // processing step would to parse the packet, so skip at this
+        // stage means that callouts did the parsing already, so server
+        // should skip parsing.
+        if (callout_handle->getSkip()) {
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_BUFFER_RCVD_SKIP);
+            skip_unpack = true;
+        }
+
+        callout_handle->getArgument("query4", query);
+    }
+
+    // Unpack the packet information unless the buffer4_receive callouts
+    // indicated they did it
+    if (!skip_unpack) {
+        try {
+            query->unpack();
+        } catch (const std::exception& e) {
+            // Failed to parse the packet.
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL,
+                      DHCP4_PACKET_PARSE_FAIL).arg(e.what());
+            stat_pkt4_parse_failed_->add(1);
+            return;
+        }
+    }
+    query->setStageTime(PacketLatencyStats::UNPACK);
 
+    try {
         // Assign this packet to one or more classes if needed. We need to do
         // this before calling accept(), because getSubnet4() may need client
         // class information.
         classifyPacket(query);
+        query->setStageTime(PacketLatencyStats::CLASSIFY);
 
-        // Check whether the message should be further processed or discarded.
-        // There is no need to log anything here. This function logs by itself.
+        // Check whether the message should be further processed or
+        // discarded. There is no need to log anything here. This function
+        // logs by itself.
         if (!accept(query)) {
-            continue;
+            return;
         }
+        query->setStageTime(PacketLatencyStats::ACCEPT);
 
-        // We have sanity checked (in accept() that the Message Type option
-        // exists, so we can safely get it here.
-        int type = query->getType();
-        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL, DHCP4_PACKET_RECEIVED)
-            .arg(serverReceivedPacketName(type))
-            .arg(type)
-            .arg(query->getIface());
-        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL_DATA, DHCP4_QUERY_DATA)
-            .arg(type)
-            .arg(query->toText());
-
-        // Let's execute all callouts registered for pkt4_receive
+        // The pkt4_receive callouts get the query with all options created,
+        // as if the options weren't parsed lazily.
         if (HooksManager::calloutsPresent(hook_index_pkt4_receive_)) {
-            CalloutHandlePtr callout_handle = getCalloutHandle(query);
+            query->materializeOptions();
+        }
 
-            // Delete previously set arguments
-            callout_handle->deleteAllArguments();
+    } catch (const std::exception& e) {
+        // When the options are parsed lazily, a malformed option is found
+        // when it is first retrieved, which is usually here.
+        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL,
+                  DHCP4_PACKET_PARSE_FAIL).arg(e.what());
+        stat_pkt4_parse_failed_->add(1);
+        return;
+    }
 
-            // Pass incoming packet as argument
-            callout_handle->setArgument("query4", query);
+    // We have sanity checked (in accept() that the Message Type option
+    // exists, so we can safely get it here.
+    int type = query->getType();
+    latency_recorder.setType(type);
+    getPacketStat(stats_received_, type, stat_pkt4_unknown_received_)->add(1);
+    LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL, DHCP4_PACKET_RECEIVED)
+        .arg(serverReceivedPacketName(type))
+        .arg(type)
+        .arg(query->getIface());
+    LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL_DATA, DHCP4_QUERY_DATA)
+        .arg(type)
+        .arg(query->toText());
+
+    // Let's execute all callouts registered for pkt4_receive
+    if (HooksManager::calloutsPresent(hook_index_pkt4_receive_)) {
+        CalloutHandlePtr callout_handle = getCalloutHandle(query);
 
-            // Call callouts
-            HooksManager::callCallouts(hook_index_pkt4_receive_,
-                                       *callout_handle);
+        // Delete previously set arguments
+        callout_handle->deleteAllArguments();
 
-            // Callouts decided to skip the next processing step. The next
-            // processing step would to process the packet, so skip at this
-            // stage means drop.
-            if (callout_handle->getSkip()) {
-                LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_PACKET_RCVD_SKIP);
-                continue;
-            }
+        // Pass incoming packet as argument
+        callout_handle->setArgument("query4", query);
 
-            callout_handle->getArgument("query4", query);
+        // Call callouts
+        HooksManager::callCallouts(hook_index_pkt4_receive_,
+                                   *callout_handle);
+
+        // Callouts decided to skip the next processing step. The next
+        // processing step would to process the packet, so skip at this
+        // stage means drop.
+        if (callout_handle->getSkip()) {
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_PACKET_RCVD_SKIP);
+            return;
         }
 
-        try {
-            switch (query->getType()) {
-            case DHCPDISCOVER:
-                rsp = processDiscover(query);
-                break;
-
-            case DHCPREQUEST:
-                // Note that REQUEST is used for many things in DHCPv4: for
-                // requesting new leases, renewing existing ones and even
-                // for rebinding.
-                rsp = processRequest(query);
-                break;
-
-            case DHCPRELEASE:
-                processRelease(query);
-                break;
-
-            case DHCPDECLINE:
-                processDecline(query);
-                break;
-
-            case DHCPINFORM:
-                rsp = processInform(query);
-                break;
-
-            default:
-                // Only action is to output a message if debug is enabled,
-                // and that is covered by the debug statement before the
-                // "switch" statement.
-                ;
-            }
-        } catch (const isc::Exception& e) {
-
-            // Catch-all exception (at least for ones based on the isc Exception
-            // class, which covers more or less all that are explicitly raised
-            // in the Kea code).  Just log the problem and ignore the packet.
-            // (The problem is logged as a debug message because debug is
-            // disabled by default - it prevents a DDOS attack based on the
-            // sending of problem packets.)
-            if (dhcp4_logger.isDebugEnabled(DBG_DHCP4_BASIC)) {
-                std::string source = "unknown";
-                HWAddrPtr hwptr = query->getHWAddr();
-                if (hwptr) {
-                    source = hwptr->toText();
-                }
-                LOG_DEBUG(dhcp4_logger, DBG_DHCP4_BASIC,
-                          DHCP4_PACKET_PROCESS_FAIL)
-                    .arg(source).arg(e.what());
+        callout_handle->getArgument("query4", query);
+    }
+    query->setStageTime(PacketLatencyStats::RECEIVE_HOOKS);
+
+    try {
+        switch (query->getType()) {
+        case DHCPDISCOVER:
+            rsp = processDiscover(query);
+            break;
+
+        case DHCPREQUEST:
+            // Note that REQUEST is used for many things in DHCPv4: for
+            // requesting new leases, renewing existing ones and even
+            // for rebinding.
+            rsp = processRequest(query);
+            break;
+
+        case DHCPRELEASE:
+            processRelease(query);
+            break;
+
+        case DHCPDECLINE:
+            processDecline(query);
+            break;
+
+        case DHCPINFORM:
+            rsp = processInform(query);
+            break;
+
+        default:
+            // Only action is to output a message if debug is enabled,
+            // and that is covered by the debug statement before the
+            // "switch" statement.
+            ;
+        }
+    } catch (const isc::Exception& e) {
+
+        // Catch-all exception (at least for ones based on the isc Exception
+        // class, which covers more or less all that are explicitly raised
+        // in the Kea code).  Just log the problem and ignore the packet.
+        // (The problem is logged as a debug message because debug is
+        // disabled by default - it prevents a DDOS attack based on the
+        // sending of problem packets.)
+        if (dhcp4_logger.isDebugEnabled(DBG_DHCP4_BASIC)) {
+            std::string source = "unknown";
+            HWAddrPtr hwptr = query->getHWAddr();
+            if (hwptr) {
+                source = hwptr->toText();
             }
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_BASIC,
+                      DHCP4_PACKET_PROCESS_FAIL)
+                .arg(source).arg(e.what());
         }
+    }
+    query->setStageTime(PacketLatencyStats::PROCESS);
 
-        if (!rsp) {
-            continue;
-        }
+    if (!rsp) {
+        return;
+    }
 
+    // Specifies if server should do the packing
+    bool skip_pack = false;
 
-        // Specifies if server should do the packing
-        bool skip_pack = false;
+    // Execute all callouts registered for pkt4_send
+    if (HooksManager::calloutsPresent(hook_index_pkt4_send_)) {
+        CalloutHandlePtr callout_handle = getCalloutHandle(query);
+
+        // Delete all previous arguments
+        callout_handle->deleteAllArguments();
 
-        // Execute all callouts registered for pkt4_send
-        if (HooksManager::calloutsPresent(hook_index_pkt4_send_)) {
+        // Clear skip flag if it was set in previous callouts
+        callout_handle->setSkip(false);
+
+        // Set our response
+        callout_handle->setArgument("response4", rsp);
+
+        // The callouts may modify the configured options in place, so
+        // they are packed from scratch.
+        rsp->clearPackedOptions();
+
+        // Call all installed callouts
+        HooksManager::callCallouts(hook_index_pkt4_send_,
+                                   *callout_handle);
+
+        // Callouts decided to skip the next processing step. The next
+        // processing step would to send the packet, so skip at this
+        // stage means "drop response".
+        if (callout_handle->getSkip()) {
+            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_PACKET_SEND_SKIP);
+            skip_pack = true;
+        }
+    }
+
+    if (!skip_pack) {
+        try {
+            rsp->pack();
+        } catch (const std::exception& e) {
+            LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL)
+                .arg(e.what());
+        }
+    }
+    query->setStageTime(PacketLatencyStats::PACK);
+
+    try {
+        // Now all fields and options are constructed into output wire buffer.
+        // Option objects modification does not make sense anymore. Hooks
+        // can only manipulate wire buffer at this stage.
+        // Let's execute all callouts registered for buffer4_send
+        if (HooksManager::calloutsPresent(Hooks.hook_index_buffer4_send_)) {
             CalloutHandlePtr callout_handle = getCalloutHandle(query);
 
-            // Delete all previous arguments
+            // Delete previously set arguments
             callout_handle->deleteAllArguments();
 
-            // Clear skip flag if it was set in previous callouts
-            callout_handle->setSkip(false);
-
-            // Set our response
+            // Pass incoming packet as argument
             callout_handle->setArgument("response4", rsp);
 
-            // Call all installed callouts
-            HooksManager::callCallouts(hook_index_pkt4_send_,
+            // Call callouts
+            HooksManager::callCallouts(Hooks.hook_index_buffer4_send_,
                                        *callout_handle);
 
             // Callouts decided to skip the next processing step. The next
-            // processing step would to send the packet, so skip at this
-            // stage means "drop response".
+            // processing step would to parse the packet, so skip at this
+            // stage means drop.
             if (callout_handle->getSkip()) {
-                LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_PACKET_SEND_SKIP);
-                skip_pack = true;
+                LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS,
+                          DHCP4_HOOK_BUFFER_SEND_SKIP);
+                return;
             }
-        }
 
-        if (!skip_pack) {
-            try {
-                rsp->pack();
-            } catch (const std::exception& e) {
-                LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL)
-                    .arg(e.what());
-            }
+            callout_handle->getArgument("response4", rsp);
         }
 
-        try {
-            // Now all fields and options are constructed into output wire buffer.
-            // Option objects modification does not make sense anymore. Hooks
-            // can only manipulate wire buffer at this stage.
-            // Let's execute all callouts registered for buffer4_send
-            if (HooksManager::calloutsPresent(Hooks.hook_index_buffer4_send_)) {
-                CalloutHandlePtr callout_handle = getCalloutHandle(query);
-
-                // Delete previously set arguments
-                callout_handle->deleteAllArguments();
-
-                // Pass incoming packet as argument
-                callout_handle->setArgument("response4", rsp);
-
-                // Call callouts
-                HooksManager::callCallouts(Hooks.hook_index_buffer4_send_,
-                                           *callout_handle);
-
-                // Callouts decided to skip the next processing step. The next
-                // processing step would to parse the packet, so skip at this
-                // stage means drop.
-                if (callout_handle->getSkip()) {
-                    LOG_DEBUG(dhcp4_logger, DBG_DHCP4_HOOKS,
-                              DHCP4_HOOK_BUFFER_SEND_SKIP);
-                    continue;
-                }
-
-                callout_handle->getArgument("response4", rsp);
-            }
-
-            LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL_DATA,
-                      DHCP4_RESPONSE_DATA)
-                .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
+        LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL_DATA,
+                  DHCP4_RESPONSE_DATA)
+            .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
 
-            sendPacket(rsp);
-        } catch (const std::exception& e) {
-            LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL)
-                .arg(e.what());
-        }
+        sendPacket(rsp);
+        stat_pkt4_sent_->add(1);
+        getPacketStat(stats_sent_, rsp->getType(), stat_pkt4_other_sent_)->add(1);
+        query->setStageTime(PacketLatencyStats::SEND);
+    } catch (const std::exception& e) {
+        LOG_ERROR(dhcp4_logger, DHCP4_PACKET_SEND_FAIL)
+            .arg(e.what());
     }
-
-    return (true);
 }
 
 string
@@ -699,14 +1008,18 @@ Dhcpv4Srv::appendRequestedOptions(Dhcpv4Exchange& ex) {
 
     // Get the codes of requested options.
     const std::vector<uint8_t>& requested_opts = option_prl->getValues();
+    ConstCfgOptionPtr cfg_option = subnet->getCfgOption();
     // For each requested option code get the instance of the option
-    // to be returned to the client.
+    // to be returned to the client. The options have been packed when
+    // the configuration was committed, so they are copied into the
+    // response.
     for (std::vector<uint8_t>::const_iterator opt = requested_opts.begin();
          opt != requested_opts.end(); ++opt) {
         if (!resp->getOption(*opt)) {
-            OptionDescriptor desc = subnet->getCfgOption()->get("dhcp4", *opt);
-            if (desc.option_) {
-                resp->addOption(desc.option_);
+            PackedOption packed = cfg_option->getPackedOption(DHCP4_OPTION_SPACE,
+                                                              *opt);
+            if (packed.option_) {
+                resp->addPackedOption(packed.option_, packed.wire_);
             }
         }
     }
@@ -1463,6 +1776,7 @@ Dhcpv4Srv::processDiscover(Pkt4Ptr& discover) {
     sanityCheck(discover, FORBIDDEN);
 
     Dhcpv4Exchange ex(alloc_engine_, discover, selectSubnet(discover));
+    discover->setStageTime(PacketLatencyStats::SELECT_SUBNET);
 
     // If DHCPDISCOVER message contains the FQDN or Hostname option, server
     // may respond to the client with the appropriate FQDN or Hostname
@@ -1471,6 +1785,7 @@ Dhcpv4Srv::processDiscover(Pkt4Ptr& discover) {
     processClientName(ex);
 
     assignLease(ex);
+    discover->setStageTime(PacketLatencyStats::LEASE);
 
     if (!ex.getResponse()) {
         // The offer is empty so return it *now*!
@@ -1514,6 +1829,7 @@ Dhcpv4Srv::processRequest(Pkt4Ptr& request) {
     /// sanityCheck(request, MANDATORY);
 
     Dhcpv4Exchange ex(alloc_engine_, request, selectSubnet(request));
+    request->setStageTime(PacketLatencyStats::SELECT_SUBNET);
 
     // If DHCPREQUEST message contains the FQDN or Hostname option, server
     // should respond to the client with the appropriate FQDN or Hostname
@@ -1525,6 +1841,7 @@ Dhcpv4Srv::processRequest(Pkt4Ptr& request) {
     // first request (requesting for new address), renewing existing address
     // or even rebinding.
     assignLease(ex);
+    request->setStageTime(PacketLatencyStats::LEASE);
 
     if (!ex.getResponse()) {
         // The ack is empty so return it *now*!
@@ -1641,6 +1958,14 @@ Dhcpv4Srv::processRelease(Pkt4Ptr& release) {
             bool success = LeaseMgrFactory::instance().deleteLease(lease->addr_);
 
             if (success) {
+                // The address may be allocated to another client.
+                alloc_engine_->leaseRemoved4(lease->addr_);
+                StatsCounterPtr assigned = CfgMgr::instance().getCurrentCfg()->
+                    getCfgSubnets4()->getAssignedAddresses(lease->subnet_id_);
+                if (assigned) {
+                    assigned->add(-1);
+                }
+
                 // Release successful
                 LOG_DEBUG(dhcp4_logger, DBG_DHCP4_DETAIL, DHCP4_RELEASE)
                     .arg(lease->addr_.toText())
@@ -1939,20 +2264,26 @@ Dhcpv4Srv::unpackOptions(const OptionBuffer& buf,
                          isc::dhcp::OptionCollection& options) {
     size_t offset = 0;
 
-    OptionDefContainer option_defs;
+    // The option definitions are not copied, because this function is
+    // called for each received packet.
+    OptionDefContainerPtr option_defs_ptr;
+    const OptionDefContainer* option_defs = NULL;
     if (option_space == "dhcp4") {
         // Get the list of standard option definitions.
-        option_defs = LibDHCP::getOptionDefs(Option::V4);
-    } else if (!option_space.empty()) {
-        OptionDefContainerPtr option_defs_ptr = CfgMgr::instance()
-            .getCurrentCfg()->getCfgOptionDef()->getAll(option_space);
-        if (option_defs_ptr != NULL) {
-            option_defs = *option_defs_ptr;
+        option_defs = &LibDHCP::getOptionDefs(Option::V4);
+    } else {
+        if (!option_space.empty()) {
+            option_defs_ptr = CfgMgr::instance().getCurrentCfg()->
+                getCfgOptionDef()->getAll(option_space);
+        }
+        if (!option_defs_ptr) {
+            option_defs_ptr.reset(new OptionDefContainer());
         }
+        option_defs = option_defs_ptr.get();
     }
     // Get the search index #1. It allows to search for option definitions
     // using option code.
-    const OptionDefContainerTypeIndex& idx = option_defs.get<1>();
+    const OptionDefContainerTypeIndex& idx = option_defs->get<1>();
 
     // The buffer being read comprises a set of options, each starting with
     // a one-byte type code and a one-byte length field.
@@ -15,6 +15,8 @@
 #ifndef DHCPV4_SRV_H
 #define DHCPV4_SRV_H
 
+#include <asiolink/interval_timer.h>
+#include <asiolink/io_service.h>
 #include <dhcp/dhcp4.h>
 #include <dhcp/pkt4.h>
 #include <dhcp/option.h>
@@ -27,10 +29,15 @@
 #include <dhcpsrv/alloc_engine.h>
 #include <hooks/callout_handle.h>
 #include <dhcpsrv/daemon.h>
+#include <dhcpsrv/latency_stats.h>
+#include <dhcpsrv/stats_mgr.h>
+#include <util/threads/thread_pool.h>
 
 #include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <iostream>
+#include <map>
 #include <queue>
 
 namespace isc {
@@ -192,10 +199,27 @@ public:
     /// their correctness, generates appropriate answer (if needed) and
     /// transmits responses.
     ///
+    /// If the server is configured to use a thread pool (thread-pool-size
+    /// greater than 0), the received packets are processed by the worker
+    /// threads and this loop only receives packets and handles signals.
+    /// Otherwise, the packets are processed by this loop.
+    ///
     /// @return true, if being shut down gracefully, fail if experienced
     ///         critical error.
     bool run();
 
+    /// @brief Processes a single received packet.
+    ///
+    /// Unpacks and classifies the packet, checks whether it should be
+    /// accepted, generates the response (if needed) and transmits it. All
+    /// hook points related to the packet are invoked by this method.
+    ///
+    /// This method may be called by the worker threads of the thread pool
+    /// concurrently for different packets.
+    ///
+    /// @param query A pointer to the received packet.
+    void processPacket(Pkt4Ptr& query);
+
     /// @brief Instructs the server to shut down.
     void shutdown();
 
@@ -218,6 +242,15 @@ public:
     ///         be freed by the caller.
     static const char* serverReceivedPacketName(uint8_t type);
 
+    /// @brief Returns the histograms of the time spent by the packets in
+    /// the processing stages.
+    ///
+    /// The histograms are only updated when the latency-histograms
+    /// parameter is enabled.
+    PacketLatencyStats& getLatencyStats() {
+        return (*latency_stats_);
+    }
+
     ///
     /// @name Public accessors returning values required to (re)open sockets.
     ///
@@ -701,10 +734,31 @@ protected:
     /// simulates reception of a packet. For that purpose it is protected.
     virtual Pkt4Ptr receivePacket(int timeout);
 
+    /// @brief Receives the packets queued on a socket together.
+    ///
+    /// This method is called by the main loop. It waits for the packets
+    /// with @c IfaceMgr::receive4Batch and receives up to
+    /// @c RECEIVE_BATCH_SIZE packets at once. Like @c receivePacket, it is
+    /// replaced in the tests to simulate reception of the packets.
+    ///
+    /// @param timeout Timeout for waiting for the packets.
+    /// @param [out] queries Collection to which the received packets are
+    /// appended.
+    virtual void receivePackets(int timeout, Pkt4Collection& queries);
+
+    /// @brief Maximum number of packets received at once.
+    static const size_t RECEIVE_BATCH_SIZE = 32;
+
     /// @brief dummy wrapper around IfaceMgr::send()
     ///
     /// This method is useful for testing purposes, where its replacement
     /// simulates transmission of a packet. For that purpose it is protected.
+    ///
+    /// When the main thread processes the packets received together, the
+    /// responses are collected and sent when all packets have been
+    /// processed. The statistics of the sent packets and the send stage
+    /// of the latency histograms then count the responses when they are
+    /// collected.
     virtual void sendPacket(const Pkt4Ptr& pkt);
 
     /// @brief Implements a callback function to parse options in the message.
@@ -747,6 +801,144 @@ protected:
     /// during normal operation (e.g. to use different allocators)
     boost::shared_ptr<AllocEngine> alloc_engine_;
 
+    /// @brief Name of the allocator used by the allocation engine.
+    std::string allocator_;
+
+    /// @brief Recreates the allocation engine if the allocator selected
+    /// in the current configuration has changed.
+    ///
+    /// This method is called by the main loop, like @c updateThreadPool.
+    /// The packets queued for the worker threads are processed before
+    /// the allocation engine is replaced.
+    void updateAllocEngine();
+
+    /// @brief Starts, restarts or stops the thread pool according to
+    /// the current configuration.
+    ///
+    /// This method is called by the main loop after handling signals, so
+    /// as the new values of thread-pool-size and packet-queue-size take
+    /// effect after reconfiguration. If the thread pool fails to start,
+    /// the packets are processed by the main thread.
+    void updateThreadPool();
+
+    /// @brief Waits for the worker threads to process queued packets and
+    /// stops them.
+    void stopThreadPool();
+
+    /// @brief Pool of threads processing received packets.
+    ///
+    /// It is not running when the thread-pool-size is 0.
+    isc::util::thread::ThreadPool thread_pool_;
+
+    /// @brief Sends the responses collected while processing a batch of
+    /// packets on the main thread.
+    ///
+    /// The responses are sent with @c IfaceMgr::sendBatch, so as the
+    /// responses sent over the same socket are sent with a single
+    /// system call. A response which can't be sent is logged and the
+    /// remaining responses are sent.
+    void sendBatchedResponses();
+
+    /// @brief Logs a batched response which couldn't be sent.
+    ///
+    /// @param pkt response which couldn't be sent.
+    /// @param errmsg error message.
+    static void logBatchSendError(const Pkt4Ptr& pkt,
+                                  const std::string& errmsg);
+
+    /// @brief Indicates that @c sendPacket should collect the responses
+    /// instead of sending them.
+    ///
+    /// It is only set by the main thread, when the thread pool is not
+    /// running.
+    bool batch_responses_;
+
+    /// @brief Responses collected while processing a batch of packets.
+    Pkt4Collection batched_responses_;
+
+    /// @brief IOService object, used for all ASIO operations.
+    ///
+    /// It is polled by the main loop to execute the ready timers.
+    isc::asiolink::IOService io_service_;
+
+    /// @brief Sets up or cancels the timer reclaiming the expired leases
+    /// according to the current configuration.
+    ///
+    /// This method is called by the main loop, like @c updateThreadPool,
+    /// so as the new value of reclaim-timer-wait-time takes effect after
+    /// reconfiguration.
+    void updateReclaimTimer();
+
+    /// @brief Reclaims expired leases.
+    ///
+    /// This method is called by the @c reclaim_timer_ every
+    /// reclaim-timer-wait-time seconds. It reclaims up to max-reclaim-leases
+    /// expired leases and removes DNS entries for them, if DNS updates are
+    /// enabled.
+    void reclaimExpiredLeases();
+
+    /// @brief Timer triggering the reclamation of expired leases.
+    isc::asiolink::IntervalTimer reclaim_timer_;
+
+    /// @brief Records the current values of the statistics if the
+    /// sampling is due.
+    ///
+    /// This method is called by the main loop. It does nothing if the
+    /// statistics-sample-interval is 0 or if less than
+    /// statistics-sample-interval seconds have elapsed since the last
+    /// sample. Otherwise, it records the values of all statistics,
+    /// retaining up to statistics-max-samples samples of each.
+    void sampleStatistics();
+
+    /// @brief Time of the last sample of the statistics.
+    time_t last_sample_time_;
+
+    /// @brief Statistics of the packets by the message type.
+    typedef std::map<uint8_t, StatsCounterPtr> PacketStats;
+
+    /// @brief Returns the statistic for the message type.
+    ///
+    /// @param stats Statistics of the packets by the message type.
+    /// @param type Message type.
+    /// @param other Statistic returned for the types not found in
+    /// the @c stats.
+    static const StatsCounterPtr& getPacketStat(const PacketStats& stats,
+                                                const uint8_t type,
+                                                const StatsCounterPtr& other);
+
+    /// @brief Number of packets received (pkt4-received).
+    StatsCounterPtr stat_pkt4_received_;
+
+    /// @brief Number of received packets which couldn't be parsed
+    /// (pkt4-parse-failed).
+    StatsCounterPtr stat_pkt4_parse_failed_;
+
+    /// @brief Number of received packets dropped because the queue of the
+    /// thread pool was full (pkt4-receive-drop).
+    StatsCounterPtr stat_pkt4_receive_drop_;
+
+    /// @brief Number of received packets of unsupported types
+    /// (pkt4-unknown-received).
+    StatsCounterPtr stat_pkt4_unknown_received_;
+
+    /// @brief Number of packets sent (pkt4-sent).
+    StatsCounterPtr stat_pkt4_sent_;
+
+    /// @brief Number of packets of other types sent (pkt4-other-sent).
+    StatsCounterPtr stat_pkt4_other_sent_;
+
+    /// @brief Numbers of accepted packets received by the message type,
+    /// e.g. pkt4-discover-received.
+    PacketStats stats_received_;
+
+    /// @brief Numbers of packets sent by the message type, e.g.
+    /// pkt4-offer-sent.
+    PacketStats stats_sent_;
+
+    /// @brief Histograms of the time spent by the packets in the processing
+    /// stages.
+    boost::scoped_ptr<PacketLatencyStats> latency_stats_;
+
 private:
 
     /// @brief Constructs netmask option based on subnet4
@@ -348,7 +348,13 @@ namespace dhcp {
     DhcpConfigParser* parser = NULL;
     if ((config_id.compare("valid-lifetime") == 0)  ||
         (config_id.compare("renew-timer") == 0)  ||
-        (config_id.compare("rebind-timer") == 0))  {
+        (config_id.compare("rebind-timer") == 0) ||
+        (config_id.compare("thread-pool-size") == 0) ||
+        (config_id.compare("packet-queue-size") == 0) ||
+        (config_id.compare("reclaim-timer-wait-time") == 0) ||
+        (config_id.compare("max-reclaim-leases") == 0) ||
+        (config_id.compare("statistics-sample-interval") == 0) ||
+        (config_id.compare("statistics-max-samples") == 0))  {
         parser = new Uint32Parser(config_id,
                                  globalContext()->uint32_values_);
     } else if (config_id.compare("interfaces-config") == 0) {
@@ -360,14 +366,17 @@ namespace dhcp {
     } else if (config_id.compare("option-def") == 0) {
         parser  = new OptionDefListParser(config_id, globalContext());
     } else if ((config_id.compare("version") == 0) ||
-               (config_id.compare("next-server") == 0)) {
+               (config_id.compare("next-server") == 0) ||
+               (config_id.compare("allocator") == 0)) {
         parser  = new StringParser(config_id,
                                     globalContext()->string_values_);
     } else if (config_id.compare("lease-database") == 0) {
         parser = new DbAccessParser(config_id, *globalContext());
     } else if (config_id.compare("hooks-libraries") == 0) {
         parser = new HooksLibrariesParser(config_id);
-    } else if (config_id.compare("echo-client-id") == 0) {
+    } else if ((config_id.compare("echo-client-id") == 0) ||
+               (config_id.compare("latency-histograms") == 0) ||
+               (config_id.compare("lazy-option-parsing") == 0)) {
         parser = new BooleanParser(config_id, globalContext()->boolean_values_);
     } else if (config_id.compare("dhcp-ddns") == 0) {
         parser = new D2ClientConfigParser(config_id);
@@ -392,6 +401,45 @@ void commitGlobalOptions() {
     } catch (...) {
         // Ignore errors. This flag is optional
     }
+
+    // Set the number of threads processing packets (0 means that packets
+    // are processed by the main thread) and the maximum number of packets
+    // waiting for processing.
+    SrvConfigPtr cfg = CfgMgr::instance().getStagingCfg();
+    cfg->setThreadPoolSize(globalContext()->uint32_values_->
+                           getOptionalParam("thread-pool-size", 0));
+    cfg->setPacketQueueSize(globalContext()->uint32_values_->
+                            getOptionalParam("packet-queue-size",
+                                             SrvConfig::DEFAULT_PACKET_QUEUE_SIZE));
+
+    // Set the interval between the runs of the expired leases reclamation
+    // routine (0 disables it) and the number of leases reclaimed in each run.
+    cfg->setReclaimTimerWaitTime(globalContext()->uint32_values_->
+                                 getOptionalParam("reclaim-timer-wait-time", 0));
+    cfg->setMaxReclaimLeases(globalContext()->uint32_values_->
+                             getOptionalParam("max-reclaim-leases",
+                                              SrvConfig::DEFAULT_MAX_RECLAIM_LEASES));
+
+    // Set the interval between the samples of the statistics (0 disables
+    // the sampling) and the number of samples retained.
+    cfg->setStatisticsSampleInterval(globalContext()->uint32_values_->
+                                     getOptionalParam("statistics-sample-interval",
+                                                      0));
+    cfg->setStatisticsMaxSamples(globalContext()->uint32_values_->
+                                 getOptionalParam("statistics-max-samples",
+                                                  SrvConfig::DEFAULT_STATISTICS_MAX_SAMPLES));
+
+    // Enable recording of the time spent in the packet processing stages.
+    cfg->setLatencyHistograms(globalContext()->boolean_values_->
+                              getOptionalParam("latency-histograms", false));
+
+    // Create the options of the received packets when they are retrieved.
+    cfg->setLazyOptionParsing(globalContext()->boolean_values_->
+                              getOptionalParam("lazy-option-parsing", false));
+
+    // Select the allocator picking the addresses for new leases.
+    cfg->setAllocator(globalContext()->string_values_->
+                      getOptionalParam("allocator", "iterative"));
 }
 
 isc::data::ConstElementPtr
@@ -1102,6 +1102,43 @@ TEST_F(Dhcp4ParserTest, echoClientId) {
     CfgMgr::instance().echoClientId(true);
 }
 
+// Check that the allocator can be selected and that it is iterative by
+// default.
+TEST_F(Dhcp4ParserTest, allocator) {
+
+    ConstElementPtr status;
+
+    string config_begin = "{ " + genIfaceConfig() + "," +
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, ";
+    string config_end =
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"192.0.2.1 - 192.0.2.100\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\" } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    ElementPtr json = Element::fromJSON(config_begin + config_end);
+    EXPECT_NO_THROW(status = configureDhcp4Server(*srv_, json));
+    checkResult(status, 0);
+    EXPECT_EQ("iterative", CfgMgr::instance().getStagingCfg()->getAllocator());
+
+    CfgMgr::instance().clear();
+
+    json = Element::fromJSON(config_begin + "\"allocator\": \"bitmap\", " +
+                             config_end);
+    EXPECT_NO_THROW(status = configureDhcp4Server(*srv_, json));
+    checkResult(status, 0);
+    EXPECT_EQ("bitmap", CfgMgr::instance().getStagingCfg()->getAllocator());
+
+    CfgMgr::instance().clear();
+
+    // The unsupported allocator is rejected.
+    json = Element::fromJSON(config_begin + "\"allocator\": \"random\", " +
+                             config_end);
+    EXPECT_NO_THROW(status = configureDhcp4Server(*srv_, json));
+    checkResult(status, 2);
+}
+
 // This test checks if it is possible to override global values
 // on a per subnet basis.
 TEST_F(Dhcp4ParserTest, subnetLocal) {
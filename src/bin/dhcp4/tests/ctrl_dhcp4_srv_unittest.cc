@@ -16,7 +16,9 @@
 
 #include <config/ccsession.h>
 #include <dhcp/dhcp4.h>
+#include <dhcp/pkt4.h>
 #include <dhcp4/ctrl_dhcp4_srv.h>
+#include <dhcpsrv/stats_mgr.h>
 #include <hooks/hooks_manager.h>
 
 #include "marker_file.h"
@@ -156,4 +158,125 @@ TEST_F(CtrlDhcpv4SrvTest, libreload) {
     EXPECT_TRUE(checkMarkerFile(LOAD_MARKER_FILE, "1212"));
 }
 
+// Check that the statistic commands return and reset the statistics.
+TEST_F(CtrlDhcpv4SrvTest, statistics) {
+    boost::scoped_ptr<ControlledDhcpv4Srv> srv;
+    ASSERT_NO_THROW(
+        srv.reset(new ControlledDhcpv4Srv(0))
+    );
+
+    // The server creates the packet statistics when it starts.
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    stats_mgr.resetAll();
+    stats_mgr.addValue("pkt4-received", 5);
+    stats_mgr.setValue("subnet[1].assigned-addresses", 10);
+
+    ElementPtr params = Element::createMap();
+    params->set("name", Element::create("pkt4-received"));
+
+    // Get a single statistic.
+    int rcode = -1;
+    ConstElementPtr result =
+        ControlledDhcpv4Srv::processCommand("statistic-get", params);
+    ConstElementPtr stats = parseAnswer(rcode, result);
+    ASSERT_EQ(0, rcode);
+    ASSERT_TRUE(stats);
+    ASSERT_EQ(1, stats->mapValue().size());
+    ConstElementPtr stat = stats->get("pkt4-received");
+    ASSERT_TRUE(stat);
+    ASSERT_EQ(1, stat->size());
+    EXPECT_EQ(5, stat->get(0)->get(0)->intValue());
+
+    // Getting a statistic which doesn't exist returns an empty map.
+    params->set("name", Element::create("no-such-statistic"));
+    result = ControlledDhcpv4Srv::processCommand("statistic-get", params);
+    stats = parseAnswer(rcode, result);
+    EXPECT_EQ(0, rcode);
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(0, stats->mapValue().size());
+
+    // The name is mandatory.
+    result = ControlledDhcpv4Srv::processCommand("statistic-get",
+                                                 Element::createMap());
+    parseAnswer(rcode, result);
+    EXPECT_EQ(1, rcode);
+
+    // Get all statistics.
+    result = ControlledDhcpv4Srv::processCommand("statistic-get-all",
+                                                 Element::createMap());
+    stats = parseAnswer(rcode, result);
+    ASSERT_EQ(0, rcode);
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats_mgr.count(), stats->mapValue().size());
+    ASSERT_TRUE(stats->get("subnet[1].assigned-addresses"));
+    EXPECT_EQ(10, stats->get("subnet[1].assigned-addresses")->get(0)->
+              get(0)->intValue());
+
+    // Reset a single statistic.
+    params->set("name", Element::create("pkt4-received"));
+    result = ControlledDhcpv4Srv::processCommand("statistic-reset", params);
+    parseAnswer(rcode, result);
+    EXPECT_EQ(0, rcode);
+    EXPECT_EQ(0, stats_mgr.getCounter("pkt4-received")->getValue());
+
+    // Resetting a statistic which doesn't exist fails.
+    params->set("name", Element::create("no-such-statistic"));
+    result = ControlledDhcpv4Srv::processCommand("statistic-reset", params);
+    parseAnswer(rcode, result);
+    EXPECT_EQ(1, rcode);
+
+    // Reset all statistics. The gauges retain their values.
+    stats_mgr.addValue("pkt4-received", 3);
+    result = ControlledDhcpv4Srv::processCommand("statistic-reset-all",
+                                                 Element::createMap());
+    parseAnswer(rcode, result);
+    EXPECT_EQ(0, rcode);
+    EXPECT_EQ(0, stats_mgr.getCounter("pkt4-received")->getValue());
+    EXPECT_EQ(10, stats_mgr.getCounter("subnet[1].assigned-addresses")->
+              getValue());
+
+    stats_mgr.remove("subnet[1].assigned-addresses");
+}
+
+// Check that the latency commands return and reset the histograms.
+TEST_F(CtrlDhcpv4SrvTest, latency) {
+    boost::scoped_ptr<ControlledDhcpv4Srv> srv;
+    ASSERT_NO_THROW(
+        srv.reset(new ControlledDhcpv4Srv(0))
+    );
+
+    // Record the times of a processed packet.
+    Pkt4 pkt(DHCPDISCOVER, 1234);
+    pkt.updateTimestamp();
+    pkt.enableStageTimes(PacketLatencyStats::NUM_STAGES);
+    pkt.setStageTime(PacketLatencyStats::RECEIVE);
+    srv->getLatencyStats().record(DHCPDISCOVER, pkt);
+
+    int rcode = -1;
+    ConstElementPtr result =
+        ControlledDhcpv4Srv::processCommand("latency-get",
+                                            Element::createMap());
+    ConstElementPtr latency = parseAnswer(rcode, result);
+    ASSERT_EQ(0, rcode);
+    ASSERT_TRUE(latency);
+    ASSERT_EQ(1, latency->mapValue().size());
+    ConstElementPtr discover = latency->get("DHCPDISCOVER");
+    ASSERT_TRUE(discover);
+    ASSERT_TRUE(discover->get("receive"));
+    ASSERT_TRUE(discover->get("total"));
+    EXPECT_EQ(1, discover->get("total")->get("count")->intValue());
+
+    result = ControlledDhcpv4Srv::processCommand("latency-reset",
+                                                 Element::createMap());
+    parseAnswer(rcode, result);
+    EXPECT_EQ(0, rcode);
+
+    result = ControlledDhcpv4Srv::processCommand("latency-get",
+                                                 Element::createMap());
+    latency = parseAnswer(rcode, result);
+    ASSERT_EQ(0, rcode);
+    ASSERT_TRUE(latency);
+    EXPECT_EQ(0, latency->mapValue().size());
+}
+
 } // End of anonymous namespace
@@ -47,6 +47,7 @@
 #include <boost/scoped_ptr.hpp>
 
 #include <iostream>
+#include <set>
 
 #include <arpa/inet.h>
 
@@ -1106,6 +1107,179 @@ TEST_F(Dhcpv4SrvTest, ReleaseReject) {
     EXPECT_FALSE(l);
 }
 
+// Checks that the server processes packets using multiple threads when
+// the thread-pool-size is configured.
+TEST_F(Dhcpv4SrvTest, threadPool) {
+    IfaceMgrTestConfig test_config(true);
+    IfaceMgr::instance().openSockets4();
+
+    NakedDhcpv4Srv srv(0);
+
+    std::string config = "{ \"interfaces-config\": {"
+        "    \"interfaces\": [ \"*\" ]"
+        "},"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"thread-pool-size\": 4, "
+        "\"packet-queue-size\": 100, "
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"192.0.2.10 - 192.0.2.200\" } ],"
+        "    \"subnet\": \"192.0.2.0/24\", "
+        "    \"interface\": \"eth1\" "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    configure(config, srv);
+
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    EXPECT_EQ(4, cfg->getThreadPoolSize());
+    EXPECT_EQ(100, cfg->getPacketQueueSize());
+
+    // Simulate reception of DHCPDISCOVERs from different clients. The
+    // packets are created from the wire data because the server is
+    // going to parse them.
+    const int num_clients = 50;
+    for (int i = 0; i < num_clients; ++i) {
+        Pkt4 dis(DHCPDISCOVER, 1234 + i);
+        std::vector<uint8_t> mac(6, 0);
+        mac[5] = static_cast<uint8_t>(i);
+        dis.setHWAddr(HTYPE_ETHER, mac.size(), mac);
+        ASSERT_NO_THROW(dis.pack());
+
+        const isc::util::OutputBuffer& buf = dis.getBuffer();
+        Pkt4Ptr query(new Pkt4(static_cast<const uint8_t*>(buf.getData()),
+                               buf.getLength()));
+        query->setIface("eth1");
+        srv.fakeReceive(query);
+    }
+
+    // Process all packets. The run() returns when all worker threads
+    // have processed their packets.
+    srv.run();
+
+    // Each client should have been offered a different address from the
+    // configured pool.
+    ASSERT_EQ(num_clients, srv.fake_sent_.size());
+    const Subnet4Collection* subnets = cfg->getCfgSubnets4()->getAll();
+    ASSERT_EQ(1, subnets->size());
+    std::set<IOAddress> offered;
+    for (std::list<Pkt4Ptr>::const_iterator offer = srv.fake_sent_.begin();
+         offer != srv.fake_sent_.end(); ++offer) {
+        ASSERT_EQ(DHCPOFFER, (*offer)->getType());
+        EXPECT_TRUE((*subnets)[0]->inPool(Lease::TYPE_V4,
+                                          (*offer)->getYiaddr()));
+        offered.insert((*offer)->getYiaddr());
+    }
+    EXPECT_EQ(num_clients, offered.size());
+}
+
+// Checks that the time spent in the processing stages is recorded when
+// the latency histograms are enabled.
+TEST_F(Dhcpv4SrvTest, latencyHistograms) {
+    IfaceMgrTestConfig test_config(true);
+    IfaceMgr::instance().openSockets4();
+
+    NakedDhcpv4Srv srv(0);
+
+    std::string config = "{ \"interfaces-config\": {"
+        "    \"interfaces\": [ \"*\" ]"
+        "},"
+        "\"latency-histograms\": true, "
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"10.254.226.0/25\" } ],"
+        "    \"subnet\": \"10.254.226.0/24\", "
+        "    \"interface\": \"eth0\" "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    configure(config);
+    ASSERT_TRUE(CfgMgr::instance().getCurrentCfg()->getLatencyHistograms());
+
+    Pkt4Ptr dis;
+    ASSERT_NO_THROW(dis = PktCaptures::captureRelayedDiscover());
+    dis->updateTimestamp();
+    srv.fakeReceive(dis);
+    srv.run();
+    ASSERT_EQ(1, srv.fake_sent_.size());
+
+    // All stages have been completed by the packet.
+    PacketLatencyStats& stats = srv.getLatencyStats();
+    for (int stage = 0; stage <= PacketLatencyStats::NUM_STAGES; ++stage) {
+        EXPECT_EQ(1, stats.getHistogram(DHCPDISCOVER,
+                                        static_cast<PacketLatencyStats::Stage>(stage)).
+                  getCount()) << "stage " << stage;
+    }
+    EXPECT_EQ(0, stats.getHistogram(DHCPREQUEST,
+                                    PacketLatencyStats::NUM_STAGES).getCount());
+}
+
+// Checks that the server creates the options of the received packets
+// when they are retrieved if the lazy-option-parsing is enabled, so as
+// a malformed option which the server doesn't use doesn't cause the
+// packet to be dropped.
+TEST_F(Dhcpv4SrvTest, lazyOptionParsing) {
+    IfaceMgrTestConfig test_config(true);
+    IfaceMgr::instance().openSockets4();
+
+    NakedDhcpv4Srv srv(0);
+
+    const std::string config_begin = "{ \"interfaces-config\": {"
+        "    \"interfaces\": [ \"*\" ]"
+        "},"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, ";
+    const std::string config_end = "\"subnet4\": [ { "
+        "    \"pools\": [ { \"pool\": \"10.254.226.0/25\" } ],"
+        "    \"subnet\": \"10.254.226.0/24\", "
+        "    \"interface\": \"eth0\" "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    configure(config_begin + "\"lazy-option-parsing\": true, " + config_end);
+    ASSERT_TRUE(CfgMgr::instance().getCurrentCfg()->getLazyOptionParsing());
+
+    // The DOCSIS modem's DISCOVER carries vendor specific information,
+    // which the server doesn't use.
+    Pkt4Ptr dis;
+    ASSERT_NO_THROW(dis = PktCaptures::captureRelayedDiscover());
+    srv.fakeReceive(dis);
+    srv.run();
+    ASSERT_EQ(1, srv.fake_sent_.size());
+    EXPECT_EQ(DHCPOFFER, srv.fake_sent_.front()->getType());
+    EXPECT_TRUE(dis->getLazyUnpack());
+    EXPECT_EQ(0, dis->options_.count(DHO_VENDOR_ENCAPSULATED_OPTIONS));
+    EXPECT_TRUE(dis->getOption(DHO_VENDOR_ENCAPSULATED_OPTIONS));
+
+    // Insert the time offset option, which is malformed because it should
+    // be 4 bytes long, before the END option.
+    const uint8_t time_offset[] = { DHO_TIME_OFFSET, 2, 0, 0 };
+    ASSERT_NO_THROW(dis = PktCaptures::captureRelayedDiscover());
+    ASSERT_EQ(DHO_END, dis->data_.back());
+    dis->data_.insert(dis->data_.end() - 1, time_offset,
+                      time_offset + sizeof(time_offset));
+    const std::vector<uint8_t> malformed = dis->data_;
+
+    srv.fake_sent_.clear();
+    srv.fakeReceive(dis);
+    srv.run();
+    ASSERT_EQ(1, srv.fake_sent_.size());
+    EXPECT_EQ(DHCPOFFER, srv.fake_sent_.front()->getType());
+    EXPECT_THROW(dis->getOption(DHO_TIME_OFFSET), InvalidOptionValue);
+
+    // When the options are parsed at once, the packet is dropped.
+    configure(config_begin + config_end);
+    ASSERT_FALSE(CfgMgr::instance().getCurrentCfg()->getLazyOptionParsing());
+
+    ASSERT_NO_THROW(dis = PktCaptures::captureRelayedDiscover());
+    dis->data_ = malformed;
+    srv.fake_sent_.clear();
+    srv.fakeReceive(dis);
+    srv.run();
+    EXPECT_TRUE(srv.fake_sent_.empty());
+}
+
 // Checks if received relay agent info option is echoed back to the client
 TEST_F(Dhcpv4SrvTest, relayAgentInfoEcho) {
     IfaceMgrTestConfig test_config(true);
@@ -31,6 +31,7 @@
 #include <dhcp4/dhcp4_srv.h>
 #include <asiolink/io_address.h>
 #include <config/ccsession.h>
+#include <util/threads/sync.h>
 #include <list>
 
 #include <boost/shared_ptr.hpp>
@@ -154,11 +155,26 @@ public:
         return (Pkt4Ptr());
     }
 
+    /// @brief fakes reception of the packets received together
+    /// @param timeout passed to receivePacket
+    /// @param [out] queries Collection to which the packet is appended.
+    ///
+    /// Receives a single packet with @c receivePacket, so as the packets
+    /// are processed one after another.
+    virtual void receivePackets(int timeout, Pkt4Collection& queries) {
+        Pkt4Ptr pkt = receivePacket(timeout);
+        if (pkt) {
+            queries.push_back(pkt);
+        }
+    }
+
     /// @brief fake packet sending
     ///
     /// Pretend to send a packet, but instead just store it in fake_send_ list
-    /// where test can later inspect server's response.
+    /// where test can later inspect server's response. The packets may be
+    /// sent by multiple threads, so access to the list is serialized.
     virtual void sendPacket(const Pkt4Ptr& pkt) {
+        isc::util::thread::Mutex::Locker locker(fake_sent_mutex_);
         fake_sent_.push_back(pkt);
     }
 
@@ -185,6 +201,9 @@ public:
 
     std::list<Pkt4Ptr> fake_sent_;
 
+    /// @brief Mutex protecting the list of sent packets.
+    isc::util::thread::Mutex fake_sent_mutex_;
+
     using Dhcpv4Srv::adjustIfaceData;
     using Dhcpv4Srv::appendServerID;
     using Dhcpv4Srv::processDiscover;
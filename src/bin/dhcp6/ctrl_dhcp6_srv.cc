@@ -65,6 +65,17 @@ ControlledDhcpv6Srv::commandConfigReloadHandler(const string&, ConstElementPtr a
     return (processConfig(args));
 }
 
+ConstElementPtr
+ControlledDhcpv6Srv::commandLatencyGetHandler(const string&, ConstElementPtr) {
+    return (isc::config::createAnswer(0, getLatencyStats().toElement()));
+}
+
+ConstElementPtr
+ControlledDhcpv6Srv::commandLatencyResetHandler(const string&, ConstElementPtr) {
+    getLatencyStats().reset();
+    return (isc::config::createAnswer(0, "Latency histograms reset."));
+}
+
 isc::data::ConstElementPtr
 ControlledDhcpv6Srv::processCommand(const std::string& command,
                                     isc::data::ConstElementPtr args) {
@@ -89,6 +100,12 @@ ControlledDhcpv6Srv::processCommand(const std::string& command,
 
         } else if (command == "config-reload") {
             return (srv->commandConfigReloadHandler(command, args));
+
+        } else if (command == "latency-get") {
+            return (srv->commandLatencyGetHandler(command, args));
+
+        } else if (command == "latency-reset") {
+            return (srv->commandLatencyResetHandler(command, args));
         }
 
         return (isc::config::createAnswer(1, "Unrecognized command:"
@@ -114,6 +131,11 @@ ControlledDhcpv6Srv::processConfig(isc::data::ConstElementPtr config) {
         return (no_srv);
     }
 
+    // The worker threads use the current configuration and the lease
+    // database, so let them finish processing queued packets before
+    // these are replaced.
+    srv->thread_pool_.wait();
+
     ConstElementPtr answer = configureDhcp6Server(*srv, config);
 
     // Check that configuration was successful. If not, do not reopen sockets
@@ -80,6 +80,8 @@ public:
     /// - shutdown
     /// - libreload
     /// - config-reload
+    /// - latency-get
+    /// - latency-reset
     ///
     /// @note It never throws.
     ///
@@ -128,9 +130,6 @@ protected:
     /// sender if the backend is JSON file).
     static void sessionReader(void);
 
-    /// @brief IOService object, used for all ASIO operations.
-    isc::asiolink::IOService io_service_;
-
     /// @brief handler for processing 'shutdown' command
     ///
     /// This handler processes shutdown command, which initializes shutdown
@@ -168,6 +167,34 @@ protected:
     isc::data::ConstElementPtr
     commandConfigReloadHandler(const std::string& command,
                                isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'latency-get' command
+    ///
+    /// This handler returns the summaries of the histograms of the time
+    /// spent by the packets in the processing stages, by the message type.
+    /// The histograms are updated when the latency-histograms parameter is
+    /// enabled.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command with the histograms
+    isc::data::ConstElementPtr
+    commandLatencyGetHandler(const std::string& command,
+                             isc::data::ConstElementPtr args);
+
+    /// @brief Handler for processing 'latency-reset' command
+    ///
+    /// This handler removes the values recorded in the histograms of the
+    /// time spent by the packets in the processing stages.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command
+    isc::data::ConstElementPtr
+    commandLatencyResetHandler(const std::string& command,
+                               isc::data::ConstElementPtr args);
 };
 
 }; // namespace isc::dhcp
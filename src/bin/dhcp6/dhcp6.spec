@@ -62,6 +62,42 @@
         "item_default": 4000
       },
 
+      { "item_name": "thread-pool-size",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 0
+      },
+
+      { "item_name": "packet-queue-size",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 64
+      },
+
+      { "item_name": "reclaim-timer-wait-time",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 0
+      },
+
+      { "item_name": "max-reclaim-leases",
+        "item_type": "integer",
+        "item_optional": true,
+        "item_default": 100
+      },
+
+      { "item_name": "latency-histograms",
+        "item_type": "boolean",
+        "item_optional": true,
+        "item_default": false
+      },
+
+      { "item_name": "lazy-option-parsing",
+        "item_type": "boolean",
+        "item_optional": true,
+        "item_default": false
+      },
+
       { "item_name": "option-def",
         "item_type": "list",
         "item_optional": false,
@@ -205,6 +241,48 @@
                 "item_type": "integer",
                 "item_optional": true,
                 "item_default": 0
+            },
+            {
+                "item_name": "lfc-incremental",
+                "item_type": "boolean",
+                "item_optional": true,
+                "item_default": false
+            },
+            {
+                "item_name": "file-format",
+                "item_type": "string",
+                "item_optional": true,
+                "item_default": "csv"
+            },
+            {
+                "item_name": "sync-policy",
+                "item_type": "string",
+                "item_optional": true,
+                "item_default": "none"
+            },
+            {
+                "item_name": "sync-interval",
+                "item_type": "integer",
+                "item_optional": true,
+                "item_default": 2
+            },
+            {
+                "item_name": "sync-leases",
+                "item_type": "integer",
+                "item_optional": true,
+                "item_default": 64
+            },
+            {
+                "item_name": "write-behind",
+                "item_type": "boolean",
+                "item_optional": true,
+                "item_default": false
+            },
+            {
+                "item_name": "connections",
+                "item_type": "integer",
+                "item_optional": true,
+                "item_default": 1
             }
         ]
       },
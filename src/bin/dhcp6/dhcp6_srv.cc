@@ -114,7 +114,8 @@ const std::string Dhcpv6Srv::VENDOR_CLASS_PREFIX("VENDOR_CLASS_");
 static const char* SERVER_DUID_FILE = "kea-dhcp6-serverid";
 
 Dhcpv6Srv::Dhcpv6Srv(uint16_t port)
-:alloc_engine_(), serverid_(), port_(port), shutdown_(true)
+:alloc_engine_(), serverid_(), port_(port), shutdown_(true),
+ reclaim_timer_(io_service_)
 {
 
     LOG_DEBUG(dhcp6_logger, DBG_DHCP6_START, DHCP6_OPEN_SOCKET).arg(port);
@@ -149,6 +150,17 @@ Dhcpv6Srv::Dhcpv6Srv(uint16_t port)
         // Instantiate allocation engine
         alloc_engine_.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 100));
 
+        PacketLatencyStats::TypeNames latency_types;
+        latency_types[DHCPV6_SOLICIT] = "SOLICIT";
+        latency_types[DHCPV6_REQUEST] = "REQUEST";
+        latency_types[DHCPV6_RENEW] = "RENEW";
+        latency_types[DHCPV6_REBIND] = "REBIND";
+        latency_types[DHCPV6_CONFIRM] = "CONFIRM";
+        latency_types[DHCPV6_RELEASE] = "RELEASE";
+        latency_types[DHCPV6_DECLINE] = "DECLINE";
+        latency_types[DHCPV6_INFORMATION_REQUEST] = "INFORMATION_REQUEST";
+        latency_stats_.reset(new PacketLatencyStats(latency_types));
+
         /// @todo call loadLibraries() when handling configuration changes
 
     } catch (const std::exception &e) {
@@ -161,6 +173,7 @@ Dhcpv6Srv::Dhcpv6Srv(uint16_t port)
 }
 
 Dhcpv6Srv::~Dhcpv6Srv() {
+    stopThreadPool();
     IfaceMgr::instance().closeSockets();
 
     LeaseMgrFactory::destroy();
@@ -175,6 +188,10 @@ Pkt6Ptr Dhcpv6Srv::receivePacket(int timeout) {
     return (IfaceMgr::instance().receive6(timeout));
 }
 
+void Dhcpv6Srv::receivePackets(int timeout, Pkt6Collection& queries) {
+    IfaceMgr::instance().receive6Batch(queries, RECEIVE_BATCH_SIZE, timeout);
+}
+
 void Dhcpv6Srv::sendPacket(const Pkt6Ptr& packet) {
     IfaceMgr::instance().send(packet);
 }
@@ -226,9 +243,8 @@ Dhcpv6Srv::testUnicast(const Pkt6Ptr& pkt) const {
 
 bool Dhcpv6Srv::run() {
     while (!shutdown_) {
-        // client's message and server's response
-        Pkt6Ptr query;
-        Pkt6Ptr rsp;
+        // clients' messages
+        Pkt6Collection queries;
 
         try {
             // The lease database backend may install some timers for which
@@ -241,7 +257,13 @@ bool Dhcpv6Srv::run() {
             if (timeout == 0) {
                 timeout = 1000;
             }
-            query = receivePacket(timeout);
+            // Wake up in time to reclaim expired leases.
+            uint32_t reclaim_wait_time = CfgMgr::instance().getCurrentCfg()->
+                getReclaimTimerWaitTime();
+            if ((reclaim_wait_time > 0) && (reclaim_wait_time < timeout)) {
+                timeout = reclaim_wait_time;
+            }
+            receivePackets(timeout, queries);
 
         } catch (const SignalInterruptOnSelect) {
             // Packet reception interrupted because a signal has been received.
@@ -265,6 +287,19 @@ bool Dhcpv6Srv::run() {
         // terminate.
         handleSignal();
 
+        // The configuration may have been changed as a result of handling
+        // the signal, so make sure that the number of worker threads
+        // matches the current configuration.
+        updateThreadPool();
+        updateReclaimTimer();
+
+        // Execute ready timers, e.g. the reclamation of expired leases.
+        // The IOService is only polled when there is a timer, because
+        // polling it without pending work stops it.
+        if (reclaim_timer_.getInterval() > 0) {
+            io_service_.poll();
+        }
+
         // Execute ready timers for the lease database, e.g. Lease File Cleanup.
         try {
             LeaseMgrFactory::instance().getIOService()->poll();
@@ -276,289 +311,506 @@ bool Dhcpv6Srv::run() {
 
         // Timeout may be reached or signal received, which breaks select()
         // with no packet received
-        if (!query) {
+        if (queries.empty()) {
             continue;
         }
 
-        // In order to parse the DHCP options, the server needs to use some
-        // configuration information such as: existing option spaces, option
-        // definitions etc. This is the kind of information which is not
-        // available in the libdhcp, so we need to supply our own implementation
-        // of the option parsing function here, which would rely on the
-        // configuration data.
-        query->setCallback(boost::bind(&Dhcpv6Srv::unpackOptions, this, _1, _2,
-                                       _3, _4, _5));
+        for (Pkt6Collection::iterator query = queries.begin();
+             query != queries.end(); ++query) {
+            // If the thread pool is running, the packet is processed by one
+            // of the worker threads. The packets sent by the same client are
+            // processed in the order in which they have been received. If the
+            // queue is full, the packet is dropped and the client will
+            // retransmit it.
+            if (thread_pool_.isRunning()) {
+                if (!thread_pool_.add(boost::bind(&Dhcpv6Srv::processPacket,
+                                                  this, *query),
+                                      getClientKey(*query))) {
+                    LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL,
+                              DHCP6_PACKET_QUEUE_FULL)
+                        .arg(thread_pool_.getQueueSize());
+                }
 
-        bool skip_unpack = false;
+            } else {
+                processPacket(*query);
+            }
+        }
+    }
 
-        // The packet has just been received so contains the uninterpreted wire
-        // data; execute callouts registered for buffer6_receive.
-        if (HooksManager::calloutsPresent(Hooks.hook_index_buffer6_receive_)) {
-            CalloutHandlePtr callout_handle = getCalloutHandle(query);
+    // Don't leave the worker threads running when the server is shut down.
+    stopThreadPool();
 
-            // Delete previously set arguments
-            callout_handle->deleteAllArguments();
+    return (true);
+}
 
-            // Pass incoming packet as argument
-            callout_handle->setArgument("query6", query);
 
-            // Call callouts
-            HooksManager::callCallouts(Hooks.hook_index_buffer6_receive_, *callout_handle);
+void
+Dhcpv6Srv::updateThreadPool() {
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    size_t thread_count = cfg->getThreadPoolSize();
+    size_t queue_size = cfg->getPacketQueueSize();
+
+    // Nothing to do if the pool already runs with the configured parameters.
+    if ((thread_count == thread_pool_.getThreadCount()) &&
+        ((thread_count == 0) || (queue_size == thread_pool_.getQueueSize()))) {
+        return;
+    }
+
+    stopThreadPool();
 
-            // Callouts decided to skip the next processing step. The next
-            // processing step would to parse the packet, so skip at this
-            // stage means that callouts did the parsing already, so server
-            // should skip parsing.
-            if (callout_handle->getSkip()) {
-                LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_BUFFER_RCVD_SKIP);
-                skip_unpack = true;
-            }
+    if (thread_count > 0) {
+        try {
+            thread_pool_.start(thread_count, queue_size);
+            LOG_INFO(dhcp6_logger, DHCP6_THREAD_POOL_STARTED)
+                .arg(thread_count).arg(queue_size);
 
-            callout_handle->getArgument("query6", query);
+        } catch (const std::exception& ex) {
+            // Fall back to processing packets on the main thread.
+            LOG_ERROR(dhcp6_logger, DHCP6_THREAD_POOL_START_FAIL)
+                .arg(ex.what());
+            stopThreadPool();
         }
+    }
+}
 
-        // Unpack the packet information unless the buffer6_receive callouts
-        // indicated they did it
-        if (!skip_unpack) {
-            try {
-                query->unpack();
-            } catch (const std::exception &e) {
-                LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL,
-                          DHCP6_PACKET_PARSE_FAIL).arg(e.what());
-                continue;
+void
+Dhcpv6Srv::updateReclaimTimer() {
+    const long interval = static_cast<long>(CfgMgr::instance().getCurrentCfg()->
+                                            getReclaimTimerWaitTime()) * 1000;
+    if (interval == reclaim_timer_.getInterval()) {
+        return;
+    }
+
+    if (interval == 0) {
+        reclaim_timer_.cancel();
+    } else {
+        reclaim_timer_.setup(boost::bind(&Dhcpv6Srv::reclaimExpiredLeases,
+                                         this), interval);
+    }
+}
+
+void
+Dhcpv6Srv::reclaimExpiredLeases() {
+    if (!alloc_engine_) {
+        return;
+    }
+
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    try {
+        Lease6Collection leases = alloc_engine_->
+            reclaimExpiredLeases6(cfg->getMaxReclaimLeases());
+        for (Lease6Collection::const_iterator lease = leases.begin();
+             lease != leases.end(); ++lease) {
+            // Remove existing DNS entries for the lease, if any.
+            createRemovalNameChangeRequest(*lease);
+        }
+        if (!leases.empty()) {
+            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_LEASES_RECLAIMED)
+                .arg(leases.size());
+        }
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcp6_logger, DHCP6_LEASES_RECLAIM_FAIL).arg(ex.what());
+    }
+}
+
+void
+Dhcpv6Srv::stopThreadPool() {
+    if (thread_pool_.isRunning()) {
+        // Let the worker threads complete processing of the queued packets.
+        thread_pool_.wait();
+        thread_pool_.stop();
+        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_START, DHCP6_THREAD_POOL_STOPPED);
+    }
+}
+
+std::string
+Dhcpv6Srv::getClientKey(const Pkt6Ptr& query) {
+    const OptionBuffer& data = query->data_;
+    if (data.empty()) {
+        return (std::string());
+    }
+
+    // Relayed messages carry the client's message in the Relay Message
+    // option, possibly nested in further relay messages. Locate the
+    // innermost client message without parsing the packet.
+    size_t begin = 0;
+    size_t end = data.size();
+    while ((end - begin > Pkt6::DHCPV6_RELAY_HDR_LEN) &&
+           (data[begin] == DHCPV6_RELAY_FORW)) {
+        size_t offset = begin + Pkt6::DHCPV6_RELAY_HDR_LEN;
+        bool found = false;
+        while (offset + 4 <= end) {
+            uint16_t code = readUint16(&data[offset], end - offset);
+            size_t len = readUint16(&data[offset + 2], end - offset - 2);
+            offset += 4;
+            if (offset + len > end) {
+                return (std::string());
             }
+            if (code == D6O_RELAY_MSG) {
+                begin = offset;
+                end = offset + len;
+                found = true;
+                break;
+            }
+            offset += len;
+        }
+        if (!found) {
+            return (std::string());
+        }
+    }
+
+    if ((end - begin <= Pkt6::DHCPV6_PKT_HDR_LEN) ||
+        (data[begin] == DHCPV6_RELAY_FORW)) {
+        return (std::string());
+    }
+
+    // Find the Client Identifier option in the client's message.
+    size_t offset = begin + Pkt6::DHCPV6_PKT_HDR_LEN;
+    while (offset + 4 <= end) {
+        uint16_t code = readUint16(&data[offset], end - offset);
+        size_t len = readUint16(&data[offset + 2], end - offset - 2);
+        offset += 4;
+        if (offset + len > end) {
+            break;
         }
+        if (code == D6O_CLIENTID) {
+            return (std::string(data.begin() + offset,
+                                data.begin() + offset + len));
+        }
+        offset += len;
+    }
+    return (std::string());
+}
+
+void
+Dhcpv6Srv::processPacket(Pkt6Ptr& query) {
+    Pkt6Ptr rsp;
+
+    // If enabled, record the times at which the packet completes the
+    // processing stages. They are recorded in the histograms when this
+    // method returns.
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    PacketLatencyStats* latency_stats = NULL;
+    if (cfg->getLatencyHistograms()) {
+        query->enableStageTimes(PacketLatencyStats::NUM_STAGES);
+        query->setStageTime(PacketLatencyStats::RECEIVE);
+        latency_stats = latency_stats_.get();
+    }
+    PacketLatencyRecorder<Pkt6Ptr> latency_recorder(latency_stats, query);
+
+    // In order to parse the DHCP options, the server needs to use some
+    // configuration information such as: existing option spaces, option
+    // definitions etc. This is the kind of information which is not
+    // available in the libdhcp, so we need to supply our own implementation
+    // of the option parsing function here, which would rely on the
+    // configuration data.
+    query->setCallback(boost::bind(&Dhcpv6Srv::unpackOptions, this, _1, _2,
+                                   _3, _4, _5));
+
+    // If enabled, the options are only located when the packet is unpacked.
+    // The options of the relays are always created, and the options of the
+    // client's message are created by the callback when they are retrieved.
+    query->setLazyUnpack(cfg->getLazyOptionParsing());
+
+    bool skip_unpack = false;
+
+    // The packet has just been received so contains the uninterpreted wire
+    // data; execute callouts registered for buffer6_receive.
+    if (HooksManager::calloutsPresent(Hooks.hook_index_buffer6_receive_)) {
+        CalloutHandlePtr callout_handle = getCalloutHandle(query);
+
+        // Delete previously set arguments
+        callout_handle->deleteAllArguments();
+
+        // Pass incoming packet as argument
+        callout_handle->setArgument("query6", query);
+
+        // Call callouts
+        HooksManager::callCallouts(Hooks.hook_index_buffer6_receive_, *callout_handle);
+
+        // Callouts decided to skip the next processing step. The next
+        // processing step would to parse the packet, so skip at this
+        // stage means that callouts did the parsing already, so server
+        // should skip parsing.
+        if (callout_handle->getSkip()) {
+            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_BUFFER_RCVD_SKIP);
+            skip_unpack = true;
+        }
+
+        callout_handle->getArgument("query6", query);
+    }
+
+    // Unpack the packet information unless the buffer6_receive callouts
+    // indicated they did it
+    if (!skip_unpack) {
+        try {
+            query->unpack();
+        } catch (const std::exception &e) {
+            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL,
+                      DHCP6_PACKET_PARSE_FAIL).arg(e.what());
+            return;
+        }
+    }
+    query->setStageTime(PacketLatencyStats::UNPACK);
+
+    try {
         // Check if received query carries server identifier matching
         // server identifier being used by the server.
         if (!testServerID(query)) {
-            continue;
+            return;
         }
 
-        // Check if the received query has been sent to unicast or multicast.
-        // The Solicit, Confirm, Rebind and Information Request will be
-        // discarded if sent to unicast address.
+        // Check if the received query has been sent to unicast or
+        // multicast. The Solicit, Confirm, Rebind and Information Request
+        // will be discarded if sent to unicast address.
         if (!testUnicast(query)) {
-            continue;
+            return;
         }
 
-        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL, DHCP6_PACKET_RECEIVED)
-            .arg(query->getName());
-        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA, DHCP6_QUERY_DATA)
-            .arg(static_cast<int>(query->getType()))
-            .arg(query->getBuffer().getLength())
-            .arg(query->toText());
-
-        // At this point the information in the packet has been unpacked into
-        // the various packet fields and option objects has been cretated.
-        // Execute callouts registered for packet6_receive.
+        // The pkt6_receive callouts get the query with all options created,
+        // as if the options weren't parsed lazily.
         if (HooksManager::calloutsPresent(Hooks.hook_index_pkt6_receive_)) {
-            CalloutHandlePtr callout_handle = getCalloutHandle(query);
+            query->materializeOptions();
+        }
 
-            // Delete previously set arguments
-            callout_handle->deleteAllArguments();
+    } catch (const std::exception& e) {
+        // When the options are parsed lazily, a malformed option is found
+        // when it is first retrieved rather than by unpack().
+        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL,
+                  DHCP6_PACKET_PARSE_FAIL).arg(e.what());
+        return;
+    }
+    query->setStageTime(PacketLatencyStats::ACCEPT);
+    latency_recorder.setType(query->getType());
 
-            // Pass incoming packet as argument
-            callout_handle->setArgument("query6", query);
+    LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL, DHCP6_PACKET_RECEIVED)
+        .arg(query->getName());
+    LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA, DHCP6_QUERY_DATA)
+        .arg(static_cast<int>(query->getType()))
+        .arg(query->getBuffer().getLength())
+        .arg(query->toText());
 
-            // Call callouts
-            HooksManager::callCallouts(Hooks.hook_index_pkt6_receive_, *callout_handle);
+    // At this point the information in the packet has been unpacked into
+    // the various packet fields and option objects has been cretated.
+    // Execute callouts registered for packet6_receive.
+    if (HooksManager::calloutsPresent(Hooks.hook_index_pkt6_receive_)) {
+        CalloutHandlePtr callout_handle = getCalloutHandle(query);
 
-            // Callouts decided to skip the next processing step. The next
-            // processing step would to process the packet, so skip at this
-            // stage means drop.
-            if (callout_handle->getSkip()) {
-                LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_PACKET_RCVD_SKIP);
-                continue;
-            }
+        // Delete previously set arguments
+        callout_handle->deleteAllArguments();
+
+        // Pass incoming packet as argument
+        callout_handle->setArgument("query6", query);
 
-            callout_handle->getArgument("query6", query);
+        // Call callouts
+        HooksManager::callCallouts(Hooks.hook_index_pkt6_receive_, *callout_handle);
+
+        // Callouts decided to skip the next processing step. The next
+        // processing step would to process the packet, so skip at this
+        // stage means drop.
+        if (callout_handle->getSkip()) {
+            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_PACKET_RCVD_SKIP);
+            return;
         }
 
-        // Assign this packet to a class, if possible
-        classifyPacket(query);
+        callout_handle->getArgument("query6", query);
+    }
+    query->setStageTime(PacketLatencyStats::RECEIVE_HOOKS);
 
-        try {
-                NameChangeRequestPtr ncr;
-            switch (query->getType()) {
-            case DHCPV6_SOLICIT:
-                rsp = processSolicit(query);
-                    break;
-
-            case DHCPV6_REQUEST:
-                rsp = processRequest(query);
-                break;
+    try {
+        // Assign this packet to a class, if possible. The packets are
+        // classified after the pkt6_receive callouts, so the time spent in
+        // the classification is accounted to the next stage. Classifying
+        // within this block handles the errors in the lazily parsed vendor
+        // class option like the errors in the other options.
+        classifyPacket(query);
 
-            case DHCPV6_RENEW:
-                rsp = processRenew(query);
+            NameChangeRequestPtr ncr;
+        switch (query->getType()) {
+        case DHCPV6_SOLICIT:
+            rsp = processSolicit(query);
                 break;
 
-            case DHCPV6_REBIND:
-                rsp = processRebind(query);
-                break;
+        case DHCPV6_REQUEST:
+            rsp = processRequest(query);
+            break;
 
-            case DHCPV6_CONFIRM:
-                rsp = processConfirm(query);
-                break;
+        case DHCPV6_RENEW:
+            rsp = processRenew(query);
+            break;
 
-            case DHCPV6_RELEASE:
-                rsp = processRelease(query);
-                break;
+        case DHCPV6_REBIND:
+            rsp = processRebind(query);
+            break;
 
-            case DHCPV6_DECLINE:
-                rsp = processDecline(query);
-                break;
+        case DHCPV6_CONFIRM:
+            rsp = processConfirm(query);
+            break;
 
-            case DHCPV6_INFORMATION_REQUEST:
-                rsp = processInfRequest(query);
-                break;
+        case DHCPV6_RELEASE:
+            rsp = processRelease(query);
+            break;
 
-            default:
-                // We received a packet type that we do not recognize.
-                LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_UNKNOWN_MSG_RECEIVED)
-                    .arg(static_cast<int>(query->getType()))
-                    .arg(query->getIface());
-                // Only action is to output a message if debug is enabled,
-                // and that will be covered by the debug statement before
-                // the "switch" statement.
-                ;
-            }
+        case DHCPV6_DECLINE:
+            rsp = processDecline(query);
+            break;
 
-        } catch (const RFCViolation& e) {
-            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_REQUIRED_OPTIONS_CHECK_FAIL)
-                .arg(query->getName())
-                .arg(query->getRemoteAddr().toText())
-                .arg(e.what());
+        case DHCPV6_INFORMATION_REQUEST:
+            rsp = processInfRequest(query);
+            break;
 
-        } catch (const isc::Exception& e) {
-
-            // Catch-all exception (at least for ones based on the isc Exception
-            // class, which covers more or less all that are explicitly raised
-            // in the Kea code).  Just log the problem and ignore the packet.
-            // (The problem is logged as a debug message because debug is
-            // disabled by default - it prevents a DDOS attack based on the
-            // sending of problem packets.)
-            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_PACKET_PROCESS_FAIL)
-                .arg(query->getName())
-                .arg(query->getRemoteAddr().toText())
-                .arg(e.what());
+        default:
+            // We received a packet type that we do not recognize.
+            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_UNKNOWN_MSG_RECEIVED)
+                .arg(static_cast<int>(query->getType()))
+                .arg(query->getIface());
+            // Only action is to output a message if debug is enabled,
+            // and that will be covered by the debug statement before
+            // the "switch" statement.
+            ;
         }
 
-        if (rsp) {
+    } catch (const RFCViolation& e) {
+        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_REQUIRED_OPTIONS_CHECK_FAIL)
+            .arg(query->getName())
+            .arg(query->getRemoteAddr().toText())
+            .arg(e.what());
 
-            // Process relay-supplied options. It is important to call this very
-            // late in the process, because we now have all the options the
-            // server wanted to send already set. This is important, because
-            // RFC6422, section 6 states:
-            //
-            //   The server SHOULD discard any options that appear in the RSOO
-            //   for which it already has one or more candidates.
-            //
-            // So we ignore any RSOO options if there's an option with the same
-            // code already present.
-            processRSOO(query, rsp);
+    } catch (const isc::Exception& e) {
 
-            rsp->setRemoteAddr(query->getRemoteAddr());
-            rsp->setLocalAddr(query->getLocalAddr());
+        // Catch-all exception (at least for ones based on the isc Exception
+        // class, which covers more or less all that are explicitly raised
+        // in the Kea code).  Just log the problem and ignore the packet.
+        // (The problem is logged as a debug message because debug is
+        // disabled by default - it prevents a DDOS attack based on the
+        // sending of problem packets.)
+        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_BASIC, DHCP6_PACKET_PROCESS_FAIL)
+            .arg(query->getName())
+            .arg(query->getRemoteAddr().toText())
+            .arg(e.what());
+    }
+    query->setStageTime(PacketLatencyStats::PROCESS);
+
+    if (rsp) {
+
+        // Process relay-supplied options. It is important to call this very
+        // late in the process, because we now have all the options the
+        // server wanted to send already set. This is important, because
+        // RFC6422, section 6 states:
+        //
+        //   The server SHOULD discard any options that appear in the RSOO
+        //   for which it already has one or more candidates.
+        //
+        // So we ignore any RSOO options if there's an option with the same
+        // code already present.
+        processRSOO(query, rsp);
+
+        rsp->setRemoteAddr(query->getRemoteAddr());
+        rsp->setLocalAddr(query->getLocalAddr());
+
+        if (rsp->relay_info_.empty()) {
+            // Direct traffic, send back to the client directly
+            rsp->setRemotePort(DHCP6_CLIENT_PORT);
+        } else {
+            // Relayed traffic, send back to the relay agent
+            rsp->setRemotePort(DHCP6_SERVER_PORT);
+        }
 
-            if (rsp->relay_info_.empty()) {
-                // Direct traffic, send back to the client directly
-                rsp->setRemotePort(DHCP6_CLIENT_PORT);
-            } else {
-                // Relayed traffic, send back to the relay agent
-                rsp->setRemotePort(DHCP6_SERVER_PORT);
-            }
+        rsp->setLocalPort(DHCP6_SERVER_PORT);
+        rsp->setIndex(query->getIndex());
+        rsp->setIface(query->getIface());
 
-            rsp->setLocalPort(DHCP6_SERVER_PORT);
-            rsp->setIndex(query->getIndex());
-            rsp->setIface(query->getIface());
+        // Specifies if server should do the packing
+        bool skip_pack = false;
 
-            // Specifies if server should do the packing
-            bool skip_pack = false;
+        // Server's reply packet now has all options and fields set.
+        // Options are represented by individual objects, but the
+        // output wire data has not been prepared yet.
+        // Execute all callouts registered for packet6_send
+        if (HooksManager::calloutsPresent(Hooks.hook_index_pkt6_send_)) {
+            CalloutHandlePtr callout_handle = getCalloutHandle(query);
 
-            // Server's reply packet now has all options and fields set.
-            // Options are represented by individual objects, but the
-            // output wire data has not been prepared yet.
-            // Execute all callouts registered for packet6_send
-            if (HooksManager::calloutsPresent(Hooks.hook_index_pkt6_send_)) {
-                CalloutHandlePtr callout_handle = getCalloutHandle(query);
+            // Delete all previous arguments
+            callout_handle->deleteAllArguments();
 
-                // Delete all previous arguments
-                callout_handle->deleteAllArguments();
+            // Set our response
+            callout_handle->setArgument("response6", rsp);
 
-                // Set our response
-                callout_handle->setArgument("response6", rsp);
+            // The callouts may modify the configured options in place, so
+            // they are packed from scratch.
+            rsp->clearPackedOptions();
 
-                // Call all installed callouts
-                HooksManager::callCallouts(Hooks.hook_index_pkt6_send_, *callout_handle);
+            // Call all installed callouts
+            HooksManager::callCallouts(Hooks.hook_index_pkt6_send_, *callout_handle);
 
-                // Callouts decided to skip the next processing step. The next
-                // processing step would to pack the packet (create wire data).
-                // That step will be skipped if any callout sets skip flag.
-                // It essentially means that the callout already did packing,
-                // so the server does not have to do it again.
-                if (callout_handle->getSkip()) {
-                    LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_PACKET_SEND_SKIP);
-                    skip_pack = true;
-                }
+            // Callouts decided to skip the next processing step. The next
+            // processing step would to pack the packet (create wire data).
+            // That step will be skipped if any callout sets skip flag.
+            // It essentially means that the callout already did packing,
+            // so the server does not have to do it again.
+            if (callout_handle->getSkip()) {
+                LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_PACKET_SEND_SKIP);
+                skip_pack = true;
             }
+        }
 
-            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA,
-                      DHCP6_RESPONSE_DATA)
-                .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
-
-            if (!skip_pack) {
-                try {
-                    rsp->pack();
-                } catch (const std::exception& e) {
-                    LOG_ERROR(dhcp6_logger, DHCP6_PACK_FAIL)
-                        .arg(e.what());
-                    continue;
-                }
+        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA,
+                  DHCP6_RESPONSE_DATA)
+            .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
 
+        if (!skip_pack) {
+            try {
+                rsp->pack();
+            } catch (const std::exception& e) {
+                LOG_ERROR(dhcp6_logger, DHCP6_PACK_FAIL)
+                    .arg(e.what());
+                return;
             }
 
-            try {
+        }
+        query->setStageTime(PacketLatencyStats::PACK);
 
-                // Now all fields and options are constructed into output wire buffer.
-                // Option objects modification does not make sense anymore. Hooks
-                // can only manipulate wire buffer at this stage.
-                // Let's execute all callouts registered for buffer6_send
-                if (HooksManager::calloutsPresent(Hooks.hook_index_buffer6_send_)) {
-                    CalloutHandlePtr callout_handle = getCalloutHandle(query);
+        try {
 
-                    // Delete previously set arguments
-                    callout_handle->deleteAllArguments();
+            // Now all fields and options are constructed into output wire buffer.
+            // Option objects modification does not make sense anymore. Hooks
+            // can only manipulate wire buffer at this stage.
+            // Let's execute all callouts registered for buffer6_send
+            if (HooksManager::calloutsPresent(Hooks.hook_index_buffer6_send_)) {
+                CalloutHandlePtr callout_handle = getCalloutHandle(query);
 
-                    // Pass incoming packet as argument
-                    callout_handle->setArgument("response6", rsp);
+                // Delete previously set arguments
+                callout_handle->deleteAllArguments();
 
-                    // Call callouts
-                    HooksManager::callCallouts(Hooks.hook_index_buffer6_send_, *callout_handle);
+                // Pass incoming packet as argument
+                callout_handle->setArgument("response6", rsp);
 
-                    // Callouts decided to skip the next processing step. The next
-                    // processing step would to parse the packet, so skip at this
-                    // stage means drop.
-                    if (callout_handle->getSkip()) {
-                        LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_BUFFER_SEND_SKIP);
-                        continue;
-                    }
+                // Call callouts
+                HooksManager::callCallouts(Hooks.hook_index_buffer6_send_, *callout_handle);
 
-                    callout_handle->getArgument("response6", rsp);
+                // Callouts decided to skip the next processing step. The next
+                // processing step would to parse the packet, so skip at this
+                // stage means drop.
+                if (callout_handle->getSkip()) {
+                    LOG_DEBUG(dhcp6_logger, DBG_DHCP6_HOOKS, DHCP6_HOOK_BUFFER_SEND_SKIP);
+                    return;
                 }
 
-                LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA,
-                          DHCP6_RESPONSE_DATA)
-                    .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
-
-                sendPacket(rsp);
-            } catch (const std::exception& e) {
-                LOG_ERROR(dhcp6_logger, DHCP6_PACKET_SEND_FAIL)
-                    .arg(e.what());
+                callout_handle->getArgument("response6", rsp);
             }
+
+            LOG_DEBUG(dhcp6_logger, DBG_DHCP6_DETAIL_DATA,
+                      DHCP6_RESPONSE_DATA)
+                .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
+
+            sendPacket(rsp);
+            query->setStageTime(PacketLatencyStats::SEND);
+        } catch (const std::exception& e) {
+            LOG_ERROR(dhcp6_logger, DHCP6_PACKET_SEND_FAIL)
+                .arg(e.what());
         }
     }
-
-    return (true);
 }
 
 bool Dhcpv6Srv::loadServerID(const std::string& file_name) {
@@ -754,23 +1006,27 @@ Dhcpv6Srv::appendRequestedOptions(const Pkt6Ptr& question, Pkt6Ptr& answer) {
     // using client classes).
     Subnet6Ptr subnet = selectSubnet(question);
 
-    // Get the list of options that client requested.
+    // Get the list of options that client requested. The options have
+    // been packed when the configuration was committed, so they are
+    // copied into the response.
     const std::vector<uint16_t>& requested_opts = option_oro->getValues();
     BOOST_FOREACH(uint16_t opt, requested_opts) {
         // If we found a subnet for this client, try subnet first.
         if (subnet) {
-            OptionDescriptor desc = subnet->getCfgOption()->get("dhcp6", opt);
-            if (desc.option_) {
+            PackedOption packed = subnet->getCfgOption()->
+                getPackedOption(DHCP6_OPTION_SPACE, opt);
+            if (packed.option_) {
                 // Attempt to assign an option from subnet first.
-                answer->addOption(desc.option_);
+                answer->addPackedOption(packed.option_, packed.wire_);
                 continue;
             }
         }
 
         // If subnet specific option is not there, try global.
-        OptionDescriptor desc = global_opts->get("dhcp6", opt);
-        if (desc.option_) {
-            answer->addOption(desc.option_);
+        PackedOption packed = global_opts->getPackedOption(DHCP6_OPTION_SPACE,
+                                                           opt);
+        if (packed.option_) {
+            answer->addPackedOption(packed.option_, packed.wire_);
         }
     }
 }
@@ -1007,6 +1263,11 @@ Dhcpv6Srv::assignLeases(const Pkt6Ptr& question, Pkt6Ptr& answer) {
     // responses in answer message (ADVERTISE or REPLY).
     //
     // @todo: IA_TA once we implement support for temporary addresses.
+    //
+    // The options are iterated over directly, so the IA options must be
+    // created if the options of the message are parsed lazily.
+    question->materializeOption(D6O_IA_NA);
+    question->materializeOption(D6O_IA_PD);
     for (OptionCollection::iterator opt = question->options_.begin();
          opt != question->options_.end(); ++opt) {
         switch (opt->second->getType()) {
@@ -1898,6 +2159,9 @@ Dhcpv6Srv::extendLeases(const Pkt6Ptr& query, Pkt6Ptr& reply) {
     }
     DuidPtr duid(new DUID(opt_duid->getData()));
 
+    // Make sure the IA options exist before iterating over the options.
+    query->materializeOption(D6O_IA_NA);
+    query->materializeOption(D6O_IA_PD);
     for (OptionCollection::iterator opt = query->options_.begin();
          opt != query->options_.end(); ++opt) {
         switch (opt->second->getType()) {
@@ -1963,6 +2227,10 @@ Dhcpv6Srv::releaseLeases(const Pkt6Ptr& release, Pkt6Ptr& reply) {
     // handled properly. Therefore the releaseIA_NA and releaseIA_PD options
     // may turn the status code to some error, but can't turn it back to success.
     int general_status = STATUS_Success;
+
+    // Create the lazily parsed IA options before iterating over them.
+    release->materializeOption(D6O_IA_NA);
+    release->materializeOption(D6O_IA_PD);
     for (OptionCollection::iterator opt = release->options_.begin();
          opt != release->options_.end(); ++opt) {
         switch (opt->second->getType()) {
@@ -2303,6 +2571,7 @@ Dhcpv6Srv::processSolicit(const Pkt6Ptr& solicit) {
 
     processClientFqdn(solicit, advertise);
     assignLeases(solicit, advertise);
+    solicit->setStageTime(PacketLatencyStats::LEASE);
     // Note, that we don't create NameChangeRequests here because we don't
     // perform DNS Updates for Solicit. Client must send Request to update
     // DNS.
@@ -2326,6 +2595,7 @@ Dhcpv6Srv::processRequest(const Pkt6Ptr& request) {
 
     processClientFqdn(request, reply);
     assignLeases(request, reply);
+    request->setStageTime(PacketLatencyStats::LEASE);
     generateFqdn(reply);
     createNameChangeRequests(reply);
 
@@ -2345,6 +2615,7 @@ Dhcpv6Srv::processRenew(const Pkt6Ptr& renew) {
 
     processClientFqdn(renew, reply);
     extendLeases(renew, reply);
+    renew->setStageTime(PacketLatencyStats::LEASE);
     generateFqdn(reply);
     createNameChangeRequests(reply);
 
@@ -2362,6 +2633,7 @@ Dhcpv6Srv::processRebind(const Pkt6Ptr& rebind) {
 
     processClientFqdn(rebind, reply);
     extendLeases(rebind, reply);
+    rebind->setStageTime(PacketLatencyStats::LEASE);
     generateFqdn(reply);
     createNameChangeRequests(rebind);
 
@@ -2501,22 +2773,27 @@ Dhcpv6Srv::unpackOptions(const OptionBuffer& buf,
     size_t offset = 0;
     size_t length = buf.size();
 
-    OptionDefContainer option_defs;
+    // The option definitions are not copied, because this function is
+    // called for each received packet.
+    OptionDefContainerPtr option_defs_ptr;
+    const OptionDefContainer* option_defs = NULL;
     if (option_space == "dhcp6") {
         // Get the list of stdandard option definitions.
-        option_defs = LibDHCP::getOptionDefs(Option::V6);
-    } else if (!option_space.empty()) {
-        OptionDefContainerPtr option_defs_ptr =
-            CfgMgr::instance().getCurrentCfg()->getCfgOptionDef()->
-            getAll(option_space);
-        if (option_defs_ptr != NULL) {
-            option_defs = *option_defs_ptr;
+        option_defs = &LibDHCP::getOptionDefs(Option::V6);
+    } else {
+        if (!option_space.empty()) {
+            option_defs_ptr = CfgMgr::instance().getCurrentCfg()->
+                getCfgOptionDef()->getAll(option_space);
+        }
+        if (!option_defs_ptr) {
+            option_defs_ptr.reset(new OptionDefContainer());
         }
+        option_defs = option_defs_ptr.get();
     }
 
     // Get the search index #1. It allows to search for option definitions
     // using option code.
-    const OptionDefContainerTypeIndex& idx = option_defs.get<1>();
+    const OptionDefContainerTypeIndex& idx = option_defs->get<1>();
 
     // The buffer being read comprises a set of options, each starting with
     // a two-byte type code and a two-byte length field.
@@ -15,6 +15,8 @@
 #ifndef DHCPV6_SRV_H
 #define DHCPV6_SRV_H
 
+#include <asiolink/interval_timer.h>
+#include <asiolink/io_service.h>
 #include <dhcp_ddns/ncr_msg.h>
 #include <dhcp/dhcp6.h>
 #include <dhcp/duid.h>
@@ -28,7 +30,10 @@
 #include <dhcpsrv/subnet.h>
 #include <hooks/callout_handle.h>
 #include <dhcpsrv/daemon.h>
+#include <dhcpsrv/latency_stats.h>
+#include <util/threads/thread_pool.h>
 
+#include <boost/scoped_ptr.hpp>
 #include <iostream>
 #include <queue>
 
@@ -92,6 +97,35 @@ public:
     ///         critical error.
     bool run();
 
+    /// @brief Processes a single received packet.
+    ///
+    /// Unpacks and classifies the packet, checks whether it should be
+    /// accepted, generates the response (if needed) and transmits it. All
+    /// hook points related to the packet are invoked by this method.
+    ///
+    /// This method may be called by the worker threads of the thread pool
+    /// concurrently for packets sent by different clients.
+    ///
+    /// @param query A pointer to the received packet.
+    void processPacket(Pkt6Ptr& query);
+
+    /// @brief Returns the key used to order processing of the packet.
+    ///
+    /// The key is the content of the Client Identifier option, so as the
+    /// packets sent by the same client (having the same DUID) are never
+    /// processed concurrently by the worker threads and are processed in
+    /// the order in which they have been received. For relayed messages
+    /// the option is taken from the innermost Relay Message option.
+    ///
+    /// The option is located in the raw packet data, because the packet
+    /// is unpacked by the worker thread.
+    ///
+    /// @param query A pointer to the received (not yet unpacked) packet.
+    ///
+    /// @return Client identifier or an empty string if it couldn't be
+    /// found, in which case the packet is not ordered.
+    static std::string getClientKey(const Pkt6Ptr& query);
+
     /// @brief Instructs the server to shut down.
     void shutdown();
 
@@ -105,6 +139,15 @@ public:
         return (port_);
     }
 
+    /// @brief Returns the histograms of the time spent by the packets in
+    /// the processing stages.
+    ///
+    /// The histograms are only updated when the latency-histograms
+    /// parameter is enabled.
+    PacketLatencyStats& getLatencyStats() {
+        return (*latency_stats_);
+    }
+
     /// @brief Starts DHCP_DDNS client IO if DDNS updates are enabled.
     ///
     /// If updates are enabled, it Instructs the D2ClientMgr singleton to
@@ -563,6 +606,21 @@ protected:
     /// simulates reception of a packet. For that purpose it is protected.
     virtual Pkt6Ptr receivePacket(int timeout);
 
+    /// @brief Receives the packets queued on a socket together.
+    ///
+    /// This method is called by the main loop. It waits for the packets
+    /// with @c IfaceMgr::receive6Batch and receives up to
+    /// @c RECEIVE_BATCH_SIZE packets at once. Like @c receivePacket, it is
+    /// replaced in the tests to simulate reception of the packets.
+    ///
+    /// @param timeout Timeout for waiting for the packets.
+    /// @param [out] queries Collection to which the received packets are
+    /// appended.
+    virtual void receivePackets(int timeout, Pkt6Collection& queries);
+
+    /// @brief Maximum number of packets received at once.
+    static const size_t RECEIVE_BATCH_SIZE = 32;
+
     /// @brief dummy wrapper around IfaceMgr::send()
     ///
     /// This method is useful for testing purposes, where its replacement
@@ -704,6 +762,52 @@ protected:
     /// Holds a list of @c isc::dhcp_ddns::NameChangeRequest objects, which
     /// are waiting for sending to kea-dhcp-ddns module.
     std::queue<isc::dhcp_ddns::NameChangeRequest> name_change_reqs_;
+
+    /// @brief Starts, restarts or stops the thread pool according to
+    /// the current configuration.
+    ///
+    /// This method is called by the main loop after handling signals, so
+    /// as the new values of thread-pool-size and packet-queue-size take
+    /// effect after reconfiguration. If the thread pool fails to start,
+    /// the packets are processed by the main thread.
+    void updateThreadPool();
+
+    /// @brief Waits for the worker threads to process queued packets and
+    /// stops them.
+    void stopThreadPool();
+
+    /// @brief Pool of threads processing received packets.
+    ///
+    /// It is not running when the thread-pool-size is 0.
+    isc::util::thread::ThreadPool thread_pool_;
+
+    /// @brief IOService object, used for all ASIO operations.
+    ///
+    /// It is polled by the main loop to execute the ready timers.
+    isc::asiolink::IOService io_service_;
+
+    /// @brief Sets up or cancels the timer reclaiming the expired leases
+    /// according to the current configuration.
+    ///
+    /// This method is called by the main loop, like @c updateThreadPool,
+    /// so as the new value of reclaim-timer-wait-time takes effect after
+    /// reconfiguration.
+    void updateReclaimTimer();
+
+    /// @brief Reclaims expired leases.
+    ///
+    /// This method is called by the @c reclaim_timer_ every
+    /// reclaim-timer-wait-time seconds. It reclaims up to max-reclaim-leases
+    /// expired leases and removes DNS entries for them, if DNS updates are
+    /// enabled.
+    void reclaimExpiredLeases();
+
+    /// @brief Timer triggering the reclamation of expired leases.
+    isc::asiolink::IntervalTimer reclaim_timer_;
+
+    /// @brief Histograms of the time spent by the packets in the processing
+    /// stages.
+    boost::scoped_ptr<PacketLatencyStats> latency_stats_;
 };
 
 }; // namespace isc::dhcp
@@ -656,7 +656,11 @@ namespace dhcp {
     if ((config_id.compare("preferred-lifetime") == 0)  ||
         (config_id.compare("valid-lifetime") == 0)  ||
         (config_id.compare("renew-timer") == 0)  ||
-        (config_id.compare("rebind-timer") == 0))  {
+        (config_id.compare("rebind-timer") == 0) ||
+        (config_id.compare("thread-pool-size") == 0) ||
+        (config_id.compare("packet-queue-size") == 0) ||
+        (config_id.compare("reclaim-timer-wait-time") == 0) ||
+        (config_id.compare("max-reclaim-leases") == 0))  {
         parser = new Uint32Parser(config_id,
                                  globalContext()->uint32_values_);
     } else if (config_id.compare("interfaces-config") == 0) {
@@ -681,6 +685,9 @@ namespace dhcp {
                                                 globalContext());
     } else if (config_id.compare("relay-supplied-options") == 0) {
         parser = new RSOOListConfigParser(config_id);
+    } else if ((config_id.compare("latency-histograms") == 0) ||
+               (config_id.compare("lazy-option-parsing") == 0)) {
+        parser = new BooleanParser(config_id, globalContext()->boolean_values_);
     } else {
         isc_throw(DhcpConfigError,
                 "unsupported global configuration parameter: "
@@ -690,6 +697,35 @@ namespace dhcp {
     return (parser);
 }
 
+/// @brief Sets global parameters in the staging configuration.
+void commitGlobalOptions() {
+    // Set the number of threads processing packets (0 means that packets
+    // are processed by the main thread) and the maximum number of packets
+    // waiting for processing.
+    SrvConfigPtr cfg = CfgMgr::instance().getStagingCfg();
+    cfg->setThreadPoolSize(globalContext()->uint32_values_->
+                           getOptionalParam("thread-pool-size", 0));
+    cfg->setPacketQueueSize(globalContext()->uint32_values_->
+                            getOptionalParam("packet-queue-size",
+                                             SrvConfig::DEFAULT_PACKET_QUEUE_SIZE));
+
+    // Set the interval between the runs of the expired leases reclamation
+    // routine (0 disables it) and the number of leases reclaimed in each run.
+    cfg->setReclaimTimerWaitTime(globalContext()->uint32_values_->
+                                 getOptionalParam("reclaim-timer-wait-time", 0));
+    cfg->setMaxReclaimLeases(globalContext()->uint32_values_->
+                             getOptionalParam("max-reclaim-leases",
+                                              SrvConfig::DEFAULT_MAX_RECLAIM_LEASES));
+
+    // Enable recording of the time spent in the packet processing stages.
+    cfg->setLatencyHistograms(globalContext()->boolean_values_->
+                              getOptionalParam("latency-histograms", false));
+
+    // Create the options of the received packets when they are retrieved.
+    cfg->setLazyOptionParsing(globalContext()->boolean_values_->
+                              getOptionalParam("lazy-option-parsing", false));
+}
+
 isc::data::ConstElementPtr
 configureDhcp6Server(Dhcpv6Srv&, isc::data::ConstElementPtr config_set) {
     if (!config_set) {
@@ -838,6 +874,9 @@ configureDhcp6Server(Dhcpv6Srv&, isc::data::ConstElementPtr config_set) {
             // No need to commit interface names as this is handled by the
             // CfgMgr::commit() function.
 
+            // Apply global options
+            commitGlobalOptions();
+
             // This occurs last as if it succeeds, there is no easy way to
             // revert it.  As a result, the failure to commit a subsequent
             // change causes problems when trying to roll back.
@@ -49,6 +49,7 @@
 #include <unistd.h>
 #include <fstream>
 #include <iostream>
+#include <set>
 #include <sstream>
 
 using namespace isc;
@@ -1507,6 +1508,177 @@ TEST_F(Dhcpv6SrvTest, portsRelayedTraffic) {
     EXPECT_EQ(DHCP6_SERVER_PORT, adv->getRemotePort());
 }
 
+// Checks that the key used to order processing of the packets by the
+// worker threads is the client identifier, also for relayed packets.
+TEST_F(Dhcpv6SrvTest, getClientKey) {
+    // Direct message.
+    Pkt6Ptr sol = PktCaptures::captureSimpleSolicit();
+    std::string key = NakedDhcpv6Srv::getClientKey(sol);
+    ASSERT_NO_THROW(sol->unpack());
+    OptionPtr clientid = sol->getOption(D6O_CLIENTID);
+    ASSERT_TRUE(clientid);
+    EXPECT_EQ(std::string(clientid->getData().begin(),
+                          clientid->getData().end()), key);
+
+    // Relayed message. The client identifier is carried in the relay
+    // message option.
+    Pkt6Ptr relayed = PktCaptures::captureRelayedSolicit();
+    key = NakedDhcpv6Srv::getClientKey(relayed);
+    ASSERT_NO_THROW(relayed->unpack());
+    clientid = relayed->getOption(D6O_CLIENTID);
+    ASSERT_TRUE(clientid);
+    EXPECT_EQ(std::string(clientid->getData().begin(),
+                          clientid->getData().end()), key);
+
+    // Message without client identifier is not ordered.
+    Pkt6 inf(DHCPV6_INFORMATION_REQUEST, 1234);
+    ASSERT_NO_THROW(inf.pack());
+    const OutputBuffer& buf = inf.getBuffer();
+    Pkt6Ptr query(new Pkt6(static_cast<const uint8_t*>(buf.getData()),
+                           buf.getLength()));
+    EXPECT_TRUE(NakedDhcpv6Srv::getClientKey(query).empty());
+
+    // Truncated message is not ordered.
+    query.reset(new Pkt6(static_cast<const uint8_t*>(buf.getData()), 2));
+    EXPECT_TRUE(NakedDhcpv6Srv::getClientKey(query).empty());
+}
+
+// Checks that the server processes packets using multiple threads when
+// the thread-pool-size is configured.
+TEST_F(Dhcpv6SrvTest, threadPool) {
+    NakedDhcpv6Srv srv(0);
+
+    string config = "{ \"interfaces-config\": {"
+        "  \"interfaces\": [ \"*\" ]"
+        "},"
+        "\"preferred-lifetime\": 3000,"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, "
+        "\"thread-pool-size\": 4, "
+        "\"packet-queue-size\": 100, "
+        "\"subnet6\": [ { "
+        "    \"pools\": [ { \"pool\": \"2001:db8:1::/64\" } ],"
+        "    \"subnet\": \"2001:db8:1::/48\", "
+        "    \"interface\": \"eth0\" "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    configure(config, srv);
+
+    ConstSrvConfigPtr cfg = CfgMgr::instance().getCurrentCfg();
+    EXPECT_EQ(4, cfg->getThreadPoolSize());
+    EXPECT_EQ(100, cfg->getPacketQueueSize());
+
+    // Simulate reception of SOLICITs from different clients. The packets
+    // are created from the wire data because the server is going to parse
+    // them.
+    const int num_clients = 50;
+    for (int i = 0; i < num_clients; ++i) {
+        Pkt6 sol(DHCPV6_SOLICIT, 1234 + i);
+        sol.addOption(generateIA(D6O_IA_NA, 234, 1500, 3000));
+        OptionBuffer duid(8, 0);
+        duid[7] = static_cast<uint8_t>(i);
+        sol.addOption(OptionPtr(new Option(Option::V6, D6O_CLIENTID, duid)));
+        ASSERT_NO_THROW(sol.pack());
+
+        const OutputBuffer& buf = sol.getBuffer();
+        Pkt6Ptr query(new Pkt6(static_cast<const uint8_t*>(buf.getData()),
+                               buf.getLength()));
+        query->setRemoteAddr(IOAddress("fe80::abcd"));
+        query->setLocalAddr(IOAddress("ff02::1:2"));
+        query->setIface("eth0");
+        srv.fakeReceive(query);
+    }
+
+    // Process all packets. The run() returns when all worker threads
+    // have processed their packets.
+    srv.run();
+
+    // Each client should have been advertised a different address from
+    // the configured pool.
+    ASSERT_EQ(num_clients, srv.fake_sent_.size());
+    const Subnet6Collection* subnets = cfg->getCfgSubnets6()->getAll();
+    ASSERT_EQ(1, subnets->size());
+    std::set<IOAddress> advertised;
+    for (std::list<Pkt6Ptr>::const_iterator adv = srv.fake_sent_.begin();
+         adv != srv.fake_sent_.end(); ++adv) {
+        ASSERT_EQ(DHCPV6_ADVERTISE, (*adv)->getType());
+        boost::shared_ptr<Option6IAAddr> addr = checkIA_NA(*adv, 234, 1000,
+                                                           2000);
+        ASSERT_TRUE(addr);
+        EXPECT_TRUE((*subnets)[0]->inPool(Lease::TYPE_NA,
+                                          addr->getAddress()));
+        advertised.insert(addr->getAddress());
+    }
+    EXPECT_EQ(num_clients, advertised.size());
+}
+
+// Checks that the server creates the options of the received packets
+// when they are retrieved if the lazy-option-parsing is enabled, so as
+// a malformed option which the server doesn't use doesn't cause the
+// packet to be dropped.
+TEST_F(Dhcpv6SrvTest, lazyOptionParsing) {
+    NakedDhcpv6Srv srv(0);
+
+    const string config_begin = "{ \"interfaces-config\": {"
+        "  \"interfaces\": [ \"*\" ]"
+        "},"
+        "\"preferred-lifetime\": 3000,"
+        "\"rebind-timer\": 2000, "
+        "\"renew-timer\": 1000, ";
+    const string config_end = "\"subnet6\": [ { "
+        "    \"pools\": [ { \"pool\": \"2001:db8:1::/64\" } ],"
+        "    \"subnet\": \"2001:db8:1::/48\", "
+        "    \"interface\": \"eth0\" "
+        " } ],"
+        "\"valid-lifetime\": 4000 }";
+
+    configure(config_begin + "\"lazy-option-parsing\": true, " + config_end,
+              srv);
+    ASSERT_TRUE(CfgMgr::instance().getCurrentCfg()->getLazyOptionParsing());
+
+    // Create the SOLICIT with the preference option, which the clients
+    // don't send. It is malformed because it doesn't carry the value.
+    Pkt6 sol(DHCPV6_SOLICIT, 1234);
+    sol.addOption(generateIA(D6O_IA_NA, 234, 1500, 3000));
+    sol.addOption(generateClientId());
+    sol.addOption(OptionPtr(new Option(Option::V6, D6O_PREFERENCE)));
+    ASSERT_NO_THROW(sol.pack());
+    const OutputBuffer& buf = sol.getBuffer();
+
+    Pkt6Ptr query(new Pkt6(static_cast<const uint8_t*>(buf.getData()),
+                           buf.getLength()));
+    query->setRemoteAddr(IOAddress("fe80::abcd"));
+    query->setLocalAddr(IOAddress("ff02::1:2"));
+    query->setIface("eth0");
+    srv.fakeReceive(query);
+    srv.run();
+
+    // The client should have been advertised an address and the malformed
+    // option should have never been created.
+    ASSERT_EQ(1, srv.fake_sent_.size());
+    Pkt6Ptr adv = srv.fake_sent_.front();
+    ASSERT_EQ(DHCPV6_ADVERTISE, adv->getType());
+    EXPECT_TRUE(checkIA_NA(adv, 234, 1000, 2000));
+    EXPECT_TRUE(query->getLazyUnpack());
+    EXPECT_EQ(0, query->options_.count(D6O_PREFERENCE));
+    EXPECT_THROW(query->getOption(D6O_PREFERENCE), InvalidOptionValue);
+
+    // When the options are parsed at once, the packet is dropped.
+    configure(config_begin + config_end, srv);
+    ASSERT_FALSE(CfgMgr::instance().getCurrentCfg()->getLazyOptionParsing());
+
+    srv.fake_sent_.clear();
+    query.reset(new Pkt6(static_cast<const uint8_t*>(buf.getData()),
+                         buf.getLength()));
+    query->setRemoteAddr(IOAddress("fe80::abcd"));
+    query->setLocalAddr(IOAddress("ff02::1:2"));
+    query->setIface("eth0");
+    srv.fakeReceive(query);
+    srv.run();
+    EXPECT_TRUE(srv.fake_sent_.empty());
+}
+
 // Checks if server is able to handle a relayed traffic from DOCSIS3.0 modems
 // @todo Uncomment this test as part of #3180 work.
 // Kea code currently fails to handle docsis traffic.
@@ -34,6 +34,7 @@
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcp6/dhcp6_srv.h>
 #include <hooks/hooks_manager.h>
+#include <util/threads/sync.h>
 
 #include <list>
 
@@ -73,12 +74,29 @@ public:
         return (isc::dhcp::Pkt6Ptr());
     }
 
+    /// @brief fakes reception of the packets received together
+    ///
+    /// Receives a single packet with @c receivePacket, so as the packets
+    /// are processed one after another.
+    ///
+    /// @param timeout passed to receivePacket
+    /// @param [out] queries Collection to which the packet is appended.
+    virtual void receivePackets(int timeout,
+                                isc::dhcp::Pkt6Collection& queries) {
+        isc::dhcp::Pkt6Ptr pkt = receivePacket(timeout);
+        if (pkt) {
+            queries.push_back(pkt);
+        }
+    }
+
     /// @brief fake packet sending
     ///
     /// Pretend to send a packet, but instead just store
     /// it in fake_send_ list where test can later inspect
-    /// server's response.
+    /// server's response. The packets may be sent by multiple
+    /// threads, so access to the list is serialized.
     virtual void sendPacket(const isc::dhcp::Pkt6Ptr& pkt) {
+        isc::util::thread::Mutex::Locker locker(fake_sent_mutex_);
         fake_sent_.push_back(pkt);
     }
 
@@ -124,6 +142,9 @@ public:
     std::list<isc::dhcp::Pkt6Ptr> fake_received_;
 
     std::list<isc::dhcp::Pkt6Ptr> fake_sent_;
+
+    /// @brief Mutex protecting the list of sent packets.
+    isc::util::thread::Mutex fake_sent_mutex_;
 };
 
 static const char* DUID_FILE = "server-id-test.txt";
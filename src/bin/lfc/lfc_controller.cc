@@ -16,11 +16,14 @@
 #include <lfc/lfc_log.h>
 #include <util/pid_file.h>
 #include <exceptions/exceptions.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
 #include <dhcpsrv/csv_lease_file4.h>
 #include <dhcpsrv/csv_lease_file6.h>
 #include <dhcpsrv/memfile_lease_storage.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_file_loader.h>
+#include <dhcpsrv/lease_file_stats.h>
 #include <log/logger_manager.h>
 #include <log/logger_name.h>
 #include <config.h>
@@ -29,6 +32,7 @@
 #include <sstream>
 #include <unistd.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <cerrno>
 
 using namespace std;
@@ -39,6 +43,22 @@ using namespace isc::log;
 namespace {
 /// @brief Maximum number of errors to allow when reading leases from the file.
 const uint32_t MAX_LEASE_ERRORS = 100;
+
+/// @brief Maximum size of the segment and copy files relative to the size
+/// of the previous file for which the incremental cleanup is performed.
+const double MAX_SEGMENT_RATIO = 0.5;
+
+/// @brief Returns the size of the file or 0 if the file doesn't exist.
+///
+/// @param file_name Path to the file.
+uint64_t
+getFileSize(const std::string& file_name) {
+    struct stat st;
+    if (file_name.empty() || (stat(file_name.c_str(), &st) != 0)) {
+        return (0);
+    }
+    return (static_cast<uint64_t>(st.st_size));
+}
 }; // namespace anonymous
 
 namespace isc {
@@ -53,7 +73,9 @@ const char* LFCController::lfc_bin_name_ = "kea-lfc";
 
 LFCController::LFCController()
     : protocol_version_(0), verbose_(false), config_file_(""), previous_file_(""),
-      copy_file_(""), output_file_(""), finish_file_(""), pid_file_("") {
+      copy_file_(""), output_file_(""), finish_file_(""), pid_file_(""),
+      segment_file_(""), segment_finish_file_(""), incremental_(false),
+      binary_(false), convert_(false) {
 }
 
 LFCController::~LFCController() {
@@ -83,6 +105,30 @@ LFCController::launch(int argc, char* argv[], const bool test_mode) {
 
     LOG_INFO(lfc_logger, LFC_START);
 
+    // The conversion doesn't interfere with the server, which must not
+    // be running, so no pid file is needed and no files are moved.
+    if (convert_) {
+        LOG_INFO(lfc_logger, LFC_CONVERTING)
+          .arg(copy_file_)
+          .arg(output_file_);
+
+        try {
+            if (getProtocolVersion() == 4) {
+                convertLeases<Lease4, CSVLeaseFile4, BinaryLeaseFile4,
+                              Lease4Storage>();
+            } else {
+                convertLeases<Lease6, CSVLeaseFile6, BinaryLeaseFile6,
+                              Lease6Storage>();
+            }
+        } catch (const std::exception& conv_ex) {
+            LOG_FATAL(lfc_logger, LFC_FAIL_CONVERT).arg(conv_ex.what());
+            throw;
+        }
+
+        LOG_INFO(lfc_logger, LFC_TERMINATE);
+        return;
+    }
+
     // verify we are the only instance
     PIDFile pid_file(pid_file_);
 
@@ -100,26 +146,43 @@ LFCController::launch(int argc, char* argv[], const bool test_mode) {
         return;
     }
 
-    // If we don't have a finish file do the processing.  We
+    // If we don't have any of the finish files do the processing.  We
     // don't know the exact type of the finish file here but
     // all we care about is if it exists so that's okay
     CSVFile lf_finish(getFinishFile());
-    if (!lf_finish.exists()) {
-        LOG_INFO(lfc_logger, LFC_PROCESSING)
-          .arg(previous_file_)
-          .arg(copy_file_);
+    CSVFile lf_segment_finish(getSegmentFinishFile());
+    bool incremental = false;
+    if (!lf_finish.exists() &&
+        (getSegmentFinishFile().empty() || !lf_segment_finish.exists())) {
+        incremental = useSegment();
+        if (incremental) {
+            LOG_INFO(lfc_logger, LFC_PROCESSING_SEGMENT)
+              .arg(segment_file_)
+              .arg(copy_file_);
+        } else {
+            LOG_INFO(lfc_logger, LFC_PROCESSING)
+              .arg(previous_file_)
+              .arg(copy_file_);
+        }
 
         try {
             if (getProtocolVersion() == 4) {
-                processLeases<Lease4, CSVLeaseFile4, Lease4Storage>();
+                processLeases<Lease4, CSVLeaseFile4, BinaryLeaseFile4,
+                              Lease4Storage>(incremental);
             } else {
-                processLeases<Lease6, CSVLeaseFile6, Lease6Storage>();
+                processLeases<Lease6, CSVLeaseFile6, BinaryLeaseFile6,
+                              Lease6Storage>(incremental);
             }
         } catch (const std::exception& proc_ex) {
             // We don't want to do the cleanup but do want to get rid of the pid
             do_rotate = false;
             LOG_FATAL(lfc_logger, LFC_FAIL_PROCESS).arg(proc_ex.what());
         }
+
+    } else {
+        // An interrupted instance left one of the finish files.  The
+        // full cleanup supersedes the incremental one.
+        incremental = !lf_finish.exists();
     }
 
     // If do_rotate is true We either already had a finish file or
@@ -130,7 +193,11 @@ LFCController::launch(int argc, char* argv[], const bool test_mode) {
         LOG_INFO(lfc_logger, LFC_ROTATING);
 
         try {
-            fileRotate();
+            if (incremental) {
+                segmentRotate();
+            } else {
+                fileRotate();
+            }
         } catch (const RunTimeFail& run_ex) {
           LOG_FATAL(lfc_logger, LFC_FAIL_ROTATE).arg(run_ex.what());
         }
@@ -152,7 +219,7 @@ LFCController::parseArgs(int argc, char* argv[]) {
 
     opterr = 0;
     optind = 1;
-    while ((ch = getopt(argc, argv, ":46dvVp:x:i:o:c:f:")) != -1) {
+    while ((ch = getopt(argc, argv, ":46dvVIbCp:x:i:o:c:f:s:g:")) != -1) {
         switch (ch) {
         case '4':
             // Process DHCPv4 lease files.
@@ -219,6 +286,37 @@ LFCController::parseArgs(int argc, char* argv[]) {
             finish_file_ = optarg;
             break;
 
+        case 's':
+            // Segment file name.
+            if (optarg == NULL) {
+                isc_throw(InvalidUsage, "Segment file name missing");
+            }
+            segment_file_ = optarg;
+            break;
+
+        case 'g':
+            // Segment finish file name.
+            if (optarg == NULL) {
+                isc_throw(InvalidUsage, "Segment finish file name missing");
+            }
+            segment_finish_file_ = optarg;
+            break;
+
+        case 'I':
+            // Incremental cleanup.
+            incremental_ = true;
+            break;
+
+        case 'b':
+            // Write the output file in the binary format.
+            binary_ = true;
+            break;
+
+        case 'C':
+            // Convert the lease file.
+            convert_ = true;
+            break;
+
         case 'c':
             // Configuration file name
             if (optarg == NULL) {
@@ -255,11 +353,12 @@ LFCController::parseArgs(int argc, char* argv[]) {
         isc_throw(InvalidUsage, "DHCP version required");
     }
 
-    if (pid_file_.empty()) {
+    // The conversion only needs the input and output files.
+    if (!convert_ && pid_file_.empty()) {
         isc_throw(InvalidUsage, "PID file not specified");
     }
 
-    if (previous_file_.empty()) {
+    if (!convert_ && previous_file_.empty()) {
         isc_throw(InvalidUsage, "Previous file not specified");
     }
 
@@ -271,14 +370,24 @@ LFCController::parseArgs(int argc, char* argv[]) {
         isc_throw(InvalidUsage, "Output file not specified");
     }
 
-    if (finish_file_.empty()) {
+    if (!convert_ && finish_file_.empty()) {
         isc_throw(InvalidUsage, "Finish file not specified");
     }
 
-    if (config_file_.empty()) {
+    if (!convert_ && config_file_.empty()) {
         isc_throw(InvalidUsage, "Config file not specified");
     }
 
+    // The segment files are optional but the incremental cleanup
+    // can't be performed without them.
+    if (incremental_ && segment_file_.empty()) {
+        isc_throw(InvalidUsage, "Segment file not specified");
+    }
+
+    if (incremental_ && segment_finish_file_.empty()) {
+        isc_throw(InvalidUsage, "Segment finish file not specified");
+    }
+
     // If verbose is set echo the input information
     if (verbose_) {
         std::cout << "Protocol version:    DHCPv" << protocol_version_ << std::endl
@@ -288,6 +397,14 @@ LFCController::parseArgs(int argc, char* argv[]) {
                   << "Finish file:               " << finish_file_ << std::endl
                   << "Config file:               " << config_file_ << std::endl
                   << "PID file:                  " << pid_file_ << std::endl
+                  << "Segment file:              " << segment_file_ << std::endl
+                  << "Segment finish file:       " << segment_finish_file_ << std::endl
+                  << "Incremental cleanup:       "
+                  << (incremental_ ? "yes" : "no") << std::endl
+                  << "Binary output:             "
+                  << (binary_ ? "yes" : "no") << std::endl
+                  << "Convert:                   "
+                  << (convert_ ? "yes" : "no") << std::endl
                   << std::endl;
     }
 }
@@ -299,7 +416,9 @@ LFCController::usage(const std::string& text) {
     }
 
     std::cerr << "Usage: " << lfc_bin_name_ << std::endl
-              << " [-4|-6] -p file -x file -i file -o file -f file -c file" << std::endl
+              << " [-4|-6] -p file -x file -i file -o file -f file -c file"
+              << " [-s file -g file [-I]] [-b]" << std::endl
+              << " [-4|-6] -C -i file -o file [-b]" << std::endl
               << "   -4 or -6 clean a set of v4 or v6 lease files" << std::endl
               << "   -p <file>: PID file" << std::endl
               << "   -x <file>: previous or ex lease file" << std::endl
@@ -307,6 +426,13 @@ LFCController::usage(const std::string& text) {
               << "   -o <file>: output lease file" << std::endl
               << "   -f <file>: finish file" << std::endl
               << "   -c <file>: configuration file" << std::endl
+              << "   -s <file>: optional, delta segment file" << std::endl
+              << "   -g <file>: optional, delta segment finish file" << std::endl
+              << "   -I: optional, incremental cleanup" << std::endl
+              << "   -b: optional, write the output file in binary format"
+              << std::endl
+              << "   -C: convert the lease file (-i) to the output file (-o)"
+              << std::endl
               << "   -v: print version number and exit" << std::endl
               << "   -V: print extended version inforamtion and exit" << std::endl
               << "   -d: optional, verbose output " << std::endl
@@ -326,48 +452,134 @@ LFCController::getVersion(const bool extended) const{
     return (version_stream.str());
 }
 
-template<typename LeaseObjectType, typename LeaseFileType, typename StorageType>
+bool
+LFCController::useSegment() const {
+    if (!incremental_) {
+        return (false);
+    }
+
+    // Without the previous file there is nothing to apply the segment to.
+    const uint64_t previous_size = getFileSize(previous_file_);
+    if (previous_size == 0) {
+        return (false);
+    }
+
+    // The segment holds all changes since the previous file was written,
+    // so it grows with each incremental cleanup.  Merge it into the
+    // previous file when it is no longer small.
+    const uint64_t segment_size = getFileSize(segment_file_) +
+        getFileSize(copy_file_);
+    return (segment_size < (previous_size * MAX_SEGMENT_RATIO));
+}
+
+template<typename LeaseObjectType, typename LeaseFileType,
+         typename BinaryLeaseFileType, typename StorageType>
 void
-LFCController::processLeases() const {
+LFCController::processLeases(const bool incremental) const {
     StorageType storage;
-
-    // If a previous file exists read the entries into storage
-    LeaseFileType lf_prev(getPreviousFile());
-    if (lf_prev.exists()) {
-        LeaseFileLoader::load<LeaseObjectType>(lf_prev, storage,
-                                               MAX_LEASE_ERRORS);
+    LeaseFileStats read_stats;
+
+    // If a previous file exists read the entries into storage, unless
+    // only the changes are being collected.  Each file may be in either
+    // format, e.g. when the server's file format has been changed.
+    if (!incremental) {
+        LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                                  BinaryLeaseFileType>(getPreviousFile(),
+                                                       storage,
+                                                       MAX_LEASE_ERRORS,
+                                                       false, &read_stats);
     }
 
-    // Follow that with the copy of the current lease file
-    LeaseFileType lf_copy(getCopyFile());
-    if (lf_copy.exists()) {
-        LeaseFileLoader::load<LeaseObjectType>(lf_copy, storage,
-                                               MAX_LEASE_ERRORS);
+    // Follow that with the changes collected by the previous incremental
+    // cleanups.  The released leases are kept in the incremental mode so
+    // as they remove the leases from the previous file when the segment
+    // is applied on top of it.
+    if (!getSegmentFile().empty()) {
+        LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                                  BinaryLeaseFileType>(getSegmentFile(),
+                                                       storage,
+                                                       MAX_LEASE_ERRORS,
+                                                       incremental,
+                                                       &read_stats);
     }
 
-    // Write the result out to the output file
-    LeaseFileType lf_output(getOutputFile());
-    LeaseFileLoader::write<LeaseObjectType>(lf_output, storage);
+    // Follow that with the copy of the current lease file
+    LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                              BinaryLeaseFileType>(getCopyFile(), storage,
+                                                   MAX_LEASE_ERRORS,
+                                                   incremental, &read_stats);
 
     // If desired log the stats
     LOG_INFO(lfc_logger, LFC_READ_STATS)
-      .arg(lf_prev.getReadLeases() + lf_copy.getReadLeases())
-      .arg(lf_prev.getReads() + lf_copy.getReads())
-      .arg(lf_prev.getReadErrs() + lf_copy.getReadErrs());
+      .arg(read_stats.getReadLeases())
+      .arg(read_stats.getReads())
+      .arg(read_stats.getReadErrs());
 
-    LOG_INFO(lfc_logger, LFC_WRITE_STATS)
-      .arg(lf_output.getWriteLeases())
-      .arg(lf_output.getWrites())
-      .arg(lf_output.getWriteErrs());
+    // Write the result out to the output file
+    writeLeases<LeaseObjectType, LeaseFileType,
+                BinaryLeaseFileType>(storage);
 
     // Once we've finished the output file move it to the complete file
-    if (rename(getOutputFile().c_str(), getFinishFile().c_str()) != 0) {
+    const std::string& finish_file = incremental ? segment_finish_file_ :
+        finish_file_;
+    if (rename(getOutputFile().c_str(), finish_file.c_str()) != 0) {
         isc_throw(RunTimeFail, "Unable to move output (" << output_file_
-                  << ") to complete (" << finish_file_
+                  << ") to complete (" << finish_file
                   << ") error: " << strerror(errno));
     }
 }
 
+template<typename LeaseObjectType, typename LeaseFileType,
+         typename BinaryLeaseFileType, typename StorageType>
+void
+LFCController::convertLeases() const {
+    StorageType storage;
+    LeaseFileStats read_stats;
+
+    // Keep the released leases, so as the converted file holds the
+    // same information as the original one.
+    LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                              BinaryLeaseFileType>(getCopyFile(), storage,
+                                                   MAX_LEASE_ERRORS, true,
+                                                   &read_stats);
+
+    LOG_INFO(lfc_logger, LFC_READ_STATS)
+      .arg(read_stats.getReadLeases())
+      .arg(read_stats.getReads())
+      .arg(read_stats.getReadErrs());
+
+    writeLeases<LeaseObjectType, LeaseFileType,
+                BinaryLeaseFileType>(storage);
+}
+
+template<typename LeaseObjectType, typename LeaseFileType,
+         typename BinaryLeaseFileType, typename StorageType>
+void
+LFCController::writeLeases(const StorageType& storage) const {
+    // Remove the output file left by an interrupted run, which would
+    // otherwise be appended to and may be in the other format.
+    static_cast<void>(unlink(getOutputFile().c_str()));
+
+    if (binary_) {
+        BinaryLeaseFileType lf_output(getOutputFile());
+        LeaseFileLoader::write<LeaseObjectType>(lf_output, storage);
+        logWriteStats(lf_output);
+
+    } else {
+        LeaseFileType lf_output(getOutputFile());
+        LeaseFileLoader::write<LeaseObjectType>(lf_output, storage);
+        logWriteStats(lf_output);
+    }
+}
+
+void
+LFCController::logWriteStats(const LeaseFileStats& stats) const {
+    LOG_INFO(lfc_logger, LFC_WRITE_STATS)
+      .arg(stats.getWriteLeases())
+      .arg(stats.getWrites())
+      .arg(stats.getWriteErrs());
+}
+
 void
 LFCController::fileRotate() const {
     // Remove the old previous file
@@ -384,6 +596,19 @@ LFCController::fileRotate() const {
                   << copy_file_ << "' error: " << strerror(errno));
     }
 
+    // Remove the segment files, the finish file holds their leases
+    if (!segment_file_.empty() && (remove(segment_file_.c_str()) != 0) &&
+        (errno != ENOENT)) {
+        isc_throw(RunTimeFail, "Unable to delete segment file '"
+                  << segment_file_ << "' error: " << strerror(errno));
+    }
+
+    if (!segment_finish_file_.empty() &&
+        (remove(segment_finish_file_.c_str()) != 0) && (errno != ENOENT)) {
+        isc_throw(RunTimeFail, "Unable to delete segment finish file '"
+                  << segment_finish_file_ << "' error: " << strerror(errno));
+    }
+
     // Rename the finish file to be the previous file
     if (rename(finish_file_.c_str(), previous_file_.c_str()) != 0) {
         isc_throw(RunTimeFail, "Unable to move finish (" << finish_file_
@@ -392,6 +617,30 @@ LFCController::fileRotate() const {
     }
 }
 
+void
+LFCController::segmentRotate() const {
+    // Remove the old segment file
+    if ((remove(segment_file_.c_str()) != 0) &&
+        (errno != ENOENT)) {
+        isc_throw(RunTimeFail, "Unable to delete segment file '"
+                  << segment_file_ << "' error: " << strerror(errno));
+    }
+
+    // Remove the copy file
+    if ((remove(getCopyFile().c_str()) != 0) &&
+        (errno != ENOENT)) {
+        isc_throw(RunTimeFail, "Unable to delete copy file '"
+                  << copy_file_ << "' error: " << strerror(errno));
+    }
+
+    // Rename the segment finish file to be the segment file
+    if (rename(segment_finish_file_.c_str(), segment_file_.c_str()) != 0) {
+        isc_throw(RunTimeFail, "Unable to move segment finish ("
+                  << segment_finish_file_ << ") to segment ("
+                  << segment_file_ << ") error: " << strerror(errno));
+    }
+}
+
 void
 LFCController::startLogger(const bool test_mode) const {
     // If we are running in test mode use the environment variables
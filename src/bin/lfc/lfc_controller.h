@@ -16,6 +16,7 @@
 #define LFC_CONTROLLER_H
 
 #include <exceptions/exceptions.h>
+#include <dhcpsrv/lease_file_stats.h>
 #include <string>
 
 namespace isc {
@@ -75,6 +76,10 @@ public:
     /// -# remove pid file
     /// -# exit to the caller
     ///
+    /// In the conversion mode (-C) the leases are read from the copy
+    /// file and written to the output file in the format selected with
+    /// the -b option.  No pid file is created and no files are moved.
+    ///
     /// @param argc Number of strings in the @c argv array.
     /// @param argv Array of arguments passed in via the program's main function.
     /// @param test_mode is a bool value which indicates if @c launch
@@ -83,6 +88,7 @@ public:
     /// mode explicitly.
     ///
     /// @throw InvalidUsage if the command line parameters are invalid.
+    /// @throw isc::Exception or std::exception if the conversion fails.
     void launch(int argc, char* argv[], const bool test_mode);
 
     /// @brief Process the command line arguments.
@@ -104,6 +110,27 @@ public:
     /// @throw RunTimeFail if we can't manipulate the files.
     void fileRotate() const;
 
+    /// @brief Rotate files after the incremental cleanup.
+    ///
+    /// After we have a segment finish file, either from doing the
+    /// incremental cleanup or because a previous instance was interrupted,
+    /// delete the work files (segment & copy) and move the segment finish
+    /// file to be the new segment file.  The previous file is left intact.
+    ///
+    /// @throw RunTimeFail if we can't manipulate the files.
+    void segmentRotate() const;
+
+    /// @brief Checks if the incremental cleanup should be performed.
+    ///
+    /// The incremental cleanup is only performed if it has been requested
+    /// on the command line, the previous file exists and the combined size
+    /// of the segment and copy files is small in comparison with the size
+    /// of the previous file.  Otherwise, all leases are rewritten which
+    /// also merges the segment file into the previous file.
+    ///
+    /// @return true if the incremental cleanup should be performed.
+    bool useSegment() const;
+
     /// @name Accessor methods mainly used for testing purposes
     //@{
 
@@ -157,6 +184,42 @@ public:
     std::string getPidFile() const {
         return (pid_file_);
     }
+
+    /// @brief Gets the segment file name
+    ///
+    /// @return Returns the path to the segment file
+    std::string getSegmentFile() const {
+        return (segment_file_);
+    }
+
+    /// @brief Gets the segment finish file name
+    ///
+    /// @return Returns the path to the segment finish file
+    std::string getSegmentFinishFile() const {
+        return (segment_finish_file_);
+    }
+
+    /// @brief Checks if the incremental cleanup has been requested
+    ///
+    /// @return Returns true if the incremental cleanup is enabled
+    bool isIncremental() const {
+        return (incremental_);
+    }
+
+    /// @brief Checks if the output file is written in the binary format
+    ///
+    /// @return Returns true if the binary format has been requested
+    bool isBinary() const {
+        return (binary_);
+    }
+
+    /// @brief Checks if the conversion has been requested
+    ///
+    /// @return Returns true if the lease file is to be converted rather
+    /// than cleaned up
+    bool isConvert() const {
+        return (convert_);
+    }
     //@}
 
 private:
@@ -170,6 +233,14 @@ private:
     std::string output_file_;   ///< The path to the output file
     std::string finish_file_;   ///< The path to the finished output file
     std::string pid_file_;      ///< The path to the pid file
+    std::string segment_file_;  ///< The path to the delta segment file
+    std::string segment_finish_file_; ///< The path to the finished segment
+    /// When true perform the incremental cleanup if possible
+    bool incremental_;
+    /// When true write the output file in the binary format
+    bool binary_;
+    /// When true convert the copy file to the output file
+    bool convert_;
 
     /// @brief Prints the program usage text to std error.
     ///
@@ -185,17 +256,67 @@ private:
 
     /// @brief Process files.
     ///
-    /// Read in the leases from any previous & copy files we have and
-    /// write the results out to the output file.  Upon completion of
+    /// Read in the leases from any previous, segment & copy files we have
+    /// and write the results out to the output file.  Upon completion of
     /// the write move the file to the finish file.
     ///
+    /// In the incremental mode the previous file is not read.  The leases
+    /// from the segment & copy files, including the released leases, are
+    /// written to the output file which is then moved to the segment finish
+    /// file.  The cost of the processing is thus proportional to the number
+    /// of lease changes since the previous file was written.
+    ///
+    /// @param incremental Indicates if the incremental processing should
+    /// be performed.
+    ///
+    /// The input files may be in the CSV or binary format.  The output
+    /// file is written in the binary format if requested with -b.
+    ///
     /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
     /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
     /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
     ///
     /// @throw RunTimeFail if we can't move the file.
-    template<typename LeaseObjectType, typename LeaseFileType, typename StorageType>
-    void processLeases() const;
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename BinaryLeaseFileType, typename StorageType>
+    void processLeases(const bool incremental) const;
+
+    /// @brief Convert the lease file.
+    ///
+    /// Read in the leases from the copy file in either format and write
+    /// them to the output file in the format selected with -b.  The
+    /// released leases are kept, so as the output file may replace the
+    /// copy file while the server is not running.
+    ///
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename BinaryLeaseFileType, typename StorageType>
+    void convertLeases() const;
+
+    /// @brief Write the leases to the output file.
+    ///
+    /// @param storage Leases to be written.
+    /// @return Statistics of the leases written.
+    ///
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename BinaryLeaseFileType, typename StorageType>
+    void writeLeases(const StorageType& storage) const;
+
+    /// @brief Logs the statistics of the leases written to the output file.
+    ///
+    /// @param stats Statistics of the output file.
+    void logWriteStats(const isc::dhcp::LeaseFileStats& stats) const;
 
     ///@brief Start up the logging system
     ///
@@ -13,9 +13,11 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include <lfc/lfc_controller.h>
+#include <dhcpsrv/binary_lease_file.h>
 #include <util/csv_file.h>
 #include <gtest/gtest.h>
 #include <fstream>
+#include <sstream>
 #include <cerrno>
 
 using namespace isc::lfc;
@@ -31,6 +33,8 @@ public:
     string ostr_; ///< String for name for output file
     string fstr_; ///< String for name for finish file
     string cstr_; ///< String for name for config file
+    string sstr_; ///< String for name for segment file
+    string gstr_; ///< String for name for segment finish file
 
     string v4_hdr_; ///< String for the header of the v4 csv test file
     string v6_hdr_; ///< String for the header of the v6 csv test file
@@ -72,6 +76,8 @@ public:
         remove(istr_.c_str());
         remove(ostr_.c_str());
         remove(fstr_.c_str());
+        remove(sstr_.c_str());
+        remove(gstr_.c_str());
     }
 
 protected:
@@ -88,6 +94,8 @@ protected:
         ostr_ = base_dir + "/" + lf + "output";     // output
         fstr_ = base_dir + "/" + lf + "completed";  // finish
         cstr_ = base_dir + "/" + "config_file";     // config
+        sstr_ = base_dir + "/" + lf + "delta";      // segment
+        gstr_ = base_dir + "/" + lf + "delta.completed"; // segment finish
 
         v4_hdr_ = "address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
                   "fqdn_fwd,fqdn_rev,hostname\n";
@@ -151,6 +159,11 @@ TEST_F(LFCControllerTest, initialValues) {
     EXPECT_TRUE(lfc_controller.getOutputFile().empty());
     EXPECT_TRUE(lfc_controller.getFinishFile().empty());
     EXPECT_TRUE(lfc_controller.getPidFile().empty());
+    EXPECT_TRUE(lfc_controller.getSegmentFile().empty());
+    EXPECT_TRUE(lfc_controller.getSegmentFinishFile().empty());
+    EXPECT_FALSE(lfc_controller.isIncremental());
+    EXPECT_FALSE(lfc_controller.isBinary());
+    EXPECT_FALSE(lfc_controller.isConvert());
 }
 
 /// @brief Verify that parsing a full command line works.
@@ -188,6 +201,73 @@ TEST_F(LFCControllerTest, fullCommandLine) {
     EXPECT_EQ(lfc_controller.getPidFile(), "pid");
 }
 
+/// @brief Verify that parsing the options of the incremental cleanup works.
+/// The segment files are required when the incremental cleanup is enabled.
+TEST_F(LFCControllerTest, incrementalCommandLine) {
+    LFCController lfc_controller;
+
+    char* argv[] = { const_cast<char*>("progName"),
+                     const_cast<char*>("-4"),
+                     const_cast<char*>("-x"),
+                     const_cast<char*>("previous"),
+                     const_cast<char*>("-i"),
+                     const_cast<char*>("copy"),
+                     const_cast<char*>("-o"),
+                     const_cast<char*>("output"),
+                     const_cast<char*>("-c"),
+                     const_cast<char*>("config"),
+                     const_cast<char*>("-f"),
+                     const_cast<char*>("finish"),
+                     const_cast<char*>("-p"),
+                     const_cast<char*>("pid"),
+                     const_cast<char*>("-I"),
+                     const_cast<char*>("-s"),
+                     const_cast<char*>("segment"),
+                     const_cast<char*>("-g"),
+                     const_cast<char*>("segment-finish") };
+
+    // The incremental cleanup without the segment files is invalid.
+    for (int argc = 15; argc < 19; ++argc) {
+        EXPECT_THROW(lfc_controller.parseArgs(argc, argv), InvalidUsage)
+            << "test failed for argc = " << argc;
+    }
+
+    ASSERT_NO_THROW(lfc_controller.parseArgs(19, argv));
+
+    EXPECT_EQ(lfc_controller.getSegmentFile(), "segment");
+    EXPECT_EQ(lfc_controller.getSegmentFinishFile(), "segment-finish");
+    EXPECT_TRUE(lfc_controller.isIncremental());
+}
+
+/// @brief Verify that parsing the options of the conversion works.
+/// Only the input and output files are required for the conversion.
+TEST_F(LFCControllerTest, convertCommandLine) {
+    LFCController lfc_controller;
+
+    char* argv[] = { const_cast<char*>("progName"),
+                     const_cast<char*>("-6"),
+                     const_cast<char*>("-C"),
+                     const_cast<char*>("-b"),
+                     const_cast<char*>("-i"),
+                     const_cast<char*>("copy"),
+                     const_cast<char*>("-o"),
+                     const_cast<char*>("output") };
+
+    // The conversion without the input or output file is invalid.
+    for (int argc = 4; argc < 8; ++argc) {
+        EXPECT_THROW(lfc_controller.parseArgs(argc, argv), InvalidUsage)
+            << "test failed for argc = " << argc;
+    }
+
+    ASSERT_NO_THROW(lfc_controller.parseArgs(8, argv));
+
+    EXPECT_EQ(lfc_controller.getProtocolVersion(), 6);
+    EXPECT_EQ(lfc_controller.getCopyFile(), "copy");
+    EXPECT_EQ(lfc_controller.getOutputFile(), "output");
+    EXPECT_TRUE(lfc_controller.isConvert());
+    EXPECT_TRUE(lfc_controller.isBinary());
+}
+
 /// @brief Verify that parsing a correct but incomplete line fails.
 /// Parse a command line that is correctly formatted but isn't complete
 /// (doesn't include some options or an some option arguments).  We
@@ -363,6 +443,247 @@ TEST_F(LFCControllerTest, fileRotate) {
     removeTestFile();
 }
 
+/// @brief Verify that we do the segment file rotation correctly.  The
+/// previous file must be left intact by the incremental cleanup while
+/// the full cleanup must remove the segment files.
+TEST_F(LFCControllerTest, segmentRotate) {
+    LFCController lfc_controller;
+
+    char* argv[] = { const_cast<char*>("progName"),
+                     const_cast<char*>("-4"),
+                     const_cast<char*>("-x"),
+                     const_cast<char*>(xstr_.c_str()),
+                     const_cast<char*>("-i"),
+                     const_cast<char*>(istr_.c_str()),
+                     const_cast<char*>("-o"),
+                     const_cast<char*>(ostr_.c_str()),
+                     const_cast<char*>("-c"),
+                     const_cast<char*>(cstr_.c_str()),
+                     const_cast<char*>("-f"),
+                     const_cast<char*>(fstr_.c_str()),
+                     const_cast<char*>("-p"),
+                     const_cast<char*>(pstr_.c_str()),
+                     const_cast<char*>("-s"),
+                     const_cast<char*>(sstr_.c_str()),
+                     const_cast<char*>("-g"),
+                     const_cast<char*>(gstr_.c_str()),
+                     const_cast<char*>("-I")
+    };
+    int argc = 19;
+    lfc_controller.parseArgs(argc, argv);
+
+    // Test 1: Start with no files - we expect an execption as there
+    // is no file to copy.
+    EXPECT_THROW(lfc_controller.segmentRotate(), RunTimeFail);
+    removeTestFile();
+
+    // Test 2: Create a file for each of previous, segment, copy and segment
+    // finish.  We should delete the segment and copy files then move
+    // segment finish to segment.
+    writeFile(xstr_, "1");
+    writeFile(sstr_, "2");
+    writeFile(istr_, "3");
+    writeFile(gstr_, "4");
+
+    lfc_controller.segmentRotate();
+
+    EXPECT_EQ(readFile(xstr_), "1");
+    EXPECT_EQ(readFile(sstr_), "4");
+    EXPECT_TRUE(noExist(gstr_));
+    EXPECT_TRUE(noExistIOF());
+    removeTestFile();
+
+    // Test 3: The full cleanup merges the segment into the finish file
+    // so the segment files should be removed.
+    writeFile(xstr_, "5");
+    writeFile(sstr_, "6");
+    writeFile(istr_, "7");
+    writeFile(fstr_, "8");
+
+    lfc_controller.fileRotate();
+
+    EXPECT_EQ(readFile(xstr_), "8");
+    EXPECT_TRUE(noExist(sstr_));
+    EXPECT_TRUE(noExistIOF());
+    removeTestFile();
+
+    // Test 4: Use launch with both finish files.  The full cleanup
+    // supersedes the incremental one.
+    writeFile(xstr_, "9");
+    writeFile(sstr_, "10");
+    writeFile(gstr_, "11");
+    writeFile(fstr_, "12");
+
+    launch(lfc_controller, argc, argv);
+
+    EXPECT_EQ(readFile(xstr_), "12");
+    EXPECT_TRUE(noExist(sstr_));
+    EXPECT_TRUE(noExist(gstr_));
+    EXPECT_TRUE(noExistIOFP());
+}
+
+/// @brief Verify that the incremental cleanup only processes the changes
+/// and that the changes are merged into the previous file when they grow
+/// large.  This is the v4 version.
+TEST_F(LFCControllerTest, launch4Incremental) {
+    LFCController lfc_controller;
+
+    char* argv[] = { const_cast<char*>("progName"),
+                     const_cast<char*>("-4"),
+                     const_cast<char*>("-x"),
+                     const_cast<char*>(xstr_.c_str()),
+                     const_cast<char*>("-i"),
+                     const_cast<char*>(istr_.c_str()),
+                     const_cast<char*>("-o"),
+                     const_cast<char*>(ostr_.c_str()),
+                     const_cast<char*>("-c"),
+                     const_cast<char*>(cstr_.c_str()),
+                     const_cast<char*>("-f"),
+                     const_cast<char*>(fstr_.c_str()),
+                     const_cast<char*>("-p"),
+                     const_cast<char*>(pstr_.c_str()),
+                     const_cast<char*>("-s"),
+                     const_cast<char*>(sstr_.c_str()),
+                     const_cast<char*>("-g"),
+                     const_cast<char*>(gstr_.c_str()),
+                     const_cast<char*>("-I"),
+                     const_cast<char*>("-d")
+    };
+    int argc = 19;
+    string test_str;
+
+    string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                 "200,200,8,1,1,host.example.com\n";
+    string a_3 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                 "200,800,8,1,1,host.example.com\n";
+
+    string b_1 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                 "100,100,7,0,0,\n";
+
+    string d_1 = "192.0.2.5,16:17:18:19:1a:bc,,"
+                 "200,200,8,1,1,host.example.com\n";
+    string d_2 = "192.0.2.5,16:17:18:19:1a:bc,,"
+                 "0,200,8,1,1,host.example.com\n";
+
+    // Leases which don't change make the previous file large in
+    // comparison with the changes.
+    std::ostringstream stable;
+    for (int i = 1; i <= 20; ++i) {
+        stable << "192.0.4." << i << ",06:07:08:09:0a:bc,,"
+               << "200,200,8,1,1,host.example.com\n";
+    }
+
+    std::ostringstream added;
+    for (int i = 1; i <= 10; ++i) {
+        added << "192.0.5." << i << ",06:07:08:09:0a:bc,,"
+              << "200,200,8,1,1,host.example.com\n";
+    }
+
+    string prev_str = v4_hdr_ + a_1 + d_1 + stable.str();
+    writeFile(xstr_, prev_str);
+
+    // Subtest 1: the copy file is small so only the changes are written
+    // to the segment, including the released lease.
+    writeFile(istr_, v4_hdr_ + a_3 + d_2);
+
+    launch(lfc_controller, argc, argv);
+
+    EXPECT_EQ(readFile(xstr_), prev_str);
+    EXPECT_EQ(readFile(sstr_), v4_hdr_ + a_3 + d_2);
+    EXPECT_TRUE(noExist(gstr_));
+    EXPECT_TRUE(noExistIOFP());
+
+    // Subtest 2: the changes are added to the existing segment.
+    writeFile(istr_, v4_hdr_ + b_1);
+
+    launch(lfc_controller, argc, argv);
+
+    EXPECT_EQ(readFile(xstr_), prev_str);
+    EXPECT_EQ(readFile(sstr_), v4_hdr_ + a_3 + d_2 + b_1);
+    EXPECT_TRUE(noExist(gstr_));
+    EXPECT_TRUE(noExistIOFP());
+
+    // Subtest 3: the segment and copy files have grown large, so all
+    // leases are merged into the previous file and the released lease
+    // is removed.
+    writeFile(istr_, v4_hdr_ + added.str());
+
+    launch(lfc_controller, argc, argv);
+
+    test_str = v4_hdr_ + a_3 + b_1 + stable.str() + added.str();
+    EXPECT_EQ(readFile(xstr_), test_str);
+    EXPECT_TRUE(noExist(sstr_));
+    EXPECT_TRUE(noExist(gstr_));
+    EXPECT_TRUE(noExistIOFP());
+}
+
+/// @brief Verify that the lease file is converted to the binary format
+/// and back, and that the LFC reads the binary files.
+TEST_F(LFCControllerTest, launch4Convert) {
+    LFCController lfc_controller;
+
+    char* to_binary[] = { const_cast<char*>("progName"),
+                          const_cast<char*>("-4"),
+                          const_cast<char*>("-C"),
+                          const_cast<char*>("-b"),
+                          const_cast<char*>("-i"),
+                          const_cast<char*>(istr_.c_str()),
+                          const_cast<char*>("-o"),
+                          const_cast<char*>(xstr_.c_str()) };
+
+    string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                 "200,200,8,1,1,host.example.com\n";
+    string b_1 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                 "100,100,7,0,0,\n";
+    string c_1 = "192.0.2.5,16:17:18:19:1a:bc,,"
+                 "0,200,8,1,1,host.example.com\n";
+
+    // The released lease is kept by the conversion.
+    string test_str = v4_hdr_ + a_1 + c_1 + b_1;
+    writeFile(istr_, test_str);
+
+    ASSERT_NO_THROW(launch(lfc_controller, 8, to_binary));
+    EXPECT_TRUE(isc::dhcp::BinaryLeaseFile::isBinary(xstr_));
+    EXPECT_EQ(readFile(istr_), test_str);
+    EXPECT_TRUE(noExist(pstr_));
+
+    // Convert the binary file back to CSV.
+    char* to_csv[] = { const_cast<char*>("progName"),
+                       const_cast<char*>("-4"),
+                       const_cast<char*>("-C"),
+                       const_cast<char*>("-i"),
+                       const_cast<char*>(xstr_.c_str()),
+                       const_cast<char*>("-o"),
+                       const_cast<char*>(ostr_.c_str()) };
+
+    LFCController csv_controller;
+    ASSERT_NO_THROW(launch(csv_controller, 7, to_csv));
+    EXPECT_EQ(readFile(ostr_), test_str);
+
+    // The regular cleanup reads the binary previous file and writes
+    // the result in the CSV format, dropping the released lease.
+    char* cleanup[] = { const_cast<char*>("progName"),
+                        const_cast<char*>("-4"),
+                        const_cast<char*>("-x"),
+                        const_cast<char*>(xstr_.c_str()),
+                        const_cast<char*>("-i"),
+                        const_cast<char*>(istr_.c_str()),
+                        const_cast<char*>("-o"),
+                        const_cast<char*>(ostr_.c_str()),
+                        const_cast<char*>("-c"),
+                        const_cast<char*>(cstr_.c_str()),
+                        const_cast<char*>("-f"),
+                        const_cast<char*>(fstr_.c_str()),
+                        const_cast<char*>("-p"),
+                        const_cast<char*>(pstr_.c_str()) };
+
+    writeFile(istr_, v4_hdr_);
+    LFCController cleanup_controller;
+    launch(cleanup_controller, 14, cleanup);
+    EXPECT_EQ(readFile(xstr_), v4_hdr_ + a_1 + b_1);
+    EXPECT_TRUE(noExistIOFP());
+}
+
 /// @brief Verify that we properly combine and clean up files
 ///
 /// This is mostly a retest as we already test that the loader and
@@ -0,0 +1,418 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <dhcp/dhcp4.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/libdhcp++.h>
+#include <dhcp/option.h>
+#include <dhcp/pkt4.h>
+#include <dhcp/pkt6.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace isc::dhcp;
+using namespace boost::posix_time;
+
+/// @file pkt_bench.cc
+///
+/// This benchmark measures the time and the number of memory allocations
+/// per packet when the received DHCPv4 and DHCPv6 messages are unpacked
+/// and when the messages are packed. Each received message is unpacked
+/// in two modes:
+/// - at once, creating all options,
+/// - lazily, creating only the options which the server would retrieve
+///   while processing the message.
+///
+/// The messages carry the options which are typical for the cable modems
+/// and their clients. The number of iterations may be passed as the
+/// argument; it is 100000 by default.
+
+namespace {
+
+/// @brief Number of memory allocations since the start.
+size_t allocations = 0;
+
+}
+
+/// @brief Allocates memory counting the allocations.
+void*
+operator new(size_t size) {
+    ++allocations;
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return (ptr);
+}
+
+/// @brief Frees memory allocated with the counting operator new.
+void
+operator delete(void* ptr) throw() {
+    free(ptr);
+}
+
+namespace {
+
+/// @brief Test message in the on-wire format.
+struct Message {
+    /// @brief Name of the message.
+    std::string name_;
+    /// @brief On-wire format.
+    OptionBuffer wire_;
+    /// @brief Codes of the options retrieved by the server.
+    std::vector<uint16_t> used_;
+};
+
+/// @brief Appends a DHCPv4 option to the buffer.
+///
+/// @param buf Buffer.
+/// @param code Option code.
+/// @param data Option data.
+/// @param len Length of the data.
+void
+addOption4(OptionBuffer& buf, const uint8_t code, const uint8_t* data,
+           const size_t len) {
+    buf.push_back(code);
+    buf.push_back(static_cast<uint8_t>(len));
+    buf.insert(buf.end(), data, data + len);
+}
+
+/// @brief Appends a DHCPv6 option to the buffer.
+///
+/// @param buf Buffer.
+/// @param code Option code.
+/// @param data Option data.
+/// @param len Length of the data.
+void
+addOption6(OptionBuffer& buf, const uint16_t code, const uint8_t* data,
+           const size_t len) {
+    buf.push_back(static_cast<uint8_t>(code >> 8));
+    buf.push_back(static_cast<uint8_t>(code));
+    buf.push_back(static_cast<uint8_t>(len >> 8));
+    buf.push_back(static_cast<uint8_t>(len));
+    buf.insert(buf.end(), data, data + len);
+}
+
+/// @brief Creates the DHCPv4 message.
+///
+/// @param type Message type.
+Message
+createMessage4(const uint8_t type) {
+    Pkt4 pkt(type, 0x12345678);
+    const uint8_t mac[] = { 0x00, 0x0c, 0x01, 0x02, 0x03, 0x04 };
+    pkt.setHWAddr(HTYPE_ETHER, sizeof(mac),
+                  std::vector<uint8_t>(mac, mac + sizeof(mac)));
+    pkt.setGiaddr(isc::asiolink::IOAddress("10.0.0.1"));
+    pkt.pack();
+
+    const uint8_t* begin =
+        static_cast<const uint8_t*>(pkt.getBuffer().getData());
+    Message msg;
+    msg.name_ = (type == DHCPDISCOVER ? "DHCPDISCOVER" : "DHCPREQUEST");
+    // Skip the options packed with the message, but keep the cookie.
+    msg.wire_.assign(begin, begin + Pkt4::DHCPV4_PKT_HDR_LEN + 4);
+
+    addOption4(msg.wire_, DHO_DHCP_MESSAGE_TYPE, &type, 1);
+    const uint8_t client_id[] = { 1, 0x00, 0x0c, 0x01, 0x02, 0x03, 0x04 };
+    addOption4(msg.wire_, DHO_DHCP_CLIENT_IDENTIFIER, client_id,
+               sizeof(client_id));
+    const uint8_t max_size[] = { 0x05, 0xdc };
+    addOption4(msg.wire_, DHO_DHCP_MAX_MESSAGE_SIZE, max_size,
+               sizeof(max_size));
+    if (type == DHCPREQUEST) {
+        const uint8_t address[] = { 10, 0, 0, 100 };
+        addOption4(msg.wire_, DHO_DHCP_REQUESTED_ADDRESS, address,
+                   sizeof(address));
+        const uint8_t server_id[] = { 10, 0, 0, 2 };
+        addOption4(msg.wire_, DHO_DHCP_SERVER_IDENTIFIER, server_id,
+                   sizeof(server_id));
+    }
+    const uint8_t prl[] = { 1, 2, 3, 4, 7, 6, 15, 28, 42, 43, 51, 54, 58,
+                            59, 100, 101, 122, 125 };
+    addOption4(msg.wire_, DHO_DHCP_PARAMETER_REQUEST_LIST, prl, sizeof(prl));
+    const std::string vendor_class = "docsis3.0:0123456789abcdef";
+    addOption4(msg.wire_, DHO_VENDOR_CLASS_IDENTIFIER,
+               reinterpret_cast<const uint8_t*>(vendor_class.data()),
+               vendor_class.size());
+    const std::string hostname = "cable-modem-0001";
+    addOption4(msg.wire_, DHO_HOST_NAME,
+               reinterpret_cast<const uint8_t*>(hostname.data()),
+               hostname.size());
+
+    // Vendor specific information: the DOCSIS modem capabilities, which
+    // the server doesn't look at.
+    OptionBuffer vendor;
+    for (uint8_t code = 1; code < 20; ++code) {
+        const uint8_t data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+        addOption4(vendor, code, data, sizeof(data));
+    }
+    addOption4(msg.wire_, DHO_VENDOR_ENCAPSULATED_OPTIONS, &vendor[0],
+               vendor.size());
+
+    // Relay agent information.
+    OptionBuffer rai;
+    const uint8_t circuit_id[] = { 0x00, 0x04, 0x00, 0x01, 0x00, 0x02 };
+    addOption4(rai, RAI_OPTION_AGENT_CIRCUIT_ID, circuit_id,
+               sizeof(circuit_id));
+    addOption4(rai, RAI_OPTION_REMOTE_ID, mac, sizeof(mac));
+    addOption4(msg.wire_, DHO_DHCP_AGENT_OPTIONS, &rai[0], rai.size());
+    msg.wire_.push_back(DHO_END);
+
+    const uint16_t used[] = { DHO_DHCP_MESSAGE_TYPE,
+                              DHO_DHCP_CLIENT_IDENTIFIER,
+                              DHO_DHCP_AGENT_OPTIONS,
+                              DHO_DHCP_PARAMETER_REQUEST_LIST,
+                              DHO_VENDOR_CLASS_IDENTIFIER,
+                              DHO_HOST_NAME, DHO_FQDN,
+                              DHO_DHCP_REQUESTED_ADDRESS,
+                              DHO_DHCP_SERVER_IDENTIFIER,
+                              DHO_SUBNET_SELECTION };
+    msg.used_.assign(used, used + sizeof(used) / sizeof(used[0]));
+    return (msg);
+}
+
+/// @brief Creates the DHCPv6 message.
+///
+/// @param type Message type.
+/// @param relayed Indicates if the message should be relayed.
+Message
+createMessage6(const uint8_t type, const bool relayed) {
+    Message msg;
+    msg.name_ = std::string(Pkt6::getName(type)) +
+        (relayed ? " (relayed)" : "");
+    msg.wire_.push_back(type);
+    msg.wire_.push_back(0x12);
+    msg.wire_.push_back(0x34);
+    msg.wire_.push_back(0x56);
+
+    const uint8_t duid[] = { 0x00, 0x01, 0x00, 0x01, 0x1d, 0x2e, 0x3f, 0x40,
+                             0x00, 0x0c, 0x01, 0x02, 0x03, 0x04 };
+    addOption6(msg.wire_, D6O_CLIENTID, duid, sizeof(duid));
+    if (type == DHCPV6_REQUEST) {
+        addOption6(msg.wire_, D6O_SERVERID, duid, sizeof(duid));
+    }
+
+    // IA_NA, holding the address in the Request.
+    OptionBuffer ia(12, 0);
+    ia[3] = 1;
+    if (type == DHCPV6_REQUEST) {
+        OptionBuffer iaaddr(24, 0);
+        iaaddr[0] = 0x20;
+        iaaddr[1] = 0x01;
+        iaaddr[2] = 0x0d;
+        iaaddr[3] = 0xb8;
+        iaaddr[15] = 0x10;
+        addOption6(ia, D6O_IAADDR, &iaaddr[0], iaaddr.size());
+    }
+    addOption6(msg.wire_, D6O_IA_NA, &ia[0], ia.size());
+
+    const uint8_t elapsed[] = { 0, 0 };
+    addOption6(msg.wire_, D6O_ELAPSED_TIME, elapsed, sizeof(elapsed));
+    const uint8_t oro[] = { 0, 23, 0, 24, 0, 17, 0, 32, 0, 31 };
+    addOption6(msg.wire_, D6O_ORO, oro, sizeof(oro));
+
+    // Vendor class and vendor specific information of a DOCSIS modem.
+    const uint8_t vendor_class[] = { 0x00, 0x00, 0x11, 0x8b, 0x00, 0x09,
+                                     'd', 'o', 'c', 's', 'i', 's', '3',
+                                     '.', '0' };
+    addOption6(msg.wire_, D6O_VENDOR_CLASS, vendor_class,
+               sizeof(vendor_class));
+    OptionBuffer vendor;
+    vendor.push_back(0x00);
+    vendor.push_back(0x00);
+    vendor.push_back(0x11);
+    vendor.push_back(0x8b);
+    for (uint16_t code = 1; code < 20; ++code) {
+        const uint8_t data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+        addOption6(vendor, code + 2000, data, sizeof(data));
+    }
+    addOption6(msg.wire_, D6O_VENDOR_OPTS, &vendor[0], vendor.size());
+
+    if (relayed) {
+        OptionBuffer relay;
+        relay.push_back(DHCPV6_RELAY_FORW);
+        relay.push_back(0);
+        // Link address and peer address.
+        OptionBuffer addr(16, 0);
+        addr[0] = 0x20;
+        addr[1] = 0x01;
+        addr[2] = 0x0d;
+        addr[3] = 0xb8;
+        relay.insert(relay.end(), addr.begin(), addr.end());
+        addr[0] = 0xfe;
+        addr[1] = 0x80;
+        addr[2] = 0x00;
+        addr[3] = 0x00;
+        relay.insert(relay.end(), addr.begin(), addr.end());
+        const std::string interface_id = "cable-modem-port-1";
+        addOption6(relay, D6O_INTERFACE_ID,
+                   reinterpret_cast<const uint8_t*>(interface_id.data()),
+                   interface_id.size());
+        addOption6(relay, D6O_RELAY_MSG, &msg.wire_[0], msg.wire_.size());
+        msg.wire_.swap(relay);
+    }
+
+    const uint16_t used[] = { D6O_CLIENTID, D6O_SERVERID, D6O_IA_NA,
+                              D6O_IA_PD, D6O_IA_TA, D6O_ORO,
+                              D6O_CLIENT_FQDN, D6O_RAPID_COMMIT,
+                              D6O_VENDOR_CLASS };
+    msg.used_.assign(used, used + sizeof(used) / sizeof(used[0]));
+    return (msg);
+}
+
+/// @brief Results of the measurement.
+struct Result {
+    /// @brief Time per packet in nanoseconds.
+    double time_;
+    /// @brief Allocations per packet.
+    double allocations_;
+};
+
+/// @brief Unpacks the message the given number of times.
+///
+/// @tparam PktType Pkt4 or Pkt6.
+/// @param msg Message.
+/// @param lazy Indicates if the options should be unpacked lazily.
+/// @param iterations Number of iterations.
+template<typename PktType>
+Result
+unpack(const Message& msg, const bool lazy, const size_t iterations) {
+    size_t found = 0;
+    const size_t start_allocations = allocations;
+    const ptime start = microsec_clock::universal_time();
+    for (size_t i = 0; i < iterations; ++i) {
+        PktType pkt(&msg.wire_[0], msg.wire_.size());
+        pkt.setLazyUnpack(lazy);
+        pkt.unpack();
+        for (size_t j = 0; j < msg.used_.size(); ++j) {
+            if (pkt.getOption(msg.used_[j])) {
+                ++found;
+            }
+        }
+    }
+    const time_duration elapsed = microsec_clock::universal_time() - start;
+
+    if (found == 0) {
+        std::cerr << "no options found in " << msg.name_ << std::endl;
+    }
+    Result result;
+    result.time_ = elapsed.total_microseconds() * 1000.0 / iterations;
+    result.allocations_ = static_cast<double>(allocations - start_allocations) /
+        iterations;
+    return (result);
+}
+
+/// @brief Packs the message the given number of times.
+///
+/// The options of the message are created once, and the message is
+/// packed in each iteration.
+///
+/// @tparam PktType Pkt4 or Pkt6.
+/// @param msg Message.
+/// @param iterations Number of iterations.
+template<typename PktType>
+Result
+pack(const Message& msg, const size_t iterations) {
+    PktType pkt(&msg.wire_[0], msg.wire_.size());
+    pkt.unpack();
+
+    const size_t start_allocations = allocations;
+    const ptime start = microsec_clock::universal_time();
+    for (size_t i = 0; i < iterations; ++i) {
+        pkt.pack();
+    }
+    const time_duration elapsed = microsec_clock::universal_time() - start;
+
+    Result result;
+    result.time_ = elapsed.total_microseconds() * 1000.0 / iterations;
+    result.allocations_ = static_cast<double>(allocations - start_allocations) /
+        iterations;
+    return (result);
+}
+
+/// @brief Prints the result.
+///
+/// @param name Name of the measurement.
+/// @param result Result.
+void
+printResult(const std::string& name, const Result& result) {
+    std::cout << "  " << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(0) << std::setw(8)
+              << result.time_ << " ns/packet"
+              << std::setprecision(1) << std::setw(8) << result.allocations_
+              << " allocations/packet" << std::endl;
+}
+
+/// @brief Runs the measurements for the message.
+///
+/// @tparam PktType Pkt4 or Pkt6.
+/// @param msg Message.
+/// @param iterations Number of iterations.
+template<typename PktType>
+void
+run(const Message& msg, const size_t iterations) {
+    std::cout << msg.name_ << ", " << msg.wire_.size() << " bytes"
+              << std::endl;
+    printResult("unpack", unpack<PktType>(msg, false, iterations));
+    printResult("lazy unpack", unpack<PktType>(msg, true, iterations));
+    printResult("pack", pack<PktType>(msg, iterations));
+}
+
+}
+
+int
+main(int argc, char* argv[]) {
+    size_t iterations = 100000;
+    if (argc > 1) {
+        try {
+            iterations = boost::lexical_cast<size_t>(argv[1]);
+        } catch (const boost::bad_lexical_cast&) {
+            std::cerr << "invalid number of iterations " << argv[1]
+                      << std::endl;
+            return (1);
+        }
+    }
+    if (iterations == 0) {
+        std::cerr << "the number of iterations must be greater than 0"
+                  << std::endl;
+        return (1);
+    }
+
+    // Initialize the option definitions before measuring.
+    LibDHCP::getOptionDefs(Option::V4);
+    LibDHCP::getOptionDefs(Option::V6);
+
+    try {
+        run<Pkt4>(createMessage4(DHCPDISCOVER), iterations);
+        run<Pkt4>(createMessage4(DHCPREQUEST), iterations);
+        run<Pkt6>(createMessage6(DHCPV6_SOLICIT, false), iterations);
+        run<Pkt6>(createMessage6(DHCPV6_REQUEST, false), iterations);
+        run<Pkt6>(createMessage6(DHCPV6_SOLICIT, true), iterations);
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << std::endl;
+        return (1);
+    }
+
+    return (0);
+}
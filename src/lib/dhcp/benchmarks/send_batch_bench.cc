@@ -0,0 +1,257 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/iface_mgr.h>
+#include <dhcp/pkt4.h>
+#include <dhcp/pkt_filter_inet.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace boost::posix_time;
+
+/// @file send_batch_bench.cc
+///
+/// This benchmark measures the time per packet and the number of packets
+/// sent per system call when the DHCPv4 responses are sent over the
+/// loopback interface one by one with @c PktFilterInet::send and in
+/// batches of various sizes with @c PktFilterInet::sendBatch. The number
+/// of packets sent in each measurement may be passed as the argument;
+/// it is 100000 by default.
+///
+/// The system calls are counted by the sendmsg() and sendmmsg() wrappers
+/// defined below, which take precedence over the C library functions.
+
+namespace {
+
+/// @brief Number of system calls sending the packets since the start.
+size_t send_calls = 0;
+
+/// @brief Port to which the packets are sent.
+const uint16_t PORT = 10547;
+
+}
+
+#if defined (SYS_sendmsg)
+/// @brief Sends a message counting the system calls.
+extern "C" ssize_t
+sendmsg(int sockfd, const struct msghdr* msg, int flags) {
+    ++send_calls;
+    return (syscall(SYS_sendmsg, sockfd, msg, flags));
+}
+#endif
+
+#if defined (SYS_sendmmsg) && defined (MSG_WAITFORONE)
+/// @brief Sends multiple messages counting the system calls.
+extern "C" int
+sendmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+    ++send_calls;
+    return (syscall(SYS_sendmmsg, sockfd, msgvec, vlen, flags));
+}
+#endif
+
+namespace {
+
+/// @brief Results of the measurement.
+struct Result {
+    /// @brief Time per packet in nanoseconds.
+    double time_;
+    /// @brief Packets sent per system call.
+    double pkts_per_call_;
+};
+
+/// @brief Reads and discards the packets received over the socket.
+///
+/// @param sockfd Non-blocking socket.
+void
+drain(const int sockfd) {
+    char buf[IfaceMgr::RCVBUFSIZE];
+    while (recv(sockfd, buf, sizeof(buf), 0) > 0) {
+        ;
+    }
+}
+
+/// @brief Sends the packets in batches of the given size.
+///
+/// @param pkt_filter Packet filter.
+/// @param iface Loopback interface.
+/// @param sockfd Socket over which the packets are sent.
+/// @param recv_sockfd Socket receiving the packets.
+/// @param pkt Packet to be sent.
+/// @param batch_size Number of packets in a batch, 0 if the packets should
+/// be sent one by one.
+/// @param num_pkts Number of packets to be sent.
+Result
+sendPackets(PktFilterInet& pkt_filter, const Iface& iface, const int sockfd,
+            const int recv_sockfd, const Pkt4Ptr& pkt,
+            const size_t batch_size, const size_t num_pkts) {
+    const Pkt4Collection batch(batch_size > 0 ? batch_size : 1, pkt);
+    size_t sent = 0;
+    size_t calls = 0;
+    time_duration elapsed;
+    while (sent < num_pkts) {
+        // Don't let the receive buffer overflow, but don't count the time
+        // spent reading the packets.
+        drain(recv_sockfd);
+
+        const size_t start_calls = send_calls;
+        const ptime start = microsec_clock::universal_time();
+        if (batch_size == 0) {
+            pkt_filter.send(iface, sockfd, pkt);
+            ++sent;
+        } else {
+            sent += pkt_filter.sendBatch(iface, sockfd, batch);
+        }
+        elapsed += microsec_clock::universal_time() - start;
+        calls += send_calls - start_calls;
+    }
+
+    Result result;
+    result.time_ = elapsed.total_microseconds() * 1000.0 / sent;
+    result.pkts_per_call_ = calls > 0 ? static_cast<double>(sent) / calls : 0;
+    return (result);
+}
+
+/// @brief Prints the result.
+///
+/// @param name Name of the measurement.
+/// @param result Result.
+void
+printResult(const std::string& name, const Result& result) {
+    std::cout << "  " << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(0) << std::setw(8)
+              << result.time_ << " ns/packet"
+              << std::setprecision(1) << std::setw(8)
+              << result.pkts_per_call_ << " packets/syscall" << std::endl;
+}
+
+/// @brief Opens the socket receiving the packets.
+///
+/// @return Non-blocking socket bound to the loopback address.
+int
+openReceiveSocket() {
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0) {
+        isc_throw(SocketConfigError, "failed to open the receive socket: "
+                  << strerror(errno));
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(PORT);
+    if ((bind(sockfd, reinterpret_cast<struct sockaddr*>(&addr),
+              sizeof(addr)) < 0) ||
+        (fcntl(sockfd, F_SETFL, O_NONBLOCK) < 0)) {
+        close(sockfd);
+        isc_throw(SocketConfigError, "failed to set up the receive socket: "
+                  << strerror(errno));
+    }
+    return (sockfd);
+}
+
+}
+
+int
+main(int argc, char* argv[]) {
+    size_t num_pkts = 100000;
+    if (argc > 1) {
+        try {
+            num_pkts = boost::lexical_cast<size_t>(argv[1]);
+        } catch (const boost::bad_lexical_cast&) {
+            std::cerr << "invalid number of packets " << argv[1]
+                      << std::endl;
+            return (1);
+        }
+    }
+    if (num_pkts == 0) {
+        std::cerr << "the number of packets must be greater than 0"
+                  << std::endl;
+        return (1);
+    }
+
+    // The loopback interface is named lo on Linux and lo0 on BSD systems.
+    std::string ifname = "lo";
+    unsigned int ifindex = if_nametoindex(ifname.c_str());
+    if (ifindex == 0) {
+        ifname = "lo0";
+        ifindex = if_nametoindex(ifname.c_str());
+    }
+    if (ifindex == 0) {
+        std::cerr << "loopback interface not found" << std::endl;
+        return (1);
+    }
+    Iface iface(ifname, ifindex);
+
+    PktFilterInet pkt_filter;
+    int recv_sockfd = -1;
+    SocketInfo sock_info(IOAddress("127.0.0.1"), PORT + 1, -1);
+    try {
+        recv_sockfd = openReceiveSocket();
+        sock_info = pkt_filter.openSocket(iface, IOAddress("127.0.0.1"),
+                                          PORT + 1, false, false);
+
+        Pkt4Ptr pkt(new Pkt4(DHCPOFFER, 0x12345678));
+        pkt->setLocalAddr(IOAddress("127.0.0.1"));
+        pkt->setLocalPort(PORT + 1);
+        pkt->setRemoteAddr(IOAddress("127.0.0.1"));
+        pkt->setRemotePort(PORT);
+        pkt->setIface(ifname);
+        pkt->setIndex(ifindex);
+        pkt->setYiaddr(IOAddress("10.0.0.100"));
+        pkt->pack();
+
+        std::cout << "DHCPOFFER, " << pkt->getBuffer().getLength()
+                  << " bytes" << std::endl;
+        printResult("send", sendPackets(pkt_filter, iface, sock_info.sockfd_,
+                                        recv_sockfd, pkt, 0, num_pkts));
+        const size_t batch_sizes[] = { 1, 8, 32, 64 };
+        for (size_t i = 0; i < sizeof(batch_sizes) / sizeof(batch_sizes[0]);
+             ++i) {
+            printResult("batch of " +
+                        boost::lexical_cast<std::string>(batch_sizes[i]),
+                        sendPackets(pkt_filter, iface, sock_info.sockfd_,
+                                    recv_sockfd, pkt, batch_sizes[i],
+                                    num_pkts));
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << std::endl;
+        if (recv_sockfd >= 0) {
+            close(recv_sockfd);
+        }
+        return (1);
+    }
+
+    close(sock_info.sockfd_);
+    close(recv_sockfd);
+    return (0);
+}
@@ -19,6 +19,7 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/constants.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/functional/hash.hpp>
 #include <iomanip>
 #include <cctype>
 #include <sstream>
@@ -37,6 +38,7 @@ DUID::DUID(const std::vector<uint8_t>& duid) {
         isc_throw(isc::BadValue, "Empty DUIDs are not allowed");
     }
     duid_ = duid;
+    hash_ = boost::hash_range(duid_.begin(), duid_.end());
 }
 
 DUID::DUID(const uint8_t* data, size_t len) {
@@ -48,6 +50,7 @@ DUID::DUID(const uint8_t* data, size_t len) {
     }
 
     duid_ = std::vector<uint8_t>(data, data + len);
+    hash_ = boost::hash_range(duid_.begin(), duid_.end());
 }
 
 std::vector<uint8_t>
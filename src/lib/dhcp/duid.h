@@ -66,6 +66,15 @@ class DUID {
     /// @return A reference to a vector holding a DUID.
     const std::vector<uint8_t>& getDuid() const;
 
+    /// @brief Returns the hash of the DUID value.
+    ///
+    /// The hash is computed by the constructor with @c boost::hash_range
+    /// over the DUID bytes, so the DUID may be used as a key of the hashed
+    /// containers without hashing it for each lookup.
+    size_t getHash() const {
+        return (hash_);
+    }
+
     /// @brief Returns the DUID type
     DUIDType getType() const;
 
@@ -109,6 +118,9 @@ class DUID {
 
     /// The actual content of the DUID
     std::vector<uint8_t> duid_;
+
+    /// Hash of the DUID value
+    size_t hash_;
 };
 
 /// @brief Shared pointer to a DUID
@@ -28,6 +28,7 @@
 #include <exceptions/exceptions.h>
 #include <util/io/pktinfo_utilities.h>
 
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
 #include <cstring>
@@ -36,15 +37,39 @@
 #include <sstream>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <netinet/in.h>
 #include <string.h>
 #include <sys/select.h>
+#if defined(OS_LINUX)
+#include <sys/epoll.h>
+#endif
 
 using namespace std;
 using namespace isc::asiolink;
 using namespace isc::util;
 using namespace isc::util::io::internal;
 
+namespace {
+
+/// @brief Counter of the changes of the sockets of all interfaces.
+uint64_t sockets_version = 0;
+
+/// @brief Retains the first error reported by @c IfaceMgr::sendBatch.
+///
+/// @param [out] first_error first error message.
+/// @param errmsg error message.
+void
+retainFirstSendError(std::string* first_error, const isc::dhcp::Pkt4Ptr&,
+                     const std::string& errmsg) {
+    if (first_error->empty()) {
+        *first_error = errmsg;
+    }
+}
+
+}
+
 namespace isc {
 namespace dhcp {
 
@@ -99,6 +124,7 @@ Iface::closeSockets(const uint16_t family) {
                 close(sock->fallbackfd_);
             }
             sockets_.erase(sock++);
+            updateSocketsVersion();
 
         } else {
             // Different type of socket. Let's move
@@ -163,6 +189,7 @@ bool Iface::delSocket(const uint16_t sockfd) {
                 close(sock->fallbackfd_);
             }
             sockets_.erase(sock);
+            updateSocketsVersion();
             return (true); //socket found
         }
         ++sock;
@@ -170,12 +197,23 @@ bool Iface::delSocket(const uint16_t sockfd) {
     return (false); // socket not found
 }
 
+uint64_t
+Iface::getSocketsVersion() {
+    return (sockets_version);
+}
+
+void
+Iface::updateSocketsVersion() {
+    ++sockets_version;
+}
+
 IfaceMgr::IfaceMgr()
     :control_buf_len_(CMSG_SPACE(sizeof(struct in6_pktinfo))),
      control_buf_(new char[control_buf_len_]),
      packet_filter_(new PktFilterInet()),
      packet_filter6_(new PktFilterInet6()),
-     test_mode_(false)
+     test_mode_(false), epoll_fd_(-1), epoll_family_(0), epoll_version_(0),
+     epoll_usable_(false)
 {
 
     try {
@@ -267,6 +305,7 @@ Iface::countActive4() const {
 
 void IfaceMgr::closeSockets() {
     BOOST_FOREACH(IfacePtr iface, ifaces_) {
+        releaseSockets4(*iface);
         iface->closeSockets();
     }
 }
@@ -274,15 +313,33 @@ void IfaceMgr::closeSockets() {
 void
 IfaceMgr::closeSockets(const uint16_t family) {
     BOOST_FOREACH(IfacePtr iface, ifaces_) {
+        if (family == AF_INET) {
+            releaseSockets4(*iface);
+        }
         iface->closeSockets(family);
     }
 }
 
+void
+IfaceMgr::releaseSockets4(const Iface& iface) {
+    // The IPv4 sockets have been opened by the packet filter, which may
+    // hold some resources for them.
+    BOOST_FOREACH(const SocketInfo& sock, iface.getSockets()) {
+        if (sock.family_ == AF_INET) {
+            packet_filter_->releaseSocket(sock);
+        }
+    }
+}
+
 IfaceMgr::~IfaceMgr() {
     // control_buf_ is deleted automatically (scoped_ptr)
     control_buf_len_ = 0;
 
     closeSockets();
+
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
 }
 
 bool
@@ -306,6 +363,7 @@ IfaceMgr::addExternalSocket(int socketfd, SocketCallback callback) {
     x.socket_ = socketfd;
     x.callback_ = callback;
     callbacks_.push_back(x);
+    Iface::updateSocketsVersion();
 }
 
 void
@@ -314,6 +372,7 @@ IfaceMgr::deleteExternalSocket(int socketfd) {
          s != callbacks_.end(); ++s) {
         if (s->socket_ == socketfd) {
             callbacks_.erase(s);
+            Iface::updateSocketsVersion();
             return;
         }
     }
@@ -673,6 +732,7 @@ IfaceMgr::getIface(const std::string& ifname) {
 void
 IfaceMgr::clearIfaces() {
     ifaces_.clear();
+    Iface::updateSocketsVersion();
 }
 
 void
@@ -872,122 +932,225 @@ IfaceMgr::send(const Pkt4Ptr& pkt) {
     return (packet_filter_->send(*iface, getSocket(*pkt).sockfd_, pkt));
 }
 
+size_t
+IfaceMgr::sendBatch(const Pkt4Collection& pkts,
+                    const PktSendErrorCallback& error_callback) {
+    // Without the callback, the first error is thrown when all packets
+    // which can be sent have been sent.
+    std::string first_error;
+    PktSendErrorCallback callback = error_callback;
+    if (!callback) {
+        callback = boost::bind(&retainFirstSendError, &first_error, _1, _2);
+    }
 
-boost::shared_ptr<Pkt4>
-IfaceMgr::receive4(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
-    // Sanity check for microsecond timeout.
-    if (timeout_usec >= 1000000) {
-        isc_throw(BadValue, "fractional timeout must be shorter than"
-                  " one million microseconds");
+    size_t sent = 0;
+    Pkt4Collection group;
+    IfacePtr group_iface;
+    int group_sockfd = -1;
+    for (Pkt4Collection::const_iterator pkt = pkts.begin(); pkt != pkts.end();
+         ++pkt) {
+        IfacePtr iface = getIface((*pkt)->getIface());
+        if (!iface) {
+            callback(*pkt, "Unable to send DHCPv4 message. Invalid interface ("
+                     + (*pkt)->getIface() + ") specified.");
+            continue;
+        }
+        int sockfd = -1;
+        try {
+            sockfd = getSocket(**pkt).sockfd_;
+        } catch (const std::exception& ex) {
+            callback(*pkt, ex.what());
+            continue;
+        }
+
+        // Pass the packets to be sent over the same socket together.
+        if (!group.empty() &&
+            ((iface != group_iface) || (sockfd != group_sockfd))) {
+            sent += sendGroup(*group_iface, group_sockfd, group, callback);
+        }
+        group_iface = iface;
+        group_sockfd = sockfd;
+        group.push_back(*pkt);
+    }
+    if (!group.empty()) {
+        sent += sendGroup(*group_iface, group_sockfd, group, callback);
     }
-    const SocketInfo* candidate = 0;
-    IfacePtr iface;
-    fd_set sockets;
-    int maxfd = 0;
 
-    FD_ZERO(&sockets);
+    if (!first_error.empty()) {
+        isc_throw(SocketWriteError, first_error);
+    }
+    return (sent);
+}
 
-    /// @todo: marginal performance optimization. We could create the set once
-    /// and then use its copy for select(). Please note that select() modifies
-    /// provided set to indicated which sockets have something to read.
-    BOOST_FOREACH(iface, ifaces_) {
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
+size_t
+IfaceMgr::sendGroup(const Iface& iface, const int sockfd,
+                    Pkt4Collection& group,
+                    const PktSendErrorCallback& error_callback) {
+    size_t sent = 0;
+    try {
+        sent = packet_filter_->sendBatch(iface, sockfd, group, error_callback);
+    } catch (const std::exception& ex) {
+        // The packet filter has failed before sending the packets, so
+        // none of them has been sent.
+        for (Pkt4Collection::const_iterator pkt = group.begin();
+             pkt != group.end(); ++pkt) {
+            error_callback(*pkt, ex.what());
+        }
+    }
+    group.clear();
+    return (sent);
+}
 
-            // Only deal with IPv4 addresses.
-            if (s.addr_.isV4()) {
+bool
+IfaceMgr::registerEpollSockets(const uint16_t family) {
+#if defined(OS_LINUX)
+    epoll_sockets_.clear();
+    // Closing the epoll set removes all registrations, so it is simpler
+    // to create a new set than to find out which sockets have changed.
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        return (false);
+    }
 
-                // Add this socket to listening set
-                FD_SET(s.sockfd_, &sockets);
-                if (maxfd < s.sockfd_) {
-                    maxfd = s.sockfd_;
-                }
+    // The external sockets come first, because select() checks them first.
+    BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
+        EpollSocket sock;
+        sock.sockfd_ = s.socket_;
+        sock.socket_ = 0;
+        sock.callback_ = s.callback_;
+        epoll_sockets_.push_back(sock);
+    }
+    BOOST_FOREACH(IfacePtr iface, ifaces_) {
+        const Iface::SocketCollection& sockets = iface->getSockets();
+        for (Iface::SocketCollection::const_iterator s = sockets.begin();
+             s != sockets.end(); ++s) {
+            if ((family == AF_INET) ? s->addr_.isV4() : s->addr_.isV6()) {
+                EpollSocket sock;
+                sock.sockfd_ = s->sockfd_;
+                sock.iface_ = iface;
+                sock.socket_ = &(*s);
+                epoll_sockets_.push_back(sock);
             }
         }
     }
 
-    // if there are any callbacks for external sockets registered...
-    if (!callbacks_.empty()) {
-        BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
-            FD_SET(s.socket_, &sockets);
-            if (maxfd < s.socket_) {
-                maxfd = s.socket_;
+    for (size_t i = 0; i < epoll_sockets_.size(); ++i) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u32 = static_cast<uint32_t>(i);
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, epoll_sockets_[i].sockfd_,
+                      &event) < 0) {
+            // The same descriptor may be used by many sockets, in which
+            // case the first one is used, as with select(). Other errors,
+            // e.g. a descriptor which doesn't support polling, make us
+            // fall back to select().
+            if (errno != EEXIST) {
+                return (false);
             }
         }
     }
+    return (true);
+#else
+    static_cast<void>(family);
+    return (false);
+#endif
+}
 
-    struct timeval select_timeout;
-    select_timeout.tv_sec = timeout_sec;
-    select_timeout.tv_usec = timeout_usec;
-
-    int result = select(maxfd + 1, &sockets, NULL, NULL, &select_timeout);
-
-    if (result == 0) {
-        // nothing received and timeout has been reached
-        return (Pkt4Ptr()); // NULL
+bool
+IfaceMgr::receiveEpoll(const uint16_t family, const uint32_t timeout_sec,
+                       const uint32_t timeout_usec, IfacePtr& iface,
+                       const SocketInfo*& candidate) {
+#if defined(OS_LINUX)
+    candidate = 0;
+    // Register the sockets again if they have changed since they have
+    // been registered.
+    if ((epoll_family_ != family) ||
+        (epoll_version_ != Iface::getSocketsVersion())) {
+        epoll_usable_ = registerEpollSockets(family);
+        epoll_family_ = family;
+        epoll_version_ = Iface::getSocketsVersion();
+    }
+    if (!epoll_usable_) {
+        return (false);
+    }
 
-    } else if (result < 0) {
-        // In most cases we would like to know whether select() returned
-        // an error because of a signal being received  or for some other
-        // reasaon. This is because DHCP servers use signals to trigger
-        // certain actions, like reconfiguration or graceful shutdown.
-        // By catching a dedicated exception the caller will know if the
-        // error returned by the function is due to the reception of the
-        // signal or for some other reason.
+    // The timeout is rounded up to milliseconds, so as the caller doesn't
+    // spin when the timeout is shorter than a millisecond.
+    const uint64_t timeout_ms = static_cast<uint64_t>(timeout_sec) * 1000 +
+        (timeout_usec + 999) / 1000;
+    struct epoll_event event;
+    int result = epoll_wait(epoll_fd_, &event, 1,
+                            timeout_ms > INT_MAX ? INT_MAX :
+                            static_cast<int>(timeout_ms));
+
+    if (result < 0) {
+        // See the comment in receive4() about the signals.
         if (errno == EINTR) {
             isc_throw(SignalInterruptOnSelect, strerror(errno));
         } else {
             isc_throw(SocketReadError, strerror(errno));
         }
-    }
 
-    // Let's find out which socket has the data
-    BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
-        if (!FD_ISSET(s.socket_, &sockets)) {
-            continue;
+    } else if (result == 0) {
+        // A closed descriptor is silently removed from the epoll set,
+        // while select() reports an error for it. Check the descriptors
+        // when the timeout has been reached, so as the caller learns about
+        // the sockets closed behind our back.
+        for (size_t i = 0; i < epoll_sockets_.size(); ++i) {
+            if ((fcntl(epoll_sockets_[i].sockfd_, F_GETFD) < 0) &&
+                (errno == EBADF)) {
+                // Register the remaining sockets again on the next call.
+                epoll_family_ = 0;
+                isc_throw(SocketReadError, strerror(EBADF));
+            }
         }
+        return (true);
+    }
 
-        // something received over external socket
-
+    const EpollSocket& sock = epoll_sockets_[event.data.u32];
+    if (!sock.socket_) {
         // Calling the external socket's callback provides its service
         // layer access without integrating any specific features
         // in IfaceMgr
-        if (s.callback_) {
-            s.callback_();
+        if (sock.callback_) {
+            sock.callback_();
         }
-
-        return (Pkt4Ptr());
+        return (true);
     }
 
-    // Let's find out which interface/socket has the data
-    BOOST_FOREACH(iface, ifaces_) {
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
-            if (FD_ISSET(s.sockfd_, &sockets)) {
-                candidate = &(s);
-                break;
-            }
-        }
-        if (candidate) {
-            break;
-        }
-    }
-
-    if (!candidate) {
-        isc_throw(SocketReadError, "received data over unknown socket");
-    }
-
-    // Now we have a socket, let's get some data from it!
-    // Assuming that packet filter is not NULL, because its modifier checks it.
-    return (packet_filter_->receive(*iface, *candidate));
+    iface = sock.iface_;
+    candidate = sock.socket_;
+    return (true);
+#else
+    static_cast<void>(family);
+    static_cast<void>(timeout_sec);
+    static_cast<void>(timeout_usec);
+    static_cast<void>(iface);
+    static_cast<void>(candidate);
+    return (false);
+#endif
 }
 
-Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+bool
+IfaceMgr::selectSocket(const uint16_t family, const uint32_t timeout_sec,
+                       const uint32_t timeout_usec, IfacePtr& iface,
+                       const SocketInfo*& candidate) {
     // Sanity check for microsecond timeout.
     if (timeout_usec >= 1000000) {
         isc_throw(BadValue, "fractional timeout must be shorter than"
                   " one million microseconds");
     }
+    candidate = 0;
+
+    // Use epoll if possible. Otherwise, fall back to select().
+    if (receiveEpoll(family, timeout_sec, timeout_usec, iface, candidate)) {
+        return (candidate != 0);
+    }
 
-    const SocketInfo* candidate = 0;
     fd_set sockets;
     int maxfd = 0;
 
@@ -996,11 +1159,11 @@ Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */
     /// @todo: marginal performance optimization. We could create the set once
     /// and then use its copy for select(). Please note that select() modifies
     /// provided set to indicated which sockets have something to read.
-    BOOST_FOREACH(IfacePtr iface, ifaces_) {
+    BOOST_FOREACH(IfacePtr i, ifaces_) {
+        BOOST_FOREACH(const SocketInfo& s, i->getSockets()) {
 
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
-            // Only deal with IPv6 addresses.
-            if (s.addr_.isV6()) {
+            // Only deal with the addresses of the specified family.
+            if ((family == AF_INET) ? s.addr_.isV4() : s.addr_.isV6()) {
 
                 // Add this socket to listening set
                 FD_SET(s.sockfd_, &sockets);
@@ -1014,7 +1177,6 @@ Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */
     // if there are any callbacks for external sockets registered...
     if (!callbacks_.empty()) {
         BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
-            // Add it to the set as well
             FD_SET(s.socket_, &sockets);
             if (maxfd < s.socket_) {
                 maxfd = s.socket_;
@@ -1030,7 +1192,7 @@ Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */
 
     if (result == 0) {
         // nothing received and timeout has been reached
-        return (Pkt6Ptr()); // NULL
+        return (false);
 
     } else if (result < 0) {
         // In most cases we would like to know whether select() returned
@@ -1062,29 +1224,77 @@ Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */
             s.callback_();
         }
 
-        return (Pkt6Ptr());
+        return (false);
     }
 
     // Let's find out which interface/socket has the data
-    BOOST_FOREACH(IfacePtr iface, ifaces_) {
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
+    BOOST_FOREACH(IfacePtr i, ifaces_) {
+        BOOST_FOREACH(const SocketInfo& s, i->getSockets()) {
             if (FD_ISSET(s.sockfd_, &sockets)) {
+                iface = i;
                 candidate = &(s);
-                break;
+                return (true);
             }
         }
-        if (candidate) {
-            break;
-        }
     }
 
-    if (!candidate) {
-        isc_throw(SocketReadError, "received data over unknown socket");
+    isc_throw(SocketReadError, "received data over unknown socket");
+}
+
+boost::shared_ptr<Pkt4>
+IfaceMgr::receive4(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    IfacePtr iface;
+    const SocketInfo* candidate = 0;
+    if (!selectSocket(AF_INET, timeout_sec, timeout_usec, iface, candidate)) {
+        return (Pkt4Ptr());
     }
+
+    // Now we have a socket, let's get some data from it!
+    // Assuming that packet filter is not NULL, because its modifier checks it.
+    return (packet_filter_->receive(*iface, *candidate));
+}
+
+size_t
+IfaceMgr::receive4Batch(Pkt4Collection& pkts, const size_t max_pkts,
+                        uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    if (max_pkts == 0) {
+        isc_throw(BadValue, "maximum number of packets to receive must"
+                  " be greater than 0");
+    }
+    IfacePtr iface;
+    const SocketInfo* candidate = 0;
+    if (!selectSocket(AF_INET, timeout_sec, timeout_usec, iface, candidate)) {
+        return (0);
+    }
+    return (packet_filter_->receiveBatch(*iface, *candidate, pkts, max_pkts));
+}
+
+Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+    IfacePtr iface;
+    const SocketInfo* candidate = 0;
+    if (!selectSocket(AF_INET6, timeout_sec, timeout_usec, iface, candidate)) {
+        return (Pkt6Ptr());
+    }
+
     // Assuming that packet filter is not NULL, because its modifier checks it.
     return (packet_filter6_->receive(*candidate));
 }
 
+size_t
+IfaceMgr::receive6Batch(Pkt6Collection& pkts, const size_t max_pkts,
+                        uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    if (max_pkts == 0) {
+        isc_throw(BadValue, "maximum number of packets to receive must"
+                  " be greater than 0");
+    }
+    IfacePtr iface;
+    const SocketInfo* candidate = 0;
+    if (!selectSocket(AF_INET6, timeout_sec, timeout_usec, iface, candidate)) {
+        return (0);
+    }
+    return (packet_filter6_->receiveBatch(*candidate, pkts, max_pkts));
+}
+
 uint16_t IfaceMgr::getSocket(const isc::dhcp::Pkt6& pkt) {
     IfacePtr iface = getIface(pkt.getIface());
     if (!iface) {
@@ -364,6 +364,7 @@ public:
     /// @param sock SocketInfo structure that describes socket.
     void addSocket(const SocketInfo& sock) {
         sockets_.push_back(sock);
+        updateSocketsVersion();
     }
 
     /// @brief Closes socket.
@@ -375,6 +376,18 @@ public:
     /// @return true if there was such socket, false otherwise
     bool delSocket(uint16_t sockfd);
 
+    /// @brief Returns the counter of the changes of the sockets.
+    ///
+    /// The counter is incremented whenever a socket is added to or removed
+    /// from any interface, so as the @c IfaceMgr can tell if the sockets
+    /// it waits for have to be registered again.
+    ///
+    /// @return Current value of the counter.
+    static uint64_t getSocketsVersion();
+
+    /// @brief Increments the counter of the changes of the sockets.
+    static void updateSocketsVersion();
+
     /// @brief Returns collection of all sockets added to interface.
     ///
     /// When new socket is created with @ref IfaceMgr::openSocket
@@ -695,6 +708,28 @@ public:
     /// @return true if sending was successful
     bool send(const Pkt4Ptr& pkt);
 
+    /// @brief Sends multiple IPv4 packets.
+    ///
+    /// The consecutive packets to be sent over the same socket are passed
+    /// to the packet filter together, so as they can be sent with a single
+    /// system call.
+    ///
+    /// A packet which can't be sent, e.g. because it specifies an invalid
+    /// interface or the socket refuses it, doesn't stop the batch: it is
+    /// reported to the error callback and the remaining packets are sent.
+    ///
+    /// @param pkts packets to be sent
+    /// @param error_callback callback invoked for each packet which
+    /// couldn't be sent.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent and no error callback is specified. The first error is
+    /// thrown after the remaining packets have been sent.
+    /// @return Number of packets sent.
+    size_t sendBatch(const Pkt4Collection& pkts,
+                     const PktSendErrorCallback& error_callback =
+                     PktSendErrorCallback());
+
     /// @brief Tries to receive DHCPv6 message over open IPv6 sockets.
     ///
     /// Attempts to receive a single DHCPv6 message over any of the open IPv6
@@ -717,6 +752,33 @@ public:
     /// @return Pkt6 object representing received packet (or NULL)
     Pkt6Ptr receive6(uint32_t timeout_sec, uint32_t timeout_usec = 0);
 
+    /// @brief Tries to receive multiple DHCPv6 messages over open IPv6
+    /// sockets.
+    ///
+    /// Waits for the data in the same way as @c receive6. When a socket
+    /// has the data, the messages already queued on this socket are
+    /// received, up to the specified maximum, so as the caller doesn't
+    /// wait for each message separately.
+    ///
+    /// @param [out] pkts Collection to which the received messages are
+    /// appended.
+    /// @param max_pkts Maximum number of messages to receive.
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million or
+    /// max_pkts is 0.
+    /// @throw isc::dhcp::SocketReadError if error occured when receiving
+    /// messages. The messages received before the error are appended to
+    /// the collection.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Number of messages appended to the collection.
+    size_t receive6Batch(Pkt6Collection& pkts, const size_t max_pkts,
+                         uint32_t timeout_sec, uint32_t timeout_usec = 0);
+
     /// @brief Tries to receive IPv4 packet over open IPv4 sockets.
     ///
     /// Attempts to receive a single DHCPv4 message over any of the open
@@ -739,6 +801,32 @@ public:
     /// @return Pkt4 object representing received packet (or NULL)
     Pkt4Ptr receive4(uint32_t timeout_sec, uint32_t timeout_usec = 0);
 
+    /// @brief Tries to receive multiple IPv4 packets over open IPv4 sockets.
+    ///
+    /// Waits for the data in the same way as @c receive4. When a socket
+    /// has the data, the packets already queued on this socket are
+    /// received, up to the specified maximum, so as the caller doesn't
+    /// wait for each packet separately.
+    ///
+    /// @param [out] pkts Collection to which the received packets are
+    /// appended.
+    /// @param max_pkts Maximum number of packets to receive.
+    /// @param timeout_sec specifies integral part of the timeout (in seconds)
+    /// @param timeout_usec specifies fractional part of the timeout
+    /// (in microseconds)
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million or
+    /// max_pkts is 0.
+    /// @throw isc::dhcp::SocketReadError if error occured when receiving
+    /// packets. The packets received before the error are appended to
+    /// the collection.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
+    /// interrupted by a signal.
+    ///
+    /// @return Number of packets appended to the collection.
+    size_t receive4Batch(Pkt4Collection& pkts, const size_t max_pkts,
+                         uint32_t timeout_sec, uint32_t timeout_usec = 0);
+
     /// Opens UDP/IP socket and binds it to address, interface and port.
     ///
     /// Specific type of socket (UDP/IPv4 or UDP/IPv6) depends on passed addr
@@ -935,6 +1023,7 @@ public:
 
     /// @brief Closes all open sockets.
     /// Is used in destructor, but also from Dhcpv4Srv and Dhcpv6Srv classes.
+    /// The packet filter releases the IPv4 sockets before they are closed.
     void closeSockets();
 
     /// @brief Closes all IPv4 or IPv6 sockets.
@@ -1040,6 +1129,7 @@ public:
     /// from unit tests.
     void addInterface(const IfacePtr& iface) {
         ifaces_.push_back(iface);
+        Iface::updateSocketsVersion();
     }
 
     /// @brief Checks if there is at least one socket of the specified family
@@ -1158,6 +1248,13 @@ private:
     getLocalAddress(const isc::asiolink::IOAddress& remote_addr,
                     const uint16_t port);
 
+    /// @brief Releases the resources held by the packet filter for the
+    /// IPv4 sockets of the interface.
+    ///
+    /// It is called before the sockets are closed.
+    ///
+    /// @param iface interface which sockets are to be closed.
+    void releaseSockets4(const Iface& iface);
 
     /// @brief Open an IPv6 socket with multicast support.
     ///
@@ -1181,6 +1278,101 @@ private:
                              const uint16_t port,
                              IfaceMgrErrorMsgCallback error_handler = NULL);
 
+    /// @brief Sends a group of packets over the same socket.
+    ///
+    /// If the packet filter fails without sending any of the packets,
+    /// all of them are reported to the callback.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param [in,out] group packets to be sent, cleared on return.
+    /// @param error_callback callback invoked for each packet which
+    /// couldn't be sent.
+    ///
+    /// @return Number of packets sent.
+    size_t sendGroup(const Iface& iface, const int sockfd,
+                     Pkt4Collection& group,
+                     const PktSendErrorCallback& error_callback);
+
+    /// @brief Waits for the data over the sockets using epoll.
+    ///
+    /// On Linux, the sockets are registered in the epoll set once, when
+    /// they have changed since the last call, so as waiting for the data
+    /// takes time proportional to the number of sockets with the data
+    /// rather than the number of all sockets. The data over the external
+    /// sockets is handled by calling their callbacks.
+    ///
+    /// If epoll is not supported or some of the sockets can't be
+    /// registered (e.g. they are not valid descriptors), the caller
+    /// should fall back to select().
+    ///
+    /// @param family AF_INET or AF_INET6, the family of the addresses of
+    /// the sockets to wait for.
+    /// @param timeout_sec Integral part of the timeout (in seconds).
+    /// @param timeout_usec Fractional part of the timeout (in microseconds).
+    /// @param [out] iface Interface of the socket with the data.
+    /// @param [out] candidate Socket with the data, or NULL if the timeout
+    /// has been reached or the data arrived over an external socket.
+    ///
+    /// @throw isc::dhcp::SocketReadError if waiting for the data failed or
+    /// a registered socket has been closed.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when waiting for the data
+    /// is interrupted by a signal.
+    ///
+    /// @return false if select() should be used, true otherwise.
+    bool receiveEpoll(const uint16_t family, const uint32_t timeout_sec,
+                      const uint32_t timeout_usec, IfacePtr& iface,
+                      const SocketInfo*& candidate);
+
+    /// @brief Waits for the data over the sockets of the specified family.
+    ///
+    /// Uses epoll if possible and select() otherwise. If the data arrives
+    /// over an external socket, its callback is called.
+    ///
+    /// @param family AF_INET or AF_INET6, the family of the addresses of
+    /// the sockets to wait for.
+    /// @param timeout_sec Integral part of the timeout (in seconds).
+    /// @param timeout_usec Fractional part of the timeout (in microseconds).
+    /// @param [out] iface Interface of the socket with the data.
+    /// @param [out] candidate Socket with the data.
+    ///
+    /// @throw isc::BadValue if timeout_usec is greater than one million.
+    /// @throw isc::dhcp::SocketReadError if waiting for the data failed.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when waiting for the data
+    /// is interrupted by a signal.
+    ///
+    /// @return true if a socket of the specified family has the data, false
+    /// if the timeout has been reached or the data arrived over an external
+    /// socket.
+    bool selectSocket(const uint16_t family, const uint32_t timeout_sec,
+                      const uint32_t timeout_usec, IfacePtr& iface,
+                      const SocketInfo*& candidate);
+
+    /// @brief Registers the sockets in the epoll set.
+    ///
+    /// Replaces the epoll set with a new one holding the external sockets
+    /// and the sockets of the specified family.
+    ///
+    /// @param family AF_INET or AF_INET6.
+    ///
+    /// @return true if all sockets have been registered.
+    bool registerEpollSockets(const uint16_t family);
+
+    /// @brief Socket registered in the epoll set.
+    struct EpollSocket {
+        /// Socket descriptor.
+        int sockfd_;
+
+        /// Interface of the socket or NULL for the external sockets.
+        IfacePtr iface_;
+
+        /// Socket of the interface or NULL for the external sockets.
+        const SocketInfo* socket_;
+
+        /// Callback of the external socket.
+        SocketCallback callback_;
+    };
+
     /// Holds instance of a class derived from PktFilter, used by the
     /// IfaceMgr to open sockets and send/receive packets through these
     /// sockets. It is possible to supply custom object using
@@ -1202,6 +1394,25 @@ private:
 
     /// @brief Indicates if the IfaceMgr is in the test mode.
     bool test_mode_;
+
+    /// @brief Descriptor of the epoll set or -1.
+    int epoll_fd_;
+
+    /// @brief Family of the sockets registered in the epoll set or 0 if
+    /// the sockets haven't been registered.
+    uint16_t epoll_family_;
+
+    /// @brief Counter of the changes of the sockets at the time they have
+    /// been registered.
+    uint64_t epoll_version_;
+
+    /// @brief Indicates if all sockets have been registered in the epoll
+    /// set.
+    bool epoll_usable_;
+
+    /// @brief Sockets registered in the epoll set, indexed by the data
+    /// of the epoll events.
+    std::vector<EpollSocket> epoll_sockets_;
 };
 
 }; // namespace isc::dhcp
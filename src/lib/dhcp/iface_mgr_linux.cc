@@ -516,7 +516,8 @@ void Iface::setFlags(uint64_t flags) {
 void
 IfaceMgr::setMatchingPacketFilter(const bool direct_response_desired) {
     if (direct_response_desired) {
-        setPacketFilter(PktFilterPtr(new PktFilterLPF()));
+        // Use the ring buffers to receive and send the frames.
+        setPacketFilter(PktFilterPtr(new PktFilterLPF(true)));
 
     } else {
         setPacketFilter(PktFilterPtr(new PktFilterInet()));
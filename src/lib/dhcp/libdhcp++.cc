@@ -52,6 +52,13 @@ VendorOptionDefContainers LibDHCP::vendor4_defs_;
 
 VendorOptionDefContainers LibDHCP::vendor6_defs_;
 
+namespace {
+
+// Empty container used for option spaces without standard definitions.
+const OptionDefContainer empty_option_defs;
+
+}
+
 // Those two vendor classes are used for cable modems:
 
 /// DOCSIS3.0 compatible cable modem
@@ -250,11 +257,10 @@ size_t LibDHCP::unpackOptions6(const OptionBuffer& buf,
     size_t offset = 0;
     size_t length = buf.size();
 
-    // Get the list of standard option definitions.
-    OptionDefContainer option_defs;
-    if (option_space == "dhcp6") {
-        option_defs = LibDHCP::getOptionDefs(Option::V6);
-    }
+    // Get the list of standard option definitions. The container
+    // is not copied, because the options are parsed for every packet.
+    const OptionDefContainer& option_defs = (option_space == "dhcp6" ?
+        LibDHCP::getOptionDefs(Option::V6) : empty_option_defs);
     // @todo Once we implement other option spaces we should add else clause
     // here and gather option definitions for them. For now leaving option_defs
     // empty will imply creation of generic Option.
@@ -356,11 +362,10 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
                                isc::dhcp::OptionCollection& options) {
     size_t offset = 0;
 
-    // Get the list of stdandard option definitions.
-    OptionDefContainer option_defs;
-    if (option_space == "dhcp4") {
-        option_defs = LibDHCP::getOptionDefs(Option::V4);
-    }
+    // Get the list of stdandard option definitions. The container
+    // is not copied, because the options are parsed for every packet.
+    const OptionDefContainer& option_defs = (option_space == "dhcp4" ?
+        LibDHCP::getOptionDefs(Option::V4) : empty_option_defs);
     // @todo Once we implement other option spaces we should add else clause
     // here and gather option definitions for them. For now leaving option_defs
     // empty will imply creation of generic Option.
@@ -441,6 +446,61 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
     return (offset);
 }
 
+size_t LibDHCP::indexOptions4(const OptionBuffer& buf, size_t offset,
+                              OptionIndex& index) {
+    // The options are scanned the same way as in unpackOptions4.
+    while (offset + 1 <= buf.size()) {
+        uint8_t opt_type = buf[offset++];
+
+        if (opt_type == DHO_END)
+            return (offset);
+
+        if (opt_type == DHO_PAD)
+            continue;
+
+        if (offset + 1 > buf.size()) {
+            isc_throw(OutOfRange, "Attempt to parse truncated option "
+                      << static_cast<int>(opt_type));
+        }
+
+        uint8_t opt_len =  buf[offset++];
+        if (offset + opt_len > buf.size()) {
+            // The option is truncated.
+            return (offset - 2);
+        }
+
+        index.add(opt_type, offset - 2, opt_len + 2);
+        offset += opt_len;
+    }
+    return (offset);
+}
+
+size_t LibDHCP::indexOptions6(const OptionBuffer& buf, size_t offset,
+                              const size_t end, OptionIndex& index) {
+    // The options are scanned the same way as in unpackOptions6.
+    while (offset + 4 <= end) {
+        uint16_t opt_type = isc::util::readUint16(&buf[offset], 2);
+        offset += 2;
+
+        uint16_t opt_len = isc::util::readUint16(&buf[offset], 2);
+        offset += 2;
+
+        if (offset + opt_len > end) {
+            // The option is truncated.
+            return (offset - 4);
+        }
+
+        if ((opt_type == D6O_VENDOR_OPTS) && (offset + 4 > end)) {
+            // Truncated vendor-option.
+            return (offset - 4);
+        }
+
+        index.add(opt_type, offset - 4, opt_len + 4);
+        offset += opt_len;
+    }
+    return (offset);
+}
+
 size_t LibDHCP::unpackVendorOptions6(const uint32_t vendor_id,
                                      const OptionBuffer& buf,
                                      isc::dhcp::OptionCollection& options) {
@@ -16,6 +16,7 @@
 #define LIBDHCP_H
 
 #include <dhcp/option_definition.h>
+#include <dhcp/option_index.h>
 #include <dhcp/pkt6.h>
 #include <util/buffer.h>
 
@@ -179,6 +180,39 @@ public:
                                  size_t* relay_msg_offset = 0,
                                  size_t* relay_msg_len = 0);
 
+    /// @brief Records the locations of the DHCPv4 options in the buffer.
+    ///
+    /// The buffer is scanned in the same way as by @c unpackOptions4, but
+    /// the options are not created. Instead, the code, offset and length
+    /// of each option is added to the index, so as the option can be
+    /// created later from the same buffer.
+    ///
+    /// @param buf Buffer holding the options.
+    /// @param offset Offset of the first option in the buffer.
+    /// @param [out] index Index to which the options are added.
+    ///
+    /// @throw isc::OutOfRange if the option header is truncated.
+    /// @return offset to the first byte after the last indexed option
+    static size_t indexOptions4(const OptionBuffer& buf, size_t offset,
+                                OptionIndex& index);
+
+    /// @brief Records the locations of the DHCPv6 options in the buffer.
+    ///
+    /// The buffer is scanned in the same way as by @c unpackOptions6, but
+    /// the options are not created. Instead, the code, offset and length
+    /// of each option is added to the index, so as the option can be
+    /// created later from the same buffer. It is not used for the relay
+    /// options, so the relay-msg option is indexed as any other option.
+    ///
+    /// @param buf Buffer holding the options.
+    /// @param offset Offset of the first option in the buffer.
+    /// @param end Offset of the end of the options in the buffer.
+    /// @param [out] index Index to which the options are added.
+    ///
+    /// @return offset to the first byte after the last indexed option
+    static size_t indexOptions6(const OptionBuffer& buf, size_t offset,
+                                const size_t end, OptionIndex& index);
+
     /// Registers factory method that produces options of specific option types.
     ///
     /// @throw isc::BadValue if provided the type is already registered, has
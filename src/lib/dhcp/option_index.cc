@@ -0,0 +1,108 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcp/option_index.h>
+
+#include <algorithm>
+
+namespace {
+
+/// @brief Orders the entries by the option code.
+bool
+entryCodeLess(const isc::dhcp::OptionIndex::Entry& entry,
+              const uint16_t code) {
+    return (entry.code_ < code);
+}
+
+/// @brief Orders the entries by the option code.
+bool
+codeEntryLess(const uint16_t code,
+              const isc::dhcp::OptionIndex::Entry& entry) {
+    return (code < entry.code_);
+}
+
+}
+
+namespace isc {
+namespace dhcp {
+
+OptionIndex::OptionIndex()
+    : overflow_(), size_(0) {
+}
+
+void
+OptionIndex::add(const uint16_t code, const uint32_t offset,
+                 const uint32_t length) {
+    Entry entry;
+    entry.code_ = code;
+    entry.offset_ = offset;
+    entry.length_ = length;
+
+    // Move the entries to the vector when there is no more room.
+    if (overflow_.empty() && (size_ == INLINE_ENTRIES)) {
+        overflow_.reserve(2 * INLINE_ENTRIES);
+        overflow_.assign(inline_, inline_ + size_);
+    }
+
+    if (overflow_.empty()) {
+        Entry* pos = std::upper_bound(inline_, inline_ + size_, code,
+                                      codeEntryLess);
+        std::copy_backward(pos, inline_ + size_, inline_ + size_ + 1);
+        *pos = entry;
+    } else {
+        std::vector<Entry>::iterator pos =
+            std::upper_bound(overflow_.begin(), overflow_.end(), code,
+                             codeEntryLess);
+        overflow_.insert(pos, entry);
+    }
+    ++size_;
+}
+
+OptionIndex::EntryRange
+OptionIndex::find(const uint16_t code) const {
+    const Entry* first = std::lower_bound(begin(), end(), code,
+                                          entryCodeLess);
+    const Entry* last = first;
+    while ((last != end()) && (last->code_ == code)) {
+        ++last;
+    }
+    return (EntryRange(first, last));
+}
+
+void
+OptionIndex::erase(const uint16_t code) {
+    EntryRange range = find(code);
+    const size_t first = range.first - begin();
+    const size_t count = range.second - range.first;
+    if (count == 0) {
+        return;
+    }
+
+    if (overflow_.empty()) {
+        std::copy(inline_ + first + count, inline_ + size_, inline_ + first);
+    } else {
+        overflow_.erase(overflow_.begin() + first,
+                        overflow_.begin() + first + count);
+    }
+    size_ -= count;
+}
+
+void
+OptionIndex::clear() {
+    overflow_.clear();
+    size_ = 0;
+}
+
+} // namespace isc::dhcp
+} // namespace isc
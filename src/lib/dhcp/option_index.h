@@ -0,0 +1,130 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef OPTION_INDEX_H
+#define OPTION_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Flat index of the options held in a received packet.
+///
+/// The index records the code, offset and length of the options found
+/// in the packet's buffer, sorted by the option code. The entries of the
+/// options having the same code are kept in the order in which they
+/// appear in the buffer. The packet uses the index to create the
+/// @c Option objects only for the options which are retrieved.
+///
+/// The entries are stored within the object, unless there are more than
+/// @c INLINE_ENTRIES of them, so indexing the options of a typical packet
+/// doesn't allocate any memory.
+class OptionIndex {
+public:
+
+    /// @brief Location of an option in the buffer.
+    struct Entry {
+        /// @brief Option code.
+        uint16_t code_;
+        /// @brief Offset of the option header in the buffer.
+        uint32_t offset_;
+        /// @brief Length of the option, including the option header.
+        uint32_t length_;
+    };
+
+    /// @brief Range of the entries.
+    typedef std::pair<const Entry*, const Entry*> EntryRange;
+
+    /// @brief Number of entries stored within the object.
+    static const size_t INLINE_ENTRIES = 24;
+
+    /// @brief Constructor.
+    ///
+    /// Creates an empty index.
+    OptionIndex();
+
+    /// @brief Adds an entry.
+    ///
+    /// The entry is placed after the other entries for the same code.
+    ///
+    /// @param code Option code.
+    /// @param offset Offset of the option header in the buffer.
+    /// @param length Length of the option, including the option header.
+    void add(const uint16_t code, const uint32_t offset,
+             const uint32_t length);
+
+    /// @brief Returns the entries for the specified code.
+    ///
+    /// @param code Option code.
+    ///
+    /// @return Range of the entries, which is empty if there are no
+    /// options with this code. The range is invalidated by the
+    /// modification of the index.
+    EntryRange find(const uint16_t code) const;
+
+    /// @brief Removes the entries for the specified code.
+    ///
+    /// @param code Option code.
+    void erase(const uint16_t code);
+
+    /// @brief Removes all entries.
+    void clear();
+
+    /// @brief Checks if the index is empty.
+    bool empty() const {
+        return (size_ == 0);
+    }
+
+    /// @brief Returns the number of entries.
+    size_t size() const {
+        return (size_);
+    }
+
+    /// @brief Returns the pointer to the first entry.
+    const Entry* begin() const {
+        return (data());
+    }
+
+    /// @brief Returns the pointer past the last entry.
+    const Entry* end() const {
+        return (data() + size_);
+    }
+
+private:
+
+    /// @brief Returns the pointer to the storage of the entries.
+    const Entry* data() const {
+        return (overflow_.empty() ? inline_ : &overflow_[0]);
+    }
+
+    /// @brief Entries stored within the object.
+    Entry inline_[INLINE_ENTRIES];
+
+    /// @brief Entries stored when they don't fit within the object.
+    ///
+    /// When not empty, it holds all entries.
+    std::vector<Entry> overflow_;
+
+    /// @brief Number of entries.
+    size_t size_;
+};
+
+} // namespace isc::dhcp
+} // namespace isc
+
+#endif // OPTION_INDEX_H
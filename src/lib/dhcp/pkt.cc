@@ -16,6 +16,7 @@
 #include <dhcp/pkt.h>
 #include <dhcp/iface_mgr.h>
 #include <dhcp/hwaddr.h>
+#include <dhcp/libdhcp++.h>
 #include <vector>
 
 namespace isc {
@@ -31,7 +32,8 @@ Pkt::Pkt(uint32_t transid, const isc::asiolink::IOAddress& local_addr,
      remote_addr_(remote_addr),
      local_port_(local_port),
      remote_port_(remote_port),
-     buffer_out_(0)
+     buffer_out_(0),
+     lazy_unpack_(false)
 {
 }
 
@@ -45,7 +47,8 @@ Pkt::Pkt(const uint8_t* buf, uint32_t len, const isc::asiolink::IOAddress& local
      remote_addr_(remote_addr),
      local_port_(local_port),
      remote_port_(remote_port),
-     buffer_out_(0)
+     buffer_out_(0),
+     lazy_unpack_(false)
 {
     data_.resize(len);
     if (len) {
@@ -55,11 +58,107 @@ Pkt::Pkt(const uint8_t* buf, uint32_t len, const isc::asiolink::IOAddress& local
 
 void
 Pkt::addOption(const OptionPtr& opt) {
+    // The option is added after the received options of the same type.
+    materializeOption(opt->getType());
     options_.insert(std::pair<int, OptionPtr>(opt->getType(), opt));
 }
 
+void
+Pkt::addPackedOption(const OptionPtr& opt, const OptionBufferPtr& wire) {
+    addOption(opt);
+    if (wire && !wire->empty()) {
+        packed_options_.push_back(std::make_pair(opt, wire));
+    }
+}
+
+void
+Pkt::clearPackedOptions() {
+    packed_options_.clear();
+}
+
+void
+Pkt::packOptions(isc::util::OutputBuffer& buf) const {
+    if (packed_options_.empty()) {
+        LibDHCP::packOptions(buf, options_);
+        return;
+    }
+
+    for (OptionCollection::const_iterator it = options_.begin();
+         it != options_.end(); ++it) {
+        // There are a few options added with the wire format, so they
+        // are searched linearly.
+        OptionBufferPtr wire;
+        for (size_t i = 0; i < packed_options_.size(); ++i) {
+            if (packed_options_[i].first == it->second) {
+                wire = packed_options_[i].second;
+                break;
+            }
+        }
+        if (wire) {
+            buf.writeData(&(*wire)[0], wire->size());
+        } else {
+            it->second->pack(buf);
+        }
+    }
+}
+
+void
+Pkt::materializeOptions() const {
+    if (!option_index_.empty()) {
+        materializeIndexedOptions(OptionIndex::EntryRange(option_index_.begin(),
+                                                          option_index_.end()));
+    }
+}
+
+void
+Pkt::materializeIndexedOptions(const OptionIndex::EntryRange& range) const {
+    if (range.first == range.second) {
+        return;
+    }
+
+    const bool all = (range.second - range.first ==
+                      static_cast<ptrdiff_t>(option_index_.size()));
+    const uint16_t code = range.first->code_;
+
+    // The options are added to the packet when all of them have been
+    // created. If any of them is malformed, the entries are kept, so as
+    // the error is reported each time these options are retrieved.
+    OptionCollection options;
+    unpackIndexedOptions(range, options);
+    options_.insert(options.begin(), options.end());
+
+    if (all) {
+        option_index_.clear();
+    } else {
+        option_index_.erase(code);
+    }
+}
+
+void
+Pkt::copyIndexedOptions(const OptionBuffer& data,
+                        const OptionIndex::EntryRange& range,
+                        OptionBuffer& buf) {
+    size_t length = 0;
+    for (const OptionIndex::Entry* entry = range.first;
+         entry != range.second; ++entry) {
+        if (entry->offset_ + entry->length_ > data.size()) {
+            isc_throw(OutOfRange, "option " << entry->code_ << " is located"
+                      " beyond the end of the received buffer");
+        }
+        length += entry->length_;
+    }
+
+    buf.reserve(buf.size() + length);
+    for (const OptionIndex::Entry* entry = range.first;
+         entry != range.second; ++entry) {
+        buf.insert(buf.end(), data.begin() + entry->offset_,
+                   data.begin() + entry->offset_ + entry->length_);
+    }
+}
+
 OptionPtr
 Pkt::getOption(uint16_t type) const {
+    materializeOption(type);
     OptionCollection::const_iterator x = options_.find(type);
     if (x != options_.end()) {
         return (*x).second;
@@ -69,6 +168,7 @@ Pkt::getOption(uint16_t type) const {
 
 bool
 Pkt::delOption(uint16_t type) {
+    materializeOption(type);
 
     isc::dhcp::OptionCollection::iterator x = options_.find(type);
     if (x!=options_.end()) {
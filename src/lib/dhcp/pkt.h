@@ -18,11 +18,14 @@
 #include <asiolink/io_address.h>
 #include <util/buffer.h>
 #include <dhcp/option.h>
+#include <dhcp/option_index.h>
 #include <dhcp/hwaddr.h>
 #include <dhcp/classify.h>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <vector>
+
 namespace isc {
 
 namespace dhcp {
@@ -131,6 +134,29 @@ public:
     /// @param opt option to be added.
     virtual void addOption(const OptionPtr& opt);
 
+    /// @brief Adds an option to this packet together with its wire format.
+    ///
+    /// The server uses this method to add the options held by the
+    /// configuration, which have been packed when the configuration was
+    /// committed. When this packet is packed, the wire data is copied
+    /// rather than packing the option again, provided that the option
+    /// is still present in the packet. The caller must ensure that the
+    /// wire data is what @c Option::pack would produce for the option and
+    /// that the option is not modified.
+    ///
+    /// @param opt option to be added.
+    /// @param wire wire format of the option, including the option header.
+    /// If it is NULL, the option is packed as usual.
+    void addPackedOption(const OptionPtr& opt, const OptionBufferPtr& wire);
+
+    /// @brief Discards the wire format of the options added with
+    /// @c addPackedOption.
+    ///
+    /// The options are packed as usual afterwards. The server calls this
+    /// method before it passes the packet to the callouts, which may
+    /// modify the options in place.
+    void clearPackedOptions();
+
     /// @brief Attempts to delete first suboption of requested type.
     ///
     /// If there are several options of the same type present, only
@@ -232,6 +258,8 @@ public:
     /// Also see \ref Pkt6::getOptions().
     ///
     /// The options will be only returned after unpack() is called.
+    /// If the options have been unpacked lazily, the options of the
+    /// specified type are created by this call.
     ///
     /// @param type option type we are looking for
     ///
@@ -256,6 +284,39 @@ public:
         return timestamp_;
     }
 
+    /// @brief Enables recording of the processing stage times.
+    ///
+    /// The server may record the times at which the packet completes the
+    /// processing stages, so as to measure the time spent in each stage.
+    /// The times are not recorded unless this method is called.
+    ///
+    /// @param num_stages Number of the processing stages.
+    void enableStageTimes(const size_t num_stages) {
+        stage_times_.assign(num_stages, boost::posix_time::ptime());
+    }
+
+    /// @brief Records the time at which the packet completed the processing
+    /// stage.
+    ///
+    /// It does nothing if the recording of the stage times hasn't been
+    /// enabled with @c Pkt::enableStageTimes.
+    ///
+    /// @param stage Index of the stage.
+    void setStageTime(const size_t stage) {
+        if (stage < stage_times_.size()) {
+            stage_times_[stage] =
+                boost::posix_time::microsec_clock::universal_time();
+        }
+    }
+
+    /// @brief Returns the recorded processing stage times.
+    ///
+    /// @return Times indexed by the stage. The times of the stages which
+    /// the packet hasn't completed are not-a-date-time.
+    const std::vector<boost::posix_time::ptime>& getStageTimes() const {
+        return (stage_times_);
+    }
+
     /// @brief Copies content of input buffer to output buffer.
     ///
     /// This is mostly a diagnostic function. It is being used for sending
@@ -272,6 +333,46 @@ public:
         callback_ = callback;
     }
 
+    /// @brief Enables or disables the lazy unpacking of the options.
+    ///
+    /// When enabled, @c unpack doesn't create the options. It only records
+    /// where the options are in the received buffer, and the options of
+    /// a given type are created when they are first retrieved, with the
+    /// callback function if set. The options which are never retrieved are
+    /// never created. Note that the errors in the options are then reported
+    /// by the methods retrieving the options rather than by @c unpack.
+    ///
+    /// The methods of this class which need all options, such as @c pack
+    /// or @c toText, create the remaining options first. The code accessing
+    /// @c options_ directly must call @c materializeOptions or
+    /// @c materializeOption.
+    ///
+    /// @param lazy true if the options should be unpacked lazily.
+    void setLazyUnpack(const bool lazy) {
+        lazy_unpack_ = lazy;
+    }
+
+    /// @brief Checks if the options are unpacked lazily.
+    bool getLazyUnpack() const {
+        return (lazy_unpack_);
+    }
+
+    /// @brief Creates the options which have not been created yet by the
+    /// lazy unpacking.
+    ///
+    /// It does nothing if the options haven't been unpacked lazily.
+    void materializeOptions() const;
+
+    /// @brief Creates the options of the specified type which have not been
+    /// created yet by the lazy unpacking.
+    ///
+    /// @param type Option type.
+    void materializeOption(const uint16_t type) const {
+        if (!option_index_.empty()) {
+            materializeIndexedOptions(option_index_.find(type));
+        }
+    }
+
     /// @brief Sets remote IP address.
     ///
     /// @param remote specifies remote address
@@ -445,16 +546,47 @@ public:
 
     /// @brief Collection of options present in this message.
     ///
+    /// When the options are unpacked lazily, the options are added to this
+    /// collection as they are retrieved. It is mutable for this reason.
+    ///
     /// @warning This public member is accessed by derived
     /// classes directly. One of such derived classes is
     /// @ref perfdhcp::PerfPkt6. The impact on derived clasess'
     /// behavior must be taken into consideration before making
     /// changes to this member such as access scope restriction or
     /// data format change etc.
-    isc::dhcp::OptionCollection options_;
+    mutable isc::dhcp::OptionCollection options_;
 
 protected:
 
+    /// @brief Stores options in the specified output buffer.
+    ///
+    /// The options added with @c addPackedOption are stored by copying
+    /// their wire data.
+    ///
+    /// @param buf output buffer where the options are stored.
+    void packOptions(isc::util::OutputBuffer& buf) const;
+
+    /// @brief Creates the options indexed by the lazy unpacking.
+    ///
+    /// The derived classes parse the options the same way as @c unpack.
+    ///
+    /// @param range Entries of the options to be created.
+    /// @param [out] options Collection to which the options are added.
+    virtual void unpackIndexedOptions(const OptionIndex::EntryRange& range,
+                                      OptionCollection& options) const = 0;
+
+    /// @brief Copies the indexed options to a buffer.
+    ///
+    /// @param data Received buffer in which the options have been indexed.
+    /// @param range Entries of the options to be copied.
+    /// @param [out] buf Buffer to which the options are copied.
+    ///
+    /// @throw isc::OutOfRange if the option lies beyond the end of data.
+    static void copyIndexedOptions(const OptionBuffer& data,
+                                   const OptionIndex::EntryRange& range,
+                                   OptionBuffer& buf);
+
     /// @brief Attempts to obtain MAC address from source link-local
     /// IPv6 address
     ///
@@ -606,14 +738,36 @@ protected:
     /// packet timestamp
     boost::posix_time::ptime timestamp_;
 
+    /// Times at which the packet completed the processing stages.
+    std::vector<boost::posix_time::ptime> stage_times_;
+
     // remote HW address (src if receiving packet, dst if sending packet)
     HWAddrPtr remote_hwaddr_;
 
     /// A callback to be called to unpack options from the packet.
     UnpackOptionsCallback callback_;
 
+    /// @brief Indicates if the options are unpacked lazily.
+    bool lazy_unpack_;
+
+    /// @brief Locations of the options which have not been created yet
+    /// by the lazy unpacking.
+    mutable OptionIndex option_index_;
+
 private:
 
+    /// @brief Options added with their wire format.
+    ///
+    /// The packed options are identified by the pointers to the options,
+    /// which are held here so as they can't be replaced by other objects
+    /// at the same addresses.
+    std::vector<std::pair<OptionPtr, OptionBufferPtr> > packed_options_;
+
+    /// @brief Creates the indexed options and removes them from the index.
+    ///
+    /// @param range Entries of the options to be created.
+    void materializeIndexedOptions(const OptionIndex::EntryRange& range) const;
+
     /// @brief Generic method that validates and sets HW address.
     ///
     /// This is a generic method used by all modifiers of this class
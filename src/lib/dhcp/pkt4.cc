@@ -87,6 +87,7 @@ Pkt4::len() {
     size_t length = DHCPV4_PKT_HDR_LEN; // DHCPv4 header
 
     // ... and sum of lengths of all options
+    materializeOptions();
     for (OptionCollection::const_iterator it = options_.begin();
          it != options_.end();
          ++it) {
@@ -106,6 +107,9 @@ Pkt4::pack() {
     // will not result in concatenation of multiple packet copies.
     buffer_out_.clear();
 
+    // Create the options not retrieved since the lazy unpacking.
+    materializeOptions();
+
     try {
         size_t hw_len = hwaddr_->hwaddr_.size();
 
@@ -144,7 +148,7 @@ Pkt4::pack() {
         // write DHCP magic cookie
         buffer_out_.writeUint32(DHCP_OPTIONS_COOKIE);
 
-        LibDHCP::packOptions(buffer_out_, options_);
+        packOptions(buffer_out_);
 
         // add END option that indicates end of options
         // (End option is very simple, just a 255 octet)
@@ -205,21 +209,29 @@ Pkt4::unpack() {
       isc_throw(Unexpected, "Invalid or missing DHCP magic cookie");
     }
 
-    size_t opts_len = buffer_in.getLength() - buffer_in.getPosition();
-    vector<uint8_t> opts_buffer;
-
-    // Use readVector because a function which parses option requires
-    // a vector as an input.
     size_t offset;
-    buffer_in.readVector(opts_buffer, opts_len);
-    if (callback_.empty()) {
-        offset = LibDHCP::unpackOptions4(opts_buffer, "dhcp4", options_);
+    if (lazy_unpack_) {
+        // Only record where the options are. They are created from data_
+        // when they are retrieved.
+        option_index_.clear();
+        offset = LibDHCP::indexOptions4(data_, buffer_in.getPosition(),
+                                        option_index_);
     } else {
-        // The last two arguments are set to NULL because they are
-        // specific to DHCPv6 options parsing. They are unused for
-        // DHCPv4 case. In DHCPv6 case they hold are the relay message
-        // offset and length.
-        offset = callback_(opts_buffer, "dhcp4", options_, NULL, NULL);
+        size_t opts_len = buffer_in.getLength() - buffer_in.getPosition();
+        vector<uint8_t> opts_buffer;
+
+        // Use readVector because a function which parses option requires
+        // a vector as an input.
+        buffer_in.readVector(opts_buffer, opts_len);
+        if (callback_.empty()) {
+            offset = LibDHCP::unpackOptions4(opts_buffer, "dhcp4", options_);
+        } else {
+            // The last two arguments are set to NULL because they are
+            // specific to DHCPv6 options parsing. They are unused for
+            // DHCPv4 case. In DHCPv6 case they hold are the relay message
+            // offset and length.
+            offset = callback_(opts_buffer, "dhcp4", options_, NULL, NULL);
+        }
     }
 
     // If offset is not equal to the size, then something is wrong here. We
@@ -243,6 +255,18 @@ Pkt4::unpack() {
     check();
 }
 
+void
+Pkt4::unpackIndexedOptions(const OptionIndex::EntryRange& range,
+                           OptionCollection& options) const {
+    OptionBuffer buf;
+    copyIndexedOptions(data_, range, buf);
+    if (callback_.empty()) {
+        LibDHCP::unpackOptions4(buf, "dhcp4", options);
+    } else {
+        callback_(buf, "dhcp4", options, NULL, NULL);
+    }
+}
+
 void Pkt4::check() {
     uint8_t msg_type = getType();
     if (msg_type > DHCPLEASEACTIVE) {
@@ -289,12 +313,22 @@ Pkt4::toText() {
         << ":" << remote_port_ << ", msgtype=" << static_cast<int>(getType())
         << ", transid=0x" << hex << transid_ << dec << endl;
 
+    // The packet is printed even if one of the options which haven't been
+    // retrieved yet is malformed.
+    std::string malformed;
+    try {
+        materializeOptions();
+    } catch (const std::exception& ex) {
+        malformed = ex.what();
+    }
     for (isc::dhcp::OptionCollection::iterator opt=options_.begin();
          opt != options_.end();
          ++opt) {
         tmp << "  " << opt->second->toText() << std::endl;
     }
-
+    if (!malformed.empty()) {
+        tmp << "  malformed options: " << malformed << std::endl;
+    }
 
     return tmp.str();
 }
@@ -90,7 +90,8 @@ public:
     /// Parses received packet, stored in on-wire format in bufferIn_.
     ///
     /// Will create a collection of option objects that will
-    /// be stored in options_ container.
+    /// be stored in options_ container, unless the lazy unpacking
+    /// is enabled with @c setLazyUnpack.
     ///
     /// Method with throw exception if packet parsing fails.
     virtual void unpack();
@@ -376,6 +377,13 @@ private:
 
 protected:
 
+    /// @brief Creates the options indexed by the lazy unpacking.
+    ///
+    /// @param range Entries of the options to be created.
+    /// @param [out] options Collection to which the options are added.
+    virtual void unpackIndexedOptions(const OptionIndex::EntryRange& range,
+                                      OptionCollection& options) const;
+
     /// converts DHCP message type to BOOTP op type
     ///
     /// @param dhcpType DHCP message type (e.g. DHCPDISCOVER)
@@ -502,6 +510,9 @@ protected:
 /// @brief A pointer to Pkt4 object.
 typedef boost::shared_ptr<Pkt4> Pkt4Ptr;
 
+/// @brief A collection of pointers to Pkt4 objects.
+typedef std::vector<Pkt4Ptr> Pkt4Collection;
+
 } // isc::dhcp namespace
 
 } // isc namespace
@@ -161,6 +161,7 @@ uint16_t Pkt6::calculateRelaySizes() {
 uint16_t Pkt6::directLen() const {
     uint16_t length = DHCPV6_PKT_HDR_LEN; // DHCPv6 header
 
+    materializeOptions();
     for (OptionCollection::const_iterator it = options_.begin();
          it != options_.end();
          ++it) {
@@ -191,6 +192,9 @@ Pkt6::packUDP() {
         // Make sure that the buffer is empty before we start writting to it.
         buffer_out_.clear();
 
+        // Create the options not retrieved since the lazy unpacking.
+        materializeOptions();
+
         // is this a relayed packet?
         if (!relay_info_.empty()) {
 
@@ -242,7 +246,7 @@ Pkt6::packUDP() {
         buffer_out_.writeUint8( (transid_) & 0xff );
 
         // the rest are options
-        LibDHCP::packOptions(buffer_out_, options_);
+        packOptions(buffer_out_);
     }
     catch (const Exception& e) {
        // An exception is thrown and message will be written to Logger
@@ -318,18 +322,29 @@ Pkt6::unpackMsg(OptionBuffer::const_iterator begin,
     // perhaps for stats gathering we can uncomment this.
     //    size -= sizeof(uint32_t); // We just parsed 4 bytes header
 
-    OptionBuffer opt_buffer(begin, end);
-
-    // If custom option parsing function has been set, use this function
-    // to parse options. Otherwise, use standard function from libdhcp.
     size_t offset;
-    if (callback_.empty()) {
-        offset = LibDHCP::unpackOptions6(opt_buffer, "dhcp6", options_);
+    if (lazy_unpack_) {
+        // Only record where the options are. They are created from data_
+        // when they are retrieved.
+        const OptionBuffer::const_iterator data_begin = data_.begin();
+        const size_t first = std::distance(data_begin, begin);
+        option_index_.clear();
+        offset = LibDHCP::indexOptions6(data_, first,
+                                        std::distance(data_begin, end),
+                                        option_index_) - first;
     } else {
-        // The last two arguments hold the DHCPv6 Relay message offset and
-        // length. Setting them to NULL because we are dealing with the
-        // not-relayed message.
-        offset = callback_(opt_buffer, "dhcp6", options_, NULL, NULL);
+        OptionBuffer opt_buffer(begin, end);
+
+        // If custom option parsing function has been set, use this function
+        // to parse options. Otherwise, use standard function from libdhcp.
+        if (callback_.empty()) {
+            offset = LibDHCP::unpackOptions6(opt_buffer, "dhcp6", options_);
+        } else {
+            // The last two arguments hold the DHCPv6 Relay message offset
+            // and length. Setting them to NULL because we are dealing with
+            // the not-relayed message.
+            offset = callback_(opt_buffer, "dhcp6", options_, NULL, NULL);
+        }
     }
 
     // If offset is not equal to the size, then something is wrong here. We
@@ -349,6 +364,18 @@ Pkt6::unpackMsg(OptionBuffer::const_iterator begin,
     (void)offset;
 }
 
+void
+Pkt6::unpackIndexedOptions(const OptionIndex::EntryRange& range,
+                           OptionCollection& options) const {
+    OptionBuffer buf;
+    copyIndexedOptions(data_, range, buf);
+    if (callback_.empty()) {
+        LibDHCP::unpackOptions6(buf, "dhcp6", options);
+    } else {
+        callback_(buf, "dhcp6", options, NULL, NULL);
+    }
+}
+
 void
 Pkt6::unpackRelayMsg() {
 
@@ -501,11 +528,22 @@ Pkt6::toText() {
         << "]:" << remote_port_ << endl;
     tmp << "msgtype=" << static_cast<int>(msg_type_) << ", transid=0x" <<
         hex << transid_ << dec << endl;
+    // The packet is printed even if one of the options which haven't been
+    // retrieved yet is malformed.
+    std::string malformed;
+    try {
+        materializeOptions();
+    } catch (const std::exception& ex) {
+        malformed = ex.what();
+    }
     for (isc::dhcp::OptionCollection::iterator opt=options_.begin();
          opt != options_.end();
          ++opt) {
         tmp << opt->second->toText() << std::endl;
     }
+    if (!malformed.empty()) {
+        tmp << "malformed options: " << malformed << std::endl;
+    }
     return tmp.str();
 }
 
@@ -513,6 +551,7 @@ isc::dhcp::OptionCollection
 Pkt6::getOptions(uint16_t opt_type) {
     isc::dhcp::OptionCollection found;
 
+    materializeOption(opt_type);
     for (OptionCollection::const_iterator x = options_.begin();
          x != options_.end(); ++x) {
         if (x->first == opt_type) {
@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
 
 #include <time.h>
 
@@ -37,6 +38,9 @@ class Pkt6;
 /// @brief A pointer to Pkt6 packet
 typedef boost::shared_ptr<Pkt6> Pkt6Ptr;
 
+/// @brief A collection of pointers to Pkt6 objects.
+typedef std::vector<Pkt6Ptr> Pkt6Collection;
+
 /// @brief Represents a DHCPv6 packet
 ///
 /// This class represents a single DHCPv6 packet. It handles both incoming
@@ -391,6 +395,8 @@ protected:
     /// This method unpacks specified buffer range as a direct
     /// (e.g. solicit or request) message. This method is called from
     /// unpackUDP() when received message is detected to be direct.
+    /// If the lazy unpacking is enabled, the options are only indexed.
+    /// The options of the relays are always created by unpackRelayMsg().
     ///
     /// @param begin start of the buffer
     /// @param end end of the buffer
@@ -407,6 +413,13 @@ protected:
     /// @throw tbd
     void unpackRelayMsg();
 
+    /// @brief Creates the options indexed by the lazy unpacking.
+    ///
+    /// @param range Entries of the options to be created.
+    /// @param [out] options Collection to which the options are added.
+    virtual void unpackIndexedOptions(const OptionIndex::EntryRange& range,
+                                      OptionCollection& options) const;
+
     /// @brief Calculates overhead introduced in specified relay.
     ///
     /// It is used when calculating message size and packing message
@@ -67,6 +67,53 @@ PktFilter::openFallbackSocket(const isc::asiolink::IOAddress& addr,
     return (sock);
 }
 
+size_t
+PktFilter::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                        Pkt4Collection& pkts, const size_t) {
+    Pkt4Ptr pkt = receive(iface, socket_info);
+    if (!pkt) {
+        return (0);
+    }
+    pkts.push_back(pkt);
+    return (1);
+}
+
+size_t
+PktFilter::sendBatch(const Iface& iface, uint16_t sockfd,
+                     const Pkt4Collection& pkts,
+                     const PktSendErrorCallback& error_callback) {
+    size_t sent = 0;
+    std::string first_error;
+    for (Pkt4Collection::const_iterator pkt = pkts.begin(); pkt != pkts.end();
+         ++pkt) {
+        try {
+            send(iface, sockfd, *pkt);
+            ++sent;
+        } catch (const std::exception& ex) {
+            reportSendError(error_callback, *pkt, ex.what(), first_error);
+        }
+    }
+    if (!first_error.empty()) {
+        isc_throw(SocketWriteError, first_error);
+    }
+    return (sent);
+}
+
+void
+PktFilter::releaseSocket(const SocketInfo&) {
+}
+
+void
+PktFilter::reportSendError(const PktSendErrorCallback& error_callback,
+                           const Pkt4Ptr& pkt, const std::string& errmsg,
+                           std::string& first_error) {
+    if (error_callback) {
+        error_callback(pkt, errmsg);
+    } else if (first_error.empty()) {
+        first_error = errmsg;
+    }
+}
+
 
 } // end of isc::dhcp namespace
 } // end of isc namespace
@@ -17,7 +17,9 @@
 
 #include <dhcp/pkt4.h>
 #include <asiolink/io_address.h>
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <string>
 
 namespace isc {
 namespace dhcp {
@@ -35,6 +37,13 @@ struct SocketInfo;
 /// Forward declaration to the class representing interface
 class Iface;
 
+/// @brief Callback reporting a packet of a batch which couldn't be sent.
+///
+/// The first argument is the packet, the second argument is the error
+/// message.
+typedef boost::function<void(const Pkt4Ptr& pkt, const std::string& errmsg)>
+PktSendErrorCallback;
+
 /// @brief Abstract packet handling class
 ///
 /// This class represents low level method to send and receive DHCP packet.
@@ -111,8 +120,76 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt) = 0;
 
+    /// @brief Receive multiple packets over specified socket.
+    ///
+    /// This method is called when the socket has the data to be read. It
+    /// receives at least one packet and then as many packets as are
+    /// available without blocking, up to the specified maximum. The
+    /// default implementation receives a single packet with @c receive.
+    /// The derived classes may override it to receive multiple packets
+    /// with a single system call.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param [out] pkts Collection to which the received packets are
+    /// appended.
+    /// @param max_pkts Maximum number of packets to receive.
+    ///
+    /// @return Number of packets appended to the collection.
+    virtual size_t receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                                Pkt4Collection& pkts, const size_t max_pkts);
+
+    /// @brief Send multiple packets over specified socket.
+    ///
+    /// The default implementation sends the packets one by one with
+    /// @c send. The derived classes may override it to send multiple
+    /// packets with a single system call.
+    ///
+    /// A packet which can't be sent doesn't stop the batch: it is
+    /// reported to the error callback and the remaining packets are sent.
+    /// If no callback is specified, the error is reported by throwing
+    /// @c SocketWriteError after the remaining packets have been sent.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param pkts packets to be sent
+    /// @param error_callback callback invoked for each packet which
+    /// couldn't be sent.
+    ///
+    /// @return Number of packets sent.
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent and no error callback is specified.
+    virtual size_t sendBatch(const Iface& iface, uint16_t sockfd,
+                             const Pkt4Collection& pkts,
+                             const PktSendErrorCallback& error_callback =
+                             PktSendErrorCallback());
+
+    /// @brief Release the resources associated with the socket.
+    ///
+    /// The @c IfaceMgr calls this method before it closes the socket
+    /// opened with @c openSocket. The default implementation does nothing.
+    /// The derived classes override it to release the resources they keep
+    /// for the socket.
+    ///
+    /// @param socket_info structure holding socket information
+    virtual void releaseSocket(const SocketInfo& socket_info);
+
 protected:
 
+    /// @brief Reports a packet of a batch which couldn't be sent.
+    ///
+    /// The error is passed to the callback if one is specified.
+    /// Otherwise, the first error is retained in @c first_error, so
+    /// that it can be thrown when the whole batch has been processed.
+    ///
+    /// @param error_callback callback passed to @c sendBatch.
+    /// @param pkt packet which couldn't be sent.
+    /// @param errmsg error message.
+    /// @param [out] first_error first error reported without a callback.
+    static void reportSendError(const PktSendErrorCallback& error_callback,
+                                const Pkt4Ptr& pkt, const std::string& errmsg,
+                                std::string& first_error);
+
     /// @brief Default implementation to open a fallback socket.
     ///
     /// This method provides a means to open a fallback socket and bind it
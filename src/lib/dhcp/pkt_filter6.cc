@@ -39,6 +39,17 @@ PktFilter6::joinMulticast(int sock, const std::string& ifname,
     return (true);
 }
 
+size_t
+PktFilter6::receiveBatch(const SocketInfo& socket_info, Pkt6Collection& pkts,
+                         const size_t) {
+    Pkt6Ptr pkt = receive(socket_info);
+    if (!pkt) {
+        return (0);
+    }
+    pkts.push_back(pkt);
+    return (1);
+}
+
 
 } // end of isc::dhcp namespace
 } // end of isc namespace
@@ -123,6 +123,22 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt6Ptr& pkt) = 0;
 
+    /// @brief Receives multiple DHCPv6 messages on the interface.
+    ///
+    /// This function is called when the socket has the data to be read. It
+    /// receives at least one message and then as many messages as are
+    /// available without blocking, up to the specified maximum. The
+    /// default implementation receives a single message with @c receive.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param [out] pkts Collection to which the received messages are
+    /// appended.
+    /// @param max_pkts Maximum number of messages to receive.
+    ///
+    /// @return Number of messages appended to the collection.
+    virtual size_t receiveBatch(const SocketInfo& socket_info,
+                                Pkt6Collection& pkts, const size_t max_pkts);
+
     /// @brief Joins IPv6 multicast group on a socket.
     ///
     /// This function joins the socket to the specified multicast group.
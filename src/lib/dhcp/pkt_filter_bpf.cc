@@ -523,6 +523,8 @@ PktFilterBPF::receive(Iface& iface, const SocketInfo& socket_info) {
     // Decode DHCP data into the Pkt4 object.
     Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(&dhcp_buf[0], dhcp_buf.size()));
 
+    pkt->updateTimestamp();
+
     // Set the appropriate packet members using data collected from
     // the decoded headers.
     pkt->setIndex(iface.getIndex());
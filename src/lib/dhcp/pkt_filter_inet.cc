@@ -18,6 +18,7 @@
 #include <dhcp/pkt_filter_inet.h>
 #include <errno.h>
 #include <cstring>
+#include <sstream>
 
 using namespace isc::asiolink;
 
@@ -104,18 +105,173 @@ PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
     struct sockaddr_in from_addr;
     uint8_t buf[IfaceMgr::RCVBUFSIZE];
 
-    memset(&control_buf_[0], 0, control_buf_len_);
-    memset(&from_addr, 0, sizeof(from_addr));
-
     // Initialize our message header structure.
     struct msghdr m;
+    struct iovec v;
+    initReceiveHeader(m, v, from_addr, buf, &control_buf_[0]);
+
+    int result = recvmsg(socket_info.sockfd_, &m, 0);
+    if (result < 0) {
+        isc_throw(SocketReadError, "failed to receive UDP4 data");
+    }
+
+    return (createPacket(iface, socket_info, buf, result, from_addr, m));
+}
+
+size_t
+PktFilterInet::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                            Pkt4Collection& pkts, const size_t max_pkts) {
+#if defined (OS_LINUX) && defined (MSG_WAITFORONE)
+    if (max_pkts <= 1) {
+        return (PktFilter::receiveBatch(iface, socket_info, pkts, max_pkts));
+    }
+    prepareBatch(max_pkts);
+
+    std::vector<struct mmsghdr> msgs(max_pkts);
+    std::vector<struct iovec> iovs(max_pkts);
+    std::vector<struct sockaddr_in> from_addrs(max_pkts);
+    for (size_t i = 0; i < max_pkts; ++i) {
+        initReceiveHeader(msgs[i].msg_hdr, iovs[i], from_addrs[i],
+                          &batch_buf_[i * IfaceMgr::RCVBUFSIZE],
+                          &batch_control_buf_[i * control_buf_len_]);
+        msgs[i].msg_len = 0;
+    }
+
+    // Wait for the first packet only. The remaining packets are received
+    // if they are already queued on the socket.
+    int result = recvmmsg(socket_info.sockfd_, &msgs[0], max_pkts,
+                          MSG_WAITFORONE, NULL);
+    if (result < 0) {
+        isc_throw(SocketReadError, "failed to receive UDP4 data");
+    }
+
+    // The packets which can't be parsed are reported after the remaining
+    // packets are appended to the collection, so as they are not lost.
+    std::string error;
+    size_t received = 0;
+    for (int i = 0; i < result; ++i) {
+        try {
+            pkts.push_back(createPacket(iface, socket_info,
+                                        &batch_buf_[i * IfaceMgr::RCVBUFSIZE],
+                                        msgs[i].msg_len, from_addrs[i],
+                                        msgs[i].msg_hdr));
+            ++received;
+        } catch (const std::exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        isc_throw(SocketReadError, "failed to parse received UDP4 data: "
+                  << error);
+    }
+    return (received);
+#else
+    return (PktFilter::receiveBatch(iface, socket_info, pkts, max_pkts));
+#endif
+}
+
+int
+PktFilterInet::send(const Iface&, uint16_t sockfd,
+                    const Pkt4Ptr& pkt) {
+    struct sockaddr_in to;
+    struct msghdr m;
+    struct iovec v;
+    // The packets may be sent by multiple threads while the packets are
+    // received, so the control buffer is not shared with other calls.
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+    } control;
+    initSendHeader(m, v, to, pkt, control.buf);
+
+    pkt->updateTimestamp();
+
+    int result = sendmsg(sockfd, &m, 0);
+    if (result < 0) {
+        isc_throw(SocketWriteError, "pkt4 send failed: sendmsg() returned "
+                  " with an error: " << strerror(errno));
+    }
+
+    return (result);
+}
+
+size_t
+PktFilterInet::sendBatch(const Iface& iface, uint16_t sockfd,
+                         const Pkt4Collection& pkts,
+                         const PktSendErrorCallback& error_callback) {
+#if defined (OS_LINUX) && defined (MSG_WAITFORONE)
+    if (pkts.size() <= 1) {
+        return (PktFilter::sendBatch(iface, sockfd, pkts, error_callback));
+    }
+
+    // The batches may be sent by multiple threads while the packets are
+    // received, so the control buffers are not shared with other calls.
+    std::vector<char> control_bufs(pkts.size() * control_buf_len_);
+    std::vector<struct mmsghdr> msgs(pkts.size());
+    std::vector<struct iovec> iovs(pkts.size());
+    std::vector<struct sockaddr_in> to_addrs(pkts.size());
+    for (size_t i = 0; i < pkts.size(); ++i) {
+        initSendHeader(msgs[i].msg_hdr, iovs[i], to_addrs[i], pkts[i],
+                       &control_bufs[i * control_buf_len_]);
+        msgs[i].msg_len = 0;
+        pkts[i]->updateTimestamp();
+    }
+
+    // The kernel may send fewer packets than requested, so keep sending
+    // the remaining ones. sendmmsg() stops at the first packet which
+    // can't be sent and reports the error only if it is the first packet
+    // of the call, so skip that packet and send the ones after it.
+    size_t sent = 0;
+    size_t next = 0;
+    std::string first_error;
+    while (next < pkts.size()) {
+        int result = sendmmsg(sockfd, &msgs[next], pkts.size() - next, 0);
+        if (result > 0) {
+            sent += result;
+            next += result;
+            continue;
+        }
+        std::ostringstream errmsg;
+        errmsg << "pkt4 send to " << pkts[next]->getRemoteAddr()
+               << " failed: sendmmsg() returned with an error: "
+               << (result < 0 ? strerror(errno) : "no packet sent");
+        reportSendError(error_callback, pkts[next], errmsg.str(),
+                        first_error);
+        ++next;
+    }
+    if (!first_error.empty()) {
+        isc_throw(SocketWriteError, first_error);
+    }
+    return (sent);
+#else
+    return (PktFilter::sendBatch(iface, sockfd, pkts, error_callback));
+#endif
+}
+
+void
+PktFilterInet::prepareBatch(const size_t num_pkts) {
+    if (batch_buf_.size() < num_pkts * IfaceMgr::RCVBUFSIZE) {
+        batch_buf_.resize(num_pkts * IfaceMgr::RCVBUFSIZE);
+    }
+    if (batch_control_buf_.size() < num_pkts * control_buf_len_) {
+        batch_control_buf_.resize(num_pkts * control_buf_len_);
+    }
+}
+
+void
+PktFilterInet::initReceiveHeader(struct msghdr& m, struct iovec& v,
+                                 struct sockaddr_in& from_addr, uint8_t* buf,
+                                 char* control_buf) const {
+    memset(control_buf, 0, control_buf_len_);
+    memset(&from_addr, 0, sizeof(from_addr));
     memset(&m, 0, sizeof(m));
 
     // Point so we can get the from address.
     m.msg_name = &from_addr;
     m.msg_namelen = sizeof(from_addr);
 
-    struct iovec v;
     v.iov_base = static_cast<void*>(buf);
     v.iov_len = IfaceMgr::RCVBUFSIZE;
     m.msg_iov = &v;
@@ -127,16 +283,17 @@ PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
     // previously asked the kernel to give us packet
     // information (when we initialized the interface), so we
     // should get the destination address from that.
-    m.msg_control = &control_buf_[0];
+    m.msg_control = control_buf;
     m.msg_controllen = control_buf_len_;
+}
 
-    int result = recvmsg(socket_info.sockfd_, &m, 0);
-    if (result < 0) {
-        isc_throw(SocketReadError, "failed to receive UDP4 data");
-    }
-
+Pkt4Ptr
+PktFilterInet::createPacket(Iface& iface, const SocketInfo& socket_info,
+                            const uint8_t* buf, const size_t len,
+                            const struct sockaddr_in& from_addr,
+                            struct msghdr& m) const {
     // We have all data let's create Pkt4 object.
-    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(buf, result));
+    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(buf, len));
 
     pkt->updateTimestamp();
 
@@ -184,24 +341,25 @@ PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
         }
         cmsg = CMSG_NXTHDR(&m, cmsg);
     }
+#else
+    static_cast<void>(m);
 #endif
 
     return (pkt);
 }
 
-int
-PktFilterInet::send(const Iface&, uint16_t sockfd,
-                    const Pkt4Ptr& pkt) {
-    memset(&control_buf_[0], 0, control_buf_len_);
+void
+PktFilterInet::initSendHeader(struct msghdr& m, struct iovec& v,
+                              struct sockaddr_in& to, const Pkt4Ptr& pkt,
+                              char* control_buf) const {
+    memset(control_buf, 0, control_buf_len_);
 
     // Set the target address we're sending to.
-    sockaddr_in to;
     memset(&to, 0, sizeof(to));
     to.sin_family = AF_INET;
     to.sin_port = htons(pkt->getRemotePort());
     to.sin_addr.s_addr = htonl(pkt->getRemoteAddr());
 
-    struct msghdr m;
     // Initialize our message header structure.
     memset(&m, 0, sizeof(m));
     m.msg_name = &to;
@@ -210,7 +368,6 @@ PktFilterInet::send(const Iface&, uint16_t sockfd,
     // Set the data buffer we're sending. (Using this wacky
     // "scatter-gather" stuff... we only have a single chunk
     // of data to send, so we declare a single vector entry.)
-    struct iovec v;
     memset(&v, 0, sizeof(v));
     // iov_base field is of void * type. We use it for packet
     // transmission, so this buffer will not be modified.
@@ -228,7 +385,7 @@ PktFilterInet::send(const Iface&, uint16_t sockfd,
     // We have to create a "control message", and set that to
     // define the IPv4 packet information. We set the source address
     // to handle correctly interfaces with multiple addresses.
-    m.msg_control = &control_buf_[0];
+    m.msg_control = control_buf;
     m.msg_controllen = control_buf_len_;
     struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
     cmsg->cmsg_level = IPPROTO_IP;
@@ -237,22 +394,10 @@ PktFilterInet::send(const Iface&, uint16_t sockfd,
     struct in_pktinfo* pktinfo =(struct in_pktinfo *)CMSG_DATA(cmsg);
     memset(pktinfo, 0, sizeof(struct in_pktinfo));
     pktinfo->ipi_ifindex = pkt->getIndex();
-	pktinfo->ipi_spec_dst.s_addr = htonl(pkt->getLocalAddr()); // set the source IP address
+    pktinfo->ipi_spec_dst.s_addr = htonl(pkt->getLocalAddr()); // set the source IP address
     m.msg_controllen = CMSG_SPACE(sizeof(struct in_pktinfo));
 #endif
-
-    pkt->updateTimestamp();
-
-    int result = sendmsg(sockfd, &m, 0);
-    if (result < 0) {
-        isc_throw(SocketWriteError, "pkt4 send failed: sendmsg() returned "
-                  " with an error: " << strerror(errno));
-    }
-
-    return (result);
 }
 
-
-
 } // end of isc::dhcp namespace
 } // end of isc namespace
@@ -17,6 +17,9 @@
 
 #include <dhcp/pkt_filter.h>
 #include <boost/scoped_array.hpp>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -85,11 +88,101 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt);
 
+    /// @brief Receive multiple packets over specified socket.
+    ///
+    /// On Linux, the packets are received with a single recvmmsg() call,
+    /// which waits for the first packet and returns the packets which are
+    /// already queued on the socket, up to the specified maximum. On other
+    /// systems, a single packet is received.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param [out] pkts Collection to which the received packets are
+    /// appended.
+    /// @param max_pkts Maximum number of packets to receive.
+    ///
+    /// @return Number of packets appended to the collection.
+    /// @throw isc::dhcp::SocketReadError if an error occurs during reception
+    /// of the packets or any of the received packets can't be parsed. In
+    /// the latter case, the remaining packets are appended to the collection.
+    virtual size_t receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                                Pkt4Collection& pkts, const size_t max_pkts);
+
+    /// @brief Send multiple packets over specified socket.
+    ///
+    /// On Linux, the packets are sent with sendmmsg(), usually in a single
+    /// call. On other systems, the packets are sent one by one. A packet
+    /// which can't be sent is skipped and the remaining packets are sent.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param pkts packets to be sent
+    /// @param error_callback callback invoked for each packet which
+    /// couldn't be sent.
+    ///
+    /// @return Number of packets sent.
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent and no error callback is specified.
+    virtual size_t sendBatch(const Iface& iface, uint16_t sockfd,
+                             const Pkt4Collection& pkts,
+                             const PktSendErrorCallback& error_callback =
+                             PktSendErrorCallback());
+
 private:
+
+    /// @brief Makes sure that the batch buffers can hold the received
+    /// packets.
+    ///
+    /// @param num_pkts Number of packets in the batch.
+    void prepareBatch(const size_t num_pkts);
+
+    /// @brief Initializes the message header to receive a packet.
+    ///
+    /// @param [out] m Message header.
+    /// @param [out] v Data buffer descriptor.
+    /// @param [out] from_addr Structure receiving the sender's address.
+    /// @param buf Buffer of @c IfaceMgr::RCVBUFSIZE bytes for the packet.
+    /// @param control_buf Control buffer of @c control_buf_len_ bytes.
+    void initReceiveHeader(struct msghdr& m, struct iovec& v,
+                           struct sockaddr_in& from_addr, uint8_t* buf,
+                           char* control_buf) const;
+
+    /// @brief Creates the packet from the received data.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param buf Received data.
+    /// @param len Length of the received data.
+    /// @param from_addr Sender's address.
+    /// @param m Message header holding the control messages.
+    ///
+    /// @return Received packet.
+    Pkt4Ptr createPacket(Iface& iface, const SocketInfo& socket_info,
+                         const uint8_t* buf, const size_t len,
+                         const struct sockaddr_in& from_addr,
+                         struct msghdr& m) const;
+
+    /// @brief Initializes the message header to send a packet.
+    ///
+    /// @param [out] m Message header.
+    /// @param [out] v Data buffer descriptor.
+    /// @param [out] to Structure holding the destination address.
+    /// @param pkt Packet to be sent.
+    /// @param control_buf Control buffer of @c control_buf_len_ bytes.
+    void initSendHeader(struct msghdr& m, struct iovec& v,
+                        struct sockaddr_in& to, const Pkt4Ptr& pkt,
+                        char* control_buf) const;
+
     /// Length of the control_buf_ array.
     size_t control_buf_len_;
-    /// Control buffer, used in transmission and reception.
+    /// Control buffer, used in reception. The packets may be sent by
+    /// multiple threads, so the control buffers used in transmission
+    /// are allocated for each call.
     boost::scoped_array<char> control_buf_;
+    /// Buffer for the packets received in batch.
+    std::vector<uint8_t> batch_buf_;
+    /// Control buffers for the packets received in batch.
+    std::vector<char> batch_control_buf_;
 };
 
 } // namespace isc::dhcp
@@ -129,12 +129,88 @@ Pkt6Ptr
 PktFilterInet6::receive(const SocketInfo& socket_info) {
     // Now we have a socket, let's get some data from it!
     uint8_t buf[IfaceMgr::RCVBUFSIZE];
-    memset(&control_buf_[0], 0, control_buf_len_);
     struct sockaddr_in6 from;
-    memset(&from, 0, sizeof(from));
 
     // Initialize our message header structure.
     struct msghdr m;
+    struct iovec v;
+    initReceiveHeader(m, v, from, buf, &control_buf_[0]);
+
+    int result = recvmsg(socket_info.sockfd_, &m, 0);
+    if (result < 0) {
+        isc_throw(SocketReadError, "failed to receive data");
+    }
+
+    return (createPacket(socket_info, buf, result, from, m));
+}
+
+size_t
+PktFilterInet6::receiveBatch(const SocketInfo& socket_info,
+                             Pkt6Collection& pkts, const size_t max_pkts) {
+#if defined (OS_LINUX) && defined (MSG_WAITFORONE)
+    if (max_pkts <= 1) {
+        return (PktFilter6::receiveBatch(socket_info, pkts, max_pkts));
+    }
+    if (batch_buf_.size() < max_pkts * IfaceMgr::RCVBUFSIZE) {
+        batch_buf_.resize(max_pkts * IfaceMgr::RCVBUFSIZE);
+    }
+    if (batch_control_buf_.size() < max_pkts * control_buf_len_) {
+        batch_control_buf_.resize(max_pkts * control_buf_len_);
+    }
+
+    std::vector<struct mmsghdr> msgs(max_pkts);
+    std::vector<struct iovec> iovs(max_pkts);
+    std::vector<struct sockaddr_in6> from_addrs(max_pkts);
+    for (size_t i = 0; i < max_pkts; ++i) {
+        initReceiveHeader(msgs[i].msg_hdr, iovs[i], from_addrs[i],
+                          &batch_buf_[i * IfaceMgr::RCVBUFSIZE],
+                          &batch_control_buf_[i * control_buf_len_]);
+        msgs[i].msg_len = 0;
+    }
+
+    // Wait for the first packet only. The remaining packets are received
+    // if they are already queued on the socket.
+    int result = recvmmsg(socket_info.sockfd_, &msgs[0], max_pkts,
+                          MSG_WAITFORONE, NULL);
+    if (result < 0) {
+        isc_throw(SocketReadError, "failed to receive data");
+    }
+
+    // The packets which can't be handled are reported after the remaining
+    // packets are appended to the collection, so as they are not lost.
+    std::string error;
+    size_t received = 0;
+    for (int i = 0; i < result; ++i) {
+        try {
+            Pkt6Ptr pkt = createPacket(socket_info,
+                                       &batch_buf_[i * IfaceMgr::RCVBUFSIZE],
+                                       msgs[i].msg_len, from_addrs[i],
+                                       msgs[i].msg_hdr);
+            if (pkt) {
+                pkts.push_back(pkt);
+                ++received;
+            }
+        } catch (const std::exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        isc_throw(SocketReadError, error);
+    }
+    return (received);
+#else
+    return (PktFilter6::receiveBatch(socket_info, pkts, max_pkts));
+#endif
+}
+
+void
+PktFilterInet6::initReceiveHeader(struct msghdr& m, struct iovec& v,
+                                  struct sockaddr_in6& from, uint8_t* buf,
+                                  char* control_buf) const {
+    memset(control_buf, 0, control_buf_len_);
+    memset(&from, 0, sizeof(from));
     memset(&m, 0, sizeof(m));
 
     // Point so we can get the from address.
@@ -144,7 +220,6 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     // Set the data buffer we're receiving. (Using this wacky
     // "scatter-gather" stuff... but we that doesn't really make
     // sense for us, so we use a single vector entry.)
-    struct iovec v;
     memset(&v, 0, sizeof(v));
     v.iov_base = static_cast<void*>(buf);
     v.iov_len = IfaceMgr::RCVBUFSIZE;
@@ -157,43 +232,41 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     // previously asked the kernel to give us packet
     // information (when we initialized the interface), so we
     // should get the destination address from that.
-    m.msg_control = &control_buf_[0];
+    m.msg_control = control_buf;
     m.msg_controllen = control_buf_len_;
+}
 
-    int result = recvmsg(socket_info.sockfd_, &m, 0);
-
+Pkt6Ptr
+PktFilterInet6::createPacket(const SocketInfo& socket_info,
+                             const uint8_t* buf, const size_t len,
+                             const struct sockaddr_in6& from,
+                             struct msghdr& m) const {
     struct in6_addr to_addr;
     memset(&to_addr, 0, sizeof(to_addr));
 
     int ifindex = -1;
-    if (result >= 0) {
-        struct in6_pktinfo* pktinfo = NULL;
-
-
-        // If we did read successfully, then we need to loop
-        // through the control messages we received and
-        // find the one with our destination address.
-        //
-        // We also keep a flag to see if we found it. If we
-        // didn't, then we consider this to be an error.
-        bool found_pktinfo = false;
-        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
-        while (cmsg != NULL) {
-            if ((cmsg->cmsg_level == IPPROTO_IPV6) &&
-                (cmsg->cmsg_type == IPV6_PKTINFO)) {
-                pktinfo = util::io::internal::convertPktInfo6(CMSG_DATA(cmsg));
-                to_addr = pktinfo->ipi6_addr;
-                ifindex = pktinfo->ipi6_ifindex;
-                found_pktinfo = true;
-                break;
-            }
-            cmsg = CMSG_NXTHDR(&m, cmsg);
-        }
-        if (!found_pktinfo) {
-            isc_throw(SocketReadError, "unable to find pktinfo");
+    struct in6_pktinfo* pktinfo = NULL;
+
+    // We need to loop through the control messages we received and
+    // find the one with our destination address.
+    //
+    // We also keep a flag to see if we found it. If we
+    // didn't, then we consider this to be an error.
+    bool found_pktinfo = false;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
+    while (cmsg != NULL) {
+        if ((cmsg->cmsg_level == IPPROTO_IPV6) &&
+            (cmsg->cmsg_type == IPV6_PKTINFO)) {
+            pktinfo = util::io::internal::convertPktInfo6(CMSG_DATA(cmsg));
+            to_addr = pktinfo->ipi6_addr;
+            ifindex = pktinfo->ipi6_ifindex;
+            found_pktinfo = true;
+            break;
         }
-    } else {
-        isc_throw(SocketReadError, "failed to receive data");
+        cmsg = CMSG_NXTHDR(&m, cmsg);
+    }
+    if (!found_pktinfo) {
+        isc_throw(SocketReadError, "unable to find pktinfo");
     }
 
     // Filter out packets sent to global unicast address (not link local and
@@ -210,15 +283,14 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     // Let's create a packet.
     Pkt6Ptr pkt;
     try {
-        pkt = Pkt6Ptr(new Pkt6(buf, result));
+        pkt = Pkt6Ptr(new Pkt6(buf, len));
     } catch (const std::exception& ex) {
         isc_throw(SocketReadError, "failed to create new packet");
     }
 
     pkt->updateTimestamp();
 
-    pkt->setLocalAddr(IOAddress::fromBytes(AF_INET6,
-                      reinterpret_cast<const uint8_t*>(&to_addr)));
+    pkt->setLocalAddr(local_addr);
     pkt->setRemoteAddr(IOAddress::fromBytes(AF_INET6,
                        reinterpret_cast<const uint8_t*>(&from.sin6_addr)));
     pkt->setRemotePort(ntohs(from.sin6_port));
@@ -233,13 +305,18 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     }
 
     return (pkt);
-
 }
 
 int
 PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
 
-    memset(&control_buf_[0], 0, control_buf_len_);
+    // The packets may be sent by multiple threads while the packets are
+    // received, so the control buffer is not shared with other calls.
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+    } control;
+    memset(control.buf, 0, sizeof(control.buf));
 
     // Set the target address we're sending to.
     sockaddr_in6 to;
@@ -281,8 +358,8 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     // define the IPv6 packet information. We could set the
     // source address if we wanted, but we can safely let the
     // kernel decide what that should be.
-    m.msg_control = &control_buf_[0];
-    m.msg_controllen = control_buf_len_;
+    m.msg_control = control.buf;
+    m.msg_controllen = sizeof(control.buf);
     struct cmsghdr *cmsg = CMSG_FIRSTHDR(&m);
 
     // FIXME: Code below assumes that cmsg is not NULL, but
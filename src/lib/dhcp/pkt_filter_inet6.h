@@ -17,6 +17,9 @@
 
 #include <dhcp/pkt_filter6.h>
 #include <boost/scoped_array.hpp>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -91,11 +94,64 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt6Ptr& pkt);
 
+    /// @brief Receives multiple DHCPv6 messages on the interface.
+    ///
+    /// On Linux, the messages are received with a single recvmmsg() call,
+    /// which waits for the first message and returns the messages which
+    /// are already queued on the socket, up to the specified maximum. The
+    /// messages are filtered in the same way as by @c receive. On other
+    /// systems, a single message is received.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param [out] pkts Collection to which the received messages are
+    /// appended.
+    /// @param max_pkts Maximum number of messages to receive.
+    ///
+    /// @return Number of messages appended to the collection.
+    /// @throw isc::dhcp::SocketReadError if an error occurs during reception
+    /// of the messages or any of the received messages can't be handled. In
+    /// the latter case, the remaining messages are appended to the collection.
+    virtual size_t receiveBatch(const SocketInfo& socket_info,
+                                Pkt6Collection& pkts, const size_t max_pkts);
+
 private:
+
+    /// @brief Initializes the message header to receive a message.
+    ///
+    /// @param [out] m Message header.
+    /// @param [out] v Data buffer descriptor.
+    /// @param [out] from Structure receiving the sender's address.
+    /// @param buf Buffer of @c IfaceMgr::RCVBUFSIZE bytes for the message.
+    /// @param control_buf Control buffer of @c control_buf_len_ bytes.
+    void initReceiveHeader(struct msghdr& m, struct iovec& v,
+                           struct sockaddr_in6& from, uint8_t* buf,
+                           char* control_buf) const;
+
+    /// @brief Creates the message from the received data.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param buf Received data.
+    /// @param len Length of the received data.
+    /// @param from Sender's address.
+    /// @param m Message header holding the control messages.
+    ///
+    /// @return A pointer to received message or NULL if the message should
+    /// be dropped.
+    Pkt6Ptr createPacket(const SocketInfo& socket_info,
+                         const uint8_t* buf, const size_t len,
+                         const struct sockaddr_in6& from,
+                         struct msghdr& m) const;
+
     /// Length of the control_buf_ array.
     size_t control_buf_len_;
-    /// Control buffer, used in transmission and reception.
+    /// Control buffer, used in reception. The packets may be sent by
+    /// multiple threads, so the control buffer used in transmission is
+    /// allocated for each call.
     boost::scoped_array<char> control_buf_;
+    /// Buffer for the messages received in batch.
+    std::vector<uint8_t> batch_buf_;
+    /// Control buffers for the messages received in batch.
+    std::vector<char> batch_control_buf_;
 };
 
 } // namespace isc::dhcp
@@ -23,6 +23,10 @@
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
 #include <net/ethernet.h>
+#include <poll.h>
+#include <sys/mman.h>
+
+#include <boost/noncopyable.hpp>
 
 namespace {
 
@@ -128,13 +132,216 @@ struct sock_filter dhcp_sock_filter [] = {
     BPF_STMT(BPF_RET + BPF_K, 0),
 };
 
+/// Size of the blocks of the receive ring. It must be a multiple of the
+/// page size.
+const unsigned int RX_RING_BLOCK_SIZE = 1 << 16;
+
+/// Number of the blocks of the receive ring.
+const unsigned int RX_RING_BLOCK_NR = 16;
+
+/// Size of the frames of the rings. It is only used by the kernel to
+/// validate the ring settings and to lay out the frames of the transmit
+/// ring.
+const unsigned int RING_FRAME_SIZE = 2048;
+
+/// Time (in milliseconds) after which the kernel hands over a partially
+/// filled block of the receive ring to the server.
+const unsigned int RX_RING_BLOCK_TIMEOUT = 1;
+
+/// Size of the blocks of the transmit ring.
+const unsigned int TX_RING_BLOCK_SIZE = 1 << 16;
+
+/// Number of the blocks of the transmit ring.
+const unsigned int TX_RING_BLOCK_NR = 4;
+
 }
 
 using namespace isc::util;
+using namespace isc::util::thread;
 
 namespace isc {
 namespace dhcp {
 
+struct PktFilterLPF::PacketRing : public boost::noncopyable {
+
+    /// @brief Constructor.
+    PacketRing()
+        : map_(MAP_FAILED), map_size_(0), rx_block_(0), rx_frame_(NULL),
+          rx_frames_left_(0), tx_map_(NULL), tx_frame_nr_(0), tx_frame_(0) {
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Unmaps the rings.
+    ~PacketRing() {
+        if (map_ != MAP_FAILED) {
+            munmap(map_, map_size_);
+        }
+    }
+
+    /// @brief Returns the descriptor of the receive ring block.
+    ///
+    /// @param index Index of the block.
+    struct tpacket_block_desc* getBlock(const unsigned int index) const {
+        return (reinterpret_cast<struct tpacket_block_desc*>
+                (static_cast<uint8_t*>(map_) + index * RX_RING_BLOCK_SIZE));
+    }
+
+    /// @brief Starts reading the next block if it is ready.
+    ///
+    /// @return false if the next block is still used by the kernel.
+    bool openBlock() {
+        struct tpacket_block_desc* block = getBlock(rx_block_);
+        if ((block->hdr.bh1.block_status & TP_STATUS_USER) == 0) {
+            return (false);
+        }
+        // Don't read the frames before the kernel hands over the block.
+        __sync_synchronize();
+        rx_frame_ = reinterpret_cast<uint8_t*>(block) +
+            block->hdr.bh1.offset_to_first_pkt;
+        rx_frames_left_ = block->hdr.bh1.num_pkts;
+        if (rx_frames_left_ == 0) {
+            releaseBlock();
+        }
+        return (true);
+    }
+
+    /// @brief Moves to the next frame of the current block.
+    ///
+    /// When all frames of the block have been read, the block is handed
+    /// back to the kernel.
+    void releaseFrame() {
+        const struct tpacket3_hdr* hdr =
+            reinterpret_cast<const struct tpacket3_hdr*>(rx_frame_);
+        rx_frame_ += hdr->tp_next_offset;
+        if (--rx_frames_left_ == 0) {
+            releaseBlock();
+        }
+    }
+
+    /// @brief Hands the current block back to the kernel.
+    void releaseBlock() {
+        // Finish reading the frames before the kernel reuses the block.
+        __sync_synchronize();
+        getBlock(rx_block_)->hdr.bh1.block_status = TP_STATUS_KERNEL;
+        rx_block_ = (rx_block_ + 1) % RX_RING_BLOCK_NR;
+        rx_frame_ = NULL;
+    }
+
+    /// @brief Returns the header of the transmit ring frame.
+    ///
+    /// @param index Index of the frame.
+    struct tpacket3_hdr* getTxFrame(const unsigned int index) const {
+        return (reinterpret_cast<struct tpacket3_hdr*>
+                (tx_map_ + index * RING_FRAME_SIZE));
+    }
+
+    /// Beginning of the mapped rings. The receive ring precedes the
+    /// transmit ring.
+    void* map_;
+    /// Size of the mapped rings.
+    size_t map_size_;
+    /// Index of the receive ring block being read.
+    unsigned int rx_block_;
+    /// Next frame of the block being read.
+    uint8_t* rx_frame_;
+    /// Number of the frames of the block left to be read.
+    unsigned int rx_frames_left_;
+    /// Beginning of the transmit ring or NULL if there is no transmit ring.
+    uint8_t* tx_map_;
+    /// Number of the frames of the transmit ring.
+    unsigned int tx_frame_nr_;
+    /// Index of the next transmit ring frame to be written.
+    unsigned int tx_frame_;
+    /// Mutex serializing the access to the transmit ring.
+    Mutex tx_mutex_;
+};
+
+PktFilterLPF::PktFilterLPF(const bool use_ring)
+    : use_ring_(use_ring) {
+}
+
+PktFilterLPF::~PktFilterLPF() {
+}
+
+void
+PktFilterLPF::releaseSocket(const SocketInfo& socket_info) {
+    Mutex::Locker locker(rings_mutex_);
+    rings_.erase(socket_info.sockfd_);
+}
+
+bool
+PktFilterLPF::hasRing(const int sockfd) const {
+    return (static_cast<bool>(getRing(sockfd)));
+}
+
+PktFilterLPF::PacketRingPtr
+PktFilterLPF::getRing(const int sockfd) const {
+    Mutex::Locker locker(rings_mutex_);
+    std::map<int, PacketRingPtr>::const_iterator ring = rings_.find(sockfd);
+    if (ring == rings_.end()) {
+        return (PacketRingPtr());
+    }
+    return (ring->second);
+}
+
+PktFilterLPF::PacketRingPtr
+PktFilterLPF::createRing(const int sock) {
+#ifdef TPACKET3_HDRLEN
+    int version = TPACKET_V3;
+    if (setsockopt(sock, SOL_PACKET, PACKET_VERSION, &version,
+                   sizeof(version)) < 0) {
+        return (PacketRingPtr());
+    }
+
+    struct tpacket_req3 rx_req;
+    memset(&rx_req, 0, sizeof(rx_req));
+    rx_req.tp_block_size = RX_RING_BLOCK_SIZE;
+    rx_req.tp_block_nr = RX_RING_BLOCK_NR;
+    rx_req.tp_frame_size = RING_FRAME_SIZE;
+    rx_req.tp_frame_nr = RX_RING_BLOCK_SIZE * RX_RING_BLOCK_NR /
+        RING_FRAME_SIZE;
+    rx_req.tp_retire_blk_tov = RX_RING_BLOCK_TIMEOUT;
+    if (setsockopt(sock, SOL_PACKET, PACKET_RX_RING, &rx_req,
+                   sizeof(rx_req)) < 0) {
+        return (PacketRingPtr());
+    }
+    size_t map_size = RX_RING_BLOCK_SIZE * RX_RING_BLOCK_NR;
+
+    // The transmit ring of the TPACKET_V3 sockets requires Linux 4.11.
+    // The packets are sent with sendto() if it can't be set up.
+    struct tpacket_req3 tx_req;
+    memset(&tx_req, 0, sizeof(tx_req));
+    tx_req.tp_block_size = TX_RING_BLOCK_SIZE;
+    tx_req.tp_block_nr = TX_RING_BLOCK_NR;
+    tx_req.tp_frame_size = RING_FRAME_SIZE;
+    tx_req.tp_frame_nr = TX_RING_BLOCK_SIZE * TX_RING_BLOCK_NR /
+        RING_FRAME_SIZE;
+    const bool has_tx_ring = (setsockopt(sock, SOL_PACKET, PACKET_TX_RING,
+                                         &tx_req, sizeof(tx_req)) == 0);
+    if (has_tx_ring) {
+        map_size += TX_RING_BLOCK_SIZE * TX_RING_BLOCK_NR;
+    }
+
+    PacketRingPtr ring(new PacketRing());
+    ring->map_ = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      sock, 0);
+    if (ring->map_ == MAP_FAILED) {
+        return (PacketRingPtr());
+    }
+    ring->map_size_ = map_size;
+    if (has_tx_ring) {
+        ring->tx_map_ = static_cast<uint8_t*>(ring->map_) +
+            RX_RING_BLOCK_SIZE * RX_RING_BLOCK_NR;
+        ring->tx_frame_nr_ = tx_req.tp_frame_nr;
+    }
+    return (ring);
+#else
+    static_cast<void>(sock);
+    return (PacketRingPtr());
+#endif
+}
+
 SocketInfo
 PktFilterLPF::openSocket(Iface& iface,
                          const isc::asiolink::IOAddress& addr,
@@ -196,14 +403,32 @@ PktFilterLPF::openSocket(Iface& iface,
                   << "' to interface '" << iface.getName() << "'");
     }
 
+    // Set up the ring buffers. If the kernel doesn't support them, the
+    // socket is used with the regular system calls. The rings of the
+    // closed socket are normally released by releaseSocket, but the
+    // descriptor may have been reused without it, so the old rings are
+    // released here too.
+    PacketRingPtr ring;
+    if (use_ring_) {
+        ring = createRing(sock);
+    }
+    {
+        Mutex::Locker locker(rings_mutex_);
+        if (ring) {
+            rings_[sock] = ring;
+        } else {
+            rings_.erase(sock);
+        }
+    }
+
     return (SocketInfo(addr, port, sock, fallback));
 
 }
 
-Pkt4Ptr
-PktFilterLPF::receive(Iface& iface, const SocketInfo& socket_info) {
+void
+PktFilterLPF::drainFallbackSocket(const SocketInfo& socket_info) const {
     uint8_t raw_buf[IfaceMgr::RCVBUFSIZE];
-    // First let's get some data from the fallback socket. The data will be
+    // Get some data from the fallback socket. The data will be
     // discarded but we don't want the socket buffer to bloat. We get the
     // packets from the socket in loop but most of the time the loop will
     // end after receiving one packet. The call to recv returns immediately
@@ -221,20 +446,12 @@ PktFilterLPF::receive(Iface& iface, const SocketInfo& socket_info) {
     do {
         datalen = recv(socket_info.fallbackfd_, raw_buf, sizeof(raw_buf), 0);
     } while (datalen > 0);
+}
 
-    // Now that we finished getting data from the fallback socket, we
-    // have to get the data from the raw socket too.
-    int data_len = read(socket_info.sockfd_, raw_buf, sizeof(raw_buf));
-    // If negative value is returned by read(), it indicates that an
-    // error occured. If returned value is 0, no data was read from the
-    // socket. In both cases something has gone wrong, because we expect
-    // that a chunk of data is there. We signal the lack of data by
-    // returing an empty packet.
-    if (data_len <= 0) {
-        return Pkt4Ptr();
-    }
-
-    InputBuffer buf(raw_buf, data_len);
+Pkt4Ptr
+PktFilterLPF::decodeFrame(const Iface& iface, const uint8_t* data,
+                          const size_t len) const {
+    InputBuffer buf(data, len);
 
     // @todo: This is awkward way to solve the chicken and egg problem
     // whereby we don't know the offset where DHCP data start in the
@@ -254,12 +471,12 @@ PktFilterLPF::receive(Iface& iface, const SocketInfo& socket_info) {
     decodeEthernetHeader(buf, dummy_pkt);
     decodeIpUdpHeader(buf, dummy_pkt);
 
-    // Read the DHCP data.
-    std::vector<uint8_t> dhcp_buf;
-    buf.readVector(dhcp_buf, buf.getLength() - buf.getPosition());
+    // Decode DHCP data into the Pkt4 object. The data is read in place,
+    // so it is only copied into the packet.
+    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(data + buf.getPosition(),
+                                   buf.getLength() - buf.getPosition()));
 
-    // Decode DHCP data into the Pkt4 object.
-    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(&dhcp_buf[0], dhcp_buf.size()));
+    pkt->updateTimestamp();
 
     // Set the appropriate packet members using data collected from
     // the decoded headers.
@@ -275,11 +492,115 @@ PktFilterLPF::receive(Iface& iface, const SocketInfo& socket_info) {
     return (pkt);
 }
 
-int
-PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
+Pkt4Ptr
+PktFilterLPF::receiveFromRing(const Iface& iface, PacketRing& ring) const {
+    for (;;) {
+        if ((ring.rx_frame_ == NULL) && !ring.openBlock()) {
+            return (Pkt4Ptr());
+        }
+        if (ring.rx_frame_ == NULL) {
+            // The block was empty.
+            continue;
+        }
+
+        const struct tpacket3_hdr* hdr =
+            reinterpret_cast<const struct tpacket3_hdr*>(ring.rx_frame_);
+
+        // Skip the frames truncated by the kernel. They don't hold
+        // the whole DHCP message.
+        if (hdr->tp_snaplen < hdr->tp_len) {
+            ring.releaseFrame();
+            continue;
+        }
+
+        // The frame must be decoded before it is handed back to the kernel.
+        Pkt4Ptr pkt;
+        try {
+            pkt = decodeFrame(iface, ring.rx_frame_ + hdr->tp_mac,
+                              hdr->tp_snaplen);
+        } catch (...) {
+            ring.releaseFrame();
+            throw;
+        }
+        ring.releaseFrame();
+        return (pkt);
+    }
+}
 
-    OutputBuffer buf(14);
+Pkt4Ptr
+PktFilterLPF::receive(Iface& iface, const SocketInfo& socket_info) {
+    drainFallbackSocket(socket_info);
+
+    // Now that we finished getting data from the fallback socket, we
+    // have to get the data from the raw socket too.
+    uint8_t raw_buf[IfaceMgr::RCVBUFSIZE];
+    PacketRingPtr ring = getRing(socket_info.sockfd_);
+    int flags = 0;
+    if (ring) {
+        Pkt4Ptr pkt = receiveFromRing(iface, *ring);
+        if (!pkt) {
+            // The kernel hands over a partially filled block after the
+            // block timeout, so wait for it once.
+            struct pollfd fds;
+            memset(&fds, 0, sizeof(fds));
+            fds.fd = socket_info.sockfd_;
+            fds.events = POLLIN;
+            if (poll(&fds, 1, 2 * RX_RING_BLOCK_TIMEOUT) > 0) {
+                pkt = receiveFromRing(iface, *ring);
+            }
+        }
+        if (pkt) {
+            return (pkt);
+        }
+        // The frames received before the ring has been set up are
+        // queued on the socket.
+        flags = MSG_DONTWAIT;
+    }
+
+    int data_len = recv(socket_info.sockfd_, raw_buf, sizeof(raw_buf), flags);
+    // If negative value is returned by recv(), it indicates that an
+    // error occured. If returned value is 0, no data was read from the
+    // socket. In both cases something has gone wrong, because we expect
+    // that a chunk of data is there. We signal the lack of data by
+    // returing an empty packet.
+    if (data_len <= 0) {
+        return Pkt4Ptr();
+    }
+
+    return (decodeFrame(iface, raw_buf, data_len));
+}
+
+size_t
+PktFilterLPF::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                           Pkt4Collection& pkts, const size_t max_pkts) {
+    PacketRingPtr ring = getRing(socket_info.sockfd_);
+    if (!ring || (max_pkts <= 1)) {
+        return (PktFilter::receiveBatch(iface, socket_info, pkts, max_pkts));
+    }
+
+    drainFallbackSocket(socket_info);
+
+    size_t received = 0;
+    while (received < max_pkts) {
+        Pkt4Ptr pkt = receiveFromRing(iface, *ring);
+        if (!pkt) {
+            break;
+        }
+        pkts.push_back(pkt);
+        ++received;
+    }
 
+    // The socket may be readable because of the frames queued before
+    // the ring has been set up.
+    if (received == 0) {
+        return (PktFilter::receiveBatch(iface, socket_info, pkts, max_pkts));
+    }
+    return (received);
+}
+
+void
+PktFilterLPF::writeFrame(const Iface& iface, const Pkt4Ptr& pkt,
+                         OutputBuffer& buf) const {
     // Some interfaces may have no HW address - e.g. loopback interface.
     // For these interfaces the HW address length is 0. If this is the case,
     // then we will rely on the functions which construct the IP/UDP headers
@@ -302,6 +623,71 @@ PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
 
     // DHCPv4 message
     buf.writeData(pkt->getBuffer().getData(), pkt->getBuffer().getLength());
+}
+
+bool
+PktFilterLPF::writeToRing(const Iface& iface, PacketRing& ring,
+                          const Pkt4Ptr& pkt) const {
+#ifdef TPACKET3_HDRLEN
+    struct tpacket3_hdr* hdr = ring.getTxFrame(ring.tx_frame_);
+    if (hdr->tp_status != TP_STATUS_AVAILABLE) {
+        // The kernel hasn't sent the frame yet.
+        return (false);
+    }
+    // Don't write the frame before the kernel hands it over.
+    __sync_synchronize();
+
+    OutputBuffer buf(RING_FRAME_SIZE);
+    writeFrame(iface, pkt, buf);
+
+    // The kernel expects the frame data right after the header.
+    const size_t data_offset = TPACKET3_HDRLEN - sizeof(struct sockaddr_ll);
+    if (data_offset + buf.getLength() > RING_FRAME_SIZE) {
+        return (false);
+    }
+    memcpy(reinterpret_cast<uint8_t*>(hdr) + data_offset, buf.getData(),
+           buf.getLength());
+    hdr->tp_len = buf.getLength();
+    hdr->tp_next_offset = 0;
+
+    // Hand the frame over to the kernel when it has been written.
+    __sync_synchronize();
+    hdr->tp_status = TP_STATUS_SEND_REQUEST;
+    ring.tx_frame_ = (ring.tx_frame_ + 1) % ring.tx_frame_nr_;
+    return (true);
+#else
+    static_cast<void>(iface);
+    static_cast<void>(ring);
+    static_cast<void>(pkt);
+    return (false);
+#endif
+}
+
+void
+PktFilterLPF::flushRing(const Iface& iface, const int sockfd) const {
+    sockaddr_ll sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sll_family = AF_PACKET;
+    sa.sll_ifindex = iface.getIndex();
+    sa.sll_protocol = htons(ETH_P_IP);
+    sa.sll_halen = 6;
+
+    // Without the data, sendto() sends the frames written to the ring.
+    // It returns when all of them have been sent.
+    int result = sendto(sockfd, NULL, 0, 0,
+                        reinterpret_cast<const struct sockaddr*>(&sa),
+                        sizeof(sockaddr_ll));
+    if (result < 0) {
+        isc_throw(SocketWriteError, "failed to send DHCPv4 packet, errno="
+                  << errno << " (check errno.h)");
+    }
+}
+
+void
+PktFilterLPF::sendCopy(const Iface& iface, const int sockfd,
+                       const Pkt4Ptr& pkt) const {
+    OutputBuffer buf(14);
+    writeFrame(iface, pkt, buf);
 
     sockaddr_ll sa;
     sa.sll_family = AF_PACKET;
@@ -316,11 +702,91 @@ PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
         isc_throw(SocketWriteError, "failed to send DHCPv4 packet, errno="
                   << errno << " (check errno.h)");
     }
+}
+
+int
+PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
+    PacketRingPtr ring = getRing(sockfd);
+    if (ring && ring->tx_map_) {
+        Mutex::Locker locker(ring->tx_mutex_);
+        if (writeToRing(iface, *ring, pkt)) {
+            flushRing(iface, sockfd);
+            return (0);
+        }
+    }
 
+    // There is no transmit ring or no free frame in it.
+    sendCopy(iface, sockfd, pkt);
     return (0);
 
 }
 
+size_t
+PktFilterLPF::sendBatch(const Iface& iface, uint16_t sockfd,
+                        const Pkt4Collection& pkts,
+                        const PktSendErrorCallback& error_callback) {
+    PacketRingPtr ring = getRing(sockfd);
+    if (!ring || !ring->tx_map_) {
+        return (PktFilter::sendBatch(iface, sockfd, pkts, error_callback));
+    }
+
+    Mutex::Locker locker(ring->tx_mutex_);
+    size_t sent = 0;
+    std::string first_error;
+    // Packets written to the ring and not yet sent.
+    Pkt4Collection written;
+    for (Pkt4Collection::const_iterator pkt = pkts.begin(); pkt != pkts.end();
+         ++pkt) {
+        try {
+            if (writeToRing(iface, *ring, *pkt)) {
+                written.push_back(*pkt);
+                continue;
+            }
+            // The ring is full. Send the frames to free it and try again.
+            if (!written.empty()) {
+                sent += flushBatch(iface, sockfd, written, error_callback,
+                                   first_error);
+                if (writeToRing(iface, *ring, *pkt)) {
+                    written.push_back(*pkt);
+                    continue;
+                }
+            }
+            sendCopy(iface, sockfd, *pkt);
+            ++sent;
+        } catch (const std::exception& ex) {
+            reportSendError(error_callback, *pkt, ex.what(), first_error);
+        }
+    }
+    sent += flushBatch(iface, sockfd, written, error_callback, first_error);
+    if (!first_error.empty()) {
+        isc_throw(SocketWriteError, first_error);
+    }
+    return (sent);
+}
+
+size_t
+PktFilterLPF::flushBatch(const Iface& iface, const int sockfd,
+                         Pkt4Collection& written,
+                         const PktSendErrorCallback& error_callback,
+                         std::string& first_error) const {
+    if (written.empty()) {
+        return (0);
+    }
+    size_t sent = written.size();
+    try {
+        flushRing(iface, sockfd);
+    } catch (const std::exception& ex) {
+        // The kernel doesn't tell which frames have been sent, so report
+        // all of them.
+        for (Pkt4Collection::const_iterator pkt = written.begin();
+             pkt != written.end(); ++pkt) {
+            reportSendError(error_callback, *pkt, ex.what(), first_error);
+        }
+        sent = 0;
+    }
+    written.clear();
+    return (sent);
+}
 
 } // end of isc::dhcp namespace
 } // end of isc namespace
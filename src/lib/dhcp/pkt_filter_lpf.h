@@ -18,6 +18,10 @@
 #include <dhcp/pkt_filter.h>
 
 #include <util/buffer.h>
+#include <util/threads/sync.h>
+
+#include <boost/shared_ptr.hpp>
+#include <map>
 
 namespace isc {
 namespace dhcp {
@@ -28,9 +32,27 @@ namespace dhcp {
 /// sockets and Linux Packet Filtering. It is used by @c isc::dhcp::IfaceMgr
 /// to send DHCPv4 messages to the hosts which don't have an IPv4 address
 /// assigned yet.
+///
+/// The raw sockets may use the memory mapped ring buffers (PACKET_MMAP
+/// with TPACKET_V3) shared with the kernel. The received
+/// frames are decoded directly from the mapped blocks, without reading
+/// them into a separate buffer. The responses are written to the frames
+/// of the transmit ring. If the kernel doesn't support the rings, the
+/// frames are read and sent with the regular system calls.
 class PktFilterLPF : public PktFilter {
 public:
 
+    /// @brief Constructor.
+    ///
+    /// @param use_ring Indicates if the sockets should use the memory
+    /// mapped ring buffers.
+    PktFilterLPF(const bool use_ring = false);
+
+    /// @brief Destructor.
+    ///
+    /// Unmaps the ring buffers.
+    virtual ~PktFilterLPF();
+
     /// @brief Check if packet can be sent to the host without address directly.
     ///
     /// This class supports direct responses to the host without address.
@@ -75,6 +97,174 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt);
 
+    /// @brief Receive multiple packets over specified socket.
+    ///
+    /// If the socket uses the ring buffer, the packets held in the ready
+    /// blocks are received, up to the specified maximum. Otherwise, a
+    /// single packet is received.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param [out] pkts Collection to which the received packets are
+    /// appended.
+    /// @param max_pkts Maximum number of packets to receive.
+    ///
+    /// @return Number of packets appended to the collection.
+    virtual size_t receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                                Pkt4Collection& pkts, const size_t max_pkts);
+
+    /// @brief Send multiple packets over specified socket.
+    ///
+    /// If the socket uses the transmit ring, the packets are written to
+    /// the ring and sent with a single system call. Otherwise, they are
+    /// sent one by one. A packet which can't be sent is skipped and the
+    /// remaining packets are sent.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param pkts packets to be sent
+    /// @param error_callback callback invoked for each packet which
+    /// couldn't be sent.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent and no error callback is specified.
+    /// @return Number of packets sent.
+    virtual size_t sendBatch(const Iface& iface, uint16_t sockfd,
+                             const Pkt4Collection& pkts,
+                             const PktSendErrorCallback& error_callback =
+                             PktSendErrorCallback());
+
+    /// @brief Release the rings of the socket.
+    ///
+    /// The rings are unmapped when the last packet being sent or received
+    /// through them has been processed.
+    ///
+    /// @param socket_info structure holding socket information
+    virtual void releaseSocket(const SocketInfo& socket_info);
+
+    /// @brief Checks if the socket uses the receive ring buffer.
+    ///
+    /// @param sockfd socket descriptor
+    ///
+    /// @return true if the socket has been opened by this object and the
+    /// receive ring buffer has been set up for it.
+    bool hasRing(const int sockfd) const;
+
+private:
+
+    /// @brief Memory mapped receive and transmit rings of a socket.
+    struct PacketRing;
+
+    /// @brief Pointer to the @c PacketRing.
+    typedef boost::shared_ptr<PacketRing> PacketRingPtr;
+
+    /// @brief Sets up the rings for the socket.
+    ///
+    /// @param sock socket descriptor
+    ///
+    /// @return Pointer to the rings or NULL if the kernel doesn't support
+    /// the rings.
+    static PacketRingPtr createRing(const int sock);
+
+    /// @brief Returns the rings of the socket.
+    ///
+    /// @param sockfd socket descriptor
+    ///
+    /// @return Pointer to the rings or NULL if the socket doesn't use them.
+    PacketRingPtr getRing(const int sockfd) const;
+
+    /// @brief Discards the data received over the fallback socket.
+    ///
+    /// @param socket_info structure holding socket information
+    void drainFallbackSocket(const SocketInfo& socket_info) const;
+
+    /// @brief Decodes the frame holding the DHCPv4 packet.
+    ///
+    /// @param iface interface over which the frame has been received.
+    /// @param data Frame data, starting with the Ethernet header.
+    /// @param len Length of the frame data.
+    ///
+    /// @return Received packet.
+    Pkt4Ptr decodeFrame(const Iface& iface, const uint8_t* data,
+                        const size_t len) const;
+
+    /// @brief Writes the Ethernet frame holding the packet.
+    ///
+    /// @param iface interface to be used to send packet
+    /// @param pkt packet to be sent
+    /// @param [out] buf Buffer to which the frame is written.
+    void writeFrame(const Iface& iface, const Pkt4Ptr& pkt,
+                    isc::util::OutputBuffer& buf) const;
+
+    /// @brief Receives a packet held in the receive ring.
+    ///
+    /// @param iface interface
+    /// @param ring rings of the socket
+    ///
+    /// @return Received packet or NULL if there is no ready block.
+    Pkt4Ptr receiveFromRing(const Iface& iface, PacketRing& ring) const;
+
+    /// @brief Writes a frame with the packet to the transmit ring.
+    ///
+    /// The caller must hold the mutex of the ring.
+    ///
+    /// @param iface interface to be used to send packet
+    /// @param ring rings of the socket
+    /// @param pkt packet to be sent
+    ///
+    /// @return false if there is no free frame large enough for the packet.
+    bool writeToRing(const Iface& iface, PacketRing& ring,
+                     const Pkt4Ptr& pkt) const;
+
+    /// @brief Sends the frames written to the transmit ring.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    ///
+    /// @throw isc::dhcp::SocketWriteError if sending the frames failed.
+    void flushRing(const Iface& iface, const int sockfd) const;
+
+    /// @brief Sends the frames of a batch written to the transmit ring.
+    ///
+    /// If the frames can't be sent, all packets written to the ring are
+    /// reported as not sent.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param [in,out] written packets written to the ring, cleared on
+    /// return.
+    /// @param error_callback callback passed to @c sendBatch.
+    /// @param [out] first_error first error reported without a callback.
+    ///
+    /// @return Number of packets sent.
+    size_t flushBatch(const Iface& iface, const int sockfd,
+                      Pkt4Collection& written,
+                      const PktSendErrorCallback& error_callback,
+                      std::string& first_error) const;
+
+    /// @brief Sends the packet with sendto().
+    ///
+    /// @param iface interface to be used to send packet
+    /// @param sockfd socket descriptor
+    /// @param pkt packet to be sent
+    ///
+    /// @throw isc::dhcp::SocketWriteError if sending the packet failed.
+    void sendCopy(const Iface& iface, const int sockfd,
+                  const Pkt4Ptr& pkt) const;
+
+    /// @brief Indicates if the sockets use the ring buffers.
+    bool use_ring_;
+
+    /// @brief Rings of the open sockets, by socket descriptor.
+    ///
+    /// The sockets are closed by the @c IfaceMgr, so the rings are kept
+    /// until the descriptor is reused or this object is destroyed.
+    std::map<int, PacketRingPtr> rings_;
+
+    /// @brief Mutex protecting the map of the rings.
+    ///
+    /// The packets may be sent by multiple threads.
+    mutable isc::util::thread::Mutex rings_mutex_;
 };
 
 } // namespace isc::dhcp
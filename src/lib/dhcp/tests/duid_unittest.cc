@@ -18,6 +18,7 @@
 #include <dhcp/duid.h>
 #include <exceptions/exceptions.h>
 
+#include <boost/functional/hash.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 
@@ -186,6 +187,28 @@ TEST(DuidTest, operators) {
     EXPECT_TRUE(*duid1 != *duid3);
 }
 
+// This test checks that the DUIDs holding the same value have the same
+// hash, which is the hash of the DUID bytes.
+TEST(DuidTest, hash) {
+    uint8_t data1[] = {0, 1, 2, 3, 4, 5, 6};
+    uint8_t data2[] = {0, 1, 2, 3, 4, 5, 7};
+    std::vector<uint8_t> data1_vec(data1, data1 + sizeof(data1));
+
+    DUID duid1(data1, sizeof(data1));
+    DUID duid2(data2, sizeof(data2));
+    DUID duid3(data1_vec);
+    ClientId client_id(data1, sizeof(data1));
+
+    EXPECT_EQ(boost::hash_range(data1, data1 + sizeof(data1)), duid1.getHash());
+    EXPECT_EQ(duid1.getHash(), duid3.getHash());
+    EXPECT_EQ(duid1.getHash(), client_id.getHash());
+    EXPECT_NE(duid1.getHash(), duid2.getHash());
+
+    // The copy has the same hash.
+    DUID duid4(duid1);
+    EXPECT_EQ(duid1.getHash(), duid4.getHash());
+}
+
 // This test verifies if the ClientId constructors are working properly
 // and passed parameters are used
 TEST(ClientIdTest, constructor) {
@@ -132,7 +132,7 @@ public:
 
     /// Constructor
     TestPktFilter()
-        : open_socket_called_(false) {
+        : open_socket_called_(false), released_sockets_(0) {
     }
 
     virtual bool isDirectResponseSupported() const {
@@ -183,9 +183,17 @@ public:
         return (0);
     }
 
+    /// Records that the socket has been released.
+    virtual void releaseSocket(const SocketInfo&) {
+        ++released_sockets_;
+    }
+
     /// Holds the information whether openSocket was called on this
     /// object after its creation.
     bool open_socket_called_;
+
+    /// Number of the sockets released by the IfaceMgr.
+    int released_sockets_;
 };
 
 class NakedIfaceMgr: public IfaceMgr {
@@ -1244,6 +1252,112 @@ TEST_F(IfaceMgrTest, sendReceive4) {
     EXPECT_THROW(ifacemgr->send(sendPkt), SocketWriteError);
 }
 
+// Verifies that multiple DHCPv4 packets can be sent and received together.
+TEST_F(IfaceMgrTest, sendReceive4Batch) {
+
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    // let's assume that every supported OS have lo interface
+    IOAddress loAddr("127.0.0.1");
+    int socket1 = 0;
+    EXPECT_NO_THROW(
+        socket1 = ifacemgr->openSocket(LOOPBACK, loAddr, DHCP4_SERVER_PORT + 10000);
+    );
+
+    EXPECT_GE(socket1, 0);
+
+    // Create three packets with different transaction ids.
+    Pkt4Collection send_pkts;
+    for (uint32_t transid = 1234; transid < 1237; ++transid) {
+        Pkt4Ptr send_pkt(new Pkt4(DHCPDISCOVER, transid));
+        send_pkt->setLocalAddr(IOAddress("127.0.0.1"));
+        send_pkt->setLocalPort(DHCP4_SERVER_PORT + 10000 + 1);
+        send_pkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+        send_pkt->setRemoteAddr(IOAddress("127.0.0.1"));
+        send_pkt->setIndex(1);
+        send_pkt->setIface(string(LOOPBACK));
+        ASSERT_NO_THROW(send_pkt->pack());
+        send_pkts.push_back(send_pkt);
+    }
+
+    size_t sent = 0;
+    ASSERT_NO_THROW(sent = ifacemgr->sendBatch(send_pkts));
+    EXPECT_EQ(3, sent);
+
+    // The maximum number of packets must be positive.
+    Pkt4Collection rcv_pkts;
+    EXPECT_THROW(ifacemgr->receive4Batch(rcv_pkts, 0, 10), BadValue);
+
+    // Receive our own packets.
+    while (rcv_pkts.size() < send_pkts.size()) {
+        size_t received = 0;
+        ASSERT_NO_THROW(received = ifacemgr->receive4Batch(rcv_pkts, 10, 10));
+        ASSERT_GT(received, 0);
+    }
+    ASSERT_EQ(send_pkts.size(), rcv_pkts.size());
+
+    // The packets are received in the order in which they have been sent.
+    for (size_t i = 0; i < rcv_pkts.size(); ++i) {
+        ASSERT_NO_THROW(rcv_pkts[i]->unpack());
+        EXPECT_EQ(send_pkts[i]->getTransid(), rcv_pkts[i]->getTransid());
+        EXPECT_EQ("127.0.0.1", rcv_pkts[i]->getRemoteAddr().toText());
+        EXPECT_EQ(send_pkts[i]->getRemotePort(), rcv_pkts[i]->getLocalPort());
+    }
+
+    // Nothing more should be received.
+    rcv_pkts.clear();
+    EXPECT_EQ(0, ifacemgr->receive4Batch(rcv_pkts, 10, 0, 1000));
+    EXPECT_TRUE(rcv_pkts.empty());
+
+    close(socket1);
+}
+
+// Verifies that a packet of a batch which can't be sent doesn't prevent
+// sending the remaining packets.
+TEST_F(IfaceMgrTest, sendBatchInvalidIface) {
+
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    IOAddress loAddr("127.0.0.1");
+    int socket1 = 0;
+    EXPECT_NO_THROW(
+        socket1 = ifacemgr->openSocket(LOOPBACK, loAddr, DHCP4_SERVER_PORT + 10000);
+    );
+
+    EXPECT_GE(socket1, 0);
+
+    // The packet in the middle specifies an interface which doesn't exist.
+    Pkt4Collection send_pkts;
+    for (uint32_t transid = 1234; transid < 1237; ++transid) {
+        Pkt4Ptr send_pkt(new Pkt4(DHCPDISCOVER, transid));
+        send_pkt->setLocalAddr(IOAddress("127.0.0.1"));
+        send_pkt->setLocalPort(DHCP4_SERVER_PORT + 10000 + 1);
+        send_pkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+        send_pkt->setRemoteAddr(IOAddress("127.0.0.1"));
+        send_pkt->setIndex(1);
+        send_pkt->setIface(transid == 1235 ? "bogus0" : string(LOOPBACK));
+        ASSERT_NO_THROW(send_pkt->pack());
+        send_pkts.push_back(send_pkt);
+    }
+
+    // The error is thrown when the remaining packets have been sent.
+    EXPECT_THROW(ifacemgr->sendBatch(send_pkts), SocketWriteError);
+
+    Pkt4Collection rcv_pkts;
+    while (rcv_pkts.size() < 2) {
+        size_t received = 0;
+        ASSERT_NO_THROW(received = ifacemgr->receive4Batch(rcv_pkts, 10, 10));
+        ASSERT_GT(received, 0);
+    }
+    ASSERT_EQ(2, rcv_pkts.size());
+    ASSERT_NO_THROW(rcv_pkts[0]->unpack());
+    EXPECT_EQ(1234, rcv_pkts[0]->getTransid());
+    ASSERT_NO_THROW(rcv_pkts[1]->unpack());
+    EXPECT_EQ(1236, rcv_pkts[1]->getTransid());
+
+    close(socket1);
+}
+
 // Verifies that it is possible to set custom packet filter object
 // to handle sockets opening and send/receive operation.
 TEST_F(IfaceMgrTest, setPacketFilter) {
@@ -1281,7 +1395,9 @@ TEST_F(IfaceMgrTest, setPacketFilter) {
                  PacketFilterChangeDenied);
 
     // So, let's close the open IPv4 sockets and retry. Now it should succeed.
+    // The packet filter should release the socket before it is closed.
     iface_mgr->closeSockets(AF_INET);
+    EXPECT_EQ(1, custom_packet_filter->released_sockets_);
     EXPECT_NO_THROW(iface_mgr->setPacketFilter(custom_packet_filter));
 }
 
@@ -2626,6 +2742,53 @@ TEST_F(IfaceMgrTest, DeleteExternalSockets4) {
     close(secondpipe[0]);
 }
 
+// Tests that the external sockets added and deleted after the sockets
+// have been waited for are taken into account by receive4().
+TEST_F(IfaceMgrTest, ChangeExternalSockets4) {
+
+    callback_ok = false;
+    callback2_ok = false;
+
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    // Create first pipe and register it as extra socket
+    int pipefd[2];
+    EXPECT_TRUE(pipe(pipefd) == 0);
+    EXPECT_NO_THROW(ifacemgr->addExternalSocket(pipefd[0], my_callback));
+
+    // Wait for the data, so as the socket is registered.
+    Pkt4Ptr pkt4;
+    ASSERT_NO_THROW(pkt4 = ifacemgr->receive4(0, 1000));
+    EXPECT_FALSE(callback_ok);
+
+    // Register the second pipe and send some data over it.
+    int secondpipe[2];
+    EXPECT_TRUE(pipe(secondpipe) == 0);
+    EXPECT_NO_THROW(ifacemgr->addExternalSocket(secondpipe[0], my_callback2));
+    EXPECT_EQ(38, write(secondpipe[1], "Hi, this is a message sent over a pipe", 38));
+
+    // The second callback should be called.
+    ASSERT_NO_THROW(pkt4 = ifacemgr->receive4(1));
+    EXPECT_FALSE(pkt4);
+    EXPECT_FALSE(callback_ok);
+    EXPECT_TRUE(callback2_ok);
+
+    // Delete the second pipe. The data which hasn't been read should be
+    // ignored now.
+    callback2_ok = false;
+    EXPECT_NO_THROW(ifacemgr->deleteExternalSocket(secondpipe[0]));
+    ASSERT_NO_THROW(pkt4 = ifacemgr->receive4(0, 1000));
+    EXPECT_FALSE(callback_ok);
+    EXPECT_FALSE(callback2_ok);
+
+    // close both pipe ends
+    close(pipefd[1]);
+    close(pipefd[0]);
+
+    close(secondpipe[1]);
+    close(secondpipe[0]);
+}
+
 
 // Tests if a single external socket and its callback can be passed and
 // it is supported properly by receive6() method.
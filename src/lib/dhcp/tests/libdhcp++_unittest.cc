@@ -640,6 +640,93 @@ TEST_F(LibDhcpTest, unpackOptions4) {
 
 }
 
+// This test verifies that the locations of the DHCPv4 options are recorded
+// in the index.
+TEST_F(LibDhcpTest, indexOptions4) {
+    // Add some padding before the options and the end option followed by
+    // the garbage after them.
+    vector<uint8_t> v4packed(3, DHO_PAD);
+    v4packed.insert(v4packed.end(), v4_opts, v4_opts + sizeof(v4_opts));
+    v4packed.push_back(DHO_END);
+    v4packed.push_back(1);
+
+    OptionIndex index;
+    size_t offset = 0;
+    ASSERT_NO_THROW(offset = LibDHCP::indexOptions4(v4packed, 1, index));
+    EXPECT_EQ(v4packed.size() - 1, offset);
+
+    // The options are sorted by the code.
+    const uint16_t expected[][3] = {
+        // code, offset, length
+        { 12, 3, 5 },
+        { 14, 13, 5 },
+        { 60, 8, 5 },
+        { DHO_DHCP_AGENT_OPTIONS, 28, 27 },
+        { 128, 23, 5 },
+        { 254, 18, 5 }
+    };
+    ASSERT_EQ(sizeof(expected) / sizeof(expected[0]), index.size());
+    const OptionIndex::Entry* entry = index.begin();
+    for (size_t i = 0; i < index.size(); ++i, ++entry) {
+        EXPECT_EQ(expected[i][0], entry->code_);
+        EXPECT_EQ(expected[i][1], entry->offset_);
+        EXPECT_EQ(expected[i][2], entry->length_);
+    }
+
+    // The truncated option is not indexed.
+    v4packed.resize(v4packed.size() - 3);
+    index.clear();
+    ASSERT_NO_THROW(offset = LibDHCP::indexOptions4(v4packed, 1, index));
+    EXPECT_EQ(28, offset);
+    EXPECT_EQ(5, index.size());
+
+    // The truncated option header is an error, as for unpackOptions4.
+    v4packed.resize(29);
+    EXPECT_THROW(LibDHCP::indexOptions4(v4packed, 1, index), OutOfRange);
+}
+
+// This test verifies that the locations of the DHCPv6 options are recorded
+// in the index.
+TEST_F(LibDhcpTest, indexOptions6) {
+    // The options are preceded by the DHCPv6 header.
+    OptionBuffer buf(4, 0);
+    buf.insert(buf.end(), v6packed, v6packed + sizeof(v6packed));
+    // Add an option of the same code as the first one.
+    const uint8_t clientid[] = { 0, 1, 0, 1, 1 };
+    buf.insert(buf.end(), clientid, clientid + sizeof(clientid));
+
+    OptionIndex index;
+    size_t offset = 0;
+    ASSERT_NO_THROW(offset = LibDHCP::indexOptions6(buf, 4, buf.size(),
+                                                    index));
+    EXPECT_EQ(buf.size(), offset);
+
+    const uint16_t expected[][3] = {
+        // code, offset, length
+        { D6O_CLIENTID, 4, 9 },
+        { D6O_CLIENTID, sizeof(v6packed) + 4, 5 },
+        { D6O_SERVERID, 13, 7 },
+        { D6O_ORO, 24, 8 },
+        { D6O_ELAPSED_TIME, 32, 6 },
+        { D6O_RAPID_COMMIT, 20, 4 },
+        { D6O_VENDOR_OPTS, 38, 26 }
+    };
+    ASSERT_EQ(sizeof(expected) / sizeof(expected[0]), index.size());
+    const OptionIndex::Entry* entry = index.begin();
+    for (size_t i = 0; i < index.size(); ++i, ++entry) {
+        EXPECT_EQ(expected[i][0], entry->code_);
+        EXPECT_EQ(expected[i][1], entry->offset_);
+        EXPECT_EQ(expected[i][2], entry->length_);
+    }
+
+    // The options beyond the end are not indexed and the truncated option
+    // is ignored.
+    index.clear();
+    ASSERT_NO_THROW(offset = LibDHCP::indexOptions6(buf, 4, 37, index));
+    EXPECT_EQ(32, offset);
+    EXPECT_EQ(4, index.size());
+}
+
 TEST_F(LibDhcpTest, isStandardOption4) {
     // Get all option codes that are not occupied by standard options.
     const uint16_t unassigned_codes[] = { 84, 96, 102, 103, 104, 105, 106, 107, 108,
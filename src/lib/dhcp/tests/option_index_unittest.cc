@@ -0,0 +1,137 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <dhcp/option_index.h>
+
+#include <gtest/gtest.h>
+
+using namespace isc::dhcp;
+
+namespace {
+
+// This test verifies that the entries are sorted by the option code and
+// the entries for the same code are kept in the order they are added.
+TEST(OptionIndexTest, add) {
+    OptionIndex index;
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(0, index.size());
+    EXPECT_TRUE(index.begin() == index.end());
+
+    index.add(53, 0, 3);
+    index.add(12, 3, 5);
+    index.add(53, 8, 3);
+    index.add(1, 11, 6);
+
+    ASSERT_EQ(4, index.size());
+    EXPECT_FALSE(index.empty());
+    const OptionIndex::Entry* entry = index.begin();
+    EXPECT_EQ(1, entry->code_);
+    EXPECT_EQ(11, entry->offset_);
+    EXPECT_EQ(6, entry->length_);
+    ++entry;
+    EXPECT_EQ(12, entry->code_);
+    EXPECT_EQ(3, entry->offset_);
+    ++entry;
+    EXPECT_EQ(53, entry->code_);
+    EXPECT_EQ(0, entry->offset_);
+    ++entry;
+    EXPECT_EQ(53, entry->code_);
+    EXPECT_EQ(8, entry->offset_);
+    ++entry;
+    EXPECT_TRUE(entry == index.end());
+}
+
+// This test verifies that the entries can be found and removed.
+TEST(OptionIndexTest, findErase) {
+    OptionIndex index;
+    index.add(12, 0, 5);
+    index.add(53, 5, 3);
+    index.add(53, 8, 3);
+    index.add(61, 11, 9);
+
+    OptionIndex::EntryRange range = index.find(53);
+    ASSERT_EQ(2, range.second - range.first);
+    EXPECT_EQ(5, range.first->offset_);
+    EXPECT_EQ(8, (range.first + 1)->offset_);
+
+    range = index.find(54);
+    EXPECT_TRUE(range.first == range.second);
+
+    index.erase(53);
+    EXPECT_EQ(2, index.size());
+    range = index.find(53);
+    EXPECT_TRUE(range.first == range.second);
+    range = index.find(61);
+    ASSERT_EQ(1, range.second - range.first);
+    EXPECT_EQ(11, range.first->offset_);
+
+    // Removing the missing option does nothing.
+    index.erase(53);
+    EXPECT_EQ(2, index.size());
+
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    range = index.find(12);
+    EXPECT_TRUE(range.first == range.second);
+}
+
+// This test verifies that the index holds more entries than fit within
+// the object, and that it may be copied.
+TEST(OptionIndexTest, overflow) {
+    OptionIndex index;
+    const size_t count = 3 * OptionIndex::INLINE_ENTRIES;
+    for (size_t i = 0; i < count; ++i) {
+        // Add the codes in the descending order.
+        index.add(count - i, i, 4);
+    }
+    ASSERT_EQ(count, index.size());
+
+    uint16_t code = 1;
+    for (const OptionIndex::Entry* entry = index.begin();
+         entry != index.end(); ++entry, ++code) {
+        EXPECT_EQ(code, entry->code_);
+        EXPECT_EQ(count - code, entry->offset_);
+    }
+
+    // Remove the entries, so as they would fit within the object, and
+    // add them back.
+    for (size_t i = 1; i <= count / 2; ++i) {
+        index.erase(i);
+    }
+    ASSERT_EQ(count - count / 2, index.size());
+    for (size_t i = 1; i <= count / 2; ++i) {
+        index.add(i, count - i, 4);
+    }
+    ASSERT_EQ(count, index.size());
+
+    OptionIndex copy(index);
+    index.clear();
+    ASSERT_EQ(count, copy.size());
+    code = 1;
+    for (const OptionIndex::Entry* entry = copy.begin();
+         entry != copy.end(); ++entry, ++code) {
+        EXPECT_EQ(code, entry->code_);
+        EXPECT_EQ(count - code, entry->offset_);
+    }
+
+    // The cleared index may be used again.
+    EXPECT_TRUE(index.empty());
+    index.add(1, 0, 4);
+    ASSERT_EQ(1, index.size());
+    EXPECT_EQ(1, index.begin()->code_);
+}
+
+}
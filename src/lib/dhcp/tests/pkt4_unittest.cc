@@ -626,6 +626,69 @@ TEST_F(Pkt4Test, options) {
     EXPECT_NO_THROW(pkt.reset());
 }
 
+// This test verifies that the options added with their wire format are
+// packed by copying the wire data.
+TEST_F(Pkt4Test, packedOptions) {
+    Pkt4 pkt(DHCPOFFER, 0);
+
+    OptionPtr opt1(new Option(Option::V4, 12, OptionBuffer(2, 0x01)));
+    OptionPtr opt2(new Option(Option::V4, 14, OptionBuffer(2, 0x02)));
+
+    // The wire data differs from the option data, so it can be told
+    // which one has been used.
+    OptionBufferPtr wire1(new OptionBuffer(4, 0x10));
+    (*wire1)[0] = 12;
+    (*wire1)[1] = 2;
+    ASSERT_NO_THROW(pkt.addPackedOption(opt1, wire1));
+    // An option without the wire data is packed as usual.
+    ASSERT_NO_THROW(pkt.addPackedOption(opt2, OptionBufferPtr()));
+    EXPECT_TRUE(pkt.getOption(12) == opt1);
+    EXPECT_TRUE(pkt.getOption(14) == opt2);
+
+    // The packed options are unique, the same as other options.
+    EXPECT_THROW(pkt.addPackedOption(opt1, wire1), BadValue);
+
+    ASSERT_NO_THROW(pkt.pack());
+    const OutputBuffer& buf = pkt.getBuffer();
+    ASSERT_EQ(static_cast<size_t>(Pkt4::DHCPV4_PKT_HDR_LEN) +
+              sizeof(DHCP_OPTIONS_COOKIE) + 12, buf.getLength());
+    const uint8_t* ptr = static_cast<const uint8_t*>(buf.getData()) +
+        Pkt4::DHCPV4_PKT_HDR_LEN + sizeof(DHCP_OPTIONS_COOKIE);
+    const uint8_t expected[] = {
+        12, 2, 0x10, 0x10,
+        14, 2, 0x02, 0x02,
+        DHO_DHCP_MESSAGE_TYPE, 1, DHCPOFFER,
+        DHO_END
+    };
+    EXPECT_EQ(0, memcmp(ptr, expected, sizeof(expected)));
+
+    // When the option is replaced, the new option is packed.
+    ASSERT_TRUE(pkt.delOption(12));
+    ASSERT_NO_THROW(pkt.addOption(OptionPtr(new Option(Option::V4, 12,
+                                                       OptionBuffer(2, 0x03)))));
+    ASSERT_NO_THROW(pkt.pack());
+    ptr = static_cast<const uint8_t*>(pkt.getBuffer().getData()) +
+        Pkt4::DHCPV4_PKT_HDR_LEN + sizeof(DHCP_OPTIONS_COOKIE);
+    EXPECT_EQ(0x03, ptr[2]);
+    EXPECT_EQ(0x03, ptr[3]);
+
+    // When the wire data is discarded, the option modified in place
+    // is packed.
+    OptionBufferPtr wire2(new OptionBuffer(4, 0x02));
+    (*wire2)[0] = 14;
+    ASSERT_TRUE(pkt.delOption(14));
+    ASSERT_NO_THROW(pkt.addPackedOption(opt2, wire2));
+    const OptionBuffer data(2, 0x04);
+    opt2->setData(data.begin(), data.end());
+    pkt.clearPackedOptions();
+    ASSERT_NO_THROW(pkt.pack());
+    ptr = static_cast<const uint8_t*>(pkt.getBuffer().getData()) +
+        Pkt4::DHCPV4_PKT_HDR_LEN + sizeof(DHCP_OPTIONS_COOKIE) + 4;
+    EXPECT_EQ(14, ptr[0]);
+    EXPECT_EQ(0x04, ptr[2]);
+    EXPECT_EQ(0x04, ptr[3]);
+}
+
 // This test verifies that the options are unpacked from the packet correctly.
 TEST_F(Pkt4Test, unpackOptions) {
 
@@ -693,6 +756,133 @@ TEST_F(Pkt4Test, unpackOptionsWithCallback) {
 
 }
 
+// This test verifies that the options are created when retrieved if the
+// lazy unpacking is enabled.
+TEST_F(Pkt4Test, unpackOptionsLazy) {
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+
+    expectedFormat.push_back(0x63);
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+
+    for (int i = 0; i < sizeof(v4_opts); i++) {
+        expectedFormat.push_back(v4_opts[i]);
+    }
+
+    boost::shared_ptr<Pkt4> pkt(new Pkt4(&expectedFormat[0],
+                                expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    EXPECT_TRUE(pkt->getLazyUnpack());
+
+    CustomUnpackCallback cb;
+    pkt->setCallback(boost::bind(&CustomUnpackCallback::execute, &cb,
+                                 _1, _2, _3));
+
+    ASSERT_NO_THROW(pkt->unpack());
+
+    // Only the message type option has been created when the packet
+    // was checked.
+    EXPECT_TRUE(cb.executed_);
+    ASSERT_EQ(1, pkt->options_.size());
+    EXPECT_EQ(DHO_DHCP_MESSAGE_TYPE, pkt->options_.begin()->first);
+
+    // The other options are created with the callback when retrieved.
+    cb.executed_ = false;
+    EXPECT_TRUE(pkt->getOption(12));
+    EXPECT_TRUE(cb.executed_);
+    EXPECT_EQ(2, pkt->options_.size());
+    EXPECT_FALSE(pkt->getOption(13));
+    EXPECT_EQ(2, pkt->options_.size());
+
+    // The option can't be added when it has been received, even if it
+    // hasn't been retrieved yet.
+    EXPECT_THROW(pkt->addOption(OptionPtr(new Option(Option::V4, 60))),
+                 BadValue);
+
+    verifyParsedOptions(pkt);
+    EXPECT_EQ(6, pkt->options_.size());
+
+    // The option can be deleted before it is retrieved.
+    pkt.reset(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+    EXPECT_TRUE(pkt->delOption(128));
+    EXPECT_FALSE(pkt->getOption(128));
+}
+
+// This test verifies that the lazily unpacked packet is packed the same
+// as the packet unpacked at once.
+TEST_F(Pkt4Test, packLazy) {
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+
+    expectedFormat.push_back(0x63);
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+
+    for (int i = 0; i < sizeof(v4_opts); i++) {
+        expectedFormat.push_back(v4_opts[i]);
+    }
+    expectedFormat.push_back(DHO_END);
+
+    Pkt4 pkt(&expectedFormat[0], expectedFormat.size());
+    pkt.setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt.unpack());
+    ASSERT_EQ(1, pkt.options_.size());
+
+    // The length includes all options.
+    EXPECT_EQ(expectedFormat.size() - sizeof(DHCP_OPTIONS_COOKIE) - 1,
+              pkt.len());
+    EXPECT_EQ(6, pkt.options_.size());
+
+    // The options which haven't been retrieved are packed too.
+    Pkt4 lazy_pkt(&expectedFormat[0], expectedFormat.size());
+    lazy_pkt.setLazyUnpack(true);
+    ASSERT_NO_THROW(lazy_pkt.unpack());
+    ASSERT_NO_THROW(lazy_pkt.pack());
+    const OutputBuffer& buf = lazy_pkt.getBuffer();
+    ASSERT_EQ(expectedFormat.size(), buf.getLength());
+    EXPECT_EQ(0, memcmp(&expectedFormat[0], buf.getData(), buf.getLength()));
+}
+
+// This test verifies that the malformed option is reported when it is
+// retrieved if the lazy unpacking is enabled.
+TEST_F(Pkt4Test, unpackMalformedOptionLazy) {
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+
+    expectedFormat.push_back(0x63);
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+
+    // Message type and the subnet mask option, which should be 4 bytes
+    // long.
+    const uint8_t opts[] = {
+        53, 1, 1,
+        1, 2, 255, 255
+    };
+    expectedFormat.insert(expectedFormat.end(), opts, opts + sizeof(opts));
+
+    Pkt4 pkt(&expectedFormat[0], expectedFormat.size());
+    EXPECT_THROW(pkt.unpack(), InvalidOptionValue);
+
+    Pkt4 lazy_pkt(&expectedFormat[0], expectedFormat.size());
+    lazy_pkt.setLazyUnpack(true);
+    ASSERT_NO_THROW(lazy_pkt.unpack());
+    EXPECT_EQ(DHCPDISCOVER, lazy_pkt.getType());
+
+    // The error is reported each time the option is retrieved.
+    EXPECT_THROW(lazy_pkt.getOption(DHO_SUBNET_MASK), InvalidOptionValue);
+    EXPECT_THROW(lazy_pkt.getOption(DHO_SUBNET_MASK), InvalidOptionValue);
+    EXPECT_EQ(1, lazy_pkt.options_.size());
+
+    // The malformed option doesn't prevent printing the packet.
+    std::string text;
+    ASSERT_NO_THROW(text = lazy_pkt.toText());
+    EXPECT_NE(std::string::npos, text.find("malformed options"));
+}
+
 // This test verifies methods that are used for manipulating meta fields
 // i.e. fields that are not part of DHCPv4 (e.g. interface name).
 TEST_F(Pkt4Test, metaFields) {
@@ -735,6 +925,28 @@ TEST_F(Pkt4Test, Timestamp) {
     EXPECT_TRUE(ts_period.length().total_microseconds() >= 0);
 }
 
+// Checks that the processing stage times are recorded only when enabled.
+TEST_F(Pkt4Test, stageTimes) {
+    scoped_ptr<Pkt4> pkt(new Pkt4(DHCPOFFER, 1234));
+
+    // The times are not recorded by default.
+    pkt->setStageTime(0);
+    EXPECT_TRUE(pkt->getStageTimes().empty());
+
+    pkt->enableStageTimes(3);
+    ASSERT_EQ(3, pkt->getStageTimes().size());
+    EXPECT_TRUE(pkt->getStageTimes()[1].is_not_a_date_time());
+
+    // Record the time of the second stage. The out of range stage is
+    // ignored.
+    pkt->setStageTime(1);
+    pkt->setStageTime(3);
+    ASSERT_EQ(3, pkt->getStageTimes().size());
+    EXPECT_TRUE(pkt->getStageTimes()[0].is_not_a_date_time());
+    EXPECT_FALSE(pkt->getStageTimes()[1].is_not_a_date_time());
+    EXPECT_TRUE(pkt->getStageTimes()[2].is_not_a_date_time());
+}
+
 TEST_F(Pkt4Test, hwaddr) {
     scoped_ptr<Pkt4> pkt(new Pkt4(DHCPOFFER, 1234));
     const uint8_t hw[] = { 2, 4, 6, 8, 10, 12 }; // MAC
@@ -421,6 +421,71 @@ TEST_F(Pkt6Test, packUnpackWithCallback) {
     EXPECT_FALSE(cb.executed_);
 }
 
+// This test verifies that the options are created when retrieved if the
+// lazy unpacking is enabled.
+TEST_F(Pkt6Test, unpackLazy) {
+    scoped_ptr<Pkt6> sol(capture1());
+    sol->setLazyUnpack(true);
+
+    CustomUnpackCallback cb;
+    sol->setCallback(boost::bind(&CustomUnpackCallback::execute, &cb,
+                                 _1, _2, _3, _4, _5));
+
+    ASSERT_NO_THROW(sol->unpack());
+    EXPECT_EQ(DHCPV6_SOLICIT, sol->getType());
+    EXPECT_FALSE(cb.executed_);
+    EXPECT_TRUE(sol->options_.empty());
+
+    // The option is created with the callback when it is retrieved.
+    OptionPtr opt = sol->getOption(D6O_IA_NA);
+    ASSERT_TRUE(opt);
+    EXPECT_TRUE(cb.executed_);
+    EXPECT_TRUE(boost::dynamic_pointer_cast<Option6IA>(opt));
+    EXPECT_EQ(1, sol->options_.size());
+    EXPECT_EQ(1, sol->getOptions(D6O_IA_NA).size());
+    EXPECT_TRUE(sol->getOption(D6O_CLIENTID));
+    EXPECT_FALSE(sol->getOption(D6O_SERVERID));
+    EXPECT_EQ(2, sol->options_.size());
+
+    // The length includes all options.
+    EXPECT_EQ(98, sol->len());
+    EXPECT_EQ(5, sol->options_.size());
+
+    // The lazily unpacked packet is the same as the packet unpacked at once.
+    scoped_ptr<Pkt6> lazy_sol(capture1());
+    lazy_sol->setLazyUnpack(true);
+    ASSERT_NO_THROW(lazy_sol->unpack());
+    scoped_ptr<Pkt6> eager_sol(capture1());
+    ASSERT_NO_THROW(eager_sol->unpack());
+    EXPECT_EQ(eager_sol->toText(), lazy_sol->toText());
+}
+
+// This test verifies that the options of the relays are created at once,
+// when the lazy unpacking is enabled.
+TEST_F(Pkt6Test, relayUnpackLazy) {
+    boost::scoped_ptr<Pkt6> msg(capture2());
+    msg->setLazyUnpack(true);
+
+    ASSERT_NO_THROW(msg->unpack());
+    EXPECT_EQ(DHCPV6_SOLICIT, msg->getType());
+    ASSERT_EQ(2, msg->relay_info_.size());
+    EXPECT_EQ(2, msg->relay_info_[0].options_.size());
+    EXPECT_TRUE(msg->options_.empty());
+
+    EXPECT_TRUE(msg->getOption(D6O_CLIENTID));
+    EXPECT_EQ(1, msg->options_.size());
+
+    // The options which haven't been retrieved are packed too.
+    boost::scoped_ptr<Pkt6> eager_msg(capture2());
+    ASSERT_NO_THROW(eager_msg->unpack());
+    ASSERT_NO_THROW(eager_msg->pack());
+    ASSERT_NO_THROW(msg->pack());
+    ASSERT_EQ(eager_msg->getBuffer().getLength(), msg->getBuffer().getLength());
+    EXPECT_EQ(0, memcmp(eager_msg->getBuffer().getData(),
+                        msg->getBuffer().getData(),
+                        msg->getBuffer().getLength()));
+}
+
 // This test verifies that options can be added (addOption()), retrieved
 // (getOption(), getOptions()) and deleted (delOption()).
 TEST_F(Pkt6Test, addGetDelOptions) {
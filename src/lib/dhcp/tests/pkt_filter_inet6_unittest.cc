@@ -18,11 +18,15 @@
 #include <dhcp/pkt6.h>
 #include <dhcp/pkt_filter_inet6.h>
 #include <dhcp/tests/pkt_filter6_test_utils.h>
+#include <util/threads/thread.h>
 
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
 #include <gtest/gtest.h>
 
 using namespace isc::asiolink;
 using namespace isc::dhcp;
+using namespace isc::util::thread;
 
 namespace {
 
@@ -37,6 +41,20 @@ class PktFilterInet6Test : public isc::dhcp::test::PktFilter6Test {
 public:
     PktFilterInet6Test() : PktFilter6Test(PORT) {
     }
+
+    /// @brief Sends copies of the test message.
+    ///
+    /// @param pkt_filter Packet filter used to send the packets.
+    /// @param iface Interface over which the packets are sent.
+    /// @param num_pkts Number of packets to send.
+    void sendTestMessages(PktFilterInet6* pkt_filter, const Iface* iface,
+                          const int num_pkts) {
+        // Each thread sends its own copy of the packet.
+        Pkt6Ptr pkt(new Pkt6(*test_message_));
+        for (int i = 0; i < num_pkts; ++i) {
+            EXPECT_NO_THROW(pkt_filter->send(*iface, sock_info_.sockfd_, pkt));
+        }
+    }
 };
 
 // This test verifies that the INET6 datagram socket is correctly opened and
@@ -137,4 +155,92 @@ TEST_F(PktFilterInet6Test, receive) {
     testRcvdMessage(rcvd_pkt);
     }
 
+// This test verifies that the DHCPv6 packets queued on the socket are
+// received together, up to the specified maximum.
+TEST_F(PktFilterInet6Test, receiveBatch) {
+
+    // Packets will be received over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("::1");
+
+    // Create an instance of the class which we are testing.
+    PktFilterInet6 pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT + 1, true);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Send three DHCPv6 messages to the local loopback address and
+    // server's port.
+    for (int i = 0; i < 3; ++i) {
+        sendMessage();
+    }
+
+    // Receive at most two packets.
+    Pkt6Collection pkts;
+    ASSERT_NO_THROW(pkt_filter.receiveBatch(sock_info_, pkts, 2));
+#if defined (OS_LINUX)
+    ASSERT_EQ(2, pkts.size());
+#endif
+
+    // Receive the remaining packets.
+    while (pkts.size() < 3) {
+        size_t received = 0;
+        ASSERT_NO_THROW(received = pkt_filter.receiveBatch(sock_info_, pkts,
+                                                           10));
+        ASSERT_GT(received, 0);
+    }
+    ASSERT_EQ(3, pkts.size());
+
+    // Check if the received messages are correct.
+    for (Pkt6Collection::const_iterator pkt = pkts.begin(); pkt != pkts.end();
+         ++pkt) {
+        ASSERT_NO_THROW((*pkt)->unpack());
+        testRcvdMessage(*pkt);
+    }
+}
+
+// This test verifies that the packets may be sent by multiple threads
+// while they are received by another thread.
+TEST_F(PktFilterInet6Test, sendConcurrent) {
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("::1");
+
+    PktFilterInet6 pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, true);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    const int num_threads = 4;
+    const int num_pkts = 25;
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>(new Thread(
+            boost::bind(&PktFilterInet6Test::sendTestMessages, this,
+                        &pkt_filter, &iface, num_pkts))));
+    }
+
+    // Receive the packets while they are being sent. Each packet must
+    // carry the interface and the destination address it was sent to.
+    for (int i = 0; i < num_threads * num_pkts; ++i) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(sock_info_.sockfd_, &readfds);
+
+        struct timeval timeout;
+        timeout.tv_sec = 5;
+        timeout.tv_usec = 0;
+        ASSERT_GT(select(sock_info_.sockfd_ + 1, &readfds, NULL, NULL,
+                         &timeout), 0);
+
+        Pkt6Ptr rcvd_pkt = pkt_filter.receive(sock_info_);
+        ASSERT_TRUE(rcvd_pkt);
+        EXPECT_EQ(ifindex_, rcvd_pkt->getIndex());
+        EXPECT_EQ("::1", rcvd_pkt->getLocalAddr().toText());
+        ASSERT_NO_THROW(rcvd_pkt->unpack());
+        testRcvdMessage(rcvd_pkt);
+    }
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads[i]->wait();
+    }
+}
+
 } // anonymous namespace
@@ -18,13 +18,20 @@
 #include <dhcp/pkt4.h>
 #include <dhcp/pkt_filter_inet.h>
 #include <dhcp/tests/pkt_filter_test_utils.h>
+#include <util/threads/thread.h>
 
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 #include <sys/socket.h>
 
 using namespace isc::asiolink;
 using namespace isc::dhcp;
+using namespace isc::util::thread;
 
 namespace {
 
@@ -39,6 +46,58 @@ class PktFilterInetTest : public isc::dhcp::test::PktFilterTest {
 public:
     PktFilterInetTest() : PktFilterTest(PORT) {
     }
+
+    /// @brief Records a packet which couldn't be sent.
+    ///
+    /// @param pkt packet which couldn't be sent.
+    /// @param errmsg error message.
+    void sendError(const Pkt4Ptr& pkt, const std::string& errmsg) {
+        failed_pkts_.push_back(pkt);
+        EXPECT_FALSE(errmsg.empty());
+    }
+
+    /// @brief Receives the packets sent to the socket under test.
+    ///
+    /// @param num_pkts Number of packets to receive.
+    void receiveTestMessages(const int num_pkts) {
+        for (int i = 0; i < num_pkts; ++i) {
+            fd_set readfds;
+            FD_ZERO(&readfds);
+            FD_SET(sock_info_.sockfd_, &readfds);
+
+            struct timeval timeout;
+            timeout.tv_sec = 5;
+            timeout.tv_usec = 0;
+            int result = select(sock_info_.sockfd_ + 1, &readfds, NULL, NULL,
+                                &timeout);
+            ASSERT_GT(result, 0);
+
+            uint8_t rcv_buf[RECV_BUF_SIZE];
+            result = recv(sock_info_.sockfd_, rcv_buf, RECV_BUF_SIZE, 0);
+            ASSERT_GT(result, 0);
+
+            Pkt4Ptr rcvd_pkt(new Pkt4(rcv_buf, result));
+            ASSERT_NO_THROW(rcvd_pkt->unpack());
+            testRcvdMessage(rcvd_pkt);
+        }
+    }
+
+    /// @brief Sends copies of the test message.
+    ///
+    /// @param pkt_filter Packet filter used to send the packets.
+    /// @param iface Interface over which the packets are sent.
+    /// @param num_pkts Number of packets to send.
+    void sendTestMessages(PktFilterInet* pkt_filter, const Iface* iface,
+                          const int num_pkts) {
+        // Each thread sends its own copy of the packet.
+        Pkt4Ptr pkt(new Pkt4(*test_message_));
+        for (int i = 0; i < num_pkts; ++i) {
+            EXPECT_NO_THROW(pkt_filter->send(*iface, sock_info_.sockfd_, pkt));
+        }
+    }
+
+    /// Packets reported as not sent.
+    std::vector<Pkt4Ptr> failed_pkts_;
 };
 
 // This test verifies that the PktFilterInet class reports its lack
@@ -150,4 +209,158 @@ TEST_F(PktFilterInetTest, receive) {
     testRcvdMessage(rcvd_pkt);
 }
 
+// This test verifies that the DHCPv4 packets queued on the socket are
+// received together, up to the specified maximum.
+TEST_F(PktFilterInetTest, receiveBatch) {
+
+    // Packets will be received over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    // Create an instance of the class which we are testing.
+    PktFilterInet pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Send three DHCPv4 messages to the local loopback address and
+    // server's port.
+    for (int i = 0; i < 3; ++i) {
+        sendMessage();
+    }
+
+    // Receive at most two packets.
+    Pkt4Collection pkts;
+    ASSERT_NO_THROW(pkt_filter.receiveBatch(iface, sock_info_, pkts, 2));
+#if defined (OS_LINUX)
+    ASSERT_EQ(2, pkts.size());
+#endif
+
+    // Receive the remaining packets.
+    while (pkts.size() < 3) {
+        size_t received = 0;
+        ASSERT_NO_THROW(received = pkt_filter.receiveBatch(iface, sock_info_,
+                                                           pkts, 10));
+        ASSERT_GT(received, 0);
+    }
+    ASSERT_EQ(3, pkts.size());
+
+    // Check if the received messages are correct.
+    for (Pkt4Collection::const_iterator pkt = pkts.begin(); pkt != pkts.end();
+         ++pkt) {
+        ASSERT_NO_THROW((*pkt)->unpack());
+        testRcvdMessage(*pkt);
+    }
+}
+
+// This test verifies that multiple DHCPv4 packets are correctly sent
+// via INET datagram socket.
+TEST_F(PktFilterInetTest, sendBatch) {
+    // Packets will be sent over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    // Create an instance of the class which we are testing.
+    PktFilterInet pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    // Send the same packet three times.
+    Pkt4Collection pkts(3, test_message_);
+    size_t sent = 0;
+    ASSERT_NO_THROW(sent = pkt_filter.sendBatch(iface, sock_info_.sockfd_,
+                                                pkts));
+    EXPECT_EQ(3, sent);
+
+    // Read the packets from socket.
+    receiveTestMessages(3);
+}
+
+// This test verifies that a packet which can't be sent doesn't prevent
+// sending the remaining packets of the batch.
+TEST_F(PktFilterInetTest, sendBatchFailingDestination) {
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    PktFilterInet pkt_filter;
+    // The socket is not allowed to send to the broadcast address.
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    Pkt4Ptr bcast_message(new Pkt4(DHCPOFFER, 0));
+    bcast_message->setLocalAddr(IOAddress("127.0.0.1"));
+    bcast_message->setRemoteAddr(IOAddress("255.255.255.255"));
+    bcast_message->setRemotePort(PORT);
+    bcast_message->setLocalPort(PORT + 1);
+    bcast_message->setIndex(ifindex_);
+    bcast_message->setIface(ifname_);
+    ASSERT_NO_THROW(bcast_message->pack());
+
+    // The failing packet is in the middle of the batch.
+    Pkt4Collection pkts;
+    pkts.push_back(test_message_);
+    pkts.push_back(bcast_message);
+    pkts.push_back(test_message_);
+
+    PktSendErrorCallback callback =
+        boost::bind(&PktFilterInetTest::sendError, this, _1, _2);
+    size_t sent = 0;
+    ASSERT_NO_THROW(sent = pkt_filter.sendBatch(iface, sock_info_.sockfd_,
+                                                pkts, callback));
+    EXPECT_EQ(2, sent);
+    ASSERT_EQ(1, failed_pkts_.size());
+    EXPECT_TRUE(failed_pkts_[0] == bcast_message);
+    receiveTestMessages(2);
+
+    // Without the callback, the error is thrown when the remaining
+    // packets have been sent.
+    EXPECT_THROW(pkt_filter.sendBatch(iface, sock_info_.sockfd_, pkts),
+                 SocketWriteError);
+    receiveTestMessages(2);
+}
+
+// This test verifies that the packets may be sent by multiple threads
+// while they are received by another thread.
+TEST_F(PktFilterInetTest, sendConcurrent) {
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    PktFilterInet pkt_filter;
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+
+    const int num_threads = 4;
+    const int num_pkts = 25;
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>(new Thread(
+            boost::bind(&PktFilterInetTest::sendTestMessages, this,
+                        &pkt_filter, &iface, num_pkts))));
+    }
+
+    // Receive the packets while they are being sent. Each packet must
+    // carry the interface and the destination address it was sent to.
+    for (int i = 0; i < num_threads * num_pkts; ++i) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(sock_info_.sockfd_, &readfds);
+
+        struct timeval timeout;
+        timeout.tv_sec = 5;
+        timeout.tv_usec = 0;
+        ASSERT_GT(select(sock_info_.sockfd_ + 1, &readfds, NULL, NULL,
+                         &timeout), 0);
+
+        Pkt4Ptr rcvd_pkt = pkt_filter.receive(iface, sock_info_);
+        ASSERT_TRUE(rcvd_pkt);
+        EXPECT_EQ(ifindex_, rcvd_pkt->getIndex());
+        EXPECT_EQ("127.0.0.1", rcvd_pkt->getLocalAddr().toText());
+        ASSERT_NO_THROW(rcvd_pkt->unpack());
+        testRcvdMessage(rcvd_pkt);
+    }
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads[i]->wait();
+    }
+}
+
 } // anonymous namespace
@@ -189,6 +189,78 @@ TEST_F(PktFilterLPFTest, DISABLED_receive) {
     testRcvdMessage(rcvd_pkt);
 }
 
+// This test verifies that the DHCP packets are received from and sent
+// through the ring buffers of the raw socket.
+TEST_F(PktFilterLPFTest, DISABLED_sendReceiveRing) {
+
+    // Packets will be received over loopback interface.
+    Iface iface(ifname_, ifindex_);
+    IOAddress addr("127.0.0.1");
+
+    // Create an instance of the class which we are testing. It should
+    // use the ring buffers.
+    PktFilterLPF pkt_filter(true);
+    sock_info_ = pkt_filter.openSocket(iface, addr, PORT, false, false);
+    ASSERT_GE(sock_info_.sockfd_, 0);
+    ASSERT_TRUE(pkt_filter.hasRing(sock_info_.sockfd_));
+
+    // Send three DHCPv4 messages to the local loopback address and
+    // server's port.
+    for (int i = 0; i < 3; ++i) {
+        sendMessage();
+    }
+
+    // Receive the packets from the ring.
+    Pkt4Collection pkts;
+    while (pkts.size() < 3) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(sock_info_.sockfd_, &readfds);
+
+        struct timeval timeout;
+        timeout.tv_sec = 5;
+        timeout.tv_usec = 0;
+        ASSERT_GT(select(sock_info_.sockfd_ + 1, &readfds, NULL, NULL,
+                         &timeout), 0);
+        ASSERT_NO_THROW(pkt_filter.receiveBatch(iface, sock_info_, pkts,
+                                                3 - pkts.size()));
+    }
+    ASSERT_EQ(3, pkts.size());
+
+    // Check if the received messages are correct.
+    for (Pkt4Collection::const_iterator pkt = pkts.begin(); pkt != pkts.end();
+         ++pkt) {
+        ASSERT_NO_THROW((*pkt)->unpack());
+        testRcvdMessage(*pkt);
+    }
+
+    // Send two packets through the transmit ring. They are looped back
+    // to the socket.
+    Pkt4Collection send_pkts(2, test_message_);
+    size_t sent = 0;
+    ASSERT_NO_THROW(sent = pkt_filter.sendBatch(iface, sock_info_.sockfd_,
+                                                send_pkts));
+    EXPECT_EQ(2, sent);
+
+    pkts.clear();
+    while (pkts.size() < 2) {
+        Pkt4Ptr rcvd_pkt;
+        ASSERT_NO_THROW(rcvd_pkt = pkt_filter.receive(iface, sock_info_));
+        ASSERT_TRUE(rcvd_pkt);
+        pkts.push_back(rcvd_pkt);
+    }
+
+    for (Pkt4Collection::const_iterator pkt = pkts.begin(); pkt != pkts.end();
+         ++pkt) {
+        ASSERT_NO_THROW((*pkt)->unpack());
+        testRcvdMessage(*pkt);
+    }
+
+    // The rings are unmapped when the socket is released.
+    pkt_filter.releaseSocket(sock_info_);
+    EXPECT_FALSE(pkt_filter.hasRing(sock_info_.sockfd_));
+}
+
 // This test verifies that if the packet is received over the raw
 // socket and its destination address doesn't match the address
 // to which the socket is "bound", the packet is dropped.
@@ -302,5 +302,49 @@ uint64_t prefixesInRange(const uint8_t pool_len, const uint8_t delegated_len) {
     }
 }
 
+isc::asiolink::IOAddress
+offsetAddress(const isc::asiolink::IOAddress& addr, const uint64_t offset,
+              const uint8_t len) {
+    if (addr.isV4()) {
+        if ((len == 0) || (len > 32)) {
+            isc_throw(BadValue, "Invalid IPv4 prefix length " << len);
+        }
+        // The offset is truncated to 32 bits, because the IPv4 address
+        // space loops anyway.
+        uint32_t numeric = static_cast<uint32_t>(addr);
+        numeric += static_cast<uint32_t>(offset << (32 - len));
+        return (IOAddress(numeric));
+    }
+
+    if ((len == 0) || (len > 128)) {
+        isc_throw(BadValue, "Invalid IPv6 prefix length " << len);
+    }
+
+    // We don't have uint128, so we need to add the offset shifted by the
+    // number of bits beyond the prefix length to the address byte by byte,
+    // starting from the least significant byte.
+    uint8_t packed[V6ADDRESS_LEN];
+    const std::vector<uint8_t>& vec = addr.toBytes();
+    memcpy(packed, &vec[0], V6ADDRESS_LEN);
+
+    const int shift = 128 - len;
+    unsigned int carry = 0;
+    for (int i = V6ADDRESS_LEN - 1; i >= 0; --i) {
+        // Position of the least significant bit of this byte within the
+        // offset. It is negative if this byte holds the bits shifted out
+        // of the offset.
+        const int pos = (V6ADDRESS_LEN - 1 - i) * 8 - shift;
+        unsigned int part = 0;
+        if ((pos > -8) && (pos < 64)) {
+            part = (pos >= 0 ? (offset >> pos) : (offset << -pos)) & 0xff;
+        }
+        const unsigned int sum = packed[i] + part + carry;
+        packed[i] = static_cast<uint8_t>(sum & 0xff);
+        carry = sum >> 8;
+    }
+
+    return (IOAddress::fromBytes(AF_INET6, packed));
+}
+
 };
 };
@@ -83,6 +83,26 @@ uint64_t addrsInRange(const isc::asiolink::IOAddress& min,
 /// @param delegated_len length of the prefixes to be delegated from the pool
 /// @return number of prefixes in range
 uint64_t prefixesInRange(const uint8_t pool_len, const uint8_t delegated_len);
+
+/// @brief Returns an address or prefix increased by the specified number
+/// of prefixes.
+///
+/// Example: offsetAddress(2001:db8:1::, 3, 64) returns 2001:db8:1:3::.
+/// For addresses, the prefix length is 32 (IPv4) or 128 (IPv6), so
+/// offsetAddress(192.0.2.10, 5, 32) returns 192.0.2.15.
+///
+/// As in case of @c IOAddress::increase, the address space "loops", i.e.
+/// the result wraps around when it exceeds the largest address.
+///
+/// @throw BadValue if the prefix length is invalid for the address family.
+///
+/// @param addr address or prefix to be increased
+/// @param offset number of prefixes by which the address is increased
+/// @param len length of the prefixes
+/// @return increased address or prefix
+isc::asiolink::IOAddress offsetAddress(const isc::asiolink::IOAddress& addr,
+                                       const uint64_t offset,
+                                       const uint8_t len);
 };
 };
 
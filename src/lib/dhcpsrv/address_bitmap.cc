@@ -0,0 +1,152 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/address_bitmap.h>
+#include <exceptions/exceptions.h>
+
+#include <algorithm>
+
+using namespace isc::asiolink;
+
+namespace isc {
+namespace dhcp {
+
+const uint32_t AddressBitmap::WORD_BITS;
+
+AddressBitmap::AddressBitmap(const IOAddress& first, const IOAddress& last)
+    : first_(0), size_(0), words_(), free_count_(0), cursor_(0) {
+    if (!first.isV4() || !last.isV4()) {
+        isc_throw(BadValue, "address bitmap can only be created for the"
+                  " range of IPv4 addresses");
+    }
+    if (last < first) {
+        isc_throw(BadValue, "invalid address range " << first << " - "
+                  << last << " used to create the address bitmap");
+    }
+    first_ = static_cast<uint32_t>(first);
+    size_ = static_cast<uint64_t>(static_cast<uint32_t>(last)) - first_ + 1;
+    words_.resize((size_ + WORD_BITS - 1) / WORD_BITS);
+    clear();
+}
+
+IOAddress
+AddressBitmap::getFirstAddress() const {
+    return (IOAddress(first_));
+}
+
+IOAddress
+AddressBitmap::getLastAddress() const {
+    return (IOAddress(static_cast<uint32_t>(first_ + size_ - 1)));
+}
+
+bool
+AddressBitmap::inRange(const IOAddress& address) const {
+    return (address.isV4() && (static_cast<uint32_t>(address) >= first_) &&
+            (getOffset(address) < size_));
+}
+
+void
+AddressBitmap::markUsed(const IOAddress& address) {
+    if (!inRange(address)) {
+        return;
+    }
+    uint32_t offset = getOffset(address);
+    Word bit = static_cast<Word>(1) << (offset % WORD_BITS);
+    Word& word = words_[offset / WORD_BITS];
+    if ((word & bit) == 0) {
+        word |= bit;
+        --free_count_;
+    }
+}
+
+void
+AddressBitmap::markFree(const IOAddress& address) {
+    if (!inRange(address)) {
+        return;
+    }
+    uint32_t offset = getOffset(address);
+    Word bit = static_cast<Word>(1) << (offset % WORD_BITS);
+    Word& word = words_[offset / WORD_BITS];
+    if ((word & bit) != 0) {
+        word &= ~bit;
+        ++free_count_;
+    }
+}
+
+bool
+AddressBitmap::isFree(const IOAddress& address) const {
+    if (!inRange(address)) {
+        return (false);
+    }
+    uint32_t offset = getOffset(address);
+    Word bit = static_cast<Word>(1) << (offset % WORD_BITS);
+    return ((words_[offset / WORD_BITS] & bit) == 0);
+}
+
+void
+AddressBitmap::clear() {
+    std::fill(words_.begin(), words_.end(), static_cast<Word>(0));
+    // Mark the bits beyond the end of the range as used.
+    uint32_t tail = static_cast<uint32_t>(size_ % WORD_BITS);
+    if (tail != 0) {
+        words_.back() = ~static_cast<Word>(0) << tail;
+    }
+    free_count_ = size_;
+}
+
+bool
+AddressBitmap::findFreeInWord(const uint64_t offset, uint64_t& found) const {
+    // Ignore the bits preceding the offset by treating them as used.
+    Word free_bits = ~(words_[offset / WORD_BITS] |
+                       ((static_cast<Word>(1) << (offset % WORD_BITS)) - 1));
+    if (free_bits == 0) {
+        return (false);
+    }
+    uint64_t bit = 0;
+    while ((free_bits & (static_cast<Word>(1) << bit)) == 0) {
+        ++bit;
+    }
+    found = (offset / WORD_BITS) * WORD_BITS + bit;
+    return (true);
+}
+
+bool
+AddressBitmap::pickFree(IOAddress& address) {
+    if (free_count_ == 0) {
+        return (false);
+    }
+
+    uint64_t found = 0;
+    // Search from the cursor to the end of the range and then from
+    // the beginning of the range up to the word holding the cursor.
+    // The word holding the cursor is checked twice to find the free
+    // addresses preceding the cursor.
+    bool ok = findFreeInWord(cursor_, found);
+    const uint64_t words = words_.size();
+    const uint64_t start = cursor_ / WORD_BITS;
+    for (uint64_t i = 1; !ok && (i <= words); ++i) {
+        ok = findFreeInWord(((start + i) % words) * WORD_BITS, found);
+    }
+    if (!ok) {
+        // This should not happen because the free_count_ is non-zero.
+        return (false);
+    }
+
+    address = IOAddress(static_cast<uint32_t>(first_ + found));
+    cursor_ = (found + 1) % size_;
+    return (true);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
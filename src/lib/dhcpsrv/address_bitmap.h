@@ -0,0 +1,160 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef ADDRESS_BITMAP_H
+#define ADDRESS_BITMAP_H
+
+#include <asiolink/io_address.h>
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Bitmap of used and free addresses in a range of IPv4 addresses.
+///
+/// The bitmap holds one bit for each address in the range. The bit is set
+/// when the address is in use and cleared when the address is free. The
+/// bitmap is used by the allocation engine to find a free address without
+/// querying the lease database for each candidate address.
+///
+/// The bitmap also holds a cursor pointing to the address following the
+/// last address returned by @c pickFree. The search for a free address
+/// starts at the cursor, so as consecutive calls return consecutive free
+/// addresses (even if they are not marked as used in the meantime) and the
+/// addresses are handed out in the same order as by the iterative
+/// allocator. The free address is found by examining 64 addresses at a
+/// time, which makes the search fast even when the range is nearly full.
+///
+/// This class is not thread safe.
+class AddressBitmap {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Creates the bitmap with all addresses free.
+    ///
+    /// @param first First address in the range.
+    /// @param last Last address in the range.
+    ///
+    /// @throw BadValue if the addresses are not IPv4 addresses or if the
+    /// first address is greater than the last address.
+    AddressBitmap(const isc::asiolink::IOAddress& first,
+                  const isc::asiolink::IOAddress& last);
+
+    /// @brief Returns the first address in the range.
+    isc::asiolink::IOAddress getFirstAddress() const;
+
+    /// @brief Returns the last address in the range.
+    isc::asiolink::IOAddress getLastAddress() const;
+
+    /// @brief Checks if the address belongs to the range.
+    ///
+    /// @param address Address to be checked.
+    bool inRange(const isc::asiolink::IOAddress& address) const;
+
+    /// @brief Marks the address as used.
+    ///
+    /// This method does nothing if the address doesn't belong to the range.
+    ///
+    /// @param address Address to be marked.
+    void markUsed(const isc::asiolink::IOAddress& address);
+
+    /// @brief Marks the address as free.
+    ///
+    /// This method does nothing if the address doesn't belong to the range.
+    ///
+    /// @param address Address to be marked.
+    void markFree(const isc::asiolink::IOAddress& address);
+
+    /// @brief Checks if the address is free.
+    ///
+    /// @param address Address to be checked.
+    ///
+    /// @return true if the address belongs to the range and is free.
+    bool isFree(const isc::asiolink::IOAddress& address) const;
+
+    /// @brief Marks all addresses as free.
+    ///
+    /// The position of the cursor is preserved.
+    void clear();
+
+    /// @brief Returns the number of free addresses in the range.
+    uint64_t getFreeCount() const {
+        return (free_count_);
+    }
+
+    /// @brief Returns the next free address.
+    ///
+    /// The search starts at the cursor and wraps around at the end of the
+    /// range. The cursor is moved past the returned address. The address
+    /// is not marked as used.
+    ///
+    /// @param [out] address Free address found.
+    ///
+    /// @return true if the free address has been found, false if all
+    /// addresses are in use.
+    bool pickFree(isc::asiolink::IOAddress& address);
+
+private:
+
+    /// @brief Type of the word holding the bits.
+    typedef uint64_t Word;
+
+    /// @brief Number of bits in the word.
+    static const uint32_t WORD_BITS = 64;
+
+    /// @brief Returns the offset of the address within the range.
+    ///
+    /// @param address Address which must belong to the range.
+    uint32_t getOffset(const isc::asiolink::IOAddress& address) const {
+        return (static_cast<uint32_t>(address) - first_);
+    }
+
+    /// @brief Finds the first free address at or after the offset within
+    /// the word which holds the offset.
+    ///
+    /// @param offset Offset at which the search starts.
+    /// @param [out] found Offset of the free address found.
+    ///
+    /// @return true if the free address has been found.
+    bool findFreeInWord(const uint64_t offset, uint64_t& found) const;
+
+    /// @brief First address in the range.
+    uint32_t first_;
+
+    /// @brief Number of addresses in the range.
+    uint64_t size_;
+
+    /// @brief Bits indicating used addresses.
+    ///
+    /// The bits beyond the end of the range are set, so as they are
+    /// never picked.
+    std::vector<Word> words_;
+
+    /// @brief Number of free addresses.
+    uint64_t free_count_;
+
+    /// @brief Offset at which the search for the free address starts.
+    uint64_t cursor_;
+};
+
+/// @brief Pointer to the @c AddressBitmap.
+typedef boost::shared_ptr<AddressBitmap> AddressBitmapPtr;
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // ADDRESS_BITMAP_H
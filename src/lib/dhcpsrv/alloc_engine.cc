@@ -12,16 +12,21 @@
 // OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
 // PERFORMANCE OF THIS SOFTWARE.
 
+#include <dhcpsrv/addr_utilities.h>
 #include <dhcpsrv/alloc_engine.h>
+#include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/host_mgr.h>
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/stats_mgr.h>
 #include <dhcp/dhcp6.h>
 
 #include <hooks/server_hooks.h>
 #include <hooks/hooks_manager.h>
 
+#include <boost/random/uniform_int_distribution.hpp>
+
 #include <cstring>
 #include <limits>
 #include <vector>
@@ -31,6 +36,7 @@
 using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::hooks;
+using namespace isc::util::thread;
 
 namespace {
 
@@ -58,6 +64,104 @@ struct AllocEngineHooks {
 // module is called.
 AllocEngineHooks Hooks;
 
+/// @brief Updates the number of addresses assigned in the subnet.
+///
+/// The statistic is obtained from the current configuration, which
+/// holds the statistics of its subnets since it has been committed.
+/// The statistics of the subnets which are no longer configured are
+/// not updated.
+///
+/// @param subnet_id Identifier of the subnet.
+/// @param value Number of addresses assigned (if positive) or released
+/// (if negative).
+void
+addAssignedAddresses(const SubnetID subnet_id, const int64_t value) {
+    StatsCounterPtr stat = CfgMgr::instance().getCurrentCfg()->
+        getCfgSubnets4()->getAssignedAddresses(subnet_id);
+    if (stat) {
+        stat->add(value);
+    }
+}
+
+/// @brief Returns the length of the addresses or prefixes in the pool.
+///
+/// @param pool Pool for which the length is returned.
+/// @return Delegated prefix length for prefix pools, 128 for IPv6 address
+/// pools and 32 for IPv4 pools.
+uint8_t
+getPrefixLength(const PoolPtr& pool) {
+    if (pool->getType() == Lease::TYPE_V4) {
+        return (32);
+    }
+    Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(pool);
+    return (pool6 ? pool6->getLength() : 128);
+}
+
+/// @brief Returns the address at the specified position in the pools.
+///
+/// The pools are treated as a single range of addresses (or prefixes),
+/// in which the first address of the second pool follows the last
+/// address of the first pool etc.
+///
+/// @param pools Non-empty collection of pools.
+/// @param offset Position of the address, counting from the first address
+/// in the first pool. It must be lower than the total capacity of the pools.
+/// @return Address at the specified position.
+IOAddress
+getAddressAtOffset(const PoolCollection& pools, uint64_t offset) {
+    for (PoolCollection::const_iterator pool = pools.begin();
+         pool != pools.end(); ++pool) {
+        if (offset < (*pool)->getCapacity()) {
+            return (offsetAddress((*pool)->getFirstAddress(), offset,
+                                  getPrefixLength(*pool)));
+        }
+        offset -= (*pool)->getCapacity();
+    }
+    // The offset is out of range. This may only happen if the capacity
+    // of the pools exceeds 2^64, so let's start over.
+    return (pools[0]->getFirstAddress());
+}
+
+/// @brief Returns the address following the specified address in the pools.
+///
+/// The first address of the next pool follows the last address of the
+/// pool, and the first address of the first pool follows the last address
+/// of the last pool.
+///
+/// @param pools Non-empty collection of pools.
+/// @param address Address for which the following address is returned.
+/// @param [out] next Address following the specified address.
+/// @return false if the specified address doesn't belong to any pool.
+bool
+getNextAddress(const PoolCollection& pools, const IOAddress& address,
+               IOAddress& next) {
+    for (PoolCollection::const_iterator pool = pools.begin();
+         pool != pools.end(); ++pool) {
+        if (!(*pool)->inRange(address)) {
+            continue;
+        }
+        next = offsetAddress(address, 1, getPrefixLength(*pool));
+        // Check for the end of the pool. The address might also have
+        // looped over if the pool ends at the end of the address space.
+        if ((*pool)->inRange(next) && (address < next)) {
+            return (true);
+        }
+        ++pool;
+        next = (pool == pools.end() ? pools[0]->getFirstAddress() :
+                (*pool)->getFirstAddress());
+        return (true);
+    }
+    return (false);
+}
+
+/// @brief Checks if the address is the zero address of its family.
+///
+/// @param address Address to be checked.
+bool
+isZeroAddress(const IOAddress& address) {
+    return (address.isV4() ? address.isV4Zero() : address.isV6Zero());
+}
+
 }; // anonymous namespace
 
 namespace isc {
@@ -129,6 +233,10 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
                                              const DuidPtr&,
                                              const IOAddress&) {
 
+    // The last allocated address is held in the subnet, so make sure that
+    // only one thread at a time picks the address.
+    Mutex::Locker locker(mutex_);
+
     // Is this prefix allocation?
     bool prefix = pool_type_ == Lease::TYPE_PD;
 
@@ -201,28 +309,212 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
 
 AllocEngine::HashedAllocator::HashedAllocator(Lease::Type lease_type)
     :Allocator(lease_type) {
-    isc_throw(NotImplemented, "Hashed allocator is not implemented");
 }
 
 
 isc::asiolink::IOAddress
-AllocEngine::HashedAllocator::pickAddress(const SubnetPtr&,
-                                          const DuidPtr&,
-                                          const IOAddress&) {
-    isc_throw(NotImplemented, "Hashed allocator is not implemented");
+AllocEngine::HashedAllocator::pickAddress(const SubnetPtr& subnet,
+                                          const DuidPtr& duid,
+                                          const IOAddress& hint) {
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    if (pools.empty()) {
+        isc_throw(AllocFailed, "No pools defined in selected subnet");
+    }
+
+    // If we have already returned an address for this client, the
+    // next address follows it.
+    IOAddress next(hint);
+    if (!isZeroAddress(hint) && getNextAddress(pools, hint, next)) {
+        return (next);
+    }
+
+    // Calculate the 64-bit FNV-1a hash of the client identifier. It is
+    // fast and distributes the similar identifiers (e.g. MAC addresses
+    // differing in the last byte) well.
+    uint64_t hash = 14695981039346656037ull;
+    if (duid) {
+        const std::vector<uint8_t>& id = duid->getDuid();
+        for (std::vector<uint8_t>::const_iterator byte = id.begin();
+             byte != id.end(); ++byte) {
+            hash ^= *byte;
+            hash *= 1099511628211ull;
+        }
+    }
+
+    return (getAddressAtOffset(pools,
+                               hash % subnet->getPoolCapacity(pool_type_)));
 }
 
 AllocEngine::RandomAllocator::RandomAllocator(Lease::Type lease_type)
-    :Allocator(lease_type) {
-    isc_throw(NotImplemented, "Random allocator is not implemented");
+    :Allocator(lease_type), generator_(time(NULL)) {
+}
+
+
+isc::asiolink::IOAddress
+AllocEngine::RandomAllocator::pickAddress(const SubnetPtr& subnet,
+                                          const DuidPtr&,
+                                          const IOAddress& hint) {
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    if (pools.empty()) {
+        isc_throw(AllocFailed, "No pools defined in selected subnet");
+    }
+
+    // If we have already returned an address for this client, don't pick
+    // another random address as it could be the one we have already
+    // returned. Simply take the next one.
+    IOAddress next(hint);
+    if (!isZeroAddress(hint) && getNextAddress(pools, hint, next)) {
+        return (next);
+    }
+
+    boost::random::uniform_int_distribution<uint64_t>
+        dist(0, subnet->getPoolCapacity(pool_type_) - 1);
+    uint64_t offset = 0;
+    {
+        Mutex::Locker locker(mutex_);
+        offset = dist(generator_);
+    }
+    return (getAddressAtOffset(pools, offset));
 }
 
+const unsigned int AllocEngine::BitmapAllocator::DEFAULT_REPOPULATE_INTERVAL;
+
+AllocEngine::BitmapAllocator::BitmapAllocator(Lease::Type type,
+                                              const unsigned int repopulate_interval)
+    :Allocator(type), repopulate_interval_(repopulate_interval) {
+    if (type != Lease::TYPE_V4) {
+        isc_throw(BadValue, "Bitmap allocator supports only IPv4 addresses");
+    }
+}
 
 isc::asiolink::IOAddress
-AllocEngine::RandomAllocator::pickAddress(const SubnetPtr&,
+AllocEngine::BitmapAllocator::pickAddress(const SubnetPtr& subnet,
                                           const DuidPtr&,
                                           const IOAddress&) {
-    isc_throw(NotImplemented, "Random allocator is not implemented");
+    Mutex::Locker locker(mutex_);
+
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    if (pools.empty()) {
+        isc_throw(AllocFailed, "No pools defined in selected subnet");
+    }
+
+    // Populate the bitmaps if this is the first allocation from this
+    // subnet or the pools have been reconfigured.
+    for (PoolCollection::const_iterator pool = pools.begin();
+         pool != pools.end(); ++pool) {
+        AddressBitmapPtr bitmap = getBitmap((*pool)->getFirstAddress());
+        if (!bitmap ||
+            (bitmap->getFirstAddress() != (*pool)->getFirstAddress()) ||
+            (bitmap->getLastAddress() != (*pool)->getLastAddress())) {
+            populate(subnet);
+            break;
+        }
+    }
+
+    // If there are no free addresses, the leases may have expired or may
+    // have been removed without notifying us. Populate the bitmaps again
+    // and retry, unless they have been populated recently: it reads all
+    // leases of the subnet, which is expensive when the pools stay
+    // exhausted.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        for (PoolCollection::const_iterator pool = pools.begin();
+             pool != pools.end(); ++pool) {
+            AddressBitmapPtr bitmap = getBitmap((*pool)->getFirstAddress());
+            IOAddress address("0.0.0.0");
+            if (bitmap && bitmap->pickFree(address)) {
+                return (address);
+            }
+        }
+        if (attempt > 0) {
+            break;
+        }
+        std::map<SubnetID, time_t>::const_iterator populated =
+            populated_.find(subnet->getID());
+        if ((populated != populated_.end()) &&
+            (time(NULL) - populated->second <
+             static_cast<time_t>(repopulate_interval_))) {
+            break;
+        }
+        populate(subnet);
+    }
+
+    return (IOAddress::IPV4_ZERO_ADDRESS());
+}
+
+void
+AllocEngine::BitmapAllocator::addressUsed(const IOAddress& address) {
+    Mutex::Locker locker(mutex_);
+    AddressBitmapPtr bitmap = getBitmap(address);
+    if (bitmap) {
+        bitmap->markUsed(address);
+    }
+}
+
+void
+AllocEngine::BitmapAllocator::addressFreed(const IOAddress& address) {
+    Mutex::Locker locker(mutex_);
+    AddressBitmapPtr bitmap = getBitmap(address);
+    if (bitmap) {
+        bitmap->markFree(address);
+    }
+}
+
+void
+AllocEngine::BitmapAllocator::populate(const SubnetPtr& subnet) {
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    for (PoolCollection::const_iterator pool = pools.begin();
+         pool != pools.end(); ++pool) {
+        const IOAddress& first = (*pool)->getFirstAddress();
+        const IOAddress& last = (*pool)->getLastAddress();
+        AddressBitmapPtr bitmap = getBitmap(first);
+        if (bitmap && (bitmap->getFirstAddress() == first) &&
+            (bitmap->getLastAddress() == last)) {
+            // Reuse the existing bitmap to preserve the position from which
+            // the addresses are handed out.
+            bitmap->clear();
+            continue;
+        }
+
+        // Remove the bitmaps of the pools which no longer exist and which
+        // overlap with this pool.
+        std::map<IOAddress, AddressBitmapPtr>::iterator it =
+            bitmaps_.upper_bound(last);
+        while (it != bitmaps_.begin()) {
+            --it;
+            if (it->second->getLastAddress() < first) {
+                break;
+            }
+            bitmaps_.erase(it++);
+        }
+        bitmaps_[first].reset(new AddressBitmap(first, last));
+    }
+
+    populated_[subnet->getID()] = time(NULL);
+    Lease4Collection leases =
+        LeaseMgrFactory::instance().getLeases4(subnet->getID());
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        // The addresses of the expired leases may be reused.
+        if (!(*lease)->expired()) {
+            AddressBitmapPtr bitmap = getBitmap((*lease)->addr_);
+            if (bitmap) {
+                bitmap->markUsed((*lease)->addr_);
+            }
+        }
+    }
+}
+
+AddressBitmapPtr
+AllocEngine::BitmapAllocator::getBitmap(const IOAddress& address) const {
+    // Find the bitmap with the greatest first address not greater than
+    // the specified address.
+    std::map<IOAddress, AddressBitmapPtr>::const_iterator it =
+        bitmaps_.upper_bound(address);
+    if (it == bitmaps_.begin()) {
+        return (AddressBitmapPtr());
+    }
+    --it;
+    return (it->second->inRange(address) ? it->second : AddressBitmapPtr());
 }
 
 
@@ -244,6 +536,9 @@ AllocEngine::AllocEngine(AllocType engine_type, unsigned int attempts,
     case ALLOC_RANDOM:
         allocators_[basic_type] = AllocatorPtr(new RandomAllocator(basic_type));
         break;
+    case ALLOC_BITMAP:
+        allocators_[basic_type] = AllocatorPtr(new BitmapAllocator(basic_type));
+        break;
     default:
         isc_throw(BadValue, "Invalid/unsupported allocation algorithm");
     }
@@ -272,6 +567,12 @@ AllocEngine::AllocEngine(AllocType engine_type, unsigned int attempts,
     // Register hook points
     hook_index_lease4_select_ = Hooks.hook_index_lease4_select_;
     hook_index_lease6_select_ = Hooks.hook_index_lease6_select_;
+
+    // Obtain the statistics, so as they are not looked up by name when
+    // the leases are allocated and reclaimed.
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    stat_v4_allocation_fail_ = stats_mgr.getCounter("v4-allocation-fail");
+    stat_reclaimed_leases_ = stats_mgr.getCounter("reclaimed-leases");
 }
 
 AllocEngine::AllocatorPtr AllocEngine::getAllocator(Lease::Type type) {
@@ -284,6 +585,91 @@ AllocEngine::AllocatorPtr AllocEngine::getAllocator(Lease::Type type) {
     return (alloc->second);
 }
 
+void
+AllocEngine::leaseRemoved4(const IOAddress& address) {
+    getAllocator(Lease::TYPE_V4)->addressFreed(address);
+}
+
+Lease4Collection
+AllocEngine::reclaimExpiredLeases4(const size_t max_leases) {
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    Lease4Collection expired_leases;
+    lease_mgr.getExpiredLeases4(expired_leases, max_leases);
+
+    Lease4Collection reclaimed_leases;
+    for (Lease4Collection::const_iterator lease = expired_leases.begin();
+         lease != expired_leases.end(); ++lease) {
+        // The expired lease may be reused by one of the threads processing
+        // packets right now. Leave it to that thread.
+        AddressClaim claim(*this, (*lease)->addr_, false);
+        if (!claim.ok()) {
+            continue;
+        }
+
+        // The lease may have been renewed after it has been found expired.
+        Lease4Ptr current = lease_mgr.getLease4((*lease)->addr_);
+        if (!current || !current->expired()) {
+            continue;
+        }
+
+        if (lease_mgr.deleteLease(current->addr_)) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_LEASE4_RECLAIMED)
+                .arg(current->addr_.toText());
+            getAllocator(Lease::TYPE_V4)->addressFreed(current->addr_);
+            addAssignedAddresses(current->subnet_id_, -1);
+            reclaimed_leases.push_back(current);
+        }
+    }
+
+    stat_reclaimed_leases_->add(reclaimed_leases.size());
+
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_LEASES_RECLAIMED)
+        .arg(reclaimed_leases.size()).arg("IPv4");
+
+    return (reclaimed_leases);
+}
+
+Lease6Collection
+AllocEngine::reclaimExpiredLeases6(const size_t max_leases) {
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    Lease6Collection expired_leases;
+    lease_mgr.getExpiredLeases6(expired_leases, max_leases);
+
+    Lease6Collection reclaimed_leases;
+    for (Lease6Collection::const_iterator lease = expired_leases.begin();
+         lease != expired_leases.end(); ++lease) {
+        // The expired lease may be reused by one of the threads processing
+        // packets right now. Leave it to that thread.
+        AddressClaim claim(*this, (*lease)->addr_, false);
+        if (!claim.ok()) {
+            continue;
+        }
+
+        // The lease may have been renewed after it has been found expired.
+        Lease6Ptr current = lease_mgr.getLease6((*lease)->type_,
+                                                (*lease)->addr_);
+        if (!current || !current->expired()) {
+            continue;
+        }
+
+        if (lease_mgr.deleteLease(current->addr_)) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_LEASE6_RECLAIMED)
+                .arg(Lease::typeToText(current->type_))
+                .arg(current->addr_.toText());
+            reclaimed_leases.push_back(current);
+        }
+    }
+
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_LEASES_RECLAIMED)
+        .arg(reclaimed_leases.size()).arg("IPv6");
+
+    return (reclaimed_leases);
+}
+
 // ##########################################################################
 // #    DHCPv6 lease allocation code starts here.
 // ##########################################################################
@@ -515,9 +901,17 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
         Pool6>(ctx.subnet_->getPool(ctx.type_, hint, false));
 
     if (pool) {
+        // Another thread may be allocating the same address at this time.
+        // If so, the hint is not usable.
+        AddressClaim claim(*this, hint, ctx.fake_allocation_);
+
         /// @todo: We support only one hint for now
         Lease6Ptr lease = LeaseMgrFactory::instance().getLease6(ctx.type_, hint);
-        if (!lease) {
+        if (!claim.ok()) {
+            // The hint is being allocated by another thread, so continue
+            // with the regular allocation path.
+
+        } else if (!lease) {
 
             // In-pool reservations: Check if this address is reserved for someone
             // else. There is no need to check for whom it is reserved, because if
@@ -590,9 +984,12 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
     /// attempts_, specified by the user could override that value (and keep
     /// dynamic if they're set to 0).
     uint32_t max_attempts = ctx.subnet_->getPoolCapacity(ctx.type_);
+    IOAddress candidate = IOAddress::IPV6_ZERO_ADDRESS();
     for (uint32_t i = 0; i < max_attempts; ++i)
     {
-        IOAddress candidate = allocator->pickAddress(ctx.subnet_, ctx.duid_, hint);
+        // Pass the previous candidate to the allocator, so as it can
+        // continue from where it left off.
+        candidate = allocator->pickAddress(ctx.subnet_, ctx.duid_, candidate);
 
         /// In-pool reservations: Check if this address is reserved for someone
         /// else. There is no need to check for whom it is reserved, because if
@@ -614,6 +1011,13 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
             prefix_len = pool->getLength();
         }
 
+        // Another thread may be allocating the same address at this time.
+        // If so, try another address.
+        AddressClaim claim(*this, candidate, ctx.fake_allocation_);
+        if (!claim.ok()) {
+            continue;
+        }
+
         Lease6Ptr existing = LeaseMgrFactory::instance().getLease6(ctx.type_,
                                                                    candidate);
         if (!existing) {
@@ -1262,8 +1666,19 @@ bool matchClientLease(const AllocEngine::ClientContext4& ctx, Lease4Ptr& client_
     LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
 
     // The server should hand out existing lease to the client, so we have to check
-    // if there is one. First, try to use the client's HW address.
-    client_lease = lease_mgr.getLease4(*ctx.hwaddr_, ctx.subnet_->getID());
+    // if there is one. First, try to use the client's HW address. If the client
+    // identifier is supplied and the lease database backend can execute both
+    // lookups concurrently, the lease for the client identifier is obtained in
+    // the same call. Otherwise, it is only obtained if needed.
+    Lease4Ptr clientid_lease;
+    const bool concurrent = ctx.clientid_ && lease_mgr.concurrentClientLookups();
+    if (concurrent) {
+        lease_mgr.getClientLeases4(*ctx.hwaddr_, *ctx.clientid_,
+                                   ctx.subnet_->getID(), client_lease,
+                                   clientid_lease);
+    } else {
+        client_lease = lease_mgr.getLease4(*ctx.hwaddr_, ctx.subnet_->getID());
+    }
     // If there is no lease for this HW address or the lease doesn't seem to be ours,
     // we will have to use the client identifier. Note that in some situations two
     // clients may use the same HW address so even if we find the lease for the HW
@@ -1279,7 +1694,8 @@ bool matchClientLease(const AllocEngine::ClientContext4& ctx, Lease4Ptr& client_
         // which we have found for the HW address, so there is still a chance that
         // we will allocate the lease. Check if there is a lease using the client
         // identifier.
-        client_lease = lease_mgr.getLease4(*ctx.clientid_, ctx.subnet_->getID());
+        client_lease = concurrent ? clientid_lease :
+            lease_mgr.getLease4(*ctx.clientid_, ctx.subnet_->getID());
     }
 
     // Check if the lease we have found belongs to us.
@@ -1381,6 +1797,7 @@ AllocEngine::allocateLease4(ClientContext4& ctx) {
         if (!new_lease) {
             // Unable to allocate an address, return an empty lease.
             LOG_WARN(dhcpsrv_logger, DHCPSRV_ADDRESS4_ALLOC_FAIL).arg(attempts_);
+            stat_v4_allocation_fail_->add(1);
         }
 
     } catch (const isc::Exception& e) {
@@ -1614,7 +2031,10 @@ AllocEngine::requestLease4(AllocEngine::ClientContext4& ctx) {
     // the previous lease needs to be removed from the lease database.
     if (new_lease && client_lease) {
         ctx.old_lease_ = Lease4Ptr(new Lease4(*client_lease));
-        lease_mgr.deleteLease(client_lease->addr_);
+        if (lease_mgr.deleteLease(client_lease->addr_)) {
+            getAllocator(Lease::TYPE_V4)->addressFreed(client_lease->addr_);
+            addAssignedAddresses(client_lease->subnet_id_, -1);
+        }
     }
 
     // Return the allocated lease or NULL pointer if allocation was
@@ -1691,6 +2111,7 @@ AllocEngine::createLease4(const ClientContext4& ctx, const IOAddress& addr) {
         // That is a real (REQUEST) allocation
         bool status = LeaseMgrFactory::instance().addLease(lease);
         if (status) {
+            addAssignedAddresses(lease->subnet_id_, 1);
             return (lease);
         } else {
             // One of many failures with LeaseMgr (e.g. lost connection to the
@@ -1849,27 +2270,66 @@ AllocEngine::reuseExpiredLease4(Lease4Ptr& expired,
     return (expired);
 }
 
+bool
+AllocEngine::claimAddress(const IOAddress& address) {
+    Mutex::Locker locker(claimed_mutex_);
+    return (claimed_addresses_.insert(address).second);
+}
+
+void
+AllocEngine::releaseAddress(const IOAddress& address) {
+    Mutex::Locker locker(claimed_mutex_);
+    claimed_addresses_.erase(address);
+}
+
+AllocEngine::AddressClaim::AddressClaim(AllocEngine& engine,
+                                        const IOAddress& address,
+                                        const bool fake_allocation)
+    : engine_(engine), address_(address), fake_allocation_(fake_allocation),
+      claimed_(!fake_allocation && engine.claimAddress(address)) {
+}
+
+AllocEngine::AddressClaim::~AddressClaim() {
+    if (claimed_) {
+        engine_.releaseAddress(address_);
+    }
+}
+
 Lease4Ptr
 AllocEngine::allocateOrReuseLease4(const IOAddress& candidate, ClientContext4& ctx) {
     ctx.conflicting_lease_.reset();
 
+    // Another thread may be allocating the same address at this time. If
+    // so, the address is treated as being in use.
+    AddressClaim claim(*this, candidate, ctx.fake_allocation_);
+    if (!claim.ok()) {
+        return (Lease4Ptr());
+    }
+
+    Lease4Ptr new_lease;
     Lease4Ptr exist_lease = LeaseMgrFactory::instance().getLease4(candidate);
     if (exist_lease) {
         if (exist_lease->expired()) {
             ctx.old_lease_ = Lease4Ptr(new Lease4(*exist_lease));
-            return (reuseExpiredLease4(exist_lease, ctx));
+            new_lease = reuseExpiredLease4(exist_lease, ctx);
 
         } else {
             // If there is a lease and it is not expired, pass this lease back
             // to the caller in the context. The caller may need to know
             // which lease we're conflicting with.
             ctx.conflicting_lease_ = exist_lease;
+            // Make sure the allocator doesn't return this address again.
+            getAllocator(Lease::TYPE_V4)->addressUsed(candidate);
         }
 
     } else {
-        return (createLease4(ctx, candidate));
+        new_lease = createLease4(ctx, candidate);
     }
-    return (Lease4Ptr());
+
+    if (new_lease && !ctx.fake_allocation_) {
+        getAllocator(Lease::TYPE_V4)->addressUsed(candidate);
+    }
+    return (new_lease);
 }
 
 Lease4Ptr
@@ -1877,9 +2337,24 @@ AllocEngine::allocateUnreservedLease4(ClientContext4& ctx) {
     Lease4Ptr new_lease;
     AllocatorPtr allocator = getAllocator(Lease::TYPE_V4);
     const uint64_t max_attempts = ctx.subnet_->getPoolCapacity(Lease::TYPE_V4);
+
+    // The client identifier is used by the hashed allocator. If the client
+    // didn't send it, use the HW address instead.
+    DuidPtr client_id = ctx.clientid_;
+    if (!client_id && ctx.hwaddr_ && !ctx.hwaddr_->hwaddr_.empty()) {
+        client_id.reset(new DUID(ctx.hwaddr_->hwaddr_));
+    }
+
+    IOAddress candidate = IOAddress::IPV4_ZERO_ADDRESS();
     for (uint64_t i = 0; i < max_attempts; ++i) {
-        IOAddress candidate = allocator->pickAddress(ctx.subnet_, ctx.clientid_,
-                                                     ctx.requested_address_);
+        // Pass the previous candidate to the allocator, so as it can
+        // continue from where it left off.
+        candidate = allocator->pickAddress(ctx.subnet_, client_id, candidate);
+        // The allocator returns zero address if it knows that there are
+        // no free addresses in the pools.
+        if (candidate.isV4Zero()) {
+            break;
+        }
         // If address is not reserved for another client, try to allocate it.
         if (!addressReserved(candidate, ctx)) {
             // The call below will return the non-NULL pointer if we
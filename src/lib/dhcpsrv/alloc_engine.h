@@ -20,15 +20,20 @@
 #include <dhcp/hwaddr.h>
 #include <dhcp/pkt6.h>
 #include <dhcp/option6_ia.h>
+#include <dhcpsrv/address_bitmap.h>
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/lease_mgr.h>
+#include <dhcpsrv/stats_mgr.h>
 #include <hooks/callout_handle.h>
+#include <util/threads/sync.h>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/random/mersenne_twister.hpp>
 
 #include <map>
+#include <set>
 
 namespace isc {
 namespace dhcp {
@@ -81,15 +86,48 @@ protected:
         /// than pickResource(), because nobody would immediately know what the
         /// resource means in this context.
         ///
+        /// The allocation engine calls this method repeatedly until it finds
+        /// an address which is not in use. The first call for a client is
+        /// made with the zero address (IPv4 or IPv6) as a hint. The
+        /// subsequent calls are made with the address returned by the
+        /// previous call, so as the allocators can continue probing the
+        /// pools from where they left off for this client.
+        ///
         /// @param subnet next address will be returned from pool of that subnet
         /// @param duid Client's DUID
-        /// @param hint client's hint
+        /// @param hint address returned by the previous call for the same
+        /// client or zero address if this is the first call.
         ///
         /// @return the next address
         virtual isc::asiolink::IOAddress
         pickAddress(const SubnetPtr& subnet, const DuidPtr& duid,
                     const isc::asiolink::IOAddress& hint) = 0;
 
+        /// @brief Notifies the allocator that the address is in use.
+        ///
+        /// The allocation engine calls this method when it has allocated
+        /// the address or when it has found that the address is leased to
+        /// another client. The allocators which keep track of the used
+        /// addresses update their state. The default implementation does
+        /// nothing.
+        ///
+        /// @param address Address in use.
+        virtual void addressUsed(const isc::asiolink::IOAddress& address) {
+            static_cast<void>(address);
+        }
+
+        /// @brief Notifies the allocator that the address is no longer
+        /// in use.
+        ///
+        /// The allocation engine calls this method when the lease for the
+        /// address has been removed from the lease database. The default
+        /// implementation does nothing.
+        ///
+        /// @param address Address which is no longer in use.
+        virtual void addressFreed(const isc::asiolink::IOAddress& address) {
+            static_cast<void>(address);
+        }
+
         /// @brief Default constructor.
         ///
         /// Specifies which type of leases this allocator will assign
@@ -116,6 +154,10 @@ protected:
     /// a pool iteratively, one after another. Once the last address is reached,
     /// it starts allocating from the beginning of the first pool (i.e. it loops
     /// over).
+    ///
+    /// The last allocated address is stored in the subnet, so the calls to
+    /// @c pickAddress are serialized to allow for using the allocator by
+    /// multiple threads.
     class IterativeAllocator : public Allocator {
     public:
 
@@ -137,6 +179,9 @@ protected:
                         const isc::asiolink::IOAddress& hint);
     protected:
 
+        /// @brief Mutex serializing the calls to @c pickAddress.
+        isc::util::thread::Mutex mutex_;
+
         /// @brief Returns the next prefix
         ///
         /// This method works for IPv6 addresses only. It increases the
@@ -154,7 +199,21 @@ protected:
 
     /// @brief Address/prefix allocator that gets an address based on a hash
     ///
-    /// @todo: This is a skeleton class for now and is missing an implementation.
+    /// This allocator calculates a hash of the client identifier (DUID or
+    /// client identifier) and uses it to select the starting candidate in
+    /// the pools of the subnet. The same client always starts at the same
+    /// address, so a returning client is likely to get the same address
+    /// it had before, even if its lease has been removed. The different
+    /// clients start at different addresses, so the concurrent allocations
+    /// don't compete for the same addresses as they do with the iterative
+    /// allocator.
+    ///
+    /// If the starting candidate is in use, the subsequent candidates
+    /// follow it in the pools, looping over to the first pool after the
+    /// end of the last pool is reached.
+    ///
+    /// This allocator holds no state, so it can be used by multiple threads
+    /// without locking.
     class HashedAllocator : public Allocator {
     public:
 
@@ -164,11 +223,11 @@ protected:
 
         /// @brief returns an address based on hash calculated from client's DUID.
         ///
-        /// @todo: Implement this method
-        ///
         /// @param subnet an address will be picked from pool of that subnet
-        /// @param duid Client's DUID
-        /// @param hint a hint (last address that was picked)
+        /// @param duid Client's DUID. If it is NULL, all such clients start
+        /// at the same address.
+        /// @param hint address picked in the previous call for this client
+        /// or zero address
         /// @return selected address
         virtual isc::asiolink::IOAddress pickAddress(const SubnetPtr& subnet,
                                                      const DuidPtr& duid,
@@ -177,25 +236,138 @@ protected:
 
     /// @brief Random allocator that picks address randomly
     ///
-    /// @todo: This is a skeleton class for now and is missing an implementation.
+    /// The starting candidate is picked randomly from all pools of the
+    /// subnet, with each address (or prefix) being equally probable. If
+    /// the starting candidate is in use, the subsequent candidates follow
+    /// it in the pools, so as the allocator never returns the same address
+    /// twice for the same client until it has tried all addresses.
     class RandomAllocator : public Allocator {
     public:
 
-        /// @brief default constructor (does nothing)
+        /// @brief default constructor
+        ///
+        /// Seeds the random number generator.
         /// @param type - specifies allocation type
         RandomAllocator(Lease::Type type);
 
         /// @brief returns a random address from pool of specified subnet
         ///
-        /// @todo: Implement this method
-        ///
         /// @param subnet an address will be picked from pool of that subnet
         /// @param duid Client's DUID (ignored)
-        /// @param hint the last address that was picked (ignored)
+        /// @param hint address picked in the previous call for this client
+        /// or zero address
         /// @return a random address from the pool
         virtual isc::asiolink::IOAddress
         pickAddress(const SubnetPtr& subnet, const DuidPtr& duid,
                     const isc::asiolink::IOAddress& hint);
+
+    protected:
+
+        /// @brief Mutex protecting the random number generator.
+        isc::util::thread::Mutex mutex_;
+
+        /// @brief Random number generator.
+        boost::random::mt19937_64 generator_;
+    };
+
+    /// @brief IPv4 address allocator tracking free addresses in bitmaps
+    ///
+    /// This allocator holds a bitmap of used and free addresses for each
+    /// IPv4 pool, so as it can return a free address without querying the
+    /// lease database for each candidate. This matters when the pools are
+    /// nearly full, because the iterative allocator returns addresses which
+    /// are mostly in use and the allocation engine has to check each of them
+    /// in the lease database.
+    ///
+    /// The bitmaps for the pools of a subnet are populated from the lease
+    /// database when the address is picked from the subnet for the first
+    /// time and kept in sync by the allocation engine, which notifies the
+    /// allocator about allocated and removed leases. If there are no free
+    /// addresses in the bitmaps, they are populated again, because leases
+    /// may have expired or may have been removed by other means. Populating
+    /// the bitmaps reads all leases of the subnet, so it is done at most
+    /// once per repopulation interval for the subnet. If there are still
+    /// no free addresses, the allocator returns the IPv4 zero address to
+    /// indicate that the pools are exhausted.
+    ///
+    /// The addresses with expired leases are treated as free when the
+    /// bitmaps are populated. The allocation engine reuses the expired
+    /// lease when such address is returned.
+    ///
+    /// This allocator only supports IPv4 addresses.
+    class BitmapAllocator : public Allocator {
+    public:
+
+        /// @brief Default minimum time between populating the bitmaps of
+        /// the exhausted subnet, in seconds.
+        static const unsigned int DEFAULT_REPOPULATE_INTERVAL = 10;
+
+        /// @brief Constructor.
+        ///
+        /// @param type Specifies allocation type. It must be TYPE_V4.
+        /// @param repopulate_interval Minimum time between populating the
+        /// bitmaps of the subnet with no free addresses, in seconds.
+        ///
+        /// @throw BadValue if the type is not TYPE_V4.
+        BitmapAllocator(Lease::Type type,
+                        const unsigned int repopulate_interval =
+                        DEFAULT_REPOPULATE_INTERVAL);
+
+        /// @brief Returns the next free address from pools in a subnet
+        ///
+        /// @param subnet next address will be returned from pool of that subnet
+        /// @param duid Client's DUID (ignored)
+        /// @param hint client's hint (ignored)
+        /// @return the next free address or the IPv4 zero address if there
+        /// are no free addresses in the pools.
+        virtual isc::asiolink::IOAddress
+            pickAddress(const SubnetPtr& subnet,
+                        const DuidPtr& duid,
+                        const isc::asiolink::IOAddress& hint);
+
+        /// @brief Marks the address as used.
+        ///
+        /// @param address Address in use.
+        virtual void addressUsed(const isc::asiolink::IOAddress& address);
+
+        /// @brief Marks the address as free.
+        ///
+        /// @param address Address which is no longer in use.
+        virtual void addressFreed(const isc::asiolink::IOAddress& address);
+
+    protected:
+
+        /// @brief Populates the bitmaps for all pools in the subnet with
+        /// the addresses of the valid leases from the lease database.
+        ///
+        /// This method must be called with the mutex locked.
+        ///
+        /// @param subnet Subnet which pools are populated.
+        void populate(const SubnetPtr& subnet);
+
+        /// @brief Returns the bitmap holding the address.
+        ///
+        /// This method must be called with the mutex locked.
+        ///
+        /// @param address Address for which the bitmap is returned.
+        /// @return Pointer to the bitmap or NULL if there is no bitmap
+        /// holding this address.
+        AddressBitmapPtr getBitmap(const isc::asiolink::IOAddress& address) const;
+
+        /// @brief Mutex protecting the bitmaps.
+        isc::util::thread::Mutex mutex_;
+
+        /// @brief Bitmaps for the pools, indexed by the first address in
+        /// the pool.
+        std::map<isc::asiolink::IOAddress, AddressBitmapPtr> bitmaps_;
+
+        /// @brief Minimum time between populating the bitmaps of the
+        /// subnet with no free addresses, in seconds.
+        unsigned int repopulate_interval_;
+
+        /// @brief Times when the bitmaps of the subnets were populated,
+        /// indexed by the subnet identifier.
+        std::map<SubnetID, time_t> populated_;
     };
 
 public:
@@ -204,7 +376,8 @@ public:
     typedef enum {
         ALLOC_ITERATIVE, // iterative - one address after another
         ALLOC_HASHED,    // hashed - client's DUID/client-id is hashed
-        ALLOC_RANDOM     // random - an address is randomly selected
+        ALLOC_RANDOM,    // random - an address is randomly selected
+        ALLOC_BITMAP     // bitmap - free addresses are tracked in bitmaps (IPv4 only)
     } AllocType;
 
     /// @brief Constructor.
@@ -230,6 +403,49 @@ public:
     /// @return pointer to allocator handling a given resource types
     AllocatorPtr getAllocator(Lease::Type type);
 
+    /// @brief Notifies the engine that the IPv4 lease has been removed.
+    ///
+    /// This method must be called when the caller removes the IPv4 lease
+    /// from the lease database without the use of the allocation engine,
+    /// e.g. as a result of DHCPRELEASE. The allocator is notified that the
+    /// address is free.
+    ///
+    /// @param address Address for which the lease has been removed.
+    void leaseRemoved4(const isc::asiolink::IOAddress& address);
+
+    /// @brief Reclaims expired IPv4 leases.
+    ///
+    /// This method removes expired leases from the lease database, starting
+    /// from the leases which expired first, so as the addresses are returned
+    /// to the pool. It is meant to be called periodically, to reclaim a
+    /// bounded number of leases at a time. The cost of this operation is
+    /// proportional to the number of reclaimed leases rather than to the
+    /// total number of leases.
+    ///
+    /// The lease is skipped if its address is being allocated by another
+    /// thread at the same time, or if the lease has been renewed after
+    /// it has been found expired.
+    ///
+    /// @param max_leases Maximum number of leases to be reclaimed. The
+    /// value of 0 means that all expired leases are reclaimed.
+    ///
+    /// @return Collection of the reclaimed leases. The caller may use it
+    /// to perform additional actions for the reclaimed leases, e.g. remove
+    /// DNS entries.
+    Lease4Collection reclaimExpiredLeases4(const size_t max_leases);
+
+    /// @brief Reclaims expired IPv6 leases.
+    ///
+    /// This method removes expired leases from the lease database, starting
+    /// from the leases which expired first. See
+    /// @c AllocEngine::reclaimExpiredLeases4 for details.
+    ///
+    /// @param max_leases Maximum number of leases to be reclaimed. The
+    /// value of 0 means that all expired leases are reclaimed.
+    ///
+    /// @return Collection of the reclaimed leases.
+    Lease6Collection reclaimExpiredLeases6(const size_t max_leases);
+
 private:
 
     /// @brief a pointer to currently used allocator
@@ -245,6 +461,80 @@ private:
     int hook_index_lease4_select_; ///< index for lease4_select hook
     int hook_index_lease6_select_; ///< index for lease6_select hook
 
+    /// @brief "v4-allocation-fail" statistic.
+    StatsCounterPtr stat_v4_allocation_fail_;
+
+    /// @brief "reclaimed-leases" statistic.
+    StatsCounterPtr stat_reclaimed_leases_;
+
+    /// @brief Addresses being currently allocated.
+    ///
+    /// When packets are processed by multiple threads, two threads may
+    /// attempt to allocate the same address for different clients, e.g.
+    /// when both find the same expired lease. The address is claimed by
+    /// the thread before checking whether it is available and released
+    /// when the allocation is complete.
+    std::set<isc::asiolink::IOAddress> claimed_addresses_;
+
+    /// @brief Mutex protecting the set of claimed addresses.
+    isc::util::thread::Mutex claimed_mutex_;
+
+    /// @brief Claims the address for the allocation in progress.
+    ///
+    /// @param address Address to be claimed.
+    ///
+    /// @return true if the address has been claimed, false if the address
+    /// is already claimed by another thread.
+    bool claimAddress(const isc::asiolink::IOAddress& address);
+
+    /// @brief Releases the address claimed with @c claimAddress.
+    ///
+    /// @param address Address to be released.
+    void releaseAddress(const isc::asiolink::IOAddress& address);
+
+    /// @brief Releases the claimed address when it goes out of scope.
+    ///
+    /// The fake allocations (e.g. for DHCPDISCOVER or SOLICIT) don't claim
+    /// addresses, so as they don't cause real allocations to fail.
+    class AddressClaim : public boost::noncopyable {
+    public:
+
+        /// @brief Constructor.
+        ///
+        /// @param engine Allocation engine holding the claimed addresses.
+        /// @param address Address to be claimed.
+        /// @param fake_allocation Indicates if the address is allocated
+        /// for real. The address is not claimed if this value is true.
+        AddressClaim(AllocEngine& engine,
+                     const isc::asiolink::IOAddress& address,
+                     const bool fake_allocation);
+
+        /// @brief Destructor.
+        ///
+        /// Releases the address if it has been claimed.
+        ~AddressClaim();
+
+        /// @brief Checks if the allocation may proceed, i.e. the address
+        /// has been claimed or no claim was required.
+        bool ok() const {
+            return (claimed_ || fake_allocation_);
+        }
+
+    private:
+
+        /// @brief Allocation engine holding the claimed addresses.
+        AllocEngine& engine_;
+
+        /// @brief Claimed address.
+        isc::asiolink::IOAddress address_;
+
+        /// @brief Indicates if the allocation is fake.
+        bool fake_allocation_;
+
+        /// @brief Indicates if the address has been claimed.
+        bool claimed_;
+    };
+
 public:
 
     /// @brief Defines a single hint (an address + prefix-length).
@@ -1058,6 +1348,10 @@ private:
     /// reuses the expired lease. If the lease doesn't exist, it creates
     /// the new lease.
     ///
+    /// If the lease is really allocated (not a fake allocation), the
+    /// address is claimed for the duration of this call. The allocation
+    /// fails if the address is being allocated by another thread.
+    ///
     /// @param address Requested address for which the lease should be
     /// allocted.
     /// @param ctx Client context holding the data extracted from the
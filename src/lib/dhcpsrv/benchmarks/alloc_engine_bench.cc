@@ -0,0 +1,226 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcpsrv/alloc_engine.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/subnet.h>
+#include <log/logger_support.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace boost::posix_time;
+
+/// @file alloc_engine_bench.cc
+///
+/// This benchmark compares the address allocators used by the allocation
+/// engine when the pool is highly utilized. For each allocator and pool
+/// utilization, the pool is filled with leases for randomly selected
+/// addresses. Then, the new leases are allocated in the same way as the
+/// allocation engine does it: the allocator is asked for a candidate and
+/// the lease database is checked if the candidate is in use, until a free
+/// address is found. The number of lease database lookups per allocation
+/// and the time per allocation are reported.
+
+namespace {
+
+/// @brief Length of the subnet and the pool prefix.
+const uint8_t POOL_PREFIX_LEN = 18;
+
+/// @brief Number of addresses allocated in each run.
+const size_t NEW_LEASES = 100;
+
+/// @brief Exposes the allocators of the allocation engine.
+class BenchAllocEngine : public AllocEngine {
+public:
+    using AllocEngine::Allocator;
+    using AllocEngine::IterativeAllocator;
+    using AllocEngine::HashedAllocator;
+    using AllocEngine::RandomAllocator;
+    using AllocEngine::BitmapAllocator;
+};
+
+/// @brief Random number generator used with @c std::random_shuffle.
+class ShuffleGenerator {
+public:
+    /// @brief Constructor.
+    ///
+    /// @param generator Random number generator.
+    ShuffleGenerator(boost::random::mt19937& generator)
+        : generator_(generator) {
+    }
+
+    /// @brief Returns a random number in the range [0, n).
+    ptrdiff_t operator()(ptrdiff_t n) {
+        boost::random::uniform_int_distribution<ptrdiff_t> dist(0, n - 1);
+        return (dist(generator_));
+    }
+
+private:
+    /// @brief Random number generator.
+    boost::random::mt19937& generator_;
+};
+
+/// @brief Creates a client identifier for the client with the given number.
+///
+/// @param client Client number.
+DuidPtr
+createClientId(const uint32_t client) {
+    std::vector<uint8_t> id(7, 0);
+    id[0] = 1; // Hardware type Ethernet.
+    for (int i = 0; i < 4; ++i) {
+        id[6 - i] = static_cast<uint8_t>(client >> (i * 8));
+    }
+    return (DuidPtr(new ClientId(id)));
+}
+
+/// @brief Results of a single run.
+struct RunResult {
+    /// @brief Number of allocated leases.
+    size_t allocated_;
+    /// @brief Total number of lease database lookups.
+    uint64_t lookups_;
+    /// @brief Total time spent in the allocation.
+    time_duration duration_;
+};
+
+/// @brief Fills the pool and allocates new leases with the allocator.
+///
+/// @param allocator Allocator to be used.
+/// @param utilization Pool utilization in percent before the allocation.
+RunResult
+run(BenchAllocEngine::Allocator& allocator, const unsigned utilization) {
+    LeaseMgrFactory::destroy();
+    LeaseMgrFactory::create("type=memfile universe=4 persist=false");
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    Subnet4Ptr subnet(new Subnet4(IOAddress("10.0.0.0"), POOL_PREFIX_LEN,
+                                  1000, 2000, 3000, 1));
+    Pool4Ptr pool(new Pool4(IOAddress("10.0.0.0"), POOL_PREFIX_LEN));
+    subnet->addPool(pool);
+    const uint32_t capacity = static_cast<uint32_t>(pool->getCapacity());
+    const uint32_t first = static_cast<uint32_t>(pool->getFirstAddress());
+
+    // Use the same set of leased addresses for all allocators.
+    std::vector<uint32_t> offsets(capacity);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        offsets[i] = i;
+    }
+    boost::random::mt19937 generator(utilization);
+    ShuffleGenerator shuffle(generator);
+    std::random_shuffle(offsets.begin(), offsets.end(), shuffle);
+
+    const uint32_t leased = static_cast<uint32_t>(static_cast<uint64_t>(capacity) *
+                                                  utilization / 100);
+    const time_t now = time(NULL);
+    for (uint32_t i = 0; i < leased; ++i) {
+        Lease4Ptr lease(new Lease4(IOAddress(first + offsets[i]), HWAddrPtr(),
+                                   0, 0, 3000, 1000, 2000, now,
+                                   subnet->getID()));
+        lease_mgr.addLease(lease);
+    }
+
+    RunResult result;
+    result.allocated_ = 0;
+    result.lookups_ = 0;
+
+    const uint32_t to_allocate = std::min(static_cast<uint32_t>(NEW_LEASES),
+                                          capacity - leased);
+    ptime start = microsec_clock::universal_time();
+    for (uint32_t client = 0; client < to_allocate; ++client) {
+        DuidPtr client_id = createClientId(leased + client);
+        IOAddress candidate = IOAddress::IPV4_ZERO_ADDRESS();
+        for (uint32_t attempt = 0; attempt < capacity; ++attempt) {
+            candidate = allocator.pickAddress(subnet, client_id, candidate);
+            if (candidate.isV4Zero()) {
+                break;
+            }
+            ++result.lookups_;
+            if (!lease_mgr.getLease4(candidate)) {
+                Lease4Ptr lease(new Lease4(candidate, HWAddrPtr(), 0, 0,
+                                           3000, 1000, 2000, now,
+                                           subnet->getID()));
+                lease_mgr.addLease(lease);
+                allocator.addressUsed(candidate);
+                ++result.allocated_;
+                break;
+            }
+        }
+    }
+    result.duration_ = microsec_clock::universal_time() - start;
+
+    LeaseMgrFactory::destroy();
+    return (result);
+}
+
+}
+
+int
+main(int, char*[]) {
+    isc::log::initLogger("kea-alloc-engine-bench", isc::log::WARN);
+
+    const unsigned utilizations[] = { 50, 90, 95, 99 };
+    const size_t num_utilizations = sizeof(utilizations) / sizeof(utilizations[0]);
+
+    std::vector<std::pair<std::string, boost::shared_ptr<BenchAllocEngine::Allocator> > >
+        allocators;
+    for (size_t i = 0; i < num_utilizations; ++i) {
+        allocators.clear();
+        allocators.push_back(std::make_pair("iterative",
+            boost::shared_ptr<BenchAllocEngine::Allocator>(
+                new BenchAllocEngine::IterativeAllocator(Lease::TYPE_V4))));
+        allocators.push_back(std::make_pair("hashed",
+            boost::shared_ptr<BenchAllocEngine::Allocator>(
+                new BenchAllocEngine::HashedAllocator(Lease::TYPE_V4))));
+        allocators.push_back(std::make_pair("random",
+            boost::shared_ptr<BenchAllocEngine::Allocator>(
+                new BenchAllocEngine::RandomAllocator(Lease::TYPE_V4))));
+        allocators.push_back(std::make_pair("bitmap",
+            boost::shared_ptr<BenchAllocEngine::Allocator>(
+                new BenchAllocEngine::BitmapAllocator(Lease::TYPE_V4))));
+
+        std::cout << "Pool /" << static_cast<int>(POOL_PREFIX_LEN) << ", "
+                  << utilizations[i] << "% utilized" << std::endl;
+        for (size_t j = 0; j < allocators.size(); ++j) {
+            RunResult result = run(*allocators[j].second, utilizations[i]);
+            const size_t allocated = std::max(result.allocated_,
+                                              static_cast<size_t>(1));
+            std::cout << "  " << std::setw(10) << std::left
+                      << allocators[j].first << std::right
+                      << " allocated: " << std::setw(4) << result.allocated_
+                      << "  lookups/allocation: " << std::setw(10)
+                      << std::fixed << std::setprecision(2)
+                      << (static_cast<double>(result.lookups_) / allocated)
+                      << "  usec/allocation: " << std::setw(10)
+                      << (static_cast<double>(result.duration_.total_microseconds()) /
+                          allocated)
+                      << std::endl;
+        }
+    }
+
+    return (0);
+}
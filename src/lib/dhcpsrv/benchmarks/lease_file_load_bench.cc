@@ -0,0 +1,150 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <dhcpsrv/csv_lease_file4.h>
+#include <dhcpsrv/lease_file_loader.h>
+#include <dhcpsrv/memfile_lease_storage.h>
+#include <log/logger_support.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace isc::dhcp;
+using namespace boost::posix_time;
+
+/// @file lease_file_load_bench.cc
+///
+/// This benchmark measures the rate at which the DHCPv4 leases are loaded
+/// from the lease file at the server startup. It creates a lease file in
+/// which each lease has been renewed multiple times and some leases have
+/// been released, in the same way as the lease file grows between the
+/// Lease File Cleanups. The file is loaded sequentially and by multiple
+/// threads, and the number of entries read per second is reported.
+///
+/// The path of the lease file may be passed as the first argument. The
+/// file is removed when the benchmark completes.
+
+namespace {
+
+/// @brief Default path of the lease file.
+const char* DEFAULT_FILE = "lease_file_load_bench.csv";
+
+/// @brief Number of leases in the lease file.
+const uint32_t NUM_LEASES = 500000;
+
+/// @brief Number of entries written for each lease.
+const unsigned NUM_ENTRIES = 4;
+
+/// @brief First leased address.
+const uint32_t FIRST_ADDRESS = 0x0a000000; // 10.0.0.0
+
+/// @brief Writes the lease file.
+///
+/// @param filename Path to the lease file.
+void
+createLeaseFile(const std::string& filename) {
+    std::ofstream fs(filename.c_str(), std::ios::trunc);
+    fs << "address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+        "fqdn_fwd,fqdn_rev,hostname\n";
+    for (unsigned entry = 0; entry < NUM_ENTRIES; ++entry) {
+        for (uint32_t client = 0; client < NUM_LEASES; ++client) {
+            const uint32_t address = FIRST_ADDRESS + client;
+            // Every twentieth lease is released in the last round.
+            const bool released = (entry == NUM_ENTRIES - 1) &&
+                (client % 20 == 0);
+            fs << ((address >> 24) & 0xFF) << "." << ((address >> 16) & 0xFF)
+               << "." << ((address >> 8) & 0xFF) << "." << (address & 0xFF)
+               << std::hex << std::setfill('0')
+               << ",00:00:" << std::setw(2) << ((client >> 24) & 0xFF)
+               << ":" << std::setw(2) << ((client >> 16) & 0xFF)
+               << ":" << std::setw(2) << ((client >> 8) & 0xFF)
+               << ":" << std::setw(2) << (client & 0xFF)
+               << ",01:00:00:" << std::setw(2) << ((client >> 24) & 0xFF)
+               << ":" << std::setw(2) << ((client >> 16) & 0xFF)
+               << ":" << std::setw(2) << ((client >> 8) & 0xFF)
+               << ":" << std::setw(2) << (client & 0xFF)
+               << std::dec << std::setfill(' ')
+               << "," << (released ? 0 : 3600) << ","
+               << (1400000000 + entry * 1800) << ",1,1,1,"
+               << "host-" << client << ".example.com\n";
+        }
+    }
+}
+
+/// @brief Loads the lease file and prints the rate of the entries read.
+///
+/// @param filename Path to the lease file.
+/// @param num_threads Number of threads or 0 for the sequential load.
+void
+loadLeaseFile(const std::string& filename, const unsigned num_threads) {
+    CSVLeaseFile4 lease_file(filename);
+    Lease4Storage storage;
+    const ptime start = microsec_clock::universal_time();
+    if (num_threads == 0) {
+        lease_file.open();
+        LeaseFileLoader::load<Lease4>(lease_file, storage);
+    } else {
+        LeaseFileLoader::loadParallel<Lease4>(lease_file, storage, 0xFFFFFFFF,
+                                              true, false, num_threads);
+    }
+    const time_duration duration = microsec_clock::universal_time() - start;
+
+    const std::string name = num_threads == 0 ? "sequential" :
+        boost::lexical_cast<std::string>(num_threads) + " thread(s)";
+    const double seconds =
+        static_cast<double>(duration.total_microseconds()) / 1000000;
+    std::cout << "  " << std::setw(16) << std::left << name << std::right
+              << " leases: " << std::setw(8) << storage.size()
+              << "  entries/s: " << std::setw(10) << std::fixed
+              << std::setprecision(0)
+              << (seconds > 0 ? lease_file.getReadLeases() / seconds : 0)
+              << std::endl;
+}
+
+}
+
+int
+main(int argc, char* argv[]) {
+    isc::log::initLogger("kea-lease-file-load-bench", isc::log::WARN);
+
+    const std::string filename = argc > 1 ? argv[1] : DEFAULT_FILE;
+
+    try {
+        createLeaseFile(filename);
+        std::cout << "Loading " << NUM_LEASES * NUM_ENTRIES << " entries of "
+                  << NUM_LEASES << " leases" << std::endl;
+
+        const unsigned thread_counts[] = { 0, 2, 4, 8 };
+        for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]);
+             ++i) {
+            loadLeaseFile(filename, thread_counts[i]);
+        }
+
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << std::endl;
+        static_cast<void>(remove(filename.c_str()));
+        return (1);
+    }
+
+    static_cast<void>(remove(filename.c_str()));
+    return (0);
+}
@@ -0,0 +1,382 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcp/hwaddr.h>
+#include <dhcpsrv/compact_lease_storage.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/memfile_lease_storage.h>
+#include <log/logger_support.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace boost::posix_time;
+
+/// @file lease_storage_bench.cc
+///
+/// This benchmark compares the memory used by the DHCPv4 leases held in
+/// the @c Lease4Storage and in the @c CompactLease4Storage, and the time
+/// of the lease lookups by address, by HW address and subnet id and by
+/// client identifier and subnet id. Each lookup returns a copy of the
+/// lease, in the same way as the memfile backend does. The same lookups
+/// are also measured through the @c Memfile_LeaseMgr API, which holds the
+/// leases in the @c CompactLease4Storage.
+///
+/// The numbers of leases may be passed as the arguments. By default,
+/// the storages are filled with 1 and 5 millions of leases. Each storage
+/// is filled in a separate process, so as the memory freed by the other
+/// storage doesn't affect the result. The memory is measured as the
+/// growth of the resident set size, which is only available on Linux.
+
+namespace {
+
+/// @brief First leased address.
+const uint32_t FIRST_ADDRESS = 0x0a000000; // 10.0.0.0
+
+/// @brief Number of lookups of each type.
+const uint32_t NUM_LOOKUPS = 1000000;
+
+/// @brief Number of subnets the leases belong to.
+const uint32_t NUM_SUBNETS = 100;
+
+/// @brief Memfile lease manager filled and searched by the benchmark.
+class MemfileStorage {
+public:
+    /// @brief Constructor.
+    ///
+    /// Creates the memfile lease manager which doesn't write the leases
+    /// to the lease file.
+    MemfileStorage() {
+        LeaseMgrFactory::create("type=memfile universe=4 persist=false");
+    }
+
+    /// @brief Destructor.
+    ~MemfileStorage() {
+        LeaseMgrFactory::destroy();
+    }
+
+    /// @brief Adds the lease.
+    ///
+    /// @param lease Pointer to the lease.
+    void insert(const Lease4Ptr& lease) {
+        LeaseMgrFactory::instance().addLease(lease);
+    }
+};
+
+/// @brief Returns the resident set size of the process in bytes or 0
+/// if it is not available.
+size_t
+getResidentSize() {
+    std::ifstream statm("/proc/self/statm");
+    size_t total = 0;
+    size_t resident = 0;
+    if (!(statm >> total >> resident)) {
+        return (0);
+    }
+    return (resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+}
+
+/// @brief Creates a HW address for the client with the given number.
+///
+/// @param client Client number.
+HWAddr
+createHWAddr(const uint32_t client) {
+    std::vector<uint8_t> hwaddr(6, 0);
+    for (int i = 0; i < 4; ++i) {
+        hwaddr[5 - i] = static_cast<uint8_t>(client >> (i * 8));
+    }
+    return (HWAddr(hwaddr, HTYPE_ETHER));
+}
+
+/// @brief Creates a client identifier for the client with the given number.
+///
+/// @param client Client number.
+ClientId
+createClientId(const uint32_t client) {
+    std::vector<uint8_t> id(7, 0);
+    id[0] = 1; // Hardware type Ethernet.
+    for (int i = 0; i < 4; ++i) {
+        id[6 - i] = static_cast<uint8_t>(client >> (i * 8));
+    }
+    return (ClientId(id));
+}
+
+/// @brief Creates a lease for the client with the given number.
+///
+/// Every second client has a hostname.
+///
+/// @param client Client number.
+/// @param now Current time.
+Lease4Ptr
+createLease(const uint32_t client, const time_t now) {
+    HWAddrPtr hwaddr(new HWAddr(createHWAddr(client)));
+    const std::vector<uint8_t> client_id = createClientId(client).getClientId();
+    Lease4Ptr lease(new Lease4(IOAddress(FIRST_ADDRESS + client), hwaddr,
+                               &client_id[0], client_id.size(), 3600, 1800,
+                               2700, now, client % NUM_SUBNETS + 1));
+    if (client % 2 == 0) {
+        lease->hostname_ = "host-" + boost::lexical_cast<std::string>(client) +
+            ".example.com";
+    }
+    return (lease);
+}
+
+/// @brief Returns a copy of the lease by address.
+Lease4Ptr
+getLease(const Lease4Storage& storage, const IOAddress& addr) {
+    Lease4Storage::const_iterator lease = storage.find(addr);
+    return (lease == storage.end() ? Lease4Ptr() : Lease4Ptr(new Lease4(**lease)));
+}
+
+/// @brief Returns a copy of the lease by address.
+Lease4Ptr
+getLease(const CompactLease4Storage& storage, const IOAddress& addr) {
+    CompactLease4Storage::const_iterator lease = storage.find(addr);
+    return (lease == storage.end() ? Lease4Ptr() : *lease);
+}
+
+/// @brief Returns a copy of the lease by address.
+Lease4Ptr
+getLease(const MemfileStorage&, const IOAddress& addr) {
+    return (LeaseMgrFactory::instance().getLease4(addr));
+}
+
+/// @brief Returns a copy of the lease by HW address and subnet id.
+Lease4Ptr
+getLease(const Lease4Storage& storage, const HWAddr& hwaddr,
+         const SubnetID subnet_id) {
+    const Lease4Storage::nth_index<1>::type& idx = storage.get<1>();
+    const HashedIdentifier key(hwaddr.hwaddr_);
+    Lease4Storage::nth_index<1>::type::const_iterator lease =
+        idx.find(boost::make_tuple(key, subnet_id));
+    return (lease == idx.end() ? Lease4Ptr() : Lease4Ptr(new Lease4(**lease)));
+}
+
+/// @brief Returns a copy of the lease by HW address and subnet id.
+Lease4Ptr
+getLease(const CompactLease4Storage& storage, const HWAddr& hwaddr,
+         const SubnetID subnet_id) {
+    return (storage.getLease(hwaddr, subnet_id));
+}
+
+/// @brief Returns a copy of the lease by HW address and subnet id.
+Lease4Ptr
+getLease(const MemfileStorage&, const HWAddr& hwaddr,
+         const SubnetID subnet_id) {
+    return (LeaseMgrFactory::instance().getLease4(hwaddr, subnet_id));
+}
+
+/// @brief Returns a copy of the lease by client identifier and subnet id.
+Lease4Ptr
+getLease(const Lease4Storage& storage, const ClientId& client_id,
+         const SubnetID subnet_id) {
+    const Lease4Storage::nth_index<2>::type& idx = storage.get<2>();
+    const HashedIdentifier key(client_id);
+    Lease4Storage::nth_index<2>::type::const_iterator lease =
+        idx.find(boost::make_tuple(key, subnet_id));
+    return (lease == idx.end() ? Lease4Ptr() : Lease4Ptr(new Lease4(**lease)));
+}
+
+/// @brief Returns a copy of the lease by client identifier and subnet id.
+Lease4Ptr
+getLease(const CompactLease4Storage& storage, const ClientId& client_id,
+         const SubnetID subnet_id) {
+    return (storage.getLease(client_id, subnet_id));
+}
+
+/// @brief Returns a copy of the lease by client identifier and subnet id.
+Lease4Ptr
+getLease(const MemfileStorage&, const ClientId& client_id,
+         const SubnetID subnet_id) {
+    return (LeaseMgrFactory::instance().getLease4(client_id, subnet_id));
+}
+
+/// @brief Prints the time per lookup.
+///
+/// @param name Name of the lookup.
+/// @param start Time when the lookups started.
+/// @param found Number of leases found.
+void
+reportLookups(const std::string& name, const ptime& start,
+              const uint32_t found) {
+    const time_duration duration = microsec_clock::universal_time() - start;
+    std::cout << "    " << std::setw(24) << std::left << name << std::right
+              << " ns/lookup: " << std::setw(8) << std::fixed
+              << std::setprecision(0)
+              << (static_cast<double>(duration.total_microseconds()) * 1000 /
+                  NUM_LOOKUPS)
+              << (found == NUM_LOOKUPS ? "" : "  (missing leases)")
+              << std::endl;
+}
+
+/// @brief Fills the storage and looks up the leases.
+///
+/// @param name Name of the storage.
+/// @param num_leases Number of leases.
+/// @tparam Storage Type of the storage.
+template<typename Storage>
+void
+run(const std::string& name, const uint32_t num_leases) {
+    const time_t now = time(NULL);
+    const size_t initial_size = getResidentSize();
+    Storage storage;
+    const ptime fill_start = microsec_clock::universal_time();
+    for (uint32_t client = 0; client < num_leases; ++client) {
+        storage.insert(createLease(client, now));
+    }
+    const time_duration fill_duration =
+        microsec_clock::universal_time() - fill_start;
+    const size_t size = getResidentSize() - initial_size;
+
+    std::cout << "  " << name << std::endl
+              << "    " << std::setw(24) << std::left << "memory" << std::right
+              << " bytes/lease: " << std::setw(6);
+    if (initial_size > 0) {
+        std::cout << (size / num_leases);
+    } else {
+        std::cout << "n/a";
+    }
+    std::cout << "  fill ns/lease: " << std::setw(6) << std::fixed
+              << std::setprecision(0)
+              << (static_cast<double>(fill_duration.total_microseconds()) *
+                  1000 / num_leases)
+              << std::endl;
+
+    // Look up the clients in a scattered order, so as the lookups don't
+    // benefit from the data cached by the previous lookups.
+    std::vector<uint32_t> clients(NUM_LOOKUPS);
+    for (uint32_t i = 0; i < NUM_LOOKUPS; ++i) {
+        clients[i] = static_cast<uint32_t>((static_cast<uint64_t>(i) *
+                                            2654435761U) % num_leases);
+    }
+
+    uint32_t found = 0;
+    ptime start = microsec_clock::universal_time();
+    for (uint32_t i = 0; i < NUM_LOOKUPS; ++i) {
+        if (getLease(storage, IOAddress(FIRST_ADDRESS + clients[i]))) {
+            ++found;
+        }
+    }
+    reportLookups("address", start, found);
+
+    std::vector<HWAddr> hwaddrs;
+    std::vector<ClientId> client_ids;
+    hwaddrs.reserve(NUM_LOOKUPS);
+    client_ids.reserve(NUM_LOOKUPS);
+    for (uint32_t i = 0; i < NUM_LOOKUPS; ++i) {
+        hwaddrs.push_back(createHWAddr(clients[i]));
+        client_ids.push_back(createClientId(clients[i]));
+    }
+
+    found = 0;
+    start = microsec_clock::universal_time();
+    for (uint32_t i = 0; i < NUM_LOOKUPS; ++i) {
+        if (getLease(storage, hwaddrs[i], clients[i] % NUM_SUBNETS + 1)) {
+            ++found;
+        }
+    }
+    reportLookups("HW address, subnet", start, found);
+
+    found = 0;
+    start = microsec_clock::universal_time();
+    for (uint32_t i = 0; i < NUM_LOOKUPS; ++i) {
+        if (getLease(storage, client_ids[i], clients[i] % NUM_SUBNETS + 1)) {
+            ++found;
+        }
+    }
+    reportLookups("client id, subnet", start, found);
+}
+
+/// @brief Runs the function in a child process and waits for it.
+///
+/// @param name Name of the storage.
+/// @param num_leases Number of leases.
+/// @tparam Storage Type of the storage.
+/// @return true if the child process succeeded.
+template<typename Storage>
+bool
+runInChild(const std::string& name, const uint32_t num_leases) {
+    // Flush the output, so as it isn't written twice.
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "fork failed" << std::endl;
+        return (false);
+
+    } else if (pid == 0) {
+        try {
+            run<Storage>(name, num_leases);
+        } catch (const std::exception& ex) {
+            std::cerr << "benchmark failed: " << ex.what() << std::endl;
+            _exit(1);
+        }
+        std::cout.flush();
+        _exit(0);
+    }
+
+    int status = 0;
+    return ((waitpid(pid, &status, 0) == pid) && WIFEXITED(status) &&
+            (WEXITSTATUS(status) == 0));
+}
+
+}
+
+int
+main(int argc, char* argv[]) {
+    isc::log::initLogger("kea-lease-storage-bench", isc::log::WARN);
+
+    std::vector<uint32_t> lease_counts;
+    for (int i = 1; i < argc; ++i) {
+        try {
+            lease_counts.push_back(boost::lexical_cast<uint32_t>(argv[i]));
+        } catch (const boost::bad_lexical_cast&) {
+            std::cerr << "invalid number of leases " << argv[i] << std::endl;
+            return (1);
+        }
+    }
+    if (lease_counts.empty()) {
+        lease_counts.push_back(1000000);
+        lease_counts.push_back(5000000);
+    }
+
+    for (size_t i = 0; i < lease_counts.size(); ++i) {
+        std::cout << lease_counts[i] << " leases" << std::endl;
+        if (!runInChild<Lease4Storage>("Lease4Storage", lease_counts[i]) ||
+            !runInChild<CompactLease4Storage>("CompactLease4Storage",
+                                              lease_counts[i]) ||
+            !runInChild<MemfileStorage>("Memfile_LeaseMgr", lease_counts[i])) {
+            return (1);
+        }
+    }
+
+    return (0);
+}
@@ -0,0 +1,244 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcp/hwaddr.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <log/logger_support.h>
+#include <util/threads/thread.h>
+
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::util::thread;
+using namespace boost::posix_time;
+
+/// @file pgsql_lease_mgr_bench.cc
+///
+/// This benchmark measures the rate of the lease lookups in the PostgreSQL
+/// lease database. It requires the database with the Kea schema, which is
+/// specified with the access string passed as the first argument. By
+/// default, the database used by the unit tests is used.
+///
+/// First, the client's lease is searched by the HW address and by the
+/// client identifier in the same way as the allocation engine does it:
+/// one after another and, with two connections, concurrently. Then, the
+/// leases are searched by address by multiple threads, each thread using
+/// its own connection. The number of lookups per second is reported.
+///
+/// The leases added by the benchmark are deleted when it completes.
+
+namespace {
+
+/// @brief Default access string.
+const char* DEFAULT_ACCESS = "type=postgresql name=keatest host=localhost "
+    "user=keatest password=keatest";
+
+/// @brief Number of leases in the database.
+const uint32_t NUM_LEASES = 1000;
+
+/// @brief Number of times each lease is looked up.
+const unsigned NUM_ROUNDS = 5;
+
+/// @brief First leased address.
+const uint32_t FIRST_ADDRESS = 0x0a000000; // 10.0.0.0
+
+/// @brief Subnet identifier of the leases.
+const SubnetID SUBNET_ID = 1;
+
+/// @brief Creates a HW address for the client with the given number.
+///
+/// @param client Client number.
+HWAddr
+createHWAddr(const uint32_t client) {
+    std::vector<uint8_t> hwaddr(6, 0);
+    for (int i = 0; i < 4; ++i) {
+        hwaddr[5 - i] = static_cast<uint8_t>(client >> (i * 8));
+    }
+    return (HWAddr(hwaddr, HTYPE_ETHER));
+}
+
+/// @brief Creates a client identifier for the client with the given number.
+///
+/// @param client Client number.
+ClientId
+createClientId(const uint32_t client) {
+    std::vector<uint8_t> id(7, 0);
+    id[0] = 1; // Hardware type Ethernet.
+    for (int i = 0; i < 4; ++i) {
+        id[6 - i] = static_cast<uint8_t>(client >> (i * 8));
+    }
+    return (ClientId(id));
+}
+
+/// @brief Opens the lease database with the given number of connections.
+///
+/// @param access Access string.
+/// @param connections Number of connections.
+LeaseMgr&
+openLeaseMgr(const std::string& access, const unsigned connections) {
+    LeaseMgrFactory::destroy();
+    LeaseMgrFactory::create(access + " connections=" +
+                            boost::lexical_cast<std::string>(connections));
+    return (LeaseMgrFactory::instance());
+}
+
+/// @brief Prints the rate of the lookups.
+///
+/// @param name Name of the test.
+/// @param lookups Number of lookups.
+/// @param duration Time taken by the lookups.
+void
+report(const std::string& name, const uint64_t lookups,
+       const time_duration& duration) {
+    const double seconds = static_cast<double>(duration.total_microseconds()) /
+        1000000;
+    std::cout << "  " << std::setw(36) << std::left << name << std::right
+              << " lookups/s: " << std::setw(10) << std::fixed
+              << std::setprecision(0)
+              << (seconds > 0 ? lookups / seconds : 0) << std::endl;
+}
+
+/// @brief Searches the clients' leases by the HW address and client
+/// identifier.
+///
+/// @param lease_mgr Lease manager.
+/// @param concurrent Use @c getClientLeases4 if true, issue the lookups
+/// one after another otherwise.
+/// @return Number of lookups.
+uint64_t
+lookupClients(const LeaseMgr& lease_mgr, const bool concurrent) {
+    uint64_t lookups = 0;
+    for (unsigned round = 0; round < NUM_ROUNDS; ++round) {
+        for (uint32_t client = 0; client < NUM_LEASES; ++client) {
+            const HWAddr hwaddr = createHWAddr(client);
+            const ClientId clientid = createClientId(client);
+            Lease4Ptr hwaddr_lease;
+            Lease4Ptr clientid_lease;
+            if (concurrent) {
+                lease_mgr.getClientLeases4(hwaddr, clientid, SUBNET_ID,
+                                           hwaddr_lease, clientid_lease);
+            } else {
+                hwaddr_lease = lease_mgr.getLease4(hwaddr, SUBNET_ID);
+                clientid_lease = lease_mgr.getLease4(clientid, SUBNET_ID);
+            }
+            lookups += 2;
+        }
+    }
+    return (lookups);
+}
+
+/// @brief Searches the leases by address.
+///
+/// @param lease_mgr Lease manager.
+/// @param thread Thread number, used to vary the order of the lookups.
+/// @param [out] lookups Number of lookups.
+void
+lookupAddresses(const LeaseMgr* lease_mgr, const uint32_t thread,
+                uint64_t& lookups) {
+    for (unsigned round = 0; round < NUM_ROUNDS; ++round) {
+        for (uint32_t i = 0; i < NUM_LEASES; ++i) {
+            const uint32_t offset = (i + thread * 97) % NUM_LEASES;
+            (void) lease_mgr->getLease4(IOAddress(FIRST_ADDRESS + offset));
+            ++lookups;
+        }
+    }
+}
+
+}
+
+int
+main(int argc, char* argv[]) {
+    isc::log::initLogger("kea-pgsql-lease-mgr-bench", isc::log::WARN);
+
+    const std::string access = argc > 1 ? argv[1] : DEFAULT_ACCESS;
+
+    try {
+        LeaseMgr& lease_mgr = openLeaseMgr(access, 1);
+        const time_t now = time(NULL);
+        for (uint32_t client = 0; client < NUM_LEASES; ++client) {
+            HWAddrPtr hwaddr(new HWAddr(createHWAddr(client)));
+            const std::vector<uint8_t> clientid =
+                createClientId(client).getClientId();
+            Lease4Ptr lease(new Lease4(IOAddress(FIRST_ADDRESS + client),
+                                       hwaddr, &clientid[0], clientid.size(),
+                                       3000, 1000, 2000, now, SUBNET_ID));
+            if (!lease_mgr.addLease(lease)) {
+                std::cerr << "lease for " << lease->addr_ << " already exists"
+                          << std::endl;
+                return (1);
+            }
+        }
+
+        std::cout << "Client lookups (HW address and client identifier)"
+                  << std::endl;
+        ptime start = microsec_clock::universal_time();
+        uint64_t lookups = lookupClients(openLeaseMgr(access, 1), false);
+        report("sequential, 1 connection", lookups,
+               microsec_clock::universal_time() - start);
+
+        start = microsec_clock::universal_time();
+        lookups = lookupClients(openLeaseMgr(access, 2), true);
+        report("concurrent, 2 connections", lookups,
+               microsec_clock::universal_time() - start);
+
+        std::cout << "Address lookups" << std::endl;
+        const unsigned thread_counts[] = { 1, 2, 4, 8 };
+        for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]);
+             ++i) {
+            const unsigned num_threads = thread_counts[i];
+            const LeaseMgr* mgr = &openLeaseMgr(access, num_threads);
+            std::vector<uint64_t> thread_lookups(num_threads, 0);
+            std::vector<boost::shared_ptr<Thread> > threads;
+            start = microsec_clock::universal_time();
+            for (unsigned t = 0; t < num_threads; ++t) {
+                threads.push_back(boost::shared_ptr<Thread>(
+                    new Thread(boost::bind(&lookupAddresses, mgr, t,
+                                           boost::ref(thread_lookups[t])))));
+            }
+            lookups = 0;
+            for (unsigned t = 0; t < num_threads; ++t) {
+                threads[t]->wait();
+                lookups += thread_lookups[t];
+            }
+            report(boost::lexical_cast<std::string>(num_threads) +
+                   " thread(s), 1 connection each", lookups,
+                   microsec_clock::universal_time() - start);
+        }
+
+        LeaseMgr& cleanup_mgr = openLeaseMgr(access, 1);
+        for (uint32_t client = 0; client < NUM_LEASES; ++client) {
+            cleanup_mgr.deleteLease(IOAddress(FIRST_ADDRESS + client));
+        }
+        LeaseMgrFactory::destroy();
+
+    } catch (const std::exception& ex) {
+        std::cerr << "benchmark failed: " << ex.what() << std::endl;
+        return (1);
+    }
+
+    return (0);
+}
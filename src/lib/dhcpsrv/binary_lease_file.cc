@@ -0,0 +1,443 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/binary_lease_file.h>
+
+#include <boost/crc.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// @brief Magic at the beginning of the binary lease file.
+const char MAGIC[] = "KEALEASE";
+
+/// @brief Length of the magic.
+const size_t MAGIC_LEN = sizeof(MAGIC) - 1;
+
+/// @brief Initial size of the buffer holding the data read from the file.
+const size_t READ_BUFFER_SIZE = 65536;
+
+/// @brief Maximum length of the record data.
+const size_t MAX_RECORD_LENGTH = 0xFFFF;
+
+/// @brief Computes the checksum of the record.
+///
+/// The checksum covers the length of the data and the data, so as the
+/// corrupted length is detected.
+///
+/// @param data Pointer to the data.
+/// @param length Length of the data.
+uint32_t
+checksum(const void* data, const size_t length) {
+    const uint8_t length_data[2] = {
+        static_cast<uint8_t>((length >> 8) & 0xFF),
+        static_cast<uint8_t>(length & 0xFF)
+    };
+    boost::crc_32_type crc;
+    crc.process_bytes(length_data, sizeof(length_data));
+    crc.process_bytes(data, length);
+    return (crc.checksum());
+}
+
+}
+
+namespace isc {
+namespace dhcp {
+
+const size_t BinaryLeaseFile::HEADER_SIZE;
+const size_t BinaryLeaseFile::RECORD_HEADER_SIZE;
+const uint8_t BinaryLeaseFile::FORMAT_VERSION;
+
+BinaryLeaseFile::BinaryLeaseFile(const std::string& filename,
+                                 const uint8_t universe)
+    : filename_(filename), universe_(universe), fd_(-1), record_(0),
+      read_buf_(READ_BUFFER_SIZE), read_pos_(0), read_end_(0), size_(0),
+      valid_end_(0), truncated_(false), skipped_(false), read_msg_() {
+}
+
+BinaryLeaseFile::~BinaryLeaseFile() {
+    close();
+}
+
+bool
+BinaryLeaseFile::isBinary(const std::string& filename) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return (false);
+    }
+    char magic[MAGIC_LEN];
+    const ssize_t len = read(fd, magic, MAGIC_LEN);
+    ::close(fd);
+    return ((len == static_cast<ssize_t>(MAGIC_LEN)) &&
+            (memcmp(magic, MAGIC, MAGIC_LEN) == 0));
+}
+
+void
+BinaryLeaseFile::open(const bool seek_to_end) {
+    close();
+
+    fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+        isc_throw(BinaryLeaseFileError, "unable to open '" << filename_
+                  << "': " << strerror(errno));
+    }
+
+    try {
+        struct stat st;
+        if (fstat(fd_, &st) != 0) {
+            isc_throw(BinaryLeaseFileError, "unable to get the size of '"
+                      << filename_ << "': " << strerror(errno));
+        }
+        size_ = st.st_size;
+
+        uint8_t header[HEADER_SIZE];
+        if (size_ == 0) {
+            // This is a new file, so write the header.
+            memset(header, 0, sizeof(header));
+            memcpy(header, MAGIC, MAGIC_LEN);
+            header[MAGIC_LEN] = FORMAT_VERSION;
+            header[MAGIC_LEN + 1] = universe_;
+            if (write(fd_, header, sizeof(header)) !=
+                static_cast<ssize_t>(sizeof(header))) {
+                isc_throw(BinaryLeaseFileError, "unable to write the header"
+                          " of '" << filename_ << "'");
+            }
+            size_ = HEADER_SIZE;
+
+        } else {
+            if ((read(fd_, header, sizeof(header)) !=
+                 static_cast<ssize_t>(sizeof(header))) ||
+                (memcmp(header, MAGIC, MAGIC_LEN) != 0)) {
+                isc_throw(BinaryLeaseFileError, "'" << filename_
+                          << "' is not a binary lease file");
+            }
+            if (header[MAGIC_LEN] != FORMAT_VERSION) {
+                isc_throw(BinaryLeaseFileError, "unsupported version "
+                          << static_cast<int>(header[MAGIC_LEN])
+                          << " of the binary lease file '" << filename_
+                          << "'");
+            }
+            if (header[MAGIC_LEN + 1] != universe_) {
+                isc_throw(BinaryLeaseFileError, "the binary lease file '"
+                          << filename_ << "' holds DHCPv"
+                          << static_cast<int>(header[MAGIC_LEN + 1])
+                          << " leases");
+            }
+        }
+
+        if (seek_to_end && (lseek(fd_, 0, SEEK_END) < 0)) {
+            isc_throw(BinaryLeaseFileError, "unable to seek to the end of '"
+                      << filename_ << "': " << strerror(errno));
+        }
+
+    } catch (...) {
+        close();
+        throw;
+    }
+
+    read_pos_ = 0;
+    read_end_ = 0;
+    valid_end_ = HEADER_SIZE;
+    truncated_ = false;
+    skipped_ = false;
+}
+
+void
+BinaryLeaseFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void
+BinaryLeaseFile::sync() {
+    if (fd_ < 0) {
+        isc_throw(BinaryLeaseFileError, "unable to sync '" << filename_
+                  << "': the file is not open");
+    }
+#ifdef OS_LINUX
+    const int result = fdatasync(fd_);
+#else
+    const int result = fsync(fd_);
+#endif
+    if (result != 0) {
+        isc_throw(BinaryLeaseFileError, "unable to sync '" << filename_
+                  << "': " << strerror(errno));
+    }
+}
+
+int
+BinaryLeaseFile::dupSyncDescriptor() const {
+    if (fd_ < 0) {
+        isc_throw(BinaryLeaseFileError, "unable to sync '" << filename_
+                  << "': the file is not open");
+    }
+    const int fd = dup(fd_);
+    if (fd < 0) {
+        isc_throw(BinaryLeaseFileError, "unable to duplicate the descriptor"
+                  " of '" << filename_ << "': " << strerror(errno));
+    }
+    return (fd);
+}
+
+bool
+BinaryLeaseFile::exists() const {
+    struct stat st;
+    return (stat(filename_.c_str(), &st) == 0);
+}
+
+util::OutputBuffer&
+BinaryLeaseFile::startRecord() {
+    record_.clear();
+    // The length and the checksum are set when the record is appended.
+    record_.writeUint16(0);
+    record_.writeUint32(0);
+    return (record_);
+}
+
+void
+BinaryLeaseFile::appendRecord() {
+    if (fd_ < 0) {
+        isc_throw(BinaryLeaseFileError, "unable to append a record to '"
+                  << filename_ << "': the file is not open");
+    }
+
+    const size_t length = record_.getLength() - RECORD_HEADER_SIZE;
+    if ((length == 0) || (length > MAX_RECORD_LENGTH)) {
+        isc_throw(BinaryLeaseFileError, "invalid length " << length
+                  << " of the record appended to '" << filename_ << "'");
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(record_.getData());
+    const uint32_t crc = checksum(data + RECORD_HEADER_SIZE, length);
+    record_.writeUint16At(static_cast<uint16_t>(length), 0);
+    record_.writeUint16At(static_cast<uint16_t>(crc >> 16), 2);
+    record_.writeUint16At(static_cast<uint16_t>(crc & 0xFFFF), 4);
+
+    // Remove the incomplete record found when reading, so as it doesn't
+    // corrupt the record being appended.
+    if (truncated_) {
+        if (ftruncate(fd_, valid_end_) != 0) {
+            isc_throw(BinaryLeaseFileError, "unable to remove the incomplete"
+                      " record from '" << filename_ << "': "
+                      << strerror(errno));
+        }
+        size_ = valid_end_;
+        truncated_ = false;
+    }
+
+    const ssize_t written = write(fd_, record_.getData(), record_.getLength());
+    if (written != static_cast<ssize_t>(record_.getLength())) {
+        const int err = errno;
+        // Don't leave the partially written record in the file.
+        if (written > 0) {
+            static_cast<void>(ftruncate(fd_, size_));
+        }
+        isc_throw(BinaryLeaseFileError, "unable to append a record to '"
+                  << filename_ << "': "
+                  << (written < 0 ? strerror(err) : "short write"));
+    }
+    size_ += written;
+}
+
+bool
+BinaryLeaseFile::nextRecord(const uint8_t*& data, size_t& length) {
+    data = NULL;
+    length = 0;
+
+    if (fd_ < 0) {
+        setReadMsg("the file is not open");
+        return (false);
+    }
+
+    // No more data indicates the end of file.
+    if (!fill(1)) {
+        return (true);
+    }
+
+    if (!fill(RECORD_HEADER_SIZE)) {
+        setIncomplete("incomplete record header at the end of the file");
+        return (false);
+    }
+
+    util::InputBuffer header(&read_buf_[read_pos_], RECORD_HEADER_SIZE);
+    const size_t record_length = header.readUint16();
+    const uint32_t crc = header.readUint32();
+    if (!fill(RECORD_HEADER_SIZE + record_length)) {
+        setIncomplete("incomplete record at the end of the file");
+        return (false);
+    }
+
+    const uint8_t* record_data = &read_buf_[read_pos_ + RECORD_HEADER_SIZE];
+    read_pos_ += RECORD_HEADER_SIZE + record_length;
+    valid_end_ += RECORD_HEADER_SIZE + record_length;
+
+    if (record_length == 0) {
+        skipped_ = true;
+        setReadMsg("empty record");
+        return (false);
+    }
+
+    if (checksum(record_data, record_length) != crc) {
+        skipped_ = true;
+        setReadMsg("checksum mismatch");
+        return (false);
+    }
+
+    data = record_data;
+    length = record_length;
+    return (true);
+}
+
+void
+BinaryLeaseFile::writeTime(util::OutputBuffer& buffer, const time_t value) {
+    const uint64_t time64 = static_cast<uint64_t>(value);
+    buffer.writeUint32(static_cast<uint32_t>(time64 >> 32));
+    buffer.writeUint32(static_cast<uint32_t>(time64 & 0xFFFFFFFF));
+}
+
+time_t
+BinaryLeaseFile::readTime(util::InputBuffer& buffer) {
+    uint64_t time64 = static_cast<uint64_t>(buffer.readUint32()) << 32;
+    time64 |= buffer.readUint32();
+    return (static_cast<time_t>(time64));
+}
+
+void
+BinaryLeaseFile::writeHWAddr(util::OutputBuffer& buffer,
+                             const HWAddrPtr& hwaddr) {
+    if (!hwaddr) {
+        buffer.writeUint16(0);
+        buffer.writeUint8(0);
+        return;
+    }
+    buffer.writeUint16(hwaddr->htype_);
+    buffer.writeUint8(static_cast<uint8_t>(hwaddr->hwaddr_.size()));
+    if (!hwaddr->hwaddr_.empty()) {
+        buffer.writeData(&hwaddr->hwaddr_[0], hwaddr->hwaddr_.size());
+    }
+}
+
+HWAddrPtr
+BinaryLeaseFile::readHWAddr(util::InputBuffer& buffer) {
+    const uint16_t htype = buffer.readUint16();
+    const uint8_t length = buffer.readUint8();
+    if (length == 0) {
+        return (HWAddrPtr());
+    }
+    std::vector<uint8_t> hwaddr;
+    buffer.readVector(hwaddr, length);
+    return (HWAddrPtr(new HWAddr(hwaddr, htype)));
+}
+
+void
+BinaryLeaseFile::writeString(util::OutputBuffer& buffer,
+                             const std::string& value) {
+    if (value.size() > 0xFFFF) {
+        isc_throw(BadValue, "the string of " << value.size()
+                  << " characters is too long for the binary lease file");
+    }
+    buffer.writeUint16(static_cast<uint16_t>(value.size()));
+    if (!value.empty()) {
+        buffer.writeData(value.data(), value.size());
+    }
+}
+
+std::string
+BinaryLeaseFile::readString(util::InputBuffer& buffer) {
+    const uint16_t length = buffer.readUint16();
+    std::string value(length, '\0');
+    if (length > 0) {
+        buffer.readData(&value[0], length);
+    }
+    return (value);
+}
+
+void
+BinaryLeaseFile::setIncomplete(const std::string& read_msg) {
+    // A crash may only leave the last record incomplete, in which case the
+    // remaining data are removed before the next record is appended. If
+    // the remaining data end with a valid record, the length of the record
+    // is corrupted, and if a record has been skipped, the records which
+    // follow may be misaligned. Removing the remaining data would then
+    // lose the valid records, so the file is reported as corrupted.
+    if (skipped_ || endsWithRecord()) {
+        isc_throw(BinaryLeaseFileError, "the lease file '" << filename_
+                  << "' is corrupted at offset " << valid_end_ << ": "
+                  << read_msg);
+    }
+    truncated_ = true;
+    read_pos_ = read_end_;
+    setReadMsg(read_msg);
+}
+
+bool
+BinaryLeaseFile::endsWithRecord() const {
+    // The read buffer holds all data remaining in the file.
+    for (size_t pos = read_pos_ + 1;
+         pos + RECORD_HEADER_SIZE < read_end_; ++pos) {
+        util::InputBuffer header(&read_buf_[pos], RECORD_HEADER_SIZE);
+        const size_t record_length = header.readUint16();
+        const uint32_t crc = header.readUint32();
+        if ((pos + RECORD_HEADER_SIZE + record_length == read_end_) &&
+            (checksum(&read_buf_[pos + RECORD_HEADER_SIZE], record_length)
+             == crc)) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+bool
+BinaryLeaseFile::fill(const size_t length) {
+    if (read_end_ - read_pos_ >= length) {
+        return (true);
+    }
+
+    // Move the unconsumed data to the beginning of the buffer.
+    if (read_pos_ > 0) {
+        if (read_end_ > read_pos_) {
+            memmove(&read_buf_[0], &read_buf_[read_pos_],
+                    read_end_ - read_pos_);
+        }
+        read_end_ -= read_pos_;
+        read_pos_ = 0;
+    }
+    if (read_buf_.size() < length) {
+        read_buf_.resize(length);
+    }
+
+    while (read_end_ < length) {
+        const ssize_t len = read(fd_, &read_buf_[read_end_],
+                                 read_buf_.size() - read_end_);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (false);
+        } else if (len == 0) {
+            return (false);
+        }
+        read_end_ += len;
+    }
+    return (true);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
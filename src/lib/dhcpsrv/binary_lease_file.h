@@ -0,0 +1,293 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef BINARY_LEASE_FILE_H
+#define BINARY_LEASE_FILE_H
+
+#include <dhcp/hwaddr.h>
+#include <exceptions/exceptions.h>
+#include <util/buffer.h>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <time.h>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Exception thrown when an error occurs during binary lease file
+/// operation.
+class BinaryLeaseFileError : public Exception {
+public:
+    BinaryLeaseFileError(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) { };
+};
+
+/// @brief Provides access to the binary lease journal.
+///
+/// The binary lease file is an alternative to the CSV lease file, which is
+/// cheaper to write and to parse. The lease values are stored in the
+/// binary form rather than converted to text, which also makes the file
+/// about three times smaller.
+///
+/// The file starts with a 12 byte header: the "KEALEASE" magic, the
+/// format version, the universe (4 or 6) and two reserved bytes. It is
+/// followed by the records, each holding a single lease entry:
+/// - length of the data (2 bytes),
+/// - CRC-32 checksum of the length and the data (4 bytes),
+/// - data (encoded by the derived classes).
+///
+/// All values are stored in network byte order. Each record is appended
+/// to the file with a single write, so a crash may only leave the last
+/// record incomplete. An incomplete record is reported as an error when
+/// the file is read and it is removed from the file before the next record
+/// is appended. The records which don't match the checksum are skipped.
+/// If the incomplete record is followed by a valid record or preceded by
+/// a skipped record, its length is likely corrupted rather than the record
+/// incomplete. The remaining records can't be read reliably in this case,
+/// so reading the file fails with @c BinaryLeaseFileError.
+///
+/// This class handles the file header and the records. The derived
+/// classes @c BinaryLeaseFile4 and @c BinaryLeaseFile6 convert the leases
+/// to the records and back.
+class BinaryLeaseFile : public boost::noncopyable {
+public:
+
+    /// @brief Size of the file header.
+    static const size_t HEADER_SIZE = 12;
+
+    /// @brief Size of the record header.
+    static const size_t RECORD_HEADER_SIZE = 6;
+
+    /// @brief Version of the file format.
+    static const uint8_t FORMAT_VERSION = 2;
+
+    /// @brief Constructor.
+    ///
+    /// @param filename Path to the lease file.
+    /// @param universe Universe of the leases held in the file: 4 or 6.
+    BinaryLeaseFile(const std::string& filename, const uint8_t universe);
+
+    /// @brief Destructor.
+    ///
+    /// Closes the file.
+    virtual ~BinaryLeaseFile();
+
+    /// @brief Checks if the file holds the binary lease file header.
+    ///
+    /// It is used to tell the binary lease files from the CSV lease files.
+    ///
+    /// @param filename Path to the file.
+    /// @return true if the file exists and starts with the binary lease
+    /// file magic, false otherwise.
+    static bool isBinary(const std::string& filename);
+
+    /// @brief Opens the lease file.
+    ///
+    /// If the file doesn't exist or is empty, the file is created and the
+    /// header is written. Otherwise, the header is validated.
+    ///
+    /// @param seek_to_end A boolean value which indicates if the records
+    /// are not going to be read, i.e. the file is opened only to append
+    /// the records.
+    ///
+    /// @throw BinaryLeaseFileError if the file can't be opened or its
+    /// header is invalid.
+    virtual void open(const bool seek_to_end = false);
+
+    /// @brief Closes the lease file.
+    ///
+    /// It is allowed to close the file multiple times.
+    void close();
+
+    /// @brief Writes the data of the lease file to the storage device.
+    ///
+    /// When this method returns, the records appended to the file survive
+    /// a crash of the system.
+    ///
+    /// @throw BinaryLeaseFileError if the file is not open or the data
+    /// can't be written.
+    void sync();
+
+    /// @brief Returns a descriptor for syncing the lease file.
+    ///
+    /// The data of the file may then be written to the storage device
+    /// with @c isc::util::CSVFile::syncDescriptor without accessing this
+    /// object, e.g. while other threads append records to the file or
+    /// close it.
+    ///
+    /// @return Duplicate of the file descriptor. The caller is responsible
+    /// for closing it.
+    /// @throw BinaryLeaseFileError if the file is not open or the
+    /// descriptor can't be duplicated.
+    int dupSyncDescriptor() const;
+
+    /// @brief Checks if the lease file exists.
+    bool exists() const;
+
+    /// @brief Returns the path to the lease file.
+    std::string getFilename() const {
+        return (filename_);
+    }
+
+    /// @brief Returns the description of the last error when reading.
+    std::string getReadMsg() const {
+        return (read_msg_);
+    }
+
+protected:
+
+    /// @brief Returns the buffer in which the new record is encoded.
+    ///
+    /// The returned buffer holds the space for the record header. The
+    /// derived class appends the data to the buffer and calls
+    /// @c appendRecord.
+    util::OutputBuffer& startRecord();
+
+    /// @brief Appends the record encoded in the buffer to the file.
+    ///
+    /// Sets the length and the checksum of the record and writes it to
+    /// the file with a single write.
+    ///
+    /// @throw BinaryLeaseFileError if the file is not open, the record is
+    /// too long or the write fails.
+    void appendRecord();
+
+    /// @brief Reads the next record from the file.
+    ///
+    /// @param [out] data Pointer to the data of the record or NULL when
+    /// the end of file has been reached. The pointer remains valid until
+    /// the next read.
+    /// @param [out] length Length of the data.
+    ///
+    /// @return true if the record has been read or the end of file has
+    /// been reached, false if the record is invalid. The description of
+    /// the error may be obtained with @c getReadMsg.
+    bool nextRecord(const uint8_t*& data, size_t& length);
+
+    /// @brief Sets the description of the last error when reading.
+    ///
+    /// @param read_msg Description of the error.
+    void setReadMsg(const std::string& read_msg) {
+        read_msg_ = read_msg;
+    }
+
+    /// @name Methods encoding and decoding the values common for the
+    /// DHCPv4 and DHCPv6 leases.
+    //@{
+    /// @brief Writes the time as a 64-bit value.
+    ///
+    /// @param buffer Buffer in which the record is encoded.
+    /// @param value Time to be written.
+    static void writeTime(util::OutputBuffer& buffer, const time_t value);
+
+    /// @brief Reads the time written by @c writeTime.
+    ///
+    /// @param buffer Buffer holding the record.
+    static time_t readTime(util::InputBuffer& buffer);
+
+    /// @brief Writes the HW address type, length and value.
+    ///
+    /// @param buffer Buffer in which the record is encoded.
+    /// @param hwaddr Pointer to the HW address or NULL, in which case
+    /// the empty address is written.
+    static void writeHWAddr(util::OutputBuffer& buffer,
+                            const HWAddrPtr& hwaddr);
+
+    /// @brief Reads the HW address written by @c writeHWAddr.
+    ///
+    /// @param buffer Buffer holding the record.
+    /// @return Pointer to the HW address or NULL if it is empty.
+    static HWAddrPtr readHWAddr(util::InputBuffer& buffer);
+
+    /// @brief Writes the length of the string (2 bytes) and the string.
+    ///
+    /// @param buffer Buffer in which the record is encoded.
+    /// @param value String to be written.
+    static void writeString(util::OutputBuffer& buffer,
+                            const std::string& value);
+
+    /// @brief Reads the string written by @c writeString.
+    ///
+    /// @param buffer Buffer holding the record.
+    static std::string readString(util::InputBuffer& buffer);
+    //@}
+
+private:
+
+    /// @brief Handles the incomplete record at the end of the file.
+    ///
+    /// Must be called after @c fill has failed, i.e. when the read buffer
+    /// holds all data remaining in the file. Marks the remaining data
+    /// to be removed before the next record is appended.
+    ///
+    /// @param read_msg Description of the error.
+    /// @throw BinaryLeaseFileError if the remaining data end with a valid
+    /// record or a record has been skipped.
+    void setIncomplete(const std::string& read_msg);
+
+    /// @brief Checks if the data remaining in the read buffer end with
+    /// a valid record.
+    bool endsWithRecord() const;
+
+    /// @brief Reads the data from the file to the read buffer, so as the
+    /// buffer holds at least the specified number of bytes.
+    ///
+    /// @param length Number of bytes required.
+    /// @return false if the file doesn't hold enough data.
+    bool fill(const size_t length);
+
+    /// @brief Path to the lease file.
+    std::string filename_;
+
+    /// @brief Universe of the leases in the file.
+    uint8_t universe_;
+
+    /// @brief Descriptor of the open file or -1.
+    int fd_;
+
+    /// @brief Buffer used to encode the records.
+    util::OutputBuffer record_;
+
+    /// @brief Buffer holding the data read from the file.
+    std::vector<uint8_t> read_buf_;
+
+    /// @brief Position of the first unconsumed byte in the read buffer.
+    size_t read_pos_;
+
+    /// @brief Position following the last byte read to the read buffer.
+    size_t read_end_;
+
+    /// @brief Size of the file, including the records appended.
+    off_t size_;
+
+    /// @brief Offset in the file following the last complete record read.
+    off_t valid_end_;
+
+    /// @brief Indicates that the file ends with an incomplete record.
+    bool truncated_;
+
+    /// @brief Indicates that a record has been skipped when reading.
+    bool skipped_;
+
+    /// @brief Description of the last error when reading.
+    std::string read_msg_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // BINARY_LEASE_FILE_H
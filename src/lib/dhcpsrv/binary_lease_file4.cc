@@ -0,0 +1,149 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/binary_lease_file4.h>
+
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::util;
+
+namespace isc {
+namespace dhcp {
+
+BinaryLeaseFile4::BinaryLeaseFile4(const std::string& filename)
+    : BinaryLeaseFile(filename, 4) {
+}
+
+void
+BinaryLeaseFile4::open(const bool seek_to_end) {
+    // Call the base class to open the file
+    BinaryLeaseFile::open(seek_to_end);
+
+    // and clear any statistics we may have
+    clearStatistics();
+}
+
+void
+BinaryLeaseFile4::append(const Lease4& lease) {
+    // Bump the number of write attempts
+    ++writes_;
+
+    if (!lease.hwaddr_) {
+        // Bump the error counter
+        ++write_errs_;
+
+        isc_throw(BadValue, "Lease4 must have hardware address specified.");
+    }
+
+    try {
+        OutputBuffer& buffer = startRecord();
+        buffer.writeUint32(static_cast<uint32_t>(lease.addr_));
+        writeHWAddr(buffer, lease.hwaddr_);
+        // Client id may be unset (NULL).
+        if (lease.client_id_) {
+            const std::vector<uint8_t>& client_id =
+                lease.client_id_->getClientId();
+            buffer.writeUint8(static_cast<uint8_t>(client_id.size()));
+            buffer.writeData(&client_id[0], client_id.size());
+        } else {
+            buffer.writeUint8(0);
+        }
+        buffer.writeUint32(lease.valid_lft_);
+        writeTime(buffer, lease.cltt_);
+        buffer.writeUint32(lease.subnet_id_);
+        buffer.writeUint8((lease.fqdn_fwd_ ? 1 : 0) |
+                          (lease.fqdn_rev_ ? 2 : 0));
+        writeString(buffer, lease.hostname_);
+
+        appendRecord();
+
+    } catch (const std::exception& ex) {
+        // Catch any errors so we can bump the error counter than rethrow it
+        ++write_errs_;
+        throw;
+    }
+
+    // Bump the number of leases written
+    ++write_leases_;
+}
+
+bool
+BinaryLeaseFile4::next(Lease4Ptr& lease) {
+    // Bump the number of read attempts
+    ++reads_;
+
+    try {
+        const uint8_t* data = NULL;
+        size_t length = 0;
+        if (!nextRecord(data, length)) {
+            ++read_errs_;
+            lease.reset();
+            return (false);
+        }
+        // The NULL data signals EOF.
+        if (data == NULL) {
+            lease.reset();
+            return (true);
+        }
+
+        InputBuffer buffer(data, length);
+        const IOAddress address(buffer.readUint32());
+        HWAddrPtr hwaddr = readHWAddr(buffer);
+        if (!hwaddr) {
+            isc_throw(BadValue, "lease record lacks the HW address");
+        }
+        std::vector<uint8_t> client_id;
+        const uint8_t client_id_len = buffer.readUint8();
+        if (client_id_len > 0) {
+            buffer.readVector(client_id, client_id_len);
+        }
+        const uint32_t valid_lft = buffer.readUint32();
+        const time_t cltt = readTime(buffer);
+        const SubnetID subnet_id = buffer.readUint32();
+        const uint8_t flags = buffer.readUint8();
+        const std::string hostname = readString(buffer);
+
+        lease.reset(new Lease4(address, hwaddr,
+                               client_id.empty() ? NULL : &client_id[0],
+                               client_id.size(), valid_lft,
+                               0, 0, // t1, t2 = 0
+                               cltt, subnet_id, (flags & 1) != 0,
+                               (flags & 2) != 0, hostname));
+
+    } catch (const BinaryLeaseFileError&) {
+        // The file is corrupted, so it can't be read any further.
+        ++read_errs_;
+        lease.reset();
+        throw;
+
+    } catch (const std::exception& ex) {
+        // bump the read error count
+        ++read_errs_;
+
+        // The lease might have been created, so let's set it back to NULL to
+        // signal that lease hasn't been parsed.
+        lease.reset();
+        setReadMsg(ex.what());
+        return (false);
+    }
+
+    // bump the number of leases read
+    ++read_leases_;
+
+    return (true);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,155 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/binary_lease_file6.h>
+
+#include <vector>
+
+using namespace isc::asiolink;
+using namespace isc::util;
+
+namespace isc {
+namespace dhcp {
+
+BinaryLeaseFile6::BinaryLeaseFile6(const std::string& filename)
+    : BinaryLeaseFile(filename, 6) {
+}
+
+void
+BinaryLeaseFile6::open(const bool seek_to_end) {
+    // Call the base class to open the file
+    BinaryLeaseFile::open(seek_to_end);
+
+    // and clear any statistics we may have
+    clearStatistics();
+}
+
+void
+BinaryLeaseFile6::append(const Lease6& lease) {
+    // Bump the number of write attempts
+    ++writes_;
+
+    if (!lease.duid_) {
+        // Bump the error counter
+        ++write_errs_;
+
+        isc_throw(BadValue, "Lease6 must have DUID specified.");
+    }
+
+    try {
+        OutputBuffer& buffer = startRecord();
+        const std::vector<uint8_t> address = lease.addr_.toBytes();
+        buffer.writeData(&address[0], address.size());
+        buffer.writeUint8(static_cast<uint8_t>(lease.type_));
+        const std::vector<uint8_t>& duid = lease.duid_->getDuid();
+        buffer.writeUint8(static_cast<uint8_t>(duid.size()));
+        if (!duid.empty()) {
+            buffer.writeData(&duid[0], duid.size());
+        }
+        buffer.writeUint32(lease.iaid_);
+        buffer.writeUint32(lease.preferred_lft_);
+        buffer.writeUint32(lease.valid_lft_);
+        writeTime(buffer, lease.cltt_);
+        buffer.writeUint32(lease.subnet_id_);
+        buffer.writeUint8(lease.prefixlen_);
+        buffer.writeUint8((lease.fqdn_fwd_ ? 1 : 0) |
+                          (lease.fqdn_rev_ ? 2 : 0));
+        writeString(buffer, lease.hostname_);
+        // We may not have hardware information
+        writeHWAddr(buffer, lease.hwaddr_);
+
+        appendRecord();
+
+    } catch (const std::exception& ex) {
+        // Catch any errors so we can bump the error counter than rethrow it
+        ++write_errs_;
+        throw;
+    }
+
+    // Bump the number of leases written
+    ++write_leases_;
+}
+
+bool
+BinaryLeaseFile6::next(Lease6Ptr& lease) {
+    // Bump the number of read attempts
+    ++reads_;
+
+    try {
+        const uint8_t* data = NULL;
+        size_t length = 0;
+        if (!nextRecord(data, length)) {
+            ++read_errs_;
+            lease.reset();
+            return (false);
+        }
+        // The NULL data signals EOF.
+        if (data == NULL) {
+            lease.reset();
+            return (true);
+        }
+
+        InputBuffer buffer(data, length);
+        uint8_t address[16];
+        buffer.readData(address, sizeof(address));
+        const uint8_t type = buffer.readUint8();
+        if (type > Lease::TYPE_PD) {
+            isc_throw(BadValue, "invalid lease type "
+                      << static_cast<int>(type));
+        }
+        std::vector<uint8_t> duid;
+        buffer.readVector(duid, buffer.readUint8());
+        const uint32_t iaid = buffer.readUint32();
+        const uint32_t preferred_lft = buffer.readUint32();
+        const uint32_t valid_lft = buffer.readUint32();
+        const time_t cltt = readTime(buffer);
+        const SubnetID subnet_id = buffer.readUint32();
+        const uint8_t prefixlen = buffer.readUint8();
+        const uint8_t flags = buffer.readUint8();
+        const std::string hostname = readString(buffer);
+        HWAddrPtr hwaddr = readHWAddr(buffer);
+
+        lease.reset(new Lease6(static_cast<Lease::Type>(type),
+                               IOAddress::fromBytes(AF_INET6, address),
+                               DuidPtr(new DUID(duid)), iaid, preferred_lft,
+                               valid_lft, 0, 0, // t1, t2 = 0
+                               subnet_id, (flags & 1) != 0, (flags & 2) != 0,
+                               hostname, hwaddr, prefixlen));
+        lease->cltt_ = cltt;
+
+    } catch (const BinaryLeaseFileError&) {
+        // The file is corrupted, so it can't be read any further.
+        ++read_errs_;
+        lease.reset();
+        throw;
+
+    } catch (const std::exception& ex) {
+        // bump the read error count
+        ++read_errs_;
+
+        // The lease might have been created, so let's set it back to NULL to
+        // signal that lease hasn't been parsed.
+        lease.reset();
+        setReadMsg(ex.what());
+        return (false);
+    }
+
+    // bump the number of leases read
+    ++read_leases_;
+
+    return (true);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
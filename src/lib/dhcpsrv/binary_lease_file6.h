@@ -0,0 +1,90 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef BINARY_LEASE_FILE6_H
+#define BINARY_LEASE_FILE6_H
+
+#include <dhcpsrv/binary_lease_file.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/lease_file_stats.h>
+#include <string>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Provides methods to access the binary file with DHCPv6 leases.
+///
+/// This class is an alternative to the @c CSVLeaseFile6. It provides the
+/// same methods used by the @c LeaseFileLoader and the @c Memfile_LeaseMgr
+/// to read and write the leases.
+///
+/// Each record holds the following values of the lease:
+/// - address (16 bytes),
+/// - lease type (1 byte),
+/// - DUID length (1 byte) and value,
+/// - IAID (4 bytes),
+/// - preferred lifetime (4 bytes),
+/// - valid lifetime (4 bytes),
+/// - cltt (8 bytes),
+/// - subnet id (4 bytes),
+/// - prefix length (1 byte),
+/// - flags (1 byte): FQDN forward (bit 0) and reverse (bit 1) updates,
+/// - hostname length (2 bytes) and value,
+/// - HW address type (2 bytes), length (1 byte) and value, which may be
+///   empty.
+class BinaryLeaseFile6 : public BinaryLeaseFile, public LeaseFileStats {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param filename Name of the lease file.
+    BinaryLeaseFile6(const std::string& filename);
+
+    /// @brief Opens a lease file.
+    ///
+    /// This function calls the base class open to do the work of opening
+    /// a file and clears the statistics associated with any previous use
+    /// of the file.
+    ///
+    /// @param seek_to_end A boolean value which indicates if the file is
+    /// opened only to append leases.
+    virtual void open(const bool seek_to_end = false);
+
+    /// @brief Appends the lease record to the file.
+    ///
+    /// @param lease Structure representing a DHCPv6 lease.
+    /// @throw BadValue if the lease has no DUID.
+    /// @throw BinaryLeaseFileError if the record can't be written.
+    void append(const Lease6& lease);
+
+    /// @brief Reads next lease from the file.
+    ///
+    /// If this function hits an error during lease read, it sets the error
+    /// message which may be read using @c getReadMsg and returns false.
+    ///
+    /// @param [out] lease Pointer to the lease read from the file or
+    /// NULL pointer if the end of file has been reached.
+    ///
+    /// @return Boolean value indicating that the new lease has been
+    /// read from the file (if true), or that the error has occurred
+    /// (false).
+    /// @throw BinaryLeaseFileError if the file is corrupted, so as the
+    /// remaining leases can't be read.
+    bool next(Lease6Ptr& lease);
+};
+
+} // namespace isc::dhcp
+} // namespace isc
+
+#endif // BINARY_LEASE_FILE6_H
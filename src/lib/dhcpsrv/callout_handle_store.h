@@ -17,6 +17,12 @@
 
 #include <hooks/hooks_manager.h>
 #include <hooks/callout_handle.h>
+#include <util/threads/sync.h>
+
+#include <map>
+#include <utility>
+
+#include <pthread.h>
 
 namespace isc {
 namespace dhcp {
@@ -27,23 +33,22 @@ namespace dhcp {
 /// isc::hooks::CalloutHandle object with each request passing through the
 /// server.  For the DHCP servers, the association is provided by this function.
 ///
-/// The DHCP servers process a single request at a time. At points where the
-/// CalloutHandle is required, the pointer to the current request (packet) is
-/// passed to this function.  If the request is a new one, a pointer to
-/// the request is stored, a new CalloutHandle is allocated (and stored) and
-/// a pointer to the latter object returned to the caller.  If the request
-/// matches the one stored, the pointer to the stored CalloutHandle is
-/// returned.
+/// Each thread of the DHCP server processes a single request at a time. At
+/// points where the CalloutHandle is required, the pointer to the current
+/// request (packet) is passed to this function.  If the request is a new one
+/// for the calling thread, a pointer to the request is stored, a new
+/// CalloutHandle is allocated (and stored) and a pointer to the latter object
+/// returned to the caller.  If the request matches the one stored for the
+/// calling thread, the pointer to the stored CalloutHandle is returned.
 ///
 /// A special case is a null pointer being passed.  This has the effect of
-/// clearing the stored pointers to the packet being processed and
-/// CalloutHandle.  As the stored pointers are shared pointers, clearing them
-/// removes one reference that keeps the pointed-to objects in existence.
+/// clearing the stored pointers to the packet being processed by the calling
+/// thread and CalloutHandle.  As the stored pointers are shared pointers,
+/// clearing them removes one reference that keeps the pointed-to objects in
+/// existence.
 ///
-/// @note If the behaviour of the server changes so that multiple packets can
-///       be active at the same time, this simplistic approach will no longer
-///       be adequate and a more complicated structure (such as a map) will
-///       be needed.
+/// The pointers are stored in a map indexed by the thread identifier, so as
+/// the packets can be processed by multiple threads concurrently.
 ///
 /// @param pktptr Pointer to the packet being processed.  This is typically a
 ///        Pkt4Ptr or Pkt6Ptr object.  An empty pointer is passed to clear
@@ -57,32 +62,36 @@ namespace dhcp {
 template <typename T>
 isc::hooks::CalloutHandlePtr getCalloutHandle(const T& pktptr) {
 
+    // Pointer to last packet seen and pointer to stored handle.
+    typedef std::pair<T, isc::hooks::CalloutHandlePtr> StoredData;
+    typedef std::map<pthread_t, StoredData> StoredDataMap;
+
     // Stored data is declared static, so is initialized when first accessed
-    static T stored_pointer;                // Pointer to last packet seen
-    static isc::hooks::CalloutHandlePtr stored_handle;
-                                            // Pointer to stored handle
+    static isc::util::thread::Mutex mutex;
+    static StoredDataMap stored_data;
+
+    isc::util::thread::Mutex::Locker locker(mutex);
 
     if (pktptr) {
 
         // Pointer given, have we seen it before? (If we have, we don't need to
         // do anything as we will automatically return the stored handle.)
-        if (pktptr != stored_pointer) {
+        StoredData& stored = stored_data[pthread_self()];
+        if (pktptr != stored.first) {
 
             // Not seen before, so store the pointer passed to us and get a new
             // CalloutHandle.  (The latter operation frees and probably deletes
             // (depending on other pointers) the stored one.)
-            stored_pointer = pktptr;
-            stored_handle = isc::hooks::HooksManager::createCalloutHandle();
+            stored.first = pktptr;
+            stored.second = isc::hooks::HooksManager::createCalloutHandle();
         }
-        
-    } else {
+        return (stored.second);
 
-        // Empty pointer passed, clear stored data
-        stored_pointer.reset();
-        stored_handle.reset();
     }
 
-    return (stored_handle);
+    // Empty pointer passed, clear stored data
+    stored_data.erase(pthread_self());
+    return (isc::hooks::CalloutHandlePtr());
 }
 
 } // namespace shcp
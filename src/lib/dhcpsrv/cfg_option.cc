@@ -16,9 +16,21 @@
 #include <dhcpsrv/cfg_option.h>
 #include <boost/lexical_cast.hpp>
 #include <dhcp/dhcp6.h>
+#include <util/buffer.h>
+#include <algorithm>
 #include <limits>
 #include <string>
 
+namespace {
+
+/// @brief Orders the packed options by the option code.
+bool
+packedOptionLess(const isc::dhcp::PackedOption& option, const uint16_t code) {
+    return (option.code_ < code);
+}
+
+}
+
 namespace isc {
 namespace dhcp {
 
@@ -28,7 +40,8 @@ OptionDescriptor::equals(const OptionDescriptor& other) const {
             option_->equals(other.option_));
 }
 
-CfgOption::CfgOption() {
+CfgOption::CfgOption()
+    : packed_(false) {
 }
 
 bool
@@ -48,6 +61,7 @@ CfgOption::add(const OptionPtr& option, const bool persistent,
                   << option_space << "'");
     }
 
+    clearPackedOptions();
     const uint32_t vendor_id = optionSpaceToVendorId(option_space);
     if (vendor_id) {
         vendor_options_.addItem(OptionDescriptor(option, persistent),
@@ -59,6 +73,7 @@ CfgOption::add(const OptionPtr& option, const bool persistent,
 
 void
 CfgOption::mergeTo(CfgOption& other) const {
+    other.clearPackedOptions();
     // Merge non-vendor options.
     mergeInternal(options_, other.options_);
     // Merge vendor options.
@@ -75,12 +90,93 @@ CfgOption::copyTo(CfgOption& other) const {
 
 void
 CfgOption::encapsulate() {
+    clearPackedOptions();
     // Append sub-options to the top level "dhcp4" option space.
     encapsulateInternal(DHCP4_OPTION_SPACE);
     // Append sub-options to the top level "dhcp6" option space.
     encapsulateInternal(DHCP6_OPTION_SPACE);
 }
 
+void
+CfgOption::packOptions() {
+    packOptionsInternal(DHCP4_OPTION_SPACE, packed4_);
+    packOptionsInternal(DHCP6_OPTION_SPACE, packed6_);
+    packed_ = true;
+}
+
+void
+CfgOption::packOptionsInternal(const std::string& option_space,
+                               std::vector<PackedOption>& packed) const {
+    packed.clear();
+
+    // Get the codes of all options in the option space.
+    std::vector<uint16_t> codes;
+    OptionContainerPtr options = getAll(option_space);
+    for (OptionContainer::const_iterator opt = options->begin();
+         opt != options->end(); ++opt) {
+        if (opt->option_) {
+            codes.push_back(opt->option_->getType());
+        }
+    }
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+
+    // Pack the option which would be returned by get() for each code.
+    packed.resize(codes.size());
+    for (size_t i = 0; i < codes.size(); ++i) {
+        packed[i].code_ = codes[i];
+        packed[i].option_ = get(option_space, codes[i]).option_;
+        try {
+            isc::util::OutputBuffer buf(0);
+            packed[i].option_->pack(buf);
+            const uint8_t* data = static_cast<const uint8_t*>(buf.getData());
+            packed[i].wire_.reset(new OptionBuffer(data,
+                                                   data + buf.getLength()));
+        } catch (const std::exception&) {
+            // The option will be packed when the response is packed,
+            // which reports the error.
+            packed[i].wire_.reset();
+        }
+    }
+}
+
+PackedOption
+CfgOption::getPackedOption(const std::string& option_space,
+                           const uint16_t option_code) const {
+    const std::vector<PackedOption>* packed = NULL;
+    if (packed_) {
+        if (option_space == DHCP4_OPTION_SPACE) {
+            packed = &packed4_;
+        } else if (option_space == DHCP6_OPTION_SPACE) {
+            packed = &packed6_;
+        }
+    }
+
+    if (!packed) {
+        PackedOption option;
+        option.code_ = option_code;
+        option.option_ = get(option_space, option_code).option_;
+        return (option);
+    }
+
+    std::vector<PackedOption>::const_iterator option =
+        std::lower_bound(packed->begin(), packed->end(), option_code,
+                         packedOptionLess);
+    if ((option == packed->end()) || (option->code_ != option_code)) {
+        PackedOption none;
+        none.code_ = option_code;
+        return (none);
+    }
+    return (*option);
+}
+
+void
+CfgOption::clearPackedOptions() {
+    packed_ = false;
+    packed4_.clear();
+    packed6_.clear();
+}
+
 void
 CfgOption::encapsulateInternal(const std::string& option_space) {
     // Get all options for the particular option space.
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <string>
 #include <set>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -169,6 +170,31 @@ typedef std::pair<OptionContainerTypeIndex::const_iterator,
 /// Type of the index #2 - option persistency flag.
 typedef OptionContainer::nth_index<2>::type OptionContainerPersistIndex;
 
+/// @brief Option with its wire format.
+///
+/// The options of the top level option spaces are packed when the server
+/// configuration is committed, so as the responses to the clients can be
+/// built by copying the packed data. See @c CfgOption::packOptions.
+struct PackedOption {
+    /// @brief Constructor.
+    PackedOption()
+        : code_(0), option_(), wire_() {
+    }
+
+    /// @brief Option code.
+    uint16_t code_;
+
+    /// @brief Option instance held by the configuration.
+    ///
+    /// It is NULL if the option has not been configured.
+    OptionPtr option_;
+
+    /// @brief Wire format of the option, including the option header.
+    ///
+    /// It is NULL if the option has not been packed.
+    OptionBufferPtr wire_;
+};
+
 /// @brief Represents option data configuration for the DHCP server.
 ///
 /// This class holds a collection of options to be sent to a DHCP client.
@@ -281,6 +307,31 @@ public:
     /// options from this option space are appended to top-level options.
     void encapsulate();
 
+    /// @brief Packs the top-level options.
+    ///
+    /// This method packs the options of the "dhcp4" and "dhcp6" option
+    /// spaces and keeps their wire format, indexed by the option code.
+    /// It is called when the configuration is committed, after the
+    /// encapsulated options have been appended. Adding or merging the
+    /// options discards the packed options, but the options held by the
+    /// configuration must not be modified in place once they are packed.
+    void packOptions();
+
+    /// @brief Returns an option with its wire format.
+    ///
+    /// If the options have been packed with @c packOptions and the option
+    /// space is "dhcp4" or "dhcp6", the option is looked up by the code in
+    /// the packed options. Otherwise, the option is returned by @c get and
+    /// its wire format is NULL.
+    ///
+    /// @param option_space Name of the option space.
+    /// @param option_code Code of the option to be returned.
+    ///
+    /// @return Option with its wire format. The option is NULL if it has
+    /// not been found.
+    PackedOption getPackedOption(const std::string& option_space,
+                                 const uint16_t option_code) const;
+
     /// @brief Returns all options for the specified option space.
     ///
     /// This method will not return vendor options, i.e. having option space
@@ -367,6 +418,16 @@ private:
     /// which encapsulated options are appended.
     void encapsulateInternal(const std::string& option_space);
 
+    /// @brief Packs the options of an option space.
+    ///
+    /// @param option_space Name of the option space.
+    /// @param [out] packed Packed options sorted by option code.
+    void packOptionsInternal(const std::string& option_space,
+                             std::vector<PackedOption>& packed) const;
+
+    /// @brief Discards the packed options.
+    void clearPackedOptions();
+
     /// @brief Merges data from two option containers.
     ///
     /// This method merges options from one option container to another
@@ -397,6 +458,15 @@ private:
                                  uint32_t> VendorOptionSpaceCollection;
     /// @brief Container holding options grouped by vendor id.
     VendorOptionSpaceCollection vendor_options_;
+
+    /// @brief Indicates that the top-level options have been packed.
+    bool packed_;
+
+    /// @brief Packed options of the "dhcp4" option space.
+    std::vector<PackedOption> packed4_;
+
+    /// @brief Packed options of the "dhcp6" option space.
+    std::vector<PackedOption> packed6_;
 };
 
 /// @name Pointers to the @c CfgOption objects.
@@ -15,6 +15,8 @@
 #include <dhcp/iface_mgr.h>
 #include <dhcpsrv/cfg_subnets4.h>
 #include <dhcpsrv/dhcpsrv_log.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/stats_mgr.h>
 #include <dhcpsrv/subnet_id.h>
 
 using namespace isc::asiolink;
@@ -43,6 +45,69 @@ CfgSubnets4::add(const Subnet4Ptr& subnet) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_ADD_SUBNET4)
               .arg(subnet->toText());
     subnets_.push_back(subnet);
+    index_.clear();
+}
+
+void
+CfgSubnets4::buildIndex() {
+    index_.build(subnets_);
+}
+
+void
+CfgSubnets4::packOptions() {
+    for (Subnet4Collection::const_iterator subnet = subnets_.begin();
+         subnet != subnets_.end(); ++subnet) {
+        (*subnet)->getCfgOption()->packOptions();
+    }
+}
+
+void
+CfgSubnets4::updateStatistics() {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    LeaseMgr::LeaseCounts counts;
+    assigned_addresses_.clear();
+    for (Subnet4Collection::const_iterator subnet = subnets_.begin();
+         subnet != subnets_.end(); ++subnet) {
+        const SubnetID id = (*subnet)->getID();
+        stats_mgr.setValue(StatsMgr::generateName("subnet", id,
+                                                  "total-addresses"),
+                           (*subnet)->getPoolCapacity(Lease::TYPE_V4));
+        assigned_addresses_[id] =
+            stats_mgr.getCounter(StatsMgr::generateName("subnet", id,
+                                                        "assigned-addresses"),
+                                 StatsCounter::GAUGE);
+        counts[id] = 0;
+    }
+
+    // The leases of all subnets are counted at once.
+    if (LeaseMgrFactory::haveInstance()) {
+        LeaseMgrFactory::instance().countLeases4(counts);
+        for (LeaseMgr::LeaseCounts::const_iterator count = counts.begin();
+             count != counts.end(); ++count) {
+            assigned_addresses_[count->first]->set(count->second);
+        }
+    }
+}
+
+StatsCounterPtr
+CfgSubnets4::getAssignedAddresses(const SubnetID& subnet_id) const {
+    std::map<SubnetID, StatsCounterPtr>::const_iterator stat =
+        assigned_addresses_.find(subnet_id);
+    return (stat == assigned_addresses_.end() ? StatsCounterPtr() :
+            stat->second);
+}
+
+void
+CfgSubnets4::removeStatistics() const {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    for (Subnet4Collection::const_iterator subnet = subnets_.begin();
+         subnet != subnets_.end(); ++subnet) {
+        const SubnetID id = (*subnet)->getID();
+        stats_mgr.remove(StatsMgr::generateName("subnet", id,
+                                                "total-addresses"));
+        stats_mgr.remove(StatsMgr::generateName("subnet", id,
+                                                "assigned-addresses"));
+    }
 }
 
 Subnet4Ptr
@@ -52,7 +117,17 @@ CfgSubnets4::selectSubnet(const SubnetSelector& selector) const {
     // address will not match with any of the relay addresses accross all
     // subnets, but we need to verify that for all subnets before we can try
     // to use the giaddr to match with the subnet prefix.
-    if (selector.giaddr_ != ZERO_ADDRESS) {
+    if ((selector.giaddr_ != ZERO_ADDRESS) && index_.isBuilt()) {
+        const SubnetIndex::Positions& positions =
+            index_.getByRelay(selector.giaddr_);
+        for (SubnetIndex::Positions::const_iterator pos = positions.begin();
+             pos != positions.end(); ++pos) {
+            if (subnets_[*pos]->clientSupported(selector.client_classes_)) {
+                return (subnets_[*pos]);
+            }
+        }
+
+    } else if (selector.giaddr_ != ZERO_ADDRESS) {
         for (Subnet4Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -115,6 +190,18 @@ CfgSubnets4::selectSubnet(const SubnetSelector& selector) const {
 Subnet4Ptr
 CfgSubnets4::selectSubnet(const IOAddress& address,
                  const ClientClasses& client_classes) const {
+    if (index_.isBuilt()) {
+        SubnetIndex::Positions positions;
+        index_.getByAddress(address, positions);
+        for (SubnetIndex::Positions::const_iterator pos = positions.begin();
+             pos != positions.end(); ++pos) {
+            if (subnets_[*pos]->clientSupported(client_classes)) {
+                return (subnets_[*pos]);
+            }
+        }
+        return (Subnet4Ptr());
+    }
+
     for (Subnet4Collection::const_iterator subnet = subnets_.begin();
          subnet != subnets_.end(); ++subnet) {
 
@@ -16,9 +16,13 @@
 #define CFG_SUBNETS4_H
 
 #include <asiolink/io_address.h>
+#include <dhcpsrv/stats_mgr.h>
 #include <dhcpsrv/subnet.h>
+#include <dhcpsrv/subnet_id.h>
+#include <dhcpsrv/subnet_index.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <boost/shared_ptr.hpp>
+#include <map>
 
 namespace isc {
 namespace dhcp {
@@ -33,17 +37,65 @@ namespace dhcp {
 ///
 /// See @c CfgSubnets4::selectSubnet documentation for more details on how the
 /// subnet is selected for the client.
+///
+/// The subnet selection uses the index of subnets built with
+/// @c CfgSubnets4::buildIndex when the configuration is committed. If the
+/// index hasn't been built, e.g. the configuration is being created, all
+/// subnets are scanned.
 class CfgSubnets4 {
 public:
 
     /// @brief Adds new subnet to the configuration.
     ///
+    /// The subnet selection index is cleared and must be rebuilt.
+    ///
     /// @param subnet Pointer to the subnet being added.
     ///
     /// @throw isc::DuplicateSubnetID If the subnet id for the new subnet
     /// duplicates id of an existing subnet.
     void add(const Subnet4Ptr& subnet);
 
+    /// @brief Builds the index used for the subnet selection.
+    ///
+    /// This method is called when the configuration is committed. The
+    /// index reflects the prefixes and relay addresses of the subnets at
+    /// the time it is built, so it must be rebuilt if they are modified.
+    void buildIndex();
+
+    /// @brief Packs the options of the subnets.
+    ///
+    /// This method is called when the configuration is committed, so as
+    /// the responses are built with the packed options. See
+    /// @c CfgOption::packOptions.
+    void packOptions();
+
+    /// @brief Initializes the statistics of the subnets.
+    ///
+    /// Sets the "total-addresses" statistic of each subnet to the number
+    /// of addresses in its pools. If the lease database is available, the
+    /// "assigned-addresses" statistic is set to the number of leases in
+    /// the subnet. The allocation engine keeps the latter up to date when
+    /// the leases are assigned and released. This method is called when
+    /// the configuration is committed.
+    ///
+    /// The pointers to the "assigned-addresses" statistics are held by
+    /// this object, so as they are not looked up by name for each lease.
+    void updateStatistics();
+
+    /// @brief Returns the "assigned-addresses" statistic of the subnet.
+    ///
+    /// @param subnet_id Identifier of the subnet.
+    /// @return Pointer to the statistic, or NULL if the subnet doesn't
+    /// belong to this configuration or @c updateStatistics hasn't been
+    /// called.
+    StatsCounterPtr getAssignedAddresses(const SubnetID& subnet_id) const;
+
+    /// @brief Removes the statistics of the subnets.
+    ///
+    /// This method is called for the configuration being replaced, so as
+    /// the statistics of the removed subnets are no longer reported.
+    void removeStatistics() const;
+
     /// @brief Returns pointer to the collection of all IPv4 subnets.
     ///
     /// This is used in a hook (subnet4_select), where the hook is able
@@ -84,13 +136,9 @@ public:
     ///
     /// If the address matches with a subnet, the subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfils the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// If the index has been built, the subnets are found using the index
+    /// by the relay address and by the prefix, so this method doesn't need
+    /// to iterate over all subnets.
     ///
     /// @param selector Const reference to the selector structure which holds
     /// various information extracted from the client's packet which are used
@@ -108,14 +156,6 @@ public:
     /// testing. This method is also called by the
     /// @c selectSubnet(SubnetSelector).
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfils
-    /// the search criteria. The subnet storage is implemented as a simple
-    /// STL vector which precludes fast searches using specific keys.
-    /// Hence, full scan is required. To improve the search performance a
-    /// different container type is required, e.g. multi-index container,
-    /// or something of a similar functionality.
-    ///
     /// @param address Address for which the subnet is searched.
     /// @param client_classes Optional parameter specifying the classes that
     /// the client belongs to.
@@ -138,6 +178,12 @@ private:
     /// @brief A container for IPv4 subnets.
     Subnet4Collection subnets_;
 
+    /// @brief Index of the subnets used for the subnet selection.
+    SubnetIndex index_;
+
+    /// @brief "assigned-addresses" statistics by subnet identifier.
+    std::map<SubnetID, StatsCounterPtr> assigned_addresses_;
+
 };
 
 /// @name Pointer to the @c CfgSubnets4 objects.
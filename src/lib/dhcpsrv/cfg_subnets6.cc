@@ -32,6 +32,20 @@ CfgSubnets6::add(const Subnet6Ptr& subnet) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_ADD_SUBNET6)
               .arg(subnet->toText());
     subnets_.push_back(subnet);
+    index_.clear();
+}
+
+void
+CfgSubnets6::buildIndex() {
+    index_.build(subnets_);
+}
+
+void
+CfgSubnets6::packOptions() {
+    for (Subnet6Collection::const_iterator subnet = subnets_.begin();
+         subnet != subnets_.end(); ++subnet) {
+        (*subnet)->getCfgOption()->packOptions();
+    }
 }
 
 Subnet6Ptr
@@ -78,6 +92,34 @@ CfgSubnets6::selectSubnet(const asiolink::IOAddress& address,
                           const ClientClasses& client_classes,
                           const bool is_relay_address) const {
 
+    if (index_.isBuilt()) {
+        if (is_relay_address) {
+            const SubnetIndex::Positions& positions = index_.getByRelay(address);
+            for (SubnetIndex::Positions::const_iterator pos = positions.begin();
+                 pos != positions.end(); ++pos) {
+                if (subnets_[*pos]->clientSupported(client_classes)) {
+                    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                              DHCPSRV_CFGMGR_SUBNET6_RELAY)
+                        .arg(subnets_[*pos]->toText()).arg(address.toText());
+                    return (subnets_[*pos]);
+                }
+            }
+        }
+
+        SubnetIndex::Positions positions;
+        index_.getByAddress(address, positions);
+        for (SubnetIndex::Positions::const_iterator pos = positions.begin();
+             pos != positions.end(); ++pos) {
+            if (subnets_[*pos]->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                          DHCPSRV_CFGMGR_SUBNET6)
+                    .arg(subnets_[*pos]->toText()).arg(address.toText());
+                return (subnets_[*pos]);
+            }
+        }
+        return (Subnet6Ptr());
+    }
+
     // If the specified address is a relay address we first need to match
     // it with the relay addresses specified for all subnets.
     if (is_relay_address) {
@@ -118,8 +160,20 @@ Subnet6Ptr
 CfgSubnets6::selectSubnet(const std::string& iface_name,
                           const ClientClasses& client_classes) const {
 
+    if (!iface_name.empty() && index_.isBuilt()) {
+        const SubnetIndex::Positions& positions = index_.getByIface(iface_name);
+        for (SubnetIndex::Positions::const_iterator pos = positions.begin();
+             pos != positions.end(); ++pos) {
+            if (subnets_[*pos]->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                          DHCPSRV_CFGMGR_SUBNET6_IFACE)
+                    .arg(subnets_[*pos]->toText()).arg(iface_name);
+                return (subnets_[*pos]);
+            }
+        }
+
     // If empty interface specified, we can't select subnet by interface.
-    if (!iface_name.empty()) {
+    } else if (!iface_name.empty()) {
         for (Subnet6Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -146,7 +200,23 @@ CfgSubnets6::selectSubnet(const OptionPtr& interface_id,
                           const ClientClasses& client_classes) const {
     // We can only select subnet using an interface id, if the interface
     // id is known.
-    if (interface_id) {
+    if (interface_id && index_.isBuilt()) {
+        // The index matches the option data only, so we need to compare
+        // the options.
+        const SubnetIndex::Positions& positions =
+            index_.getByInterfaceId(interface_id);
+        for (SubnetIndex::Positions::const_iterator pos = positions.begin();
+             pos != positions.end(); ++pos) {
+            if (subnets_[*pos]->getInterfaceId()->equals(interface_id) &&
+                subnets_[*pos]->clientSupported(client_classes)) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                      DHCPSRV_CFGMGR_SUBNET6_IFACE_ID)
+                    .arg(subnets_[*pos]->toText());
+                return (subnets_[*pos]);
+            }
+        }
+
+    } else if (interface_id) {
         for (Subnet6Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
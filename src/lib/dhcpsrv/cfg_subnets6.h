@@ -18,6 +18,7 @@
 #include <asiolink/io_address.h>
 #include <dhcp/option.h>
 #include <dhcpsrv/subnet.h>
+#include <dhcpsrv/subnet_index.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <util/optional_value.h>
 #include <boost/shared_ptr.hpp>
@@ -34,17 +35,39 @@ namespace dhcp {
 ///
 /// See @c CfgSubnets6::selectSubnet documentation for more details on how the subnet
 /// is selected for the client.
+///
+/// The subnet selection uses the index of subnets built with
+/// @c CfgSubnets6::buildIndex when the configuration is committed. If the
+/// index hasn't been built, e.g. the configuration is being created, all
+/// subnets are scanned.
 class CfgSubnets6 {
 public:
 
     /// @brief Adds new subnet to the configuration.
     ///
+    /// The subnet selection index is cleared and must be rebuilt.
+    ///
     /// @param subnet Pointer to the subnet being added.
     ///
     /// @throw isc::DuplicateSubnetID If the subnet id for the new subnet
     /// duplicates id of an existing subnet.
     void add(const Subnet6Ptr& subnet);
 
+    /// @brief Builds the index used for the subnet selection.
+    ///
+    /// This method is called when the configuration is committed. The
+    /// index reflects the prefixes, relay addresses, interface names and
+    /// interface ids of the subnets at the time it is built, so it must be
+    /// rebuilt if they are modified.
+    void buildIndex();
+
+    /// @brief Packs the options of the subnets.
+    ///
+    /// This method is called when the configuration is committed, so as
+    /// the responses are built with the packed options. See
+    /// @c CfgOption::packOptions.
+    void packOptions();
+
     /// @brief Returns pointer to the collection of all IPv6 subnets.
     ///
     /// This is used in a hook (subnet6_select), where the hook is able
@@ -79,13 +102,8 @@ public:
     /// associated with any subnet. If not, it is checked if the link address
     /// is in range with any of the subnets.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfils the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// If the index has been built, the subnets are found using the index,
+    /// so this method doesn't need to iterate over all subnets.
     ///
     /// @param selector Const reference to the selector structure which holds
     /// various information extracted from the client's packet which are used
@@ -112,14 +130,6 @@ public:
     /// address. For other purposes the @c selectSubnet(SubnetSelector) should
     /// rather be used instead.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfils the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
-    ///
     /// @param address Address for which the subnet is searched.
     /// @param client_classes Optional parameter specifying the classes that
     /// the client belongs to.
@@ -140,14 +150,6 @@ private:
     /// If any of the subnets is explicitly associated with the interface
     /// name, the subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfils
-    /// the search criteria. The subnet storage is implemented as a
-    /// simple STL vector which precludes fast searches using specific
-    /// keys. Hence, full scan is required. To improve the search
-    /// performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
-    ///
     /// @param iface_name Interface name.
     /// @param client_classes Optional parameter specifying the classes that
     /// the client belongs to.
@@ -164,14 +166,6 @@ private:
     /// of the subnets is explicitly associated with that interface id, the
     /// subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfils
-    /// the search criteria. The subnet storage is implemented as a
-    /// simple STL vector which precludes fast searches using specific
-    /// keys. Hence, full scan is required. To improve the search
-    /// performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
-    ///
     /// @param interface_id An instance of the Interface ID option received
     /// from the client.
     /// @param client_classes Optional parameter specifying the classes that
@@ -193,6 +187,9 @@ private:
     /// @brief A container for IPv6 subnets.
     Subnet6Collection subnets_;
 
+    /// @brief Index of the subnets used for the subnet selection.
+    SubnetIndex index_;
+
 };
 
 /// @name Pointer to the @c CfgSubnets6 objects.
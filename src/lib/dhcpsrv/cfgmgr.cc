@@ -117,6 +117,19 @@ void
 CfgMgr::commit() {
     ensureCurrentAllocated();
     if (!configs_.back()->sequenceEquals(*configuration_)) {
+        // Build the subnet selection indexes before the configuration
+        // is in use.
+        configs_.back()->getCfgSubnets4()->buildIndex();
+        configs_.back()->getCfgSubnets6()->buildIndex();
+        // Pack the options sent to the clients, so as they are copied into
+        // the responses.
+        configs_.back()->getCfgOption()->packOptions();
+        configs_.back()->getCfgSubnets4()->packOptions();
+        configs_.back()->getCfgSubnets6()->packOptions();
+        // Replace the statistics of the subnets which are no longer in
+        // use with the statistics of the new subnets.
+        configuration_->getCfgSubnets4()->removeStatistics();
+        configs_.back()->getCfgSubnets4()->updateStatistics();
         configuration_ = configs_.back();
         // Keep track of the maximum size of the configs history. Before adding
         // new element, we have to remove the oldest one.
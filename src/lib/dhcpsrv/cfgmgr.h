@@ -202,7 +202,8 @@ public:
     /// The staging configuration becomes current configuration when this
     /// function is called. It removes the oldest configuration held in the
     /// history so as the size of the list of configuration does not exceed
-    /// the @c CONFIG_LIST_SIZE.
+    /// the @c CONFIG_LIST_SIZE. The indexes used for the subnet selection
+    /// are built for the new current configuration.
     ///
     /// This function is exception safe.
     void commit();
@@ -0,0 +1,418 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <dhcpsrv/compact_lease_storage.h>
+#include <exceptions/exceptions.h>
+
+#include <boost/tuple/tuple.hpp>
+
+#include <cstring>
+
+using namespace isc::asiolink;
+
+namespace isc {
+namespace dhcp {
+
+StringPool::StringPool()
+    : ids_(1, strings_.end()) {
+}
+
+uint32_t
+StringPool::add(const std::string& str) {
+    if (str.empty()) {
+        return (0);
+    }
+
+    std::pair<StringMap::iterator, bool> result =
+        strings_.insert(std::make_pair(str, std::make_pair(0, 0)));
+    std::pair<uint32_t, uint32_t>& entry = result.first->second;
+    ++entry.second;
+    if (result.second) {
+        if (free_ids_.empty()) {
+            entry.first = static_cast<uint32_t>(ids_.size());
+            ids_.push_back(result.first);
+        } else {
+            entry.first = free_ids_.back();
+            free_ids_.pop_back();
+            ids_[entry.first] = result.first;
+        }
+    }
+    return (entry.first);
+}
+
+void
+StringPool::release(const uint32_t id) {
+    if ((id == 0) || (id >= ids_.size()) || (ids_[id] == strings_.end())) {
+        return;
+    }
+    if (--ids_[id]->second.second == 0) {
+        strings_.erase(ids_[id]);
+        ids_[id] = strings_.end();
+        free_ids_.push_back(id);
+    }
+}
+
+const std::string&
+StringPool::get(const uint32_t id) const {
+    static const std::string empty;
+    if ((id == 0) || (id >= ids_.size()) || (ids_[id] == strings_.end())) {
+        return (empty);
+    }
+    return (ids_[id]->first);
+}
+
+size_t
+StringPool::size() const {
+    return (strings_.size());
+}
+
+HashedIdentifier
+CompactLease4Storage::Record::getClientId() const {
+    if (client_id_len_ <= INLINE_CLIENT_ID_LEN) {
+        return (HashedIdentifier(client_id_, client_id_len_, client_id_hash_));
+    }
+    // The longer client identifier is allocated separately and the record
+    // holds the pointer to it.
+    const uint8_t* data = NULL;
+    memcpy(&data, client_id_, sizeof(data));
+    return (HashedIdentifier(data, client_id_len_, client_id_hash_));
+}
+
+CompactLease4Storage::CompactLease4Storage()
+    : last_slab_used_(0) {
+}
+
+CompactLease4Storage::~CompactLease4Storage() {
+    clear();
+    for (size_t i = 0; i < slabs_.size(); ++i) {
+        delete[] slabs_[i];
+    }
+}
+
+CompactLease4Storage::const_iterator
+CompactLease4Storage::begin() const {
+    return (const_iterator(this, index_.get<0>().begin()));
+}
+
+CompactLease4Storage::const_iterator
+CompactLease4Storage::end() const {
+    return (const_iterator(this, index_.get<0>().end()));
+}
+
+CompactLease4Storage::const_iterator
+CompactLease4Storage::find(const IOAddress& addr) const {
+    if (!addr.isV4()) {
+        return (end());
+    }
+    return (const_iterator(this, index_.get<0>().find(static_cast<uint32_t>(addr))));
+}
+
+bool
+CompactLease4Storage::insert(const Lease4Ptr& lease) {
+    if (!lease->addr_.isV4()) {
+        isc_throw(BadValue, "address " << lease->addr_ << " of the lease"
+                  " is not an IPv4 address");
+    }
+    if (index_.get<0>().count(static_cast<uint32_t>(lease->addr_)) > 0) {
+        return (false);
+    }
+
+    Record* record = allocate();
+    try {
+        fill(*lease, *record);
+    } catch (...) {
+        deallocate(record);
+        throw;
+    }
+    index_.insert(record);
+    return (true);
+}
+
+void
+CompactLease4Storage::replace(const const_iterator& it,
+                              const Lease4Ptr& lease) {
+    // The new lease is stored in a new record, so as the replaced lease
+    // remains in the storage if the new lease can't be stored.
+    Record* record = allocate();
+    try {
+        fill(*lease, *record);
+    } catch (...) {
+        deallocate(record);
+        throw;
+    }
+    erase(it);
+    if (!index_.insert(record).second) {
+        release(*record);
+        deallocate(record);
+    }
+}
+
+void
+CompactLease4Storage::erase(const const_iterator& it) {
+    Record* record = *it.it_;
+    index_.get<0>().erase(it.it_);
+    release(*record);
+    deallocate(record);
+}
+
+void
+CompactLease4Storage::clear() {
+    for (AddressIndex::const_iterator it = index_.get<0>().begin();
+         it != index_.get<0>().end(); ++it) {
+        release(**it);
+        deallocate(*it);
+    }
+    index_.clear();
+}
+
+size_t
+CompactLease4Storage::size() const {
+    return (index_.size());
+}
+
+bool
+CompactLease4Storage::empty() const {
+    return (index_.empty());
+}
+
+Lease4Ptr
+CompactLease4Storage::getLease(const HWAddr& hwaddr,
+                               const SubnetID subnet_id) const {
+    const RecordIndex::nth_index<1>::type& idx = index_.get<1>();
+    const HashedIdentifier key(hwaddr.hwaddr_);
+    return (toLease(idx, idx.find(boost::make_tuple(key, subnet_id))));
+}
+
+Lease4Ptr
+CompactLease4Storage::getLease(const ClientId& client_id,
+                               const SubnetID subnet_id) const {
+    const RecordIndex::nth_index<2>::type& idx = index_.get<2>();
+    const HashedIdentifier key(client_id);
+    return (toLease(idx, idx.find(boost::make_tuple(key, subnet_id))));
+}
+
+Lease4Ptr
+CompactLease4Storage::getLease(const ClientId& client_id, const HWAddr& hwaddr,
+                               const SubnetID subnet_id) const {
+    const RecordIndex::nth_index<3>::type& idx = index_.get<3>();
+    const HashedIdentifier client_id_key(client_id);
+    const HashedIdentifier hwaddr_key(hwaddr.hwaddr_);
+    return (toLease(idx, idx.find(boost::make_tuple(client_id_key, hwaddr_key,
+                                                    subnet_id))));
+}
+
+void
+CompactLease4Storage::getLeases(const HWAddr& hwaddr,
+                                Lease4Collection& leases) const {
+    const HashedIdentifier key(hwaddr.hwaddr_);
+    for (AddressIndex::const_iterator it = index_.get<0>().begin();
+         it != index_.get<0>().end(); ++it) {
+        const Record& record = **it;
+        if ((record.flags_ & FLAG_HWADDR) && (record.htype_ == hwaddr.htype_) &&
+            (record.getHWAddr() == key)) {
+            leases.push_back(toLease(record));
+        }
+    }
+}
+
+void
+CompactLease4Storage::getLeases(const ClientId& client_id,
+                                Lease4Collection& leases) const {
+    const HashedIdentifier key(client_id);
+    for (AddressIndex::const_iterator it = index_.get<0>().begin();
+         it != index_.get<0>().end(); ++it) {
+        const Record& record = **it;
+        if ((record.flags_ & FLAG_CLIENT_ID) && (record.getClientId() == key)) {
+            leases.push_back(toLease(record));
+        }
+    }
+}
+
+void
+CompactLease4Storage::getLeases(const SubnetID subnet_id,
+                                Lease4Collection& leases) const {
+    for (AddressIndex::const_iterator it = index_.get<0>().begin();
+         it != index_.get<0>().end(); ++it) {
+        if ((*it)->subnet_id_ == subnet_id) {
+            leases.push_back(toLease(**it));
+        }
+    }
+}
+
+void
+CompactLease4Storage::countLeases(std::map<SubnetID, uint64_t>& counts) const {
+    for (std::map<SubnetID, uint64_t>::iterator count = counts.begin();
+         count != counts.end(); ++count) {
+        count->second = 0;
+    }
+    for (AddressIndex::const_iterator it = index_.get<0>().begin();
+         it != index_.get<0>().end(); ++it) {
+        std::map<SubnetID, uint64_t>::iterator count =
+            counts.find((*it)->subnet_id_);
+        if (count != counts.end()) {
+            ++count->second;
+        }
+    }
+}
+
+void
+CompactLease4Storage::getExpiredLeases(const int64_t now,
+                                       const size_t max_leases,
+                                       Lease4Collection& leases) const {
+    const RecordIndex::nth_index<4>::type& idx = index_.get<4>();
+    // The leases expiring at the specified time or later are not expired.
+    RecordIndex::nth_index<4>::type::const_iterator last = idx.lower_bound(now);
+    size_t count = 0;
+    for (RecordIndex::nth_index<4>::type::const_iterator it = idx.begin();
+         (it != last) && ((max_leases == 0) || (count < max_leases));
+         ++it, ++count) {
+        leases.push_back(toLease(**it));
+    }
+}
+
+size_t
+CompactLease4Storage::getRecordsSize() const {
+    return (slabs_.size() * SLAB_SIZE * sizeof(Record));
+}
+
+size_t
+CompactLease4Storage::getStringsCount() const {
+    return (strings_.size());
+}
+
+Lease4Ptr
+CompactLease4Storage::toLease(const Record& record) const {
+    Lease4Ptr lease(new Lease4());
+    lease->addr_ = IOAddress(record.addr_);
+    lease->t1_ = record.t1_;
+    lease->t2_ = record.t2_;
+    lease->valid_lft_ = record.valid_lft_;
+    lease->cltt_ = static_cast<time_t>(record.cltt_);
+    lease->subnet_id_ = record.subnet_id_;
+    lease->ext_ = record.ext_;
+    lease->fixed_ = (record.flags_ & FLAG_FIXED) != 0;
+    lease->fqdn_fwd_ = (record.flags_ & FLAG_FQDN_FWD) != 0;
+    lease->fqdn_rev_ = (record.flags_ & FLAG_FQDN_REV) != 0;
+    lease->hostname_ = strings_.get(record.hostname_);
+    lease->comments_ = strings_.get(record.comments_);
+    if (record.flags_ & FLAG_HWADDR) {
+        lease->hwaddr_.reset(new HWAddr(record.hwaddr_, record.hwaddr_len_,
+                                        record.htype_));
+        lease->hwaddr_->source_ = record.hwaddr_source_;
+    }
+    if (record.flags_ & FLAG_CLIENT_ID) {
+        const HashedIdentifier client_id = record.getClientId();
+        lease->client_id_.reset(new ClientId(client_id.data_,
+                                             client_id.len_));
+    }
+    return (lease);
+}
+
+void
+CompactLease4Storage::fill(const Lease4& lease, Record& record) {
+    record.addr_ = static_cast<uint32_t>(lease.addr_);
+    record.t1_ = lease.t1_;
+    record.t2_ = lease.t2_;
+    record.valid_lft_ = lease.valid_lft_;
+    record.cltt_ = static_cast<int64_t>(lease.cltt_);
+    record.subnet_id_ = lease.subnet_id_;
+    record.ext_ = lease.ext_;
+    record.flags_ = (lease.fixed_ ? FLAG_FIXED : 0) |
+        (lease.fqdn_fwd_ ? FLAG_FQDN_FWD : 0) |
+        (lease.fqdn_rev_ ? FLAG_FQDN_REV : 0);
+
+    record.htype_ = 0;
+    record.hwaddr_len_ = 0;
+    record.hwaddr_source_ = 0;
+    if (lease.hwaddr_) {
+        const std::vector<uint8_t>& hwaddr = lease.hwaddr_->hwaddr_;
+        if (hwaddr.size() > HWAddr::MAX_HWADDR_LEN) {
+            isc_throw(BadValue, "hardware address of the lease " << lease.addr_
+                      << " is too long");
+        }
+        record.flags_ |= FLAG_HWADDR;
+        record.htype_ = lease.hwaddr_->htype_;
+        record.hwaddr_source_ = lease.hwaddr_->source_;
+        record.hwaddr_len_ = static_cast<uint8_t>(hwaddr.size());
+        if (!hwaddr.empty()) {
+            memcpy(record.hwaddr_, &hwaddr[0], hwaddr.size());
+        }
+    }
+    record.hwaddr_hash_ = HashedIdentifier::hash(record.hwaddr_,
+                                                 record.hwaddr_len_);
+
+    record.client_id_len_ = 0;
+    record.client_id_hash_ = HashedIdentifier::hash(NULL, 0);
+    if (lease.client_id_) {
+        const std::vector<uint8_t>& client_id = lease.client_id_->getClientId();
+        if (client_id.size() > ClientId::MAX_CLIENT_ID_LEN) {
+            isc_throw(BadValue, "client identifier of the lease " << lease.addr_
+                      << " is too long");
+        }
+        record.flags_ |= FLAG_CLIENT_ID;
+        record.client_id_len_ = static_cast<uint8_t>(client_id.size());
+        record.client_id_hash_ =
+            static_cast<uint32_t>(lease.client_id_->getHash());
+        if (client_id.size() <= INLINE_CLIENT_ID_LEN) {
+            if (!client_id.empty()) {
+                memcpy(record.client_id_, &client_id[0], client_id.size());
+            }
+        } else {
+            uint8_t* data = new uint8_t[client_id.size()];
+            memcpy(data, &client_id[0], client_id.size());
+            memcpy(record.client_id_, &data, sizeof(data));
+        }
+    }
+
+    // The strings are added last, so as nothing needs to be released if
+    // the lease can't be stored.
+    record.hostname_ = strings_.add(lease.hostname_);
+    record.comments_ = strings_.add(lease.comments_);
+}
+
+void
+CompactLease4Storage::release(Record& record) {
+    strings_.release(record.hostname_);
+    strings_.release(record.comments_);
+    record.hostname_ = 0;
+    record.comments_ = 0;
+    if (record.client_id_len_ > INLINE_CLIENT_ID_LEN) {
+        delete[] record.getClientId().data_;
+    }
+    record.client_id_len_ = 0;
+}
+
+CompactLease4Storage::Record*
+CompactLease4Storage::allocate() {
+    // Reuse the records of the removed leases first.
+    if (!free_records_.empty()) {
+        Record* record = free_records_.back();
+        free_records_.pop_back();
+        return (record);
+    }
+    if (slabs_.empty() || (last_slab_used_ == SLAB_SIZE)) {
+        slabs_.push_back(new Record[SLAB_SIZE]);
+        last_slab_used_ = 0;
+    }
+    return (&slabs_.back()[last_slab_used_++]);
+}
+
+void
+CompactLease4Storage::deallocate(Record* record) {
+    free_records_.push_back(record);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
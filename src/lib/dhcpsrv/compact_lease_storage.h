@@ -0,0 +1,506 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#ifndef COMPACT_LEASE_STORAGE_H
+#define COMPACT_LEASE_STORAGE_H
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcp/hwaddr.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/memfile_lease_storage.h>
+#include <dhcpsrv/subnet_id.h>
+
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/indexed_by.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Pool of reference counted strings.
+///
+/// Each distinct string is held once, no matter how many objects refer
+/// to it. The strings are identified by numbers, which are smaller than
+/// the strings themselves. The number 0 identifies the empty string,
+/// which is not held in the pool.
+class StringPool : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    StringPool();
+
+    /// @brief Adds a reference to the string.
+    ///
+    /// @param str String.
+    /// @return Identifier of the string.
+    uint32_t add(const std::string& str);
+
+    /// @brief Removes a reference to the string.
+    ///
+    /// The string is removed from the pool when the last reference is
+    /// removed.
+    ///
+    /// @param id Identifier of the string returned by @c add.
+    void release(const uint32_t id);
+
+    /// @brief Returns the string.
+    ///
+    /// @param id Identifier of the string returned by @c add.
+    const std::string& get(const uint32_t id) const;
+
+    /// @brief Returns the number of distinct strings in the pool.
+    size_t size() const;
+
+private:
+
+    /// @brief Identifiers and numbers of references by the strings.
+    typedef std::map<std::string, std::pair<uint32_t, uint32_t> > StringMap;
+
+    /// @brief Identifiers and numbers of references of the strings.
+    StringMap strings_;
+
+    /// @brief Strings by identifiers.
+    ///
+    /// The element 0 refers to the end of @c strings_.
+    std::vector<StringMap::iterator> ids_;
+
+    /// @brief Identifiers of the removed strings to be reused.
+    std::vector<uint32_t> free_ids_;
+};
+
+/// @brief Memory efficient storage of the DHCPv4 leases.
+///
+/// The @c Lease4Storage holds the pointers to the @c Lease4 objects. Each
+/// lease is a separately allocated object with separately allocated
+/// hardware address, client identifier, strings and reference counters,
+/// so a few millions of leases take several hundreds of megabytes and
+/// the index lookups follow pointers to the scattered objects.
+///
+/// This storage holds each lease in a fixed size record. The records are
+/// allocated in the slabs of @c SLAB_SIZE records and the records of the
+/// removed leases are reused. The hardware address and the client
+/// identifier are held in the record, unless the client identifier is
+/// longer than @c INLINE_CLIENT_ID_LEN, in which case it is allocated
+/// separately. The hostnames and the comments are held in the
+/// @c StringPool. The indexes hold the pointers to the records and
+/// compare the data held in the records. The records hold the hashes of
+/// the HW address and the client identifier used by the hashed indexes.
+///
+/// The leases are converted to the @c Lease4 objects when they are
+/// returned by this storage. The iterators return the new copy of the
+/// lease each time they are dereferenced.
+///
+/// The storage provides the subset of the @c Lease4Storage interface
+/// used by the @c LeaseFileLoader, so the leases can be loaded to it from
+/// the lease files.
+class CompactLease4Storage : public boost::noncopyable {
+public:
+
+    /// @brief Number of records in a slab.
+    static const size_t SLAB_SIZE = 4096;
+
+    /// @brief Maximum length of the client identifier held in the record.
+    static const size_t INLINE_CLIENT_ID_LEN = 20;
+
+private:
+
+    /// @brief Fixed size record holding the lease.
+    struct Record {
+        /// @brief Returns the hardware address.
+        HashedIdentifier getHWAddr() const {
+            return (HashedIdentifier(hwaddr_, hwaddr_len_, hwaddr_hash_));
+        }
+
+        /// @brief Returns the client identifier.
+        HashedIdentifier getClientId() const;
+
+        /// @brief Returns the expiration time of the lease.
+        int64_t getExpirationTime() const {
+            return (cltt_ + valid_lft_);
+        }
+
+        /// @brief IPv4 address.
+        uint32_t addr_;
+
+        /// @brief Renewal timer.
+        uint32_t t1_;
+
+        /// @brief Rebinding timer.
+        uint32_t t2_;
+
+        /// @brief Valid lifetime.
+        uint32_t valid_lft_;
+
+        /// @brief Client last transmission time.
+        int64_t cltt_;
+
+        /// @brief Subnet identifier.
+        SubnetID subnet_id_;
+
+        /// @brief Address extended attributes.
+        uint32_t ext_;
+
+        /// @brief Identifier of the hostname in the string pool.
+        uint32_t hostname_;
+
+        /// @brief Identifier of the comments in the string pool.
+        uint32_t comments_;
+
+        /// @brief Source of the hardware address.
+        uint32_t hwaddr_source_;
+
+        /// @brief Hash of the hardware address.
+        uint32_t hwaddr_hash_;
+
+        /// @brief Hash of the client identifier.
+        uint32_t client_id_hash_;
+
+        /// @brief Hardware type.
+        uint16_t htype_;
+
+        /// @brief Length of the hardware address.
+        uint8_t hwaddr_len_;
+
+        /// @brief Length of the client identifier.
+        uint8_t client_id_len_;
+
+        /// @brief Combination of the @c Flags.
+        uint8_t flags_;
+
+        /// @brief Hardware address.
+        uint8_t hwaddr_[HWAddr::MAX_HWADDR_LEN];
+
+        /// @brief Client identifier or the pointer to the separately
+        /// allocated client identifier.
+        uint8_t client_id_[INLINE_CLIENT_ID_LEN];
+    };
+
+    /// @brief Index of the records.
+    ///
+    /// The records may be accessed using the same keys as the leases
+    /// in the @c Lease4Storage:
+    /// - IPv4 address,
+    /// - hashed composite index: HW address and subnet id,
+    /// - hashed composite index: client id and subnet id,
+    /// - hashed composite index: client id, HW address and subnet id,
+    /// - expiration time.
+    typedef boost::multi_index_container<
+        // It holds pointers to the records.
+        Record*,
+        boost::multi_index::indexed_by<
+            boost::multi_index::ordered_unique<
+                boost::multi_index::member<Record, uint32_t, &Record::addr_>
+            >,
+
+            boost::multi_index::hashed_non_unique<
+                boost::multi_index::composite_key<
+                    Record,
+                    boost::multi_index::const_mem_fun<Record, HashedIdentifier,
+                                                      &Record::getHWAddr>,
+                    boost::multi_index::member<Record, SubnetID,
+                                               &Record::subnet_id_>
+                >
+            >,
+
+            boost::multi_index::hashed_non_unique<
+                boost::multi_index::composite_key<
+                    Record,
+                    boost::multi_index::const_mem_fun<Record, HashedIdentifier,
+                                                      &Record::getClientId>,
+                    boost::multi_index::member<Record, SubnetID,
+                                               &Record::subnet_id_>
+                >
+            >,
+
+            boost::multi_index::hashed_non_unique<
+                boost::multi_index::composite_key<
+                    Record,
+                    boost::multi_index::const_mem_fun<Record, HashedIdentifier,
+                                                      &Record::getClientId>,
+                    boost::multi_index::const_mem_fun<Record, HashedIdentifier,
+                                                      &Record::getHWAddr>,
+                    boost::multi_index::member<Record, SubnetID,
+                                               &Record::subnet_id_>
+                >
+            >,
+
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::const_mem_fun<Record, int64_t,
+                                                  &Record::getExpirationTime>
+            >
+        >
+    > RecordIndex;
+
+    /// @brief Index of the records by address.
+    typedef RecordIndex::nth_index<0>::type AddressIndex;
+
+public:
+
+    /// @brief Iterator over the leases in the order of their addresses.
+    class const_iterator {
+    public:
+
+        /// @brief Constructor.
+        ///
+        /// @param storage Storage holding the leases.
+        /// @param it Iterator of the address index.
+        const_iterator(const CompactLease4Storage* storage,
+                       const AddressIndex::const_iterator& it)
+            : storage_(storage), it_(it) {
+        }
+
+        /// @brief Returns the copy of the lease.
+        Lease4Ptr operator*() const {
+            return (storage_->toLease(**it_));
+        }
+
+        /// @brief Advances to the next lease.
+        const_iterator& operator++() {
+            ++it_;
+            return (*this);
+        }
+
+        /// @brief Checks if the iterators point to the same lease.
+        bool operator==(const const_iterator& other) const {
+            return (it_ == other.it_);
+        }
+
+        /// @brief Checks if the iterators point to different leases.
+        bool operator!=(const const_iterator& other) const {
+            return (it_ != other.it_);
+        }
+
+    private:
+
+        friend class CompactLease4Storage;
+
+        /// @brief Storage holding the leases.
+        const CompactLease4Storage* storage_;
+
+        /// @brief Iterator of the address index.
+        AddressIndex::const_iterator it_;
+    };
+
+    /// @brief Iterator over the leases.
+    ///
+    /// The leases can't be modified through the iterators.
+    typedef const_iterator iterator;
+
+    /// @brief Constructor.
+    CompactLease4Storage();
+
+    /// @brief Destructor.
+    ~CompactLease4Storage();
+
+    /// @brief Returns the iterator pointing to the lease with the lowest
+    /// address.
+    const_iterator begin() const;
+
+    /// @brief Returns the iterator pointing past the lease with the
+    /// highest address.
+    const_iterator end() const;
+
+    /// @brief Searches the lease by address.
+    ///
+    /// @param addr Address of the lease.
+    /// @return Iterator pointing to the lease or @c end().
+    const_iterator find(const isc::asiolink::IOAddress& addr) const;
+
+    /// @brief Stores the lease.
+    ///
+    /// @param lease Pointer to the lease. The storage holds a copy of it.
+    /// @return false if the storage holds the lease for the same address,
+    /// true otherwise.
+    /// @throw BadValue if the lease address is not an IPv4 address.
+    bool insert(const Lease4Ptr& lease);
+
+    /// @brief Replaces the lease.
+    ///
+    /// @param it Iterator pointing to the lease.
+    /// @param lease Pointer to the new lease, which address must be the
+    /// same as the address of the replaced lease.
+    void replace(const const_iterator& it, const Lease4Ptr& lease);
+
+    /// @brief Removes the lease.
+    ///
+    /// @param it Iterator pointing to the lease.
+    void erase(const const_iterator& it);
+
+    /// @brief Removes all leases.
+    void clear();
+
+    /// @brief Returns the number of leases.
+    size_t size() const;
+
+    /// @brief Checks if the storage holds no leases.
+    bool empty() const;
+
+    /// @brief Returns the lease for the hardware address in the subnet.
+    ///
+    /// @param hwaddr Hardware address.
+    /// @param subnet_id Subnet identifier.
+    /// @return Copy of the lease or NULL.
+    Lease4Ptr getLease(const HWAddr& hwaddr, const SubnetID subnet_id) const;
+
+    /// @brief Returns the lease for the client identifier in the subnet.
+    ///
+    /// @param client_id Client identifier.
+    /// @param subnet_id Subnet identifier.
+    /// @return Copy of the lease or NULL.
+    Lease4Ptr getLease(const ClientId& client_id,
+                       const SubnetID subnet_id) const;
+
+    /// @brief Returns the lease for the client identifier and hardware
+    /// address in the subnet.
+    ///
+    /// @param client_id Client identifier.
+    /// @param hwaddr Hardware address.
+    /// @param subnet_id Subnet identifier.
+    /// @return Copy of the lease or NULL.
+    Lease4Ptr getLease(const ClientId& client_id, const HWAddr& hwaddr,
+                       const SubnetID subnet_id) const;
+
+    /// @brief Returns the leases for the hardware address in all subnets.
+    ///
+    /// The hardware type must match too.
+    ///
+    /// @param hwaddr Hardware address.
+    /// @param [out] leases Copies of the leases are appended to it.
+    void getLeases(const HWAddr& hwaddr, Lease4Collection& leases) const;
+
+    /// @brief Returns the leases for the client identifier in all subnets.
+    ///
+    /// @param client_id Client identifier.
+    /// @param [out] leases Copies of the leases are appended to it.
+    void getLeases(const ClientId& client_id, Lease4Collection& leases) const;
+
+    /// @brief Returns the leases in the subnet.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param [out] leases Copies of the leases are appended to it.
+    void getLeases(const SubnetID subnet_id, Lease4Collection& leases) const;
+
+    /// @brief Counts the leases in the subnets.
+    ///
+    /// @param [in,out] counts Map holding the identifiers of the subnets
+    /// for which the leases are counted. The numbers of leases in these
+    /// subnets are stored in the map.
+    void countLeases(std::map<SubnetID, uint64_t>& counts) const;
+
+    /// @brief Returns the leases which expired before the specified time.
+    ///
+    /// The leases are returned in the order of their expiration time.
+    ///
+    /// @param now Time at which the returned leases are expired.
+    /// @param max_leases Maximum number of leases to return or 0 for no
+    /// limit.
+    /// @param [out] leases Copies of the leases are appended to it.
+    void getExpiredLeases(const int64_t now, const size_t max_leases,
+                          Lease4Collection& leases) const;
+
+    /// @brief Returns the number of bytes allocated for the records.
+    ///
+    /// It doesn't include the index, the separately allocated client
+    /// identifiers and the strings.
+    size_t getRecordsSize() const;
+
+    /// @brief Returns the number of distinct strings in the string pool.
+    size_t getStringsCount() const;
+
+private:
+
+    /// @brief Flags of the record.
+    enum Flags {
+        /// The lease is a fixed lease.
+        FLAG_FIXED = 0x01,
+        /// The forward DNS update has been performed.
+        FLAG_FQDN_FWD = 0x02,
+        /// The reverse DNS update has been performed.
+        FLAG_FQDN_REV = 0x04,
+        /// The lease has the hardware address.
+        FLAG_HWADDR = 0x08,
+        /// The lease has the client identifier.
+        FLAG_CLIENT_ID = 0x10
+    };
+
+    /// @brief Returns the copy of the lease held in the record.
+    ///
+    /// @param record Record.
+    Lease4Ptr toLease(const Record& record) const;
+
+    /// @brief Returns the copy of the lease pointed to by the iterator of
+    /// any index or NULL if it is the end of the index.
+    ///
+    /// @param index Index.
+    /// @param it Iterator.
+    /// @tparam Index Type of the index.
+    template<typename Index>
+    Lease4Ptr toLease(const Index& index,
+                      const typename Index::const_iterator& it) const {
+        return (it == index.end() ? Lease4Ptr() : toLease(**it));
+    }
+
+    /// @brief Stores the lease in the record.
+    ///
+    /// @param lease Lease.
+    /// @param [out] record Record, which must be empty.
+    void fill(const Lease4& lease, Record& record);
+
+    /// @brief Releases the strings and the client identifier held by the
+    /// record.
+    ///
+    /// @param [out] record Record.
+    void release(Record& record);
+
+    /// @brief Returns the unused record.
+    Record* allocate();
+
+    /// @brief Releases the record and makes it available for reuse.
+    ///
+    /// @param record Pointer to the record.
+    void deallocate(Record* record);
+
+    /// @brief Index of the records.
+    RecordIndex index_;
+
+    /// @brief Slabs of the records.
+    std::vector<Record*> slabs_;
+
+    /// @brief Number of records handed out from the last slab.
+    size_t last_slab_used_;
+
+    /// @brief Records of the removed leases to be reused.
+    std::vector<Record*> free_records_;
+
+    /// @brief Hostnames and comments of the leases.
+    StringPool strings_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // COMPACT_LEASE_STORAGE_H
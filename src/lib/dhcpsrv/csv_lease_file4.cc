@@ -90,30 +90,7 @@ CSVLeaseFile4::next(Lease4Ptr& lease) {
             return (true);
         }
 
-        // Get client id. It is possible that the client id is empty and the
-        // returned pointer is NULL. This is ok, but if the client id is NULL,
-        // we need to be careful to not use the NULL pointer.
-        ClientIdPtr client_id = readClientId(row);
-        std::vector<uint8_t> client_id_vec;
-        if (client_id) {
-            client_id_vec = client_id->getClientId();
-        }
-        size_t client_id_len = client_id_vec.size();
-
-        // Get the HW address. It should never be empty and the readHWAddr checks
-        // that.
-        HWAddr hwaddr = readHWAddr(row);
-        lease.reset(new Lease4(readAddress(row),
-                               HWAddrPtr(new HWAddr(hwaddr)),
-                               client_id_vec.empty() ? NULL : &client_id_vec[0],
-                               client_id_len,
-                               readValid(row),
-                               0, 0, // t1, t2 = 0
-                               readCltt(row),
-                               readSubnetID(row),
-                               readFqdnFwd(row),
-                               readFqdnRev(row),
-                               readHostname(row)));
+        lease = parseLease(row);
 
     } catch (std::exception& ex) {
         // bump the read error count
@@ -132,6 +109,39 @@ CSVLeaseFile4::next(Lease4Ptr& lease) {
     return (true);
 }
 
+Lease4Ptr
+CSVLeaseFile4::parseLease(const CSVRow& row) const {
+    // The LeaseFileLoader parses the rows which haven't been validated
+    // when read, so check them here.
+    checkValuesCount(row);
+
+    // Get client id. It is possible that the client id is empty and the
+    // returned pointer is NULL. This is ok, but if the client id is NULL,
+    // we need to be careful to not use the NULL pointer.
+    ClientIdPtr client_id = readClientId(row);
+    std::vector<uint8_t> client_id_vec;
+    if (client_id) {
+        client_id_vec = client_id->getClientId();
+    }
+    size_t client_id_len = client_id_vec.size();
+
+    // Get the HW address. It should never be empty and the readHWAddr checks
+    // that.
+    HWAddr hwaddr = readHWAddr(row);
+    Lease4Ptr lease(new Lease4(readAddress(row),
+                               HWAddrPtr(new HWAddr(hwaddr)),
+                               client_id_vec.empty() ? NULL : &client_id_vec[0],
+                               client_id_len,
+                               readValid(row),
+                               0, 0, // t1, t2 = 0
+                               readCltt(row),
+                               readSubnetID(row),
+                               readFqdnFwd(row),
+                               readFqdnRev(row),
+                               readHostname(row)));
+    return (lease);
+}
+
 void
 CSVLeaseFile4::initColumns() {
     addColumn("address");
@@ -146,13 +156,13 @@ CSVLeaseFile4::initColumns() {
 }
 
 IOAddress
-CSVLeaseFile4::readAddress(const CSVRow& row) {
+CSVLeaseFile4::readAddress(const CSVRow& row) const {
     IOAddress address(row.readAt(getColumnIndex("address")));
     return (address);
 }
 
 HWAddr
-CSVLeaseFile4::readHWAddr(const CSVRow& row) {
+CSVLeaseFile4::readHWAddr(const CSVRow& row) const {
     HWAddr hwaddr = HWAddr::fromText(row.readAt(getColumnIndex("hwaddr")));
     if (hwaddr.hwaddr_.empty()) {
         isc_throw(isc::BadValue, "hardware address in the lease file"
@@ -162,7 +172,7 @@ CSVLeaseFile4::readHWAddr(const CSVRow& row) {
 }
 
 ClientIdPtr
-CSVLeaseFile4::readClientId(const CSVRow& row) {
+CSVLeaseFile4::readClientId(const CSVRow& row) const {
     std::string client_id = row.readAt(getColumnIndex("client_id"));
     // NULL client ids are allowed in DHCPv4.
     if (client_id.empty()) {
@@ -173,40 +183,40 @@ CSVLeaseFile4::readClientId(const CSVRow& row) {
 }
 
 uint32_t
-CSVLeaseFile4::readValid(const CSVRow& row) {
+CSVLeaseFile4::readValid(const CSVRow& row) const {
     uint32_t valid =
         row.readAndConvertAt<uint32_t>(getColumnIndex("valid_lifetime"));
     return (valid);
 }
 
 time_t
-CSVLeaseFile4::readCltt(const CSVRow& row) {
+CSVLeaseFile4::readCltt(const CSVRow& row) const {
     uint32_t cltt = row.readAndConvertAt<uint32_t>(getColumnIndex("expire"))
         - readValid(row);
     return (cltt);
 }
 
 SubnetID
-CSVLeaseFile4::readSubnetID(const CSVRow& row) {
+CSVLeaseFile4::readSubnetID(const CSVRow& row) const {
     SubnetID subnet_id =
         row.readAndConvertAt<SubnetID>(getColumnIndex("subnet_id"));
     return (subnet_id);
 }
 
 bool
-CSVLeaseFile4::readFqdnFwd(const CSVRow& row) {
+CSVLeaseFile4::readFqdnFwd(const CSVRow& row) const {
     bool fqdn_fwd = row.readAndConvertAt<bool>(getColumnIndex("fqdn_fwd"));
     return (fqdn_fwd);
 }
 
 bool
-CSVLeaseFile4::readFqdnRev(const CSVRow& row) {
+CSVLeaseFile4::readFqdnRev(const CSVRow& row) const {
     bool fqdn_rev = row.readAndConvertAt<bool>(getColumnIndex("fqdn_rev"));
     return (fqdn_rev);
 }
 
 std::string
-CSVLeaseFile4::readHostname(const CSVRow& row) {
+CSVLeaseFile4::readHostname(const CSVRow& row) const {
     std::string hostname = row.readAt(getColumnIndex("hostname"));
     return (hostname);
 }
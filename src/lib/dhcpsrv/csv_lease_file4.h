@@ -88,6 +88,21 @@ public:
     /// ticket http://kea.isc.org/ticket/2405 is implemented.
     bool next(Lease4Ptr& lease);
 
+    /// @brief Creates the lease from the values of the CSV row.
+    ///
+    /// This function is used by the @c next function and by the
+    /// @c LeaseFileLoader, which parses the rows of the lease file itself.
+    /// It doesn't modify the object, so it may be called by multiple
+    /// threads concurrently. It doesn't update the lease file statistics.
+    /// The row must hold a value for each column.
+    ///
+    /// @param row Row read from the lease file.
+    ///
+    /// @return Pointer to the new lease.
+    /// @throw isc::Exception or std::exception if the row doesn't hold
+    /// a valid lease.
+    Lease4Ptr parseLease(const util::CSVRow& row) const;
+
 private:
 
     /// @brief Initializes columns of the CSV file holding leases.
@@ -112,47 +127,47 @@ private:
     /// @brief Reads lease address from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    asiolink::IOAddress readAddress(const util::CSVRow& row);
+    asiolink::IOAddress readAddress(const util::CSVRow& row) const;
 
     /// @brief Reads HW address from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    HWAddr readHWAddr(const util::CSVRow& row);
+    HWAddr readHWAddr(const util::CSVRow& row) const;
 
     /// @brief Reads client identifier from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    ClientIdPtr readClientId(const util::CSVRow& row);
+    ClientIdPtr readClientId(const util::CSVRow& row) const;
 
     /// @brief Reads valid lifetime from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    uint32_t readValid(const util::CSVRow& row);
+    uint32_t readValid(const util::CSVRow& row) const;
 
     /// @brief Reads cltt value from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    time_t readCltt(const util::CSVRow& row);
+    time_t readCltt(const util::CSVRow& row) const;
 
     /// @brief Reads subnet id from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    SubnetID readSubnetID(const util::CSVRow& row);
+    SubnetID readSubnetID(const util::CSVRow& row) const;
 
     /// @brief Reads the FQDN forward flag from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    bool readFqdnFwd(const util::CSVRow& row);
+    bool readFqdnFwd(const util::CSVRow& row) const;
 
     /// @brief Reads the FQDN reverse flag from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    bool readFqdnRev(const util::CSVRow& row);
+    bool readFqdnRev(const util::CSVRow& row) const;
 
     /// @brief Reads hostname from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    std::string readHostname(const util::CSVRow& row);
+    std::string readHostname(const util::CSVRow& row) const;
     //@}
 
 };
@@ -89,16 +89,7 @@ CSVLeaseFile6::next(Lease6Ptr& lease) {
             return (true);
         }
 
-        lease.reset(new Lease6(readType(row), readAddress(row), readDUID(row),
-                               readIAID(row), readPreferred(row),
-                               readValid(row), 0, 0, // t1, t2 = 0
-                               readSubnetID(row),
-                               readHWAddr(row),
-                               readPrefixLen(row)));
-        lease->cltt_ = readCltt(row);
-        lease->fqdn_fwd_ = readFqdnFwd(row);
-        lease->fqdn_rev_ = readFqdnRev(row);
-        lease->hostname_ = readHostname(row);
+        lease = parseLease(row);
 
     } catch (std::exception& ex) {
         // bump the read error count
@@ -117,6 +108,28 @@ CSVLeaseFile6::next(Lease6Ptr& lease) {
     return (true);
 }
 
+Lease6Ptr
+CSVLeaseFile6::parseLease(const CSVRow& row) const {
+    // The LeaseFileLoader parses the rows which haven't been validated
+    // when read, so check them here. The rows written by Kea 0.9 lack
+    // the last, hwaddr column.
+    if (row.getValuesCount() != getColumnCount() - 1) {
+        checkValuesCount(row);
+    }
+
+    Lease6Ptr lease(new Lease6(readType(row), readAddress(row), readDUID(row),
+                               readIAID(row), readPreferred(row),
+                               readValid(row), 0, 0, // t1, t2 = 0
+                               readSubnetID(row),
+                               readHWAddr(row),
+                               readPrefixLen(row)));
+    lease->cltt_ = readCltt(row);
+    lease->fqdn_fwd_ = readFqdnFwd(row);
+    lease->fqdn_rev_ = readFqdnRev(row);
+    lease->hostname_ = readHostname(row);
+    return (lease);
+}
+
 void
 CSVLeaseFile6::initColumns() {
     addColumn("address");
@@ -135,83 +148,83 @@ CSVLeaseFile6::initColumns() {
 }
 
 Lease::Type
-CSVLeaseFile6::readType(const CSVRow& row) {
+CSVLeaseFile6::readType(const CSVRow& row) const {
     return (static_cast<Lease::Type>
             (row.readAndConvertAt<int>(getColumnIndex("lease_type"))));
 }
 
 IOAddress
-CSVLeaseFile6::readAddress(const CSVRow& row) {
+CSVLeaseFile6::readAddress(const CSVRow& row) const {
     IOAddress address(row.readAt(getColumnIndex("address")));
     return (address);
 }
 
 DuidPtr
-CSVLeaseFile6::readDUID(const util::CSVRow& row) {
+CSVLeaseFile6::readDUID(const util::CSVRow& row) const {
     DuidPtr duid(new DUID(DUID::fromText(row.readAt(getColumnIndex("duid")))));
     return (duid);
 }
 
 uint32_t
-CSVLeaseFile6::readIAID(const CSVRow& row) {
+CSVLeaseFile6::readIAID(const CSVRow& row) const {
     uint32_t iaid = row.readAndConvertAt<uint32_t>(getColumnIndex("iaid"));
     return (iaid);
 }
 
 uint32_t
-CSVLeaseFile6::readPreferred(const CSVRow& row) {
+CSVLeaseFile6::readPreferred(const CSVRow& row) const {
     uint32_t pref =
         row.readAndConvertAt<uint32_t>(getColumnIndex("pref_lifetime"));
     return (pref);
 }
 
 uint32_t
-CSVLeaseFile6::readValid(const CSVRow& row) {
+CSVLeaseFile6::readValid(const CSVRow& row) const {
     uint32_t valid =
         row.readAndConvertAt<uint32_t>(getColumnIndex("valid_lifetime"));
     return (valid);
 }
 
 uint32_t
-CSVLeaseFile6::readCltt(const CSVRow& row) {
+CSVLeaseFile6::readCltt(const CSVRow& row) const {
     uint32_t cltt = row.readAndConvertAt<uint32_t>(getColumnIndex("expire"))
         - readValid(row);
     return (cltt);
 }
 
 SubnetID
-CSVLeaseFile6::readSubnetID(const CSVRow& row) {
+CSVLeaseFile6::readSubnetID(const CSVRow& row) const {
     SubnetID subnet_id =
         row.readAndConvertAt<SubnetID>(getColumnIndex("subnet_id"));
     return (subnet_id);
 }
 
 uint8_t
-CSVLeaseFile6::readPrefixLen(const CSVRow& row) {
+CSVLeaseFile6::readPrefixLen(const CSVRow& row) const {
     int prefixlen = row.readAndConvertAt<int>(getColumnIndex("prefix_len"));
     return (static_cast<uint8_t>(prefixlen));
 }
 
 bool
-CSVLeaseFile6::readFqdnFwd(const CSVRow& row) {
+CSVLeaseFile6::readFqdnFwd(const CSVRow& row) const {
     bool fqdn_fwd = row.readAndConvertAt<bool>(getColumnIndex("fqdn_fwd"));
     return (fqdn_fwd);
 }
 
 bool
-CSVLeaseFile6::readFqdnRev(const CSVRow& row) {
+CSVLeaseFile6::readFqdnRev(const CSVRow& row) const {
     bool fqdn_rev = row.readAndConvertAt<bool>(getColumnIndex("fqdn_rev"));
     return (fqdn_rev);
 }
 
 std::string
-CSVLeaseFile6::readHostname(const CSVRow& row) {
+CSVLeaseFile6::readHostname(const CSVRow& row) const {
     std::string hostname = row.readAt(getColumnIndex("hostname"));
     return (hostname);
 }
 
 HWAddrPtr
-CSVLeaseFile6::readHWAddr(const CSVRow& row) {
+CSVLeaseFile6::readHWAddr(const CSVRow& row) const {
 
     try {
         const HWAddr& hwaddr = HWAddr::fromText(row.readAt(getColumnIndex("hwaddr")));
@@ -87,6 +87,22 @@ public:
     /// ticket http://kea.isc.org/ticket/2405 is implemented.
     bool next(Lease6Ptr& lease);
 
+    /// @brief Creates the lease from the values of the CSV row.
+    ///
+    /// This function is used by the @c next function and by the
+    /// @c LeaseFileLoader, which parses the rows of the lease file itself.
+    /// It doesn't modify the object, so it may be called by multiple
+    /// threads concurrently. It doesn't update the lease file statistics.
+    /// The row must hold a value for each column, but the hwaddr column
+    /// which the lease files written by Kea 0.9 lack.
+    ///
+    /// @param row Row read from the lease file.
+    ///
+    /// @return Pointer to the new lease.
+    /// @throw isc::Exception or std::exception if the row doesn't hold
+    /// a valid lease.
+    Lease6Ptr parseLease(const util::CSVRow& row) const;
+
 protected:
     /// @brief This function validates the header of the Lease6 CSV file.
     ///
@@ -127,68 +143,68 @@ private:
     /// @brief Reads lease type from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    Lease::Type readType(const util::CSVRow& row);
+    Lease::Type readType(const util::CSVRow& row) const;
 
     /// @brief Reads lease address from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    asiolink::IOAddress readAddress(const util::CSVRow& row);
+    asiolink::IOAddress readAddress(const util::CSVRow& row) const;
 
     /// @brief Reads DUID from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    DuidPtr readDUID(const util::CSVRow& row);
+    DuidPtr readDUID(const util::CSVRow& row) const;
 
     /// @brief Reads IAID from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    uint32_t readIAID(const util::CSVRow& row);
+    uint32_t readIAID(const util::CSVRow& row) const;
 
     /// @brief Reads preferred lifetime from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    uint32_t readPreferred(const util::CSVRow& row);
+    uint32_t readPreferred(const util::CSVRow& row) const;
 
     /// @brief Reads valid lifetime from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    uint32_t readValid(const util::CSVRow& row);
+    uint32_t readValid(const util::CSVRow& row) const;
 
     /// @brief Reads cltt value from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    uint32_t readCltt(const util::CSVRow& row);
+    uint32_t readCltt(const util::CSVRow& row) const;
 
     /// @brief Reads subnet id from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    SubnetID readSubnetID(const util::CSVRow& row);
+    SubnetID readSubnetID(const util::CSVRow& row) const;
 
     /// @brief Reads prefix length from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    uint8_t readPrefixLen(const util::CSVRow& row);
+    uint8_t readPrefixLen(const util::CSVRow& row) const;
 
     /// @brief Reads the FQDN forward flag from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    bool readFqdnFwd(const util::CSVRow& row);
+    bool readFqdnFwd(const util::CSVRow& row) const;
 
     /// @brief Reads the FQDN reverse flag from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    bool readFqdnRev(const util::CSVRow& row);
+    bool readFqdnRev(const util::CSVRow& row) const;
 
     /// @brief Reads hostname from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
-    std::string readHostname(const util::CSVRow& row);
+    std::string readHostname(const util::CSVRow& row) const;
 
     /// @brief Reads HW address from the CSV file row.
     ///
     /// @param row CSV file holding lease values.
     /// @return pointer to the HWAddr structure that was read
-    HWAddrPtr readHWAddr(const util::CSVRow& row);
+    HWAddrPtr readHWAddr(const util::CSVRow& row) const;
     //@}
 
 };
@@ -287,6 +287,9 @@ D2ClientMgr::stopSender() {
 
 void
 D2ClientMgr::sendRequest(dhcp_ddns::NameChangeRequestPtr& ncr) {
+    // The requests may be sent by multiple threads processing packets,
+    // while the IO is run by the main thread.
+    isc::util::thread::Mutex::Locker locker(mutex_);
     if (!amSending()) {
         // This is programmatic error so bust them for it.
         isc_throw(D2ClientError, "D2ClientMgr::sendRequest not in send mode");
@@ -386,6 +389,7 @@ D2ClientMgr::runReadyIO() {
                   " name_change_sender is null");
     }
 
+    isc::util::thread::Mutex::Locker locker(mutex_);
     name_change_sender_->runReadyIO();
 }
 
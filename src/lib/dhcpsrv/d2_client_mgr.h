@@ -23,6 +23,7 @@
 #include <dhcp_ddns/ncr_io.h>
 #include <dhcpsrv/d2_client_cfg.h>
 #include <exceptions/exceptions.h>
+#include <util/threads/sync.h>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
@@ -431,6 +432,12 @@ private:
 
     /// @brief Remembers the select-fd registered with IfaceMgr.
     int registered_select_fd_;
+
+    /// @brief Mutex serializing access to the sender queue.
+    ///
+    /// The requests are queued by the threads processing packets and
+    /// the IO is run by the main thread.
+    isc::util::thread::Mutex mutex_;
 };
 
 template <class T>
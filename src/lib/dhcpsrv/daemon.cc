@@ -19,6 +19,7 @@
 #include <cc/data.h>
 #include <boost/bind.hpp>
 #include <logging.h>
+#include <log/async_log_writer.h>
 #include <log/logger_name.h>
 #include <log/logger_support.h>
 #include <errno.h>
@@ -38,6 +39,8 @@ Daemon::Daemon()
 }
 
 Daemon::~Daemon() {
+    // Write the queued log messages while the logging is still set up.
+    isc::log::AsyncLogWriter::instance().stop();
 }
 
 void Daemon::init(const std::string& config_file) {
@@ -67,6 +70,13 @@ void Daemon::configureLogger(const isc::data::ConstElementPtr& log_config,
             LogConfigParser parser(storage);
             parser.parseConfiguration(loggers, CfgMgr::instance().isVerbose());
         }
+
+        isc::data::ConstElementPtr async_logging =
+            log_config->get("async-logging");
+        if (async_logging) {
+            LogConfigParser parser(storage);
+            parser.parseAsyncLogging(async_logging);
+        }
     }
 }
 
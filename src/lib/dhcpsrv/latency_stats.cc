@@ -0,0 +1,287 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <dhcpsrv/latency_stats.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace isc::data;
+using namespace boost::posix_time;
+
+namespace isc {
+namespace dhcp {
+
+const unsigned LatencyHistogram::SUB_BUCKETS;
+const unsigned LatencyHistogram::MAX_BIT;
+const unsigned LatencyHistogram::NUM_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void
+LatencyHistogram::record(const uint64_t value) {
+    __sync_fetch_and_add(&buckets_[getBucket(value)], 1);
+    __sync_fetch_and_add(&count_, 1);
+    __sync_fetch_and_add(&sum_, value);
+
+    uint64_t current = min_;
+    while ((value < current) &&
+           !__sync_bool_compare_and_swap(&min_, current, value)) {
+        current = min_;
+    }
+    current = max_;
+    while ((value > current) &&
+           !__sync_bool_compare_and_swap(&max_, current, value)) {
+        current = max_;
+    }
+}
+
+uint64_t
+LatencyHistogram::getCount() const {
+    return (count_);
+}
+
+uint64_t
+LatencyHistogram::getMin() const {
+    return (count_ > 0 ? min_ : 0);
+}
+
+uint64_t
+LatencyHistogram::getMax() const {
+    return (max_);
+}
+
+double
+LatencyHistogram::getMean() const {
+    const uint64_t count = count_;
+    return (count > 0 ? static_cast<double>(sum_) / count : 0);
+}
+
+uint64_t
+LatencyHistogram::getPercentile(const double percentile) const {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        total += buckets_[i];
+    }
+    if (total == 0) {
+        return (0);
+    }
+
+    // Find the bucket holding the value at the rank of the percentile.
+    uint64_t rank = static_cast<uint64_t>(percentile * total / 100 + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return (std::min(getBucketMax(i), getMax()));
+        }
+    }
+    return (getMax());
+}
+
+void
+LatencyHistogram::reset() {
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        buckets_[i] = 0;
+    }
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+ElementPtr
+LatencyHistogram::toElement() const {
+    ElementPtr map = Element::createMap();
+    map->set("count", Element::create(static_cast<long long int>(getCount())));
+    map->set("min", Element::create(static_cast<long long int>(getMin())));
+    map->set("mean", Element::create(getMean()));
+    map->set("max", Element::create(static_cast<long long int>(getMax())));
+    map->set("p50", Element::create(static_cast<long long int>
+                                    (getPercentile(50))));
+    map->set("p90", Element::create(static_cast<long long int>
+                                    (getPercentile(90))));
+    map->set("p99", Element::create(static_cast<long long int>
+                                    (getPercentile(99))));
+    map->set("p99.9", Element::create(static_cast<long long int>
+                                      (getPercentile(99.9))));
+    return (map);
+}
+
+unsigned
+LatencyHistogram::getBucket(const uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return (static_cast<unsigned>(value));
+    }
+    unsigned bit = 63 - __builtin_clzll(value);
+    if (bit > MAX_BIT) {
+        return (NUM_BUCKETS - 1);
+    }
+    // Keep the 4 most significant bits of the value. The value is then
+    // (sub_bucket << shift), where sub_bucket is in the range of SUB_BUCKETS
+    // to 2 * SUB_BUCKETS - 1.
+    const unsigned shift = bit - 3;
+    return (SUB_BUCKETS * shift + static_cast<unsigned>(value >> shift));
+}
+
+uint64_t
+LatencyHistogram::getBucketMax(const unsigned bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return (bucket);
+    }
+    if (bucket >= NUM_BUCKETS - 1) {
+        return (std::numeric_limits<uint64_t>::max());
+    }
+    const unsigned shift = bucket / SUB_BUCKETS - 1;
+    const uint64_t sub_bucket = bucket % SUB_BUCKETS + SUB_BUCKETS;
+    return (((sub_bucket + 1) << shift) - 1);
+}
+
+PacketLatencyStats::PacketLatencyStats(const TypeNames& type_names)
+    : other_(createHistograms("other")) {
+    for (TypeNames::const_iterator name = type_names.begin();
+         name != type_names.end(); ++name) {
+        histograms_[name->first] = createHistograms(name->second);
+    }
+}
+
+const char*
+PacketLatencyStats::stageToText(const Stage stage) {
+    switch (stage) {
+    case RECEIVE:
+        return ("receive");
+    case UNPACK:
+        return ("unpack");
+    case CLASSIFY:
+        return ("classify");
+    case ACCEPT:
+        return ("accept");
+    case RECEIVE_HOOKS:
+        return ("receive-hooks");
+    case SELECT_SUBNET:
+        return ("select-subnet");
+    case LEASE:
+        return ("lease");
+    case PROCESS:
+        return ("process");
+    case PACK:
+        return ("pack");
+    case SEND:
+        return ("send");
+    default:
+        ;
+    }
+    return ("total");
+}
+
+void
+PacketLatencyStats::record(const uint8_t type, const Pkt& pkt) {
+    const std::vector<ptime>& times = pkt.getStageTimes();
+    if (times.empty()) {
+        return;
+    }
+
+    const StageHistograms& histograms = getTypeHistograms(type).second;
+    ptime start = pkt.getTimestamp();
+    ptime last = start;
+    for (size_t stage = 0; (stage < times.size()) && (stage < NUM_STAGES);
+         ++stage) {
+        if (times[stage].is_not_a_date_time()) {
+            continue;
+        }
+        // If the packet has no timestamp, the first completed stage is
+        // the origin.
+        if (!last.is_not_a_date_time()) {
+            const int64_t elapsed = (times[stage] - last).total_microseconds();
+            histograms[stage]->record(elapsed > 0 ? elapsed : 0);
+        } else {
+            start = times[stage];
+        }
+        last = times[stage];
+    }
+
+    if (!start.is_not_a_date_time()) {
+        const int64_t total = (last - start).total_microseconds();
+        histograms[NUM_STAGES]->record(total > 0 ? total : 0);
+    }
+}
+
+const LatencyHistogram&
+PacketLatencyStats::getHistogram(const uint8_t type, const Stage stage) const {
+    return (*getTypeHistograms(type).second.at(stage));
+}
+
+void
+PacketLatencyStats::reset() {
+    for (std::map<uint8_t, TypeHistograms>::const_iterator type =
+             histograms_.begin(); type != histograms_.end(); ++type) {
+        for (size_t i = 0; i < type->second.second.size(); ++i) {
+            type->second.second[i]->reset();
+        }
+    }
+    for (size_t i = 0; i < other_.second.size(); ++i) {
+        other_.second[i]->reset();
+    }
+}
+
+ConstElementPtr
+PacketLatencyStats::toElement() const {
+    ElementPtr map = Element::createMap();
+    std::vector<const TypeHistograms*> types;
+    for (std::map<uint8_t, TypeHistograms>::const_iterator type =
+             histograms_.begin(); type != histograms_.end(); ++type) {
+        types.push_back(&type->second);
+    }
+    types.push_back(&other_);
+
+    for (size_t t = 0; t < types.size(); ++t) {
+        ElementPtr stages = Element::createMap();
+        const StageHistograms& histograms = types[t]->second;
+        for (size_t stage = 0; stage < histograms.size(); ++stage) {
+            if (histograms[stage]->getCount() > 0) {
+                stages->set(stageToText(static_cast<Stage>(stage)),
+                            histograms[stage]->toElement());
+            }
+        }
+        if (!stages->mapValue().empty()) {
+            map->set(types[t]->first, stages);
+        }
+    }
+    return (map);
+}
+
+PacketLatencyStats::TypeHistograms
+PacketLatencyStats::createHistograms(const std::string& name) {
+    StageHistograms histograms;
+    for (int i = 0; i <= NUM_STAGES; ++i) {
+        histograms.push_back(LatencyHistogramPtr(new LatencyHistogram()));
+    }
+    return (TypeHistograms(name, histograms));
+}
+
+const PacketLatencyStats::TypeHistograms&
+PacketLatencyStats::getTypeHistograms(const uint8_t type) const {
+    std::map<uint8_t, TypeHistograms>::const_iterator histograms =
+        histograms_.find(type);
+    return (histograms != histograms_.end() ? histograms->second : other_);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,301 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <cc/data.h>
+#include <dhcp/pkt.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Histogram of latencies expressed in microseconds.
+///
+/// The histogram has logarithmic buckets subdivided linearly, in the same
+/// way as the HDR histograms: the values below 16 have their own buckets
+/// and each power of two above is divided into 8 buckets. Therefore, the
+/// value of a bucket is within 12.5% of the recorded values. The values
+/// above about 12 days are recorded in the last bucket.
+///
+/// The values are recorded with atomic operations, so multiple threads
+/// may record them concurrently without a lock. The statistics returned
+/// while the values are being recorded may be slightly inconsistent.
+class LatencyHistogram : public boost::noncopyable {
+public:
+
+    /// @brief Number of buckets in each power of two.
+    static const unsigned SUB_BUCKETS = 8;
+
+    /// @brief Most significant bit of the largest recorded value.
+    static const unsigned MAX_BIT = 39;
+
+    /// @brief Number of buckets.
+    static const unsigned NUM_BUCKETS = SUB_BUCKETS * (MAX_BIT - 1);
+
+    /// @brief Constructor.
+    ///
+    /// Creates an empty histogram.
+    LatencyHistogram();
+
+    /// @brief Records the value.
+    ///
+    /// @param value Latency in microseconds.
+    void record(const uint64_t value);
+
+    /// @brief Returns the number of recorded values.
+    uint64_t getCount() const;
+
+    /// @brief Returns the smallest recorded value or 0 if the histogram
+    /// is empty.
+    uint64_t getMin() const;
+
+    /// @brief Returns the largest recorded value.
+    uint64_t getMax() const;
+
+    /// @brief Returns the mean of the recorded values or 0 if the histogram
+    /// is empty.
+    double getMean() const;
+
+    /// @brief Returns the value below or at which the specified percentage
+    /// of the recorded values falls.
+    ///
+    /// @param percentile Percentage in the range of 0 to 100.
+    /// @return Highest value of the bucket in which the percentile falls,
+    /// limited to the largest recorded value, or 0 if the histogram is
+    /// empty.
+    uint64_t getPercentile(const double percentile) const;
+
+    /// @brief Removes all recorded values.
+    void reset();
+
+    /// @brief Returns the summary of the histogram.
+    ///
+    /// @return Map holding the "count", "min", "mean", "max" and the 50th,
+    /// 90th, 99th and 99.9th percentiles ("p50", "p90", "p99", "p99.9"),
+    /// in microseconds.
+    isc::data::ElementPtr toElement() const;
+
+    /// @brief Returns the index of the bucket for the value.
+    ///
+    /// @param value Recorded value.
+    static unsigned getBucket(const uint64_t value);
+
+    /// @brief Returns the highest value recorded in the bucket.
+    ///
+    /// @param bucket Index of the bucket.
+    static uint64_t getBucketMax(const unsigned bucket);
+
+private:
+
+    /// @brief Numbers of values recorded in each bucket.
+    uint64_t buckets_[NUM_BUCKETS];
+
+    /// @brief Number of recorded values.
+    uint64_t count_;
+
+    /// @brief Sum of the recorded values.
+    uint64_t sum_;
+
+    /// @brief Smallest recorded value.
+    uint64_t min_;
+
+    /// @brief Largest recorded value.
+    uint64_t max_;
+};
+
+/// @brief Pointer to the latency histogram.
+typedef boost::shared_ptr<LatencyHistogram> LatencyHistogramPtr;
+
+/// @brief Histograms of the time spent by the packets in the processing
+/// stages.
+///
+/// The server enables the recording of the stage times in the received
+/// packet with @c Pkt::enableStageTimes and records the time at which
+/// the packet completes each stage with @c Pkt::setStageTime. When the
+/// packet has been processed, the times are passed to
+/// @c PacketLatencyStats::record. The time spent in a stage is the time
+/// elapsed since the completion of the previous stage. The first stage
+/// starts when the packet has been read from the socket (the packet's
+/// timestamp). The stages which the packet hasn't gone through are
+/// skipped, i.e. their time is accounted to the next completed stage.
+///
+/// Separate histograms are held for each message type, including the
+/// histogram of the total processing time.
+class PacketLatencyStats : public boost::noncopyable {
+public:
+
+    /// @brief Packet processing stages.
+    enum Stage {
+        /// Waiting for processing after the packet has been read from the
+        /// socket, e.g. in the queue of the thread pool.
+        RECEIVE,
+        /// Callouts for buffer receive and parsing of the packet.
+        UNPACK,
+        /// Classification of the packet.
+        CLASSIFY,
+        /// Checks whether the packet should be processed.
+        ACCEPT,
+        /// Callouts for packet receive.
+        RECEIVE_HOOKS,
+        /// Subnet selection and host reservation lookup.
+        SELECT_SUBNET,
+        /// Lease lookup and allocation.
+        LEASE,
+        /// Remaining processing of the packet, e.g. appending options to
+        /// the response.
+        PROCESS,
+        /// Callouts for packet send and building the response.
+        PACK,
+        /// Callouts for buffer send and sending the response.
+        SEND,
+        /// Number of stages.
+        NUM_STAGES
+    };
+
+    /// @brief Names of the message types.
+    typedef std::map<uint8_t, std::string> TypeNames;
+
+    /// @brief Constructor.
+    ///
+    /// @param type_names Names of the message types for which the
+    /// histograms are held. The histograms for the other message types
+    /// are held under the name "other".
+    explicit PacketLatencyStats(const TypeNames& type_names);
+
+    /// @brief Returns the name of the stage.
+    ///
+    /// @param stage Processing stage.
+    static const char* stageToText(const Stage stage);
+
+    /// @brief Records the time spent by the packet in the processing
+    /// stages.
+    ///
+    /// It does nothing if the stage times are not recorded in the packet.
+    ///
+    /// @param type Message type.
+    /// @param pkt Processed packet.
+    void record(const uint8_t type, const Pkt& pkt);
+
+    /// @brief Returns the histogram of the time spent in the stage.
+    ///
+    /// @param type Message type.
+    /// @param stage Processing stage or @c NUM_STAGES for the total time.
+    const LatencyHistogram& getHistogram(const uint8_t type,
+                                         const Stage stage) const;
+
+    /// @brief Removes all recorded values.
+    void reset();
+
+    /// @brief Returns the summaries of the histograms.
+    ///
+    /// @return Map of the message type names to the maps of the stage names
+    /// (and "total") to the summaries of the histograms. The histograms
+    /// without values are omitted.
+    isc::data::ConstElementPtr toElement() const;
+
+private:
+
+    /// @brief Histograms of the stages of a message type, followed by the
+    /// histogram of the total time.
+    typedef std::vector<LatencyHistogramPtr> StageHistograms;
+
+    /// @brief Histograms of a message type with its name.
+    typedef std::pair<std::string, StageHistograms> TypeHistograms;
+
+    /// @brief Creates the histograms for the message type.
+    ///
+    /// @param name Name of the message type.
+    static TypeHistograms createHistograms(const std::string& name);
+
+    /// @brief Returns the histograms for the message type.
+    ///
+    /// @param type Message type.
+    const TypeHistograms& getTypeHistograms(const uint8_t type) const;
+
+    /// @brief Histograms by message type.
+    ///
+    /// The map is populated in the constructor, so it may be searched
+    /// without a lock.
+    std::map<uint8_t, TypeHistograms> histograms_;
+
+    /// @brief Histograms of the other message types.
+    TypeHistograms other_;
+};
+
+/// @brief Records the processing stage times of the packet in the latency
+/// histograms when it goes out of scope.
+///
+/// The server creates the recorder when it starts processing the packet,
+/// so as the times are recorded on each exit path, including the paths
+/// on which the packet is dropped.
+///
+/// @tparam PktPtrType Type of the pointer to the packet.
+template<typename PktPtrType>
+class PacketLatencyRecorder : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param stats Pointer to the latency histograms or NULL if the
+    /// histograms are disabled.
+    /// @param pkt Reference to the pointer to the processed packet. The
+    /// pointer may be replaced while the packet is processed.
+    PacketLatencyRecorder(PacketLatencyStats* stats, const PktPtrType& pkt)
+        : stats_(stats), pkt_(pkt), type_(0) {
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Records the stage times of the packet.
+    ~PacketLatencyRecorder() {
+        if (stats_ && pkt_) {
+            stats_->record(type_, *pkt_);
+        }
+    }
+
+    /// @brief Sets the message type under which the times are recorded.
+    ///
+    /// The times of the packets for which the message type hasn't been
+    /// set are recorded under the "other" type.
+    ///
+    /// @param type Message type.
+    void setType(const uint8_t type) {
+        type_ = type;
+    }
+
+private:
+
+    /// @brief Pointer to the latency histograms.
+    PacketLatencyStats* stats_;
+
+    /// @brief Reference to the pointer to the processed packet.
+    const PktPtrType& pkt_;
+
+    /// @brief Message type.
+    uint8_t type_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // LATENCY_STATS_H
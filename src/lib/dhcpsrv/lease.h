@@ -148,6 +148,15 @@ struct Lease {
     /// @return true if the lease is expired
     bool expired() const;
 
+    /// @brief Returns the time when the lease expires.
+    ///
+    /// This function is also used as a key extractor for the index
+    /// sorting leases by their expiration time.
+    ///
+    /// @return Sum of the client last transmission time and the valid
+    /// lifetime.
+    int64_t getExpirationTime() const;
+
     /// @brief Returns true if the other lease has equal FQDN data.
     ///
     /// @param other Lease which FQDN data is to be compared with our lease.
@@ -0,0 +1,133 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/lease_file_loader.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// @brief Maximum number of threads loading the lease file.
+const unsigned MAX_LOAD_THREADS = 16;
+
+/// @brief Minimum size of the lease file parsed by a single thread.
+const size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+}
+
+namespace isc {
+namespace dhcp {
+
+LeaseFileMapping::LeaseFileMapping(const std::string& filename)
+    : fd_(-1), data_(NULL), size_(0) {
+    fd_ = open(filename.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        isc_throw(util::CSVFileError, "unable to open the lease file "
+                  << filename << ": " << strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        const int err = errno;
+        close(fd_);
+        isc_throw(util::CSVFileError, "unable to get the size of the lease"
+                  " file " << filename << ": " << strerror(err));
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    // Empty files can't be mapped.
+    if (size_ == 0) {
+        return;
+    }
+
+    void* data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED) {
+        const int err = errno;
+        close(fd_);
+        isc_throw(util::CSVFileError, "unable to map the lease file "
+                  << filename << " into memory: " << strerror(err));
+    }
+    data_ = static_cast<const char*>(data);
+    // The file is read once from the beginning to the end by each thread.
+    // This is only a hint, so the failure is ignored.
+    (void) madvise(data, size_, MADV_SEQUENTIAL);
+}
+
+LeaseFileMapping::~LeaseFileMapping() {
+    if (data_ != NULL) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    close(fd_);
+}
+
+void
+LeaseFileMapping::split(const size_t num_chunks,
+                        std::vector<Chunk>& chunks) const {
+    chunks.clear();
+    if ((data_ == NULL) || (num_chunks == 0)) {
+        return;
+    }
+
+    const char* end = data_ + size_;
+    // Skip the header.
+    const char* pos = static_cast<const char*>(memchr(data_, '\n', size_));
+    if (pos == NULL) {
+        return;
+    }
+    ++pos;
+
+    const size_t chunk_size = std::max(static_cast<size_t>((end - pos) /
+                                                            num_chunks),
+                                       static_cast<size_t>(1));
+    while (pos < end) {
+        // Extend the chunk to the end of the row it ends in.
+        const char* chunk_end = end;
+        if ((chunks.size() + 1 < num_chunks) &&
+            (static_cast<size_t>(end - pos) > chunk_size)) {
+            const char* eol = static_cast<const char*>
+                (memchr(pos + chunk_size - 1, '\n',
+                        end - (pos + chunk_size - 1)));
+            if (eol != NULL) {
+                chunk_end = eol + 1;
+            }
+        }
+        chunks.push_back(Chunk(pos, chunk_end));
+        pos = chunk_end;
+    }
+}
+
+unsigned
+LeaseFileLoader::getLoadThreads(const std::string& filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) {
+        return (1);
+    }
+
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = static_cast<size_t>(st.st_size) / MIN_CHUNK_SIZE;
+    threads = std::min(threads, static_cast<size_t>(MAX_LOAD_THREADS));
+    if (processors > 0) {
+        threads = std::min(threads, static_cast<size_t>(processors));
+    }
+    return (threads > 0 ? static_cast<unsigned>(threads) : 1);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -15,15 +15,78 @@
 #ifndef LEASE_FILE_LOADER_H
 #define LEASE_FILE_LOADER_H
 
+#include <dhcpsrv/binary_lease_file.h>
 #include <dhcpsrv/dhcpsrv_log.h>
+#include <dhcpsrv/lease_file_stats.h>
 #include <dhcpsrv/memfile_lease_storage.h>
 #include <util/csv_file.h>
+#include <util/threads/thread.h>
 
+#include <boost/bind.hpp>
+#include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
 
+/// @brief Lease file mapped into memory.
+///
+/// The lease file is mapped read only, so as its contents can be parsed
+/// without copying them to the buffers of a stream. The mapping is used
+/// by the @c LeaseFileLoader to split the lease file into chunks which
+/// are parsed by multiple threads.
+class LeaseFileMapping : public boost::noncopyable {
+public:
+
+    /// @brief Part of the lease file: pointers to its first character and
+    /// to the character following its last character.
+    typedef std::pair<const char*, const char*> Chunk;
+
+    /// @brief Constructor.
+    ///
+    /// Maps the whole file into memory.
+    ///
+    /// @param filename Path to the lease file.
+    /// @throw isc::util::CSVFileError if the file can't be mapped.
+    explicit LeaseFileMapping(const std::string& filename);
+
+    /// @brief Destructor.
+    ///
+    /// Unmaps and closes the file.
+    ~LeaseFileMapping();
+
+    /// @brief Returns the size of the mapped file.
+    size_t getSize() const {
+        return (size_);
+    }
+
+    /// @brief Splits the rows following the header into chunks.
+    ///
+    /// The chunks have approximately the same size, and each of them
+    /// holds complete rows. The chunks are returned in the order in which
+    /// they appear in the file.
+    ///
+    /// @param num_chunks Number of chunks to split the rows into. Fewer
+    /// chunks are returned if there are not enough rows.
+    /// @param [out] chunks Chunks of the file.
+    void split(const size_t num_chunks, std::vector<Chunk>& chunks) const;
+
+private:
+
+    /// @brief Descriptor of the mapped file.
+    int fd_;
+
+    /// @brief Pointer to the mapped contents of the file.
+    const char* data_;
+
+    /// @brief Size of the mapped file.
+    size_t size_;
+};
+
 /// @brief Utility class to manage bulk of leases in the lease files.
 ///
 /// This class exposes methods which allow for bulk loading leases from
@@ -41,7 +104,9 @@ namespace dhcp {
 ///
 /// The methods in this class are templated so as they can be used both
 /// with the @c Lease4Storage and @c Lease6Storage to process the DHCPv4
-/// and DHCPv6 leases respectively.
+/// and DHCPv6 leases respectively. The DHCPv4 leases may also be loaded
+/// into the @c CompactLease4Storage, which provides the subset of the
+/// container interface used by these methods.
 ///
 class LeaseFileLoader {
 public:
@@ -57,11 +122,16 @@ public:
     ///
     /// If the method finds the entry with the valid lifetime of 0 it
     /// means that the particular lease was released and the method
-    /// removes an existing lease from the container.
+    /// removes an existing lease from the container. If the
+    /// @c keep_released flag is set, the entry is instead stored in the
+    /// container (replacing an existing lease), so as the released leases
+    /// are preserved when the leases are written to a delta lease file
+    /// which is later applied on top of another lease file.
     ///
-    /// @param lease_file A reference to the @c CSVLeaseFile4 or
-    /// @c CSVLeaseFile6 object representing the lease file. The file
-    /// doesn't need to be open because the method re-opens the file.
+    /// @param lease_file A reference to the @c CSVLeaseFile4,
+    /// @c CSVLeaseFile6, @c BinaryLeaseFile4 or @c BinaryLeaseFile6 object
+    /// representing the lease file. The file doesn't need to be open
+    /// because the method re-opens the file.
     /// @param storage A reference to the container to which leases
     /// should be inserted.
     /// @param max_errors Maximum number of corrupted leases in the
@@ -73,8 +143,12 @@ public:
     /// One case when the file is not opened is when the server starts
     /// up, reads the leases in the file and then leaves the file open
     /// for writing future lease updates.
+    /// @param keep_released A boolean flag which indicates if the entries
+    /// with the valid lifetime of 0 should be kept in the storage rather
+    /// than remove the existing leases.
     /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
-    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4, @c CSVLeaseFile6,
+    /// @c BinaryLeaseFile4 or @c BinaryLeaseFile6.
     /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
     ///
     /// @throw isc::util::CSVFileError when the maximum number of errors
@@ -83,7 +157,8 @@ public:
              typename StorageType>
     static void load(LeaseFileType& lease_file, StorageType& storage,
                      const uint32_t max_errors = 0xFFFFFFFF,
-                     const bool close_file_on_exit = true) {
+                     const bool close_file_on_exit = true,
+                     const bool keep_released = false) {
 
         LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_FILE_LOAD)
             .arg(lease_file.getFilename());
@@ -126,26 +201,7 @@ public:
                           DHCPSRV_MEMFILE_LEASE_LOAD)
                     .arg(lease->toText());
 
-                // Check if this lease exists.
-                typename StorageType::iterator lease_it =
-                    storage.find(lease->addr_);
-                // The lease doesn't exist yet. Insert the lease if
-                // it has a positive valid lifetime.
-                if (lease_it == storage.end()) {
-                    if (lease->valid_lft_ > 0) {
-                        storage.insert(lease);
-                    }
-                } else {
-                    // The lease exists. If the new entry has a valid
-                    // lifetime of 0 it is an indication to remove the
-                    // existing entry. Otherwise, we update the lease.
-                    if (lease->valid_lft_ == 0) {
-                        storage.erase(lease_it);
-
-                    } else {
-                        **lease_it = *lease;
-                    }
-                }
+                applyLease(storage, lease, keep_released);
 
             } else {
                 // Being here means that we hit the end of file.
@@ -159,6 +215,215 @@ public:
         }
     }
 
+    /// @brief Load leases from the lease file using multiple threads.
+    ///
+    /// This method produces the same result as the @c load method, but
+    /// it is faster for large lease files. The lease file is mapped into
+    /// memory and split into chunks, one per thread. Each thread parses
+    /// the rows of its chunk into a separate container, in which only the
+    /// most recent entry for each lease is held (including the entries
+    /// with the valid lifetime of 0). The containers are then applied to
+    /// the storage in the order of the chunks in the file, so as the
+    /// entries further in the lease file override the previous entries.
+    ///
+    /// Empty rows are skipped. The maximum number of errors is checked
+    /// when all chunks have been parsed and no leases are loaded into the
+    /// storage if it is exceeded.
+    ///
+    /// If the number of threads is not specified, it is selected with the
+    /// @c getLoadThreads. If only one thread is to be used, the @c load
+    /// method is called.
+    ///
+    /// @param lease_file A reference to the @c CSVLeaseFile4 or
+    /// @c CSVLeaseFile6 object representing the lease file. The file
+    /// doesn't need to be open because the method re-opens the file.
+    /// @param storage A reference to the container to which leases
+    /// should be inserted.
+    /// @param max_errors Maximum number of corrupted leases in the
+    /// lease file.
+    /// @param close_file_on_exit A boolean flag which indicates if
+    /// the file should be closed after it has been successfully parsed.
+    /// @param keep_released A boolean flag which indicates if the entries
+    /// with the valid lifetime of 0 should be kept in the storage rather
+    /// than remove the existing leases.
+    /// @param num_threads Number of threads parsing the lease file or 0
+    /// to select it automatically.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    ///
+    /// @throw isc::util::CSVFileError when the maximum number of errors
+    /// has been exceeded or the file can't be mapped into memory.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename StorageType>
+    static void loadParallel(LeaseFileType& lease_file, StorageType& storage,
+                             const uint32_t max_errors = 0xFFFFFFFF,
+                             const bool close_file_on_exit = true,
+                             const bool keep_released = false,
+                             unsigned num_threads = 0) {
+        if (num_threads == 0) {
+            num_threads = getLoadThreads(lease_file.getFilename());
+        }
+
+        if (num_threads <= 1) {
+            load<LeaseObjectType>(lease_file, storage, max_errors,
+                                  close_file_on_exit, keep_released);
+            return;
+        }
+
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_FILE_LOAD_PARALLEL)
+            .arg(lease_file.getFilename())
+            .arg(num_threads);
+
+        // Reopen the file to validate its header. The file is created if
+        // it doesn't exist.
+        lease_file.close();
+        lease_file.open();
+
+        // The chunks are only used until this method returns, so if it
+        // throws, the file is closed to not leave it in unknown state.
+        typedef Chunk<StorageType> ChunkType;
+        std::vector<boost::shared_ptr<ChunkType> > chunks;
+        try {
+            LeaseFileMapping mapping(lease_file.getFilename());
+            std::vector<LeaseFileMapping::Chunk> ranges;
+            mapping.split(num_threads, ranges);
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                chunks.push_back(boost::shared_ptr<ChunkType>(new ChunkType()));
+                chunks.back()->range_ = ranges[i];
+            }
+
+            // Parse the first chunk in this thread and the remaining ones
+            // in the new threads. All threads must complete before the
+            // file is unmapped, even if one of them fails.
+            std::vector<boost::shared_ptr<util::thread::Thread> > threads;
+            bool failed = false;
+            try {
+                for (size_t i = 1; i < chunks.size(); ++i) {
+                    threads.push_back(boost::shared_ptr<util::thread::Thread>
+                        (new util::thread::Thread(boost::bind(
+                            &LeaseFileLoader::loadChunk<LeaseObjectType,
+                                                        LeaseFileType,
+                                                        StorageType>,
+                            &lease_file, chunks[i].get()))));
+                }
+                if (!chunks.empty()) {
+                    loadChunk<LeaseObjectType>(&lease_file, chunks[0].get());
+                }
+            } catch (const std::exception&) {
+                failed = true;
+            }
+            for (size_t i = 0; i < threads.size(); ++i) {
+                try {
+                    threads[i]->wait();
+                } catch (const std::exception&) {
+                    failed = true;
+                }
+            }
+            if (failed) {
+                isc_throw(util::CSVFileError, "failed to parse leases in"
+                          " the lease file " << lease_file.getFilename());
+            }
+
+        } catch (const std::exception&) {
+            lease_file.close();
+            throw;
+        }
+
+        // Count the read attempt which hits the end of file, as the
+        // lease file does.
+        uint32_t reads = 1;
+        uint32_t read_leases = 0;
+        uint32_t read_errs = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            reads += chunks[i]->reads_;
+            read_leases += chunks[i]->read_leases_;
+            read_errs += chunks[i]->read_errs_;
+        }
+        lease_file.addReadStatistics(reads, read_leases, read_errs);
+
+        if (read_errs > max_errors) {
+            lease_file.close();
+            isc_throw(util::CSVFileError, "exceeded maximum number of"
+                      " failures " << max_errors << " to read a lease"
+                      " from the lease file "
+                      << lease_file.getFilename());
+        }
+
+        // Apply the chunks in the order in which they appear in the file.
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            for (typename StorageType::const_iterator lease =
+                     chunks[i]->storage_.begin();
+                 lease != chunks[i]->storage_.end(); ++lease) {
+                applyLease(storage, *lease, keep_released);
+            }
+            // Release the memory as soon as possible.
+            chunks[i].reset();
+        }
+
+        if (close_file_on_exit) {
+            lease_file.close();
+        }
+    }
+
+    /// @brief Load leases from the lease file in the CSV or binary format.
+    ///
+    /// The format of the file is detected with the
+    /// @c BinaryLeaseFile::isBinary. The CSV files are loaded with the
+    /// @c loadParallel and the binary files are loaded with the @c load.
+    /// The file is closed when the leases have been loaded. Nothing is
+    /// loaded if the file doesn't exist.
+    ///
+    /// @param filename Path to the lease file.
+    /// @param storage A reference to the container to which leases
+    /// should be inserted.
+    /// @param max_errors Maximum number of corrupted leases in the
+    /// lease file.
+    /// @param keep_released A boolean flag which indicates if the entries
+    /// with the valid lifetime of 0 should be kept in the storage rather
+    /// than remove the existing leases.
+    /// @param [out] stats Optional pointer to the statistics to which the
+    /// statistics of the leases read from the file are added.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam CSVLeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    ///
+    /// @throw isc::util::CSVFileError when the maximum number of errors
+    /// has been exceeded.
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename StorageType>
+    static void loadFile(const std::string& filename, StorageType& storage,
+                         const uint32_t max_errors = 0xFFFFFFFF,
+                         const bool keep_released = false,
+                         LeaseFileStats* stats = NULL) {
+        if (BinaryLeaseFile::isBinary(filename)) {
+            BinaryLeaseFileType lease_file(filename);
+            load<LeaseObjectType>(lease_file, storage, max_errors, true,
+                                  keep_released);
+            addStatistics(lease_file, stats);
+
+        } else {
+            CSVLeaseFileType lease_file(filename);
+            if (lease_file.exists()) {
+                loadParallel<LeaseObjectType>(lease_file, storage, max_errors,
+                                              true, keep_released);
+                addStatistics(lease_file, stats);
+            }
+        }
+    }
+
+    /// @brief Returns the number of threads worth using to load the
+    /// lease file.
+    ///
+    /// Each thread should parse at least 1MB of the lease file. The number
+    /// of threads is limited to the number of online processors and to 16.
+    ///
+    /// @param filename Path to the lease file.
+    /// @return Number of threads, at least 1.
+    static unsigned getLoadThreads(const std::string& filename);
+
     /// @brief Write leases from the storage into a lease file
     ///
     /// This method iterates over the @c Lease4 or @c Lease6 object in the
@@ -176,14 +441,16 @@ public:
     /// and reopen it for writing.  After completion it will close
     /// the file.
     ///
-    /// @param lease_file A reference to the @c CSVLeaseFile4 or
-    /// @c CSVLeaseFile6 object representing the lease file. The file
-    /// doesn't need to be open because the method re-opens the file.
+    /// @param lease_file A reference to the @c CSVLeaseFile4,
+    /// @c CSVLeaseFile6, @c BinaryLeaseFile4 or @c BinaryLeaseFile6 object
+    /// representing the lease file. The file doesn't need to be open
+    /// because the method re-opens the file.
     /// @param storage A reference to the container from which leases
     /// should be written.
     ///
     /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
-    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4, @c CSVLeaseFile6,
+    /// @c BinaryLeaseFile4 or @c BinaryLeaseFile6.
     /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
     template<typename LeaseObjectType, typename LeaseFileType,
              typename StorageType>
@@ -209,6 +476,134 @@ public:
         // Close the file
         lease_file.close();
     }
+
+private:
+
+    /// @brief Adds the read statistics of the lease file to the statistics.
+    ///
+    /// @param lease_file Lease file from which the leases have been read.
+    /// @param [out] stats Pointer to the statistics or NULL.
+    static void addStatistics(const LeaseFileStats& lease_file,
+                              LeaseFileStats* stats) {
+        if (stats != NULL) {
+            stats->addReadStatistics(lease_file.getReads(),
+                                     lease_file.getReadLeases(),
+                                     lease_file.getReadErrs());
+        }
+    }
+
+    /// @brief Chunk of the lease file parsed by a single thread.
+    ///
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    template<typename StorageType>
+    struct Chunk {
+        /// @brief Constructor.
+        Chunk()
+            : range_(static_cast<const char*>(0), static_cast<const char*>(0)),
+              storage_(), reads_(0), read_leases_(0), read_errs_(0) {
+        }
+
+        /// @brief Part of the mapped lease file.
+        LeaseFileMapping::Chunk range_;
+
+        /// @brief Most recent entries of the leases in the chunk.
+        StorageType storage_;
+
+        /// @brief Number of attempts to read a lease.
+        uint32_t reads_;
+
+        /// @brief Number of leases read.
+        uint32_t read_leases_;
+
+        /// @brief Number of errors when reading.
+        uint32_t read_errs_;
+    };
+
+    /// @brief Parses the rows of the chunk of the lease file.
+    ///
+    /// It is executed by the threads started by @c loadParallel. The
+    /// leases are stored in the storage of the chunk, including the
+    /// leases with the valid lifetime of 0. Each row is parsed into the
+    /// same @c util::CSVRow object to avoid memory allocations.
+    ///
+    /// @param lease_file Pointer to the lease file used to parse rows.
+    /// @param chunk Pointer to the chunk.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename StorageType>
+    static void loadChunk(const LeaseFileType* lease_file,
+                          Chunk<StorageType>* chunk) {
+        util::CSVRow row;
+        const char* pos = chunk->range_.first;
+        const char* end = chunk->range_.second;
+        while (pos < end) {
+            const char* eol = static_cast<const char*>
+                (memchr(pos, '\n', end - pos));
+            const char* line_end = (eol != NULL ? eol : end);
+            // Skip empty rows.
+            if (line_end > pos) {
+                ++chunk->reads_;
+                try {
+                    row.parse(pos, line_end - pos);
+                    boost::shared_ptr<LeaseObjectType> lease =
+                        lease_file->parseLease(row);
+                    ++chunk->read_leases_;
+                    applyLease(chunk->storage_, lease, true);
+
+                } catch (const std::exception&) {
+                    ++chunk->read_errs_;
+                }
+            }
+            if (eol == NULL) {
+                break;
+            }
+            pos = eol + 1;
+        }
+    }
+
+    /// @brief Applies the lease entry read from the lease file to the
+    /// storage.
+    ///
+    /// If the storage doesn't hold the lease, the lease is inserted if it
+    /// has a positive valid lifetime or if the released leases are to be
+    /// kept. If the storage holds the lease, the lease is removed if the
+    /// entry has a valid lifetime of 0 and the released leases are not to
+    /// be kept. Otherwise, it is replaced.
+    ///
+    /// @param storage A reference to the container.
+    /// @param lease Pointer to the lease.
+    /// @param keep_released A boolean flag which indicates if the entries
+    /// with the valid lifetime of 0 should be kept in the storage.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    /// @tparam LeasePtrType A @c Lease4Ptr or @c Lease6Ptr.
+    template<typename StorageType, typename LeasePtrType>
+    static void applyLease(StorageType& storage, const LeasePtrType& lease,
+                           const bool keep_released) {
+        // Check if this lease exists.
+        typename StorageType::iterator lease_it = storage.find(lease->addr_);
+        // The lease doesn't exist yet. Insert the lease if
+        // it has a positive valid lifetime or if the released
+        // leases are to be kept.
+        if (lease_it == storage.end()) {
+            if ((lease->valid_lft_ > 0) || keep_released) {
+                storage.insert(lease);
+            }
+        } else {
+            // The lease exists. If the new entry has a valid
+            // lifetime of 0 it is an indication to remove the
+            // existing entry. Otherwise, we update the lease.
+            if ((lease->valid_lft_ == 0) && !keep_released) {
+                storage.erase(lease_it);
+
+            } else {
+                // Replace the lease rather than modify it in
+                // place, so as the storage indexes are updated.
+                storage.replace(lease_it, lease);
+            }
+        }
+    }
 };
 
 } // namesapce dhcp
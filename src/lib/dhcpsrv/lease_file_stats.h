@@ -15,6 +15,8 @@
 #ifndef LEASE_FILE_STATS_H
 #define LEASE_FILE_STATS_H
 
+#include <stdint.h>
+
 namespace isc {
 namespace dhcp {
 
@@ -66,6 +68,21 @@ public:
         return (write_errs_);
     }
 
+    /// @brief Adds to the statistics of the leases read
+    ///
+    /// It is used when the leases are parsed outside of the lease
+    /// file object, e.g. by multiple threads.
+    ///
+    /// @param reads Number of attempts to read a lease
+    /// @param read_leases Number of leases read
+    /// @param read_errs Number of errors when reading
+    void addReadStatistics(const uint32_t reads, const uint32_t read_leases,
+                           const uint32_t read_errs) {
+        reads_       += reads;
+        read_leases_ += read_leases;
+        read_errs_   += read_errs;
+    }
+
     /// @brief Clears the statistics
     void clearStatistics() {
         reads_        = 0;
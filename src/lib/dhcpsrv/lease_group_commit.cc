@@ -0,0 +1,150 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <dhcpsrv/lease_group_commit.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace isc::util::thread;
+using namespace boost::posix_time;
+
+namespace isc {
+namespace dhcp {
+
+LeaseGroupCommit::Transaction::Transaction(LeaseGroupCommit* group_commit)
+    : group_commit_(group_commit), finished_(false) {
+    if (group_commit_) {
+        group_commit_->beginUpdate();
+    }
+}
+
+LeaseGroupCommit::Transaction::~Transaction() {
+    finish();
+}
+
+void
+LeaseGroupCommit::Transaction::commit() {
+    finish();
+    if (group_commit_) {
+        group_commit_->waitForSync();
+    }
+}
+
+void
+LeaseGroupCommit::Transaction::finish() {
+    if (group_commit_ && !finished_) {
+        finished_ = true;
+        group_commit_->endUpdate();
+    }
+}
+
+LeaseGroupCommit::LeaseGroupCommit(const SyncFunction& sync,
+                                   const uint32_t interval,
+                                   const uint32_t max_leases)
+    : sync_(sync), interval_(interval), max_leases_(max_leases),
+      written_(0), synced_(0), syncs_(0), updates_(0), syncing_(false) {
+}
+
+void
+LeaseGroupCommit::recordWrite() {
+    Mutex::Locker locker(mutex_);
+    ++written_;
+    if (written_ - synced_ >= max_leases_) {
+        write_cond_.signal();
+    }
+}
+
+uint64_t
+LeaseGroupCommit::getSyncs() const {
+    Mutex::Locker locker(mutex_);
+    return (syncs_);
+}
+
+uint64_t
+LeaseGroupCommit::getWrites() const {
+    Mutex::Locker locker(mutex_);
+    return (written_);
+}
+
+void
+LeaseGroupCommit::beginUpdate() {
+    Mutex::Locker locker(mutex_);
+    ++updates_;
+}
+
+void
+LeaseGroupCommit::endUpdate() {
+    Mutex::Locker locker(mutex_);
+    --updates_;
+    write_cond_.signal();
+}
+
+void
+LeaseGroupCommit::waitForSync() {
+    uint64_t target = 0;
+    {
+        Mutex::Locker locker(mutex_);
+        // The leases written by the caller are among the leases written
+        // so far.
+        target = written_;
+        for (;;) {
+            if (synced_ >= target) {
+                return;
+            }
+            if (!syncing_) {
+                break;
+            }
+            sync_cond_.wait(mutex_);
+        }
+
+        // Become the leader and let the updates in progress join the group.
+        syncing_ = true;
+        const ptime deadline = microsec_clock::universal_time() +
+            milliseconds(interval_);
+        while ((updates_ > 0) && (written_ - synced_ < max_leases_)) {
+            const time_duration remaining =
+                deadline - microsec_clock::universal_time();
+            if ((remaining.total_milliseconds() <= 0) ||
+                !write_cond_.timedWait(mutex_,
+                                       remaining.total_milliseconds())) {
+                break;
+            }
+        }
+        target = written_;
+    }
+
+    // Sync without the lock, so as the other callers can write leases
+    // for the next group.
+    try {
+        sync_();
+    } catch (...) {
+        // Let one of the waiting callers retry.
+        Mutex::Locker locker(mutex_);
+        syncing_ = false;
+        sync_cond_.broadcast();
+        throw;
+    }
+
+    Mutex::Locker locker(mutex_);
+    syncing_ = false;
+    if (target > synced_) {
+        synced_ = target;
+        ++syncs_;
+    }
+    sync_cond_.broadcast();
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,168 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#ifndef LEASE_GROUP_COMMIT_H
+#define LEASE_GROUP_COMMIT_H
+
+#include <util/threads/sync.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Makes the lease file writes durable in groups.
+///
+/// Syncing the lease file after each write makes the leases crash-safe,
+/// but the rate of the lease updates is then limited by the latency of
+/// the storage device. This class allows for syncing the writes of many
+/// concurrently processed packets with a single sync.
+///
+/// Each update of the leases is bracketed by a @c Transaction. After the
+/// lease has been written to the file, the @c Transaction::commit blocks
+/// the caller until the write is synced, so as the response to the client
+/// is held until the lease is durable. The first of the waiting callers
+/// becomes the leader, which gives the other updates in progress a chance
+/// to write their leases and then syncs the file for all of them. The
+/// callers waiting while the sync is in progress are synced by the next
+/// leader.
+///
+/// The leader syncs the file when either of the following occurs:
+/// - the configured number of the leases is waiting for the sync,
+/// - the configured interval has elapsed,
+/// - there are no other updates in progress.
+///
+/// The last condition ensures that a server processing the packets one
+/// after another is not delayed by the interval.
+class LeaseGroupCommit : public boost::noncopyable {
+public:
+
+    /// @brief Function syncing the lease files.
+    ///
+    /// It is called without the lock protecting this object, but at most
+    /// by one thread at a time. It should throw on failure.
+    typedef boost::function<void()> SyncFunction;
+
+    /// @brief Update of the leases waiting for the sync.
+    ///
+    /// The object must be created before the lease is written and must
+    /// not be held while the lease file lock is held by the caller.
+    class Transaction : public boost::noncopyable {
+    public:
+
+        /// @brief Constructor.
+        ///
+        /// Records the update in progress.
+        ///
+        /// @param group_commit Pointer to the group commit or NULL, in
+        /// which case the transaction does nothing.
+        explicit Transaction(LeaseGroupCommit* group_commit);
+
+        /// @brief Destructor.
+        ///
+        /// Records the end of the update if it hasn't been committed.
+        ~Transaction();
+
+        /// @brief Waits until the leases written so far are synced.
+        ///
+        /// @throw isc::Exception or std::exception thrown by the sync
+        /// function.
+        void commit();
+
+    private:
+
+        /// @brief Records the end of the update.
+        void finish();
+
+        /// @brief Pointer to the group commit or NULL.
+        LeaseGroupCommit* group_commit_;
+
+        /// @brief Indicates if the end of the update has been recorded.
+        bool finished_;
+    };
+
+    /// @brief Constructor.
+    ///
+    /// @param sync Function syncing the lease files.
+    /// @param interval Maximum time in milliseconds the leader waits for
+    /// other leases before syncing.
+    /// @param max_leases Number of leases which causes the leader to sync
+    /// without waiting for other leases.
+    LeaseGroupCommit(const SyncFunction& sync, const uint32_t interval,
+                     const uint32_t max_leases);
+
+    /// @brief Records the lease written to the file.
+    ///
+    /// It is called with the lease file lock held.
+    void recordWrite();
+
+    /// @brief Returns the number of syncs performed.
+    uint64_t getSyncs() const;
+
+    /// @brief Returns the number of leases written.
+    uint64_t getWrites() const;
+
+private:
+
+    /// @brief Records the start of the update.
+    void beginUpdate();
+
+    /// @brief Records the end of the update.
+    void endUpdate();
+
+    /// @brief Waits until the leases written so far are synced.
+    void waitForSync();
+
+    /// @brief Function syncing the lease files.
+    SyncFunction sync_;
+
+    /// @brief Maximum time the leader waits for other leases.
+    uint32_t interval_;
+
+    /// @brief Number of leases which causes the sync without waiting.
+    uint32_t max_leases_;
+
+    /// @brief Number of leases written.
+    uint64_t written_;
+
+    /// @brief Number of leases synced.
+    uint64_t synced_;
+
+    /// @brief Number of syncs performed.
+    uint64_t syncs_;
+
+    /// @brief Number of updates in progress.
+    unsigned updates_;
+
+    /// @brief Indicates that a leader is syncing the leases.
+    bool syncing_;
+
+    /// @brief Mutex protecting the members.
+    mutable isc::util::thread::Mutex mutex_;
+
+    /// @brief Signals the leader that a lease was written or an update
+    /// has ended.
+    isc::util::thread::CondVar write_cond_;
+
+    /// @brief Signals the waiting callers that the sync has completed.
+    isc::util::thread::CondVar sync_cond_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // LEASE_GROUP_COMMIT_H
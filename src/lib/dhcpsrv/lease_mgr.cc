@@ -42,6 +42,22 @@ std::string LeaseMgr::getParameter(const std::string& name) const {
     return (param->second);
 }
 
+void
+LeaseMgr::getClientLeases4(const HWAddr& hwaddr, const ClientId& clientid,
+                           SubnetID subnet_id, Lease4Ptr& hwaddr_lease,
+                           Lease4Ptr& clientid_lease) const {
+    hwaddr_lease = getLease4(hwaddr, subnet_id);
+    clientid_lease = getLease4(clientid, subnet_id);
+}
+
+void
+LeaseMgr::countLeases4(LeaseCounts& counts) const {
+    for (LeaseCounts::iterator count = counts.begin(); count != counts.end();
+         ++count) {
+        count->second = getLeases4(count->first).size();
+    }
+}
+
 Lease6Ptr
 LeaseMgr::getLease6(Lease::Type type, const DUID& duid,
                     uint32_t iaid, SubnetID subnet_id) const {
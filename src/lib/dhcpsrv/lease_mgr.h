@@ -140,6 +140,9 @@ public:
     /// Database configuration parameter map
     typedef std::map<std::string, std::string> ParameterMap;
 
+    /// Numbers of leases by subnet identifier
+    typedef std::map<SubnetID, uint64_t> LeaseCounts;
+
     /// @brief Constructor
     ///
     /// @param parameters A data structure relating keywords and values
@@ -245,6 +248,61 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const = 0;
 
+    /// @brief Returns IPv4 leases for the HW address and client identifier
+    ///
+    /// The allocation engine searches for the client's lease using the
+    /// HW address and the client identifier. This method returns the
+    /// results of both lookups, so as the backends which can execute them
+    /// concurrently can override it and save a round trip to the database.
+    /// The default implementation executes the lookups one after another.
+    ///
+    /// The allocation engine only calls this method when
+    /// @c concurrentClientLookups returns true. Otherwise, it looks up the
+    /// lease by the client identifier only if the lease for the HW address
+    /// doesn't belong to the client.
+    ///
+    /// @param hwaddr hardware address of the client
+    /// @param clientid client identifier
+    /// @param subnet_id identifier of the subnet that leases must belong to
+    /// @param [out] hwaddr_lease lease found by the HW address or NULL
+    /// @param [out] clientid_lease lease found by the client identifier
+    ///        or NULL
+    virtual void getClientLeases4(const HWAddr& hwaddr,
+                                  const ClientId& clientid,
+                                  SubnetID subnet_id,
+                                  Lease4Ptr& hwaddr_lease,
+                                  Lease4Ptr& clientid_lease) const;
+
+    /// @brief Checks if @c getClientLeases4 executes the lookups concurrently
+    ///
+    /// @return true if both lookups made by @c getClientLeases4 cost a
+    /// single round trip to the database, false otherwise.
+    virtual bool concurrentClientLookups() const {
+        return (false);
+    }
+
+    /// @brief Returns all IPv4 leases for the particular subnet identifier.
+    ///
+    /// This method is used to learn which addresses of the subnet are
+    /// in use without querying the lease database for each address.
+    ///
+    /// @param subnet_id identifier of the subnet that leases must belong to
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    virtual Lease4Collection getLeases4(SubnetID subnet_id) const = 0;
+
+    /// @brief Counts the IPv4 leases in the subnets.
+    ///
+    /// This method is used to initialize the statistics of the subnets.
+    /// The default implementation retrieves the leases of each subnet
+    /// with @c getLeases4. The backends should override it if they can
+    /// count the leases more efficiently.
+    ///
+    /// @param [in,out] counts Map holding the identifiers of the subnets
+    /// for which the leases are counted. The numbers of leases in these
+    /// subnets are stored in the map.
+    virtual void countLeases4(LeaseCounts& counts) const;
+
     /// @brief Returns existing IPv6 lease for a given IPv6 address.
     ///
     /// For a given address, we assume that there will be only one lease.
@@ -314,6 +372,32 @@ public:
     Lease6Ptr getLease6(Lease::Type type, const DUID& duid,
                         uint32_t iaid, SubnetID subnet_id) const;
 
+    /// @brief Returns a collection of expired DHCPv4 leases.
+    ///
+    /// The leases are returned in the order of their expiration times,
+    /// starting from the lease which expired first. This allows for
+    /// reclaiming the expired leases in chunks, starting from the oldest
+    /// ones.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    virtual void getExpiredLeases4(Lease4Collection& expired_leases,
+                                   const size_t max_leases) const = 0;
+
+    /// @brief Returns a collection of expired DHCPv6 leases.
+    ///
+    /// The leases are returned in the order of their expiration times,
+    /// starting from the lease which expired first.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    virtual void getExpiredLeases6(Lease6Collection& expired_leases,
+                                   const size_t max_leases) const = 0;
+
     /// @brief Updates IPv4 lease.
     ///
     /// @param lease4 The lease to be updated.
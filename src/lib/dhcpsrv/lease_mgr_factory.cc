@@ -158,6 +158,11 @@ LeaseMgrFactory::destroy() {
     getLeaseMgrPtr().reset();
 }
 
+bool
+LeaseMgrFactory::haveInstance() {
+    return (getLeaseMgrPtr().get() != NULL);
+}
+
 LeaseMgr&
 LeaseMgrFactory::instance() {
     LeaseMgr* lmptr = getLeaseMgrPtr().get();
@@ -89,6 +89,11 @@ public:
     /// lease manager is available.
     static void destroy();
 
+    /// @brief Checks if the lease manager has been created.
+    ///
+    /// @return true if the lease manager is available, false otherwise.
+    static bool haveInstance();
+
     /// @brief Return current lease manager
     ///
     /// Returns an instance of the "current" lease manager.  An exception
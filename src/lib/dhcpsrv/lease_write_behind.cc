@@ -0,0 +1,397 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <dhcpsrv/dhcpsrv_log.h>
+#include <dhcpsrv/lease_write_behind.h>
+
+#include <boost/bind.hpp>
+
+#include <unistd.h>
+
+using namespace isc::asiolink;
+using namespace isc::util::thread;
+
+namespace isc {
+namespace dhcp {
+
+LeaseWriteBehind::LeaseWriteBehind(LeaseMgr& writer, const size_t max_pending,
+                                   const unsigned int max_attempts)
+    : writer_(writer), max_pending_(max_pending),
+      max_attempts_(max_attempts > 0 ? max_attempts : 1), pending_(),
+      writing_(), started_(0), completed_(0), stopping_(false) {
+    thread_.reset(new Thread(boost::bind(&LeaseWriteBehind::run, this)));
+}
+
+LeaseWriteBehind::~LeaseWriteBehind() {
+    {
+        Mutex::Locker locker(mutex_);
+        stopping_ = true;
+        pending_cond_.signal();
+    }
+    try {
+        thread_->wait();
+    } catch (...) {
+        // The thread catches the exceptions, so this should not happen.
+    }
+}
+
+bool
+LeaseWriteBehind::addLease(const Lease4Ptr& lease) {
+    return (recordAdd(lease->addr_, Lease4Ptr(new Lease4(*lease)),
+                      Lease6Ptr()));
+}
+
+bool
+LeaseWriteBehind::addLease(const Lease6Ptr& lease) {
+    return (recordAdd(lease->addr_, Lease4Ptr(),
+                      Lease6Ptr(new Lease6(*lease))));
+}
+
+void
+LeaseWriteBehind::updateLease4(const Lease4Ptr& lease) {
+    recordUpdate(lease->addr_, Lease4Ptr(new Lease4(*lease)), Lease6Ptr());
+}
+
+void
+LeaseWriteBehind::updateLease6(const Lease6Ptr& lease) {
+    recordUpdate(lease->addr_, Lease4Ptr(), Lease6Ptr(new Lease6(*lease)));
+}
+
+LeaseWriteBehind::State
+LeaseWriteBehind::deleteLease(const IOAddress& addr) {
+    Mutex::Locker locker(mutex_);
+    bool pending = false;
+    const Change* change = findChange(addr, pending);
+    if (!change) {
+        return (UNKNOWN);
+
+    } else if (change->operation_ == Change::DELETE) {
+        return (DELETED);
+    }
+
+    if (!pending) {
+        waitForRoom();
+    }
+    Change& deletion = pending_[addr];
+    deletion.operation_ = Change::DELETE;
+    deletion.lease4_.reset();
+    deletion.lease6_.reset();
+    pending_cond_.signal();
+    return (PRESENT);
+}
+
+LeaseWriteBehind::State
+LeaseWriteBehind::getLease4(const IOAddress& addr, Lease4Ptr& lease) const {
+    lease.reset();
+    Mutex::Locker locker(mutex_);
+    bool pending = false;
+    const Change* change = findChange(addr, pending);
+    if (!change) {
+        return (UNKNOWN);
+
+    } else if (!change->lease4_) {
+        return (DELETED);
+    }
+    lease.reset(new Lease4(*change->lease4_));
+    return (PRESENT);
+}
+
+LeaseWriteBehind::State
+LeaseWriteBehind::getLease6(const IOAddress& addr, Lease6Ptr& lease) const {
+    lease.reset();
+    Mutex::Locker locker(mutex_);
+    bool pending = false;
+    const Change* change = findChange(addr, pending);
+    if (!change) {
+        return (UNKNOWN);
+
+    } else if (!change->lease6_) {
+        return (DELETED);
+    }
+    lease.reset(new Lease6(*change->lease6_));
+    return (PRESENT);
+}
+
+uint64_t
+LeaseWriteBehind::getWrites() const {
+    Mutex::Locker locker(mutex_);
+    return (completed_);
+}
+
+bool
+LeaseWriteBehind::merge(Lease4Collection& leases,
+                        const Lease4Predicate& predicate,
+                        const uint64_t writes) const {
+    return (mergeInternal(leases, predicate, writes, &Change::lease4_));
+}
+
+bool
+LeaseWriteBehind::merge(Lease6Collection& leases,
+                        const Lease6Predicate& predicate,
+                        const uint64_t writes) const {
+    return (mergeInternal(leases, predicate, writes, &Change::lease6_));
+}
+
+template<typename LeaseCollection, typename Predicate, typename LeasePtrType>
+bool
+LeaseWriteBehind::mergeInternal(LeaseCollection& leases,
+                                const Predicate& predicate,
+                                const uint64_t writes,
+                                LeasePtrType Change::* member) const {
+    Mutex::Locker locker(mutex_);
+    // If the changes have been written since the leases were read, it is
+    // unknown whether the leases include these changes or not.
+    if (completed_ != writes) {
+        return (false);
+    }
+
+    // Leave only the leases without pending changes.
+    LeaseCollection merged;
+    for (typename LeaseCollection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        bool pending = false;
+        if (!findChange((*lease)->addr_, pending)) {
+            merged.push_back(*lease);
+        }
+    }
+
+    // Append the pending leases. The changes not yet being written
+    // supersede the changes being written.
+    for (ChangeMap::const_iterator change = writing_.begin();
+         change != writing_.end(); ++change) {
+        const LeasePtrType& lease = change->second.*member;
+        if (lease && (pending_.count(change->first) == 0) &&
+            predicate(*lease)) {
+            merged.push_back(LeasePtrType(new typename LeasePtrType::element_type(*lease)));
+        }
+    }
+    for (ChangeMap::const_iterator change = pending_.begin();
+         change != pending_.end(); ++change) {
+        const LeasePtrType& lease = change->second.*member;
+        if (lease && predicate(*lease)) {
+            merged.push_back(LeasePtrType(new typename LeasePtrType::element_type(*lease)));
+        }
+    }
+
+    leases.swap(merged);
+    return (true);
+}
+
+void
+LeaseWriteBehind::flush() {
+    Mutex::Locker locker(mutex_);
+    // The pending changes will be taken by the next write.
+    const uint64_t target = started_ + (pending_.empty() ? 0 : 1);
+    while (completed_ < target) {
+        written_cond_.wait(mutex_);
+    }
+}
+
+const LeaseWriteBehind::Change*
+LeaseWriteBehind::findChange(const IOAddress& addr, bool& pending) const {
+    ChangeMap::const_iterator change = pending_.find(addr);
+    if (change != pending_.end()) {
+        pending = true;
+        return (&change->second);
+    }
+    pending = false;
+    change = writing_.find(addr);
+    return (change != writing_.end() ? &change->second : NULL);
+}
+
+void
+LeaseWriteBehind::waitForRoom() {
+    while (pending_.size() >= max_pending_) {
+        written_cond_.wait(mutex_);
+    }
+}
+
+bool
+LeaseWriteBehind::recordAdd(const IOAddress& addr, const Lease4Ptr& lease4,
+                            const Lease6Ptr& lease6) {
+    Mutex::Locker locker(mutex_);
+    bool pending = false;
+    const Change* change = findChange(addr, pending);
+    if (change && (change->operation_ != Change::DELETE)) {
+        return (false);
+    }
+
+    // If the deletion of the lease hasn't been written yet, the lease
+    // must be deleted before it is added again.
+    Change::Operation operation = (change && pending) ? Change::REPLACE :
+        Change::ADD;
+    if (!pending) {
+        waitForRoom();
+    }
+    Change& addition = pending_[addr];
+    addition.operation_ = operation;
+    addition.lease4_ = lease4;
+    addition.lease6_ = lease6;
+    pending_cond_.signal();
+    return (true);
+}
+
+void
+LeaseWriteBehind::recordUpdate(const IOAddress& addr, const Lease4Ptr& lease4,
+                               const Lease6Ptr& lease6) {
+    Mutex::Locker locker(mutex_);
+    bool pending = false;
+    const Change* change = findChange(addr, pending);
+    if (change && (change->operation_ == Change::DELETE)) {
+        isc_throw(NoSuchLease, "unable to update lease for address "
+                  << addr << " as it does not exist");
+    }
+
+    // The pending addition remains the addition, only with the
+    // updated lease.
+    Change::Operation operation = pending ? change->operation_ :
+        Change::UPDATE;
+    if (!pending) {
+        waitForRoom();
+    }
+    Change& update = pending_[addr];
+    update.operation_ = operation;
+    update.lease4_ = lease4;
+    update.lease6_ = lease6;
+    pending_cond_.signal();
+}
+
+void
+LeaseWriteBehind::writeChange(const IOAddress& addr, const Change& change) {
+    if ((change.operation_ == Change::DELETE) ||
+        (change.operation_ == Change::REPLACE)) {
+        writer_.deleteLease(addr);
+    }
+
+    if ((change.operation_ == Change::ADD) ||
+        (change.operation_ == Change::REPLACE)) {
+        bool added = change.lease4_ ? writer_.addLease(change.lease4_) :
+            writer_.addLease(change.lease6_);
+        if (!added) {
+            LOG_ERROR(dhcpsrv_logger, DHCPSRV_WRITE_BEHIND_ADD_FAILED)
+                .arg(addr.toText());
+        }
+
+    } else if (change.operation_ == Change::UPDATE) {
+        try {
+            if (change.lease4_) {
+                writer_.updateLease4(change.lease4_);
+            } else {
+                writer_.updateLease6(change.lease6_);
+            }
+        } catch (const NoSuchLease&) {
+            LOG_ERROR(dhcpsrv_logger, DHCPSRV_WRITE_BEHIND_UPDATE_FAILED)
+                .arg(addr.toText());
+        }
+    }
+}
+
+bool
+LeaseWriteBehind::write() {
+    try {
+        for (ChangeMap::const_iterator it = writing_.begin();
+             it != writing_.end(); ++it) {
+            writeChange(it->first, it->second);
+        }
+        writer_.commit();
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_WRITE_BEHIND_WRITE_FAILED)
+            .arg(writing_.size()).arg(ex.what());
+        try {
+            writer_.rollback();
+        } catch (...) {
+            // The failure has been already logged.
+        }
+        return (false);
+    }
+
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_WRITE_BEHIND_WRITTEN).arg(writing_.size());
+    return (true);
+}
+
+void
+LeaseWriteBehind::writeSeparately() {
+    LOG_ERROR(dhcpsrv_logger, DHCPSRV_WRITE_BEHIND_WRITE_SEPARATELY)
+        .arg(writing_.size()).arg(max_attempts_);
+    for (ChangeMap::const_iterator it = writing_.begin();
+         it != writing_.end(); ++it) {
+        try {
+            writeChange(it->first, it->second);
+            writer_.commit();
+
+        } catch (const std::exception& ex) {
+            LOG_ERROR(dhcpsrv_logger, DHCPSRV_WRITE_BEHIND_CHANGE_DISCARDED)
+                .arg(it->first.toText()).arg(ex.what());
+            try {
+                writer_.rollback();
+            } catch (...) {
+                // The failure has been already logged.
+            }
+        }
+    }
+}
+
+void
+LeaseWriteBehind::run() {
+    for (;;) {
+        {
+            Mutex::Locker locker(mutex_);
+            while (pending_.empty() && !stopping_) {
+                pending_cond_.wait(mutex_);
+            }
+            if (pending_.empty()) {
+                return;
+            }
+            writing_.swap(pending_);
+            ++started_;
+            // There is a room for new changes.
+            written_cond_.broadcast();
+        }
+
+        unsigned int attempts = 1;
+        while (!write()) {
+            bool stopping = false;
+            {
+                Mutex::Locker locker(mutex_);
+                stopping = stopping_;
+            }
+            if (stopping) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_WRITE_BEHIND_DISCARDED)
+                    .arg(writing_.size());
+                break;
+            }
+            // Don't let a change which the database rejects hold the
+            // other changes and the callers waiting for them.
+            if (attempts >= max_attempts_) {
+                writeSeparately();
+                break;
+            }
+            ++attempts;
+            // Give the database some time to recover.
+            sleep(1);
+        }
+
+        Mutex::Locker locker(mutex_);
+        writing_.clear();
+        ++completed_;
+        written_cond_.broadcast();
+    }
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
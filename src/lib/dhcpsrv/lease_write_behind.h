@@ -0,0 +1,346 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef LEASE_WRITE_BEHIND_H
+#define LEASE_WRITE_BEHIND_H
+
+#include <asiolink/io_address.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/lease_mgr.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <map>
+#include <stdint.h>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Journal of lease changes written to the database in background.
+///
+/// The SQL lease database backends execute a database statement for each
+/// added, updated or deleted lease. When the database is remote, each
+/// such change blocks the server for the round trip time. This class
+/// allows for deferring the writes: the changes are recorded in the
+/// in-memory journal and the caller returns immediately. A background
+/// thread writes the recorded changes to the database using a separate
+/// lease manager instance (and connection) and commits them in a single
+/// transaction. The changes recorded while a transaction is in progress
+/// are written in the next transaction, so the size of the transactions
+/// grows with the load.
+///
+/// Multiple changes of the same lease recorded before they are written
+/// are coalesced, i.e. only the resulting state of the lease is written.
+///
+/// The journal must be consulted by the lease manager before reading
+/// the leases from the database, because the database doesn't include
+/// the changes which haven't been written yet. The @c getLease4 and
+/// @c getLease6 methods return the pending state of the lease. The
+/// @c merge methods update the collection of leases read from the
+/// database with the pending changes.
+///
+/// Because the changes are written asynchronously, the errors reported
+/// by the database can't be reported to the caller. The lease manager
+/// therefore looks the lease up in the journal and in the database before
+/// it records the addition (the lease must not exist) or the update (the
+/// lease must exist), so the caller gets the same result as when writing
+/// synchronously. The errors still reported by the database are logged.
+/// If the database transaction fails, it is retried after a second. When
+/// the transaction has failed the maximum number of times, the changes are
+/// written one by one, each in its own transaction, and the changes which
+/// still can't be written are logged and discarded. This prevents a single
+/// change rejected by the database from blocking the callers forever.
+class LeaseWriteBehind : public boost::noncopyable {
+public:
+
+    /// @brief State of the lease in the journal.
+    enum State {
+        /// The journal has no pending changes for the lease.
+        UNKNOWN,
+        /// The lease has been added or updated.
+        PRESENT,
+        /// The lease has been deleted.
+        DELETED
+    };
+
+    /// @brief Function checking if the lease matches the query.
+    typedef boost::function<bool(const Lease4&)> Lease4Predicate;
+
+    /// @brief Function checking if the lease matches the query.
+    typedef boost::function<bool(const Lease6&)> Lease6Predicate;
+
+    /// @brief Constructor.
+    ///
+    /// Starts the thread writing the changes.
+    ///
+    /// @param writer Lease manager used to write the changes. It is
+    /// used exclusively by the background thread. The changes written
+    /// by this lease manager must be made durable by its @c commit method.
+    /// @param max_pending Maximum number of leases with pending changes.
+    /// When it is reached, the callers are blocked until the pending
+    /// changes are written.
+    /// @param max_attempts Maximum number of attempts to write the changes
+    /// in a single transaction before they are written one by one.
+    LeaseWriteBehind(LeaseMgr& writer, const size_t max_pending = 65536,
+                     const unsigned int max_attempts = 3);
+
+    /// @brief Destructor.
+    ///
+    /// Writes the pending changes and stops the thread.
+    ~LeaseWriteBehind();
+
+    /// @brief Records addition of the IPv4 lease.
+    ///
+    /// @param lease Pointer to the lease. The journal holds a copy of it.
+    /// @return false if the journal holds the lease for the same address,
+    /// true otherwise.
+    bool addLease(const Lease4Ptr& lease);
+
+    /// @brief Records addition of the IPv6 lease.
+    ///
+    /// @param lease Pointer to the lease. The journal holds a copy of it.
+    /// @return false if the journal holds the lease for the same address,
+    /// true otherwise.
+    bool addLease(const Lease6Ptr& lease);
+
+    /// @brief Records update of the IPv4 lease.
+    ///
+    /// @param lease Pointer to the lease. The journal holds a copy of it.
+    /// @throw NoSuchLease if the lease has been deleted.
+    void updateLease4(const Lease4Ptr& lease);
+
+    /// @brief Records update of the IPv6 lease.
+    ///
+    /// @param lease Pointer to the lease. The journal holds a copy of it.
+    /// @throw NoSuchLease if the lease has been deleted.
+    void updateLease6(const Lease6Ptr& lease);
+
+    /// @brief Records deletion of the lease.
+    ///
+    /// The deletion is only recorded if the journal holds the lease. If the
+    /// journal has no pending changes for the address, the caller should
+    /// delete the lease from the database.
+    ///
+    /// @param addr Address of the lease.
+    /// @return State of the lease before the deletion.
+    State deleteLease(const isc::asiolink::IOAddress& addr);
+
+    /// @brief Returns the pending state of the IPv4 lease.
+    ///
+    /// @param addr Address of the lease.
+    /// @param [out] lease Copy of the lease if the returned state is
+    /// @c PRESENT, NULL otherwise.
+    /// @return State of the lease.
+    State getLease4(const isc::asiolink::IOAddress& addr,
+                    Lease4Ptr& lease) const;
+
+    /// @brief Returns the pending state of the IPv6 lease.
+    ///
+    /// @param addr Address of the lease.
+    /// @param [out] lease Copy of the lease if the returned state is
+    /// @c PRESENT, NULL otherwise.
+    /// @return State of the lease.
+    State getLease6(const isc::asiolink::IOAddress& addr,
+                    Lease6Ptr& lease) const;
+
+    /// @brief Returns the number of completed writes.
+    ///
+    /// The collection of leases read from the database can only be merged
+    /// with the journal if no write has completed in the meantime. The
+    /// caller should obtain this number before reading the leases and
+    /// pass it to @c merge.
+    uint64_t getWrites() const;
+
+    /// @brief Applies the pending changes to the IPv4 leases.
+    ///
+    /// Removes the leases which have pending changes from the collection
+    /// and appends the copies of the pending leases matching the predicate.
+    ///
+    /// @param [out] leases Leases read from the database.
+    /// @param predicate Function returning true for the leases matching the
+    /// query.
+    /// @param writes Number of completed writes returned by @c getWrites
+    /// before the leases were read.
+    /// @return false if a write has completed since the leases were read,
+    /// in which case the leases must be read again.
+    bool merge(Lease4Collection& leases, const Lease4Predicate& predicate,
+               const uint64_t writes) const;
+
+    /// @brief Applies the pending changes to the IPv6 leases.
+    ///
+    /// @param [out] leases Leases read from the database.
+    /// @param predicate Function returning true for the leases matching the
+    /// query.
+    /// @param writes Number of completed writes returned by @c getWrites
+    /// before the leases were read.
+    /// @return false if a write has completed since the leases were read,
+    /// in which case the leases must be read again.
+    bool merge(Lease6Collection& leases, const Lease6Predicate& predicate,
+               const uint64_t writes) const;
+
+    /// @brief Waits until the changes recorded so far are written.
+    void flush();
+
+private:
+
+    /// @brief Change of the lease.
+    struct Change {
+        /// @brief Operations to be executed for the lease.
+        enum Operation {
+            /// Add the lease.
+            ADD,
+            /// Update the lease.
+            UPDATE,
+            /// Delete the lease.
+            DELETE,
+            /// Delete and add the lease.
+            REPLACE
+        };
+
+        /// @brief Operation.
+        Operation operation_;
+
+        /// @brief IPv4 lease added or updated.
+        Lease4Ptr lease4_;
+
+        /// @brief IPv6 lease added or updated.
+        Lease6Ptr lease6_;
+    };
+
+    /// @brief Changes by the lease address.
+    typedef std::map<isc::asiolink::IOAddress, Change> ChangeMap;
+
+    /// @brief Returns the most recent change of the lease.
+    ///
+    /// Must be called with the mutex locked.
+    ///
+    /// @param addr Address of the lease.
+    /// @param [out] pending Set to true if the change is in the changes
+    /// not yet being written.
+    /// @return Pointer to the change or NULL.
+    const Change* findChange(const isc::asiolink::IOAddress& addr,
+                             bool& pending) const;
+
+    /// @brief Blocks the caller until there is a room for the change.
+    ///
+    /// Must be called with the mutex locked.
+    void waitForRoom();
+
+    /// @brief Records the addition of the lease.
+    ///
+    /// @param addr Address of the lease.
+    /// @param lease4 IPv4 lease or NULL.
+    /// @param lease6 IPv6 lease or NULL.
+    /// @return false if the journal holds the lease for this address.
+    bool recordAdd(const isc::asiolink::IOAddress& addr,
+                   const Lease4Ptr& lease4, const Lease6Ptr& lease6);
+
+    /// @brief Records the update of the lease.
+    ///
+    /// @param addr Address of the lease.
+    /// @param lease4 IPv4 lease or NULL.
+    /// @param lease6 IPv6 lease or NULL.
+    /// @throw NoSuchLease if the lease has been deleted.
+    void recordUpdate(const isc::asiolink::IOAddress& addr,
+                      const Lease4Ptr& lease4, const Lease6Ptr& lease6);
+
+    /// @brief Applies the pending changes to the leases.
+    ///
+    /// @param [out] leases Leases read from the database.
+    /// @param predicate Function returning true for the leases matching the
+    /// query.
+    /// @param writes Number of completed writes before the leases were read.
+    /// @param member Pointer to the member of the @c Change holding the
+    /// lease of the appropriate type.
+    /// @tparam LeaseCollection Type of the collection of leases.
+    /// @tparam Predicate Type of the function matching the leases.
+    /// @tparam LeasePtrType Type of the pointer to the lease.
+    /// @return false if a write has completed since the leases were read.
+    template<typename LeaseCollection, typename Predicate,
+             typename LeasePtrType>
+    bool mergeInternal(LeaseCollection& leases, const Predicate& predicate,
+                       const uint64_t writes,
+                       LeasePtrType Change::* member) const;
+
+    /// @brief Writes the change of the lease without committing it.
+    ///
+    /// @param addr Address of the lease.
+    /// @param change Change of the lease.
+    /// @throw isc::dhcp::DbOperationError or other exception if the
+    /// database has failed to execute the change.
+    void writeChange(const isc::asiolink::IOAddress& addr,
+                     const Change& change);
+
+    /// @brief Writes the changes in a single transaction.
+    ///
+    /// @return true if the transaction has been committed.
+    bool write();
+
+    /// @brief Writes the changes one by one, each in its own transaction.
+    ///
+    /// The changes which can't be written are logged and discarded.
+    void writeSeparately();
+
+    /// @brief Main function of the thread writing the changes.
+    void run();
+
+    /// @brief Lease manager used to write the changes.
+    LeaseMgr& writer_;
+
+    /// @brief Maximum number of pending changes.
+    size_t max_pending_;
+
+    /// @brief Maximum number of attempts to write the changes in a single
+    /// transaction.
+    unsigned int max_attempts_;
+
+    /// @brief Changes not yet being written.
+    ChangeMap pending_;
+
+    /// @brief Changes being written.
+    ///
+    /// This map is only modified by the thread writing the changes, with
+    /// the mutex locked. The thread reads it without the mutex.
+    ChangeMap writing_;
+
+    /// @brief Number of writes started.
+    uint64_t started_;
+
+    /// @brief Number of writes completed.
+    uint64_t completed_;
+
+    /// @brief Indicates that the thread should write pending changes and
+    /// stop.
+    bool stopping_;
+
+    /// @brief Mutex protecting the members.
+    mutable isc::util::thread::Mutex mutex_;
+
+    /// @brief Signals the thread that there are pending changes.
+    isc::util::thread::CondVar pending_cond_;
+
+    /// @brief Signals the callers that a write has started or completed.
+    isc::util::thread::CondVar written_cond_;
+
+    /// @brief Thread writing the changes.
+    boost::scoped_ptr<isc::util::thread::Thread> thread_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // LEASE_WRITE_BEHIND_H
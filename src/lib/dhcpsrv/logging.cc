@@ -16,6 +16,7 @@
 #include <dhcpsrv/logging.h>
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
+#include <log/async_log_writer.h>
 #include <log/logger_specification.h>
 #include <log/logger_support.h>
 #include <log/logger_manager.h>
@@ -150,5 +151,44 @@ void LogConfigParser::parseOutputOptions(std::vector<LoggingDestination>& destin
     }
 }
 
+void LogConfigParser::parseAsyncLogging(const isc::data::ConstElementPtr& async_config) {
+    if (!async_config) {
+        return;
+    }
+
+    if (async_config->getType() != Element::map) {
+        isc_throw(BadValue, "'async-logging' must be a map ("
+                  << async_config->getPosition() << ")");
+    }
+
+    int64_t queue_size = AsyncLogWriter::DEFAULT_QUEUE_SIZE;
+    isc::data::ConstElementPtr queue_size_ptr = async_config->get("queue-size");
+    if (queue_size_ptr) {
+        try {
+            queue_size = queue_size_ptr->intValue();
+        } catch (...) {
+            queue_size = 0;
+        }
+        if ((queue_size <= 0) || (queue_size > 1048576)) {
+            isc_throw(BadValue, "Unsupported queue-size value '"
+                      << queue_size_ptr->str() << "', expected 1-1048576 ("
+                      << queue_size_ptr->getPosition() << ")");
+        }
+    }
+
+    AsyncLogWriter::OverflowPolicy policy = AsyncLogWriter::BLOCK;
+    isc::data::ConstElementPtr policy_ptr = async_config->get("overflow-policy");
+    if (policy_ptr) {
+        try {
+            policy = AsyncLogWriter::overflowPolicyFromText(policy_ptr->stringValue());
+        } catch (const std::exception& ex) {
+            isc_throw(BadValue, ex.what() << " ("
+                      << policy_ptr->getPosition() << ")");
+        }
+    }
+
+    config_->setAsyncLogging(true, static_cast<uint32_t>(queue_size), policy);
+}
+
 } // namespace isc::dhcp
 } // namespace isc
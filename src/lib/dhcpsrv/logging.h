@@ -64,6 +64,20 @@ public:
     void parseConfiguration(const isc::data::ConstElementPtr& log_config,
                             bool verbose = false);
 
+    /// @brief Parses the asynchronous logging configuration
+    ///
+    /// The presence of the structure enables the asynchronous logging.
+    /// An example data structure in JSON format looks like this:
+    ///     "async-logging": {
+    ///         "queue-size": 4096,
+    ///         "overflow-policy": "block"
+    ///     }
+    /// Both parameters are optional. The overflow policy is one of "block",
+    /// "drop" and "count".
+    ///
+    /// @param async_config JSON structure to be parsed (Logging/async-logging)
+    void parseAsyncLogging(const isc::data::ConstElementPtr& async_config);
+
 private:
 
     /// @brief Parses one JSON structure in Logging/loggers" array
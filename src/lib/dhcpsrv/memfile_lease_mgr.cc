@@ -20,11 +20,15 @@
 #include <util/pid_file.h>
 #include <util/process_spawn.h>
 #include <util/signal_set.h>
+#include <util/threads/sync.h>
 #include <cstdio>
 #include <cstring>
 #include <errno.h>
 #include <iostream>
 #include <sstream>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -43,6 +47,7 @@ const char* KEA_LFC_EXECUTABLE_ENV_NAME = "KEA_LFC_EXECUTABLE";
 } // end of anonymous namespace
 
 using namespace isc::util;
+using isc::util::thread::Mutex;
 
 namespace isc {
 namespace dhcp {
@@ -79,13 +84,15 @@ public:
     ///
     /// @param lfc_interval An interval in seconds at which the cleanup should
     /// be performed.
-    /// @param lease_file4 A pointer to the DHCPv4 lease file to be cleaned up
-    /// or NULL. If this is NULL, the @c lease_file6 must be non-null.
-    /// @param lease_file6 A pointer to the DHCPv6 lease file to be cleaned up
-    /// or NULL. If this is NULL, the @c lease_file4 must be non-null.
-    void setup(const uint32_t lfc_interval,
-               const boost::shared_ptr<CSVLeaseFile4>& lease_file4,
-               const boost::shared_ptr<CSVLeaseFile6>& lease_file6);
+    /// @param incremental A boolean value indicating if the incremental
+    /// cleanup should be used.
+    /// @param binary A boolean value indicating if the lease files should
+    /// be written in the binary format.
+    /// @param lease_file Path to the lease file to be cleaned up.
+    /// @param u Universe of the lease file.
+    void setup(const uint32_t lfc_interval, const bool incremental,
+               const bool binary, const std::string& lease_file,
+               const Memfile_LeaseMgr::Universe u);
 
     /// @brief Spawns a new process.
     void execute();
@@ -125,9 +132,9 @@ LFCSetup::LFCSetup(asiolink::IntervalTimer::Callback callback,
 }
 
 void
-LFCSetup::setup(const uint32_t lfc_interval,
-                const boost::shared_ptr<CSVLeaseFile4>& lease_file4,
-                const boost::shared_ptr<CSVLeaseFile6>& lease_file6) {
+LFCSetup::setup(const uint32_t lfc_interval, const bool incremental,
+                const bool binary, const std::string& lease_file,
+                const Memfile_LeaseMgr::Universe u) {
 
     // If LFC is enabled, we have to setup the interval timer and prepare for
     // executing the kea-lfc process.
@@ -148,16 +155,11 @@ LFCSetup::setup(const uint32_t lfc_interval,
         // timeout in milliseconds.
         timer_.setup(callback_, lfc_interval * 1000);
 
-        // Start preparing the command line for kea-lfc.
-
-        // Gather the base file name.
-        std::string lease_file = lease_file4 ? lease_file4->getFilename() :
-            lease_file6->getFilename();
-
-        // Create the other names by appending suffixes to the base name.
+        // Start preparing the command line for kea-lfc. Create the other
+        // names by appending suffixes to the base name.
         util::ProcessArgs args;
         // Universe: v4 or v6.
-        args.push_back(lease_file4 ? "-4" : "-6");
+        args.push_back(u == Memfile_LeaseMgr::V4 ? "-4" : "-6");
         // Previous file.
         args.push_back("-x");
         args.push_back(Memfile_LeaseMgr::appendSuffix(lease_file,
@@ -178,6 +180,22 @@ LFCSetup::setup(const uint32_t lfc_interval,
         args.push_back("-p");
         args.push_back(Memfile_LeaseMgr::appendSuffix(lease_file,
                                                       Memfile_LeaseMgr::FILE_PID));
+        // Delta segment file.
+        args.push_back("-s");
+        args.push_back(Memfile_LeaseMgr::appendSuffix(lease_file,
+                                                      Memfile_LeaseMgr::FILE_SEGMENT));
+        // Delta segment finish file.
+        args.push_back("-g");
+        args.push_back(Memfile_LeaseMgr::appendSuffix(lease_file,
+                                                      Memfile_LeaseMgr::FILE_SEGMENT_FINISH));
+        // Incremental cleanup.
+        if (incremental) {
+            args.push_back("-I");
+        }
+        // Binary lease file format.
+        if (binary) {
+            args.push_back("-b");
+        }
 
         // The configuration file is currently unused.
         args.push_back("-c");
@@ -221,22 +239,28 @@ LFCSetup::getExitStatus() const {
 
 
 Memfile_LeaseMgr::Memfile_LeaseMgr(const ParameterMap& parameters)
-    : LeaseMgr(parameters),
+    : LeaseMgr(parameters), sync_policy_(SYNC_NONE),
       lfc_setup_(new LFCSetup(boost::bind(&Memfile_LeaseMgr::lfcCallback, this),
                               *getIOService()))
     {
+    const bool binary = initBinaryFormat();
+
     // Check the universe and use v4 file or v6 file.
     std::string universe = getParameter("universe");
     if (universe == "4") {
         std::string file4 = initLeaseFilePath(V4);
         if (!file4.empty()) {
-            loadLeasesFromFiles<Lease4, CSVLeaseFile4>(file4, lease_file4_,
+            loadLeasesFromFiles<Lease4, CSVLeaseFile4>(file4, binary,
+                                                       lease_file4_,
+                                                       binary_lease_file4_,
                                                        storage4_);
         }
     } else {
         std::string file6 = initLeaseFilePath(V6);
         if (!file6.empty()) {
-            loadLeasesFromFiles<Lease6, CSVLeaseFile6>(file6, lease_file6_,
+            loadLeasesFromFiles<Lease6, CSVLeaseFile6>(file6, binary,
+                                                       lease_file6_,
+                                                       binary_lease_file6_,
                                                        storage6_);
         }
     }
@@ -249,6 +273,7 @@ Memfile_LeaseMgr::Memfile_LeaseMgr(const ParameterMap& parameters)
         LOG_WARN(dhcpsrv_logger, DHCPSRV_MEMFILE_NO_STORAGE);
 
     } else  {
+        initSyncPolicy();
         lfcSetup();
     }
 }
@@ -262,6 +287,14 @@ Memfile_LeaseMgr::~Memfile_LeaseMgr() {
         lease_file6_->close();
         lease_file6_.reset();
     }
+    if (binary_lease_file4_) {
+        binary_lease_file4_->close();
+        binary_lease_file4_.reset();
+    }
+    if (binary_lease_file6_) {
+        binary_lease_file6_->close();
+        binary_lease_file6_.reset();
+    }
 }
 
 bool
@@ -269,19 +302,26 @@ Memfile_LeaseMgr::addLease(const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_ADD_ADDR4).arg(lease->addr_.toText());
 
-    if (getLease4(lease->addr_)) {
-        // there is a lease with specified address already
-        return (false);
-    }
+    LeaseGroupCommit::Transaction transaction(group_commit_.get());
+    {
+        Mutex::Locker locker(mutex_);
+        if (storage4_.find(lease->addr_) != storage4_.end()) {
+            // there is a lease with specified address already
+            return (false);
+        }
+
+        // Try to write a lease to disk first. If this fails, the lease will
+        // not be inserted to the memory and the disk and in-memory data will
+        // remain consistent.
+        if (persistLeases(V4)) {
+            appendLease(*lease);
+        }
 
-    // Try to write a lease to disk first. If this fails, the lease will
-    // not be inserted to the memory and the disk and in-memory data will
-    // remain consistent.
-    if (persistLeases(V4)) {
-        lease_file4_->append(*lease);
+        storage4_.insert(lease);
     }
 
-    storage4_.insert(lease);
+    // Wait for the lease to be synced without holding the mutex.
+    transaction.commit();
     return (true);
 }
 
@@ -290,19 +330,26 @@ Memfile_LeaseMgr::addLease(const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_ADD_ADDR6).arg(lease->addr_.toText());
 
-    if (getLease6(lease->type_, lease->addr_)) {
-        // there is a lease with specified address already
-        return (false);
-    }
+    LeaseGroupCommit::Transaction transaction(group_commit_.get());
+    {
+        Mutex::Locker locker(mutex_);
+        if (storage6_.find(lease->addr_) != storage6_.end()) {
+            // there is a lease with specified address already
+            return (false);
+        }
+
+        // Try to write a lease to disk first. If this fails, the lease will
+        // not be inserted to the memory and the disk and in-memory data will
+        // remain consistent.
+        if (persistLeases(V6)) {
+            appendLease(*lease);
+        }
 
-    // Try to write a lease to disk first. If this fails, the lease will
-    // not be inserted to the memory and the disk and in-memory data will
-    // remain consistent.
-    if (persistLeases(V6)) {
-        lease_file6_->append(*lease);
+        storage6_.insert(lease);
     }
 
-    storage6_.insert(lease);
+    // Wait for the lease to be synced without holding the mutex.
+    transaction.commit();
     return (true);
 }
 
@@ -311,13 +358,14 @@ Memfile_LeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_ADDR4).arg(addr.toText());
 
-    typedef Lease4Storage::nth_index<0>::type SearchIndex;
-    const SearchIndex& idx = storage4_.get<0>();
-    Lease4Storage::iterator l = idx.find(addr);
+    Mutex::Locker locker(mutex_);
+
+    // The storage returns a copy of the lease.
+    CompactLease4Storage::const_iterator l = storage4_.find(addr);
     if (l == storage4_.end()) {
         return (Lease4Ptr());
     } else {
-        return (Lease4Ptr(new Lease4(**l)));
+        return (*l);
     }
 }
 
@@ -325,18 +373,9 @@ Lease4Collection
 Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_HWADDR).arg(hwaddr.toText());
-    typedef Lease4Storage::nth_index<0>::type SearchIndex;
+    Mutex::Locker locker(mutex_);
     Lease4Collection collection;
-    const SearchIndex& idx = storage4_.get<0>();
-    for(SearchIndex::const_iterator lease = idx.begin();
-        lease != idx.end(); ++lease) {
-
-        // Every Lease4 has a hardware address, so we can compare it
-        if ( (*(*lease)->hwaddr_) == hwaddr) {
-            collection.push_back((*lease));
-        }
-    }
-
+    storage4_.getLeases(hwaddr, collection);
     return (collection);
 }
 
@@ -346,41 +385,17 @@ Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
               DHCPSRV_MEMFILE_GET_SUBID_HWADDR).arg(subnet_id)
         .arg(hwaddr.toText());
 
-    // We are going to use index #1 of the multi index container.
-    // We define SearchIndex locally in this function because
-    // currently only this function uses this index.
-    typedef Lease4Storage::nth_index<1>::type SearchIndex;
-    // Get the index.
-    const SearchIndex& idx = storage4_.get<1>();
-    // Try to find the lease using HWAddr and subnet id.
-    SearchIndex::const_iterator lease =
-        idx.find(boost::make_tuple(hwaddr.hwaddr_, subnet_id));
-    // Lease was not found. Return empty pointer to the caller.
-    if (lease == idx.end()) {
-        return (Lease4Ptr());
-    }
-
-    // Lease was found. Return it to the caller.
-    return (Lease4Ptr(new Lease4(**lease)));
+    Mutex::Locker locker(mutex_);
+    return (storage4_.getLease(hwaddr, subnet_id));
 }
 
 Lease4Collection
 Memfile_LeaseMgr::getLease4(const ClientId& client_id) const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_CLIENTID).arg(client_id.toText());
-    typedef Lease4Storage::nth_index<0>::type SearchIndex;
+    Mutex::Locker locker(mutex_);
     Lease4Collection collection;
-    const SearchIndex& idx = storage4_.get<0>();
-    for(SearchIndex::const_iterator lease = idx.begin();
-        lease != idx.end(); ++ lease) {
-
-        // client-id is not mandatory in DHCPv4. There can be a lease that does
-        // not have a client-id. Dereferencing null pointer would be a bad thing
-        if((*lease)->client_id_ && *(*lease)->client_id_ == client_id) {
-            collection.push_back((*lease));
-        }
-    }
-
+    storage4_.getLeases(client_id, collection);
     return (collection);
 }
 
@@ -393,24 +408,8 @@ Memfile_LeaseMgr::getLease4(const ClientId& client_id,
                                                         .arg(hwaddr.toText())
                                                         .arg(subnet_id);
 
-    // We are going to use index #3 of the multi index container.
-    // We define SearchIndex locally in this function because
-    // currently only this function uses this index.
-    typedef Lease4Storage::nth_index<3>::type SearchIndex;
-    // Get the index.
-    const SearchIndex& idx = storage4_.get<3>();
-    // Try to get the lease using client id, hardware address and subnet id.
-    SearchIndex::const_iterator lease =
-        idx.find(boost::make_tuple(client_id.getClientId(), hwaddr.hwaddr_,
-                                   subnet_id));
-
-    if (lease == idx.end()) {
-        // Lease was not found. Return empty pointer to the caller.
-        return (Lease4Ptr());
-    }
-
-    // Lease was found. Return it to the caller.
-    return (*lease);
+    Mutex::Locker locker(mutex_);
+    return (storage4_.getLease(client_id, hwaddr, subnet_id));
 }
 
 Lease4Ptr
@@ -420,21 +419,30 @@ Memfile_LeaseMgr::getLease4(const ClientId& client_id,
               DHCPSRV_MEMFILE_GET_SUBID_CLIENTID).arg(subnet_id)
               .arg(client_id.toText());
 
-    // We are going to use index #2 of the multi index container.
-    // We define SearchIndex locally in this function because
-    // currently only this function uses this index.
-    typedef Lease4Storage::nth_index<2>::type SearchIndex;
-    // Get the index.
-    const SearchIndex& idx = storage4_.get<2>();
-    // Try to get the lease using client id and subnet id.
-    SearchIndex::const_iterator lease =
-        idx.find(boost::make_tuple(client_id.getClientId(), subnet_id));
-    // Lease was not found. Return empty pointer to the caller.
-    if (lease == idx.end()) {
-        return (Lease4Ptr());
-    }
-    // Lease was found. Return it to the caller.
-    return (Lease4Ptr(new Lease4(**lease)));
+    Mutex::Locker locker(mutex_);
+    return (storage4_.getLease(client_id, subnet_id));
+}
+
+Lease4Collection
+Memfile_LeaseMgr::getLeases4(SubnetID subnet_id) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MEMFILE_GET_SUBID4)
+        .arg(subnet_id);
+
+    Mutex::Locker locker(mutex_);
+
+    // There is no index by subnet identifier, because this function is
+    // only used to populate the in-memory state of the allocators. The
+    // storage walks over all leases.
+    Lease4Collection collection;
+    storage4_.getLeases(subnet_id, collection);
+    return (collection);
+}
+
+void
+Memfile_LeaseMgr::countLeases4(LeaseCounts& counts) const {
+    Mutex::Locker locker(mutex_);
+    storage4_.countLeases(counts);
 }
 
 Lease6Ptr
@@ -444,6 +452,8 @@ Memfile_LeaseMgr::getLease6(Lease::Type type,
               DHCPSRV_MEMFILE_GET_ADDR6)
         .arg(addr.toText())
         .arg(Lease::typeToText(type));
+
+    Mutex::Locker locker(mutex_);
     Lease6Storage::iterator l = storage6_.find(addr);
     if (l == storage6_.end() || !(*l) || ((*l)->type_ != type)) {
         return (Lease6Ptr());
@@ -461,13 +471,15 @@ Memfile_LeaseMgr::getLeases6(Lease::Type type,
         .arg(duid.toText())
         .arg(Lease::typeToText(type));
 
+    Mutex::Locker locker(mutex_);
+
     // We are going to use index #1 of the multi index container.
     typedef Lease6Storage::nth_index<1>::type SearchIndex;
     // Get the index.
     const SearchIndex& idx = storage6_.get<1>();
     // Try to get the lease using the DUID, IAID and lease type.
     std::pair<SearchIndex::iterator, SearchIndex::iterator> l =
-        idx.equal_range(boost::make_tuple(duid.getDuid(), iaid, type));
+        idx.equal_range(boost::make_tuple(HashedIdentifier(duid), iaid, type));
     Lease6Collection collection;
     for(SearchIndex::iterator lease = l.first; lease != l.second; ++lease) {
         collection.push_back(Lease6Ptr(new Lease6(**lease)));
@@ -487,13 +499,15 @@ Memfile_LeaseMgr::getLeases6(Lease::Type type,
         .arg(duid.toText())
         .arg(Lease::typeToText(type));
 
+    Mutex::Locker locker(mutex_);
+
     // We are going to use index #1 of the multi index container.
     typedef Lease6Storage::nth_index<1>::type SearchIndex;
     // Get the index.
     const SearchIndex& idx = storage6_.get<1>();
     // Try to get the lease using the DUID, IAID and lease type.
     std::pair<SearchIndex::iterator, SearchIndex::iterator> l =
-        idx.equal_range(boost::make_tuple(duid.getDuid(), iaid, type));
+        idx.equal_range(boost::make_tuple(HashedIdentifier(duid), iaid, type));
     Lease6Collection collection;
     for(SearchIndex::iterator lease = l.first; lease != l.second; ++lease) {
         // Filter out the leases which subnet id doesn't match.
@@ -505,25 +519,71 @@ Memfile_LeaseMgr::getLeases6(Lease::Type type,
     return (collection);
 }
 
+void
+Memfile_LeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
+                                    const size_t max_leases) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MEMFILE_GET_EXPIRED4)
+        .arg(max_leases);
+
+    Mutex::Locker locker(mutex_);
+
+    // The leases expiring at the current time or later are not expired.
+    storage4_.getExpiredLeases(static_cast<int64_t>(time(NULL)), max_leases,
+                               expired_leases);
+}
+
+void
+Memfile_LeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
+                                    const size_t max_leases) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MEMFILE_GET_EXPIRED6)
+        .arg(max_leases);
+
+    Mutex::Locker locker(mutex_);
+
+    // We are going to use index #2 of the multi index container.
+    typedef Lease6Storage::nth_index<2>::type SearchIndex;
+    // Get the index.
+    const SearchIndex& idx = storage6_.get<2>();
+    // The leases expiring at the current time or later are not expired.
+    SearchIndex::const_iterator last =
+        idx.lower_bound(static_cast<int64_t>(time(NULL)));
+    size_t count = 0;
+    for (SearchIndex::const_iterator lease = idx.begin();
+         (lease != last) && ((max_leases == 0) || (count < max_leases));
+         ++lease, ++count) {
+        expired_leases.push_back(Lease6Ptr(new Lease6(**lease)));
+    }
+}
+
 void
 Memfile_LeaseMgr::updateLease4(const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_UPDATE_ADDR4).arg(lease->addr_.toText());
 
-    Lease4Storage::iterator lease_it = storage4_.find(lease->addr_);
-    if (lease_it == storage4_.end()) {
-        isc_throw(NoSuchLease, "failed to update the lease with address "
-                  << lease->addr_ << " - no such lease");
-    }
+    LeaseGroupCommit::Transaction transaction(group_commit_.get());
+    {
+        Mutex::Locker locker(mutex_);
+        CompactLease4Storage::iterator lease_it = storage4_.find(lease->addr_);
+        if (lease_it == storage4_.end()) {
+            isc_throw(NoSuchLease, "failed to update the lease with address "
+                      << lease->addr_ << " - no such lease");
+        }
+
+        // Try to write a lease to disk first. If this fails, the lease will
+        // not be inserted to the memory and the disk and in-memory data will
+        // remain consistent.
+        if (persistLeases(V4)) {
+            appendLease(*lease);
+        }
 
-    // Try to write a lease to disk first. If this fails, the lease will
-    // not be inserted to the memory and the disk and in-memory data will
-    // remain consistent.
-    if (persistLeases(V4)) {
-        lease_file4_->append(*lease);
+        // The storage holds a copy of the new lease.
+        storage4_.replace(lease_it, lease);
     }
 
-    **lease_it = *lease;
+    // Wait for the lease to be synced without holding the mutex.
+    transaction.commit();
 }
 
 void
@@ -531,33 +591,46 @@ Memfile_LeaseMgr::updateLease6(const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_UPDATE_ADDR6).arg(lease->addr_.toText());
 
-    Lease6Storage::iterator lease_it = storage6_.find(lease->addr_);
-    if (lease_it == storage6_.end()) {
-        isc_throw(NoSuchLease, "failed to update the lease with address "
-                  << lease->addr_ << " - no such lease");
-    }
+    LeaseGroupCommit::Transaction transaction(group_commit_.get());
+    {
+        Mutex::Locker locker(mutex_);
+        Lease6Storage::iterator lease_it = storage6_.find(lease->addr_);
+        if (lease_it == storage6_.end()) {
+            isc_throw(NoSuchLease, "failed to update the lease with address "
+                      << lease->addr_ << " - no such lease");
+        }
+
+        // Try to write a lease to disk first. If this fails, the lease will
+        // not be inserted to the memory and the disk and in-memory data will
+        // remain consistent.
+        if (persistLeases(V6)) {
+            appendLease(*lease);
+        }
 
-    // Try to write a lease to disk first. If this fails, the lease will
-    // not be inserted to the memory and the disk and in-memory data will
-    // remain consistent.
-    if (persistLeases(V6)) {
-        lease_file6_->append(*lease);
+        // Replace the stored lease with a copy of the new one rather than
+        // modify it in place, so as the storage indexes are updated.
+        storage6_.replace(lease_it, Lease6Ptr(new Lease6(*lease)));
     }
 
-    **lease_it = *lease;
+    // Wait for the lease to be synced without holding the mutex.
+    transaction.commit();
 }
 
 bool
 Memfile_LeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_DELETE_ADDR).arg(addr.toText());
-    if (addr.isV4()) {
-        // v4 lease
-        Lease4Storage::iterator l = storage4_.find(addr);
-        if (l == storage4_.end()) {
-            // No such lease
-            return (false);
-        } else {
+
+    LeaseGroupCommit::Transaction transaction(group_commit_.get());
+    {
+        Mutex::Locker locker(mutex_);
+        if (addr.isV4()) {
+            // v4 lease
+            CompactLease4Storage::iterator l = storage4_.find(addr);
+            if (l == storage4_.end()) {
+                // No such lease
+                return (false);
+            }
             if (persistLeases(V4)) {
                 // Copy the lease. The valid lifetime needs to be modified and
                 // we don't modify the original lease.
@@ -565,19 +638,17 @@ Memfile_LeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
                 // Setting valid lifetime to 0 means that lease is being
                 // removed.
                 lease_copy.valid_lft_ = 0;
-                lease_file4_->append(lease_copy);
+                appendLease(lease_copy);
             }
             storage4_.erase(l);
-            return (true);
-        }
 
-    } else {
-        // v6 lease
-        Lease6Storage::iterator l = storage6_.find(addr);
-        if (l == storage6_.end()) {
-            // No such lease
-            return (false);
         } else {
+            // v6 lease
+            Lease6Storage::iterator l = storage6_.find(addr);
+            if (l == storage6_.end()) {
+                // No such lease
+                return (false);
+            }
             if (persistLeases(V6)) {
                 // Copy the lease. The lifetimes need to be modified and we
                 // don't modify the original lease.
@@ -585,13 +656,15 @@ Memfile_LeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
                 // Setting lifetimes to 0 means that lease is being removed.
                 lease_copy.valid_lft_ = 0;
                 lease_copy.preferred_lft_ = 0;
-                lease_file6_->append(lease_copy);
+                appendLease(lease_copy);
             }
-
             storage6_.erase(l);
-            return (true);
         }
     }
+
+    // Wait for the deletion to be synced without holding the mutex.
+    transaction.commit();
+    return (true);
 }
 
 std::string
@@ -632,6 +705,12 @@ Memfile_LeaseMgr::appendSuffix(const std::string& file_name,
     case FILE_PID:
         name += ".pid";
         break;
+    case FILE_SEGMENT:
+        name += ".delta";
+        break;
+    case FILE_SEGMENT_FINISH:
+        name += ".delta.completed";
+        break;
     default:
         // Do not append any suffix for the FILE_CURRENT.
         ;
@@ -658,9 +737,15 @@ Memfile_LeaseMgr::getDefaultLeaseFilePath(Universe u) const {
 std::string
 Memfile_LeaseMgr::getLeaseFilePath(Universe u) const {
     if (u == V4) {
+        if (binary_lease_file4_) {
+            return (binary_lease_file4_->getFilename());
+        }
         return (lease_file4_ ? lease_file4_->getFilename() : "");
     }
 
+    if (binary_lease_file6_) {
+        return (binary_lease_file6_->getFilename());
+    }
     return (lease_file6_ ? lease_file6_->getFilename() : "");
 }
 
@@ -669,11 +754,186 @@ Memfile_LeaseMgr::persistLeases(Universe u) const {
     // Currently, if the lease file IO is not created, it means that writes to
     // disk have been explicitly disabled by the administrator. At some point,
     // there may be a dedicated ON/OFF flag implemented to control this.
-    if (u == V4 && lease_file4_) {
+    if (u == V4 && (lease_file4_ || binary_lease_file4_)) {
         return (true);
     }
 
-    return (u == V6 && lease_file6_);
+    return (u == V6 && (lease_file6_ || binary_lease_file6_));
+}
+
+bool
+Memfile_LeaseMgr::initBinaryFormat() const {
+    std::string format = "csv";
+    try {
+        format = getParameter("file-format");
+    } catch (const std::exception& ex) {
+        // Ignore and default to csv.
+    }
+
+    if ((format != "csv") && (format != "binary")) {
+        isc_throw(isc::BadValue, "invalid value of the file-format "
+                  << format << " specified");
+    }
+    return (format == "binary");
+}
+
+void
+Memfile_LeaseMgr::initSyncPolicy() {
+    std::string policy = "none";
+    try {
+        policy = getParameter("sync-policy");
+    } catch (const std::exception& ex) {
+        // Ignore and default to none.
+    }
+
+    if (policy == "none") {
+        sync_policy_ = SYNC_NONE;
+    } else if (policy == "write") {
+        sync_policy_ = SYNC_WRITE;
+    } else if (policy == "group") {
+        sync_policy_ = SYNC_GROUP;
+    } else {
+        isc_throw(isc::BadValue, "invalid value of the sync-policy "
+                  << policy << " specified");
+    }
+
+    std::string sync_interval_str = "2";
+    try {
+        sync_interval_str = getParameter("sync-interval");
+    } catch (const std::exception& ex) {
+        // Ignore and use the default.
+    }
+
+    uint32_t sync_interval = 0;
+    try {
+        sync_interval = boost::lexical_cast<uint32_t>(sync_interval_str);
+    } catch (boost::bad_lexical_cast& ex) {
+        isc_throw(isc::BadValue, "invalid value of the sync-interval "
+                  << sync_interval_str << " specified");
+    }
+
+    std::string sync_leases_str = "64";
+    try {
+        sync_leases_str = getParameter("sync-leases");
+    } catch (const std::exception& ex) {
+        // Ignore and use the default.
+    }
+
+    uint32_t sync_leases = 0;
+    try {
+        sync_leases = boost::lexical_cast<uint32_t>(sync_leases_str);
+    } catch (boost::bad_lexical_cast& ex) {
+        isc_throw(isc::BadValue, "invalid value of the sync-leases "
+                  << sync_leases_str << " specified");
+    }
+    if (sync_leases == 0) {
+        isc_throw(isc::BadValue, "the sync-leases must be greater than 0");
+    }
+
+    if (sync_policy_ == SYNC_GROUP) {
+        group_commit_.reset(new LeaseGroupCommit(boost::bind(&Memfile_LeaseMgr::
+                                                             syncLeaseFiles,
+                                                             this),
+                                                 sync_interval, sync_leases));
+    }
+
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_SYNC_SETUP)
+        .arg(policy).arg(sync_interval).arg(sync_leases);
+}
+
+void
+Memfile_LeaseMgr::syncLeaseFiles() {
+    // The data are written to the storage device after the mutex is
+    // released, so as other threads may append leases in the meantime.
+    // The duplicated descriptors remain valid if the files are closed.
+    std::vector<std::pair<int, std::string> > files;
+    {
+        Mutex::Locker locker(mutex_);
+        try {
+            if (lease_file4_) {
+                files.push_back(std::make_pair(lease_file4_->dupSyncDescriptor(),
+                                               lease_file4_->getFilename()));
+            }
+            if (lease_file6_) {
+                files.push_back(std::make_pair(lease_file6_->dupSyncDescriptor(),
+                                               lease_file6_->getFilename()));
+            }
+            if (binary_lease_file4_) {
+                files.push_back(std::make_pair(binary_lease_file4_->dupSyncDescriptor(),
+                                               binary_lease_file4_->getFilename()));
+            }
+            if (binary_lease_file6_) {
+                files.push_back(std::make_pair(binary_lease_file6_->dupSyncDescriptor(),
+                                               binary_lease_file6_->getFilename()));
+            }
+        } catch (...) {
+            for (size_t i = 0; i < files.size(); ++i) {
+                ::close(files[i].first);
+            }
+            throw;
+        }
+    }
+
+    std::ostringstream errors;
+    for (size_t i = 0; i < files.size(); ++i) {
+        const int err = CSVFile::syncDescriptor(files[i].first);
+        if (err != 0) {
+            if (!errors.str().empty()) {
+                errors << "; ";
+            }
+            errors << "unable to sync '" << files[i].second << "': "
+                   << strerror(err);
+        }
+    }
+    if (!errors.str().empty()) {
+        isc_throw(CSVFileError, errors.str());
+    }
+}
+
+void
+Memfile_LeaseMgr::syncLeaseFilesInternal() {
+    if (lease_file4_) {
+        lease_file4_->sync();
+    }
+    if (lease_file6_) {
+        lease_file6_->sync();
+    }
+    if (binary_lease_file4_) {
+        binary_lease_file4_->sync();
+    }
+    if (binary_lease_file6_) {
+        binary_lease_file6_->sync();
+    }
+}
+
+void
+Memfile_LeaseMgr::appendLease(const Lease4& lease) {
+    if (binary_lease_file4_) {
+        binary_lease_file4_->append(lease);
+    } else {
+        lease_file4_->append(lease);
+    }
+
+    if (sync_policy_ == SYNC_WRITE) {
+        syncLeaseFilesInternal();
+    } else if (group_commit_) {
+        group_commit_->recordWrite();
+    }
+}
+
+void
+Memfile_LeaseMgr::appendLease(const Lease6& lease) {
+    if (binary_lease_file6_) {
+        binary_lease_file6_->append(lease);
+    } else {
+        lease_file6_->append(lease);
+    }
+
+    if (sync_policy_ == SYNC_WRITE) {
+        syncLeaseFilesInternal();
+    } else if (group_commit_) {
+        group_commit_->recordWrite();
+    }
 }
 
 std::string
@@ -705,9 +965,13 @@ Memfile_LeaseMgr::initLeaseFilePath(Universe u) {
     return (lease_file);
 }
 
-template<typename LeaseObjectType, typename LeaseFileType, typename StorageType>
+template<typename LeaseObjectType, typename LeaseFileType,
+         typename BinaryLeaseFileType, typename StorageType>
 void Memfile_LeaseMgr::loadLeasesFromFiles(const std::string& filename,
+                                           const bool binary,
                                            boost::shared_ptr<LeaseFileType>& lease_file,
+                                           boost::shared_ptr<BinaryLeaseFileType>&
+                                           binary_lease_file,
                                            StorageType& storage) {
     // Check if the instance of the LFC is running right now. If it is
     // running, we refuse to load leases as the LFC may be writing to the
@@ -722,26 +986,48 @@ void Memfile_LeaseMgr::loadLeasesFromFiles(const std::string& filename,
     }
 
     storage.clear();
+    lease_file.reset();
+    binary_lease_file.reset();
+
+    // The files produced by the LFC may be in either format, e.g. when
+    // the format has been changed since the last cleanup, so the format
+    // of each file is detected by the loader.
 
     // Load the leasefile.completed, if exists.
-    lease_file.reset(new LeaseFileType(std::string(filename + ".completed")));
-    if (lease_file->exists()) {
-        LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                               MAX_LEASE_ERRORS);
+    const std::string completed_file = std::string(filename + ".completed");
+    if (LeaseFileType(completed_file).exists()) {
+        LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                                  BinaryLeaseFileType>
+            (completed_file, storage, MAX_LEASE_ERRORS);
 
     } else {
         // If the leasefile.completed doesn't exist, let's load the leases
         // from leasefile.2 and leasefile.1, if they exist.
-        lease_file.reset(new LeaseFileType(appendSuffix(filename, FILE_PREVIOUS)));
-        if (lease_file->exists()) {
-            LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                                   MAX_LEASE_ERRORS);
-        }
+        LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                                  BinaryLeaseFileType>
+            (appendSuffix(filename, FILE_PREVIOUS), storage, MAX_LEASE_ERRORS);
+
+        // The incremental cleanup stores the changes made since the
+        // leasefile.2 was written in the leasefile.delta. If the
+        // leasefile.delta.completed exists, it already contains the
+        // leases from the leasefile.delta and leasefile.1.
+        const std::string segment_finish_file =
+            appendSuffix(filename, FILE_SEGMENT_FINISH);
+        if (LeaseFileType(segment_finish_file).exists()) {
+            LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                                      BinaryLeaseFileType>
+                (segment_finish_file, storage, MAX_LEASE_ERRORS);
 
-        lease_file.reset(new LeaseFileType(appendSuffix(filename, FILE_INPUT)));
-        if (lease_file->exists()) {
-            LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                                   MAX_LEASE_ERRORS);
+        } else {
+            LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                                      BinaryLeaseFileType>
+                (appendSuffix(filename, FILE_SEGMENT), storage,
+                 MAX_LEASE_ERRORS);
+
+            LeaseFileLoader::loadFile<LeaseObjectType, LeaseFileType,
+                                      BinaryLeaseFileType>
+                (appendSuffix(filename, FILE_INPUT), storage,
+                 MAX_LEASE_ERRORS);
         }
     }
 
@@ -751,9 +1037,23 @@ void Memfile_LeaseMgr::loadLeasesFromFiles(const std::string& filename,
     // function causes the function to leave the file open after
     // it is parsed. This file will be used by the backend to record
     // future lease updates.
-    lease_file.reset(new LeaseFileType(filename));
-    LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                           MAX_LEASE_ERRORS, false);;
+    if (binary) {
+        binary_lease_file.reset(new BinaryLeaseFileType(filename));
+        LeaseFileLoader::load<LeaseObjectType>(*binary_lease_file, storage,
+                                               MAX_LEASE_ERRORS, false);
+
+    } else {
+        if (BinaryLeaseFile::isBinary(filename)) {
+            isc_throw(DbOpenError, "the lease file " << filename
+                      << " is in the binary format: set the file-format"
+                      " parameter to binary or convert the file with"
+                      " kea-lfc");
+        }
+        lease_file.reset(new LeaseFileType(filename));
+        LeaseFileLoader::loadParallel<LeaseObjectType>(*lease_file, storage,
+                                                       MAX_LEASE_ERRORS,
+                                                       false);
+    }
 }
 
 
@@ -771,12 +1071,28 @@ void
 Memfile_LeaseMgr::lfcCallback() {
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_START);
 
+    // The lease file is rotated, so make sure that no other thread
+    // appends leases to it at the same time.
+    Mutex::Locker locker(mutex_);
+
+    // The leases waiting for the group commit are written to the file
+    // being rotated, so they must be synced before it is renamed.
+    if (sync_policy_ != SYNC_NONE) {
+        syncLeaseFilesInternal();
+    }
+
     // Check if we're in the v4 or v6 space and use the appropriate file.
     if (lease_file4_) {
         lfcExecute(lease_file4_);
 
     } else if (lease_file6_) {
         lfcExecute(lease_file6_);
+
+    } else if (binary_lease_file4_) {
+        lfcExecute(binary_lease_file4_);
+
+    } else if (binary_lease_file6_) {
+        lfcExecute(binary_lease_file6_);
     }
 }
 
@@ -797,8 +1113,23 @@ Memfile_LeaseMgr::lfcSetup() {
                   << lfc_interval_str << " specified");
     }
 
+    std::string lfc_incremental_str = "false";
+    try {
+        lfc_incremental_str = getParameter("lfc-incremental");
+    } catch (const std::exception& ex) {
+        // Ignore and default to false.
+    }
+
+    if ((lfc_incremental_str != "true") && (lfc_incremental_str != "false")) {
+        isc_throw(isc::BadValue, "invalid value of the lfc-incremental "
+                  << lfc_incremental_str << " specified");
+    }
+
     if (lfc_interval > 0) {
-        lfc_setup_->setup(lfc_interval, lease_file4_, lease_file6_);
+        const Universe u = persistLeases(V4) ? V4 : V6;
+        lfc_setup_->setup(lfc_interval, lfc_incremental_str == "true",
+                          binary_lease_file4_ || binary_lease_file6_,
+                          getLeaseFilePath(u), u);
     }
 }
 
@@ -807,13 +1138,17 @@ void Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file)
     bool do_lfc = true;
 
     // Check the status of the LFC instance.
-    // If the finish file exists or the copy of the lease file exists it
-    // is an indication that another LFC instance may be in progress or
-    // may be stalled. In that case we don't want to rotate the current
-    // lease file to avoid overriding the contents of the existing file.
+    // If any of the finish files exists or the copy of the lease file
+    // exists it is an indication that another LFC instance may be in
+    // progress or may be stalled. In that case we don't want to rotate
+    // the current lease file to avoid overriding the contents of the
+    // existing file.
     CSVFile lease_file_finish(appendSuffix(lease_file->getFilename(), FILE_FINISH));
+    CSVFile lease_file_segment_finish(appendSuffix(lease_file->getFilename(),
+                                                   FILE_SEGMENT_FINISH));
     CSVFile lease_file_copy(appendSuffix(lease_file->getFilename(), FILE_INPUT));
-    if (!lease_file_finish.exists() && !lease_file_copy.exists()) {
+    if (!lease_file_finish.exists() && !lease_file_segment_finish.exists() &&
+        !lease_file_copy.exists()) {
         // Close the current file so as we can move it to the copy file.
         lease_file->close();
         // Move the current file to the copy file. Remember the result
@@ -836,7 +1171,7 @@ void Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file)
         try {
             lease_file->open(true);
 
-        } catch (const CSVFileError& ex) {
+        } catch (const isc::Exception& ex) {
             // If we're unable to open the lease file this is a serious
             // error because the server will not be able to persist
             // leases.
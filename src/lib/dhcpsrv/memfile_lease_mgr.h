@@ -17,11 +17,16 @@
 
 #include <asiolink/interval_timer.h>
 #include <dhcp/hwaddr.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
+#include <dhcpsrv/compact_lease_storage.h>
 #include <dhcpsrv/csv_lease_file4.h>
 #include <dhcpsrv/csv_lease_file6.h>
+#include <dhcpsrv/lease_group_commit.h>
 #include <dhcpsrv/memfile_lease_storage.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <util/process_spawn.h>
+#include <util/threads/sync.h>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
@@ -37,6 +42,17 @@ class LFCSetup;
 /// DHCPv4 and DHCPv6 leases on disk. The format of the files is determined
 /// by the @c CSVLeaseFile4 and @c CSVLeaseFile6 classes.
 ///
+/// When the "file-format" parameter is set to "binary", the backend uses
+/// the binary lease files instead (see @c BinaryLeaseFile4 and
+/// @c BinaryLeaseFile6), which are cheaper to write and to read. The lease
+/// files produced by the previous cleanups are read regardless of their
+/// format, but the current lease file must be in the configured format.
+/// The @c kea-lfc converts the lease files between the formats.
+///
+/// The DHCPv4 leases are held in the @c CompactLease4Storage, which
+/// stores them in fixed size records rather than in separately allocated
+/// objects, and the copies of the leases are returned to the caller.
+///
 /// In order to obtain good performance, the backend stores leases
 /// incrementally, i.e. updates to leases are appended at the end of the lease
 /// file. To record the deletion of a lease, the lease record is appended to
@@ -46,6 +62,13 @@ class LFCSetup;
 /// problem, the backend implements the Lease File Cleanup mechanism which is
 /// described on the Kea wiki: http://kea.isc.org/wiki/LFCDesign.
 ///
+/// By default, each cleanup rewrites all leases. When the @c lfc-incremental
+/// parameter is set to true, the cleanup writes the leases changed since the
+/// last full cleanup to the delta segment file instead, so as its cost is
+/// proportional to the number of lease changes rather than to the number of
+/// leases. The segment is merged into the previous lease file when it grows
+/// large in comparison with that file.
+///
 /// The backend installs an @c asiolink::IntervalTimer to periodically execute
 /// the @c Memfile_LeaseMgr::lfcCallback. This callback function controls
 /// the startup of the background process which removes redundant information
@@ -72,6 +95,24 @@ class LFCSetup;
 /// removal or addition of the lease is appended to the lease file
 /// synchronously.
 ///
+/// The appended leases are not synced to the storage device by default, so
+/// the leases handed out shortly before a system crash may be lost. The
+/// "sync-policy" parameter controls when the lease file is synced:
+/// - "none" (default) - the file is never synced explicitly,
+/// - "write" - the file is synced after each lease is appended,
+/// - "group" - the leases appended by the concurrently processed packets
+/// are synced together (see @c LeaseGroupCommit). The leader waits at most
+/// "sync-interval" milliseconds (default 2) or until "sync-leases" leases
+/// (default 64) are waiting before syncing the file.
+///
+/// With the "write" and "group" policies, the methods adding, updating and
+/// deleting the leases return when the lease is durable.
+///
+/// The backend may be used by multiple threads processing packets
+/// concurrently. Access to the lease containers and lease files is
+/// serialized with a mutex and the leases are always returned as copies
+/// of the stored leases, so as the caller may modify them freely.
+///
 /// Originally, the Memfile backend didn't write leases to disk. This was
 /// particularly useful for testing server performance in non-disk bound
 /// conditions. In order to preserve this capability, the new parameter
@@ -217,6 +258,27 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const;
 
+    /// @brief Returns all IPv4 leases for the particular subnet identifier.
+    ///
+    /// This function returns a copy of the leases. The modification in the
+    /// returned leases does not affect the instances held in the lease
+    /// storage.
+    ///
+    /// @param subnet_id identifier of the subnet that leases must belong to
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    virtual Lease4Collection getLeases4(SubnetID subnet_id) const;
+
+    /// @brief Counts the IPv4 leases in the subnets.
+    ///
+    /// The leases of all subnets are counted in a single pass over the
+    /// lease storage.
+    ///
+    /// @param [in,out] counts Map holding the identifiers of the subnets
+    /// for which the leases are counted. The numbers of leases in these
+    /// subnets are stored in the map.
+    virtual void countLeases4(LeaseCounts& counts) const;
+
     /// @brief Returns existing IPv6 lease for a given IPv6 address.
     ///
     /// This function returns a copy of the lease. The modification in the
@@ -256,6 +318,33 @@ public:
                                         uint32_t iaid,
                                         SubnetID subnet_id) const;
 
+    /// @brief Returns a collection of expired DHCPv4 leases.
+    ///
+    /// The leases are found using the index sorting leases by their
+    /// expiration time, so the cost of this operation is proportional
+    /// to the number of returned leases rather than the number of all
+    /// leases. The returned leases are copies of the stored leases.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    virtual void getExpiredLeases4(Lease4Collection& expired_leases,
+                                   const size_t max_leases) const;
+
+    /// @brief Returns a collection of expired DHCPv6 leases.
+    ///
+    /// The leases are found using the index sorting leases by their
+    /// expiration time. The returned leases are copies of the stored
+    /// leases.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    virtual void getExpiredLeases6(Lease6Collection& expired_leases,
+                                   const size_t max_leases) const;
+
     /// @brief Updates IPv4 lease.
     ///
     /// @warning This function does not validate the pointer to the lease.
@@ -344,7 +433,9 @@ public:
         FILE_PREVIOUS, ///< Previous %Lease File
         FILE_OUTPUT,   ///< LFC Output File
         FILE_FINISH,   ///< LFC Finish File
-        FILE_PID       ///< PID File
+        FILE_PID,      ///< PID File
+        FILE_SEGMENT,  ///< LFC Delta Segment File
+        FILE_SEGMENT_FINISH ///< LFC Delta Segment Finish File
     };
 
     /// @brief Appends appropriate suffix to the file name.
@@ -357,6 +448,8 @@ public:
     /// - LFC Output File: ".output"
     /// - LFC Finish File: ".completed"
     /// - LFC PID File: ".pid"
+    /// - LFC Delta Segment File: ".delta"
+    /// - LFC Delta Segment Finish File: ".delta.completed"
     ///
     /// See http://kea.isc.org/wiki/LFCDesign for details.
     ///
@@ -474,24 +567,95 @@ private:
     /// @todo Consider implementing delaying the lease files loading when
     /// the LFC is in progress by the specified amount of time.
     ///
+    /// The lease files produced by the LFC may be in the CSV or binary
+    /// format. The format of the <filename> must match the format
+    /// specified with the "file-format" parameter.
+    ///
     /// @param filename Name of the lease file.
-    /// @param lease_file An object representing a lease file to which
-    /// the server will store lease updates.
+    /// @param binary A boolean value indicating if the lease file is in
+    /// the binary format.
+    /// @param lease_file An object representing a CSV lease file to which
+    /// the server will store lease updates. It is set when the @c binary
+    /// is false.
+    /// @param binary_lease_file An object representing a binary lease file
+    /// to which the server will store lease updates. It is set when the
+    /// @c binary is true.
     /// @param storage A storage for leases read from the lease file.
     /// @tparam LeaseObjectType @c Lease4 or @c Lease6.
     /// @tparam LeaseFileType @c CSVLeaseFile4 or @c CSVLeaseFile6.
-    /// @tparam StorageType @c Lease4Storage or @c Lease6Storage.
+    /// @tparam BinaryLeaseFileType @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam StorageType @c CompactLease4Storage or @c Lease6Storage.
     ///
     /// @throw CSVFileError when parsing any of the lease files fails.
-    /// @throw DbOpenError when it is found that the LFC is in progress.
+    /// @throw BinaryLeaseFileError when the current lease file is not
+    /// a binary lease file.
+    /// @throw DbOpenError when it is found that the LFC is in progress or
+    /// the current lease file is not a CSV file.
     template<typename LeaseObjectType, typename LeaseFileType,
-             typename StorageType>
-    void loadLeasesFromFiles(const std::string& filename,
+             typename BinaryLeaseFileType, typename StorageType>
+    void loadLeasesFromFiles(const std::string& filename, const bool binary,
                              boost::shared_ptr<LeaseFileType>& lease_file,
+                             boost::shared_ptr<BinaryLeaseFileType>&
+                             binary_lease_file,
                              StorageType& storage);
 
+    /// @brief Checks if the leases are stored in the binary lease files.
+    ///
+    /// @return true if the "file-format" parameter is set to "binary",
+    /// false if it is set to "csv" or not specified.
+    /// @throw BadValue if the parameter has an invalid value.
+    bool initBinaryFormat() const;
+
+    /// @brief Policy of syncing the lease files.
+    enum SyncPolicy {
+        /// The lease files are not synced.
+        SYNC_NONE,
+        /// The lease file is synced after each write.
+        SYNC_WRITE,
+        /// The writes of the concurrent updates are synced together.
+        SYNC_GROUP
+    };
+
+    /// @brief Creates the group commit according to the sync parameters.
+    ///
+    /// Sets the @c sync_policy_ according to the "sync-policy" parameter
+    /// and creates the @c group_commit_ for the "group" policy.
+    ///
+    /// @throw BadValue if any of the parameters has an invalid value.
+    void initSyncPolicy();
+
+    /// @brief Syncs the current lease file.
+    ///
+    /// The file is flushed with the mutex locked, but the data are written
+    /// to the storage device after the mutex is released.
+    ///
+    /// @throw CSVFileError or BinaryLeaseFileError if the sync fails.
+    void syncLeaseFiles();
+
+    /// @brief Syncs the current lease file.
+    ///
+    /// Must be called with the mutex locked.
+    void syncLeaseFilesInternal();
+
+    /// @brief Appends the DHCPv4 lease to the current lease file.
+    ///
+    /// Depending on the sync policy, the file is synced or the write is
+    /// recorded for the group commit. Must be called with the mutex locked.
+    ///
+    /// @param lease Lease to be appended.
+    void appendLease(const Lease4& lease);
+
+    /// @brief Appends the DHCPv6 lease to the current lease file.
+    ///
+    /// Depending on the sync policy, the file is synced or the write is
+    /// recorded for the group commit. Must be called with the mutex locked.
+    ///
+    /// @param lease Lease to be appended.
+    void appendLease(const Lease6& lease);
+
     /// @brief stores IPv4 leases
-    Lease4Storage storage4_;
+    CompactLease4Storage storage4_;
 
     /// @brief stores IPv6 leases
     Lease6Storage storage6_;
@@ -502,6 +666,21 @@ private:
     /// @brief Holds the pointer to the DHCPv6 lease file IO.
     boost::shared_ptr<CSVLeaseFile6> lease_file6_;
 
+    /// @brief Holds the pointer to the DHCPv4 binary lease file IO.
+    boost::shared_ptr<BinaryLeaseFile4> binary_lease_file4_;
+
+    /// @brief Holds the pointer to the DHCPv6 binary lease file IO.
+    boost::shared_ptr<BinaryLeaseFile6> binary_lease_file6_;
+
+    /// @brief Mutex protecting the lease containers and lease files.
+    mutable isc::util::thread::Mutex mutex_;
+
+    /// @brief Policy of syncing the lease files.
+    SyncPolicy sync_policy_;
+
+    /// @brief Group commit used with the "group" sync policy.
+    boost::scoped_ptr<LeaseGroupCommit> group_commit_;
+
 public:
 
     /// @name Public methods to retrieve information about the LFC process state.
@@ -553,7 +732,9 @@ private:
     /// is set to a non-zero value and sets up the interval timer to
     /// perform the %Lease File Cleanup periodically. It also prepares the
     /// path and arguments for the @c kea-lfc application which will be
-    /// executed to perform the cleanup. By default the backend will use
+    /// executed to perform the cleanup. If the @c lfc-incremental parameter
+    /// is set to true, the @c kea-lfc is instructed to perform the
+    /// incremental cleanup. By default the backend will use
     /// the path to the kea-lfc in the Kea installation directory. If
     /// the unit tests need to override this path (with the path in the
     /// Kea build directory, the @c KEA_LFC_EXECUTABLE environmental
@@ -579,10 +760,15 @@ private:
     /// any lease entries. If the file has been successfully moved, it runs
     /// the @c kea-lfc application.
     ///
+    /// The Current %Lease File is not moved if any of the LFC Finish File
+    /// or the LFC Delta Segment Finish File exist, because they indicate
+    /// that the previous cleanup hasn't completed.
+    ///
     /// @param lease_file A pointer to the object representing the Current
     /// %Lease File (DHCPv4 or DHCPv6 lease file).
     ///
-    /// @tparam LeaseFileType One of @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam LeaseFileType One of @c CSVLeaseFile4, @c CSVLeaseFile6,
+    /// @c BinaryLeaseFile4 or @c BinaryLeaseFile6.
     template<typename LeaseFileType>
     void lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file);
 
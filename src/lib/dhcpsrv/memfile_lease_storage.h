@@ -19,6 +19,9 @@
 #include <dhcpsrv/lease.h>
 #include <dhcpsrv/subnet_id.h>
 
+#include <boost/functional/hash.hpp>
+#include <boost/multi_index/global_fun.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/indexed_by.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
@@ -26,16 +29,126 @@
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/composite_key.hpp>
 
+#include <cstring>
+#include <stdint.h>
 #include <vector>
 
 namespace isc {
 namespace dhcp {
 
+/// @brief Client identifier used as a key of the hashed lease indexes.
+///
+/// It refers to the bytes of the HW address, client identifier or DUID
+/// and holds their hash. The identifiers are compared by the hash first,
+/// so the lookups compare the bytes of the identifiers only when they
+/// are likely equal. The @c DUID and @c ClientId objects compute their
+/// hash when created, so the hash of the leases' identifiers isn't
+/// computed for each lookup.
+///
+/// The hash is the lower 32 bits of the value returned by the
+/// @c boost::hash_range for the bytes.
+struct HashedIdentifier {
+    /// @brief Constructor.
+    ///
+    /// @param data Pointer to the first byte.
+    /// @param len Number of bytes.
+    /// @param hash Hash of the bytes returned by @c hash.
+    HashedIdentifier(const uint8_t* data, const size_t len,
+                     const uint32_t hash)
+        : data_(data), len_(len), hash_(hash) {
+    }
+
+    /// @brief Constructor.
+    ///
+    /// Computes the hash of the bytes.
+    ///
+    /// @param vec Vector holding the bytes. It must outlive this object.
+    explicit HashedIdentifier(const std::vector<uint8_t>& vec)
+        : data_(vec.empty() ? NULL : &vec[0]), len_(vec.size()),
+          hash_(hash(data_, len_)) {
+    }
+
+    /// @brief Constructor.
+    ///
+    /// Uses the hash computed by the DUID.
+    ///
+    /// @param duid DUID or client identifier. It must outlive this object.
+    explicit HashedIdentifier(const DUID& duid)
+        : data_(&duid.getDuid()[0]), len_(duid.getDuid().size()),
+          hash_(static_cast<uint32_t>(duid.getHash())) {
+    }
+
+    /// @brief Computes the hash of the bytes.
+    ///
+    /// @param data Pointer to the first byte.
+    /// @param len Number of bytes.
+    static uint32_t hash(const uint8_t* data, const size_t len) {
+        return (static_cast<uint32_t>(boost::hash_range(data, data + len)));
+    }
+
+    /// @brief Pointer to the first byte.
+    const uint8_t* data_;
+
+    /// @brief Number of bytes.
+    size_t len_;
+
+    /// @brief Hash of the bytes.
+    uint32_t hash_;
+};
+
+/// @brief Checks if the identifiers hold the same bytes.
+inline bool
+operator==(const HashedIdentifier& a, const HashedIdentifier& b) {
+    return ((a.hash_ == b.hash_) && (a.len_ == b.len_) &&
+            ((a.len_ == 0) || (memcmp(a.data_, b.data_, a.len_) == 0)));
+}
+
+/// @brief Returns the hash of the identifier.
+///
+/// It is used by the @c boost::hash.
+inline size_t
+hash_value(const HashedIdentifier& id) {
+    return (id.hash_);
+}
+
+/// @brief Returns the HW address of the lease as the index key.
+///
+/// The HW address may be modified, so its hash is computed here.
+///
+/// @param lease Lease.
+inline HashedIdentifier
+getHWAddrKey(const Lease& lease) {
+    return (HashedIdentifier(lease.getHWAddrVector()));
+}
+
+/// @brief Returns the client identifier of the lease as the index key.
+///
+/// @param lease Lease.
+inline HashedIdentifier
+getClientIdKey(const Lease4& lease) {
+    if (!lease.client_id_) {
+        return (HashedIdentifier(lease.getClientIdVector()));
+    }
+    return (HashedIdentifier(*lease.client_id_));
+}
+
+/// @brief Returns the DUID of the lease as the index key.
+///
+/// @param lease Lease.
+inline HashedIdentifier
+getDuidKey(const Lease6& lease) {
+    if (!lease.duid_) {
+        return (HashedIdentifier(lease.getDuidVector()));
+    }
+    return (HashedIdentifier(*lease.duid_));
+}
+
 /// @brief A multi index container holding DHCPv6 leases.
 ///
 /// The leases in the container may be accessed using different indexes:
 /// - using an IPv6 address,
-/// - using a composite index: DUID, IAID and lease type.
+/// - using a hashed composite index: DUID, IAID and lease type,
+/// - using an expiration time.
 typedef boost::multi_index_container<
     // It holds pointers to Lease6 objects.
     Lease6Ptr,
@@ -48,20 +161,28 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the second index starts here.
-        boost::multi_index::ordered_non_unique<
+        boost::multi_index::hashed_non_unique<
             // This is a composite index that will be used to search for
             // the lease using three attributes: DUID, IAID and lease type.
             boost::multi_index::composite_key<
                 Lease6,
-                // The DUID can be retrieved from the Lease6 object using
-                // a getDuidVector const function.
-                boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
-                                                  &Lease6::getDuidVector>,
+                // The DUID is returned with its hash by the getDuidKey
+                // function.
+                boost::multi_index::global_fun<const Lease6&, HashedIdentifier,
+                                               &getDuidKey>,
                 // The two other ingredients of this index are IAID and
                 // lease type.
                 boost::multi_index::member<Lease6, uint32_t, &Lease6::iaid_>,
                 boost::multi_index::member<Lease6, Lease::Type, &Lease6::type_>
             >
+        >,
+
+        // Specification of the third index starts here.
+        // This index sorts leases by their expiration time, so as the
+        // expired leases can be found without iterating over all leases.
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::const_mem_fun<Lease, int64_t,
+                                              &Lease::getExpirationTime>
         >
      >
 > Lease6Storage; // Specify the type name of this container.
@@ -70,9 +191,10 @@ typedef boost::multi_index_container<
 ///
 /// The leases in the container may be accessed using different indexes:
 /// - IPv6 address,
-/// - composite index: HW address and subnet id,
-/// - composite index: client id and subnet id,
-/// - composite index: HW address, client id and subnet id
+/// - hashed composite index: HW address and subnet id,
+/// - hashed composite index: client id and subnet id,
+/// - hashed composite index: client id, HW address and subnet id,
+/// - expiration time.
 typedef boost::multi_index_container<
     // It holds pointers to Lease4 objects.
     Lease4Ptr,
@@ -88,7 +210,7 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the second index starts here.
-        boost::multi_index::ordered_non_unique<
+        boost::multi_index::hashed_non_unique<
             // This is a composite index that combines two attributes of the
             // Lease4 object: hardware address and subnet id.
             boost::multi_index::composite_key<
@@ -96,9 +218,9 @@ typedef boost::multi_index_container<
                 // The hardware address is held in the hwaddr_ member of the
                 // Lease4 object, which is a HWAddr object. Boost does not
                 // provide a key extractor for getting a member of a member,
-                // so we need a simple method for that.
-                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
-                                                  &Lease::getHWAddrVector>,
+                // so we need a simple function for that.
+                boost::multi_index::global_fun<const Lease&, HashedIdentifier,
+                                               &getHWAddrKey>,
                 // The subnet id is held in the subnet_id_ member of Lease4
                 // class. Note that the subnet_id_ is defined in the base
                 // class (Lease) so we have to point to this class rather
@@ -108,39 +230,47 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the third index starts here.
-        boost::multi_index::ordered_non_unique<
+        boost::multi_index::hashed_non_unique<
             // This is a composite index that uses two values to search for a
             // lease: client id and subnet id.
             boost::multi_index::composite_key<
                 Lease4,
-                // The client id can be retrieved from the Lease4 object by
-                // calling getClientIdVector const function.
-                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
-                                                  &Lease4::getClientIdVector>,
+                // The client id is returned with its hash by the
+                // getClientIdKey function.
+                boost::multi_index::global_fun<const Lease4&, HashedIdentifier,
+                                               &getClientIdKey>,
                 // The subnet id is accessed through the subnet_id_ member.
                 boost::multi_index::member<Lease, uint32_t, &Lease::subnet_id_>
             >
         >,
 
         // Specification of the fourth index starts here.
-        boost::multi_index::ordered_non_unique<
+        boost::multi_index::hashed_non_unique<
             // This is a composite index that uses three values to search for a
             // lease: client id, HW address and subnet id.
             boost::multi_index::composite_key<
                 Lease4,
-                // The client id can be retrieved from the Lease4 object by
-                // calling getClientIdVector const function.
-                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
-                                                  &Lease4::getClientIdVector>,
+                // The client id is returned with its hash by the
+                // getClientIdKey function.
+                boost::multi_index::global_fun<const Lease4&, HashedIdentifier,
+                                               &getClientIdKey>,
                 // The hardware address is held in the hwaddr_ object. We can
                 // access the raw data using lease->hwaddr_->hwaddr_, but Boost
                 // doesn't seem to provide a way to use member of a member for this,
-                // so we need a simple key extractor method (getHWAddrVector).
-                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
-                                                  &Lease::getHWAddrVector>,
+                // so we need a simple key extractor function (getHWAddrKey).
+                boost::multi_index::global_fun<const Lease&, HashedIdentifier,
+                                               &getHWAddrKey>,
                 // The subnet id is accessed through the subnet_id_ member.
                 boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
             >
+        >,
+
+        // Specification of the fifth index starts here.
+        // This index sorts leases by their expiration time, so as the
+        // expired leases can be found without iterating over all leases.
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::const_mem_fun<Lease, int64_t,
+                                              &Lease::getExpirationTime>
         >
     >
 > Lease4Storage; // Specify the type name for this container.
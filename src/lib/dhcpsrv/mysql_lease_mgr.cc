@@ -20,17 +20,20 @@
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/mysql_lease_mgr.h>
 
+#include <boost/bind.hpp>
 #include <boost/static_assert.hpp>
 #include <mysqld_error.h>
 
 #include <iostream>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <time.h>
 
 using namespace isc;
 using namespace isc::dhcp;
+using namespace isc::util::thread;
 using namespace std;
 
 /// @file
@@ -123,6 +126,10 @@ struct TaggedStatement {
 };
 
 TaggedStatement tagged_statements[] = {
+    {MySqlLeaseMgr::COUNT_LEASE4_SUBID,
+                    "SELECT subnet_id, COUNT(*) "
+                            "FROM lease4 "
+                            "GROUP BY subnet_id"},
     {MySqlLeaseMgr::DELETE_LEASE4,
                     "DELETE FROM lease4 WHERE address = ?"},
     {MySqlLeaseMgr::DELETE_LEASE6,
@@ -157,6 +164,20 @@ TaggedStatement tagged_statements[] = {
                         "fqdn_fwd, fqdn_rev, hostname "
                             "FROM lease4 "
                             "WHERE hwaddr = ? AND subnet_id = ?"},
+    {MySqlLeaseMgr::GET_LEASE4_EXPIRE,
+                    "SELECT address, hwaddr, client_id, "
+                        "valid_lifetime, expire, subnet_id, "
+                        "fqdn_fwd, fqdn_rev, hostname "
+                            "FROM lease4 "
+                            "WHERE expire < ? "
+                            "ORDER BY expire "
+                            "LIMIT ?"},
+    {MySqlLeaseMgr::GET_LEASE4_SUBID,
+                    "SELECT address, hwaddr, client_id, "
+                        "valid_lifetime, expire, subnet_id, "
+                        "fqdn_fwd, fqdn_rev, hostname "
+                            "FROM lease4 "
+                            "WHERE subnet_id = ?"},
     {MySqlLeaseMgr::GET_LEASE6_ADDR,
                     "SELECT address, duid, valid_lifetime, "
                         "expire, subnet_id, pref_lifetime, "
@@ -182,6 +203,16 @@ TaggedStatement tagged_statements[] = {
                             "FROM lease6 "
                             "WHERE duid = ? AND iaid = ? AND subnet_id = ? "
                             "AND lease_type = ?"},
+    {MySqlLeaseMgr::GET_LEASE6_EXPIRE,
+                    "SELECT address, duid, valid_lifetime, "
+                        "expire, subnet_id, pref_lifetime, "
+                        "lease_type, iaid, prefix_len, "
+                        "fqdn_fwd, fqdn_rev, hostname, "
+                        "hwaddr, hwtype, hwaddr_source "
+                            "FROM lease6 "
+                            "WHERE expire < ? "
+                            "ORDER BY expire "
+                            "LIMIT ?"},
     {MySqlLeaseMgr::GET_VERSION,
                     "SELECT version, minor FROM schema_version"},
     {MySqlLeaseMgr::INSERT_LEASE4,
@@ -213,6 +244,51 @@ TaggedStatement tagged_statements[] = {
     {MySqlLeaseMgr::NUM_STATEMENTS, NULL}
 };
 
+// Functions matching the leases with pending changes in the write-behind
+// mode against the query criteria.
+
+bool
+hwaddrMatches(const Lease4& lease, const HWAddr& hwaddr) {
+    return (lease.hwaddr_ && (lease.hwaddr_->hwaddr_ == hwaddr.hwaddr_));
+}
+
+bool
+hwaddrSubnetMatches(const Lease4& lease, const HWAddr& hwaddr,
+                    const SubnetID subnet_id) {
+    return (hwaddrMatches(lease, hwaddr) && (lease.subnet_id_ == subnet_id));
+}
+
+bool
+clientIdMatches(const Lease4& lease, const ClientId& clientid) {
+    return (lease.client_id_ && (*lease.client_id_ == clientid));
+}
+
+bool
+clientIdSubnetMatches(const Lease4& lease, const ClientId& clientid,
+                      const SubnetID subnet_id) {
+    return (clientIdMatches(lease, clientid) && (lease.subnet_id_ == subnet_id));
+}
+
+bool
+subnetMatches(const Lease4& lease, const SubnetID subnet_id) {
+    return (lease.subnet_id_ == subnet_id);
+}
+
+bool
+duidIaidMatches(const Lease6& lease, const Lease::Type lease_type,
+                const DUID& duid, const uint32_t iaid) {
+    return ((lease.type_ == lease_type) && lease.duid_ &&
+            (*lease.duid_ == duid) && (lease.iaid_ == iaid));
+}
+
+bool
+duidIaidSubnetMatches(const Lease6& lease, const Lease::Type lease_type,
+                      const DUID& duid, const uint32_t iaid,
+                      const SubnetID subnet_id) {
+    return (duidIaidMatches(lease, lease_type, duid, iaid) &&
+            (lease.subnet_id_ == subnet_id));
+}
+
 };  // Anonymous namespace
 
 
@@ -1247,10 +1323,39 @@ MySqlLeaseMgr::MySqlLeaseMgr(const LeaseMgr::ParameterMap& parameters)
     // program and the database.
     exchange4_.reset(new MySqlLease4Exchange());
     exchange6_.reset(new MySqlLease6Exchange());
+
+    std::string write_behind = "false";
+    try {
+        write_behind = getParameter("write-behind");
+    } catch (...) {
+        // No write-behind. Fine, the leases are written synchronously.
+    }
+
+    if (write_behind == "true") {
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MYSQL_WRITE_BEHIND);
+
+        // The changes are written by the separate lease manager using its
+        // own connection. It groups the changes in transactions, so the
+        // autocommit is disabled for it.
+        ParameterMap writer_parameters = parameters;
+        writer_parameters.erase("write-behind");
+        writer_.reset(new MySqlLeaseMgr(writer_parameters));
+        if (mysql_autocommit(writer_->mysql_, 0) != 0) {
+            isc_throw(DbOperationError, mysql_error(writer_->mysql_));
+        }
+        write_behind_.reset(new LeaseWriteBehind(*writer_));
+
+    } else if (write_behind != "false") {
+        isc_throw(BadValue, "invalid value 'write-behind="
+                  << write_behind << "'");
+    }
 }
 
 
 MySqlLeaseMgr::~MySqlLeaseMgr() {
+    // Write the pending changes before the writer is destroyed.
+    write_behind_.reset();
+
     // Free up the prepared statements, ignoring errors. (What would we do
     // about them? We're destroying this object and are not really concerned
     // with errors on a database connection that is about to go away.)
@@ -1495,9 +1600,25 @@ MySqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
 
 bool
 MySqlLeaseMgr::addLease(const Lease4Ptr& lease) {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_ADD_ADDR4).arg(lease->addr_.toText());
 
+    if (write_behind_) {
+        // The database can't report the conflict to the caller when the
+        // lease is written in background, so the lease is looked up before
+        // the addition is recorded.
+        Lease4Ptr existing;
+        LeaseWriteBehind::State state =
+            write_behind_->getLease4(lease->addr_, existing);
+        if ((state == LeaseWriteBehind::PRESENT) ||
+            ((state == LeaseWriteBehind::UNKNOWN) &&
+             getStoredLease4(lease->addr_))) {
+            return (false);
+        }
+        return (write_behind_->addLease(lease));
+    }
+
     // Create the MYSQL_BIND array for the lease
     std::vector<MYSQL_BIND> bind = exchange4_->createBindForSend(lease);
 
@@ -1507,10 +1628,24 @@ MySqlLeaseMgr::addLease(const Lease4Ptr& lease) {
 
 bool
 MySqlLeaseMgr::addLease(const Lease6Ptr& lease) {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_ADD_ADDR6).arg(lease->addr_.toText())
               .arg(lease->type_);
 
+    if (write_behind_) {
+        // See the comment in the addLease for the IPv4 lease.
+        Lease6Ptr existing;
+        LeaseWriteBehind::State state =
+            write_behind_->getLease6(lease->addr_, existing);
+        if ((state == LeaseWriteBehind::PRESENT) ||
+            ((state == LeaseWriteBehind::UNKNOWN) &&
+             getStoredLease6(lease->type_, lease->addr_))) {
+            return (false);
+        }
+        return (write_behind_->addLease(lease));
+    }
+
     // Create the MYSQL_BIND array for the lease
     std::vector<MYSQL_BIND> bind = exchange6_->createBindForSend(lease);
 
@@ -1641,15 +1776,75 @@ void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
     }
 }
 
+// In the write-behind mode, the leases read from the database are merged
+// with the pending changes. If the pending changes are written while the
+// leases are being read, the leases are read again.
+
+template<typename LeaseCollection, typename Predicate>
+void MySqlLeaseMgr::getLeaseCollection(StatementIndex stindex,
+                                       MYSQL_BIND* bind,
+                                       LeaseCollection& result,
+                                       const Predicate& predicate) const {
+    if (!write_behind_) {
+        getLeaseCollection(stindex, bind, result);
+        return;
+    }
+
+    uint64_t writes = 0;
+    do {
+        writes = write_behind_->getWrites();
+        result.clear();
+        getLeaseCollection(stindex, bind, result);
+    } while (!write_behind_->merge(result, predicate, writes));
+}
+
+template<typename LeasePtr, typename Predicate>
+void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
+                             LeasePtr& result,
+                             const Predicate& predicate) const {
+    if (!write_behind_) {
+        getLease(stindex, bind, result);
+        return;
+    }
+
+    std::vector<LeasePtr> collection;
+    getLeaseCollection(stindex, bind, collection, predicate);
+    if (collection.size() > 1) {
+        isc_throw(MultipleRecords, "multiple records were found in the "
+                  "database where only one was expected for query "
+                  << text_statements_[stindex]);
+    }
+
+    // Return single record if present, else clear the lease.
+    if (collection.empty()) {
+        result.reset();
+    } else {
+        result = *collection.begin();
+    }
+}
+
 
 // Basic lease access methods.  Obtain leases from the database using various
 // criteria.
 
 Lease4Ptr
 MySqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_ADDR4).arg(addr.toText());
 
+    // The pending changes supersede the database contents.
+    Lease4Ptr result;
+    if (write_behind_ &&
+        (write_behind_->getLease4(addr, result) != LeaseWriteBehind::UNKNOWN)) {
+        return (result);
+    }
+
+    return (getStoredLease4(addr));
+}
+
+Lease4Ptr
+MySqlLeaseMgr::getStoredLease4(const isc::asiolink::IOAddress& addr) const {
     // Set up the WHERE clause value
     MYSQL_BIND inbind[1];
     memset(inbind, 0, sizeof(inbind));
@@ -1669,6 +1864,7 @@ MySqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
 
 Lease4Collection
 MySqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_HWADDR).arg(hwaddr.toText());
 
@@ -1691,7 +1887,8 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_HWADDR, inbind, result);
+    getLeaseCollection(GET_LEASE4_HWADDR, inbind, result,
+                       boost::bind(&hwaddrMatches, _1, boost::cref(hwaddr)));
 
     return (result);
 }
@@ -1699,6 +1896,7 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
 Lease4Ptr
 MySqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_SUBID_HWADDR)
         .arg(subnet_id).arg(hwaddr.toText());
@@ -1726,7 +1924,9 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_HWADDR_SUBID, inbind, result);
+    getLease(GET_LEASE4_HWADDR_SUBID, inbind, result,
+             boost::bind(&hwaddrSubnetMatches, _1, boost::cref(hwaddr),
+                         subnet_id));
 
     return (result);
 }
@@ -1734,6 +1934,7 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
 Lease4Collection
 MySqlLeaseMgr::getLease4(const ClientId& clientid) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_CLIENTID).arg(clientid.toText());
 
@@ -1750,7 +1951,9 @@ MySqlLeaseMgr::getLease4(const ClientId& clientid) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_CLIENTID, inbind, result);
+    getLeaseCollection(GET_LEASE4_CLIENTID, inbind, result,
+                       boost::bind(&clientIdMatches, _1,
+                                   boost::cref(clientid)));
 
     return (result);
 }
@@ -1767,6 +1970,7 @@ MySqlLeaseMgr::getLease4(const ClientId&, const HWAddr&, SubnetID) const {
 
 Lease4Ptr
 MySqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_SUBID_CLIENTID)
               .arg(subnet_id).arg(clientid.toText());
@@ -1788,19 +1992,117 @@ MySqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_CLIENTID_SUBID, inbind, result);
+    getLease(GET_LEASE4_CLIENTID_SUBID, inbind, result,
+             boost::bind(&clientIdSubnetMatches, _1, boost::cref(clientid),
+                         subnet_id));
 
     return (result);
 }
 
+Lease4Collection
+MySqlLeaseMgr::getLeases4(SubnetID subnet_id) const {
+    Mutex::Locker locker(mutex_);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_GET_SUBID4)
+              .arg(subnet_id);
+
+    // Set up the WHERE clause value
+    MYSQL_BIND inbind[1];
+    memset(inbind, 0, sizeof(inbind));
+
+    inbind[0].buffer_type = MYSQL_TYPE_LONG;
+    inbind[0].buffer = reinterpret_cast<char*>(&subnet_id);
+    inbind[0].is_unsigned = MLM_TRUE;
+
+    // Get the data
+    Lease4Collection result;
+    getLeaseCollection(GET_LEASE4_SUBID, inbind, result,
+                       boost::bind(&subnetMatches, _1, subnet_id));
+
+    return (result);
+}
+
+void
+MySqlLeaseMgr::countLeases4(LeaseCounts& counts) const {
+    Mutex::Locker locker(mutex_);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_COUNT_LEASES4);
+
+    // The leases are only counted when the configuration is committed,
+    // so rather than merging the pending changes, wait until they are
+    // written.
+    if (write_behind_) {
+        write_behind_->flush();
+    }
+
+    const StatementIndex stindex = COUNT_LEASE4_SUBID;
+
+    // Bind the output of the statement to the appropriate variables.
+    uint32_t subnet_id;
+    int64_t count;
+    MYSQL_BIND outbind[2];
+    memset(outbind, 0, sizeof(outbind));
+
+    outbind[0].buffer_type = MYSQL_TYPE_LONG;
+    outbind[0].buffer = reinterpret_cast<char*>(&subnet_id);
+    outbind[0].is_unsigned = MLM_TRUE;
+
+    outbind[1].buffer_type = MYSQL_TYPE_LONGLONG;
+    outbind[1].buffer = reinterpret_cast<char*>(&count);
+    outbind[1].is_unsigned = MLM_FALSE;
+
+    int status = mysql_stmt_bind_result(statements_[stindex], outbind);
+    checkError(status, stindex, "unable to bind SELECT clause parameters");
+
+    status = mysql_stmt_execute(statements_[stindex]);
+    checkError(status, stindex, "unable to execute");
+
+    status = mysql_stmt_store_result(statements_[stindex]);
+    checkError(status, stindex, "unable to set up for storing all results");
+
+    // The subnets without leases are not returned by the query.
+    for (LeaseCounts::iterator it = counts.begin(); it != counts.end(); ++it) {
+        it->second = 0;
+    }
+
+    MySqlFreeResult fetch_release(statements_[stindex]);
+    while ((status = mysql_stmt_fetch(statements_[stindex])) == 0) {
+        LeaseCounts::iterator it = counts.find(subnet_id);
+        if (it != counts.end()) {
+            it->second = count;
+        }
+    }
+
+    if (status == 1) {
+        checkError(status, stindex, "unable to fetch results");
+    }
+}
+
 
 Lease6Ptr
 MySqlLeaseMgr::getLease6(Lease::Type lease_type,
                          const isc::asiolink::IOAddress& addr) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_ADDR6).arg(addr.toText())
               .arg(lease_type);
 
+    // The pending changes supersede the database contents.
+    Lease6Ptr result;
+    if (write_behind_ &&
+        (write_behind_->getLease6(addr, result) != LeaseWriteBehind::UNKNOWN)) {
+        if (result && (result->type_ != lease_type)) {
+            result.reset();
+        }
+        return (result);
+    }
+
+    return (getStoredLease6(lease_type, addr));
+}
+
+Lease6Ptr
+MySqlLeaseMgr::getStoredLease6(Lease::Type lease_type,
+                               const isc::asiolink::IOAddress& addr) const {
     // Set up the WHERE clause value
     MYSQL_BIND inbind[2];
     memset(inbind, 0, sizeof(inbind));
@@ -1830,6 +2132,7 @@ MySqlLeaseMgr::getLease6(Lease::Type lease_type,
 Lease6Collection
 MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
                           const DUID& duid, uint32_t iaid) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_IAID_DUID).arg(iaid).arg(duid.toText())
               .arg(lease_type);
@@ -1870,7 +2173,9 @@ MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID, inbind, result);
+    getLeaseCollection(GET_LEASE6_DUID_IAID, inbind, result,
+                       boost::bind(&duidIaidMatches, _1, lease_type,
+                                   boost::cref(duid), iaid));
 
     return (result);
 }
@@ -1879,6 +2184,7 @@ Lease6Collection
 MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
                           const DUID& duid, uint32_t iaid,
                           SubnetID subnet_id) const {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_IAID_SUBID_DUID)
               .arg(iaid).arg(subnet_id).arg(duid.toText())
@@ -1915,11 +2221,68 @@ MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID_SUBID, inbind, result);
+    getLeaseCollection(GET_LEASE6_DUID_IAID_SUBID, inbind, result,
+                       boost::bind(&duidIaidSubnetMatches, _1, lease_type,
+                                   boost::cref(duid), iaid, subnet_id));
 
     return (result);
 }
 
+void
+MySqlLeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
+                                 const size_t max_leases) const {
+    Mutex::Locker locker(mutex_);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_GET_EXPIRED4)
+        .arg(max_leases);
+    getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE4_EXPIRE);
+}
+
+void
+MySqlLeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
+                                 const size_t max_leases) const {
+    Mutex::Locker locker(mutex_);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MYSQL_GET_EXPIRED6)
+        .arg(max_leases);
+    getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE6_EXPIRE);
+}
+
+template<typename LeaseCollection>
+void
+MySqlLeaseMgr::getExpiredLeasesCommon(LeaseCollection& expired_leases,
+                                      const size_t max_leases,
+                                      StatementIndex statement_index) const {
+    // The expired leases are rarely retrieved, so rather than merging the
+    // pending changes, wait until they are written.
+    if (write_behind_) {
+        write_behind_->flush();
+    }
+
+    // Set up the WHERE clause value
+    MYSQL_BIND inbind[2];
+    memset(inbind, 0, sizeof(inbind));
+
+    // The leases which expiration time is earlier than the current time
+    // have expired.
+    MYSQL_TIME expire_time;
+    convertToDatabaseTime(time(NULL), 0, expire_time);
+    inbind[0].buffer_type = MYSQL_TYPE_TIMESTAMP;
+    inbind[0].buffer = reinterpret_cast<char*>(&expire_time);
+    inbind[0].buffer_length = sizeof(expire_time);
+
+    // If the number of leases is 0, all expired leases are returned.
+    // This is achieved by setting the limit to a very high value.
+    uint32_t limit = max_leases > 0 ? static_cast<uint32_t>(max_leases) :
+        std::numeric_limits<uint32_t>::max();
+    inbind[1].buffer_type = MYSQL_TYPE_LONG;
+    inbind[1].buffer = reinterpret_cast<char*>(&limit);
+    inbind[1].is_unsigned = MLM_TRUE;
+
+    // Get the data
+    getLeaseCollection(statement_index, inbind, expired_leases);
+}
+
 // Update lease methods.  These comprise common code that handles the actual
 // update, and type-specific methods that set up the parameters for the prepared
 // statement depending on the type of lease.
@@ -1954,11 +2317,26 @@ MySqlLeaseMgr::updateLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind,
 
 void
 MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    Mutex::Locker locker(mutex_);
     const StatementIndex stindex = UPDATE_LEASE4;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_UPDATE_ADDR4).arg(lease->addr_.toText());
 
+    if (write_behind_) {
+        // The update of the lease missing in the database would only fail
+        // in background, so the lease is looked up before the update is
+        // recorded.
+        Lease4Ptr existing;
+        if ((write_behind_->getLease4(lease->addr_, existing) ==
+             LeaseWriteBehind::UNKNOWN) && !getStoredLease4(lease->addr_)) {
+            isc_throw(NoSuchLease, "unable to update lease for address " <<
+                      lease->addr_ << " as it does not exist");
+        }
+        write_behind_->updateLease4(lease);
+        return;
+    }
+
     // Create the MYSQL_BIND array for the data being updated
     std::vector<MYSQL_BIND> bind = exchange4_->createBindForSend(lease);
 
@@ -1979,12 +2357,26 @@ MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
 void
 MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    Mutex::Locker locker(mutex_);
     const StatementIndex stindex = UPDATE_LEASE6;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_UPDATE_ADDR6).arg(lease->addr_.toText())
               .arg(lease->type_);
 
+    if (write_behind_) {
+        // See the comment in the updateLease4.
+        Lease6Ptr existing;
+        if ((write_behind_->getLease6(lease->addr_, existing) ==
+             LeaseWriteBehind::UNKNOWN) &&
+            !getStoredLease6(lease->type_, lease->addr_)) {
+            isc_throw(NoSuchLease, "unable to update lease for address " <<
+                      lease->addr_ << " as it does not exist");
+        }
+        write_behind_->updateLease6(lease);
+        return;
+    }
+
     // Create the MYSQL_BIND array for the data being updated
     std::vector<MYSQL_BIND> bind = exchange6_->createBindForSend(lease);
 
@@ -2031,9 +2423,19 @@ MySqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind) {
 
 bool
 MySqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_DELETE_ADDR).arg(addr.toText());
 
+    // If there are pending changes of the lease, the deletion is written
+    // with them. Otherwise, the lease is deleted from the database.
+    if (write_behind_) {
+        LeaseWriteBehind::State state = write_behind_->deleteLease(addr);
+        if (state != LeaseWriteBehind::UNKNOWN) {
+            return (state == LeaseWriteBehind::PRESENT);
+        }
+    }
+
     // Set up the WHERE clause value
     MYSQL_BIND inbind[1];
     memset(inbind, 0, sizeof(inbind));
@@ -2084,6 +2486,7 @@ MySqlLeaseMgr::getDescription() const {
 
 std::pair<uint32_t, uint32_t>
 MySqlLeaseMgr::getVersion() const {
+    Mutex::Locker locker(mutex_);
     const StatementIndex stindex = GET_VERSION;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -2135,7 +2538,11 @@ MySqlLeaseMgr::getVersion() const {
 
 void
 MySqlLeaseMgr::commit() {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_COMMIT);
+    if (write_behind_) {
+        write_behind_->flush();
+    }
     if (mysql_commit(mysql_) != 0) {
         isc_throw(DbOperationError, "commit failed: " << mysql_error(mysql_));
     }
@@ -2144,6 +2551,7 @@ MySqlLeaseMgr::commit() {
 
 void
 MySqlLeaseMgr::rollback() {
+    Mutex::Locker locker(mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_ROLLBACK);
     if (mysql_rollback(mysql_) != 0) {
         isc_throw(DbOperationError, "rollback failed: " << mysql_error(mysql_));
@@ -17,6 +17,8 @@
 
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/lease_mgr.h>
+#include <dhcpsrv/lease_write_behind.h>
+#include <util/threads/sync.h>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/utility.hpp>
@@ -78,7 +80,7 @@ private:
 // Define the current database schema values
 
 const uint32_t CURRENT_VERSION_VERSION = 2;
-const uint32_t CURRENT_VERSION_MINOR = 0;
+const uint32_t CURRENT_VERSION_MINOR = 1;
 
 
 // Forward declaration of the Lease exchange objects.  These classes are defined
@@ -103,6 +105,9 @@ public:
     /// - host - Host to which to connect (optional, defaults to "localhost")
     /// - user - Username under which to connect (optional)
     /// - password - Password for "user" on the database (optional)
+    /// - write-behind - "true" if the changes of the leases should be
+    ///   written to the database in background (optional, defaults to
+    ///   "false"). See @ref LeaseWriteBehind for details.
     ///
     /// If the database is successfully opened, the version number in the
     /// schema_version table will be checked against hard-coded value in
@@ -117,6 +122,7 @@ public:
     /// @throw isc::dhcp::DbOpenError Error opening the database
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
+    /// @throw isc::BadValue Invalid value of the write-behind parameter.
     MySqlLeaseMgr(const ParameterMap& parameters);
 
     /// @brief Destructor (closes database)
@@ -251,6 +257,27 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const;
 
+    /// @brief Returns all IPv4 leases for the particular subnet identifier.
+    ///
+    /// @param subnet_id identifier of the subnet that leases must belong to
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    virtual Lease4Collection getLeases4(SubnetID subnet_id) const;
+
+    /// @brief Counts the IPv4 leases in the subnets.
+    ///
+    /// The leases of all subnets are counted by a single query grouping
+    /// them by the subnet identifier. The pending changes held by the
+    /// write-behind buffer, if enabled, are written first.
+    ///
+    /// @param [in,out] counts Map holding the identifiers of the subnets
+    /// for which the leases are counted. The numbers of leases in these
+    /// subnets are stored in the map.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void countLeases4(LeaseCounts& counts) const;
+
     /// @brief Returns existing IPv6 lease for a given IPv6 address.
     ///
     /// For a given address, we assume that there will be only one lease.
@@ -314,6 +341,36 @@ public:
     virtual Lease6Collection getLeases6(Lease::Type type, const DUID& duid,
                                         uint32_t iaid, SubnetID subnet_id) const;
 
+    /// @brief Returns a collection of expired DHCPv4 leases.
+    ///
+    /// The leases are returned in the order of their expiration times,
+    /// starting from the lease which expired first.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void getExpiredLeases4(Lease4Collection& expired_leases,
+                                   const size_t max_leases) const;
+
+    /// @brief Returns a collection of expired DHCPv6 leases.
+    ///
+    /// The leases are returned in the order of their expiration times,
+    /// starting from the lease which expired first.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void getExpiredLeases6(Lease6Collection& expired_leases,
+                                   const size_t max_leases) const;
+
     /// @brief Updates IPv4 lease.
     ///
     /// Updates the record of the lease in the database (as identified by the
@@ -456,6 +513,7 @@ public:
     ///
     /// The contents of the enum are indexes into the list of SQL statements
     enum StatementIndex {
+        COUNT_LEASE4_SUBID,         // Count lease4 by subnet ID
         DELETE_LEASE4,              // Delete from lease4 by address
         DELETE_LEASE6,              // Delete from lease6 by address
         GET_LEASE4_ADDR,            // Get lease4 by address
@@ -463,9 +521,12 @@ public:
         GET_LEASE4_CLIENTID_SUBID,  // Get lease4 by client ID & subnet ID
         GET_LEASE4_HWADDR,          // Get lease4 by HW address
         GET_LEASE4_HWADDR_SUBID,    // Get lease4 by HW address & subnet ID
+        GET_LEASE4_EXPIRE,          // Get expired lease4
+        GET_LEASE4_SUBID,           // Get lease4 by subnet ID
         GET_LEASE6_ADDR,            // Get lease6 by address
         GET_LEASE6_DUID_IAID,       // Get lease6 by DUID and IAID
         GET_LEASE6_DUID_IAID_SUBID, // Get lease6 by DUID, IAID and subnet ID
+        GET_LEASE6_EXPIRE,          // Get expired lease6
         GET_VERSION,                // Obtain version number
         INSERT_LEASE4,              // Add entry to lease4 table
         INSERT_LEASE6,              // Add entry to lease6 table
@@ -617,6 +678,79 @@ private:
     void getLease(StatementIndex stindex, MYSQL_BIND* bind,
                    Lease6Ptr& result) const;
 
+    /// @brief Get IPv4 Lease Stored in the Database
+    ///
+    /// Returns the lease from the database, ignoring the changes pending
+    /// in the write-behind mode. Must be called with the mutex locked.
+    ///
+    /// @param addr Address of the lease.
+    ///
+    /// @return Pointer to the lease or NULL if the lease is not stored.
+    Lease4Ptr getStoredLease4(const isc::asiolink::IOAddress& addr) const;
+
+    /// @brief Get IPv6 Lease Stored in the Database
+    ///
+    /// Returns the lease from the database, ignoring the changes pending
+    /// in the write-behind mode. Must be called with the mutex locked.
+    ///
+    /// @param type Type of the lease.
+    /// @param addr Address of the lease.
+    ///
+    /// @return Pointer to the lease or NULL if the lease is not stored.
+    Lease6Ptr getStoredLease6(Lease::Type type,
+                              const isc::asiolink::IOAddress& addr) const;
+
+    /// @brief Get Lease Collection Merged with Pending Changes
+    ///
+    /// Gets a collection of leases. In the write-behind mode, the leases
+    /// with pending changes are replaced with the pending leases matching
+    /// the predicate.
+    ///
+    /// @param stindex Index of statement being executed
+    /// @param bind MYSQL_BIND array for input parameters
+    /// @param result LeaseCollection object returned.
+    /// @param predicate Function returning true for the pending leases
+    ///        matching the query of the statement.
+    template<typename LeaseCollection, typename Predicate>
+    void getLeaseCollection(StatementIndex stindex, MYSQL_BIND* bind,
+                            LeaseCollection& result,
+                            const Predicate& predicate) const;
+
+    /// @brief Get Lease Merged with Pending Changes
+    ///
+    /// Gets a single lease. In the write-behind mode, the pending lease
+    /// matching the predicate is returned instead of the lease from the
+    /// database.
+    ///
+    /// @param stindex Index of statement being executed
+    /// @param bind MYSQL_BIND array for input parameters
+    /// @param result Lease object returned
+    /// @param predicate Function returning true for the pending leases
+    ///        matching the query of the statement.
+    template<typename LeasePtr, typename Predicate>
+    void getLease(StatementIndex stindex, MYSQL_BIND* bind,
+                  LeasePtr& result, const Predicate& predicate) const;
+
+    /// @brief Get expired leases common code.
+    ///
+    /// This method retrieves expired DHCPv4 or DHCPv6 leases. It binds
+    /// the current time and the maximum number of leases to the prepared
+    /// statement and executes it.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    /// @param statement_index One of the @c GET_LEASE4_EXPIRE or
+    /// @c GET_LEASE6_EXPIRE.
+    ///
+    /// @tparam LeaseCollection Type of the container: @c Lease4Collection
+    /// or @c Lease6Collection.
+    template<typename LeaseCollection>
+    void getExpiredLeasesCommon(LeaseCollection& expired_leases,
+                                const size_t max_leases,
+                                StatementIndex statement_index) const;
+
     /// @brief Update lease common code
     ///
     /// Holds the common code for updating a lease.  It binds the parameters
@@ -685,9 +819,21 @@ private:
     /// declare them as "mutable".)
     boost::scoped_ptr<MySqlLease4Exchange> exchange4_; ///< Exchange object
     boost::scoped_ptr<MySqlLease6Exchange> exchange6_; ///< Exchange object
+
+    /// The exchange objects, prepared statements and the connection are
+    /// shared, so the calls from multiple threads are serialized with
+    /// this mutex.
+    mutable isc::util::thread::Mutex mutex_;
     MySqlHolder mysql_;
     std::vector<MYSQL_STMT*> statements_;       ///< Prepared statements
     std::vector<std::string> text_statements_;  ///< Raw text of statements
+
+    /// Lease manager writing the changes of the leases in the write-behind
+    /// mode, using its own connection.
+    boost::scoped_ptr<MySqlLeaseMgr> writer_;
+
+    /// Journal of the pending changes in the write-behind mode.
+    boost::scoped_ptr<LeaseWriteBehind> write_behind_;
 };
 
 }; // end of isc::dhcp namespace
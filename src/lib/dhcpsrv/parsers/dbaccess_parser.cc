@@ -57,10 +57,15 @@ DbAccessParser::build(isc::data::ConstElementPtr config_value) {
     values_copy["universe"] = ctx_.universe_ == Option::V4 ? "4" : "6";
 
     int64_t lfc_interval = 0;
+    int64_t connections = 1;
+    int64_t sync_interval = 0;
+    int64_t sync_leases = 1;
     // 3. Update the copy with the passed keywords.
     BOOST_FOREACH(ConfigPair param, config_value->mapValue()) {
         try {
-            if (param.first == "persist") {
+            if ((param.first == "persist") ||
+                (param.first == "write-behind") ||
+                (param.first == "lfc-incremental")) {
                 values_copy[param.first] = (param.second->boolValue() ?
                                             "true" : "false");
 
@@ -69,6 +74,21 @@ DbAccessParser::build(isc::data::ConstElementPtr config_value) {
                 values_copy[param.first] =
                     boost::lexical_cast<std::string>(lfc_interval);
 
+            } else if (param.first == "connections") {
+                connections = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(connections);
+
+            } else if (param.first == "sync-interval") {
+                sync_interval = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(sync_interval);
+
+            } else if (param.first == "sync-leases") {
+                sync_leases = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(sync_leases);
+
             } else {
                 values_copy[param.first] = param.second->stringValue();
             }
@@ -104,6 +124,27 @@ DbAccessParser::build(isc::data::ConstElementPtr config_value) {
                   << std::numeric_limits<uint32_t>::max());
     }
 
+    // d. Check that the number of connections is positive.
+    if (connections <= 0) {
+        isc_throw(BadValue, "connections value: " << connections
+                  << " is out of range, expected positive value");
+    }
+
+    // e. Check that the sync-interval and sync-leases are within a
+    // reasonable range.
+    if ((sync_interval < 0) ||
+        (sync_interval > std::numeric_limits<uint32_t>::max())) {
+        isc_throw(BadValue, "sync-interval value: " << sync_interval
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint32_t>::max());
+    }
+    if ((sync_leases <= 0) ||
+        (sync_leases > std::numeric_limits<uint32_t>::max())) {
+        isc_throw(BadValue, "sync-leases value: " << sync_leases
+                  << " is out of range, expected value: 1.."
+                  << std::numeric_limits<uint32_t>::max());
+    }
+
     // 5. If all is OK, update the stored keyword/value pairs.  We do this by
     // swapping contents - values_copy is destroyed immediately after the
     // operation (when the method exits), so we are not interested in its new
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <time.h>
@@ -44,6 +45,7 @@ const char DUPLICATE_KEY[] = ERRCODE_UNIQUE_VIOLATION;
 
 using namespace isc;
 using namespace isc::dhcp;
+using namespace isc::util::thread;
 using namespace std;
 
 namespace {
@@ -51,6 +53,9 @@ namespace {
 // Maximum number of parameters used in any single query
 const size_t MAX_PARAMETERS_IN_QUERY = 13;
 
+// Maximum number of connections opened to the database
+const unsigned MAX_CONNECTIONS = 64;
+
 /// @brief  Defines a single query
 struct TaggedStatement {
 
@@ -86,6 +91,13 @@ const size_t OID_VARCHAR = 1043;
 /// that the order columns appear in statement body must match the order they
 /// that the occur in the table.  This does not apply to the where clause.
 TaggedStatement tagged_statements[] = {
+    // COUNT_LEASE4_SUBID
+    { 0, { OID_NONE },
+      "count_lease4_subid",
+      "SELECT subnet_id, COUNT(*) "
+      "FROM lease4 "
+      "GROUP BY subnet_id"},
+
     // DELETE_LEASE4
     { 1, { OID_INT8 },
       "delete_lease4",
@@ -141,6 +153,26 @@ TaggedStatement tagged_statements[] = {
       "FROM lease4 "
       "WHERE hwaddr = $1 AND subnet_id = $2"},
 
+    // GET_LEASE4_EXPIRE
+    { 2, { OID_TIMESTAMP, OID_INT8 },
+      "get_lease4_expire",
+      "SELECT address, hwaddr, client_id, "
+        "valid_lifetime, extract(epoch from expire)::bigint, subnet_id, "
+        "fqdn_fwd, fqdn_rev, hostname "
+      "FROM lease4 "
+      "WHERE expire < $1 "
+      "ORDER BY expire "
+      "LIMIT $2"},
+
+    // GET_LEASE4_SUBID
+    { 1, { OID_INT8 },
+      "get_lease4_subid",
+      "SELECT address, hwaddr, client_id, "
+        "valid_lifetime, extract(epoch from expire)::bigint, subnet_id, "
+        "fqdn_fwd, fqdn_rev, hostname "
+      "FROM lease4 "
+      "WHERE subnet_id = $1"},
+
     // GET_LEASE6_ADDR
     { 2, { OID_VARCHAR, OID_INT2 },
       "get_lease6_addr",
@@ -169,6 +201,17 @@ TaggedStatement tagged_statements[] = {
       "WHERE lease_type = $1 "
         "AND duid = $2 AND iaid = $3 AND subnet_id = $4"},
 
+    // GET_LEASE6_EXPIRE
+    { 2, { OID_TIMESTAMP, OID_INT8 },
+      "get_lease6_expire",
+      "SELECT address, duid, valid_lifetime, "
+        "extract(epoch from expire)::bigint, subnet_id, pref_lifetime, "
+        "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname "
+      "FROM lease6 "
+      "WHERE expire < $1 "
+      "ORDER BY expire "
+      "LIMIT $2"},
+
     // GET_VERSION
     { 0, { OID_NONE },
       "get_version",
@@ -942,14 +985,12 @@ private:
     //@}
 };
 
-PgSqlLeaseMgr::PgSqlLeaseMgr(const LeaseMgr::ParameterMap& parameters)
-    : LeaseMgr(parameters), exchange4_(new PgSqlLease4Exchange()),
-    exchange6_(new PgSqlLease6Exchange()), conn_(NULL) {
-    openDatabase();
-    prepareStatements();
+PgSqlConnection::PgSqlConnection()
+    : conn_(NULL), exchange4_(new PgSqlLease4Exchange()),
+      exchange6_(new PgSqlLease6Exchange()) {
 }
 
-PgSqlLeaseMgr::~PgSqlLeaseMgr() {
+PgSqlConnection::~PgSqlConnection() {
     if (conn_) {
         // Deallocate the prepared queries.
         PGresult* r = PQexec(conn_, "DEALLOCATE all");
@@ -965,11 +1006,73 @@ PgSqlLeaseMgr::~PgSqlLeaseMgr() {
     }
 }
 
+PgSqlLeaseMgr::ConnectionHolder::ConnectionHolder(const PgSqlLeaseMgr& lease_mgr,
+                                                  const bool wait)
+    : lease_mgr_(lease_mgr), connection_(NULL) {
+    Mutex::Locker locker(lease_mgr_.mutex_);
+    while (wait && lease_mgr_.free_connections_.empty()) {
+        lease_mgr_.free_cond_.wait(lease_mgr_.mutex_);
+    }
+    if (!lease_mgr_.free_connections_.empty()) {
+        connection_ = lease_mgr_.free_connections_.back();
+        lease_mgr_.free_connections_.pop_back();
+    }
+}
+
+PgSqlLeaseMgr::ConnectionHolder::~ConnectionHolder() {
+    if (connection_) {
+        // Discard the results not read by the caller, so as the connection
+        // can be used for the next query. This returns immediately if no
+        // query is in progress.
+        PGresult* r;
+        while ((r = PQgetResult(connection_->conn_)) != NULL) {
+            PQclear(r);
+        }
+
+        Mutex::Locker locker(lease_mgr_.mutex_);
+        lease_mgr_.free_connections_.push_back(connection_);
+        lease_mgr_.free_cond_.signal();
+    }
+}
+
+PgSqlLeaseMgr::PgSqlLeaseMgr(const LeaseMgr::ParameterMap& parameters)
+    : LeaseMgr(parameters) {
+    std::string connections_str = "1";
+    try {
+        connections_str = getParameter("connections");
+    } catch (...) {
+        // No number of connections. Fine, we'll use a single connection.
+    }
+
+    unsigned connections = 0;
+    try {
+        connections = boost::lexical_cast<unsigned>(connections_str);
+    } catch (const boost::bad_lexical_cast&) {
+        // Reported below.
+    }
+    if ((connections == 0) || (connections > MAX_CONNECTIONS)) {
+        isc_throw(BadValue, "invalid value of the connections "
+                  << connections_str << " specified, must be between 1 and "
+                  << MAX_CONNECTIONS);
+    }
+
+    for (unsigned i = 0; i < connections; ++i) {
+        PgSqlConnectionPtr connection(new PgSqlConnection());
+        openDatabase(*connection);
+        prepareStatements(*connection);
+        connections_.push_back(connection);
+        free_connections_.push_back(connection.get());
+    }
+}
+
+PgSqlLeaseMgr::~PgSqlLeaseMgr() {
+}
+
 void
-PgSqlLeaseMgr::prepareStatements() {
+PgSqlLeaseMgr::prepareStatements(PgSqlConnection& connection) {
     for(int i = 0; tagged_statements[i].text != NULL; ++ i) {
         // Prepare all statements queries with all known fields datatype
-        PGresult* r = PQprepare(conn_, tagged_statements[i].name,
+        PGresult* r = PQprepare(connection.conn_, tagged_statements[i].name,
                                 tagged_statements[i].text,
                                 tagged_statements[i].nbparams,
                                 tagged_statements[i].types);
@@ -979,7 +1082,7 @@ PgSqlLeaseMgr::prepareStatements() {
             isc_throw(DbOperationError,
                       "unable to prepare PostgreSQL statement: "
                       << tagged_statements[i].text << ", reason: "
-                      << PQerrorMessage(conn_));
+                      << PQerrorMessage(connection.conn_));
         }
 
         PQclear(r);
@@ -987,7 +1090,7 @@ PgSqlLeaseMgr::prepareStatements() {
 }
 
 void
-PgSqlLeaseMgr::openDatabase() {
+PgSqlLeaseMgr::openDatabase(PgSqlConnection& connection) {
     string dbconnparameters;
     string shost = "localhost";
     try {
@@ -1023,25 +1126,26 @@ PgSqlLeaseMgr::openDatabase() {
         isc_throw(NoDatabaseName, "must specify a name for the database");
     }
 
-    conn_ = PQconnectdb(dbconnparameters.c_str());
-    if (conn_ == NULL) {
+    connection.conn_ = PQconnectdb(dbconnparameters.c_str());
+    if (connection.conn_ == NULL) {
         isc_throw(DbOpenError, "could not allocate connection object");
     }
 
-    if (PQstatus(conn_) != CONNECTION_OK) {
+    if (PQstatus(connection.conn_) != CONNECTION_OK) {
         // If we have a connection object, we have to call finish
         // to release it, but grab the error message first.
-        std::string error_message = PQerrorMessage(conn_);
-        PQfinish(conn_);
-        conn_ = NULL;
+        std::string error_message = PQerrorMessage(connection.conn_);
+        PQfinish(connection.conn_);
+        connection.conn_ = NULL;
         isc_throw(DbOpenError, error_message);
     }
 }
 
 bool
-PgSqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::addLeaseCommon(PgSqlConnection& connection,
+                              StatementIndex stindex,
                               PsqlBindArray& bind_array) {
-    PGresult* r = PQexecPrepared(conn_, tagged_statements[stindex].name,
+    PGresult* r = PQexecPrepared(connection.conn_, tagged_statements[stindex].name,
                                   tagged_statements[stindex].nbparams,
                                   &bind_array.values_[0],
                                   &bind_array.lengths_[0],
@@ -1058,7 +1162,7 @@ PgSqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
             return (false);
         }
 
-        const char* errorMsg = PQerrorMessage(conn_);
+        const char* errorMsg = PQerrorMessage(connection.conn_);
         PQclear(r);
         isc_throw(DbOperationError, "unable to INSERT for " <<
                   tagged_statements[stindex].name << ", reason: " <<
@@ -1079,41 +1183,65 @@ bool PgSqlLeaseMgr::compareError(PGresult*& r, const char* error_state) {
 
 bool
 PgSqlLeaseMgr::addLease(const Lease4Ptr& lease) {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_ADD_ADDR4).arg(lease->addr_.toText());
 
     PsqlBindArray bind_array;
-    exchange4_->createBindForSend(lease, bind_array);
-    return (addLeaseCommon(INSERT_LEASE4, bind_array));
+    (*connection).exchange4_->createBindForSend(lease, bind_array);
+    return (addLeaseCommon(*connection, INSERT_LEASE4, bind_array));
 }
 
 bool
 PgSqlLeaseMgr::addLease(const Lease6Ptr& lease) {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_ADD_ADDR6).arg(lease->addr_.toText());
     PsqlBindArray bind_array;
-    exchange6_->createBindForSend(lease, bind_array);
+    (*connection).exchange6_->createBindForSend(lease, bind_array);
 
-    return (addLeaseCommon(INSERT_LEASE6, bind_array));
+    return (addLeaseCommon(*connection, INSERT_LEASE6, bind_array));
 }
 
-template <typename Exchange, typename LeaseCollection>
-void PgSqlLeaseMgr::getLeaseCollection(StatementIndex stindex,
-                                       PsqlBindArray& bind_array,
-                                       Exchange& exchange,
-                                       LeaseCollection& result,
-                                       bool single) const {
-    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
-              DHCPSRV_PGSQL_GET_ADDR4).arg(tagged_statements[stindex].name);
+void
+PgSqlLeaseMgr::sendQuery(PgSqlConnection& connection, StatementIndex stindex,
+                         PsqlBindArray& bind_array) const {
+    if (!PQsendQueryPrepared(connection.conn_, tagged_statements[stindex].name,
+                             tagged_statements[stindex].nbparams,
+                             &bind_array.values_[0],
+                             &bind_array.lengths_[0],
+                             &bind_array.formats_[0], 0)) {
+        isc_throw(DbOperationError, "unable to send query: "
+                  << tagged_statements[stindex].name << ", reason: "
+                  << PQerrorMessage(connection.conn_));
+    }
+}
 
-    PGresult* r = PQexecPrepared(conn_, tagged_statements[stindex].name,
-                       tagged_statements[stindex].nbparams,
-                       &bind_array.values_[0],
-                       &bind_array.lengths_[0],
-                       &bind_array.formats_[0], 0);
+PGresult*
+PgSqlLeaseMgr::getResult(PgSqlConnection& connection,
+                         StatementIndex stindex) const {
+    PGresult* r = PQgetResult(connection.conn_);
+    if (r == NULL) {
+        isc_throw(DbOperationError, "no result returned for: "
+                  << tagged_statements[stindex].name << ", reason: "
+                  << PQerrorMessage(connection.conn_));
+    }
+    checkStatementError(connection, r, stindex);
+
+    // Each query returns a single result, followed by NULL which must
+    // be read before the next query is sent.
+    PGresult* next;
+    while ((next = PQgetResult(connection.conn_)) != NULL) {
+        PQclear(next);
+    }
 
-    checkStatementError(r, stindex);
+    return (r);
+}
 
+template <typename Exchange, typename LeaseCollection>
+void PgSqlLeaseMgr::convertLeases(PGresult*& r, StatementIndex stindex,
+                                  Exchange& exchange, LeaseCollection& result,
+                                  bool single) const {
     int rows = PQntuples(r);
     if (single && rows > 1) {
         PQclear(r);
@@ -1122,24 +1250,45 @@ void PgSqlLeaseMgr::getLeaseCollection(StatementIndex stindex,
                       << tagged_statements[stindex].name);
     }
 
-    for(int i = 0; i < rows; ++ i) {
-        result.push_back(exchange->convertFromDatabase(r, i));
+    try {
+        for(int i = 0; i < rows; ++ i) {
+            result.push_back(exchange->convertFromDatabase(r, i));
+        }
+    } catch (...) {
+        PQclear(r);
+        throw;
     }
 
     PQclear(r);
 }
 
+template <typename Exchange, typename LeaseCollection>
+void PgSqlLeaseMgr::getLeaseCollection(PgSqlConnection& connection,
+                                       StatementIndex stindex,
+                                       PsqlBindArray& bind_array,
+                                       Exchange& exchange,
+                                       LeaseCollection& result,
+                                       bool single) const {
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_GET_ADDR4).arg(tagged_statements[stindex].name);
+
+    sendQuery(connection, stindex, bind_array);
+    PGresult* r = getResult(connection, stindex);
+    convertLeases(r, stindex, exchange, result, single);
+}
+
 
 void
-PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
-                             Lease4Ptr& result) const {
+PgSqlLeaseMgr::getLease(PgSqlConnection& connection, StatementIndex stindex,
+                        PsqlBindArray& bind_array, Lease4Ptr& result) const {
     // Create appropriate collection object and get all leases matching
     // the selection criteria.  The "single" parameter is true to indicate
     // that the called method should throw an exception if multiple
     // matching records are found: this particular method is called when only
     // one or zero matches is expected.
     Lease4Collection collection;
-    getLeaseCollection(stindex, bind_array, exchange4_, collection, true);
+    getLeaseCollection(connection, stindex, bind_array, connection.exchange4_,
+                       collection, true);
 
     // Return single record if present, else clear the lease.
     if (collection.empty()) {
@@ -1151,15 +1300,16 @@ PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
 
 
 void
-PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
-                             Lease6Ptr& result) const {
+PgSqlLeaseMgr::getLease(PgSqlConnection& connection, StatementIndex stindex,
+                        PsqlBindArray& bind_array, Lease6Ptr& result) const {
     // Create appropriate collection object and get all leases matching
     // the selection criteria.  The "single" parameter is true to indicate
     // that the called method should throw an exception if multiple
     // matching records are found: this particular method is called when only
     // one or zero matches is expected.
     Lease6Collection collection;
-    getLeaseCollection(stindex, bind_array, exchange6_, collection, true);
+    getLeaseCollection(connection, stindex, bind_array, connection.exchange6_,
+                       collection, true);
 
     // Return single record if present, else clear the lease.
     if (collection.empty()) {
@@ -1171,6 +1321,7 @@ PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
 
 Lease4Ptr
 PgSqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_ADDR4).arg(addr.toText());
 
@@ -1184,13 +1335,14 @@ PgSqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_ADDR, bind_array, result);
+    getLease(*connection, GET_LEASE4_ADDR, bind_array, result);
 
     return (result);
 }
 
 Lease4Collection
 PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_HWADDR).arg(hwaddr.toText());
 
@@ -1206,13 +1358,14 @@ PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_HWADDR, bind_array, result);
+    getLeaseCollection(*connection, GET_LEASE4_HWADDR, bind_array, result);
 
     return (result);
 }
 
 Lease4Ptr
 PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_SUBID_HWADDR)
               .arg(subnet_id).arg(hwaddr.toText());
@@ -1233,13 +1386,14 @@ PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_HWADDR_SUBID, bind_array, result);
+    getLease(*connection, GET_LEASE4_HWADDR_SUBID, bind_array, result);
 
     return (result);
 }
 
 Lease4Collection
 PgSqlLeaseMgr::getLease4(const ClientId& clientid) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_CLIENTID).arg(clientid.toText());
 
@@ -1251,13 +1405,14 @@ PgSqlLeaseMgr::getLease4(const ClientId& clientid) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_CLIENTID, bind_array, result);
+    getLeaseCollection(*connection, GET_LEASE4_CLIENTID, bind_array, result);
 
     return (result);
 }
 
 Lease4Ptr
 PgSqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_SUBID_CLIENTID)
               .arg(subnet_id).arg(clientid.toText());
@@ -1274,11 +1429,134 @@ PgSqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_CLIENTID_SUBID, bind_array, result);
+    getLease(*connection, GET_LEASE4_CLIENTID_SUBID, bind_array, result);
 
     return (result);
 }
 
+Lease4Collection
+PgSqlLeaseMgr::getLeases4(SubnetID subnet_id) const {
+    ConnectionHolder connection(*this);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_GET_SUBID4)
+              .arg(subnet_id);
+
+    // Set up the WHERE clause value
+    PsqlBindArray bind_array;
+
+    // SUBNET_ID
+    std::string subnet_id_str = boost::lexical_cast<std::string>(subnet_id);
+    bind_array.add(subnet_id_str);
+
+    // Get the data
+    Lease4Collection result;
+    getLeaseCollection(*connection, GET_LEASE4_SUBID, bind_array, result);
+
+    return (result);
+}
+
+void
+PgSqlLeaseMgr::countLeases4(LeaseCounts& counts) const {
+    ConnectionHolder connection(*this);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_COUNT_LEASES4);
+
+    PGresult* r = PQexecPrepared((*connection).conn_,
+                                 tagged_statements[COUNT_LEASE4_SUBID].name,
+                                 0, NULL, NULL, NULL, 0);
+    checkStatementError(*connection, r, COUNT_LEASE4_SUBID);
+
+    // The subnets without leases are not returned by the query.
+    for (LeaseCounts::iterator it = counts.begin(); it != counts.end(); ++it) {
+        it->second = 0;
+    }
+
+    const int rows = PQntuples(r);
+    for (int row = 0; row < rows; ++row) {
+        SubnetID subnet_id;
+        uint64_t count;
+        try {
+            subnet_id = boost::lexical_cast<SubnetID>(PQgetvalue(r, row, 0));
+            count = boost::lexical_cast<uint64_t>(PQgetvalue(r, row, 1));
+        } catch (const boost::bad_lexical_cast& ex) {
+            PQclear(r);
+            isc_throw(DbOperationError, "invalid lease count returned for: "
+                      << tagged_statements[COUNT_LEASE4_SUBID].name
+                      << ", reason: " << ex.what());
+        }
+        LeaseCounts::iterator it = counts.find(subnet_id);
+        if (it != counts.end()) {
+            it->second = count;
+        }
+    }
+
+    PQclear(r);
+}
+
+void
+PgSqlLeaseMgr::getClientLeases4(const HWAddr& hwaddr, const ClientId& clientid,
+                                SubnetID subnet_id, Lease4Ptr& hwaddr_lease,
+                                Lease4Ptr& clientid_lease) const {
+    ConnectionHolder connection(*this);
+    // Don't wait for the second connection if all are in use.
+    ConnectionHolder second_connection(*this, false);
+
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_GET_CLIENT4)
+              .arg(subnet_id).arg(hwaddr.toText()).arg(clientid.toText());
+
+    // Set up the WHERE clause values
+    PsqlBindArray hwaddr_bind_array;
+    if (!hwaddr.hwaddr_.empty()) {
+        hwaddr_bind_array.add(hwaddr.hwaddr_);
+    } else {
+        hwaddr_bind_array.add("");
+    }
+    std::string subnet_id_str = boost::lexical_cast<std::string>(subnet_id);
+    hwaddr_bind_array.add(subnet_id_str);
+
+    PsqlBindArray clientid_bind_array;
+    clientid_bind_array.add(clientid.getClientId());
+    clientid_bind_array.add(subnet_id_str);
+
+    if (!second_connection.get()) {
+        getLease(*connection, GET_LEASE4_HWADDR_SUBID, hwaddr_bind_array,
+                 hwaddr_lease);
+        getLease(*connection, GET_LEASE4_CLIENTID_SUBID, clientid_bind_array,
+                 clientid_lease);
+        return;
+    }
+
+    // Send both queries before waiting for the results.
+    sendQuery(*connection, GET_LEASE4_HWADDR_SUBID, hwaddr_bind_array);
+    sendQuery(*second_connection, GET_LEASE4_CLIENTID_SUBID,
+              clientid_bind_array);
+
+    // As in getLease, each lookup may return at most one lease, so the
+    // "single" parameter is true to throw MultipleRecords otherwise.
+    Lease4Collection hwaddr_leases;
+    PGresult* r = getResult(*connection, GET_LEASE4_HWADDR_SUBID);
+    convertLeases(r, GET_LEASE4_HWADDR_SUBID, (*connection).exchange4_,
+                  hwaddr_leases, true);
+
+    Lease4Collection clientid_leases;
+    r = getResult(*second_connection, GET_LEASE4_CLIENTID_SUBID);
+    convertLeases(r, GET_LEASE4_CLIENTID_SUBID,
+                  (*second_connection).exchange4_, clientid_leases, true);
+
+    // Return single records if present, else clear the leases.
+    if (hwaddr_leases.empty()) {
+        hwaddr_lease.reset();
+    } else {
+        hwaddr_lease = *hwaddr_leases.begin();
+    }
+    if (clientid_leases.empty()) {
+        clientid_lease.reset();
+    } else {
+        clientid_lease = *clientid_leases.begin();
+    }
+}
+
 Lease4Ptr
 PgSqlLeaseMgr::getLease4(const ClientId&, const HWAddr&, SubnetID) const {
     /// This function is currently not implemented because allocation engine
@@ -1292,6 +1570,7 @@ PgSqlLeaseMgr::getLease4(const ClientId&, const HWAddr&, SubnetID) const {
 Lease6Ptr
 PgSqlLeaseMgr::getLease6(Lease::Type lease_type,
                          const isc::asiolink::IOAddress& addr) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_GET_ADDR6)
               .arg(addr.toText()).arg(lease_type);
 
@@ -1308,7 +1587,7 @@ PgSqlLeaseMgr::getLease6(Lease::Type lease_type,
 
     // ... and get the data
     Lease6Ptr result;
-    getLease(GET_LEASE6_ADDR, bind_array, result);
+    getLease(*connection, GET_LEASE6_ADDR, bind_array, result);
 
     return (result);
 }
@@ -1316,6 +1595,7 @@ PgSqlLeaseMgr::getLease6(Lease::Type lease_type,
 Lease6Collection
 PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
                           uint32_t iaid) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_IAID_DUID)
               .arg(iaid).arg(duid.toText()).arg(lease_type);
@@ -1336,7 +1616,7 @@ PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID, bind_array, result);
+    getLeaseCollection(*connection, GET_LEASE6_DUID_IAID, bind_array, result);
 
     return (result);
 }
@@ -1344,6 +1624,7 @@ PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
 Lease6Collection
 PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
                           uint32_t iaid, SubnetID subnet_id) const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_IAID_SUBID_DUID)
               .arg(iaid).arg(subnet_id).arg(duid.toText()).arg(lease_type);
@@ -1368,26 +1649,76 @@ PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID_SUBID, bind_array, result);
+    getLeaseCollection(*connection, GET_LEASE6_DUID_IAID_SUBID, bind_array, result);
 
     return (result);
 }
 
+void
+PgSqlLeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
+                                 const size_t max_leases) const {
+    ConnectionHolder connection(*this);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_GET_EXPIRED4)
+        .arg(max_leases);
+    getExpiredLeasesCommon(*connection, expired_leases, max_leases,
+                           GET_LEASE4_EXPIRE);
+}
+
+void
+PgSqlLeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
+                                 const size_t max_leases) const {
+    ConnectionHolder connection(*this);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_PGSQL_GET_EXPIRED6)
+        .arg(max_leases);
+    getExpiredLeasesCommon(*connection, expired_leases, max_leases,
+                           GET_LEASE6_EXPIRE);
+}
+
+template<typename LeaseCollection>
+void
+PgSqlLeaseMgr::getExpiredLeasesCommon(PgSqlConnection& connection,
+                                      LeaseCollection& expired_leases,
+                                      const size_t max_leases,
+                                      StatementIndex statement_index) const {
+    PsqlBindArray bind_array;
+
+    // The leases which expiration time is earlier than the current time
+    // have expired.
+    std::string timestamp_str =
+        PgSqlLeaseExchange::convertToDatabaseTime(time(NULL), 0);
+    bind_array.add(timestamp_str);
+
+    // If the number of leases is 0, all expired leases are returned.
+    // This is achieved by setting the limit to a very high value.
+    uint32_t limit = max_leases > 0 ? static_cast<uint32_t>(max_leases) :
+        std::numeric_limits<uint32_t>::max();
+    std::string limit_str = boost::lexical_cast<std::string>(limit);
+    bind_array.add(limit_str);
+
+    // Get the data
+    getLeaseCollection(connection, statement_index, bind_array,
+                       expired_leases);
+}
+
 template <typename LeasePtr>
 void
-PgSqlLeaseMgr::updateLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::updateLeaseCommon(PgSqlConnection& connection,
+                                 StatementIndex stindex,
                                  PsqlBindArray& bind_array,
                                  const LeasePtr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_ADD_ADDR4).arg(tagged_statements[stindex].name);
 
-    PGresult* r = PQexecPrepared(conn_, tagged_statements[stindex].name,
+    PGresult* r = PQexecPrepared(connection.conn_,
+                                  tagged_statements[stindex].name,
                                   tagged_statements[stindex].nbparams,
                                   &bind_array.values_[0],
                                   &bind_array.lengths_[0],
                                   &bind_array.formats_[0], 0);
 
-    checkStatementError(r, stindex);
+    checkStatementError(connection, r, stindex);
 
     int affected_rows = boost::lexical_cast<int>(PQcmdTuples(r));
     PQclear(r);
@@ -1412,6 +1743,7 @@ PgSqlLeaseMgr::updateLeaseCommon(StatementIndex stindex,
 
 void
 PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    ConnectionHolder connection(*this);
     const StatementIndex stindex = UPDATE_LEASE4;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1419,7 +1751,7 @@ PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
-    exchange4_->createBindForSend(lease, bind_array);
+    (*connection).exchange4_->createBindForSend(lease, bind_array);
 
     // Set up the WHERE clause and append it to the SQL_BIND array
     std::string addr4_ = boost::lexical_cast<std::string>
@@ -1427,11 +1759,12 @@ PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
     bind_array.add(addr4_);
 
     // Drop to common update code
-    updateLeaseCommon(stindex, bind_array, lease);
+    updateLeaseCommon(*connection, stindex, bind_array, lease);
 }
 
 void
 PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    ConnectionHolder connection(*this);
     const StatementIndex stindex = UPDATE_LEASE6;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1439,26 +1772,28 @@ PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
-    exchange6_->createBindForSend(lease, bind_array);
+    (*connection).exchange6_->createBindForSend(lease, bind_array);
 
     // Set up the WHERE clause and append it to the BIND array
     std::string addr_str = lease->addr_.toText();
     bind_array.add(addr_str);
 
     // Drop to common update code
-    updateLeaseCommon(stindex, bind_array, lease);
+    updateLeaseCommon(*connection, stindex, bind_array, lease);
 }
 
 bool
-PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::deleteLeaseCommon(PgSqlConnection& connection,
+                                 StatementIndex stindex,
                                  PsqlBindArray& bind_array) {
-    PGresult* r = PQexecPrepared(conn_, tagged_statements[stindex].name,
+    PGresult* r = PQexecPrepared(connection.conn_,
+                                  tagged_statements[stindex].name,
                                   tagged_statements[stindex].nbparams,
                                   &bind_array.values_[0],
                                   &bind_array.lengths_[0],
                                   &bind_array.formats_[0], 0);
 
-    checkStatementError(r, stindex);
+    checkStatementError(connection, r, stindex);
     int affected_rows = boost::lexical_cast<int>(PQcmdTuples(r));
     PQclear(r);
 
@@ -1467,6 +1802,7 @@ PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
 
 bool
 PgSqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_DELETE_ADDR).arg(addr.toText());
 
@@ -1477,12 +1813,12 @@ PgSqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
         std::string addr4_str = boost::lexical_cast<std::string>
                                  (static_cast<uint32_t>(addr));
         bind_array.add(addr4_str);
-        return (deleteLeaseCommon(DELETE_LEASE4, bind_array));
+        return (deleteLeaseCommon(*connection, DELETE_LEASE4, bind_array));
     }
 
     std::string addr6_str = addr.toText();
     bind_array.add(addr6_str);
-    return (deleteLeaseCommon(DELETE_LEASE6, bind_array));
+    return (deleteLeaseCommon(*connection, DELETE_LEASE6, bind_array));
 }
 
 string
@@ -1497,10 +1833,11 @@ PgSqlLeaseMgr::getName() const {
 }
 
 void
-PgSqlLeaseMgr::checkStatementError(PGresult*& r, StatementIndex index) const {
+PgSqlLeaseMgr::checkStatementError(const PgSqlConnection& connection,
+                                   PGresult*& r, StatementIndex index) const {
     int s = PQresultStatus(r);
     if (s != PGRES_COMMAND_OK && s != PGRES_TUPLES_OK) {
-        const char* error_message = PQerrorMessage(conn_);
+        const char* error_message = PQerrorMessage(connection.conn_);
         PQclear(r);
         isc_throw(DbOperationError, "Statement exec faild:" << " for: "
                   << tagged_statements[index].name << ", reason: "
@@ -1515,11 +1852,13 @@ PgSqlLeaseMgr::getDescription() const {
 
 pair<uint32_t, uint32_t>
 PgSqlLeaseMgr::getVersion() const {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_VERSION);
 
-    PGresult* r = PQexecPrepared(conn_, "get_version", 0, NULL, NULL, NULL, 0);
-    checkStatementError(r, GET_VERSION);
+    PGresult* r = PQexecPrepared((*connection).conn_, "get_version", 0, NULL,
+                                 NULL, NULL, 0);
+    checkStatementError(*connection, r, GET_VERSION);
 
     istringstream tmp;
     uint32_t version;
@@ -1539,10 +1878,11 @@ PgSqlLeaseMgr::getVersion() const {
 
 void
 PgSqlLeaseMgr::commit() {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_COMMIT);
-    PGresult* r = PQexec(conn_, "COMMIT");
+    PGresult* r = PQexec((*connection).conn_, "COMMIT");
     if (PQresultStatus(r) != PGRES_COMMAND_OK) {
-        const char* error_message = PQerrorMessage(conn_);
+        const char* error_message = PQerrorMessage((*connection).conn_);
         PQclear(r);
         isc_throw(DbOperationError, "commit failed: " << error_message);
     }
@@ -1552,10 +1892,11 @@ PgSqlLeaseMgr::commit() {
 
 void
 PgSqlLeaseMgr::rollback() {
+    ConnectionHolder connection(*this);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_ROLLBACK);
-    PGresult* r = PQexec(conn_, "ROLLBACK");
+    PGresult* r = PQexec((*connection).conn_, "ROLLBACK");
     if (PQresultStatus(r) != PGRES_COMMAND_OK) {
-        const char* error_message = PQerrorMessage(conn_);
+        const char* error_message = PQerrorMessage((*connection).conn_);
         PQclear(r);
         isc_throw(DbOperationError, "rollback failed: " << error_message);
     }
@@ -17,8 +17,10 @@
 
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/lease_mgr.h>
+#include <util/threads/sync.h>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
 #include <libpq-fe.h>
 
@@ -112,9 +114,39 @@ struct PsqlBindArray {
 class PgSqlLease4Exchange;
 class PgSqlLease6Exchange;
 
-/// Defines PostgreSQL backend version: 1.0
+/// Defines PostgreSQL backend version: 1.1
 const uint32_t PG_CURRENT_VERSION = 1;
-const uint32_t PG_CURRENT_MINOR = 0;
+const uint32_t PG_CURRENT_MINOR = 1;
+
+/// @brief Connection to the PostgreSQL database
+///
+/// Holds the connection handle and the exchange objects used to transfer
+/// the leases over this connection. The statements are prepared for each
+/// connection separately. The connection is used by one thread at a time.
+class PgSqlConnection : public boost::noncopyable {
+public:
+
+    /// @brief Constructor
+    ///
+    /// Creates the exchange objects. The connection is opened by the
+    /// lease manager.
+    PgSqlConnection();
+
+    /// @brief Destructor
+    ///
+    /// Deallocates the prepared statements and closes the connection.
+    ~PgSqlConnection();
+
+    /// PostgreSQL connection handle
+    PGconn* conn_;
+
+    /// The exchange objects are used for transfer of data to/from the database.
+    boost::scoped_ptr<PgSqlLease4Exchange> exchange4_; ///< Exchange object
+    boost::scoped_ptr<PgSqlLease6Exchange> exchange6_; ///< Exchange object
+};
+
+/// @brief Pointer to the @c PgSqlConnection object.
+typedef boost::shared_ptr<PgSqlConnection> PgSqlConnectionPtr;
 
 /// @brief PostgreSQL Lease Manager
 ///
@@ -132,6 +164,14 @@ public:
     /// - host - Host to which to connect (optional, defaults to "localhost")
     /// - user - Username under which to connect (optional)
     /// - password - Password for "user" on the database (optional)
+    /// - connections - Number of connections opened to the database
+    ///   (optional, defaults to 1)
+    ///
+    /// The calls from multiple threads are executed concurrently, each
+    /// using a different connection. When all connections are in use, the
+    /// caller waits until one is returned to the pool. The additional
+    /// connections also allow @c getClientLeases4 to issue both lookups at
+    /// the same time.
     ///
     /// If the database is successfully opened, the version number in the
     /// schema_version table will be checked against hard-coded value in
@@ -146,6 +186,7 @@ public:
     /// @throw isc::dhcp::DbOpenError Error opening the database
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
+    /// @throw isc::BadValue Invalid number of connections.
     PgSqlLeaseMgr(const ParameterMap& parameters);
 
     /// @brief Destructor (closes database)
@@ -265,6 +306,59 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const;
 
+    /// @brief Returns all IPv4 leases for the particular subnet identifier.
+    ///
+    /// @param subnet_id identifier of the subnet that leases must belong to
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    virtual Lease4Collection getLeases4(SubnetID subnet_id) const;
+
+    /// @brief Counts the IPv4 leases in the subnets.
+    ///
+    /// The leases of all subnets are counted by a single query grouping
+    /// them by the subnet identifier.
+    ///
+    /// @param [in,out] counts Map holding the identifiers of the subnets
+    /// for which the leases are counted. The numbers of leases in these
+    /// subnets are stored in the map.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void countLeases4(LeaseCounts& counts) const;
+
+    /// @brief Returns IPv4 leases for the HW address and client identifier
+    ///
+    /// If a second connection is free, the lookups by the HW address and
+    /// by the client identifier are sent over the two connections at the
+    /// same time, so the server waits for a single round trip. Otherwise,
+    /// they are executed one after another.
+    ///
+    /// @param hwaddr hardware address of the client
+    /// @param clientid client identifier
+    /// @param subnet_id identifier of the subnet that leases must belong to
+    /// @param [out] hwaddr_lease lease found by the HW address or NULL
+    /// @param [out] clientid_lease lease found by the client identifier
+    ///        or NULL
+    ///
+    /// @throw isc::dhcp::DataTruncation Data was truncated on retrieval to
+    ///        fit into the space allocated for it.
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
+    ///        by one of the lookups.
+    virtual void getClientLeases4(const HWAddr& hwaddr,
+                                  const ClientId& clientid,
+                                  SubnetID subnet_id,
+                                  Lease4Ptr& hwaddr_lease,
+                                  Lease4Ptr& clientid_lease) const;
+
+    /// @brief Checks if @c getClientLeases4 executes the lookups concurrently
+    ///
+    /// @return true if more than one connection to the database is open.
+    virtual bool concurrentClientLookups() const {
+        return (connections_.size() > 1);
+    }
+
     /// @brief Returns existing IPv6 lease for a given IPv6 address.
     ///
     /// For a given address, we assume that there will be only one lease.
@@ -319,6 +413,36 @@ public:
     virtual Lease6Collection getLeases6(Lease::Type type, const DUID& duid,
                                         uint32_t iaid, SubnetID subnet_id) const;
 
+    /// @brief Returns a collection of expired DHCPv4 leases.
+    ///
+    /// The leases are returned in the order of their expiration times,
+    /// starting from the lease which expired first.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void getExpiredLeases4(Lease4Collection& expired_leases,
+                                   const size_t max_leases) const;
+
+    /// @brief Returns a collection of expired DHCPv6 leases.
+    ///
+    /// The leases are returned in the order of their expiration times,
+    /// starting from the lease which expired first.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void getExpiredLeases6(Lease6Collection& expired_leases,
+                                   const size_t max_leases) const;
+
     /// @brief Updates IPv4 lease.
     ///
     /// Updates the record of the lease in the database (as identified by the
@@ -414,6 +538,7 @@ public:
     /// The contents of the enum are indexes into the list of compiled SQL
     /// statements
     enum StatementIndex {
+        COUNT_LEASE4_SUBID,         // Count lease4 by subnet ID
         DELETE_LEASE4,              // Delete from lease4 by address
         DELETE_LEASE6,              // Delete from lease6 by address
         GET_LEASE4_ADDR,            // Get lease4 by address
@@ -421,9 +546,12 @@ public:
         GET_LEASE4_CLIENTID_SUBID,  // Get lease4 by client ID & subnet ID
         GET_LEASE4_HWADDR,          // Get lease4 by HW address
         GET_LEASE4_HWADDR_SUBID,    // Get lease4 by HW address & subnet ID
+        GET_LEASE4_EXPIRE,          // Get expired lease4
+        GET_LEASE4_SUBID,           // Get lease4 by subnet ID
         GET_LEASE6_ADDR,            // Get lease6 by address
         GET_LEASE6_DUID_IAID,       // Get lease6 by DUID and IAID
         GET_LEASE6_DUID_IAID_SUBID, // Get lease6 by DUID, IAID and subnet ID
+        GET_LEASE6_EXPIRE,          // Get expired lease6
         GET_VERSION,                // Obtain version number
         INSERT_LEASE4,              // Add entry to lease4 table
         INSERT_LEASE6,              // Add entry to lease6 table
@@ -434,25 +562,107 @@ public:
 
 private:
 
+    /// @brief Holds a connection taken from the pool
+    ///
+    /// Returns the connection to the pool when destroyed. The results of
+    /// the queries sent over the connection which haven't been read, e.g.
+    /// because of an error, are discarded first.
+    class ConnectionHolder : public boost::noncopyable {
+    public:
+
+        /// @brief Constructor
+        ///
+        /// @param lease_mgr Lease manager holding the pool.
+        /// @param wait If true, waits until a connection is free. Otherwise,
+        ///        no connection is held if all connections are in use.
+        ConnectionHolder(const PgSqlLeaseMgr& lease_mgr, const bool wait = true);
+
+        /// @brief Destructor
+        ///
+        /// Returns the connection to the pool.
+        ~ConnectionHolder();
+
+        /// @brief Returns the held connection or NULL.
+        PgSqlConnection* get() const {
+            return (connection_);
+        }
+
+        /// @brief Returns the held connection.
+        PgSqlConnection& operator*() const {
+            return (*connection_);
+        }
+
+    private:
+
+        /// Lease manager holding the pool
+        const PgSqlLeaseMgr& lease_mgr_;
+
+        /// Held connection
+        PgSqlConnection* connection_;
+    };
+
+    friend class ConnectionHolder;
+
     /// @brief Prepare statements
     ///
     /// Creates the prepared statements for all of the SQL statements used
     /// by the PostgreSQL backend.
     ///
+    /// @param connection Connection for which the statements are prepared.
+    ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
     /// @throw isc::InvalidParameter 'index' is not valid for the vector.  This
     ///        represents an internal error within the code.
-    void prepareStatements();
+    void prepareStatements(PgSqlConnection& connection);
 
     /// @brief Open Database
     ///
     /// Opens the database using the information supplied in the parameters
     /// passed to the constructor.
     ///
+    /// @param connection Connection to be opened.
+    ///
     /// @throw NoDatabaseName Mandatory database name not given
     /// @throw DbOpenError Error opening the database
-    void openDatabase();
+    void openDatabase(PgSqlConnection& connection);
+
+    /// @brief Sends the query without waiting for the result
+    ///
+    /// @param connection Connection over which the query is sent.
+    /// @param stindex Index of statement being executed
+    /// @param bind_array array containing the where clause input parameters
+    ///
+    /// @throw isc::dhcp::DbOperationError The query couldn't be sent.
+    void sendQuery(PgSqlConnection& connection, StatementIndex stindex,
+                   PsqlBindArray& bind_array) const;
+
+    /// @brief Waits for the result of the query sent with @c sendQuery
+    ///
+    /// @param connection Connection over which the query has been sent.
+    /// @param stindex Index of statement being executed
+    ///
+    /// @return Result of the query which must be cleared by the caller.
+    /// @throw isc::dhcp::DbOperationError The query has failed.
+    PGresult* getResult(PgSqlConnection& connection,
+                        StatementIndex stindex) const;
+
+    /// @brief Converts the rows of the result to leases
+    ///
+    /// Clears the result.
+    ///
+    /// @param r Result of the query.
+    /// @param stindex Index of statement which has been executed
+    /// @param exchange Exchange object to use
+    /// @param result Collection to which the leases are appended.
+    /// @param single If true, only a single data item is expected.
+    ///
+    /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
+    ///        from the database where only one was expected.
+    template <typename Exchange, typename LeaseCollection>
+    void convertLeases(PGresult*& r, StatementIndex stindex,
+                       Exchange& exchange, LeaseCollection& result,
+                       bool single) const;
 
     /// @brief Add Lease Common Code
     ///
@@ -460,6 +670,7 @@ private:
     /// of the addLease method.  It binds the contents of the lease object to
     /// the prepared statement and adds it to the database.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of statement being executed
     /// @param bind_array array that has been created for the type
     ///        of lease in question.
@@ -469,13 +680,15 @@ private:
     ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
-    bool addLeaseCommon(StatementIndex stindex, PsqlBindArray& bind_array);
+    bool addLeaseCommon(PgSqlConnection& connection, StatementIndex stindex,
+                        PsqlBindArray& bind_array);
 
     /// @brief Get Lease Collection Common Code
     ///
     /// This method performs the common actions for obtaining multiple leases
     /// from the database.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing the where clause input parameters
     /// @param exchange Exchange object to use
@@ -492,7 +705,8 @@ private:
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
     template <typename Exchange, typename LeaseCollection>
-    void getLeaseCollection(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLeaseCollection(PgSqlConnection& connection,
+                            StatementIndex stindex, PsqlBindArray& bind_array,
                             Exchange& exchange, LeaseCollection& result,
                             bool single = false) const;
 
@@ -501,6 +715,7 @@ private:
     /// Gets a collection of Lease4 objects.  This is just an interface to
     /// the get lease collection common code.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing the where clause input parameters
     /// @param lease LeaseCollection object returned.  Note that any leases in
@@ -512,9 +727,11 @@ private:
     ///        failed.
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
-    void getLeaseCollection(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLeaseCollection(PgSqlConnection& connection,
+                            StatementIndex stindex, PsqlBindArray& bind_array,
                             Lease4Collection& result) const {
-        getLeaseCollection(stindex, bind_array, exchange4_, result);
+        getLeaseCollection(connection, stindex, bind_array,
+                           connection.exchange4_, result);
     }
 
     /// @brief Get Lease6 Collection
@@ -522,6 +739,7 @@ private:
     /// Gets a collection of Lease6 objects.  This is just an interface to
     /// the get lease collection common code.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing input parameters for the query
     /// @param lease LeaseCollection object returned.  Note that any existing
@@ -532,9 +750,11 @@ private:
     ///        failed.
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
-    void getLeaseCollection(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLeaseCollection(PgSqlConnection& connection,
+                            StatementIndex stindex, PsqlBindArray& bind_array,
                             Lease6Collection& result) const {
-        getLeaseCollection(stindex, bind_array, exchange6_, result);
+        getLeaseCollection(connection, stindex, bind_array,
+                           connection.exchange6_, result);
     }
 
     /// @brief Checks result of the r object
@@ -542,11 +762,13 @@ private:
     /// Checks status of the operation passed as first argument and throws
     /// DbOperationError with details if it is non-success.
     ///
+    /// @param connection Connection over which the operation was executed
     /// @param r result of the last PostgreSQL operation
     /// @param index will be used to print out compiled statement name
     ///
     /// @throw isc::dhcp::DbOperationError Detailed PostgreSQL failure
-    void checkStatementError(PGresult*& r, StatementIndex index) const;
+    void checkStatementError(const PgSqlConnection& connection, PGresult*& r,
+                             StatementIndex index) const;
 
     /// @brief Get Lease4 Common Code
     ///
@@ -554,11 +776,12 @@ private:
     /// methods.  It acts as an interface to the getLeaseCollection() method,
     /// but retrieveing only a single lease.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing input parameters for the query
     /// @param lease Lease4 object returned
-    void getLease(StatementIndex stindex, PsqlBindArray& bind_array,
-                  Lease4Ptr& result) const;
+    void getLease(PgSqlConnection& connection, StatementIndex stindex,
+                  PsqlBindArray& bind_array, Lease4Ptr& result) const;
 
     /// @brief Get Lease6 Common Code
     ///
@@ -566,11 +789,34 @@ private:
     /// methods.  It acts as an interface to the getLeaseCollection() method,
     /// but retrieveing only a single lease.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing input parameters for the query
     /// @param lease Lease6 object returned
-    void getLease(StatementIndex stindex, PsqlBindArray& bind_array,
-                  Lease6Ptr& result) const;
+    void getLease(PgSqlConnection& connection, StatementIndex stindex,
+                  PsqlBindArray& bind_array, Lease6Ptr& result) const;
+
+    /// @brief Get expired leases common code.
+    ///
+    /// This method retrieves expired DHCPv4 or DHCPv6 leases. It binds
+    /// the current time and the maximum number of leases to the prepared
+    /// statement and executes it.
+    ///
+    /// @param connection Connection to be used.
+    /// @param [out] expired_leases A container to which expired leases
+    /// are appended.
+    /// @param max_leases Maximum number of leases to be returned. The value
+    /// of 0 means that all expired leases are returned.
+    /// @param statement_index One of the @c GET_LEASE4_EXPIRE or
+    /// @c GET_LEASE6_EXPIRE.
+    ///
+    /// @tparam LeaseCollection Type of the container: @c Lease4Collection
+    /// or @c Lease6Collection.
+    template<typename LeaseCollection>
+    void getExpiredLeasesCommon(PgSqlConnection& connection,
+                                LeaseCollection& expired_leases,
+                                const size_t max_leases,
+                                StatementIndex statement_index) const;
 
 
     /// @brief Update lease common code
@@ -579,6 +825,7 @@ private:
     /// to the prepared statement, executes it, then checks how many rows
     /// were affected.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of prepared statement to be executed
     /// @param bind_array array containing lease values and where clause
     /// parameters for the update.
@@ -589,7 +836,8 @@ private:
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
     template <typename LeasePtr>
-    void updateLeaseCommon(StatementIndex stindex, PsqlBindArray& bind_array,
+    void updateLeaseCommon(PgSqlConnection& connection,
+                           StatementIndex stindex, PsqlBindArray& bind_array,
                            const LeasePtr& lease);
 
     /// @brief Delete lease common code
@@ -598,6 +846,7 @@ private:
     /// to the prepared statement, executes the statement and checks to
     /// see how many rows were deleted.
     ///
+    /// @param connection Connection to be used.
     /// @param stindex Index of prepared statement to be executed
     /// @param bind_array array containing lease values and where clause
     /// parameters for the delete
@@ -607,17 +856,21 @@ private:
     ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
-    bool deleteLeaseCommon(StatementIndex stindex, PsqlBindArray& bind_array);
+    bool deleteLeaseCommon(PgSqlConnection& connection, StatementIndex stindex,
+                           PsqlBindArray& bind_array);
 
-    /// The exchange objects are used for transfer of data to/from the database.
-    /// They are pointed-to objects as the contents may change in "const" calls,
-    /// while the rest of this object does not.  (At alternative would be to
-    /// declare them as "mutable".)
-    boost::scoped_ptr<PgSqlLease4Exchange> exchange4_; ///< Exchange object
-    boost::scoped_ptr<PgSqlLease6Exchange> exchange6_; ///< Exchange object
+    /// All connections opened to the database
+    std::vector<PgSqlConnectionPtr> connections_;
 
-    /// PostgreSQL connection handle
-    PGconn* conn_;
+    /// Connections not used by any thread. The connections are taken from
+    /// and returned to the pool in "const" calls, so it is mutable.
+    mutable std::vector<PgSqlConnection*> free_connections_;
+
+    /// Mutex protecting the pool of free connections
+    mutable isc::util::thread::Mutex mutex_;
+
+    /// Signals that a connection has been returned to the pool
+    mutable isc::util::thread::CondVar free_cond_;
 };
 
 }; // end of isc::dhcp namespace
@@ -25,18 +25,42 @@ using namespace isc::log;
 namespace isc {
 namespace dhcp {
 
+const uint32_t SrvConfig::DEFAULT_PACKET_QUEUE_SIZE;
+const uint32_t SrvConfig::DEFAULT_MAX_RECLAIM_LEASES;
+const uint32_t SrvConfig::DEFAULT_STATISTICS_MAX_SAMPLES;
+
 SrvConfig::SrvConfig()
-    : sequence_(0), cfg_iface_(new CfgIface()),
+    : sequence_(0), async_logging_(false),
+      async_logging_queue_size_(AsyncLogWriter::DEFAULT_QUEUE_SIZE),
+      async_logging_policy_(AsyncLogWriter::BLOCK),
+      cfg_iface_(new CfgIface()),
       cfg_option_def_(new CfgOptionDef()), cfg_option_(new CfgOption()),
       cfg_subnets4_(new CfgSubnets4()), cfg_subnets6_(new CfgSubnets6()),
-      cfg_hosts_(new CfgHosts()), cfg_rsoo_(new CfgRSOO()) {
+      cfg_hosts_(new CfgHosts()), cfg_rsoo_(new CfgRSOO()),
+      thread_pool_size_(0), packet_queue_size_(DEFAULT_PACKET_QUEUE_SIZE),
+      reclaim_timer_wait_time_(0),
+      max_reclaim_leases_(DEFAULT_MAX_RECLAIM_LEASES),
+      statistics_sample_interval_(0),
+      statistics_max_samples_(DEFAULT_STATISTICS_MAX_SAMPLES),
+      latency_histograms_(false), lazy_option_parsing_(false),
+      allocator_("iterative") {
 }
 
 SrvConfig::SrvConfig(const uint32_t sequence)
-    : sequence_(sequence), cfg_iface_(new CfgIface()),
+    : sequence_(sequence), async_logging_(false),
+      async_logging_queue_size_(AsyncLogWriter::DEFAULT_QUEUE_SIZE),
+      async_logging_policy_(AsyncLogWriter::BLOCK),
+      cfg_iface_(new CfgIface()),
       cfg_option_def_(new CfgOptionDef()), cfg_option_(new CfgOption()),
       cfg_subnets4_(new CfgSubnets4()), cfg_subnets6_(new CfgSubnets6()),
-      cfg_hosts_(new CfgHosts()), cfg_rsoo_(new CfgRSOO()) {
+      cfg_hosts_(new CfgHosts()), cfg_rsoo_(new CfgRSOO()),
+      thread_pool_size_(0), packet_queue_size_(DEFAULT_PACKET_QUEUE_SIZE),
+      reclaim_timer_wait_time_(0),
+      max_reclaim_leases_(DEFAULT_MAX_RECLAIM_LEASES),
+      statistics_sample_interval_(0),
+      statistics_max_samples_(DEFAULT_STATISTICS_MAX_SAMPLES),
+      latency_histograms_(false), lazy_option_parsing_(false),
+      allocator_("iterative") {
 }
 
 std::string
@@ -93,11 +117,35 @@ SrvConfig::copy(SrvConfig& new_config) const {
          it != logging_info_.end(); ++it) {
         new_config.addLoggingInfo(*it);
     }
+    new_config.setAsyncLogging(async_logging_, async_logging_queue_size_,
+                               async_logging_policy_);
     // Replace interface configuration.
     new_config.cfg_iface_.reset(new CfgIface(*cfg_iface_));
     // Replace option definitions.
     cfg_option_def_->copyTo(*new_config.cfg_option_def_);
     cfg_option_->copyTo(*new_config.cfg_option_);
+    // Copy multi-threading parameters.
+    new_config.thread_pool_size_ = thread_pool_size_;
+    new_config.packet_queue_size_ = packet_queue_size_;
+    // Copy leases reclamation parameters.
+    new_config.reclaim_timer_wait_time_ = reclaim_timer_wait_time_;
+    new_config.max_reclaim_leases_ = max_reclaim_leases_;
+    // Copy statistics sampling parameters.
+    new_config.statistics_sample_interval_ = statistics_sample_interval_;
+    new_config.statistics_max_samples_ = statistics_max_samples_;
+    new_config.latency_histograms_ = latency_histograms_;
+    new_config.lazy_option_parsing_ = lazy_option_parsing_;
+    new_config.allocator_ = allocator_;
+}
+
+void
+SrvConfig::setAllocator(const std::string& allocator) {
+    if ((allocator != "iterative") && (allocator != "bitmap")) {
+        isc_throw(BadValue, "unsupported allocator '" << allocator
+                  << "', the supported allocators are 'iterative' and"
+                  " 'bitmap'");
+    }
+    allocator_ = allocator;
 }
 
 void
@@ -108,8 +156,19 @@ SrvConfig::applyLoggingCfg() const {
          it != logging_info_.end(); ++it) {
         specs.push_back(it->toSpec());
     }
+
+    // The queued messages are written to the old destinations before
+    // the loggers are reconfigured.
+    AsyncLogWriter::instance().stop();
+
     LoggerManager manager;
     manager.process(specs.begin(), specs.end());
+
+    // Resume writing the log messages in the background.
+    if (async_logging_) {
+        AsyncLogWriter::instance().start(async_logging_queue_size_,
+                                         async_logging_policy_);
+    }
 }
 
 bool
@@ -140,8 +199,21 @@ SrvConfig::equals(const SrvConfig& other) const {
     }
     // Logging information is equal between objects, so check other values.
     return ((*cfg_iface_ == *other.cfg_iface_) &&
+            (async_logging_ == other.async_logging_) &&
+            (async_logging_queue_size_ == other.async_logging_queue_size_) &&
+            (async_logging_policy_ == other.async_logging_policy_) &&
             (*cfg_option_def_ == *other.cfg_option_def_) &&
-            (*cfg_option_ == *other.cfg_option_));
+            (*cfg_option_ == *other.cfg_option_) &&
+            (thread_pool_size_ == other.thread_pool_size_) &&
+            (packet_queue_size_ == other.packet_queue_size_) &&
+            (reclaim_timer_wait_time_ == other.reclaim_timer_wait_time_) &&
+            (max_reclaim_leases_ == other.max_reclaim_leases_) &&
+            (statistics_sample_interval_ ==
+             other.statistics_sample_interval_) &&
+            (statistics_max_samples_ == other.statistics_max_samples_) &&
+            (latency_histograms_ == other.latency_histograms_) &&
+            (lazy_option_parsing_ == other.lazy_option_parsing_) &&
+            (allocator_ == other.allocator_));
 }
 
 }
@@ -24,6 +24,7 @@
 #include <dhcpsrv/cfg_subnets6.h>
 #include <dhcpsrv/cfg_mac_source.h>
 #include <dhcpsrv/logging_info.h>
+#include <log/async_log_writer.h>
 #include <boost/shared_ptr.hpp>
 #include <vector>
 #include <stdint.h>
@@ -64,6 +65,17 @@ public:
     static const uint32_t CFGSEL_ALL     = 0xFFFFFFFF;
     //@}
 
+    /// @brief Default maximum number of packets awaiting processing by
+    /// the worker threads.
+    static const uint32_t DEFAULT_PACKET_QUEUE_SIZE = 64;
+
+    /// @brief Default maximum number of expired leases reclaimed in a
+    /// single run of the lease reclamation routine.
+    static const uint32_t DEFAULT_MAX_RECLAIM_LEASES = 100;
+
+    /// @brief Default number of samples retained for each statistic.
+    static const uint32_t DEFAULT_STATISTICS_MAX_SAMPLES = 20;
+
     /// @brief Default constructor.
     ///
     /// This constructor sets configuration sequence number to 0.
@@ -130,6 +142,37 @@ public:
         logging_info_.push_back(logging_info);
     }
 
+    /// @brief Enables or disables the asynchronous logging.
+    ///
+    /// @param enabled true if the log messages should be written by
+    /// a background thread.
+    /// @param queue_size Maximum number of the messages awaiting output.
+    /// @param policy Policy applied when the queue is full.
+    void setAsyncLogging(const bool enabled,
+                         const uint32_t queue_size =
+                         isc::log::AsyncLogWriter::DEFAULT_QUEUE_SIZE,
+                         const isc::log::AsyncLogWriter::OverflowPolicy policy =
+                         isc::log::AsyncLogWriter::BLOCK) {
+        async_logging_ = enabled;
+        async_logging_queue_size_ = queue_size;
+        async_logging_policy_ = policy;
+    }
+
+    /// @brief Checks if the asynchronous logging is enabled.
+    bool getAsyncLogging() const {
+        return (async_logging_);
+    }
+
+    /// @brief Returns the size of the asynchronous logging queue.
+    uint32_t getAsyncLoggingQueueSize() const {
+        return (async_logging_queue_size_);
+    }
+
+    /// @brief Returns the overflow policy of the asynchronous logging.
+    isc::log::AsyncLogWriter::OverflowPolicy getAsyncLoggingPolicy() const {
+        return (async_logging_policy_);
+    }
+
     /// @brief Returns non-const pointer to interface configuration.
     ///
     /// This function returns a non-const pointer to the interface
@@ -276,6 +319,127 @@ public:
         return (cfg_mac_source_);
     }
 
+    /// @brief Sets the number of threads processing received packets.
+    ///
+    /// @param size Number of worker threads. The value of 0 indicates that
+    /// the packets are processed by the thread which receives them.
+    void setThreadPoolSize(const uint32_t size) {
+        thread_pool_size_ = size;
+    }
+
+    /// @brief Returns the number of threads processing received packets.
+    uint32_t getThreadPoolSize() const {
+        return (thread_pool_size_);
+    }
+
+    /// @brief Sets the maximum number of received packets awaiting
+    /// processing by the worker threads.
+    ///
+    /// @param size Maximum number of queued packets.
+    void setPacketQueueSize(const uint32_t size) {
+        packet_queue_size_ = size;
+    }
+
+    /// @brief Returns the maximum number of received packets awaiting
+    /// processing by the worker threads.
+    uint32_t getPacketQueueSize() const {
+        return (packet_queue_size_);
+    }
+
+    /// @brief Sets the interval between two runs of the expired leases
+    /// reclamation routine.
+    ///
+    /// @param wait_time Interval in seconds. The value of 0 disables the
+    /// periodic reclamation of expired leases.
+    void setReclaimTimerWaitTime(const uint32_t wait_time) {
+        reclaim_timer_wait_time_ = wait_time;
+    }
+
+    /// @brief Returns the interval between two runs of the expired leases
+    /// reclamation routine.
+    uint32_t getReclaimTimerWaitTime() const {
+        return (reclaim_timer_wait_time_);
+    }
+
+    /// @brief Sets the maximum number of expired leases reclaimed in a
+    /// single run of the reclamation routine.
+    ///
+    /// @param max_leases Maximum number of leases. The value of 0 means
+    /// that all expired leases are reclaimed.
+    void setMaxReclaimLeases(const uint32_t max_leases) {
+        max_reclaim_leases_ = max_leases;
+    }
+
+    /// @brief Returns the maximum number of expired leases reclaimed in
+    /// a single run of the reclamation routine.
+    uint32_t getMaxReclaimLeases() const {
+        return (max_reclaim_leases_);
+    }
+
+    /// @brief Sets the interval between two samples of the statistics.
+    ///
+    /// @param interval Interval in seconds. The value of 0 disables the
+    /// recording of the history of the statistics.
+    void setStatisticsSampleInterval(const uint32_t interval) {
+        statistics_sample_interval_ = interval;
+    }
+
+    /// @brief Returns the interval between two samples of the statistics.
+    uint32_t getStatisticsSampleInterval() const {
+        return (statistics_sample_interval_);
+    }
+
+    /// @brief Sets the number of samples retained for each statistic.
+    ///
+    /// @param max_samples Maximum number of samples.
+    void setStatisticsMaxSamples(const uint32_t max_samples) {
+        statistics_max_samples_ = max_samples;
+    }
+
+    /// @brief Returns the number of samples retained for each statistic.
+    uint32_t getStatisticsMaxSamples() const {
+        return (statistics_max_samples_);
+    }
+
+    /// @brief Enables or disables the packet latency histograms.
+    ///
+    /// @param enabled true if the time spent in each processing stage
+    /// should be recorded for the received packets.
+    void setLatencyHistograms(const bool enabled) {
+        latency_histograms_ = enabled;
+    }
+
+    /// @brief Checks if the packet latency histograms are enabled.
+    bool getLatencyHistograms() const {
+        return (latency_histograms_);
+    }
+
+    /// @brief Enables or disables the lazy parsing of the received options.
+    ///
+    /// @param enabled true if the options of the received packets should
+    /// be created when they are first retrieved.
+    void setLazyOptionParsing(const bool enabled) {
+        lazy_option_parsing_ = enabled;
+    }
+
+    /// @brief Checks if the lazy parsing of the received options is enabled.
+    bool getLazyOptionParsing() const {
+        return (lazy_option_parsing_);
+    }
+
+    /// @brief Selects the allocator picking the IPv4 addresses for new
+    /// leases.
+    ///
+    /// @param allocator "iterative" to try the addresses one after another
+    /// or "bitmap" to track the free addresses in bitmaps.
+    /// @throw isc::BadValue if the allocator is not supported.
+    void setAllocator(const std::string& allocator);
+
+    /// @brief Returns the allocator picking the IPv4 addresses.
+    const std::string& getAllocator() const {
+        return (allocator_);
+    }
+
     /// @brief Copies the currnet configuration to a new configuration.
     ///
     /// This method copies the parameters stored in the configuration to
@@ -358,6 +522,15 @@ private:
     /// @brief Logging specific information.
     LoggingInfoStorage logging_info_;
 
+    /// @brief Indicates if the asynchronous logging is enabled.
+    bool async_logging_;
+
+    /// @brief Size of the asynchronous logging queue.
+    uint32_t async_logging_queue_size_;
+
+    /// @brief Overflow policy of the asynchronous logging.
+    isc::log::AsyncLogWriter::OverflowPolicy async_logging_policy_;
+
     /// @brief Interface configuration.
     ///
     /// Used to select interfaces on which the DHCP server will listen to
@@ -396,6 +569,33 @@ private:
     /// This object holds a set of RSOO-enabled options. See
     /// RFC 6422 for the definition of the RSOO-enabled option.
     CfgRSOOPtr cfg_rsoo_;
+
+    /// @brief Number of threads processing received packets.
+    uint32_t thread_pool_size_;
+
+    /// @brief Maximum number of packets awaiting processing.
+    uint32_t packet_queue_size_;
+
+    /// @brief Interval between the runs of the leases reclamation routine.
+    uint32_t reclaim_timer_wait_time_;
+
+    /// @brief Maximum number of leases reclaimed in a single run.
+    uint32_t max_reclaim_leases_;
+
+    /// @brief Interval between the samples of the statistics.
+    uint32_t statistics_sample_interval_;
+
+    /// @brief Maximum number of samples retained for each statistic.
+    uint32_t statistics_max_samples_;
+
+    /// @brief Indicates if the packet latency histograms are enabled.
+    bool latency_histograms_;
+
+    /// @brief Indicates if the received options are parsed lazily.
+    bool lazy_option_parsing_;
+
+    /// @brief Allocator picking the IPv4 addresses for new leases.
+    std::string allocator_;
 };
 
 /// @name Pointers to the @c SrvConfig object.
@@ -0,0 +1,191 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <dhcpsrv/stats_mgr.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <sstream>
+
+using namespace isc::data;
+using namespace isc::util::thread;
+using namespace boost::posix_time;
+
+namespace isc {
+namespace dhcp {
+
+StatsCounter::StatsCounter(const std::string& name, const Type type)
+    : name_(name), type_(type), value_(0) {
+}
+
+void
+StatsCounter::set(const int64_t value) {
+    int64_t old_value = getValue();
+    while (!__sync_bool_compare_and_swap(&value_, old_value, value)) {
+        old_value = getValue();
+    }
+}
+
+void
+StatsCounter::reset() {
+    if (type_ == COUNTER) {
+        set(0);
+    }
+    Mutex::Locker lock(mutex_);
+    samples_.clear();
+}
+
+void
+StatsCounter::sample(const ptime& now, const size_t max_samples) {
+    const int64_t value = getValue();
+    Mutex::Locker lock(mutex_);
+    samples_.push_front(Sample(value, now));
+    while (samples_.size() > max_samples) {
+        samples_.pop_back();
+    }
+}
+
+StatsCounter::SampleList
+StatsCounter::getSamples() const {
+    Mutex::Locker lock(mutex_);
+    return (samples_);
+}
+
+ElementPtr
+StatsCounter::toElement(const ptime& now) const {
+    ElementPtr list = Element::createList();
+    SampleList samples = getSamples();
+    samples.push_front(Sample(getValue(), now));
+    for (SampleList::const_iterator sample = samples.begin();
+         sample != samples.end(); ++sample) {
+        ElementPtr entry = Element::createList();
+        entry->add(Element::create(static_cast<long long int>(sample->first)));
+        entry->add(Element::create(to_iso_extended_string(sample->second)));
+        list->add(entry);
+    }
+    return (list);
+}
+
+StatsMgr::StatsMgr() {
+}
+
+StatsMgr&
+StatsMgr::instance() {
+    static StatsMgr stats_mgr;
+    return (stats_mgr);
+}
+
+StatsCounterPtr
+StatsMgr::getCounter(const std::string& name, const StatsCounter::Type type) {
+    Mutex::Locker lock(mutex_);
+    StatsCounterPtr& counter = counters_[name];
+    if (!counter) {
+        counter.reset(new StatsCounter(name, type));
+    }
+    return (counter);
+}
+
+void
+StatsMgr::addValue(const std::string& name, const int64_t value,
+                   const StatsCounter::Type type) {
+    getCounter(name, type)->add(value);
+}
+
+void
+StatsMgr::setValue(const std::string& name, const int64_t value) {
+    getCounter(name, StatsCounter::GAUGE)->set(value);
+}
+
+bool
+StatsMgr::reset(const std::string& name) {
+    Mutex::Locker lock(mutex_);
+    CounterMap::const_iterator counter = counters_.find(name);
+    if (counter == counters_.end()) {
+        return (false);
+    }
+    counter->second->reset();
+    return (true);
+}
+
+void
+StatsMgr::resetAll() {
+    Mutex::Locker lock(mutex_);
+    for (CounterMap::const_iterator counter = counters_.begin();
+         counter != counters_.end(); ++counter) {
+        counter->second->reset();
+    }
+}
+
+bool
+StatsMgr::remove(const std::string& name) {
+    Mutex::Locker lock(mutex_);
+    return (counters_.erase(name) > 0);
+}
+
+void
+StatsMgr::removeAll() {
+    Mutex::Locker lock(mutex_);
+    counters_.clear();
+}
+
+size_t
+StatsMgr::count() const {
+    Mutex::Locker lock(mutex_);
+    return (counters_.size());
+}
+
+void
+StatsMgr::sample(const size_t max_samples) {
+    const ptime now = microsec_clock::universal_time();
+    Mutex::Locker lock(mutex_);
+    for (CounterMap::const_iterator counter = counters_.begin();
+         counter != counters_.end(); ++counter) {
+        counter->second->sample(now, max_samples);
+    }
+}
+
+ConstElementPtr
+StatsMgr::get(const std::string& name) const {
+    ElementPtr map = Element::createMap();
+    Mutex::Locker lock(mutex_);
+    CounterMap::const_iterator counter = counters_.find(name);
+    if (counter != counters_.end()) {
+        map->set(name, counter->second->
+                 toElement(microsec_clock::universal_time()));
+    }
+    return (map);
+}
+
+ConstElementPtr
+StatsMgr::getAll() const {
+    const ptime now = microsec_clock::universal_time();
+    ElementPtr map = Element::createMap();
+    Mutex::Locker lock(mutex_);
+    for (CounterMap::const_iterator counter = counters_.begin();
+         counter != counters_.end(); ++counter) {
+        map->set(counter->first, counter->second->toElement(now));
+    }
+    return (map);
+}
+
+std::string
+StatsMgr::generateName(const std::string& context, const uint32_t id,
+                       const std::string& name) {
+    std::ostringstream s;
+    s << context << "[" << id << "]." << name;
+    return (s.str());
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,257 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#ifndef STATS_MGR_H
+#define STATS_MGR_H
+
+#include <cc/data.h>
+#include <util/threads/sync.h>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <list>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Statistic maintained by the server.
+///
+/// The value of the statistic is modified with atomic operations, so
+/// the threads processing packets may update it concurrently without
+/// taking a lock. The server holds pointers to the frequently updated
+/// statistics, so as they are not looked up by name for each packet.
+///
+/// The statistic may also hold a history of its values, recorded by
+/// @c StatsCounter::sample at regular intervals. Access to the history
+/// is serialized with a mutex, but it doesn't affect the updates of
+/// the value.
+class StatsCounter : public boost::noncopyable {
+public:
+
+    /// @brief Type of the statistic.
+    enum Type {
+        /// Number of events which occurred since the statistic was reset,
+        /// e.g. the number of received packets.
+        COUNTER,
+        /// Current quantity of something, e.g. the number of assigned
+        /// addresses. Resetting the gauge doesn't change its value.
+        GAUGE
+    };
+
+    /// @brief Value of the statistic recorded at the given time.
+    typedef std::pair<int64_t, boost::posix_time::ptime> Sample;
+
+    /// @brief History of the statistic, the most recent sample first.
+    typedef std::list<Sample> SampleList;
+
+    /// @brief Constructor.
+    ///
+    /// @param name Name of the statistic.
+    /// @param type Type of the statistic.
+    StatsCounter(const std::string& name, const Type type);
+
+    /// @brief Returns the name of the statistic.
+    const std::string& getName() const {
+        return (name_);
+    }
+
+    /// @brief Returns the type of the statistic.
+    Type getType() const {
+        return (type_);
+    }
+
+    /// @brief Atomically adds to the value of the statistic.
+    ///
+    /// @param value Value to be added, which may be negative.
+    void add(const int64_t value) {
+        __sync_fetch_and_add(&value_, value);
+    }
+
+    /// @brief Atomically sets the value of the statistic.
+    ///
+    /// @param value New value.
+    void set(const int64_t value);
+
+    /// @brief Returns the current value of the statistic.
+    int64_t getValue() const {
+        return (__sync_fetch_and_add(const_cast<int64_t*>(&value_), 0));
+    }
+
+    /// @brief Resets the statistic.
+    ///
+    /// Sets the value of the counter to 0 and clears the history. The
+    /// value of the gauge is preserved.
+    void reset();
+
+    /// @brief Records the current value of the statistic in the history.
+    ///
+    /// @param now Time of the sample.
+    /// @param max_samples Maximum number of samples held in the history.
+    /// The oldest samples are discarded when it is exceeded.
+    void sample(const boost::posix_time::ptime& now, const size_t max_samples);
+
+    /// @brief Returns a copy of the history of the statistic.
+    SampleList getSamples() const;
+
+    /// @brief Returns the statistic as a list of values.
+    ///
+    /// The first element of the list holds the current value and time,
+    /// followed by the samples from the history, the most recent first.
+    /// Each element is a list holding the value and the time in the ISO
+    /// extended format.
+    ///
+    /// @param now Current time.
+    isc::data::ElementPtr toElement(const boost::posix_time::ptime& now) const;
+
+private:
+
+    /// @brief Name of the statistic.
+    std::string name_;
+
+    /// @brief Type of the statistic.
+    Type type_;
+
+    /// @brief Value of the statistic, modified atomically.
+    int64_t value_;
+
+    /// @brief History of the statistic.
+    SampleList samples_;
+
+    /// @brief Mutex protecting the history.
+    mutable isc::util::thread::Mutex mutex_;
+};
+
+/// @brief Pointer to the statistic.
+typedef boost::shared_ptr<StatsCounter> StatsCounterPtr;
+
+/// @brief Registry of the statistics maintained by the server.
+///
+/// The statistics are identified by names, e.g. "pkt4-received". The
+/// statistics pertaining to a particular subnet have names generated by
+/// @c StatsMgr::generateName, e.g. "subnet[1].assigned-addresses". The
+/// statistic is created when it is first used.
+///
+/// The registry is protected by a mutex. The code updating a statistic
+/// for each packet should obtain the pointer to it with
+/// @c StatsMgr::getCounter once and update the value with the methods
+/// of the @c StatsCounter, which don't take any lock.
+class StatsMgr : public boost::noncopyable {
+public:
+
+    /// @brief Returns the only instance of the statistics manager.
+    static StatsMgr& instance();
+
+    /// @brief Returns the statistic, creating it if it doesn't exist.
+    ///
+    /// @param name Name of the statistic.
+    /// @param type Type of the statistic created if it doesn't exist.
+    /// @return Pointer to the statistic.
+    StatsCounterPtr getCounter(const std::string& name,
+                               const StatsCounter::Type type =
+                               StatsCounter::COUNTER);
+
+    /// @brief Adds to the value of the statistic.
+    ///
+    /// @param name Name of the statistic.
+    /// @param value Value to be added, which may be negative.
+    /// @param type Type of the statistic created if it doesn't exist.
+    void addValue(const std::string& name, const int64_t value,
+                  const StatsCounter::Type type = StatsCounter::COUNTER);
+
+    /// @brief Sets the value of the gauge.
+    ///
+    /// @param name Name of the statistic.
+    /// @param value New value.
+    void setValue(const std::string& name, const int64_t value);
+
+    /// @brief Resets the statistic.
+    ///
+    /// @param name Name of the statistic.
+    /// @return true if the statistic has been found, false otherwise.
+    bool reset(const std::string& name);
+
+    /// @brief Resets all statistics.
+    void resetAll();
+
+    /// @brief Removes the statistic.
+    ///
+    /// The pointers to the statistic held by the server remain valid, but
+    /// the statistic is no longer reported.
+    ///
+    /// @param name Name of the statistic.
+    /// @return true if the statistic has been found, false otherwise.
+    bool remove(const std::string& name);
+
+    /// @brief Removes all statistics.
+    void removeAll();
+
+    /// @brief Returns the number of statistics.
+    size_t count() const;
+
+    /// @brief Records the current values of all statistics in their
+    /// history.
+    ///
+    /// @param max_samples Maximum number of samples held for each
+    /// statistic.
+    void sample(const size_t max_samples);
+
+    /// @brief Returns the statistic as a map element.
+    ///
+    /// @param name Name of the statistic.
+    /// @return Map holding the statistic in the format returned by
+    /// @c StatsCounter::toElement, or an empty map if the statistic
+    /// doesn't exist.
+    isc::data::ConstElementPtr get(const std::string& name) const;
+
+    /// @brief Returns all statistics as a map element.
+    isc::data::ConstElementPtr getAll() const;
+
+    /// @brief Generates the name of the statistic pertaining to an object.
+    ///
+    /// @param context Type of the object, e.g. "subnet".
+    /// @param id Identifier of the object.
+    /// @param name Name of the statistic.
+    /// @return Name in the format "context[id].name".
+    static std::string generateName(const std::string& context,
+                                    const uint32_t id,
+                                    const std::string& name);
+
+private:
+
+    /// @brief Constructor.
+    ///
+    /// The constructor is private, the only instance is returned by
+    /// @c StatsMgr::instance.
+    StatsMgr();
+
+    /// @brief Statistics by name.
+    typedef std::map<std::string, StatsCounterPtr> CounterMap;
+
+    /// @brief Statistics.
+    CounterMap counters_;
+
+    /// @brief Mutex protecting the registry.
+    mutable isc::util::thread::Mutex mutex_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // STATS_MGR_H
@@ -17,10 +17,24 @@
 #include <dhcpsrv/addr_utilities.h>
 #include <dhcpsrv/subnet.h>
 
+#include <algorithm>
 #include <sstream>
 
 using namespace isc::asiolink;
 
+namespace {
+
+/// @brief Checks if the address is lower than the first address of the pool.
+///
+/// @param addr Address to be compared.
+/// @param pool Pointer to the pool.
+bool
+lessFirstAddress(const IOAddress& addr, const isc::dhcp::PoolPtr& pool) {
+    return (addr < pool->getFirstAddress());
+}
+
+}
+
 namespace isc {
 namespace dhcp {
 
@@ -137,33 +151,77 @@ Subnet::getPoolCapacity(Lease::Type type) const {
     switch (type) {
     case Lease::TYPE_V4:
     case Lease::TYPE_NA:
-        return sumPoolCapacity(pools_);
+        return (pools_index_.capacity_);
     case Lease::TYPE_TA:
-        return sumPoolCapacity(pools_ta_);
+        return (pools_ta_index_.capacity_);
     case Lease::TYPE_PD:
-        return sumPoolCapacity(pools_pd_);
+        return (pools_pd_index_.capacity_);
     default:
         isc_throw(BadValue, "Unsupported pool type: "
                   << static_cast<int>(type));
     }
 }
 
-uint64_t
-Subnet::sumPoolCapacity(const PoolCollection& pools) const {
-    uint64_t sum = 0;
-    for (PoolCollection::const_iterator p = pools.begin(); p != pools.end(); ++p) {
-        uint64_t x = (*p)->getCapacity();
-
-        // Check if we can add it. If sum + x > uint64::max, then we would have
-        // overflown if we tried to add it.
-        if (x > std::numeric_limits<uint64_t>::max() - sum) {
-            return (std::numeric_limits<uint64_t>::max());
-        }
+void
+Subnet::PoolIndex::add(const PoolPtr& pool) {
+    uint64_t x = pool->getCapacity();
+
+    // Check if we can add it. If capacity + x > uint64::max, then we would
+    // have overflown if we tried to add it.
+    if (x > std::numeric_limits<uint64_t>::max() - capacity_) {
+        capacity_ = std::numeric_limits<uint64_t>::max();
+    } else {
+        capacity_ += x;
+    }
 
-        sum += x;
+    // Insert the pool after the pools with the same or lower first address.
+    PoolCollection::iterator pos =
+        sorted_.insert(std::upper_bound(sorted_.begin(), sorted_.end(),
+                                        pool->getFirstAddress(),
+                                        lessFirstAddress),
+                       pool);
+
+    // If the pools are sorted by the first address and don't overlap, it
+    // is enough to check the neighbours of the new pool.
+    if ((pos != sorted_.begin()) &&
+        !((*(pos - 1))->getLastAddress() < pool->getFirstAddress())) {
+        overlapping_ = true;
     }
+    if ((pos + 1 != sorted_.end()) &&
+        !(pool->getLastAddress() < (*(pos + 1))->getFirstAddress())) {
+        overlapping_ = true;
+    }
+}
 
-    return (sum);
+void
+Subnet::PoolIndex::clear() {
+    sorted_.clear();
+    capacity_ = 0;
+    overlapping_ = false;
+}
+
+PoolPtr
+Subnet::PoolIndex::find(const PoolCollection& pools,
+                        const IOAddress& addr) const {
+    if (overlapping_) {
+        for (PoolCollection::const_iterator pool = pools.begin();
+             pool != pools.end(); ++pool) {
+            if ((*pool)->inRange(addr)) {
+                return (*pool);
+            }
+        }
+        return (PoolPtr());
+    }
+
+    // Find the last pool which first address is not greater than the
+    // address. This is the only pool the address may belong to.
+    PoolCollection::const_iterator pool =
+        std::upper_bound(sorted_.begin(), sorted_.end(), addr,
+                         lessFirstAddress);
+    if ((pool != sorted_.begin()) && (*(pool - 1))->inRange(addr)) {
+        return (*(pool - 1));
+    }
+    return (PoolPtr());
 }
 
 void Subnet4::checkType(Lease::Type type) const {
@@ -215,6 +273,42 @@ const PoolCollection& Subnet::getPools(Lease::Type type) const {
     }
 }
 
+const Subnet::PoolIndex& Subnet::getPoolIndex(Lease::Type type) const {
+    // check if the type is valid (and throw if it isn't)
+    checkType(type);
+
+    switch (type) {
+    case Lease::TYPE_V4:
+    case Lease::TYPE_NA:
+        return (pools_index_);
+    case Lease::TYPE_TA:
+        return (pools_ta_index_);
+    case Lease::TYPE_PD:
+        return (pools_pd_index_);
+    default:
+        isc_throw(BadValue, "Unsupported pool type: "
+                  << static_cast<int>(type));
+    }
+}
+
+Subnet::PoolIndex& Subnet::getPoolIndexWritable(Lease::Type type) {
+    // check if the type is valid (and throw if it isn't)
+    checkType(type);
+
+    switch (type) {
+    case Lease::TYPE_V4:
+    case Lease::TYPE_NA:
+        return (pools_index_);
+    case Lease::TYPE_TA:
+        return (pools_ta_index_);
+    case Lease::TYPE_PD:
+        return (pools_pd_index_);
+    default:
+        isc_throw(BadValue, "Invalid pool type specified: "
+                  << static_cast<int>(type));
+    }
+}
+
 PoolCollection& Subnet::getPoolsWritable(Lease::Type type) {
     // check if the type is valid (and throw if it isn't)
     checkType(type);
@@ -240,22 +334,18 @@ const PoolPtr Subnet::getPool(Lease::Type type, const isc::asiolink::IOAddress&
 
     const PoolCollection& pools = getPools(type);
 
-    PoolPtr candidate;
-    for (PoolCollection::const_iterator pool = pools.begin();
-         pool != pools.end(); ++pool) {
-
-        // if we won't find anything better, then let's just use the first pool
-        if (anypool && !candidate) {
-            candidate = *pool;
-        }
+    // if the client provided a pool and there's a pool that hint is valid
+    // in, then let's use that pool
+    PoolPtr pool = getPoolIndex(type).find(pools, hint);
+    if (pool) {
+        return (pool);
+    }
 
-        // if the client provided a pool and there's a pool that hint is valid
-        // in, then let's use that pool
-        if ((*pool)->inRange(hint)) {
-            return (*pool);
-        }
+    // if we won't find anything better, then let's just use the first pool
+    if (anypool && !pools.empty()) {
+        return (pools.front());
     }
-    return (candidate);
+    return (PoolPtr());
 }
 
 void
@@ -284,11 +374,13 @@ Subnet::addPool(const PoolPtr& pool) {
 
     // Add the pool to the appropriate pools collection
     getPoolsWritable(pool->getType()).push_back(pool);
+    getPoolIndexWritable(pool->getType()).add(pool);
 }
 
 void
 Subnet::delPools(Lease::Type type) {
     getPoolsWritable(type).clear();
+    getPoolIndexWritable(type).clear();
 }
 
 void
@@ -309,16 +401,7 @@ Subnet::inPool(Lease::Type type, const isc::asiolink::IOAddress& addr) const {
         return (false);
     }
 
-    const PoolCollection& pools = getPools(type);
-
-    for (PoolCollection::const_iterator pool = pools.begin();
-         pool != pools.end(); ++pool) {
-        if ((*pool)->inRange(addr)) {
-            return (true);
-        }
-    }
-    // There's no pool that address belongs to
-    return (false);
+    return (static_cast<bool>(getPoolIndex(type).find(getPools(type), addr)));
 }
 
 Subnet6::Subnet6(const isc::asiolink::IOAddress& prefix, uint8_t length,
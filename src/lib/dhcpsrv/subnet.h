@@ -235,6 +235,9 @@ public:
 
     /// @brief Returns the number of possible leases for specified lease type
     ///
+    /// The capacity is computed when the pools are added, so this method
+    /// doesn't iterate over the pools.
+    ///
     /// @param type type of the lease
     uint64_t getPoolCapacity(Lease::Type type) const;
 
@@ -348,11 +351,70 @@ protected:
     /// @brief Returns all pools (non-const variant)
     ///
     /// The reference is only valid as long as the object that returned it.
+    /// The pools must not be added directly to the returned collection,
+    /// because it would bypass the pool index. Use @c addPool instead.
     ///
     /// @param type lease type to be set
     /// @return a collection of all pools
     PoolCollection& getPoolsWritable(Lease::Type type);
 
+    /// @brief Index of the pools of a single type.
+    ///
+    /// The pools are held in the @c PoolCollection in the order in which
+    /// they have been added. The index holds the same pools sorted by
+    /// their first addresses, which allows for finding the pool to which
+    /// the address belongs with a binary search. This is only possible
+    /// when the pools don't overlap. If they do, the pools are searched
+    /// linearly in the order in which they have been added, because
+    /// the first matching pool must be returned.
+    ///
+    /// The index also holds the total capacity of the pools.
+    struct PoolIndex {
+        /// @brief Constructor.
+        PoolIndex()
+            : sorted_(), capacity_(0), overlapping_(false) {
+        }
+
+        /// @brief Adds a pool to the index.
+        ///
+        /// @param pool Pointer to the pool.
+        void add(const PoolPtr& pool);
+
+        /// @brief Removes all pools from the index.
+        void clear();
+
+        /// @brief Returns the pool to which the address belongs.
+        ///
+        /// @param pools Pools in the order in which they have been added.
+        /// @param addr Address for which the pool is searched.
+        /// @return Pointer to the pool or NULL if the address doesn't
+        /// belong to any pool.
+        PoolPtr find(const PoolCollection& pools,
+                     const isc::asiolink::IOAddress& addr) const;
+
+        /// @brief Pools sorted by the first address.
+        PoolCollection sorted_;
+
+        /// @brief Total number of leases in the pools.
+        uint64_t capacity_;
+
+        /// @brief Indicates if any of the pools overlap.
+        bool overlapping_;
+    };
+
+    /// @brief Returns the pool index for the specified lease type.
+    ///
+    /// @param type lease type
+    /// @return pool index
+    const PoolIndex& getPoolIndex(Lease::Type type) const;
+
+    /// @brief Returns the pool index for the specified lease type
+    /// (non-const variant).
+    ///
+    /// @param type lease type
+    /// @return pool index
+    PoolIndex& getPoolIndexWritable(Lease::Type type);
+
     /// @brief Protected constructor
     //
     /// By making the constructor protected, we make sure that no one will
@@ -415,11 +477,6 @@ protected:
     /// @throw BadValue if invalid value is used
     virtual void checkType(Lease::Type type) const = 0;
 
-    /// @brief returns a sum of possible leases in all pools
-    /// @param pools list of pools
-    /// @return sum of possible leases
-    uint64_t sumPoolCapacity(const PoolCollection& pools) const;
-
     /// @brief subnet-id
     ///
     /// Subnet-id is a unique value that can be used to find or identify
@@ -435,6 +492,15 @@ protected:
     /// @brief collection of IPv6 prefix pools in that subnet
     PoolCollection pools_pd_;
 
+    /// @brief index of IPv4 or non-temporary IPv6 pools in that subnet
+    PoolIndex pools_index_;
+
+    /// @brief index of IPv6 temporary address pools in that subnet
+    PoolIndex pools_ta_index_;
+
+    /// @brief index of IPv6 prefix pools in that subnet
+    PoolIndex pools_pd_index_;
+
     /// @brief a prefix of the subnet
     isc::asiolink::IOAddress prefix_;
 
@@ -0,0 +1,114 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <dhcpsrv/addr_utilities.h>
+#include <dhcpsrv/subnet_index.h>
+
+#include <algorithm>
+
+using namespace isc::asiolink;
+
+namespace isc {
+namespace dhcp {
+
+SubnetIndex::SubnetIndex()
+    : built_(false) {
+}
+
+void
+SubnetIndex::clear() {
+    built_ = false;
+    prefixes_.clear();
+    prefix_lengths_.clear();
+    relays_.clear();
+    ifaces_.clear();
+    interface_ids_.clear();
+}
+
+void
+SubnetIndex::add(const size_t position, const SubnetPtr& subnet) {
+    std::pair<IOAddress, uint8_t> prefix = subnet->get();
+    const IOAddress first = firstAddrInPrefix(prefix.first, prefix.second);
+    prefixes_[std::make_pair(prefix.second, first)].push_back(position);
+    prefix_lengths_.insert(std::make_pair(first.getFamily(), prefix.second));
+
+    // The zero relay address means that the relay address is not specified.
+    const IOAddress& relay = subnet->getRelayInfo().addr_;
+    if (!relay.isV4Zero() && !relay.isV6Zero()) {
+        relays_[relay].push_back(position);
+    }
+
+    const std::string iface = subnet->getIface();
+    if (!iface.empty()) {
+        ifaces_[iface].push_back(position);
+    }
+
+    Subnet6Ptr subnet6 = boost::dynamic_pointer_cast<Subnet6>(subnet);
+    if (subnet6 && subnet6->getInterfaceId()) {
+        interface_ids_[subnet6->getInterfaceId()->getData()].push_back(position);
+    }
+}
+
+void
+SubnetIndex::getByAddress(const IOAddress& address,
+                          Positions& positions) const {
+    positions.clear();
+    // There is at most one prefix of each length which includes the
+    // address. Check the prefixes of all lengths used by the subnets.
+    const short family = address.getFamily();
+    for (std::set<std::pair<short, uint8_t> >::const_iterator length =
+             prefix_lengths_.lower_bound(std::make_pair(family, 0));
+         (length != prefix_lengths_.end()) && (length->first == family);
+         ++length) {
+        std::map<std::pair<uint8_t, IOAddress>, Positions>::const_iterator it =
+            prefixes_.find(std::make_pair(length->second,
+                                          firstAddrInPrefix(address,
+                                                            length->second)));
+        if (it != prefixes_.end()) {
+            positions.insert(positions.end(), it->second.begin(),
+                             it->second.end());
+        }
+    }
+    // The positions found for different lengths need to be merged.
+    std::sort(positions.begin(), positions.end());
+}
+
+const SubnetIndex::Positions&
+SubnetIndex::getByRelay(const IOAddress& address) const {
+    return (find(relays_, address));
+}
+
+const SubnetIndex::Positions&
+SubnetIndex::getByIface(const std::string& iface_name) const {
+    return (find(ifaces_, iface_name));
+}
+
+const SubnetIndex::Positions&
+SubnetIndex::getByInterfaceId(const OptionPtr& interface_id) const {
+    if (!interface_id) {
+        return (find(interface_ids_, OptionBuffer()));
+    }
+    return (find(interface_ids_, interface_id->getData()));
+}
+
+template<typename Key>
+const SubnetIndex::Positions&
+SubnetIndex::find(const std::map<Key, Positions>& map, const Key& key) {
+    static const Positions empty;
+    typename std::map<Key, Positions>::const_iterator it = map.find(key);
+    return (it != map.end() ? it->second : empty);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
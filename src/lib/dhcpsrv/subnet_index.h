@@ -0,0 +1,154 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef SUBNET_INDEX_H
+#define SUBNET_INDEX_H
+
+#include <asiolink/io_address.h>
+#include <dhcp/option.h>
+#include <dhcpsrv/subnet.h>
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Index of the subnets used for the fast subnet selection.
+///
+/// The subnets are held by the @c CfgSubnets4 and @c CfgSubnets6 in
+/// vectors, in the order in which they have been configured. The subnet
+/// selection returns the first subnet in this order which matches the
+/// client's packet. Scanning all subnets for each packet is slow when
+/// there are tens of thousands of subnets, so this class indexes the
+/// positions of the subnets in the vector by:
+/// - subnet prefix,
+/// - relay address,
+/// - interface name,
+/// - interface id (DHCPv6 only).
+///
+/// Each lookup returns the positions of the matching subnets in ascending
+/// order, so as the caller can pick the first one which supports the
+/// client classes. The prefix lookup checks the prefixes of each length
+/// used by the subnets, so it is logarithmic in the number of subnets.
+///
+/// The index reflects the state of the subnets at the time it was built.
+/// It must be rebuilt when the subnets are added or modified.
+class SubnetIndex {
+public:
+
+    /// @brief Positions of the subnets in the vector.
+    typedef std::vector<size_t> Positions;
+
+    /// @brief Constructor.
+    ///
+    /// Creates an index which is not built.
+    SubnetIndex();
+
+    /// @brief Builds the index for the collection of subnets.
+    ///
+    /// @param subnets Collection of pointers to @c Subnet4 or @c Subnet6
+    /// objects.
+    /// @tparam SubnetCollection Type of the collection.
+    template<typename SubnetCollection>
+    void build(const SubnetCollection& subnets) {
+        clear();
+        for (size_t i = 0; i < subnets.size(); ++i) {
+            add(i, subnets[i]);
+        }
+        built_ = true;
+    }
+
+    /// @brief Removes all entries from the index.
+    ///
+    /// The index is not built after this call.
+    void clear();
+
+    /// @brief Checks if the index has been built.
+    bool isBuilt() const {
+        return (built_);
+    }
+
+    /// @brief Returns positions of the subnets which prefixes include
+    /// the address.
+    ///
+    /// @param address Address for which the subnets are searched.
+    /// @param [out] positions Positions of the subnets in ascending order.
+    void getByAddress(const isc::asiolink::IOAddress& address,
+                      Positions& positions) const;
+
+    /// @brief Returns positions of the subnets with the relay address.
+    ///
+    /// @param address Relay address.
+    /// @return Positions of the subnets in ascending order.
+    const Positions& getByRelay(const isc::asiolink::IOAddress& address) const;
+
+    /// @brief Returns positions of the subnets with the interface name.
+    ///
+    /// @param iface_name Interface name.
+    /// @return Positions of the subnets in ascending order.
+    const Positions& getByIface(const std::string& iface_name) const;
+
+    /// @brief Returns positions of the subnets which interface id has the
+    /// same data as the specified option.
+    ///
+    /// The caller must check that the options are equal.
+    ///
+    /// @param interface_id Interface Id option.
+    /// @return Positions of the subnets in ascending order.
+    const Positions& getByInterfaceId(const OptionPtr& interface_id) const;
+
+private:
+
+    /// @brief Adds the subnet to the index.
+    ///
+    /// @param position Position of the subnet in the vector.
+    /// @param subnet Pointer to the subnet.
+    void add(const size_t position, const SubnetPtr& subnet);
+
+    /// @brief Returns the positions found in the map or empty positions.
+    ///
+    /// @param map Map in which the positions are searched.
+    /// @param key Key of the positions.
+    template<typename Key>
+    static const Positions& find(const std::map<Key, Positions>& map,
+                                 const Key& key);
+
+    /// @brief Indicates if the index has been built.
+    bool built_;
+
+    /// @brief Subnet positions by prefix length and the first address in
+    /// the prefix.
+    std::map<std::pair<uint8_t, isc::asiolink::IOAddress>, Positions> prefixes_;
+
+    /// @brief Prefix lengths used by the subnets of each address family.
+    std::set<std::pair<short, uint8_t> > prefix_lengths_;
+
+    /// @brief Subnet positions by relay address.
+    std::map<isc::asiolink::IOAddress, Positions> relays_;
+
+    /// @brief Subnet positions by interface name.
+    std::map<std::string, Positions> ifaces_;
+
+    /// @brief Subnet positions by interface id data.
+    std::map<OptionBuffer, Positions> interface_ids_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // SUBNET_INDEX_H
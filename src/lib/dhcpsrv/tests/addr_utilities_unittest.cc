@@ -277,4 +277,35 @@ TEST(AddrUtilitiesTest, prefixesInRange) {
 
 }
 
+// Checks if offsetAddress returns the address increased by the specified
+// number of addresses or prefixes.
+TEST(AddrUtilitiesTest, offsetAddress) {
+    EXPECT_EQ("192.0.2.15",
+              offsetAddress(IOAddress("192.0.2.10"), 5, 32).toText());
+    EXPECT_EQ("192.0.3.4",
+              offsetAddress(IOAddress("192.0.2.250"), 10, 32).toText());
+    EXPECT_EQ("192.0.4.0",
+              offsetAddress(IOAddress("192.0.2.0"), 2, 24).toText());
+    EXPECT_EQ("0.0.0.1",
+              offsetAddress(IOAddress("255.255.255.255"), 2, 32).toText());
+
+    EXPECT_EQ("2001:db8:1::10",
+              offsetAddress(IOAddress("2001:db8:1::1"), 15, 128).toText());
+    EXPECT_EQ("2001:db8:1::1:0",
+              offsetAddress(IOAddress("2001:db8:1::ffff"), 1, 128).toText());
+    EXPECT_EQ("2001:db8:1:1:ffff:ffff:ffff:fffe",
+              offsetAddress(IOAddress("2001:db8:1::ffff:ffff:ffff:ffff"),
+                            0xffffffffffffffffull, 128).toText());
+    EXPECT_EQ("2001:db8:1:3::",
+              offsetAddress(IOAddress("2001:db8:1::"), 3, 64).toText());
+    EXPECT_EQ("2001:db8:2:80::",
+              offsetAddress(IOAddress("2001:db8:1:ff80::"), 2, 57).toText());
+    EXPECT_EQ("2001:db9::",
+              offsetAddress(IOAddress("2001:db8::"), 1, 32).toText());
+
+    EXPECT_THROW(offsetAddress(IOAddress("192.0.2.1"), 1, 33), isc::BadValue);
+    EXPECT_THROW(offsetAddress(IOAddress("192.0.2.1"), 1, 0), isc::BadValue);
+    EXPECT_THROW(offsetAddress(IOAddress("2001:db8::"), 1, 129), isc::BadValue);
+}
+
 }; // end of anonymous namespace
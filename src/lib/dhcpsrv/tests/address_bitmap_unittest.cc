@@ -0,0 +1,139 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <dhcpsrv/address_bitmap.h>
+#include <exceptions/exceptions.h>
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+using namespace isc;
+using namespace isc::dhcp;
+using namespace isc::asiolink;
+
+namespace {
+
+// This test verifies that the bitmap can only be created for the valid
+// range of IPv4 addresses.
+TEST(AddressBitmapTest, constructor) {
+    EXPECT_THROW(AddressBitmap(IOAddress("2001:db8:1::1"),
+                               IOAddress("2001:db8:1::10")),
+                 BadValue);
+    EXPECT_THROW(AddressBitmap(IOAddress("192.0.2.10"),
+                               IOAddress("192.0.2.1")),
+                 BadValue);
+
+    AddressBitmap bitmap(IOAddress("192.0.2.1"), IOAddress("192.0.2.100"));
+    EXPECT_EQ("192.0.2.1", bitmap.getFirstAddress().toText());
+    EXPECT_EQ("192.0.2.100", bitmap.getLastAddress().toText());
+    EXPECT_EQ(100, bitmap.getFreeCount());
+
+    // A single address range is allowed.
+    AddressBitmap single(IOAddress("192.0.2.1"), IOAddress("192.0.2.1"));
+    EXPECT_EQ(1, single.getFreeCount());
+}
+
+// This test verifies that the addresses can be marked used and free.
+TEST(AddressBitmapTest, markUsedFree) {
+    AddressBitmap bitmap(IOAddress("192.0.2.1"), IOAddress("192.0.2.100"));
+    EXPECT_TRUE(bitmap.isFree(IOAddress("192.0.2.50")));
+
+    bitmap.markUsed(IOAddress("192.0.2.50"));
+    EXPECT_FALSE(bitmap.isFree(IOAddress("192.0.2.50")));
+    EXPECT_EQ(99, bitmap.getFreeCount());
+
+    // Marking the same address twice doesn't change the count.
+    bitmap.markUsed(IOAddress("192.0.2.50"));
+    EXPECT_EQ(99, bitmap.getFreeCount());
+
+    // Addresses out of range are ignored.
+    bitmap.markUsed(IOAddress("192.0.2.101"));
+    bitmap.markUsed(IOAddress("2001:db8:1::1"));
+    EXPECT_EQ(99, bitmap.getFreeCount());
+    EXPECT_FALSE(bitmap.isFree(IOAddress("192.0.2.101")));
+
+    bitmap.markFree(IOAddress("192.0.2.50"));
+    EXPECT_TRUE(bitmap.isFree(IOAddress("192.0.2.50")));
+    EXPECT_EQ(100, bitmap.getFreeCount());
+
+    bitmap.markUsed(IOAddress("192.0.2.1"));
+    bitmap.markUsed(IOAddress("192.0.2.100"));
+    EXPECT_EQ(98, bitmap.getFreeCount());
+    bitmap.clear();
+    EXPECT_EQ(100, bitmap.getFreeCount());
+    EXPECT_TRUE(bitmap.isFree(IOAddress("192.0.2.1")));
+}
+
+// This test verifies that the free addresses are returned in order,
+// starting from the address following the last returned address.
+TEST(AddressBitmapTest, pickFree) {
+    AddressBitmap bitmap(IOAddress("192.0.2.1"), IOAddress("192.0.2.200"));
+    IOAddress address("0.0.0.0");
+
+    ASSERT_TRUE(bitmap.pickFree(address));
+    EXPECT_EQ("192.0.2.1", address.toText());
+    ASSERT_TRUE(bitmap.pickFree(address));
+    EXPECT_EQ("192.0.2.2", address.toText());
+
+    // Used addresses are skipped, also across the word boundaries.
+    const uint32_t base = static_cast<uint32_t>(IOAddress("192.0.2.0"));
+    for (int i = 3; i <= 150; ++i) {
+        bitmap.markUsed(IOAddress(base + i));
+    }
+    ASSERT_TRUE(bitmap.pickFree(address));
+    EXPECT_EQ("192.0.2.151", address.toText());
+
+    // The search wraps around at the end of the range.
+    for (int i = 152; i <= 200; ++i) {
+        bitmap.markUsed(IOAddress(base + i));
+    }
+    ASSERT_TRUE(bitmap.pickFree(address));
+    EXPECT_EQ("192.0.2.1", address.toText());
+
+    // No free addresses.
+    bitmap.markUsed(IOAddress("192.0.2.1"));
+    bitmap.markUsed(IOAddress("192.0.2.2"));
+    bitmap.markUsed(IOAddress("192.0.2.151"));
+    EXPECT_EQ(0, bitmap.getFreeCount());
+    EXPECT_FALSE(bitmap.pickFree(address));
+
+    // The freed address is found.
+    bitmap.markFree(IOAddress("192.0.2.77"));
+    ASSERT_TRUE(bitmap.pickFree(address));
+    EXPECT_EQ("192.0.2.77", address.toText());
+}
+
+// This test verifies that each address in a large range is returned
+// exactly once when the returned addresses are marked used.
+TEST(AddressBitmapTest, pickAll) {
+    AddressBitmap bitmap(IOAddress("10.0.0.0"), IOAddress("10.0.3.254"));
+    const uint64_t size = bitmap.getFreeCount();
+    ASSERT_EQ(1023, size);
+
+    std::set<IOAddress> picked;
+    IOAddress address("0.0.0.0");
+    while (bitmap.pickFree(address)) {
+        ASSERT_TRUE(bitmap.isFree(address));
+        ASSERT_TRUE(picked.insert(address).second);
+        bitmap.markUsed(address);
+    }
+    EXPECT_EQ(size, picked.size());
+    EXPECT_EQ("10.0.0.0", picked.begin()->toText());
+    EXPECT_EQ("10.0.3.254", picked.rbegin()->toText());
+}
+
+} // end of anonymous namespace
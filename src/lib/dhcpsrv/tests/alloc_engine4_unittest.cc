@@ -16,6 +16,8 @@
 #include <dhcpsrv/tests/alloc_engine_utils.h>
 #include <dhcpsrv/tests/test_utils.h>
 
+#include <set>
+
 using namespace std;
 using namespace isc::hooks;
 using namespace isc::asiolink;
@@ -29,11 +31,13 @@ namespace test {
 TEST_F(AllocEngine4Test, constructor) {
     boost::scoped_ptr<AllocEngine> x;
 
-    // Hashed and random allocators are not supported yet
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5, false)),
-                 NotImplemented);
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5, false)),
-                 NotImplemented);
+    // Hashed and random allocators can be created.
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5,
+                                            false)));
+    EXPECT_TRUE(x->getAllocator(Lease::TYPE_V4));
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5,
+                                            false)));
+    EXPECT_TRUE(x->getAllocator(Lease::TYPE_V4));
 
     // Create V4 (ipv6=false) Allocation Engine that will try at most
     // 100 attempts to pick up a lease
@@ -336,6 +340,244 @@ TEST_F(AllocEngine4Test, IterativeAllocator_manyPools4) {
 }
 
 
+// This test verifies that the hashed allocator returns the same starting
+// address for the same client and then walks over all addresses in all
+// pools.
+TEST_F(AllocEngine4Test, HashedAllocator) {
+    NakedAllocEngine::HashedAllocator alloc(Lease::TYPE_V4);
+
+    // Add more pools. There are 10 addresses in the pool in the fixture.
+    for (int i = 2; i < 10; ++i) {
+        stringstream min, max;
+        min << "192.0.2." << i * 10 + 1;
+        max << "192.0.2." << i * 10 + 9;
+        subnet_->addPool(Pool4Ptr(new Pool4(IOAddress(min.str()),
+                                            IOAddress(max.str()))));
+    }
+    const size_t total = 10 + 8 * 9;
+
+    // The same client gets the same starting address.
+    IOAddress start = alloc.pickAddress(subnet_, clientid_,
+                                        IOAddress("0.0.0.0"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, start));
+    EXPECT_EQ(start, alloc.pickAddress(subnet_, clientid_,
+                                       IOAddress("0.0.0.0")));
+
+    // Different clients start at different addresses.
+    std::set<IOAddress> starts;
+    for (uint8_t i = 0; i < 10; ++i) {
+        ClientIdPtr clientid(new ClientId(vector<uint8_t>(8, i)));
+        IOAddress candidate = alloc.pickAddress(subnet_, clientid,
+                                                IOAddress("0.0.0.0"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+        starts.insert(candidate);
+    }
+    EXPECT_GT(starts.size(), 1);
+
+    // Passing the previous candidate, all addresses should be returned
+    // once before we get back to the starting address.
+    std::set<IOAddress> generated_addrs;
+    IOAddress candidate = start;
+    for (size_t i = 0; i < total; ++i) {
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+        candidate = alloc.pickAddress(subnet_, clientid_, candidate);
+    }
+    EXPECT_EQ(total, generated_addrs.size());
+    EXPECT_EQ(start, candidate);
+}
+
+// This test verifies that the random allocator returns addresses from all
+// pools and that it walks over all addresses when the previous candidate is
+// passed.
+TEST_F(AllocEngine4Test, RandomAllocator) {
+    NakedAllocEngine::RandomAllocator alloc(Lease::TYPE_V4);
+
+    subnet_->addPool(Pool4Ptr(new Pool4(IOAddress("192.0.2.200"),
+                                        IOAddress("192.0.2.209"))));
+
+    // Both pools should be used.
+    std::set<IOAddress> generated_addrs;
+    for (int i = 0; i < 1000; ++i) {
+        IOAddress candidate = alloc.pickAddress(subnet_, clientid_,
+                                                IOAddress("0.0.0.0"));
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+        generated_addrs.insert(candidate);
+    }
+    EXPECT_EQ(20, generated_addrs.size());
+
+    // The last address of the last pool is followed by the first address
+    // of the first pool.
+    EXPECT_EQ("192.0.2.100",
+              alloc.pickAddress(subnet_, clientid_,
+                                IOAddress("192.0.2.209")).toText());
+
+    generated_addrs.clear();
+    IOAddress candidate = alloc.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0"));
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+        candidate = alloc.pickAddress(subnet_, clientid_, candidate);
+    }
+}
+
+// This test verifies that the allocation engine using the hashed and the
+// random allocator allocates all addresses in the pool.
+TEST_F(AllocEngine4Test, hashedRandomAllocatorExhaustPool) {
+    const AllocEngine::AllocType types[] = { AllocEngine::ALLOC_HASHED,
+                                             AllocEngine::ALLOC_RANDOM };
+    for (int t = 0; t < 2; ++t) {
+        SCOPED_TRACE(t == 0 ? "hashed" : "random");
+        LeaseMgrFactory::destroy();
+        LeaseMgrFactory::create("type=memfile universe=4 persist=false");
+
+        boost::scoped_ptr<AllocEngine> engine;
+        ASSERT_NO_THROW(engine.reset(new AllocEngine(types[t], 100, false)));
+
+        // The pool has 10 addresses. Allocate them for different clients,
+        // some of which don't send client identifier.
+        std::set<IOAddress> allocated;
+        for (int i = 0; i < 10; ++i) {
+            uint8_t hwaddr_data[] = { 0, 0xfe, 0xfe, 0xfe, 0xfe,
+                                      static_cast<uint8_t>(i) };
+            HWAddrPtr hwaddr(new HWAddr(hwaddr_data, sizeof(hwaddr_data),
+                                        HTYPE_ETHER));
+            ClientIdPtr clientid;
+            if (i % 2) {
+                clientid.reset(new ClientId(vector<uint8_t>(8, i)));
+            }
+            AllocEngine::ClientContext4 ctx(subnet_, clientid, hwaddr,
+                                            IOAddress("0.0.0.0"), false,
+                                            false, "", false);
+            Lease4Ptr lease = engine->allocateLease4(ctx);
+            ASSERT_TRUE(lease);
+            EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, lease->addr_));
+            EXPECT_TRUE(allocated.insert(lease->addr_).second);
+        }
+
+        // There are no more addresses.
+        AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_,
+                                        IOAddress("0.0.0.0"), false, false,
+                                        "", false);
+        EXPECT_FALSE(engine->allocateLease4(ctx));
+    }
+}
+
+// This test verifies that the bitmap allocator returns only free addresses
+// and that it takes into account the leases in the lease database.
+TEST_F(AllocEngine4Test, BitmapAllocator) {
+    EXPECT_THROW(NakedAllocEngine::BitmapAllocator(Lease::TYPE_NA), BadValue);
+
+    // Populate the bitmaps whenever the pool is exhausted.
+    NakedAllocEngine::BitmapAllocator alloc(Lease::TYPE_V4, 0);
+
+    // Create a valid lease for the first address in the pool and an expired
+    // lease for the second address.
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.100"), hwaddr_, 0, 0,
+                               500, 100, 200, time(NULL), subnet_->getID()));
+    ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    lease.reset(new Lease4(IOAddress("192.0.2.101"), hwaddr_, 0, 0,
+                           100, 100, 200, time(NULL) - 500, subnet_->getID()));
+    ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+
+    // The leased address is skipped. The address of the expired lease
+    // may be reused.
+    IOAddress candidate = alloc.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.101", candidate.toText());
+
+    // Mark all remaining addresses used.
+    for (int i = 1; i < 10; ++i) {
+        alloc.addressUsed(IOAddress(static_cast<uint32_t>(pool_->getFirstAddress()) + i));
+    }
+
+    // The allocator should check the lease database again, because some of
+    // the leases may have expired. The address of the expired lease should
+    // be returned.
+    candidate = alloc.pickAddress(subnet_, clientid_, IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.101", candidate.toText());
+
+    // Fill the pool in the lease database. There are no free addresses.
+    ASSERT_TRUE(LeaseMgrFactory::instance().deleteLease(IOAddress("192.0.2.101")));
+    for (int i = 1; i < 10; ++i) {
+        lease.reset(new Lease4(IOAddress(static_cast<uint32_t>(pool_->getFirstAddress()) + i),
+                               hwaddr_, 0, 0, 500, 100, 200, time(NULL),
+                               subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+    candidate = alloc.pickAddress(subnet_, clientid_, IOAddress("0.0.0.0"));
+    EXPECT_TRUE(candidate.isV4Zero());
+
+    // The freed address is returned.
+    ASSERT_TRUE(LeaseMgrFactory::instance().deleteLease(IOAddress("192.0.2.105")));
+    alloc.addressFreed(IOAddress("192.0.2.105"));
+    candidate = alloc.pickAddress(subnet_, clientid_, IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.105", candidate.toText());
+}
+
+// This test verifies that the bitmap allocator doesn't read the leases
+// from the lease database each time the pool is exhausted.
+TEST_F(AllocEngine4Test, bitmapAllocatorRepopulateInterval) {
+    NakedAllocEngine::BitmapAllocator alloc(Lease::TYPE_V4, 3600);
+
+    // The bitmaps are populated when the first address is picked.
+    IOAddress candidate = alloc.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.100", candidate.toText());
+
+    // Mark all addresses used, but leave them free in the lease database.
+    for (int i = 0; i < 10; ++i) {
+        alloc.addressUsed(IOAddress(static_cast<uint32_t>(pool_->getFirstAddress()) + i));
+    }
+
+    // The bitmaps have been populated recently, so the allocator doesn't
+    // find the free addresses in the lease database.
+    candidate = alloc.pickAddress(subnet_, clientid_, IOAddress("0.0.0.0"));
+    EXPECT_TRUE(candidate.isV4Zero());
+
+    // The addresses freed by the allocation engine are still returned.
+    alloc.addressFreed(IOAddress("192.0.2.105"));
+    candidate = alloc.pickAddress(subnet_, clientid_, IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.105", candidate.toText());
+}
+
+// This test verifies that the allocation engine using the bitmap allocator
+// allocates all addresses in the pool and reuses the released address.
+TEST_F(AllocEngine4Test, bitmapAllocatorExhaustPool) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_BITMAP,
+                                                 100, false)));
+    ASSERT_TRUE(engine);
+
+    // The pool has 10 addresses. Allocate them for different clients.
+    std::set<IOAddress> allocated;
+    for (int i = 0; i < 10; ++i) {
+        uint8_t hwaddr_data[] = { 0, 0xfe, 0xfe, 0xfe, 0xfe,
+                                  static_cast<uint8_t>(i) };
+        HWAddrPtr hwaddr(new HWAddr(hwaddr_data, sizeof(hwaddr_data),
+                                    HTYPE_ETHER));
+        AllocEngine::ClientContext4 ctx(subnet_, ClientIdPtr(), hwaddr,
+                                        IOAddress("0.0.0.0"), false, false,
+                                        "", false);
+        Lease4Ptr lease = engine->allocateLease4(ctx);
+        ASSERT_TRUE(lease);
+        EXPECT_TRUE(allocated.insert(lease->addr_).second);
+    }
+
+    // There are no more addresses.
+    AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_,
+                                    IOAddress("0.0.0.0"), false, false,
+                                    "", false);
+    EXPECT_FALSE(engine->allocateLease4(ctx));
+
+    // Release one of the addresses. It should be allocated to our client.
+    ASSERT_TRUE(LeaseMgrFactory::instance().deleteLease(IOAddress("192.0.2.107")));
+    engine->leaseRemoved4(IOAddress("192.0.2.107"));
+    Lease4Ptr lease = engine->allocateLease4(ctx);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.107", lease->addr_.toText());
+}
+
 // This test checks if really small pools are working
 TEST_F(AllocEngine4Test, smallPool4) {
     boost::scoped_ptr<AllocEngine> engine;
@@ -536,6 +778,48 @@ TEST_F(AllocEngine4Test, requestReuseExpiredLease4) {
     EXPECT_TRUE(*ctx.old_lease_ == original_lease);
 }
 
+// This test checks that the expired leases are reclaimed, starting from
+// the leases which expired first, and that the valid leases are left intact.
+TEST_F(AllocEngine4Test, reclaimExpiredLeases4) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                 100, false)));
+    ASSERT_TRUE(engine);
+
+    // Create three expired leases and one valid lease. The lease for
+    // 192.0.2.103 expired first.
+    const char* addrs[] = { "192.0.2.101", "192.0.2.102", "192.0.2.103",
+                            "192.0.2.104" };
+    const uint32_t valid_lft[] = { 200, 100, 10, 1000 };
+    for (int i = 0; i < 4; ++i) {
+        Lease4Ptr lease(new Lease4(IOAddress(addrs[i]), hwaddr_, 0, 0,
+                                   valid_lft[i], 100, 200, time(NULL) - 500,
+                                   subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    // Reclaim at most two leases. The ones which expired first should
+    // be reclaimed.
+    Lease4Collection reclaimed;
+    ASSERT_NO_THROW(reclaimed = engine->reclaimExpiredLeases4(2));
+    ASSERT_EQ(2, reclaimed.size());
+    EXPECT_EQ("192.0.2.103", reclaimed[0]->addr_.toText());
+    EXPECT_EQ("192.0.2.102", reclaimed[1]->addr_.toText());
+    EXPECT_FALSE(LeaseMgrFactory::instance().getLease4(IOAddress(addrs[1])));
+    EXPECT_FALSE(LeaseMgrFactory::instance().getLease4(IOAddress(addrs[2])));
+
+    // Reclaim all remaining expired leases.
+    ASSERT_NO_THROW(reclaimed = engine->reclaimExpiredLeases4(0));
+    ASSERT_EQ(1, reclaimed.size());
+    EXPECT_EQ("192.0.2.101", reclaimed[0]->addr_.toText());
+    EXPECT_FALSE(LeaseMgrFactory::instance().getLease4(IOAddress(addrs[0])));
+
+    // The valid lease should still be there.
+    EXPECT_TRUE(LeaseMgrFactory::instance().getLease4(IOAddress(addrs[3])));
+    ASSERT_NO_THROW(reclaimed = engine->reclaimExpiredLeases4(0));
+    EXPECT_TRUE(reclaimed.empty());
+}
+
 // This test checks that when the client requests the address which belongs
 // to another client, the allocation engine returns NULL (for the
 // DHCPREQUEST case) or a lease for the address which belongs to this
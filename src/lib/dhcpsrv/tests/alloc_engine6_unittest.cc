@@ -13,6 +13,7 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include <config.h>
+#include <dhcpsrv/addr_utilities.h>
 #include <dhcpsrv/tests/alloc_engine_utils.h>
 #include <dhcpsrv/tests/test_utils.h>
 
@@ -29,9 +30,11 @@ namespace test {
 TEST_F(AllocEngine6Test, constructor) {
     boost::scoped_ptr<AllocEngine> x;
 
-    // Hashed and random allocators are not supported yet
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5)), NotImplemented);
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5)), NotImplemented);
+    // Hashed and random allocators can be created.
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5)));
+    EXPECT_TRUE(x->getAllocator(Lease::TYPE_PD));
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5)));
+    EXPECT_TRUE(x->getAllocator(Lease::TYPE_PD));
 
     ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 100, true)));
 
@@ -360,6 +363,43 @@ TEST_F(AllocEngine6Test, IterativeAllocator_manyPools6) {
     }
 }
 
+// This test verifies that the hashed allocator returns the same starting
+// address for the same client and walks over all addresses in the pool.
+TEST_F(AllocEngine6Test, HashedAllocator) {
+    NakedAllocEngine::HashedAllocator alloc(Lease::TYPE_NA);
+
+    IOAddress start = alloc.pickAddress(subnet_, duid_, IOAddress("::"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_NA, start));
+    EXPECT_EQ(start, alloc.pickAddress(subnet_, duid_, IOAddress("::")));
+
+    // The pool in the fixture has 17 addresses.
+    std::set<IOAddress> generated_addrs;
+    IOAddress candidate = start;
+    for (int i = 0; i < 17; ++i) {
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_NA, candidate));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+        candidate = alloc.pickAddress(subnet_, duid_, candidate);
+    }
+    EXPECT_EQ(start, candidate);
+}
+
+// This test verifies that the random allocator returns valid prefixes and
+// walks over all prefixes in the pool when the previous candidate is passed.
+TEST_F(AllocEngine6Test, RandomAllocatorPrefix) {
+    NakedAllocEngine::RandomAllocator alloc(Lease::TYPE_PD);
+
+    // The pool in the fixture has 256 prefixes of length 64.
+    std::set<IOAddress> generated_addrs;
+    IOAddress candidate = alloc.pickAddress(subnet_, duid_, IOAddress("::"));
+    for (int i = 0; i < 256; ++i) {
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_PD, candidate));
+        EXPECT_EQ(candidate, firstAddrInPrefix(candidate, 64));
+        EXPECT_TRUE(generated_addrs.insert(candidate).second);
+        candidate = alloc.pickAddress(subnet_, duid_, candidate);
+    }
+    EXPECT_EQ(256, generated_addrs.size());
+}
+
 // This test checks if really small pools are working
 TEST_F(AllocEngine6Test, smallPool6) {
     boost::scoped_ptr<AllocEngine> engine;
@@ -547,6 +587,50 @@ TEST_F(AllocEngine6Test, requestReuseExpiredLease6) {
     detailCompareLease(lease, from_mgr);
 }
 
+// This test checks that the expired leases are reclaimed, starting from
+// the leases which expired first, and that the valid leases are left intact.
+TEST_F(AllocEngine6Test, reclaimExpiredLeases6) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 100)));
+    ASSERT_TRUE(engine);
+
+    // Create three expired leases and one valid lease. The lease for
+    // 2001:db8:1::3 expired first.
+    const char* addrs[] = { "2001:db8:1::1", "2001:db8:1::2", "2001:db8:1::3",
+                            "2001:db8:1::4" };
+    const uint32_t valid_lft[] = { 200, 100, 10, 1000 };
+    for (int i = 0; i < 4; ++i) {
+        Lease6Ptr lease(new Lease6(Lease::TYPE_NA, IOAddress(addrs[i]), duid_,
+                                   iaid_, 300, valid_lft[i], 100, 200,
+                                   subnet_->getID(), HWAddrPtr(), 0));
+        lease->cltt_ = time(NULL) - 500;
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    // Reclaim at most two leases. The ones which expired first should
+    // be reclaimed.
+    Lease6Collection reclaimed;
+    ASSERT_NO_THROW(reclaimed = engine->reclaimExpiredLeases6(2));
+    ASSERT_EQ(2, reclaimed.size());
+    EXPECT_EQ("2001:db8:1::3", reclaimed[0]->addr_.toText());
+    EXPECT_EQ("2001:db8:1::2", reclaimed[1]->addr_.toText());
+    EXPECT_FALSE(LeaseMgrFactory::instance().getLease6(Lease::TYPE_NA,
+                                                       IOAddress(addrs[1])));
+    EXPECT_FALSE(LeaseMgrFactory::instance().getLease6(Lease::TYPE_NA,
+                                                       IOAddress(addrs[2])));
+
+    // Reclaim all remaining expired leases.
+    ASSERT_NO_THROW(reclaimed = engine->reclaimExpiredLeases6(0));
+    ASSERT_EQ(1, reclaimed.size());
+    EXPECT_EQ("2001:db8:1::1", reclaimed[0]->addr_.toText());
+
+    // The valid lease should still be there.
+    EXPECT_TRUE(LeaseMgrFactory::instance().getLease6(Lease::TYPE_NA,
+                                                      IOAddress(addrs[3])));
+    ASSERT_NO_THROW(reclaimed = engine->reclaimExpiredLeases6(0));
+    EXPECT_TRUE(reclaimed.empty());
+}
+
 // --- v6 host reservation ---
 
 // Checks that a client gets the address reserved (in-pool case)
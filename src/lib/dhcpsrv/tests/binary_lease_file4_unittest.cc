@@ -0,0 +1,411 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/tests/lease_file_io.h>
+#include <boost/scoped_ptr.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::dhcp::test;
+
+namespace {
+
+// HWADDR values used by unit tests.
+const uint8_t HWADDR0[] = { 0, 1, 2, 3, 4, 5 };
+const uint8_t HWADDR1[] = { 0xd, 0xe, 0xa, 0xd, 0xb, 0xe, 0xe, 0xf };
+
+const uint8_t CLIENTID0[] = { 1, 2, 3, 4 };
+
+/// @brief Test fixture class for @c BinaryLeaseFile4 validation.
+class BinaryLeaseFile4Test : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Initializes IO for lease file used by unit tests.
+    BinaryLeaseFile4Test();
+
+    /// @brief Prepends the absolute path to the file specified
+    /// as an argument.
+    ///
+    /// @param filename Name of the file.
+    /// @return Absolute path to the test file.
+    static std::string absolutePath(const std::string& filename);
+
+    /// @brief Creates a lease for the address.
+    ///
+    /// @param address Leased address.
+    /// @param hwaddr HW address of the client.
+    Lease4Ptr createLease(const std::string& address,
+                          const HWAddrPtr& hwaddr) const {
+        Lease4Ptr lease(new Lease4(IOAddress(address), hwaddr, CLIENTID0,
+                                   sizeof(CLIENTID0), 200, 0, 0, 1000, 8,
+                                   true, false, "host.example.com"));
+        return (lease);
+    }
+
+    /// @brief Writes the leases to the lease file.
+    ///
+    /// @param leases Leases to be written.
+    void writeLeases(const Lease4Collection& leases) const;
+
+    /// @brief Returns the size of the lease file.
+    off_t getFileSize() const;
+
+    /// @brief Checks the stats for the file
+    ///
+    /// This method is passed a leasefile and the values for the statistics it
+    /// should have for comparison.
+    ///
+    /// @param lease_file A reference to the file we are using
+    /// @param reads the number of attempted reads
+    /// @param read_leases the number of valid leases read
+    /// @param read_errs the number of errors while reading leases
+    /// @param writes the number of attempted writes
+    /// @param write_leases the number of leases successfully written
+    /// @param write_errs the number of errors while writing
+    void checkStats(BinaryLeaseFile4& lease_file,
+                    uint32_t reads, uint32_t read_leases,
+                    uint32_t read_errs, uint32_t writes,
+                    uint32_t write_leases, uint32_t write_errs) const {
+        EXPECT_EQ(reads, lease_file.getReads());
+        EXPECT_EQ(read_leases, lease_file.getReadLeases());
+        EXPECT_EQ(read_errs, lease_file.getReadErrs());
+        EXPECT_EQ(writes, lease_file.getWrites());
+        EXPECT_EQ(write_leases, lease_file.getWriteLeases());
+        EXPECT_EQ(write_errs, lease_file.getWriteErrs());
+    }
+
+    /// @brief Name of the test lease file.
+    std::string filename_;
+
+    /// @brief Object providing access to lease file IO.
+    LeaseFileIO io_;
+
+    /// @brief hardware address 0 (corresponds to HWADDR0 const)
+    HWAddrPtr hwaddr0_;
+
+    /// @brief hardware address 1 (corresponds to HWADDR1 const)
+    HWAddrPtr hwaddr1_;
+
+};
+
+BinaryLeaseFile4Test::BinaryLeaseFile4Test()
+    : filename_(absolutePath("leases4.bin")), io_(filename_) {
+    hwaddr0_.reset(new HWAddr(HWADDR0, sizeof(HWADDR0), HTYPE_ETHER));
+    hwaddr1_.reset(new HWAddr(HWADDR1, sizeof(HWADDR1), HTYPE_ETHER));
+}
+
+std::string
+BinaryLeaseFile4Test::absolutePath(const std::string& filename) {
+    std::ostringstream s;
+    s << DHCP_DATA_DIR << "/" << filename;
+    return (s.str());
+}
+
+void
+BinaryLeaseFile4Test::writeLeases(const Lease4Collection& leases) const {
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        ASSERT_NO_THROW(lf.append(**lease));
+    }
+    lf.close();
+}
+
+off_t
+BinaryLeaseFile4Test::getFileSize() const {
+    const int fd = open(filename_.c_str(), O_RDONLY);
+    const off_t size = lseek(fd, 0, SEEK_END);
+    close(fd);
+    return (size);
+}
+
+// This test checks that the leases written to the file are read back.
+TEST_F(BinaryLeaseFile4Test, appendAndRead) {
+    boost::scoped_ptr<BinaryLeaseFile4> lf(new BinaryLeaseFile4(filename_));
+    ASSERT_NO_THROW(lf->open());
+    {
+    SCOPED_TRACE("Check stats are empty");
+    checkStats(*lf, 0, 0, 0, 0, 0, 0);
+    }
+
+    // The lease without the client identifier and hostname.
+    Lease4Ptr lease0(new Lease4(IOAddress("192.0.2.1"), hwaddr0_, NULL, 0,
+                                100, 0, 0, 0, 7));
+    Lease4Ptr lease1 = createLease("192.0.3.15", hwaddr1_);
+    // The lease with the expiration time beyond 2038.
+    Lease4Ptr lease2 = createLease("192.0.3.16", hwaddr1_);
+    lease2->cltt_ = static_cast<time_t>(0x100000000LL);
+    lease2->fqdn_fwd_ = false;
+    lease2->fqdn_rev_ = true;
+
+    ASSERT_NO_THROW(lf->append(*lease0));
+    ASSERT_NO_THROW(lf->append(*lease1));
+    ASSERT_NO_THROW(lf->append(*lease2));
+    {
+    SCOPED_TRACE("Write stats");
+    checkStats(*lf, 0, 0, 0, 3, 3, 0);
+    }
+    lf->close();
+
+    ASSERT_TRUE(BinaryLeaseFile::isBinary(filename_));
+
+    ASSERT_NO_THROW(lf->open());
+    Lease4Ptr lease;
+    ASSERT_TRUE(lf->next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease0);
+    EXPECT_FALSE(lease->client_id_);
+    ASSERT_TRUE(lf->next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease1);
+    ASSERT_TRUE(lf->next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease2);
+
+    // There are no more leases.
+    ASSERT_TRUE(lf->next(lease));
+    EXPECT_FALSE(lease);
+    {
+    SCOPED_TRACE("Read stats");
+    checkStats(*lf, 4, 3, 0, 0, 0, 0);
+    }
+}
+
+// This test checks that the CSV file and a missing file are not reported
+// as binary lease files.
+TEST_F(BinaryLeaseFile4Test, isBinary) {
+    EXPECT_FALSE(BinaryLeaseFile::isBinary(filename_));
+
+    io_.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname\n");
+    EXPECT_FALSE(BinaryLeaseFile::isBinary(filename_));
+
+    io_.removeFile();
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    lf.close();
+    EXPECT_TRUE(BinaryLeaseFile::isBinary(filename_));
+}
+
+// This test checks that the leases are appended to the existing file.
+TEST_F(BinaryLeaseFile4Test, reopenAndAppend) {
+    Lease4Collection leases;
+    leases.push_back(createLease("192.0.2.1", hwaddr0_));
+    writeLeases(leases);
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open(true));
+    Lease4Ptr lease1 = createLease("192.0.2.2", hwaddr1_);
+    ASSERT_NO_THROW(lf.append(*lease1));
+    lf.close();
+
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr lease;
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *leases[0]);
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease1);
+    ASSERT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+}
+
+// This test checks that the record partially written at the end of the
+// file is reported as an error and removed before appending a lease.
+TEST_F(BinaryLeaseFile4Test, truncatedRecord) {
+    Lease4Collection leases;
+    leases.push_back(createLease("192.0.2.1", hwaddr0_));
+    leases.push_back(createLease("192.0.2.2", hwaddr1_));
+    writeLeases(leases);
+
+    // Cut off the end of the second record.
+    ASSERT_EQ(0, truncate(filename_.c_str(), getFileSize() - 3));
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr lease;
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *leases[0]);
+    EXPECT_FALSE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    EXPECT_EQ("incomplete record at the end of the file", lf.getReadMsg());
+    ASSERT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    {
+    SCOPED_TRACE("Read stats");
+    checkStats(lf, 3, 1, 1, 0, 0, 0);
+    }
+
+    // Append the lease after reading the file, as the server does.
+    Lease4Ptr lease2 = createLease("192.0.2.3", hwaddr1_);
+    ASSERT_NO_THROW(lf.append(*lease2));
+    lf.close();
+
+    // The incomplete record has been removed.
+    ASSERT_NO_THROW(lf.open());
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *leases[0]);
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease2);
+    ASSERT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+}
+
+// This test checks that the record with a checksum mismatch is skipped.
+TEST_F(BinaryLeaseFile4Test, checksumMismatch) {
+    Lease4Collection leases;
+    leases.push_back(createLease("192.0.2.1", hwaddr0_));
+    leases.push_back(createLease("192.0.2.2", hwaddr1_));
+    writeLeases(leases);
+
+    // Modify the address of the first lease.
+    const int fd = open(filename_.c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    const uint8_t byte = 0xFF;
+    ASSERT_EQ(1, pwrite(fd, &byte, 1, BinaryLeaseFile::HEADER_SIZE +
+                        BinaryLeaseFile::RECORD_HEADER_SIZE + 3));
+    close(fd);
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr lease;
+    EXPECT_FALSE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    EXPECT_EQ("checksum mismatch", lf.getReadMsg());
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *leases[1]);
+    ASSERT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+}
+
+// This test checks that the corrupted length of the record which is not
+// the last one fails the read and the file is not truncated.
+TEST_F(BinaryLeaseFile4Test, corruptedLength) {
+    Lease4Collection leases;
+    leases.push_back(createLease("192.0.2.1", hwaddr0_));
+    leases.push_back(createLease("192.0.2.2", hwaddr1_));
+    writeLeases(leases);
+    const off_t file_size = getFileSize();
+
+    // Set the length of the first record beyond the end of the file.
+    const int fd = open(filename_.c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    const uint8_t length[] = { 0xFF, 0x00 };
+    ASSERT_EQ(2, pwrite(fd, length, sizeof(length),
+                        BinaryLeaseFile::HEADER_SIZE));
+    close(fd);
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr lease;
+    EXPECT_THROW(lf.next(lease), BinaryLeaseFileError);
+    EXPECT_FALSE(lease);
+
+    // Appending must not remove the valid record.
+    Lease4Ptr lease2 = createLease("192.0.2.3", hwaddr1_);
+    ASSERT_NO_THROW(lf.append(*lease2));
+    lf.close();
+    EXPECT_LT(file_size, getFileSize());
+}
+
+// This test checks that the record which length has been changed is
+// skipped and the misaligned records which follow fail the read.
+TEST_F(BinaryLeaseFile4Test, lengthChecksumMismatch) {
+    Lease4Collection leases;
+    leases.push_back(createLease("192.0.2.1", hwaddr0_));
+    leases.push_back(createLease("192.0.2.2", hwaddr1_));
+    writeLeases(leases);
+
+    // Shorten the first record by one byte. The checksum covers the
+    // length, so the record doesn't match it.
+    const int fd = open(filename_.c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    uint8_t length[2];
+    ASSERT_EQ(2, pread(fd, length, sizeof(length),
+                       BinaryLeaseFile::HEADER_SIZE));
+    --length[1];
+    ASSERT_EQ(2, pwrite(fd, length, sizeof(length),
+                        BinaryLeaseFile::HEADER_SIZE));
+    close(fd);
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr lease;
+    EXPECT_FALSE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    EXPECT_EQ("checksum mismatch", lf.getReadMsg());
+
+    // Reading from the misaligned offset fails sooner or later.
+    bool thrown = false;
+    for (int i = 0; i < 10 && !thrown; ++i) {
+        try {
+            if (lf.next(lease) && !lease) {
+                break;
+            }
+        } catch (const BinaryLeaseFileError&) {
+            thrown = true;
+        }
+    }
+    EXPECT_TRUE(thrown);
+}
+
+// This test checks that the file which is not a binary lease file for
+// DHCPv4 is not opened.
+TEST_F(BinaryLeaseFile4Test, invalidHeader) {
+    io_.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname\n");
+    BinaryLeaseFile4 lf(filename_);
+    EXPECT_THROW(lf.open(), BinaryLeaseFileError);
+
+    // The file holding DHCPv6 leases.
+    io_.removeFile();
+    BinaryLeaseFile6 lf6(filename_);
+    ASSERT_NO_THROW(lf6.open());
+    lf6.close();
+    EXPECT_THROW(lf.open(), BinaryLeaseFileError);
+}
+
+// This test checks that the lease without the HW address is not written.
+TEST_F(BinaryLeaseFile4Test, noHWAddr) {
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr lease = createLease("192.0.2.1", HWAddrPtr());
+    EXPECT_THROW(lf.append(*lease), BadValue);
+    {
+    SCOPED_TRACE("Write stats");
+    checkStats(lf, 0, 0, 0, 1, 0, 1);
+    }
+}
+
+} // end of anonymous namespace
@@ -0,0 +1,228 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/tests/lease_file_io.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::dhcp::test;
+
+namespace {
+
+// DUID values used by unit tests.
+const uint8_t DUID0[] = { 0, 1, 2, 3, 4, 5, 6, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf };
+const uint8_t DUID1[] = { 1, 1, 1, 1, 0xa, 1, 2, 3, 4, 5 };
+
+// HWADDR value used by unit tests.
+const uint8_t HWADDR0[] = { 0, 1, 2, 3, 4, 5 };
+
+/// @brief Test fixture class for @c BinaryLeaseFile6 validation.
+class BinaryLeaseFile6Test : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Initializes IO for lease file used by unit tests.
+    BinaryLeaseFile6Test();
+
+    /// @brief Prepends the absolute path to the file specified
+    /// as an argument.
+    ///
+    /// @param filename Name of the file.
+    /// @return Absolute path to the test file.
+    static std::string absolutePath(const std::string& filename);
+
+    /// @brief Creates an address lease with the HW address.
+    ///
+    /// @param address Leased address.
+    Lease6Ptr createLease(const std::string& address) const {
+        HWAddrPtr hwaddr(new HWAddr(HWADDR0, sizeof(HWADDR0), HTYPE_ETHER));
+        Lease6Ptr lease(new Lease6(Lease::TYPE_NA, IOAddress(address),
+                                   duid0_, 7, 100, 200, 0, 0, 8, true, true,
+                                   "host.example.com", hwaddr));
+        lease->cltt_ = 1000;
+        return (lease);
+    }
+
+    /// @brief Checks the stats for the file
+    ///
+    /// This method is passed a leasefile and the values for the statistics it
+    /// should have for comparison.
+    ///
+    /// @param lease_file A reference to the file we are using
+    /// @param reads the number of attempted reads
+    /// @param read_leases the number of valid leases read
+    /// @param read_errs the number of errors while reading leases
+    /// @param writes the number of attempted writes
+    /// @param write_leases the number of leases successfully written
+    /// @param write_errs the number of errors while writing
+    void checkStats(BinaryLeaseFile6& lease_file,
+                    uint32_t reads, uint32_t read_leases,
+                    uint32_t read_errs, uint32_t writes,
+                    uint32_t write_leases, uint32_t write_errs) const {
+        EXPECT_EQ(reads, lease_file.getReads());
+        EXPECT_EQ(read_leases, lease_file.getReadLeases());
+        EXPECT_EQ(read_errs, lease_file.getReadErrs());
+        EXPECT_EQ(writes, lease_file.getWrites());
+        EXPECT_EQ(write_leases, lease_file.getWriteLeases());
+        EXPECT_EQ(write_errs, lease_file.getWriteErrs());
+    }
+
+    /// @brief Name of the test lease file.
+    std::string filename_;
+
+    /// @brief Object providing access to lease file IO.
+    LeaseFileIO io_;
+
+    /// @brief DUID 0 (corresponds to DUID0 const)
+    DuidPtr duid0_;
+
+    /// @brief DUID 1 (corresponds to DUID1 const)
+    DuidPtr duid1_;
+
+};
+
+BinaryLeaseFile6Test::BinaryLeaseFile6Test()
+    : filename_(absolutePath("leases6.bin")), io_(filename_) {
+    duid0_.reset(new DUID(DUID0, sizeof(DUID0)));
+    duid1_.reset(new DUID(DUID1, sizeof(DUID1)));
+}
+
+std::string
+BinaryLeaseFile6Test::absolutePath(const std::string& filename) {
+    std::ostringstream s;
+    s << DHCP_DATA_DIR << "/" << filename;
+    return (s.str());
+}
+
+// This test checks that the leases written to the file are read back.
+TEST_F(BinaryLeaseFile6Test, appendAndRead) {
+    BinaryLeaseFile6 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    {
+    SCOPED_TRACE("Check stats are empty");
+    checkStats(lf, 0, 0, 0, 0, 0, 0);
+    }
+
+    Lease6Ptr lease0 = createLease("2001:db8:1::1");
+    // The prefix lease without the HW address and hostname.
+    Lease6Ptr lease1(new Lease6(Lease::TYPE_PD, IOAddress("3000:1:1::"),
+                                duid1_, 8, 150, 300, 0, 0, 6, false, false,
+                                "", HWAddrPtr(), 64));
+    lease1->cltt_ = static_cast<time_t>(0x100000000LL);
+    // The temporary address lease with a zero lifetime.
+    Lease6Ptr lease2(new Lease6(Lease::TYPE_TA, IOAddress("2001:db8:2::10"),
+                                duid0_, 9, 0, 0, 0, 0, 8, false, true,
+                                "", HWAddrPtr(), 128));
+
+    ASSERT_NO_THROW(lf.append(*lease0));
+    ASSERT_NO_THROW(lf.append(*lease1));
+    ASSERT_NO_THROW(lf.append(*lease2));
+    {
+    SCOPED_TRACE("Write stats");
+    checkStats(lf, 0, 0, 0, 3, 3, 0);
+    }
+    lf.close();
+
+    ASSERT_TRUE(BinaryLeaseFile::isBinary(filename_));
+
+    ASSERT_NO_THROW(lf.open());
+    Lease6Ptr lease;
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease0);
+    ASSERT_TRUE(lease->hwaddr_);
+    EXPECT_TRUE(*lease->hwaddr_ == *lease0->hwaddr_);
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease1);
+    EXPECT_EQ(64, static_cast<int>(lease->prefixlen_));
+    EXPECT_FALSE(lease->hwaddr_);
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease2);
+
+    // There are no more leases.
+    ASSERT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    {
+    SCOPED_TRACE("Read stats");
+    checkStats(lf, 4, 3, 0, 0, 0, 0);
+    }
+}
+
+// This test checks that the record header partially written at the end
+// of the file is reported as an error and removed before appending a lease.
+TEST_F(BinaryLeaseFile6Test, truncatedHeader) {
+    BinaryLeaseFile6 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    Lease6Ptr lease0 = createLease("2001:db8:1::1");
+    ASSERT_NO_THROW(lf.append(*lease0));
+    lf.close();
+
+    // Append a part of the record header.
+    const int fd = open(filename_.c_str(), O_WRONLY | O_APPEND);
+    ASSERT_GE(fd, 0);
+    const uint8_t header[] = { 0, 10, 0 };
+    ASSERT_EQ(sizeof(header), write(fd, header, sizeof(header)));
+    close(fd);
+
+    ASSERT_NO_THROW(lf.open());
+    Lease6Ptr lease;
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_FALSE(lf.next(lease));
+    EXPECT_EQ("incomplete record header at the end of the file",
+              lf.getReadMsg());
+    ASSERT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+
+    Lease6Ptr lease1 = createLease("2001:db8:1::2");
+    ASSERT_NO_THROW(lf.append(*lease1));
+    lf.close();
+
+    ASSERT_NO_THROW(lf.open());
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease0);
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(*lease == *lease1);
+    ASSERT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+}
+
+// This test checks that the file holding DHCPv4 leases is not opened.
+TEST_F(BinaryLeaseFile6Test, invalidHeader) {
+    BinaryLeaseFile4 lf4(filename_);
+    ASSERT_NO_THROW(lf4.open());
+    lf4.close();
+
+    BinaryLeaseFile6 lf(filename_);
+    EXPECT_THROW(lf.open(), BinaryLeaseFileError);
+}
+
+} // end of anonymous namespace
@@ -18,16 +18,29 @@
 #include <dhcp/dhcp6.h>
 #include <dhcp/pkt4.h>
 #include <dhcpsrv/callout_handle_store.h>
+#include <util/threads/thread.h>
 #include "test_get_callout_handle.h"
 
+#include <boost/bind.hpp>
 #include <gtest/gtest.h>
 
 using namespace isc;
 using namespace isc::dhcp;
 using namespace isc::hooks;
+using namespace isc::util::thread;
 
 namespace {
 
+/// @brief Retrieves the callout handle for the packet.
+///
+/// It is used to retrieve the handle in a separate thread.
+///
+/// @param pktptr Pointer to the packet.
+/// @param [out] chptr Retrieved callout handle.
+void getHandleForPacket(const Pkt4Ptr& pktptr, CalloutHandlePtr* chptr) {
+    *chptr = getCalloutHandle(pktptr);
+}
+
 TEST(CalloutHandleStoreTest, StoreRetrieve) {
 
     // Create two DHCP4 packets during tests.  The constructor arguments are
@@ -119,4 +132,26 @@ TEST(CalloutHandleStoreTest, SeparateCompilationUnit) {
     EXPECT_TRUE(chptr_1 == chptr_2);
 }
 
+// Checks that the callout handles are stored separately for each thread.
+TEST(CalloutHandleStoreTest, SeparateThreads) {
+    Pkt4Ptr pktptr_1(new Pkt4(DHCPDISCOVER, 1234));
+    Pkt4Ptr pktptr_2(new Pkt4(DHCPDISCOVER, 5678));
+
+    CalloutHandlePtr chptr_1 = getCalloutHandle(pktptr_1);
+    ASSERT_TRUE(chptr_1);
+
+    // Another thread processes different packet, which must not replace
+    // the handle stored for this thread.
+    CalloutHandlePtr chptr_2;
+    Thread thread(boost::bind(&getHandleForPacket, pktptr_2, &chptr_2));
+    thread.wait();
+    ASSERT_TRUE(chptr_2);
+    EXPECT_TRUE(chptr_1 != chptr_2);
+
+    EXPECT_TRUE(chptr_1 == getCalloutHandle(pktptr_1));
+
+    // Clear the stored data.
+    getCalloutHandle(Pkt4Ptr());
+}
+
 } // Anonymous namespace
@@ -308,6 +308,72 @@ TEST(CfgOptionTest, encapsulate) {
 
 // This test verifies that single option can be retrieved from the configuration
 // using option code and option space.
+// This test verifies that the top-level options are packed and returned
+// with their wire format.
+TEST(CfgOptionTest, packOptions) {
+    CfgOption cfg;
+
+    // Create a top-level option encapsulating "foo" option space and
+    // a sub-option of this space.
+    OptionUint16Ptr option(new OptionUint16(Option::V6, 1000, 1234));
+    option->setEncapsulatedSpace("foo");
+    ASSERT_NO_THROW(cfg.add(option, false, DHCP6_OPTION_SPACE));
+    ASSERT_NO_THROW(cfg.add(OptionPtr(new OptionUint8(Option::V6, 1, 0x01)),
+                            false, "foo"));
+    ASSERT_NO_THROW(cfg.add(OptionPtr(new Option(Option::V6, 2000,
+                                                 OptionBuffer(1, 0x02))),
+                            false, DHCP6_OPTION_SPACE));
+    ASSERT_NO_THROW(cfg.encapsulate());
+
+    // The options are returned without the wire format until they are
+    // packed.
+    PackedOption packed = cfg.getPackedOption(DHCP6_OPTION_SPACE, 1000);
+    EXPECT_EQ(1000, packed.code_);
+    EXPECT_TRUE(packed.option_ == option);
+    EXPECT_FALSE(packed.wire_);
+
+    ASSERT_NO_THROW(cfg.packOptions());
+
+    // The wire format includes the sub-option.
+    packed = cfg.getPackedOption(DHCP6_OPTION_SPACE, 1000);
+    EXPECT_EQ(1000, packed.code_);
+    EXPECT_TRUE(packed.option_ == option);
+    ASSERT_TRUE(packed.wire_);
+    const uint8_t expected[] = {
+        0x03, 0xE8, 0x00, 0x07,  // option 1000, length 7
+        0x04, 0xD2,              // value 1234
+        0x00, 0x01, 0x00, 0x01,  // sub-option 1, length 1
+        0x01                     // value 1
+    };
+    EXPECT_TRUE(OptionBuffer(expected, expected + sizeof(expected)) ==
+                *packed.wire_);
+
+    packed = cfg.getPackedOption(DHCP6_OPTION_SPACE, 2000);
+    ASSERT_TRUE(packed.option_);
+    ASSERT_TRUE(packed.wire_);
+    EXPECT_EQ(5, packed.wire_->size());
+
+    // Options which haven't been configured are not returned.
+    packed = cfg.getPackedOption(DHCP6_OPTION_SPACE, 1500);
+    EXPECT_EQ(1500, packed.code_);
+    EXPECT_FALSE(packed.option_);
+    EXPECT_FALSE(packed.wire_);
+
+    // Options from other spaces are returned without the wire format.
+    packed = cfg.getPackedOption("foo", 1);
+    ASSERT_TRUE(packed.option_);
+    EXPECT_FALSE(packed.wire_);
+
+    // Adding an option discards the packed options.
+    ASSERT_NO_THROW(cfg.add(OptionPtr(new Option(Option::V6, 3000,
+                                                 OptionBuffer(1, 0x03))),
+                            false, DHCP6_OPTION_SPACE));
+    packed = cfg.getPackedOption(DHCP6_OPTION_SPACE, 3000);
+    ASSERT_TRUE(packed.option_);
+    EXPECT_FALSE(packed.wire_);
+    EXPECT_FALSE(cfg.getPackedOption(DHCP6_OPTION_SPACE, 1000).wire_);
+}
+
 TEST(CfgOption, get) {
     CfgOption cfg;
 
@@ -16,10 +16,13 @@
 #include <dhcp/classify.h>
 #include <dhcp/tests/iface_mgr_test_config.h>
 #include <dhcpsrv/cfg_subnets4.h>
+#include <dhcpsrv/lease_mgr_factory.h>
+#include <dhcpsrv/stats_mgr.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/subnet_id.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <gtest/gtest.h>
+#include <sstream>
 
 using namespace isc;
 using namespace isc::asiolink;
@@ -289,5 +292,116 @@ TEST(CfgSubnets4, duplication) {
     EXPECT_THROW(cfg.add(subnet3), isc::dhcp::DuplicateSubnetID);
 }
 
+// This test verifies that the subnet selection using the index returns the
+// same subnets as the selection without the index.
+TEST(CfgSubnets4Test, selectSubnetIndex) {
+    CfgSubnets4 cfg;
+    CfgSubnets4 cfg_indexed;
+
+    // Create many subnets, some of them overlapping, with relay addresses
+    // and client classes.
+    SubnetID id = 1;
+    for (int i = 0; i < 256; ++i) {
+        std::ostringstream prefix;
+        prefix << "10.0." << i << ".0";
+        Subnet4Ptr subnet(new Subnet4(IOAddress(prefix.str()), 24, 1, 2, 3,
+                                      id++));
+        if (i % 3 == 0) {
+            std::ostringstream relay;
+            relay << "192.0.2." << i / 3;
+            subnet->setRelayInfo(IOAddress(relay.str()));
+        }
+        if (i % 5 == 0) {
+            subnet->allowClientClass("foo");
+        }
+        cfg.add(subnet);
+        cfg_indexed.add(subnet);
+    }
+    Subnet4Ptr subnet(new Subnet4(IOAddress("10.0.0.0"), 16, 1, 2, 3, id++));
+    subnet->setRelayInfo(IOAddress("192.0.2.1"));
+    cfg.add(subnet);
+    cfg_indexed.add(subnet);
+
+    cfg_indexed.buildIndex();
+
+    ClientClasses classes[2];
+    classes[1].insert("foo");
+    for (int c = 0; c < 2; ++c) {
+        for (int i = 0; i < 256; i += 7) {
+            SubnetSelector selector;
+            selector.client_classes_ = classes[c];
+            std::ostringstream addr;
+            addr << "10.0." << i << ".10";
+            selector.giaddr_ = IOAddress(addr.str());
+            EXPECT_EQ(cfg.selectSubnet(selector),
+                      cfg_indexed.selectSubnet(selector)) << addr.str();
+
+            std::ostringstream relay;
+            relay << "192.0.2." << i % 100;
+            selector.giaddr_ = IOAddress(relay.str());
+            EXPECT_EQ(cfg.selectSubnet(selector),
+                      cfg_indexed.selectSubnet(selector)) << relay.str();
+        }
+    }
+
+    // The overlapping subnet is selected for the address which doesn't
+    // belong to the more specific subnet supporting client's classes.
+    EXPECT_EQ(subnet, cfg_indexed.selectSubnet(IOAddress("10.0.1.1"),
+                                               classes[0]));
+    EXPECT_EQ(subnet, cfg_indexed.selectSubnet(IOAddress("10.0.0.1"),
+                                               classes[0]));
+    EXPECT_FALSE(cfg_indexed.selectSubnet(IOAddress("10.1.0.1")));
+
+    // Adding a subnet clears the index, so the new subnet is selected.
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("10.1.0.0"), 16, 1, 2, 3, id++));
+    cfg_indexed.add(subnet2);
+    EXPECT_EQ(subnet2, cfg_indexed.selectSubnet(IOAddress("10.1.0.1")));
+    cfg_indexed.buildIndex();
+    EXPECT_EQ(subnet2, cfg_indexed.selectSubnet(IOAddress("10.1.0.1")));
+}
+
+// This test verifies that the statistics of the subnets are initialized
+// from the pools and the lease database, and that they are removed.
+TEST(CfgSubnets4Test, statistics) {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    stats_mgr.removeAll();
+
+    CfgSubnets4 cfg;
+    Subnet4Ptr subnet1(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3, 1));
+    subnet1->addPool(Pool4Ptr(new Pool4(IOAddress("192.0.2.10"),
+                                        IOAddress("192.0.2.19"))));
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("192.0.3.0"), 24, 1, 2, 3, 2));
+    cfg.add(subnet1);
+    cfg.add(subnet2);
+
+    LeaseMgrFactory::create("type=memfile universe=4 persist=false");
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.10"), HWAddrPtr(), 0, 0,
+                               100, 50, 80, time(NULL), 1));
+    ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+
+    cfg.updateStatistics();
+    EXPECT_EQ(10, stats_mgr.getCounter("subnet[1].total-addresses")->
+              getValue());
+    EXPECT_EQ(1, stats_mgr.getCounter("subnet[1].assigned-addresses")->
+              getValue());
+    EXPECT_EQ(0, stats_mgr.getCounter("subnet[2].total-addresses")->
+              getValue());
+    EXPECT_EQ(0, stats_mgr.getCounter("subnet[2].assigned-addresses")->
+              getValue());
+    EXPECT_EQ(4, stats_mgr.count());
+
+    // The "assigned-addresses" statistics are held by the configuration.
+    StatsCounterPtr assigned = cfg.getAssignedAddresses(1);
+    ASSERT_TRUE(assigned);
+    EXPECT_TRUE(assigned ==
+                stats_mgr.getCounter("subnet[1].assigned-addresses"));
+    EXPECT_TRUE(cfg.getAssignedAddresses(2));
+    EXPECT_FALSE(cfg.getAssignedAddresses(3));
+
+    cfg.removeStatistics();
+    EXPECT_EQ(0, stats_mgr.count());
+
+    LeaseMgrFactory::destroy();
+}
 
 } // end of anonymous namespace
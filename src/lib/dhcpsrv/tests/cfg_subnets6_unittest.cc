@@ -21,6 +21,7 @@
 #include <dhcpsrv/subnet_id.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <gtest/gtest.h>
+#include <sstream>
 #include <string>
 
 using namespace isc;
@@ -350,4 +351,67 @@ TEST(CfgSubnets6, duplication) {
     EXPECT_THROW(cfg.add(subnet3), isc::dhcp::DuplicateSubnetID);
 }
 
+// This test verifies that the subnet selection using the index returns the
+// same subnets as the selection without the index.
+TEST(CfgSubnets6Test, selectSubnetIndex) {
+    CfgSubnets6 cfg;
+    CfgSubnets6 cfg_indexed;
+
+    for (int i = 0; i < 64; ++i) {
+        std::ostringstream prefix;
+        prefix << "2001:db8:" << std::hex << i + 1 << "::";
+        Subnet6Ptr subnet(new Subnet6(IOAddress(prefix.str()), 64, 1, 2, 3, 4,
+                                      i + 1));
+        if (i % 3 == 0) {
+            std::ostringstream relay;
+            relay << "2001:db8:ff::" << std::hex << i / 3;
+            subnet->setRelayInfo(IOAddress(relay.str()));
+        }
+        if (i % 4 == 0) {
+            std::ostringstream iface;
+            iface << "eth" << i / 8;
+            subnet->setIface(iface.str());
+            subnet->setInterfaceId(generateInterfaceId(iface.str()));
+        }
+        if (i % 5 == 0) {
+            subnet->allowClientClass("foo");
+        }
+        cfg.add(subnet);
+        cfg_indexed.add(subnet);
+    }
+    cfg_indexed.buildIndex();
+
+    ClientClasses classes[2];
+    classes[1].insert("foo");
+    for (int c = 0; c < 2; ++c) {
+        for (int i = 0; i < 64; i += 3) {
+            SubnetSelector selector;
+            selector.client_classes_ = classes[c];
+
+            std::ostringstream iface;
+            iface << "eth" << i % 9;
+            selector.iface_name_ = iface.str();
+            std::ostringstream addr;
+            addr << "2001:db8:" << std::hex << i + 1 << "::10";
+            selector.remote_address_ = IOAddress(addr.str());
+            EXPECT_EQ(cfg.selectSubnet(selector),
+                      cfg_indexed.selectSubnet(selector)) << iface.str();
+
+            selector.iface_name_.clear();
+            EXPECT_EQ(cfg.selectSubnet(selector),
+                      cfg_indexed.selectSubnet(selector)) << addr.str();
+
+            std::ostringstream relay;
+            relay << "2001:db8:ff::" << std::hex << i % 30;
+            selector.first_relay_linkaddr_ = IOAddress(relay.str());
+            EXPECT_EQ(cfg.selectSubnet(selector),
+                      cfg_indexed.selectSubnet(selector)) << relay.str();
+
+            selector.interface_id_ = generateInterfaceId(iface.str());
+            EXPECT_EQ(cfg.selectSubnet(selector),
+                      cfg_indexed.selectSubnet(selector)) << iface.str();
+        }
+    }
+}
+
 } // end of anonymous namespace
@@ -0,0 +1,327 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcp/hwaddr.h>
+#include <dhcpsrv/compact_lease_storage.h>
+#include <exceptions/exceptions.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+
+namespace {
+
+/// @brief Creates the DHCPv4 lease.
+///
+/// @param address Leased address.
+/// @param hwaddr Last byte of the HW address.
+/// @param client_id Last byte of the client identifier or 0 if the lease
+/// has no client identifier.
+/// @param subnet_id Subnet identifier.
+Lease4Ptr
+createLease(const std::string& address, const uint8_t hwaddr,
+            const uint8_t client_id, const SubnetID subnet_id = 1) {
+    std::vector<uint8_t> hwaddr_vec(6, 1);
+    hwaddr_vec[5] = hwaddr;
+    HWAddrPtr hwaddr_ptr(new HWAddr(hwaddr_vec, HTYPE_ETHER));
+    std::vector<uint8_t> client_id_vec(7, 2);
+    client_id_vec[6] = client_id;
+    Lease4Ptr lease(new Lease4(IOAddress(address), hwaddr_ptr,
+                               client_id > 0 ? &client_id_vec[0] : NULL,
+                               client_id > 0 ? client_id_vec.size() : 0,
+                               200, 50, 100, 1000, subnet_id));
+    return (lease);
+}
+
+// This test verifies that the string pool holds each string once and
+// reuses the identifiers of the removed strings.
+TEST(StringPoolTest, addRelease) {
+    StringPool pool;
+    EXPECT_EQ(0, pool.add(""));
+    EXPECT_EQ("", pool.get(0));
+
+    const uint32_t foo = pool.add("foo");
+    const uint32_t bar = pool.add("bar");
+    EXPECT_NE(0, foo);
+    EXPECT_NE(foo, bar);
+    EXPECT_EQ(foo, pool.add("foo"));
+    EXPECT_EQ(2, pool.size());
+    EXPECT_EQ("foo", pool.get(foo));
+    EXPECT_EQ("bar", pool.get(bar));
+
+    // The string is removed when the last reference is removed.
+    pool.release(foo);
+    EXPECT_EQ("foo", pool.get(foo));
+    pool.release(foo);
+    EXPECT_EQ(1, pool.size());
+    EXPECT_EQ("", pool.get(foo));
+
+    // The identifier is reused.
+    EXPECT_EQ(foo, pool.add("baz"));
+    EXPECT_EQ("baz", pool.get(foo));
+}
+
+// This test verifies that the leases are stored and returned with all
+// their attributes.
+TEST(CompactLease4StorageTest, insertFind) {
+    CompactLease4Storage storage;
+    EXPECT_TRUE(storage.empty());
+
+    Lease4Ptr lease = createLease("192.0.2.1", 1, 1);
+    lease->hostname_ = "host.example.com";
+    lease->comments_ = "reserved";
+    lease->fixed_ = true;
+    lease->fqdn_fwd_ = true;
+    lease->ext_ = 5;
+    lease->hwaddr_->source_ = HWAddr::HWADDR_SOURCE_RAW;
+    ASSERT_TRUE(storage.insert(lease));
+
+    // The lease without HW address and client identifier.
+    Lease4Ptr empty_lease = createLease("192.0.2.2", 2, 0);
+    empty_lease->hwaddr_.reset();
+    ASSERT_TRUE(storage.insert(empty_lease));
+
+    // The lease with a client identifier which doesn't fit in the record.
+    Lease4Ptr long_lease = createLease("192.0.2.3", 3, 3);
+    std::vector<uint8_t> long_client_id(64, 4);
+    long_lease->client_id_.reset(new ClientId(long_client_id));
+    ASSERT_TRUE(storage.insert(long_lease));
+
+    // The lease for the same address is not stored.
+    EXPECT_FALSE(storage.insert(createLease("192.0.2.1", 4, 4)));
+    EXPECT_EQ(3, storage.size());
+
+    CompactLease4Storage::const_iterator it = storage.find(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(it != storage.end());
+    Lease4Ptr stored = *it;
+    EXPECT_TRUE(*stored == *lease);
+    EXPECT_EQ(5, stored->ext_);
+    EXPECT_EQ(HWAddr::HWADDR_SOURCE_RAW, stored->hwaddr_->source_);
+
+    it = storage.find(IOAddress("192.0.2.2"));
+    ASSERT_TRUE(it != storage.end());
+    stored = *it;
+    EXPECT_FALSE(stored->hwaddr_);
+    EXPECT_FALSE(stored->client_id_);
+    EXPECT_TRUE(*stored == *empty_lease);
+
+    it = storage.find(IOAddress("192.0.2.3"));
+    ASSERT_TRUE(it != storage.end());
+    EXPECT_TRUE(**it == *long_lease);
+
+    // The returned leases are copies.
+    EXPECT_NE(lease.get(), (*storage.find(IOAddress("192.0.2.1"))).get());
+
+    EXPECT_TRUE(storage.find(IOAddress("192.0.2.4")) == storage.end());
+    EXPECT_TRUE(storage.find(IOAddress("2001:db8::1")) == storage.end());
+    EXPECT_THROW(storage.insert(Lease4Ptr(new Lease4(IOAddress("2001:db8::1"),
+                                                     HWAddrPtr(), 0, 0, 200,
+                                                     50, 100, 1000, 1))),
+                 BadValue);
+}
+
+// This test verifies that the leases are iterated in the order of their
+// addresses and that the records of the removed leases are reused.
+TEST(CompactLease4StorageTest, iterateErase) {
+    CompactLease4Storage storage;
+    ASSERT_TRUE(storage.insert(createLease("192.0.2.3", 3, 3)));
+    ASSERT_TRUE(storage.insert(createLease("192.0.2.1", 1, 1)));
+    ASSERT_TRUE(storage.insert(createLease("192.0.2.2", 2, 2)));
+
+    std::vector<std::string> addresses;
+    for (CompactLease4Storage::const_iterator it = storage.begin();
+         it != storage.end(); ++it) {
+        addresses.push_back((*it)->addr_.toText());
+    }
+    ASSERT_EQ(3, addresses.size());
+    EXPECT_EQ("192.0.2.1", addresses[0]);
+    EXPECT_EQ("192.0.2.2", addresses[1]);
+    EXPECT_EQ("192.0.2.3", addresses[2]);
+
+    storage.erase(storage.find(IOAddress("192.0.2.2")));
+    EXPECT_EQ(2, storage.size());
+    EXPECT_TRUE(storage.find(IOAddress("192.0.2.2")) == storage.end());
+    EXPECT_FALSE(storage.getLease(ClientId(createLease("192.0.2.2", 2, 2)->
+                                           client_id_->getClientId()), 1));
+
+    // Fill more than one slab, then remove and add the leases again. The
+    // removed records are reused.
+    storage.clear();
+    EXPECT_TRUE(storage.empty());
+    const size_t count = CompactLease4Storage::SLAB_SIZE + 1;
+    for (uint32_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(storage.insert(Lease4Ptr(new Lease4(IOAddress(0x0a000000 + i),
+                                                        HWAddrPtr(), 0, 0, 200,
+                                                        50, 100, 1000, 1))));
+    }
+    const size_t records_size = storage.getRecordsSize();
+    EXPECT_GT(records_size, 0);
+    storage.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(storage.insert(Lease4Ptr(new Lease4(IOAddress(0x0b000000 + i),
+                                                        HWAddrPtr(), 0, 0, 200,
+                                                        50, 100, 1000, 1))));
+    }
+    EXPECT_EQ(count, storage.size());
+    EXPECT_EQ(records_size, storage.getRecordsSize());
+}
+
+// This test verifies that the replaced lease can be found by its new
+// HW address and client identifier.
+TEST(CompactLease4StorageTest, replace) {
+    CompactLease4Storage storage;
+    Lease4Ptr lease = createLease("192.0.2.1", 1, 1);
+    lease->hostname_ = "old.example.com";
+    ASSERT_TRUE(storage.insert(lease));
+
+    Lease4Ptr new_lease = createLease("192.0.2.1", 2, 2, 2);
+    new_lease->hostname_ = "new.example.com";
+    storage.replace(storage.find(IOAddress("192.0.2.1")), new_lease);
+    EXPECT_EQ(1, storage.size());
+    EXPECT_EQ(1, storage.getStringsCount());
+
+    EXPECT_FALSE(storage.getLease(*lease->hwaddr_, 1));
+    Lease4Ptr stored = storage.getLease(*new_lease->hwaddr_, 2);
+    ASSERT_TRUE(stored);
+    EXPECT_TRUE(*stored == *new_lease);
+    EXPECT_TRUE(storage.getLease(*new_lease->client_id_, 2));
+    EXPECT_FALSE(storage.getLease(*lease->client_id_, 1));
+}
+
+// This test verifies that the leases are found by the HW address, client
+// identifier and subnet identifier.
+TEST(CompactLease4StorageTest, getLeases) {
+    CompactLease4Storage storage;
+    ASSERT_TRUE(storage.insert(createLease("192.0.2.1", 1, 1, 1)));
+    ASSERT_TRUE(storage.insert(createLease("192.0.3.1", 1, 1, 2)));
+    ASSERT_TRUE(storage.insert(createLease("192.0.2.2", 2, 0, 1)));
+
+    Lease4Ptr lease = createLease("192.0.0.1", 1, 1);
+    Lease4Ptr stored = storage.getLease(*lease->hwaddr_, 2);
+    ASSERT_TRUE(stored);
+    EXPECT_EQ("192.0.3.1", stored->addr_.toText());
+
+    stored = storage.getLease(*lease->client_id_, 1);
+    ASSERT_TRUE(stored);
+    EXPECT_EQ("192.0.2.1", stored->addr_.toText());
+
+    stored = storage.getLease(*lease->client_id_, *lease->hwaddr_, 2);
+    ASSERT_TRUE(stored);
+    EXPECT_EQ("192.0.3.1", stored->addr_.toText());
+    EXPECT_FALSE(storage.getLease(*lease->client_id_, *lease->hwaddr_, 3));
+
+    Lease4Collection leases;
+    storage.getLeases(*lease->hwaddr_, leases);
+    EXPECT_EQ(2, leases.size());
+
+    // The HW type must match too.
+    leases.clear();
+    HWAddr other_type(lease->hwaddr_->hwaddr_, HTYPE_FDDI);
+    storage.getLeases(other_type, leases);
+    EXPECT_TRUE(leases.empty());
+
+    storage.getLeases(*lease->client_id_, leases);
+    EXPECT_EQ(2, leases.size());
+
+    leases.clear();
+    storage.getLeases(1, leases);
+    ASSERT_EQ(2, leases.size());
+    EXPECT_EQ("192.0.2.1", leases[0]->addr_.toText());
+    EXPECT_EQ("192.0.2.2", leases[1]->addr_.toText());
+
+    // Count the leases in the subnets 1 and 3. The subnet 2 is not counted.
+    std::map<SubnetID, uint64_t> counts;
+    counts[1] = 10;
+    counts[3] = 10;
+    storage.countLeases(counts);
+    ASSERT_EQ(2, counts.size());
+    EXPECT_EQ(2, counts[1]);
+    EXPECT_EQ(0, counts[3]);
+}
+
+// This test verifies that the expired leases are returned in the order
+// of their expiration time.
+TEST(CompactLease4StorageTest, getExpiredLeases) {
+    CompactLease4Storage storage;
+    for (int i = 0; i < 5; ++i) {
+        Lease4Ptr lease = createLease("192.0.2.1", 1, 1);
+        lease->addr_ = IOAddress(0xc0000201 + i);
+        // The lease with the highest address expires first.
+        lease->cltt_ = 1000 - i * 10;
+        ASSERT_TRUE(storage.insert(lease));
+    }
+
+    Lease4Collection leases;
+    // The leases expire at 1200, 1190 ... 1160.
+    storage.getExpiredLeases(1180, 0, leases);
+    ASSERT_EQ(2, leases.size());
+    EXPECT_EQ("192.0.2.5", leases[0]->addr_.toText());
+    EXPECT_EQ("192.0.2.4", leases[1]->addr_.toText());
+
+    leases.clear();
+    storage.getExpiredLeases(2000, 3, leases);
+    EXPECT_EQ(3, leases.size());
+}
+
+// This test verifies that the leases are found by the client identifiers
+// held outside of the records and by the identifiers with the same hash.
+TEST(CompactLease4StorageTest, getLeaseHashed) {
+    CompactLease4Storage storage;
+    const size_t long_id_len = CompactLease4Storage::INLINE_CLIENT_ID_LEN + 10;
+    std::vector<uint8_t> long_id(long_id_len, 0x42);
+    Lease4Ptr lease = createLease("192.0.2.1", 1, 0);
+    lease->client_id_.reset(new ClientId(long_id));
+    ASSERT_TRUE(storage.insert(lease));
+
+    Lease4Ptr stored = storage.getLease(ClientId(long_id), 1);
+    ASSERT_TRUE(stored);
+    EXPECT_EQ("192.0.2.1", stored->addr_.toText());
+    ASSERT_TRUE(stored->client_id_);
+    EXPECT_TRUE(*stored->client_id_ == ClientId(long_id));
+
+    // The client identifier differing in the last byte is not found.
+    long_id.back() = 0x43;
+    EXPECT_FALSE(storage.getLease(ClientId(long_id), 1));
+
+    // Many leases in the same subnet, stored in the reused records, are
+    // found by their identifiers.
+    storage.erase(storage.find(IOAddress("192.0.2.1")));
+    for (uint8_t i = 2; i < 250; ++i) {
+        ASSERT_TRUE(storage.insert(createLease("192.0.2.1", i, i)));
+        storage.erase(storage.find(IOAddress("192.0.2.1")));
+        Lease4Ptr other = createLease("192.0.2.1", i, i);
+        other->addr_ = IOAddress(0xc0000300 + i);
+        ASSERT_TRUE(storage.insert(other));
+    }
+    for (uint8_t i = 2; i < 250; ++i) {
+        Lease4Ptr other = createLease("192.0.2.1", i, i);
+        stored = storage.getLease(*other->hwaddr_, 1);
+        ASSERT_TRUE(stored);
+        EXPECT_EQ(0xc0000300 + i, static_cast<uint32_t>(stored->addr_));
+        stored = storage.getLease(*other->client_id_, *other->hwaddr_, 1);
+        ASSERT_TRUE(stored);
+        EXPECT_EQ(0xc0000300 + i, static_cast<uint32_t>(stored->addr_));
+    }
+}
+
+} // end of anonymous namespace
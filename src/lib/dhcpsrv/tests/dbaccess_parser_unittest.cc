@@ -93,8 +93,9 @@ public:
             }
 
             // Add the keyword and value - make sure that they are quoted.
-            // The parameters which are not quoted are persist and
-            // lfc-interval as they are boolean and integer respectively.
+            // The parameters which are not quoted are persist, write-behind,
+            // lfc-incremental, lfc-interval, connections, sync-interval and
+            // sync-leases as they are boolean and integer.
             result += quote + keyval[i] + quote + colon + space;
             if (!quoteValue(std::string(keyval[i]))) {
                 result += keyval[i + 1];
@@ -184,7 +185,11 @@ private:
     ///
     /// @return true if the value of the parameter should be quoted.
      bool quoteValue(const std::string& parameter) const {
-         return ((parameter != "persist") && (parameter != "lfc-interval"));
+         return ((parameter != "persist") && (parameter != "lfc-interval") &&
+                 (parameter != "write-behind") && (parameter != "connections") &&
+                 (parameter != "lfc-incremental") &&
+                 (parameter != "sync-interval") &&
+                 (parameter != "sync-leases"));
     }
 
 };
@@ -320,6 +325,24 @@ TEST_F(DbAccessParserTest, validLFCInterval) {
                       config, Option::V6);
 }
 
+// This test checks that the parser accepts the lfc-incremental parameter.
+TEST_F(DbAccessParserTest, lfcIncremental) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases4.csv",
+                            "lfc-interval", "3600",
+                            "lfc-incremental", "true",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser("lease-database", ParserContext(Option::V4));
+    ASSERT_NO_THROW(parser.build(json_elements));
+    checkAccessString("Valid LFC incremental", parser.getDbAccessParameters(),
+                      config, Option::V4);
+}
+
 // This test checks that the parser rejects the negative value of the
 // lfc-interval parameter.
 TEST_F(DbAccessParserTest, negativeLFCInterval) {
@@ -352,6 +375,69 @@ TEST_F(DbAccessParserTest, largeLFCInterval) {
     EXPECT_THROW(parser.build(json_elements), BadValue);
 }
 
+// This test checks that the parser accepts the number of connections
+// and rejects the value which is not positive.
+TEST_F(DbAccessParserTest, connections) {
+    const char* config[] = {"type",        "postgresql",
+                            "name",        "keatest",
+                            "connections", "4",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser("lease-database", ParserContext(Option::V4));
+    EXPECT_NO_THROW(parser.build(json_elements));
+    checkAccessString("Valid connections", parser.getDbAccessParameters(),
+                      config);
+
+    const char* zero_config[] = {"type",        "postgresql",
+                                 "name",        "keatest",
+                                 "connections", "0",
+                                 NULL};
+    json_elements = Element::fromJSON(toJson(zero_config));
+    TestDbAccessParser zero_parser("lease-database",
+                                   ParserContext(Option::V4));
+    EXPECT_THROW(zero_parser.build(json_elements), BadValue);
+}
+
+// This test checks that the parser accepts the lease file sync parameters
+// and rejects the out of range values.
+TEST_F(DbAccessParserTest, syncPolicy) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases4.csv",
+                            "sync-policy", "group",
+                            "sync-interval", "5",
+                            "sync-leases", "128",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser("lease-database", ParserContext(Option::V4));
+    ASSERT_NO_THROW(parser.build(json_elements));
+    checkAccessString("Valid sync policy", parser.getDbAccessParameters(),
+                      config, Option::V4);
+
+    const char* interval_config[] = {"type", "memfile",
+                                     "sync-interval", "-1",
+                                     NULL};
+    json_elements = Element::fromJSON(toJson(interval_config));
+    TestDbAccessParser interval_parser("lease-database",
+                                       ParserContext(Option::V4));
+    EXPECT_THROW(interval_parser.build(json_elements), BadValue);
+
+    const char* leases_config[] = {"type", "memfile",
+                                   "sync-leases", "0",
+                                   NULL};
+    json_elements = Element::fromJSON(toJson(leases_config));
+    TestDbAccessParser leases_parser("lease-database",
+                                     ParserContext(Option::V4));
+    EXPECT_THROW(leases_parser.build(json_elements), BadValue);
+}
+
 // Check that the parser works with a valid MySQL configuration
 TEST_F(DbAccessParserTest, validTypeMysql) {
     const char* config[] = {"type",     "mysql",
@@ -370,6 +456,26 @@ TEST_F(DbAccessParserTest, validTypeMysql) {
     checkAccessString("Valid mysql", parser.getDbAccessParameters(), config);
 }
 
+// Check that the parser accepts the write-behind mode for MySQL.
+TEST_F(DbAccessParserTest, writeBehindMysql) {
+    const char* config[] = {"type",         "mysql",
+                            "host",         "erewhon",
+                            "user",         "kea",
+                            "password",     "keapassword",
+                            "name",         "keatest",
+                            "write-behind", "true",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser("lease-database", ParserContext(Option::V4));
+    EXPECT_NO_THROW(parser.build(json_elements));
+    checkAccessString("Valid write-behind", parser.getDbAccessParameters(),
+                      config);
+}
+
 // A missing 'type' keyword should cause an exception to be thrown.
 TEST_F(DbAccessParserTest, missingTypeKeyword) {
     const char* config[] = {"host",     "erewhon",
@@ -1220,6 +1220,142 @@ GenericLeaseMgrTest::testGetLease4ClientIdSubnetId() {
     EXPECT_FALSE(returned);
 }
 
+void
+GenericLeaseMgrTest::testGetClientLeases4() {
+    // Get the leases to be used for the test and add to the database
+    vector<Lease4Ptr> leases = createLeases4();
+    for (int i = 0; i < leases.size(); ++i) {
+        EXPECT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Both identifiers of lease 1 should return lease 1.
+    Lease4Ptr hwaddr_lease;
+    Lease4Ptr clientid_lease;
+    lmptr_->getClientLeases4(*leases[1]->hwaddr_, *leases[1]->client_id_,
+                             leases[1]->subnet_id_, hwaddr_lease,
+                             clientid_lease);
+    ASSERT_TRUE(hwaddr_lease);
+    detailCompareLease(leases[1], hwaddr_lease);
+    ASSERT_TRUE(clientid_lease);
+    detailCompareLease(leases[1], clientid_lease);
+
+    // The HW address of lease 1 and the client identifier which is not
+    // in use should only return the lease by the HW address.
+    const uint8_t invalid_data[] = {0, 0, 0};
+    ClientId invalid(invalid_data, sizeof(invalid_data));
+    lmptr_->getClientLeases4(*leases[1]->hwaddr_, invalid,
+                             leases[1]->subnet_id_, hwaddr_lease,
+                             clientid_lease);
+    ASSERT_TRUE(hwaddr_lease);
+    detailCompareLease(leases[1], hwaddr_lease);
+    EXPECT_FALSE(clientid_lease);
+
+    // The unknown HW address and the client identifier of lease 1 should
+    // only return the lease by the client identifier.
+    vector<uint8_t> invalid_hwaddr(15, 0x77);
+    lmptr_->getClientLeases4(HWAddr(invalid_hwaddr, HTYPE_ETHER),
+                             *leases[1]->client_id_, leases[1]->subnet_id_,
+                             hwaddr_lease, clientid_lease);
+    EXPECT_FALSE(hwaddr_lease);
+    ASSERT_TRUE(clientid_lease);
+    detailCompareLease(leases[1], clientid_lease);
+
+    // Nothing should be returned for the wrong subnet ID.
+    lmptr_->getClientLeases4(*leases[1]->hwaddr_, *leases[1]->client_id_,
+                             leases[1]->subnet_id_ + 1, hwaddr_lease,
+                             clientid_lease);
+    EXPECT_FALSE(hwaddr_lease);
+    EXPECT_FALSE(clientid_lease);
+}
+
+void
+GenericLeaseMgrTest::testGetClientLeases4MultipleRecords() {
+    // Get the leases to be used for the test and add to the database
+    vector<Lease4Ptr> leases = createLeases4();
+    for (int i = 0; i < leases.size(); ++i) {
+        EXPECT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Add a second lease with the same HW address and subnet as lease 1
+    // and check that the lookups throw the "multiple records" exception,
+    // as getLease4() does.
+    EXPECT_TRUE(lmptr_->deleteLease(leases[2]->addr_));
+    leases[1]->addr_ = leases[2]->addr_;
+    EXPECT_TRUE(lmptr_->addLease(leases[1]));
+
+    const uint8_t invalid_data[] = {0, 0, 0};
+    ClientId invalid(invalid_data, sizeof(invalid_data));
+    Lease4Ptr hwaddr_lease;
+    Lease4Ptr clientid_lease;
+    EXPECT_THROW(lmptr_->getClientLeases4(*leases[1]->hwaddr_, invalid,
+                                          leases[1]->subnet_id_, hwaddr_lease,
+                                          clientid_lease),
+                 isc::dhcp::MultipleRecords);
+}
+
+void
+GenericLeaseMgrTest::testGetLeases4SubnetId() {
+    // Get the leases to be used for the test and add to the database
+    vector<Lease4Ptr> leases = createLeases4();
+    for (int i = 0; i < leases.size(); ++i) {
+        EXPECT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // All leases belonging to the subnet of lease 1 should be returned.
+    Lease4Collection returned = lmptr_->getLeases4(leases[1]->subnet_id_);
+    size_t expected = 0;
+    for (int i = 0; i < leases.size(); ++i) {
+        if (leases[i]->subnet_id_ != leases[1]->subnet_id_) {
+            continue;
+        }
+        ++expected;
+        bool found = false;
+        for (Lease4Collection::const_iterator lease = returned.begin();
+             lease != returned.end(); ++lease) {
+            if ((*lease)->addr_ == leases[i]->addr_) {
+                detailCompareLease(leases[i], *lease);
+                found = true;
+            }
+        }
+        EXPECT_TRUE(found) << "lease " << leases[i]->addr_.toText()
+                           << " not returned";
+    }
+    EXPECT_EQ(expected, returned.size());
+
+    // There are no leases in the unknown subnet.
+    SubnetID unknown_subnet_id = 12345;
+    returned = lmptr_->getLeases4(unknown_subnet_id);
+    EXPECT_TRUE(returned.empty());
+}
+
+void
+GenericLeaseMgrTest::testCountLeases4() {
+    // Get the leases to be used for the test and add to the database
+    vector<Lease4Ptr> leases = createLeases4();
+    for (int i = 0; i < leases.size(); ++i) {
+        EXPECT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Count the leases in the subnet of lease 1, the subnet of lease 0
+    // and the unknown subnet. The initial values should be overwritten.
+    LeaseMgr::LeaseCounts counts;
+    counts[leases[0]->subnet_id_] = 100;
+    counts[leases[1]->subnet_id_] = 100;
+    counts[12345] = 100;
+    lmptr_->countLeases4(counts);
+    ASSERT_EQ(3, counts.size());
+
+    uint64_t expected = 0;
+    for (int i = 0; i < leases.size(); ++i) {
+        if (leases[i]->subnet_id_ == leases[1]->subnet_id_) {
+            ++expected;
+        }
+    }
+    EXPECT_EQ(1, counts[leases[0]->subnet_id_]);
+    EXPECT_EQ(expected, counts[leases[1]->subnet_id_]);
+    EXPECT_EQ(0, counts[12345]);
+}
+
 void
 GenericLeaseMgrTest::testGetLeases6DuidIaid() {
     // Get the leases to be used for the test.
@@ -1650,6 +1786,128 @@ GenericLeaseMgrTest::testNullDuid() {
     ASSERT_THROW(lmptr_->addLease(leases[1]), DbOperationError);
 }
 
+void
+GenericLeaseMgrTest::testGetExpiredLeases4() {
+    // Get the leases to be used for the test.
+    vector<Lease4Ptr> leases = createLeases4();
+    // Make sure we have at least 6 leases there.
+    ASSERT_GE(leases.size(), 6);
+
+    // Use the same current time for all leases.
+    time_t current_time = time(NULL);
+
+    // Add them to the database. Leases with even indexes are expired, and
+    // the leases with higher indexes expired earlier.
+    for (int i = 0; i < leases.size(); ++i) {
+        leases[i]->valid_lft_ = 1000;
+        if (i % 2 == 0) {
+            leases[i]->cltt_ = current_time - leases[i]->valid_lft_ - 10 * (i + 1);
+        } else {
+            leases[i]->cltt_ = current_time;
+        }
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Retrieve all expired leases. They should be ordered by the
+    // expiration time, starting from the oldest one.
+    Lease4Collection expired_leases;
+    ASSERT_NO_THROW(lmptr_->getExpiredLeases4(expired_leases, 0));
+    ASSERT_EQ(static_cast<size_t>((leases.size() + 1) / 2),
+              expired_leases.size());
+    int index = (leases.size() - 1) / 2 * 2;
+    for (Lease4Collection::const_iterator lease = expired_leases.begin();
+         lease != expired_leases.end(); ++lease, index -= 2) {
+        EXPECT_EQ(leases[index]->addr_, (*lease)->addr_);
+    }
+
+    // Retrieve only two expired leases. The leases should be appended to
+    // the existing collection.
+    ASSERT_NO_THROW(lmptr_->getExpiredLeases4(expired_leases, 2));
+    ASSERT_EQ(static_cast<size_t>((leases.size() + 1) / 2) + 2,
+              expired_leases.size());
+    index = (leases.size() - 1) / 2 * 2;
+    EXPECT_EQ(leases[index]->addr_,
+              expired_leases[expired_leases.size() - 2]->addr_);
+    EXPECT_EQ(leases[index - 2]->addr_, expired_leases.back()->addr_);
+
+    // Renew the lease which expired first and delete the next one. These
+    // leases should no longer be returned.
+    leases[index]->cltt_ = current_time;
+    ASSERT_NO_THROW(lmptr_->updateLease4(leases[index]));
+    ASSERT_TRUE(lmptr_->deleteLease(leases[index - 2]->addr_));
+
+    expired_leases.clear();
+    ASSERT_NO_THROW(lmptr_->getExpiredLeases4(expired_leases, 0));
+    ASSERT_EQ(static_cast<size_t>((leases.size() + 1) / 2) - 2,
+              expired_leases.size());
+    index -= 4;
+    for (Lease4Collection::const_iterator lease = expired_leases.begin();
+         lease != expired_leases.end(); ++lease, index -= 2) {
+        EXPECT_EQ(leases[index]->addr_, (*lease)->addr_);
+    }
+}
+
+void
+GenericLeaseMgrTest::testGetExpiredLeases6() {
+    // Get the leases to be used for the test.
+    vector<Lease6Ptr> leases = createLeases6();
+    // Make sure we have at least 6 leases there.
+    ASSERT_GE(leases.size(), 6);
+
+    // Use the same current time for all leases.
+    time_t current_time = time(NULL);
+
+    // Add them to the database. Leases with even indexes are expired, and
+    // the leases with higher indexes expired earlier.
+    for (int i = 0; i < leases.size(); ++i) {
+        leases[i]->valid_lft_ = 1000;
+        if (i % 2 == 0) {
+            leases[i]->cltt_ = current_time - leases[i]->valid_lft_ - 10 * (i + 1);
+        } else {
+            leases[i]->cltt_ = current_time;
+        }
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Retrieve all expired leases. They should be ordered by the
+    // expiration time, starting from the oldest one.
+    Lease6Collection expired_leases;
+    ASSERT_NO_THROW(lmptr_->getExpiredLeases6(expired_leases, 0));
+    ASSERT_EQ(static_cast<size_t>((leases.size() + 1) / 2),
+              expired_leases.size());
+    int index = (leases.size() - 1) / 2 * 2;
+    for (Lease6Collection::const_iterator lease = expired_leases.begin();
+         lease != expired_leases.end(); ++lease, index -= 2) {
+        EXPECT_EQ(leases[index]->addr_, (*lease)->addr_);
+    }
+
+    // Retrieve only two expired leases. The leases should be appended to
+    // the existing collection.
+    ASSERT_NO_THROW(lmptr_->getExpiredLeases6(expired_leases, 2));
+    ASSERT_EQ(static_cast<size_t>((leases.size() + 1) / 2) + 2,
+              expired_leases.size());
+    index = (leases.size() - 1) / 2 * 2;
+    EXPECT_EQ(leases[index]->addr_,
+              expired_leases[expired_leases.size() - 2]->addr_);
+    EXPECT_EQ(leases[index - 2]->addr_, expired_leases.back()->addr_);
+
+    // Renew the lease which expired first and delete the next one. These
+    // leases should no longer be returned.
+    leases[index]->cltt_ = current_time;
+    ASSERT_NO_THROW(lmptr_->updateLease6(leases[index]));
+    ASSERT_TRUE(lmptr_->deleteLease(leases[index - 2]->addr_));
+
+    expired_leases.clear();
+    ASSERT_NO_THROW(lmptr_->getExpiredLeases6(expired_leases, 0));
+    ASSERT_EQ(static_cast<size_t>((leases.size() + 1) / 2) - 2,
+              expired_leases.size());
+    index -= 4;
+    for (Lease6Collection::const_iterator lease = expired_leases.begin();
+         lease != expired_leases.end(); ++lease, index -= 2) {
+        EXPECT_EQ(leases[index]->addr_, (*lease)->addr_);
+    }
+}
+
 void
 GenericLeaseMgrTest::testVersion(int major, int minor) {
     EXPECT_EQ(major, lmptr_->getVersion().first);
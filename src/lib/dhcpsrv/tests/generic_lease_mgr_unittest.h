@@ -161,6 +161,31 @@ public:
     /// a combination of client and subnet IDs.
     void testGetLease4ClientIdSubnetId();
 
+    /// @brief Check getClientLeases4 method
+    ///
+    /// Adds leases to the database and checks that the leases for the
+    /// HW address and for the client identifier are returned together.
+    void testGetClientLeases4();
+
+    /// @brief Check that getClientLeases4 throws on duplicate leases
+    ///
+    /// Adds two leases with the same HW address and subnet ID and checks
+    /// that the @c MultipleRecords exception is thrown. The memfile backend
+    /// doesn't detect the duplicates, so it doesn't run this test.
+    void testGetClientLeases4MultipleRecords();
+
+    /// @brief Check GetLeases4 method - access by Subnet ID
+    ///
+    /// Adds leases to the database and checks that all leases belonging
+    /// to the particular subnet are returned.
+    void testGetLeases4SubnetId();
+
+    /// @brief Check countLeases4 method
+    ///
+    /// Adds leases to the database and checks that the leases are counted
+    /// for the requested subnets only.
+    void testCountLeases4();
+
     /// @brief Basic Lease4 Checks
     ///
     /// Checks that the addLease, getLease4(by address), getLease4(hwaddr,subnet_id),
@@ -257,6 +282,20 @@ public:
     /// persistent storage has been updated as expected.
     void testRecreateLease6();
 
+    /// @brief Checks that expired DHCPv4 leases are returned.
+    ///
+    /// Half of the leases are expired and they are expected to be returned
+    /// in the order of their expiration times, up to the specified limit.
+    /// The leases which are renewed or deleted are not returned.
+    void testGetExpiredLeases4();
+
+    /// @brief Checks that expired DHCPv6 leases are returned.
+    ///
+    /// Half of the leases are expired and they are expected to be returned
+    /// in the order of their expiration times, up to the specified limit.
+    /// The leases which are renewed or deleted are not returned.
+    void testGetExpiredLeases6();
+
     /// @brief Verifies that a null DUID is not allowed.
     void testNullDuid();
 
@@ -0,0 +1,172 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <config.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/pkt4.h>
+#include <dhcpsrv/latency_stats.h>
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::data;
+using namespace isc::dhcp;
+using namespace boost::posix_time;
+
+namespace {
+
+// This test verifies that the values are assigned to the buckets holding
+// the values within 12.5% of each other.
+TEST(LatencyHistogramTest, buckets) {
+    // The small values have their own buckets.
+    for (uint64_t value = 0; value < 16; ++value) {
+        EXPECT_EQ(value, LatencyHistogram::getBucket(value));
+        EXPECT_EQ(value, LatencyHistogram::getBucketMax(value));
+    }
+
+    // The buckets are contiguous and each value falls in its bucket.
+    for (uint64_t value = 16; value < 100000; ++value) {
+        const unsigned bucket = LatencyHistogram::getBucket(value);
+        ASSERT_LT(bucket, LatencyHistogram::NUM_BUCKETS);
+        const uint64_t bucket_max = LatencyHistogram::getBucketMax(bucket);
+        ASSERT_GE(bucket_max, value);
+        ASSERT_LT(LatencyHistogram::getBucketMax(bucket - 1), value);
+        ASSERT_LE(bucket_max - value, value / 8);
+    }
+
+    // The very large values are recorded in the last bucket.
+    EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1,
+              LatencyHistogram::getBucket(0xFFFFFFFFFFFFFFFFULL));
+}
+
+// This test verifies that the statistics are computed from the recorded
+// values.
+TEST(LatencyHistogramTest, record) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(0, histogram.getCount());
+    EXPECT_EQ(0, histogram.getMin());
+    EXPECT_EQ(0, histogram.getMax());
+    EXPECT_EQ(0, histogram.getPercentile(50));
+
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(1000, histogram.getCount());
+    EXPECT_EQ(1, histogram.getMin());
+    EXPECT_EQ(1000, histogram.getMax());
+    EXPECT_DOUBLE_EQ(500.5, histogram.getMean());
+
+    // The percentiles are accurate to 12.5%.
+    const uint64_t p50 = histogram.getPercentile(50);
+    EXPECT_GE(p50, 500);
+    EXPECT_LE(p50, 563);
+    const uint64_t p99 = histogram.getPercentile(99);
+    EXPECT_GE(p99, 990);
+    EXPECT_LE(p99, 1000);
+    EXPECT_EQ(1000, histogram.getPercentile(100));
+
+    ConstElementPtr summary = histogram.toElement();
+    ASSERT_TRUE(summary);
+    ASSERT_TRUE(summary->get("count"));
+    EXPECT_EQ(1000, summary->get("count")->intValue());
+    ASSERT_TRUE(summary->get("p99.9"));
+    EXPECT_EQ(1000, summary->get("p99.9")->intValue());
+
+    histogram.reset();
+    EXPECT_EQ(0, histogram.getCount());
+    EXPECT_EQ(0, histogram.getMax());
+}
+
+// This test verifies that the time spent in the stages is recorded for
+// the message type.
+TEST(PacketLatencyStatsTest, record) {
+    PacketLatencyStats::TypeNames names;
+    names[DHCPDISCOVER] = "DHCPDISCOVER";
+    PacketLatencyStats stats(names);
+
+    Pkt4 pkt(DHCPDISCOVER, 1234);
+    // The stage times are not recorded by default.
+    stats.record(DHCPDISCOVER, pkt);
+    EXPECT_EQ(0, stats.getHistogram(DHCPDISCOVER,
+                                    PacketLatencyStats::NUM_STAGES).getCount());
+
+    pkt.updateTimestamp();
+    pkt.enableStageTimes(PacketLatencyStats::NUM_STAGES);
+    pkt.setStageTime(PacketLatencyStats::RECEIVE);
+    pkt.setStageTime(PacketLatencyStats::UNPACK);
+    pkt.setStageTime(PacketLatencyStats::SEND);
+    stats.record(DHCPDISCOVER, pkt);
+
+    EXPECT_EQ(1, stats.getHistogram(DHCPDISCOVER,
+                                    PacketLatencyStats::RECEIVE).getCount());
+    EXPECT_EQ(1, stats.getHistogram(DHCPDISCOVER,
+                                    PacketLatencyStats::UNPACK).getCount());
+    EXPECT_EQ(0, stats.getHistogram(DHCPDISCOVER,
+                                    PacketLatencyStats::LEASE).getCount());
+    EXPECT_EQ(1, stats.getHistogram(DHCPDISCOVER,
+                                    PacketLatencyStats::SEND).getCount());
+    EXPECT_EQ(1, stats.getHistogram(DHCPDISCOVER,
+                                    PacketLatencyStats::NUM_STAGES).getCount());
+
+    // The unknown message types are recorded as "other".
+    stats.record(DHCPINFORM, pkt);
+    EXPECT_EQ(1, stats.getHistogram(DHCPINFORM,
+                                    PacketLatencyStats::NUM_STAGES).getCount());
+    EXPECT_EQ(1, stats.getHistogram(DHCPDECLINE,
+                                    PacketLatencyStats::NUM_STAGES).getCount());
+
+    ConstElementPtr summary = stats.toElement();
+    ASSERT_TRUE(summary);
+    ASSERT_EQ(2, summary->mapValue().size());
+    ConstElementPtr discover = summary->get("DHCPDISCOVER");
+    ASSERT_TRUE(discover);
+    EXPECT_EQ(4, discover->mapValue().size());
+    EXPECT_TRUE(discover->get("receive"));
+    EXPECT_TRUE(discover->get("unpack"));
+    EXPECT_TRUE(discover->get("send"));
+    EXPECT_TRUE(discover->get("total"));
+    EXPECT_TRUE(summary->get("other"));
+
+    stats.reset();
+    EXPECT_EQ(0, stats.toElement()->mapValue().size());
+}
+
+// This test verifies that the recorder records the stage times when it
+// goes out of scope.
+TEST(PacketLatencyRecorderTest, record) {
+    PacketLatencyStats::TypeNames names;
+    names[DHCPREQUEST] = "DHCPREQUEST";
+    PacketLatencyStats stats(names);
+
+    Pkt4Ptr pkt(new Pkt4(DHCPREQUEST, 1234));
+    pkt->updateTimestamp();
+    pkt->enableStageTimes(PacketLatencyStats::NUM_STAGES);
+    {
+        PacketLatencyRecorder<Pkt4Ptr> recorder(&stats, pkt);
+        recorder.setType(DHCPREQUEST);
+        pkt->setStageTime(PacketLatencyStats::RECEIVE);
+    }
+    EXPECT_EQ(1, stats.getHistogram(DHCPREQUEST,
+                                    PacketLatencyStats::RECEIVE).getCount());
+
+    // Nothing is recorded when the histograms are disabled.
+    {
+        PacketLatencyRecorder<Pkt4Ptr> recorder(NULL, pkt);
+        recorder.setType(DHCPREQUEST);
+    }
+    EXPECT_EQ(1, stats.getHistogram(DHCPREQUEST,
+                                    PacketLatencyStats::RECEIVE).getCount());
+}
+
+} // end of anonymous namespace
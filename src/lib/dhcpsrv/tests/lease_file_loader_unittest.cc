@@ -14,6 +14,7 @@
 
 #include <config.h>
 #include <asiolink/io_address.h>
+#include <dhcpsrv/compact_lease_storage.h>
 #include <dhcpsrv/csv_lease_file4.h>
 #include <dhcpsrv/csv_lease_file6.h>
 #include <dhcpsrv/memfile_lease_storage.h>
@@ -296,6 +297,51 @@ TEST_F(LeaseFileLoaderTest, loadWrite4LeaseRemove) {
     }
 }
 
+// This test verifies that the leases with a valid lifetime of 0 are
+// kept in the storage when the loader is instructed to keep released
+// leases. This is used to produce delta lease files.
+TEST_F(LeaseFileLoaderTest, loadWrite4KeepReleased) {
+    std::string test_str;
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com\n";
+    std::string a_2 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "0,500,8,1,1,host.example.com\n";
+
+    std::string b_1 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                      "100,100,7,0,0,\n";
+
+    std::string c_1 = "192.0.3.20,dd:de:ba:0d:1b:2e:3e:5f,,"
+                      "0,100,7,0,0,\n";
+
+    // The entry for 192.0.2.1 is released after it has been allocated.
+    // The entry for 192.0.3.20 is released without any previous entries.
+    test_str = v4_hdr_ + a_1 + b_1 + a_2 + c_1;
+    io_.writeFile(test_str);
+
+    boost::scoped_ptr<CSVLeaseFile4> lf(new CSVLeaseFile4(filename_));
+    ASSERT_NO_THROW(lf->open());
+
+    Lease4Storage storage;
+    ASSERT_NO_THROW(LeaseFileLoader::load<Lease4>(*lf, storage, 10, true,
+                                                  true));
+
+    // All leases should be kept, including the released ones.
+    ASSERT_EQ(3, storage.size());
+
+    Lease4Ptr lease = getLease<Lease4Ptr>("192.0.2.1", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(0, lease->valid_lft_);
+
+    lease = getLease<Lease4Ptr>("192.0.3.20", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(0, lease->valid_lft_);
+
+    // The released leases should be written so as they remove the
+    // leases when the written file is applied on top of another file.
+    test_str = v4_hdr_ + a_2 + b_1 + c_1;
+    writeLeases<Lease4, CSVLeaseFile4, Lease4Storage>(*lf, storage, test_str);
+}
+
 // This test verifies that the DHCPv6 leases can be loaded from the lease
 // file and that only the most recent entry for each lease is loaded and
 // the previous entries are discarded.
@@ -539,4 +585,207 @@ TEST_F(LeaseFileLoaderTest, loadWriteLeaseWithZeroLifetime) {
     checkStats(*lf, 0, 0, 0, 1, 1, 0);
     }
 }
+
+// This test verifies that the DHCPv4 leases loaded by multiple threads
+// are the same as the leases loaded sequentially, when the entries for
+// the same lease, including the removal, are in different parts of the
+// file parsed by different threads.
+TEST_F(LeaseFileLoaderTest, loadParallel4) {
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com\n";
+    std::string a_2 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,500,8,1,1,host.example.com\n";
+
+    std::string b_1 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                      "100,100,7,0,0,\n";
+    std::string b_2 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                      "0,150,7,0,0,\n";
+
+    std::string c_1 = "192.0.2.3,,a:11:01:04,"
+                      "200,200,8,1,1,host.example.com\n";
+
+    std::string d_1 = "192.0.2.10,01:02:03:04:05:06,,200,300,8,1,1,\n";
+
+    // The lease for 192.0.3.15 is removed by the entry near the end of
+    // the file. The empty line should be skipped.
+    std::string test_str = v4_hdr_ + a_1 + b_1 + c_1 + d_1 + "\n" + a_1 +
+        d_1 + b_2 + a_2;
+    io_.writeFile(test_str);
+
+    boost::scoped_ptr<CSVLeaseFile4> lf(new CSVLeaseFile4(filename_));
+
+    // Load leases from the file using 3 threads.
+    Lease4Storage storage;
+    ASSERT_NO_THROW(LeaseFileLoader::loadParallel<Lease4>(*lf, storage, 10,
+                                                          true, false, 3));
+
+    // We should have made 9 attempts to read, with 7 leases read and 1 error
+    {
+    SCOPED_TRACE("Read leases");
+    checkStats(*lf, 9, 7, 1, 0, 0, 0);
+    }
+
+    ASSERT_EQ(2, storage.size());
+
+    Lease4Ptr lease = getLease<Lease4Ptr>("192.0.2.1", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(300, lease->cltt_);
+
+    lease = getLease<Lease4Ptr>("192.0.2.10", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(100, lease->cltt_);
+
+    EXPECT_FALSE(getLease<Lease4Ptr>("192.0.2.3", storage));
+    EXPECT_FALSE(getLease<Lease4Ptr>("192.0.3.15", storage));
+
+    // The released leases are kept if requested.
+    storage.clear();
+    ASSERT_NO_THROW(LeaseFileLoader::loadParallel<Lease4>(*lf, storage, 10,
+                                                          true, true, 3));
+    ASSERT_EQ(3, storage.size());
+    lease = getLease<Lease4Ptr>("192.0.3.15", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(0, lease->valid_lft_);
+}
+
+// This test verifies that the DHCPv6 leases loaded by multiple threads
+// are the same as the leases loaded sequentially from a file holding
+// many entries for each lease.
+TEST_F(LeaseFileLoaderTest, loadParallel6) {
+    std::ostringstream test_str;
+    test_str << v6_hdr_;
+    for (int i = 0; i < 1000; ++i) {
+        const int lease = i % 97;
+        // Every tenth entry removes the lease.
+        const int valid_lft = (i % 10 == 0 ? 0 : 200);
+        test_str << "2001:db8:1::" << std::hex << (lease + 1) << std::dec
+                 << ",00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+                 << valid_lft << "," << (i + 1000)
+                 << ",8,100,0,7,0,1,1,host.example.com,\n";
+    }
+    io_.writeFile(test_str.str());
+
+    CSVLeaseFile6 lf(filename_);
+    lf.open();
+    Lease6Storage expected;
+    ASSERT_NO_THROW(LeaseFileLoader::load<Lease6>(lf, expected, 0));
+
+    const unsigned thread_counts[] = { 2, 3, 8 };
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]);
+         ++i) {
+        std::ostringstream s;
+        s << thread_counts[i] << " threads";
+        SCOPED_TRACE(s.str());
+
+        Lease6Storage storage;
+        ASSERT_NO_THROW(LeaseFileLoader::loadParallel<Lease6>
+                        (lf, storage, 0, true, false, thread_counts[i]));
+        checkStats(lf, 1001, 1000, 0, 0, 0, 0);
+
+        ASSERT_EQ(expected.size(), storage.size());
+        for (Lease6Storage::const_iterator it = expected.begin();
+             it != expected.end(); ++it) {
+            Lease6Ptr lease = getLease<Lease6Ptr>((*it)->addr_.toText(),
+                                                  storage);
+            ASSERT_TRUE(lease);
+            EXPECT_TRUE(**it == *lease);
+        }
+    }
+}
+
+// This test verifies that the DHCPv4 leases are loaded to the compact
+// storage in the same way as to the multi index container.
+TEST_F(LeaseFileLoaderTest, loadCompact4) {
+    std::ostringstream test_str;
+    test_str << v4_hdr_;
+    for (int i = 0; i < 1000; ++i) {
+        const int lease = i % 97;
+        // Every tenth entry removes the lease.
+        const int valid_lft = (i % 10 == 0 ? 0 : 200);
+        test_str << "192.0.2." << (lease + 1) << ",06:07:08:09:0a:"
+                 << std::hex << (lease + 16) << std::dec << ",01:02:03:04,"
+                 << valid_lft << "," << (i + 1000) << ",8,1,1,"
+                 << "host-" << lease << ".example.com\n";
+    }
+    io_.writeFile(test_str.str());
+
+    CSVLeaseFile4 lf(filename_);
+    lf.open();
+    Lease4Storage expected;
+    ASSERT_NO_THROW(LeaseFileLoader::load<Lease4>(lf, expected, 0));
+
+    CompactLease4Storage storage;
+    ASSERT_NO_THROW(LeaseFileLoader::loadParallel<Lease4>
+                    (lf, storage, 0, true, false, 3));
+
+    ASSERT_EQ(expected.size(), storage.size());
+    for (Lease4Storage::const_iterator it = expected.begin();
+         it != expected.end(); ++it) {
+        CompactLease4Storage::const_iterator lease =
+            storage.find((*it)->addr_);
+        ASSERT_TRUE(lease != storage.end());
+        EXPECT_TRUE(**it == **lease);
+    }
+}
+
+// This test verifies that no leases are loaded by multiple threads when
+// the maximum number of errors is exceeded.
+TEST_F(LeaseFileLoaderTest, loadParallelMaxErrors) {
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com\n";
+    std::string b_1 = "192.0.2.3,,a:11:01:04,200,200,8,1,1,host.example.com\n";
+    std::string c_1 = "192.0.2.10,01:02:03:04:05:06,,200,300,8,1,1,\n";
+
+    io_.writeFile(v4_hdr_ + a_1 + b_1 + b_1 + c_1 + b_1 + b_1);
+
+    boost::scoped_ptr<CSVLeaseFile4> lf(new CSVLeaseFile4(filename_));
+
+    // All entries are parsed before the number of errors is checked.
+    Lease4Storage storage;
+    ASSERT_THROW(LeaseFileLoader::loadParallel<Lease4>(*lf, storage, 3, true,
+                                                       false, 2),
+                 util::CSVFileError);
+    {
+    SCOPED_TRACE("Read leases 1");
+    checkStats(*lf, 7, 2, 4, 0, 0, 0);
+    }
+    EXPECT_TRUE(storage.empty());
+
+    ASSERT_NO_THROW(LeaseFileLoader::loadParallel<Lease4>(*lf, storage, 4, true,
+                                                          false, 2));
+    EXPECT_EQ(2, storage.size());
+}
+
+// This test verifies that the rows which don't hold a value for each
+// column are rejected when the lease file is loaded by multiple threads,
+// as when it is loaded sequentially.
+TEST_F(LeaseFileLoaderTest, loadParallelInvalidRowSize) {
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com\n";
+    // The row lacking the hostname.
+    std::string b_1 = "192.0.2.3,06:07:08:09:0a:bd,,200,200,8,1,1\n";
+    // The row with an extra value.
+    std::string c_1 = "192.0.2.10,01:02:03:04:05:06,,200,300,8,1,1,,foo\n";
+
+    io_.writeFile(v4_hdr_ + a_1 + b_1 + c_1);
+
+    boost::scoped_ptr<CSVLeaseFile4> lf(new CSVLeaseFile4(filename_));
+
+    const unsigned thread_counts[] = { 1, 2 };
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]);
+         ++i) {
+        std::ostringstream s;
+        s << thread_counts[i] << " threads";
+        SCOPED_TRACE(s.str());
+
+        Lease4Storage storage;
+        ASSERT_NO_THROW(LeaseFileLoader::loadParallel<Lease4>
+                        (*lf, storage, 2, true, false, thread_counts[i]));
+        checkStats(*lf, 4, 1, 2, 0, 0, 0);
+
+        ASSERT_EQ(1, storage.size());
+        EXPECT_TRUE(getLease<Lease4Ptr>("192.0.2.1", storage));
+    }
+}
+
 } // end of anonymous namespace
@@ -0,0 +1,182 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <config.h>
+
+#include <dhcpsrv/lease_group_commit.h>
+#include <exceptions/exceptions.h>
+#include <util/threads/thread.h>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+#include <vector>
+
+using namespace isc;
+using namespace isc::dhcp;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Test fixture class for @c LeaseGroupCommit.
+class LeaseGroupCommitTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    LeaseGroupCommitTest()
+        : syncs_(0), fail_(false), delay_(0) {
+    }
+
+    /// @brief Sync function counting the syncs.
+    ///
+    /// Throws if the @c fail_ is set, sleeps for @c delay_ microseconds
+    /// otherwise.
+    void sync() {
+        if (fail_) {
+            isc_throw(Unexpected, "sync failed");
+        }
+        if (delay_ > 0) {
+            usleep(delay_);
+        }
+        Mutex::Locker locker(mutex_);
+        ++syncs_;
+    }
+
+    /// @brief Returns the number of syncs.
+    unsigned getSyncs() {
+        Mutex::Locker locker(mutex_);
+        return (syncs_);
+    }
+
+    /// @brief Writes a lease and waits for the sync.
+    ///
+    /// @param group_commit Group commit.
+    void update(LeaseGroupCommit* group_commit) {
+        LeaseGroupCommit::Transaction transaction(group_commit);
+        group_commit->recordWrite();
+        transaction.commit();
+    }
+
+    /// @brief Number of syncs.
+    unsigned syncs_;
+
+    /// @brief Indicates if the sync should fail.
+    bool fail_;
+
+    /// @brief Duration of the sync in microseconds.
+    useconds_t delay_;
+
+    /// @brief Mutex protecting the number of syncs.
+    Mutex mutex_;
+};
+
+// This test verifies that a single update is synced immediately and that
+// a transaction without writes doesn't cause a sync.
+TEST_F(LeaseGroupCommitTest, singleUpdate) {
+    // The interval is long, so as the test would hang if the update
+    // waited for it.
+    LeaseGroupCommit group_commit(boost::bind(&LeaseGroupCommitTest::sync,
+                                              this), 100000, 64);
+    update(&group_commit);
+    EXPECT_EQ(1, getSyncs());
+    EXPECT_EQ(1, group_commit.getSyncs());
+    EXPECT_EQ(1, group_commit.getWrites());
+
+    {
+        LeaseGroupCommit::Transaction transaction(&group_commit);
+        transaction.commit();
+    }
+    EXPECT_EQ(1, getSyncs());
+
+    update(&group_commit);
+    EXPECT_EQ(2, getSyncs());
+    EXPECT_EQ(2, group_commit.getWrites());
+}
+
+// This test verifies that the transaction without group commit does nothing.
+TEST_F(LeaseGroupCommitTest, noGroupCommit) {
+    LeaseGroupCommit::Transaction transaction(NULL);
+    EXPECT_NO_THROW(transaction.commit());
+}
+
+// This test verifies that the writes of the concurrent updates are synced
+// together.
+TEST_F(LeaseGroupCommitTest, concurrentUpdates) {
+    LeaseGroupCommit group_commit(boost::bind(&LeaseGroupCommitTest::sync,
+                                              this), 100000, 64);
+    {
+        // Begin an update and let another thread write a lease. Regardless
+        // of which of the updates becomes the leader, it has to wait for
+        // the other one.
+        LeaseGroupCommit::Transaction transaction(&group_commit);
+        Thread thread(boost::bind(&LeaseGroupCommitTest::update, this,
+                                  &group_commit));
+        while (group_commit.getWrites() == 0) {
+            usleep(1000);
+        }
+        group_commit.recordWrite();
+        transaction.commit();
+        thread.wait();
+    }
+    EXPECT_EQ(1, getSyncs());
+    EXPECT_EQ(2, group_commit.getWrites());
+
+    // Many threads updating the leases while the sync is slow should
+    // be synced in fewer syncs than writes.
+    delay_ = 20000;
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>(
+            new Thread(boost::bind(&LeaseGroupCommitTest::update, this,
+                                   &group_commit))));
+    }
+    for (int i = 0; i < threads.size(); ++i) {
+        threads[i]->wait();
+    }
+    EXPECT_EQ(10, group_commit.getWrites());
+    EXPECT_LT(getSyncs(), 9);
+    EXPECT_EQ(getSyncs(), group_commit.getSyncs());
+}
+
+// This test verifies that the leader syncs the file when the configured
+// number of leases is waiting, without waiting for the other updates.
+TEST_F(LeaseGroupCommitTest, maxLeases) {
+    LeaseGroupCommit group_commit(boost::bind(&LeaseGroupCommitTest::sync,
+                                              this), 100000, 1);
+    // The update held open would delay the sync by the interval if the
+    // number of leases wasn't taken into account.
+    LeaseGroupCommit::Transaction open_transaction(&group_commit);
+    update(&group_commit);
+    EXPECT_EQ(1, getSyncs());
+}
+
+// This test verifies that the sync failure is reported to the caller and
+// that the next update retries the sync.
+TEST_F(LeaseGroupCommitTest, syncFailure) {
+    LeaseGroupCommit group_commit(boost::bind(&LeaseGroupCommitTest::sync,
+                                              this), 100000, 64);
+    fail_ = true;
+    EXPECT_THROW(update(&group_commit), Unexpected);
+    EXPECT_EQ(0, group_commit.getSyncs());
+
+    fail_ = false;
+    update(&group_commit);
+    EXPECT_EQ(1, getSyncs());
+    EXPECT_EQ(1, group_commit.getSyncs());
+}
+
+} // end of anonymous namespace
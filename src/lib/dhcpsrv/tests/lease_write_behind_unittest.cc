@@ -0,0 +1,394 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcpsrv/lease_write_behind.h>
+#include <dhcpsrv/memfile_lease_mgr.h>
+#include <util/threads/sync.h>
+
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <gtest/gtest.h>
+
+#include <set>
+#include <sstream>
+#include <time.h>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief In-memory lease database which commit can be blocked.
+///
+/// The journal holds the changes until they are committed. Blocking the
+/// commit allows for checking the contents of the journal without races
+/// with the thread writing the changes.
+class BlockingLeaseMgr : public Memfile_LeaseMgr {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param parameters Lease database parameters.
+    BlockingLeaseMgr(const ParameterMap& parameters)
+        : Memfile_LeaseMgr(parameters), blocked_(false), rejected_() {
+    }
+
+    /// @brief Makes the database reject the lease for the address.
+    ///
+    /// @param address Address of the lease to be rejected.
+    void reject(const std::string& address) {
+        rejected_.insert(IOAddress(address));
+    }
+
+    /// @brief Adds the lease unless it is rejected.
+    ///
+    /// @param lease Lease to be added.
+    /// @throw DbOperationError if the lease is rejected.
+    virtual bool addLease(const Lease4Ptr& lease) {
+        if (rejected_.count(lease->addr_) > 0) {
+            isc_throw(DbOperationError, "lease for " << lease->addr_
+                      << " rejected");
+        }
+        return (Memfile_LeaseMgr::addLease(lease));
+    }
+
+    using Memfile_LeaseMgr::addLease;
+
+    /// @brief Blocks the commit until @c unblock is called.
+    void block() {
+        Mutex::Locker locker(mutex_);
+        blocked_ = true;
+    }
+
+    /// @brief Unblocks the commit.
+    void unblock() {
+        Mutex::Locker locker(mutex_);
+        blocked_ = false;
+        cond_.broadcast();
+    }
+
+    /// @brief Waits until the commit is unblocked.
+    virtual void commit() {
+        Mutex::Locker locker(mutex_);
+        while (blocked_) {
+            cond_.wait(mutex_);
+        }
+    }
+
+private:
+
+    /// @brief Indicates if the commit is blocked.
+    bool blocked_;
+
+    /// @brief Mutex protecting the flag.
+    Mutex mutex_;
+
+    /// @brief Signals that the commit has been unblocked.
+    CondVar cond_;
+
+    /// @brief Addresses of the leases which can't be added.
+    std::set<IOAddress> rejected_;
+};
+
+/// @brief Test fixture class for @c LeaseWriteBehind.
+///
+/// The changes are written to the in-memory lease database.
+class LeaseWriteBehindTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Creates the in-memory lease database and the journal.
+    LeaseWriteBehindTest() {
+        LeaseMgr::ParameterMap pmap;
+        pmap["universe"] = "4";
+        pmap["persist"] = "false";
+        writer_.reset(new BlockingLeaseMgr(pmap));
+        journal_.reset(new LeaseWriteBehind(*writer_));
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Stops the journal before the lease database is destroyed.
+    virtual ~LeaseWriteBehindTest() {
+        writer_->unblock();
+        journal_.reset();
+    }
+
+    /// @brief Unblocks the lease database and waits until the pending
+    /// changes are written.
+    void flush() {
+        writer_->unblock();
+        journal_->flush();
+    }
+
+    /// @brief Creates the IPv4 lease.
+    ///
+    /// @param address Address of the lease.
+    /// @param subnet_id Subnet identifier.
+    Lease4Ptr createLease4(const std::string& address,
+                           const SubnetID subnet_id = 1) const {
+        return (Lease4Ptr(new Lease4(IOAddress(address), HWAddrPtr(), 0, 0,
+                                     3000, 1000, 2000, time(NULL),
+                                     subnet_id)));
+    }
+
+    /// @brief Creates the IPv6 lease.
+    ///
+    /// @param address Address of the lease.
+    /// @param iaid IAID of the lease.
+    Lease6Ptr createLease6(const std::string& address,
+                           const uint32_t iaid = 1) const {
+        DuidPtr duid(new DUID(std::vector<uint8_t>(8, 0x42)));
+        return (Lease6Ptr(new Lease6(Lease::TYPE_NA, IOAddress(address),
+                                     duid, iaid, 1000, 2000, 3000, 4000, 1)));
+    }
+
+    /// @brief Lease database to which the changes are written.
+    boost::scoped_ptr<BlockingLeaseMgr> writer_;
+
+    /// @brief Journal under test.
+    boost::scoped_ptr<LeaseWriteBehind> journal_;
+};
+
+/// @brief Checks if the lease belongs to the subnet.
+bool
+inSubnet(const Lease4& lease, const SubnetID subnet_id) {
+    return (lease.subnet_id_ == subnet_id);
+}
+
+// This test verifies that the IPv4 leases are added, updated and deleted
+// in the journal and then in the lease database.
+TEST_F(LeaseWriteBehindTest, addUpdateDelete4) {
+    // Hold the changes in the journal until they are flushed.
+    writer_->block();
+    Lease4Ptr lease = createLease4("192.0.2.1");
+    ASSERT_TRUE(journal_->addLease(lease));
+
+    // The lease is returned from the journal.
+    Lease4Ptr returned;
+    EXPECT_EQ(LeaseWriteBehind::PRESENT,
+              journal_->getLease4(lease->addr_, returned));
+    ASSERT_TRUE(returned);
+    EXPECT_TRUE(*returned == *lease);
+
+    // The journal holds the copy of the lease.
+    lease->subnet_id_ = 2;
+    ASSERT_EQ(LeaseWriteBehind::PRESENT,
+              journal_->getLease4(lease->addr_, returned));
+    EXPECT_EQ(1, returned->subnet_id_);
+
+    // The journal has no information about other leases.
+    EXPECT_EQ(LeaseWriteBehind::UNKNOWN,
+              journal_->getLease4(IOAddress("192.0.2.2"), returned));
+    EXPECT_FALSE(returned);
+
+    // Once the changes are written, the lease is in the lease database
+    // and the journal doesn't hold it anymore.
+    flush();
+    returned = writer_->getLease4(lease->addr_);
+    ASSERT_TRUE(returned);
+    EXPECT_EQ(1, returned->subnet_id_);
+    EXPECT_EQ(LeaseWriteBehind::UNKNOWN,
+              journal_->getLease4(lease->addr_, returned));
+
+    // Update the lease.
+    writer_->block();
+    journal_->updateLease4(lease);
+    ASSERT_EQ(LeaseWriteBehind::PRESENT,
+              journal_->getLease4(lease->addr_, returned));
+    EXPECT_EQ(2, returned->subnet_id_);
+    flush();
+    returned = writer_->getLease4(lease->addr_);
+    ASSERT_TRUE(returned);
+    EXPECT_EQ(2, returned->subnet_id_);
+
+    // The deletion of the lease not held by the journal must be done
+    // by the caller.
+    EXPECT_EQ(LeaseWriteBehind::UNKNOWN, journal_->deleteLease(lease->addr_));
+
+    // Update and delete the lease.
+    writer_->block();
+    journal_->updateLease4(lease);
+    EXPECT_EQ(LeaseWriteBehind::PRESENT, journal_->deleteLease(lease->addr_));
+    EXPECT_EQ(LeaseWriteBehind::DELETED,
+              journal_->getLease4(lease->addr_, returned));
+    EXPECT_FALSE(returned);
+    EXPECT_EQ(LeaseWriteBehind::DELETED, journal_->deleteLease(lease->addr_));
+
+    // The deleted lease can't be updated.
+    EXPECT_THROW(journal_->updateLease4(lease), NoSuchLease);
+
+    flush();
+    EXPECT_FALSE(writer_->getLease4(lease->addr_));
+}
+
+// This test verifies that the lease is replaced when it is deleted and
+// added again before the changes are written.
+TEST_F(LeaseWriteBehindTest, replace4) {
+    Lease4Ptr lease = createLease4("192.0.2.1");
+    ASSERT_TRUE(writer_->addLease(lease));
+
+    // Delete and add the lease with the different subnet id.
+    writer_->block();
+    journal_->updateLease4(lease);
+    EXPECT_EQ(LeaseWriteBehind::PRESENT, journal_->deleteLease(lease->addr_));
+    lease = createLease4("192.0.2.1", 5);
+    EXPECT_TRUE(journal_->addLease(lease));
+
+    // The lease can't be added twice.
+    EXPECT_FALSE(journal_->addLease(lease));
+
+    flush();
+    Lease4Ptr returned = writer_->getLease4(lease->addr_);
+    ASSERT_TRUE(returned);
+    EXPECT_EQ(5, returned->subnet_id_);
+}
+
+// This test verifies that the IPv6 leases are written to the lease database.
+TEST_F(LeaseWriteBehindTest, addUpdateDelete6) {
+    writer_->block();
+    Lease6Ptr lease = createLease6("2001:db8:1::1");
+    ASSERT_TRUE(journal_->addLease(lease));
+
+    Lease6Ptr returned;
+    ASSERT_EQ(LeaseWriteBehind::PRESENT,
+              journal_->getLease6(lease->addr_, returned));
+    ASSERT_TRUE(returned);
+    EXPECT_TRUE(*returned == *lease);
+
+    // Update the lease before the addition is written. The updated lease
+    // should be added.
+    lease->iaid_ = 10;
+    journal_->updateLease6(lease);
+
+    flush();
+    returned = writer_->getLease6(Lease::TYPE_NA, lease->addr_);
+    ASSERT_TRUE(returned);
+    EXPECT_EQ(10, returned->iaid_);
+
+    writer_->block();
+    journal_->updateLease6(lease);
+    EXPECT_EQ(LeaseWriteBehind::PRESENT, journal_->deleteLease(lease->addr_));
+    flush();
+    EXPECT_FALSE(writer_->getLease6(Lease::TYPE_NA, lease->addr_));
+}
+
+// This test verifies that the leases read from the lease database are
+// merged with the pending changes.
+TEST_F(LeaseWriteBehindTest, merge) {
+    ASSERT_TRUE(writer_->addLease(createLease4("192.0.2.1", 1)));
+    ASSERT_TRUE(writer_->addLease(createLease4("192.0.2.2", 1)));
+    ASSERT_TRUE(writer_->addLease(createLease4("192.0.2.3", 1)));
+
+    // Move the first lease to another subnet, delete the second lease
+    // and add the new lease.
+    writer_->block();
+    journal_->updateLease4(createLease4("192.0.2.1", 2));
+    journal_->updateLease4(createLease4("192.0.2.2", 1));
+    ASSERT_EQ(LeaseWriteBehind::PRESENT,
+              journal_->deleteLease(IOAddress("192.0.2.2")));
+    ASSERT_TRUE(journal_->addLease(createLease4("192.0.2.4", 1)));
+
+    // No write completes while the lease database is blocked, so the
+    // merge must succeed.
+    const uint64_t writes = journal_->getWrites();
+    Lease4Collection leases = writer_->getLeases4(1);
+    ASSERT_TRUE(journal_->merge(leases, boost::bind(&inSubnet, _1, 1),
+                                writes));
+
+    std::set<IOAddress> addresses;
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        EXPECT_EQ(1, (*lease)->subnet_id_);
+        addresses.insert((*lease)->addr_);
+    }
+    ASSERT_EQ(2, addresses.size());
+    EXPECT_EQ(1, addresses.count(IOAddress("192.0.2.3")));
+    EXPECT_EQ(1, addresses.count(IOAddress("192.0.2.4")));
+
+    // The merge fails when the number of writes doesn't match.
+    EXPECT_FALSE(journal_->merge(leases, boost::bind(&inSubnet, _1, 1),
+                                 writes + 1));
+
+    // After the changes are written, the lease database returns the
+    // same leases.
+    flush();
+    leases = writer_->getLeases4(1);
+    EXPECT_EQ(2, leases.size());
+}
+
+// This test verifies that the pending changes are written when the
+// journal is destroyed.
+TEST_F(LeaseWriteBehindTest, destroy) {
+    for (int i = 1; i <= 100; ++i) {
+        std::ostringstream address;
+        address << "192.0.2." << i;
+        ASSERT_TRUE(journal_->addLease(createLease4(address.str())));
+    }
+    journal_.reset();
+    EXPECT_EQ(100, writer_->getLeases4(1).size());
+}
+
+// This test verifies that the callers are blocked when the maximum number
+// of the pending changes is reached, until the changes are written.
+TEST_F(LeaseWriteBehindTest, maxPending) {
+    journal_.reset(new LeaseWriteBehind(*writer_, 2));
+    for (int i = 1; i <= 100; ++i) {
+        std::ostringstream address;
+        address << "192.0.2." << i;
+        ASSERT_TRUE(journal_->addLease(createLease4(address.str())));
+    }
+    flush();
+    EXPECT_EQ(100, writer_->getLeases4(1).size());
+}
+
+// This test verifies that a change which the database rejects is
+// discarded after the maximum number of attempts, and the remaining
+// changes are written.
+TEST_F(LeaseWriteBehindTest, rejectedChange) {
+    journal_.reset(new LeaseWriteBehind(*writer_, 65536, 1));
+    writer_->reject("192.0.2.2");
+
+    // Hold the changes until all of them are recorded, so as they are
+    // written together.
+    writer_->block();
+    ASSERT_TRUE(journal_->addLease(createLease4("192.0.2.1")));
+    ASSERT_TRUE(journal_->addLease(createLease4("192.0.2.2")));
+    ASSERT_TRUE(journal_->addLease(createLease4("192.0.2.3")));
+
+    // The callers waiting for the changes must not be blocked forever.
+    flush();
+    EXPECT_TRUE(writer_->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_FALSE(writer_->getLease4(IOAddress("192.0.2.2")));
+    EXPECT_TRUE(writer_->getLease4(IOAddress("192.0.2.3")));
+
+    // The journal doesn't hold the discarded change.
+    Lease4Ptr lease;
+    EXPECT_EQ(LeaseWriteBehind::UNKNOWN,
+              journal_->getLease4(IOAddress("192.0.2.2"), lease));
+
+    // The subsequent changes are written.
+    ASSERT_TRUE(journal_->addLease(createLease4("192.0.2.4")));
+    flush();
+    EXPECT_TRUE(writer_->getLease4(IOAddress("192.0.2.4")));
+}
+
+} // end of anonymous namespace
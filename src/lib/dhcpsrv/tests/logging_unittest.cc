@@ -236,6 +236,37 @@ TEST_F(LoggingTest, multipleLoggingDestinations) {
     EXPECT_EQ("stdout" , storage->getLoggingInfo()[0].destinations_[1].output_);
 }
 
+// Checks that the asynchronous logging parameters are parsed and that
+// the invalid values are rejected.
+TEST_F(LoggingTest, parsingAsyncLogging) {
+    SrvConfigPtr storage(new SrvConfig());
+    EXPECT_FALSE(storage->getAsyncLogging());
+
+    LogConfigParser parser(storage);
+
+    // Defaults are used when the parameters are not specified.
+    ConstElementPtr config = Element::fromJSON("{ }");
+    ASSERT_NO_THROW(parser.parseAsyncLogging(config));
+    EXPECT_TRUE(storage->getAsyncLogging());
+    EXPECT_EQ(isc::log::AsyncLogWriter::DEFAULT_QUEUE_SIZE,
+              storage->getAsyncLoggingQueueSize());
+    EXPECT_EQ(isc::log::AsyncLogWriter::BLOCK,
+              storage->getAsyncLoggingPolicy());
+
+    config = Element::fromJSON("{ \"queue-size\": 1024,"
+                               "  \"overflow-policy\": \"count\" }");
+    ASSERT_NO_THROW(parser.parseAsyncLogging(config));
+    EXPECT_EQ(1024, storage->getAsyncLoggingQueueSize());
+    EXPECT_EQ(isc::log::AsyncLogWriter::COUNT,
+              storage->getAsyncLoggingPolicy());
+
+    config = Element::fromJSON("{ \"queue-size\": 0 }");
+    EXPECT_THROW(parser.parseAsyncLogging(config), BadValue);
+
+    config = Element::fromJSON("{ \"overflow-policy\": \"wait\" }");
+    EXPECT_THROW(parser.parseAsyncLogging(config), BadValue);
+}
+
 /// @todo There is no easy way to test applyConfiguration() and defaultLogging().
 /// To test them, it would require instrumenting log4cplus to actually fake
 /// the logging set up. Alternatively, we could develop set of test suites
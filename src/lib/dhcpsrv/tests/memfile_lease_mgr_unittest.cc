@@ -158,6 +158,13 @@ public:
             LeaseFileIO io(Memfile_LeaseMgr::appendSuffix(base_name, type));
             io.removeFile();
         }
+        // Remove the delta segment files created by incremental LFC.
+        LeaseFileIO io_segment(Memfile_LeaseMgr::appendSuffix(base_name,
+            Memfile_LeaseMgr::FILE_SEGMENT));
+        io_segment.removeFile();
+        LeaseFileIO io_segment_finish(Memfile_LeaseMgr::appendSuffix(base_name,
+            Memfile_LeaseMgr::FILE_SEGMENT_FINISH));
+        io_segment_finish.removeFile();
     }
 
     /// @brief Return path to the lease file used by unit tests.
@@ -278,6 +285,30 @@ TEST_F(MemfileLeaseMgrTest, constructor) {
     // The lfc-interval must be an integer.
     pmap["lfc-interval"] = "bogus";
     EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The file-format must be csv or binary.
+    pmap["lfc-interval"] = "10";
+    pmap["persist"] = "true";
+    pmap["file-format"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The sync-policy must be none, write or group.
+    pmap["file-format"] = "csv";
+    pmap["sync-policy"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The sync-interval must be an integer.
+    pmap["sync-policy"] = "group";
+    pmap["sync-interval"] = "bogus";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    // The sync-leases must be a positive integer.
+    pmap["sync-interval"] = "5";
+    pmap["sync-leases"] = "0";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), isc::BadValue);
+
+    pmap["sync-leases"] = "10";
+    EXPECT_NO_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)));
 }
 
 // Checks if the getType() and getName() methods both return "memfile".
@@ -850,6 +881,25 @@ TEST_F(MemfileLeaseMgrTest, getLease4ClientIdSubnetId) {
     testGetLease4ClientIdSubnetId();
 }
 
+/// @brief Checks that the leases for the HW address and client identifier
+/// are returned together.
+TEST_F(MemfileLeaseMgrTest, getClientLeases4) {
+    startBackend(V4);
+    testGetClientLeases4();
+}
+
+/// @brief Checks that all leases for the subnet can be retrieved.
+TEST_F(MemfileLeaseMgrTest, getLeases4SubnetId) {
+    startBackend(V4);
+    testGetLeases4SubnetId();
+}
+
+/// @brief Checks that the leases in the subnets are counted.
+TEST_F(MemfileLeaseMgrTest, countLeases4) {
+    startBackend(V4);
+    testCountLeases4();
+}
+
 /// @brief Basic Lease6 Checks
 ///
 /// Checks that the addLease, getLease6 (by address) and deleteLease (with an
@@ -920,6 +970,13 @@ TEST_F(MemfileLeaseMgrTest, DISABLED_updateLease4) {
     testUpdateLease4();
 }
 
+/// @brief Checks that expired DHCPv4 leases are returned in the order
+/// of their expiration times.
+TEST_F(MemfileLeaseMgrTest, getExpiredLeases4) {
+    startBackend(V4);
+    testGetExpiredLeases4();
+}
+
 /// @brief Lease6 update tests
 ///
 /// Checks that we are able to update a lease in the database.
@@ -931,6 +988,13 @@ TEST_F(MemfileLeaseMgrTest, DISABLED_updateLease6) {
     testUpdateLease6();
 }
 
+/// @brief Checks that expired DHCPv6 leases are returned in the order
+/// of their expiration times.
+TEST_F(MemfileLeaseMgrTest, getExpiredLeases6) {
+    startBackend(V6);
+    testGetExpiredLeases6();
+}
+
 /// @brief DHCPv4 Lease recreation tests
 ///
 /// Checks that the lease can be created, deleted and recreated with
@@ -1134,6 +1198,73 @@ TEST_F(MemfileLeaseMgrTest, load4CompletedFile) {
     EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.1")));
 }
 
+// This test checks that the backend applies the delta segment file
+// created by the incremental LFC on top of the previous lease file and
+// before the lease file copy.
+TEST_F(MemfileLeaseMgrTest, load4DeltaFile) {
+    LeaseFileIO io2("leasefile4_0.csv.2");
+    io2.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname\n"
+                  "192.0.2.2,02:02:02:02:02:02,,200,200,8,1,1,,\n"
+                  "192.0.2.3,03:03:03:03:03:03,,200,200,8,1,1,,\n"
+                  "192.0.2.11,bb:bb:bb:bb:bb:bb,,200,200,8,1,1,,\n");
+
+    // The delta segment releases the lease for 192.0.2.3 and updates
+    // the lease for 192.0.2.11.
+    LeaseFileIO iod("leasefile4_0.csv.delta");
+    iod.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname\n"
+                  "192.0.2.3,03:03:03:03:03:03,,0,200,8,1,1,,\n"
+                  "192.0.2.11,bb:bb:bb:bb:bb:bb,,200,300,8,1,1,,\n");
+
+    LeaseFileIO io1("leasefile4_0.csv.1");
+    io1.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname\n"
+                  "192.0.2.11,bb:bb:bb:bb:bb:bb,,200,400,8,1,1,,\n");
+
+    LeaseFileIO io("leasefile4_0.csv");
+    io.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                 "fqdn_fwd,fqdn_rev,hostname\n"
+                 "192.0.2.10,0a:0a:0a:0a:0a:0a,,200,200,8,1,1,,\n");
+
+    startBackend(V4);
+
+    // This lease only exists in the previous file.
+    Lease4Ptr lease = lmptr_->getLease4(IOAddress("192.0.2.2"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(0, lease->cltt_);
+
+    // This lease has been released in the delta segment.
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.3")));
+
+    // The lease file copy is loaded after the delta segment.
+    lease = lmptr_->getLease4(IOAddress("192.0.2.11"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(200, lease->cltt_);
+
+    lease = lmptr_->getLease4(IOAddress("192.0.2.10"));
+    ASSERT_TRUE(lease);
+
+    // If the incremental LFC has produced the new delta segment, it
+    // holds the leases from the delta segment and the lease file copy,
+    // so they must not be loaded.
+    LeaseMgrFactory::destroy();
+    LeaseFileIO iodc("leasefile4_0.csv.delta.completed");
+    iodc.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                   "fqdn_fwd,fqdn_rev,hostname\n"
+                   "192.0.2.3,03:03:03:03:03:03,,0,200,8,1,1,,\n"
+                   "192.0.2.11,bb:bb:bb:bb:bb:bb,,200,500,8,1,1,,\n");
+
+    startBackend(V4);
+
+    EXPECT_TRUE(lmptr_->getLease4(IOAddress("192.0.2.2")));
+    EXPECT_FALSE(lmptr_->getLease4(IOAddress("192.0.2.3")));
+
+    lease = lmptr_->getLease4(IOAddress("192.0.2.11"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(300, lease->cltt_);
+}
+
 // This test checks that backend constructor refuses to load leases from the
 // lease files if the LFC is in progress.
 TEST_F(MemfileLeaseMgrTest, load4LFCInProgress) {
@@ -1161,6 +1292,91 @@ TEST_F(MemfileLeaseMgrTest, load4LFCInProgress) {
     ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
 }
 
+// This test checks that the leases are stored in the binary lease file
+// and that the CSV files produced before the format was changed are
+// still read.
+TEST_F(MemfileLeaseMgrTest, load4BinaryFile) {
+    LeaseFileIO io2(getLeaseFilePath("leasefile4_0.csv.2"));
+    io2.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname\n"
+                  "192.0.2.2,02:02:02:02:02:02,,200,200,8,1,1,,\n");
+
+    LeaseMgr::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["file-format"] = "binary";
+
+    boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr;
+    ASSERT_NO_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)));
+    ASSERT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.2")));
+
+    HWAddrPtr hwaddr(new HWAddr(HWAddr::fromText("01:01:01:01:01:01")));
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.1"), hwaddr, 0, 0,
+                               200, 0, 0, 1000, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    lease_mgr.reset();
+
+    EXPECT_TRUE(BinaryLeaseFile::isBinary(pmap["name"]));
+
+    // Both leases are loaded after the restart.
+    ASSERT_NO_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)));
+    Lease4Ptr stored = lease_mgr->getLease4(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(stored);
+    EXPECT_TRUE(*stored == *lease);
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.2")));
+    lease_mgr.reset();
+
+    // The binary lease file can't be used in the CSV format.
+    pmap["file-format"] = "csv";
+    EXPECT_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)), DbOpenError);
+}
+
+// This test checks that the leases are stored with each of the sync
+// policies and both lease file formats.
+TEST_F(MemfileLeaseMgrTest, syncPolicy) {
+    const char* policies[] = { "write", "group" };
+    const char* formats[] = { "csv", "binary" };
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            SCOPED_TRACE(std::string(policies[i]) + " " + formats[j]);
+            LeaseMgr::ParameterMap pmap;
+            pmap["type"] = "memfile";
+            pmap["universe"] = "4";
+            pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+            pmap["file-format"] = formats[j];
+            pmap["sync-policy"] = policies[i];
+
+            boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr;
+            ASSERT_NO_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)));
+
+            HWAddrPtr hwaddr(new HWAddr(HWAddr::fromText("01:01:01:01:01:01")));
+            Lease4Ptr lease(new Lease4(IOAddress("192.0.2.1"), hwaddr, 0, 0,
+                                       200, 0, 0, 1000, 8));
+            Lease4Ptr deleted(new Lease4(IOAddress("192.0.2.2"), hwaddr, 0, 0,
+                                         200, 0, 0, 1000, 8));
+            ASSERT_TRUE(lease_mgr->addLease(lease));
+            ASSERT_TRUE(lease_mgr->addLease(deleted));
+            lease->valid_lft_ = 300;
+            ASSERT_NO_THROW(lease_mgr->updateLease4(lease));
+            ASSERT_TRUE(lease_mgr->deleteLease(IOAddress("192.0.2.2")));
+            EXPECT_FALSE(lease_mgr->deleteLease(IOAddress("192.0.2.2")));
+            lease_mgr.reset();
+
+            // The changes are read after the restart.
+            ASSERT_NO_THROW(lease_mgr.reset(new Memfile_LeaseMgr(pmap)));
+            Lease4Ptr stored = lease_mgr->getLease4(IOAddress("192.0.2.1"));
+            ASSERT_TRUE(stored);
+            EXPECT_EQ(300, stored->valid_lft_);
+            EXPECT_FALSE(lease_mgr->getLease4(IOAddress("192.0.2.2")));
+            lease_mgr.reset();
+
+            // Start with the fresh lease file for the next format.
+            removeFiles(pmap["name"]);
+        }
+    }
+}
+
 // This test checks that the backend reads DHCPv6 lease data from multiple
 // files.
 TEST_F(MemfileLeaseMgrTest, load6MultipleLeaseFiles) {
@@ -346,6 +346,12 @@ TEST_F(MySqlLeaseMgrTest, updateLease4) {
     testUpdateLease4();
 }
 
+/// @brief Checks that expired DHCPv4 leases are returned in the order
+/// of their expiration times.
+TEST_F(MySqlLeaseMgrTest, getExpiredLeases4) {
+    testGetExpiredLeases4();
+}
+
 /// @brief Check GetLease4 methods - access by Hardware Address
 TEST_F(MySqlLeaseMgrTest, getLease4HWAddr1) {
     testGetLease4HWAddr1();
@@ -408,6 +414,27 @@ TEST_F(MySqlLeaseMgrTest, getLease4ClientIdSubnetId) {
     testGetLease4ClientIdSubnetId();
 }
 
+/// @brief Checks that the leases for the HW address and client identifier
+/// are returned together.
+TEST_F(MySqlLeaseMgrTest, getClientLeases4) {
+    testGetClientLeases4();
+}
+
+/// @brief Checks that the duplicate leases for the HW address are detected.
+TEST_F(MySqlLeaseMgrTest, getClientLeases4MultipleRecords) {
+    testGetClientLeases4MultipleRecords();
+}
+
+/// @brief Checks that all leases for the subnet can be retrieved.
+TEST_F(MySqlLeaseMgrTest, getLeases4SubnetId) {
+    testGetLeases4SubnetId();
+}
+
+/// @brief Checks that the leases in the subnets are counted.
+TEST_F(MySqlLeaseMgrTest, countLeases4) {
+    testCountLeases4();
+}
+
 /// @brief Basic Lease4 Checks
 ///
 /// Checks that the addLease, getLease4(by address), getLease4(hwaddr,subnet_id),
@@ -499,6 +526,12 @@ TEST_F(MySqlLeaseMgrTest, updateLease6) {
     testUpdateLease6();
 }
 
+/// @brief Checks that expired DHCPv6 leases are returned in the order
+/// of their expiration times.
+TEST_F(MySqlLeaseMgrTest, getExpiredLeases6) {
+    testGetExpiredLeases6();
+}
+
 /// @brief DHCPv4 Lease recreation tests
 ///
 /// Checks that the lease can be created, deleted and recreated with
@@ -532,4 +565,61 @@ TEST_F(MySqlLeaseMgrTest, testLease6HWTypeAndSource) {
     testLease6HWTypeAndSource();
 }
 
+/// @brief Checks that the conflicts are reported in the write-behind mode.
+///
+/// The leases stored in the database are looked up before the addition
+/// or update is recorded, so the caller gets the same result as when the
+/// leases are written synchronously.
+TEST_F(MySqlLeaseMgrTest, writeBehindConflicts) {
+    vector<Lease4Ptr> leases4 = createLeases4();
+    vector<Lease6Ptr> leases6 = createLeases6();
+    ASSERT_TRUE(lmptr_->addLease(leases4[1]));
+    ASSERT_TRUE(lmptr_->addLease(leases6[1]));
+    lmptr_->commit();
+
+    LeaseMgrFactory::destroy();
+    LeaseMgrFactory::create(validConnectionString() + " write-behind=true");
+    lmptr_ = &(LeaseMgrFactory::instance());
+
+    // The leases stored in the database can't be added again.
+    EXPECT_FALSE(lmptr_->addLease(leases4[1]));
+    EXPECT_FALSE(lmptr_->addLease(leases6[1]));
+
+    // The leases which are neither stored nor added can't be updated.
+    EXPECT_THROW(lmptr_->updateLease4(leases4[2]), NoSuchLease);
+    EXPECT_THROW(lmptr_->updateLease6(leases6[2]), NoSuchLease);
+
+    // The stored leases can be updated.
+    leases4[1]->valid_lft_ += 100;
+    leases6[1]->valid_lft_ += 100;
+    EXPECT_NO_THROW(lmptr_->updateLease4(leases4[1]));
+    EXPECT_NO_THROW(lmptr_->updateLease6(leases6[1]));
+
+    // The added leases can be updated before they are written, but can't
+    // be added again.
+    EXPECT_TRUE(lmptr_->addLease(leases4[2]));
+    EXPECT_TRUE(lmptr_->addLease(leases6[2]));
+    EXPECT_FALSE(lmptr_->addLease(leases4[2]));
+    EXPECT_FALSE(lmptr_->addLease(leases6[2]));
+    EXPECT_NO_THROW(lmptr_->updateLease4(leases4[2]));
+    EXPECT_NO_THROW(lmptr_->updateLease6(leases6[2]));
+
+    // The same after the changes are written.
+    lmptr_->commit();
+    EXPECT_FALSE(lmptr_->addLease(leases4[2]));
+    EXPECT_FALSE(lmptr_->addLease(leases6[2]));
+    EXPECT_NO_THROW(lmptr_->updateLease4(leases4[2]));
+    EXPECT_NO_THROW(lmptr_->updateLease6(leases6[2]));
+
+    // The deleted lease can be added again, but not updated.
+    EXPECT_TRUE(lmptr_->deleteLease(leases4[1]->addr_));
+    EXPECT_THROW(lmptr_->updateLease4(leases4[1]), NoSuchLease);
+    EXPECT_TRUE(lmptr_->addLease(leases4[1]));
+    lmptr_->commit();
+
+    Lease4Ptr l_returned = lmptr_->getLease4(leases4[1]->addr_);
+    ASSERT_TRUE(l_returned);
+    detailCompareLease(leases4[1], l_returned);
+}
+
 }; // Of anonymous namespace
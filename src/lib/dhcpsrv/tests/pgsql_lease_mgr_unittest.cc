@@ -20,8 +20,11 @@
 #include <dhcpsrv/tests/test_utils.h>
 #include <dhcpsrv/tests/generic_lease_mgr_unittest.h>
 #include <exceptions/exceptions.h>
+#include <util/threads/thread.h>
 
 
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
 #include <gtest/gtest.h>
 
 #include <algorithm>
@@ -34,6 +37,7 @@ using namespace isc;
 using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::dhcp::test;
+using namespace isc::util::thread;
 using namespace std;
 
 namespace {
@@ -144,6 +148,22 @@ void createSchema() {
     PQfinish(conn);
 }
 
+/// @brief Looks up the leases by address a number of times
+///
+/// @param lease_mgr Lease manager to be used.
+/// @param leases Leases to be looked up.
+/// @param [out] found Number of leases found.
+void lookupLeases(const LeaseMgr* lease_mgr, const vector<Lease4Ptr>& leases,
+                  size_t& found) {
+    for (int i = 0; i < 10; ++i) {
+        for (size_t j = 0; j < leases.size(); ++j) {
+            if (lease_mgr->getLease4(leases[j]->addr_)) {
+                ++found;
+            }
+        }
+    }
+}
+
 /// @brief Test fixture class for testing PostgreSQL Lease Manager
 ///
 /// Opens the database prior to each test and closes it afterwards.
@@ -261,6 +281,12 @@ TEST(PgSqlOpenTest, OpenDatabase) {
         VALID_TYPE, NULL, VALID_HOST, INVALID_USER, VALID_PASSWORD)),
         NoDatabaseName);
 
+    // Check that the invalid number of connections is rejected.
+    EXPECT_THROW(LeaseMgrFactory::create(validConnectionString() +
+                                         " connections=0"), BadValue);
+    EXPECT_THROW(LeaseMgrFactory::create(validConnectionString() +
+                                         " connections=many"), BadValue);
+
     // Tidy up after the test
     destroySchema();
 }
@@ -311,6 +337,12 @@ TEST_F(PgSqlLeaseMgrTest, updateLease4) {
     testUpdateLease4();
 }
 
+/// @brief Checks that expired DHCPv4 leases are returned in the order
+/// of their expiration times.
+TEST_F(PgSqlLeaseMgrTest, getExpiredLeases4) {
+    testGetExpiredLeases4();
+}
+
 /// @brief Check GetLease4 methods - access by Hardware Address
 TEST_F(PgSqlLeaseMgrTest, getLease4HWAddr1) {
     testGetLease4HWAddr1();
@@ -373,6 +405,75 @@ TEST_F(PgSqlLeaseMgrTest, getLease4ClientIdSubnetId) {
     testGetLease4ClientIdSubnetId();
 }
 
+/// @brief Checks that the leases for the HW address and client identifier
+/// are returned together, using a single connection.
+TEST_F(PgSqlLeaseMgrTest, getClientLeases4) {
+    EXPECT_FALSE(lmptr_->concurrentClientLookups());
+    testGetClientLeases4();
+}
+
+/// @brief Checks that the leases for the HW address and client identifier
+/// are returned together, when the queries are sent over two connections.
+TEST_F(PgSqlLeaseMgrTest, getClientLeases4Concurrent) {
+    LeaseMgrFactory::destroy();
+    LeaseMgrFactory::create(validConnectionString() + " connections=2");
+    lmptr_ = &(LeaseMgrFactory::instance());
+    EXPECT_TRUE(lmptr_->concurrentClientLookups());
+    testGetClientLeases4();
+}
+
+/// @brief Checks that the duplicate leases for the HW address are detected,
+/// using a single connection.
+TEST_F(PgSqlLeaseMgrTest, getClientLeases4MultipleRecords) {
+    testGetClientLeases4MultipleRecords();
+}
+
+/// @brief Checks that the duplicate leases for the HW address are detected,
+/// when the queries are sent over two connections.
+TEST_F(PgSqlLeaseMgrTest, getClientLeases4MultipleRecordsConcurrent) {
+    LeaseMgrFactory::destroy();
+    LeaseMgrFactory::create(validConnectionString() + " connections=2");
+    lmptr_ = &(LeaseMgrFactory::instance());
+    testGetClientLeases4MultipleRecords();
+}
+
+/// @brief Checks that the leases can be retrieved by multiple threads at
+/// the same time. There are more threads than connections, so some threads
+/// must wait for a free connection.
+TEST_F(PgSqlLeaseMgrTest, concurrentLookups) {
+    LeaseMgrFactory::destroy();
+    LeaseMgrFactory::create(validConnectionString() + " connections=4");
+    lmptr_ = &(LeaseMgrFactory::instance());
+
+    vector<Lease4Ptr> leases = createLeases4();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    const size_t num_threads = 8;
+    vector<size_t> found(num_threads, 0);
+    vector<boost::shared_ptr<Thread> > threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>(
+            new Thread(boost::bind(&lookupLeases, lmptr_, boost::cref(leases),
+                                   boost::ref(found[i])))));
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        ASSERT_NO_THROW(threads[i]->wait());
+        EXPECT_EQ(10 * leases.size(), found[i]);
+    }
+}
+
+/// @brief Checks that all leases for the subnet can be retrieved.
+TEST_F(PgSqlLeaseMgrTest, getLeases4SubnetId) {
+    testGetLeases4SubnetId();
+}
+
+/// @brief Checks that the leases in the subnets are counted.
+TEST_F(PgSqlLeaseMgrTest, countLeases4) {
+    testCountLeases4();
+}
+
 /// @brief Basic Lease4 Checks
 ///
 /// Checks that the addLease, getLease4(by address), getLease4(hwaddr,subnet_id),
@@ -464,6 +565,12 @@ TEST_F(PgSqlLeaseMgrTest, updateLease6) {
     testUpdateLease6();
 }
 
+/// @brief Checks that expired DHCPv6 leases are returned in the order
+/// of their expiration times.
+TEST_F(PgSqlLeaseMgrTest, getExpiredLeases6) {
+    testGetExpiredLeases6();
+}
+
 TEST_F(PgSqlLeaseMgrTest, nullDuid) {
     testNullDuid();
 }
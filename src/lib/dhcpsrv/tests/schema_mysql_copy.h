@@ -125,6 +125,13 @@ const char* create_statement[] = {
     "UPDATE schema_version SET version=\"2\", minor=\"0\";",
     // Schema upgrade to 2.0 ends here.
 
+    // Schema upgrade to 2.1 starts here.
+    "CREATE INDEX lease4_by_expire ON lease4 (expire)",
+    "CREATE INDEX lease6_by_expire ON lease6 (expire)",
+
+    "UPDATE schema_version SET version=\"2\", minor=\"1\";",
+    // Schema upgrade to 2.1 ends here.
+
     NULL
 };
 
@@ -87,6 +87,15 @@ const char* create_statement[] = {
     "INSERT INTO schema_version VALUES (1, 0)",
     "COMMIT",
 
+    // Schema upgrade to 1.1 starts here.
+    "START TRANSACTION",
+    "CREATE INDEX lease4_by_expire ON lease4 (expire)",
+    "CREATE INDEX lease6_by_expire ON lease6 (expire)",
+
+    "UPDATE schema_version SET version = '1', minor = '1'",
+    "COMMIT",
+    // Schema upgrade to 1.1 ends here.
+
     NULL
 };
 
@@ -265,6 +265,21 @@ TEST_F(SrvConfigTest, copy) {
     OptionPtr option(new Option(Option::V6, 1000, OptionBuffer(10, 0xFF)));
     conf1.getCfgOption()->add(option, true, "dhcp6");
 
+    // Set multi-threading parameters.
+    conf1.setThreadPoolSize(4);
+    conf1.setPacketQueueSize(128);
+
+    // Set leases reclamation parameters.
+    conf1.setReclaimTimerWaitTime(10);
+    conf1.setMaxReclaimLeases(50);
+
+    // Set statistics sampling parameters.
+    conf1.setStatisticsSampleInterval(60);
+    conf1.setStatisticsMaxSamples(100);
+    conf1.setLatencyHistograms(true);
+    conf1.setLazyOptionParsing(true);
+    conf1.setAllocator("bitmap");
+
     // Make sure both configurations are different.
     ASSERT_TRUE(conf1 != conf2);
 
@@ -342,6 +357,111 @@ TEST_F(SrvConfigTest, equality) {
 
     EXPECT_TRUE(conf1 == conf2);
     EXPECT_FALSE(conf1 != conf2);
+
+    // Differ by multi-threading parameters.
+    conf1.setThreadPoolSize(4);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setThreadPoolSize(4);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    conf1.setPacketQueueSize(256);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setPacketQueueSize(256);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    // Differ by leases reclamation parameters.
+    conf1.setReclaimTimerWaitTime(10);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setReclaimTimerWaitTime(10);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    conf1.setMaxReclaimLeases(20);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setMaxReclaimLeases(20);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    // Differ by statistics sampling parameters.
+    conf1.setStatisticsSampleInterval(60);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setStatisticsSampleInterval(60);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    conf1.setStatisticsMaxSamples(5);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setStatisticsMaxSamples(5);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    conf1.setLatencyHistograms(true);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setLatencyHistograms(true);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    conf1.setLazyOptionParsing(true);
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setLazyOptionParsing(true);
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+
+    conf1.setAllocator("bitmap");
+
+    EXPECT_FALSE(conf1 == conf2);
+    EXPECT_TRUE(conf1 != conf2);
+
+    conf2.setAllocator("bitmap");
+
+    EXPECT_TRUE(conf1 == conf2);
+    EXPECT_FALSE(conf1 != conf2);
+}
+
+// This test checks that only the supported allocators can be selected.
+TEST_F(SrvConfigTest, allocator) {
+    SrvConfig conf;
+    EXPECT_EQ("iterative", conf.getAllocator());
+
+    ASSERT_NO_THROW(conf.setAllocator("bitmap"));
+    EXPECT_EQ("bitmap", conf.getAllocator());
+
+    EXPECT_THROW(conf.setAllocator("random"), isc::BadValue);
+    EXPECT_EQ("bitmap", conf.getAllocator());
 }
 
 } // end of anonymous namespace
@@ -0,0 +1,222 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include <config.h>
+#include <dhcpsrv/stats_mgr.h>
+#include <util/threads/thread.h>
+#include <gtest/gtest.h>
+
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+using namespace isc;
+using namespace isc::data;
+using namespace isc::dhcp;
+using namespace isc::util::thread;
+using namespace boost::posix_time;
+
+namespace {
+
+/// @brief Test fixture class for @c StatsMgr.
+class StatsMgrTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Removes the statistics created by other tests.
+    StatsMgrTest() {
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Removes the statistics created by the test.
+    virtual ~StatsMgrTest() {
+        StatsMgr::instance().removeAll();
+    }
+};
+
+/// @brief Increments the statistic the specified number of times.
+///
+/// @param counter Statistic to be incremented.
+/// @param count Number of increments.
+void
+increment(const StatsCounterPtr& counter, const unsigned count) {
+    for (unsigned i = 0; i < count; ++i) {
+        counter->add(1);
+    }
+}
+
+// This test verifies that the value of the statistic can be modified.
+TEST_F(StatsMgrTest, counterValue) {
+    StatsCounter counter("pkt4-received", StatsCounter::COUNTER);
+    EXPECT_EQ("pkt4-received", counter.getName());
+    EXPECT_EQ(StatsCounter::COUNTER, counter.getType());
+    EXPECT_EQ(0, counter.getValue());
+
+    counter.add(5);
+    EXPECT_EQ(5, counter.getValue());
+    counter.add(-2);
+    EXPECT_EQ(3, counter.getValue());
+    counter.set(100);
+    EXPECT_EQ(100, counter.getValue());
+}
+
+// This test verifies that resetting the counter sets its value to 0 and
+// resetting the gauge preserves its value. The history is cleared in
+// both cases.
+TEST_F(StatsMgrTest, counterReset) {
+    const ptime now = microsec_clock::universal_time();
+
+    StatsCounter counter("pkt4-received", StatsCounter::COUNTER);
+    counter.add(10);
+    counter.sample(now, 5);
+    counter.reset();
+    EXPECT_EQ(0, counter.getValue());
+    EXPECT_TRUE(counter.getSamples().empty());
+
+    StatsCounter gauge("subnet[1].assigned-addresses", StatsCounter::GAUGE);
+    gauge.set(10);
+    gauge.sample(now, 5);
+    gauge.reset();
+    EXPECT_EQ(10, gauge.getValue());
+    EXPECT_TRUE(gauge.getSamples().empty());
+}
+
+// This test verifies that the history holds the most recent samples.
+TEST_F(StatsMgrTest, counterSamples) {
+    StatsCounter counter("pkt4-received", StatsCounter::COUNTER);
+    const ptime start = microsec_clock::universal_time();
+    for (int i = 0; i < 5; ++i) {
+        counter.add(1);
+        counter.sample(start + seconds(i), 3);
+    }
+
+    StatsCounter::SampleList samples = counter.getSamples();
+    ASSERT_EQ(3, samples.size());
+    StatsCounter::SampleList::const_iterator sample = samples.begin();
+    EXPECT_EQ(5, sample->first);
+    EXPECT_EQ(start + seconds(4), sample->second);
+    ++sample;
+    EXPECT_EQ(4, sample->first);
+    ++sample;
+    EXPECT_EQ(3, sample->first);
+    EXPECT_EQ(start + seconds(2), sample->second);
+
+    // The current value is followed by the samples.
+    counter.add(1);
+    ConstElementPtr element = counter.toElement(start + seconds(5));
+    ASSERT_TRUE(element);
+    ASSERT_EQ(4, element->size());
+    EXPECT_EQ(6, element->get(0)->get(0)->intValue());
+    EXPECT_EQ(to_iso_extended_string(start + seconds(5)),
+              element->get(0)->get(1)->stringValue());
+    EXPECT_EQ(5, element->get(1)->get(0)->intValue());
+    EXPECT_EQ(3, element->get(3)->get(0)->intValue());
+}
+
+// This test verifies that the concurrent increments are not lost.
+TEST_F(StatsMgrTest, concurrentAdd) {
+    StatsCounterPtr counter = StatsMgr::instance().getCounter("pkt4-received");
+    const unsigned num_threads = 4;
+    const unsigned num_increments = 100000;
+
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>(
+            new Thread(boost::bind(&increment, counter, num_increments))));
+    }
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads[i]->wait();
+    }
+
+    EXPECT_EQ(static_cast<int64_t>(num_threads * num_increments),
+              counter->getValue());
+}
+
+// This test verifies that the statistics are created on first use and
+// can be reset and removed by name.
+TEST_F(StatsMgrTest, registry) {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    EXPECT_EQ(0, stats_mgr.count());
+
+    StatsCounterPtr received = stats_mgr.getCounter("pkt4-received");
+    ASSERT_TRUE(received);
+    EXPECT_EQ(StatsCounter::COUNTER, received->getType());
+
+    // The same statistic is returned for the same name.
+    stats_mgr.addValue("pkt4-received", 2);
+    EXPECT_EQ(received, stats_mgr.getCounter("pkt4-received"));
+    EXPECT_EQ(2, received->getValue());
+
+    const std::string assigned =
+        StatsMgr::generateName("subnet", 1, "assigned-addresses");
+    EXPECT_EQ("subnet[1].assigned-addresses", assigned);
+    stats_mgr.setValue(assigned, 7);
+    stats_mgr.addValue(assigned, -1, StatsCounter::GAUGE);
+    EXPECT_EQ(StatsCounter::GAUGE, stats_mgr.getCounter(assigned)->getType());
+    EXPECT_EQ(6, stats_mgr.getCounter(assigned)->getValue());
+    EXPECT_EQ(2, stats_mgr.count());
+
+    EXPECT_TRUE(stats_mgr.reset("pkt4-received"));
+    EXPECT_EQ(0, received->getValue());
+    EXPECT_FALSE(stats_mgr.reset("pkt4-sent"));
+
+    received->add(1);
+    stats_mgr.resetAll();
+    EXPECT_EQ(0, received->getValue());
+    EXPECT_EQ(6, stats_mgr.getCounter(assigned)->getValue());
+
+    EXPECT_TRUE(stats_mgr.remove(assigned));
+    EXPECT_FALSE(stats_mgr.remove(assigned));
+    EXPECT_EQ(1, stats_mgr.count());
+
+    stats_mgr.removeAll();
+    EXPECT_EQ(0, stats_mgr.count());
+}
+
+// This test verifies that the statistics are returned as elements and that
+// their history is recorded.
+TEST_F(StatsMgrTest, get) {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    stats_mgr.addValue("pkt4-received", 3);
+    stats_mgr.addValue("pkt4-sent", 1);
+    stats_mgr.sample(10);
+    stats_mgr.addValue("pkt4-received", 1);
+
+    ConstElementPtr stat = stats_mgr.get("pkt4-received");
+    ASSERT_TRUE(stat);
+    ASSERT_EQ(Element::map, stat->getType());
+    ASSERT_EQ(1, stat->mapValue().size());
+    ConstElementPtr values = stat->get("pkt4-received");
+    ASSERT_TRUE(values);
+    ASSERT_EQ(2, values->size());
+    EXPECT_EQ(4, values->get(0)->get(0)->intValue());
+    EXPECT_EQ(3, values->get(1)->get(0)->intValue());
+
+    stat = stats_mgr.get("pkt4-nak-sent");
+    ASSERT_TRUE(stat);
+    EXPECT_EQ(0, stat->mapValue().size());
+
+    ConstElementPtr all = stats_mgr.getAll();
+    ASSERT_TRUE(all);
+    ASSERT_EQ(2, all->mapValue().size());
+    ASSERT_TRUE(all->get("pkt4-sent"));
+    EXPECT_EQ(1, all->get("pkt4-sent")->get(0)->get(0)->intValue());
+}
+
+} // end of anonymous namespace
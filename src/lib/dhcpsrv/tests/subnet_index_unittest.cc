@@ -0,0 +1,130 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/option.h>
+#include <dhcpsrv/subnet.h>
+#include <dhcpsrv/subnet_index.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+
+namespace {
+
+// This test verifies that the subnets are found by the address in their
+// prefix and that the overlapping subnets are returned in the order in
+// which they were configured.
+TEST(SubnetIndexTest, getByAddress4) {
+    Subnet4Collection subnets;
+    subnets.push_back(Subnet4Ptr(new Subnet4(IOAddress("192.0.2.0"), 26,
+                                             1, 2, 3)));
+    subnets.push_back(Subnet4Ptr(new Subnet4(IOAddress("10.0.0.0"), 8,
+                                             1, 2, 3)));
+    subnets.push_back(Subnet4Ptr(new Subnet4(IOAddress("192.0.2.64"), 26,
+                                             1, 2, 3)));
+    // This one overlaps with the first and the third subnet.
+    subnets.push_back(Subnet4Ptr(new Subnet4(IOAddress("192.0.2.0"), 24,
+                                             1, 2, 3)));
+
+    SubnetIndex index;
+    EXPECT_FALSE(index.isBuilt());
+    index.build(subnets);
+    EXPECT_TRUE(index.isBuilt());
+
+    SubnetIndex::Positions positions;
+    index.getByAddress(IOAddress("192.0.2.1"), positions);
+    ASSERT_EQ(2, positions.size());
+    EXPECT_EQ(0, positions[0]);
+    EXPECT_EQ(3, positions[1]);
+
+    index.getByAddress(IOAddress("192.0.2.100"), positions);
+    ASSERT_EQ(2, positions.size());
+    EXPECT_EQ(2, positions[0]);
+    EXPECT_EQ(3, positions[1]);
+
+    index.getByAddress(IOAddress("192.0.2.200"), positions);
+    ASSERT_EQ(1, positions.size());
+    EXPECT_EQ(3, positions[0]);
+
+    index.getByAddress(IOAddress("10.20.30.40"), positions);
+    ASSERT_EQ(1, positions.size());
+    EXPECT_EQ(1, positions[0]);
+
+    index.getByAddress(IOAddress("192.0.3.1"), positions);
+    EXPECT_TRUE(positions.empty());
+
+    // IPv6 address doesn't match IPv4 subnets.
+    index.getByAddress(IOAddress("2001:db8:1::1"), positions);
+    EXPECT_TRUE(positions.empty());
+
+    index.clear();
+    EXPECT_FALSE(index.isBuilt());
+    index.getByAddress(IOAddress("192.0.2.1"), positions);
+    EXPECT_TRUE(positions.empty());
+}
+
+// This test verifies that the subnets are found by relay address,
+// interface name and interface id.
+TEST(SubnetIndexTest, getByRelayIfaceInterfaceId) {
+    Subnet6Collection subnets;
+    for (int i = 0; i < 3; ++i) {
+        std::ostringstream prefix;
+        prefix << "2001:db8:" << i + 1 << "::";
+        subnets.push_back(Subnet6Ptr(new Subnet6(IOAddress(prefix.str()), 64,
+                                                 1, 2, 3, 4)));
+    }
+    subnets[0]->setRelayInfo(IOAddress("2001:db8:ff::1"));
+    subnets[2]->setRelayInfo(IOAddress("2001:db8:ff::1"));
+    subnets[1]->setIface("eth0");
+
+    OptionBuffer data(4, 1);
+    subnets[2]->setInterfaceId(OptionPtr(new Option(Option::V6,
+                                                    D6O_INTERFACE_ID, data)));
+
+    SubnetIndex index;
+    index.build(subnets);
+
+    const SubnetIndex::Positions& relays =
+        index.getByRelay(IOAddress("2001:db8:ff::1"));
+    ASSERT_EQ(2, relays.size());
+    EXPECT_EQ(0, relays[0]);
+    EXPECT_EQ(2, relays[1]);
+    EXPECT_TRUE(index.getByRelay(IOAddress("2001:db8:ff::2")).empty());
+    // Subnets without relay address are not indexed.
+    EXPECT_TRUE(index.getByRelay(IOAddress("::")).empty());
+
+    ASSERT_EQ(1, index.getByIface("eth0").size());
+    EXPECT_EQ(1, index.getByIface("eth0")[0]);
+    EXPECT_TRUE(index.getByIface("eth1").empty());
+
+    OptionPtr interface_id(new Option(Option::V6, D6O_INTERFACE_ID, data));
+    ASSERT_EQ(1, index.getByInterfaceId(interface_id).size());
+    EXPECT_EQ(2, index.getByInterfaceId(interface_id)[0]);
+    interface_id.reset(new Option(Option::V6, D6O_INTERFACE_ID,
+                                  OptionBuffer(4, 2)));
+    EXPECT_TRUE(index.getByInterfaceId(interface_id).empty());
+    EXPECT_TRUE(index.getByInterfaceId(OptionPtr()).empty());
+
+    SubnetIndex::Positions positions;
+    index.getByAddress(IOAddress("2001:db8:2::10"), positions);
+    ASSERT_EQ(1, positions.size());
+    EXPECT_EQ(1, positions[0]);
+}
+
+} // end of anonymous namespace
@@ -23,6 +23,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 #include <limits>
+#include <vector>
 
 // don't import the entire boost namespace.  It will unexpectedly hide uint8_t
 // for some systems.
@@ -174,6 +175,63 @@ TEST(Subnet4Test, getCapacity) {
     EXPECT_EQ(196, subnet->getPoolCapacity(Lease::TYPE_V4));
 }
 
+// Check that the pools are found when there are many pools, added in
+// random order, and that the capacity is updated when the pools are
+// deleted.
+TEST(Subnet4Test, manyPools) {
+    Subnet4Ptr subnet(new Subnet4(IOAddress("10.0.0.0"), 16, 1, 2, 3));
+
+    // Add 256 /28 pools, every other one in the 10.0.0.0/19 range.
+    const uint32_t base = static_cast<uint32_t>(IOAddress("10.0.0.0"));
+    std::vector<PoolPtr> pools;
+    for (uint32_t i = 0; i < 256; ++i) {
+        // 167 is coprime with 256, so all pools are added in mixed order.
+        uint32_t index = (i * 167) % 256;
+        PoolPtr pool(new Pool4(IOAddress(base + index * 32), 28));
+        subnet->addPool(pool);
+        pools.push_back(pool);
+    }
+    EXPECT_EQ(256 * 16, subnet->getPoolCapacity(Lease::TYPE_V4));
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t index = (i * 167) % 256;
+        IOAddress addr(base + index * 32 + 15);
+        EXPECT_TRUE(subnet->inPool(Lease::TYPE_V4, addr));
+        EXPECT_EQ(pools[i], subnet->getPool(Lease::TYPE_V4, addr, false));
+
+        // The gaps between the pools don't belong to any pool.
+        addr = IOAddress(base + index * 32 + 16);
+        EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, addr));
+        EXPECT_FALSE(subnet->getPool(Lease::TYPE_V4, addr, false));
+
+        // The first pool added is returned when anypool is requested.
+        EXPECT_EQ(pools[0], subnet->getPool(Lease::TYPE_V4, addr));
+    }
+    EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, IOAddress("10.0.255.1")));
+
+    subnet->delPools(Lease::TYPE_V4);
+    EXPECT_EQ(0, subnet->getPoolCapacity(Lease::TYPE_V4));
+    EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, IOAddress("10.0.0.1")));
+    EXPECT_FALSE(subnet->getPool(Lease::TYPE_V4, IOAddress("10.0.0.1")));
+}
+
+// Check that the first added pool is returned when the pools overlap.
+TEST(Subnet4Test, overlappingPools) {
+    Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3));
+
+    PoolPtr pool1(new Pool4(IOAddress("192.0.2.64"), IOAddress("192.0.2.127")));
+    PoolPtr pool2(new Pool4(IOAddress("192.0.2.0"), IOAddress("192.0.2.255")));
+    PoolPtr pool3(new Pool4(IOAddress("192.0.2.100"), IOAddress("192.0.2.200")));
+    subnet->addPool(pool1);
+    subnet->addPool(pool2);
+    subnet->addPool(pool3);
+
+    EXPECT_EQ(pool1, subnet->getPool(Lease::TYPE_V4, IOAddress("192.0.2.110")));
+    EXPECT_EQ(pool2, subnet->getPool(Lease::TYPE_V4, IOAddress("192.0.2.150")));
+    EXPECT_EQ(pool2, subnet->getPool(Lease::TYPE_V4, IOAddress("192.0.2.10")));
+    EXPECT_TRUE(subnet->inPool(Lease::TYPE_V4, IOAddress("192.0.2.255")));
+}
+
 TEST(Subnet4Test, Subnet4_Pool4_checks) {
 
     Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 8, 1, 2, 3));
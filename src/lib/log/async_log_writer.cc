@@ -0,0 +1,329 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <log/async_log_writer.h>
+#include <log/log_formatter.h>
+#include <log/log_messages.h>
+#include <log/logger_impl.h>
+#include <log/logger_manager.h>
+#include <log/logger_name.h>
+#include <log/message_dictionary.h>
+#include <log/interprocess/interprocess_sync_file.h>
+#include <log/interprocess/interprocess_sync_null.h>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <log4cplus/loggingmacros.h>
+
+#include <sched.h>
+
+using namespace isc::util::thread;
+
+namespace {
+
+/// Maximum number of messages written under a single lock.
+const size_t MAX_BATCH_SIZE = 256;
+
+/// Time (in milliseconds) after which the idle background thread checks
+/// the queue, even if it hasn't been woken up.
+const unsigned long IDLE_WAIT_TIME = 100;
+
+}
+
+namespace isc {
+namespace log {
+
+AsyncLogWriter&
+AsyncLogWriter::instance() {
+    static AsyncLogWriter writer;
+    return (writer);
+}
+
+AsyncLogWriter::AsyncLogWriter()
+    : slots_(), mask_(0), enqueue_pos_(0), dequeue_pos_(0), policy_(BLOCK),
+      running_(false), stopping_(false), producers_(0), waiting_(0),
+      dropped_(0), dropped_total_(0) {
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+    try {
+        stop();
+    } catch (...) {
+        // Nothing to do at exit.
+    }
+}
+
+AsyncLogWriter::OverflowPolicy
+AsyncLogWriter::overflowPolicyFromText(const std::string& name) {
+    if (name == "block") {
+        return (BLOCK);
+    } else if (name == "drop") {
+        return (DROP);
+    } else if (name == "count") {
+        return (COUNT);
+    }
+    isc_throw(BadValue, "unsupported overflow policy '" << name
+              << "', expected block, drop or count");
+}
+
+std::string
+AsyncLogWriter::overflowPolicyToText(const OverflowPolicy policy) {
+    switch (policy) {
+    case DROP:
+        return ("drop");
+    case COUNT:
+        return ("count");
+    default:
+        ;
+    }
+    return ("block");
+}
+
+void
+AsyncLogWriter::start(const size_t queue_size, const OverflowPolicy policy) {
+    if (queue_size == 0) {
+        isc_throw(BadValue, "size of the asynchronous logging queue must"
+                  " be greater than 0");
+    }
+    stop();
+
+    // The positions are mapped to the slots with a mask.
+    size_t size = 1;
+    while (size < queue_size) {
+        size <<= 1;
+    }
+    slots_ = std::vector<Slot>(size);
+    for (size_t i = 0; i < size; ++i) {
+        slots_[i].sequence_ = i;
+    }
+    mask_ = size - 1;
+    enqueue_pos_ = 0;
+    dequeue_pos_ = 0;
+    policy_ = policy;
+    dropped_ = 0;
+    dropped_total_ = 0;
+    stopping_ = false;
+
+    if (lockfileEnabled()) {
+        sync_.reset(new interprocess::InterprocessSyncFile("logger"));
+    } else {
+        sync_.reset(new interprocess::InterprocessSyncNull("logger"));
+    }
+
+    thread_.reset(new Thread(boost::bind(&AsyncLogWriter::run, this)));
+    __sync_synchronize();
+    running_ = true;
+}
+
+void
+AsyncLogWriter::stop() {
+    if (!thread_) {
+        return;
+    }
+
+    // Don't accept new messages and let the threads which are putting
+    // messages into the queue finish. The background thread keeps
+    // taking the messages, so the blocked threads get room.
+    running_ = false;
+    __sync_synchronize();
+    while (__sync_fetch_and_add(&producers_, 0) != 0) {
+        sched_yield();
+    }
+
+    stopping_ = true;
+    __sync_synchronize();
+    {
+        Mutex::Locker locker(mutex_);
+        cond_.signal();
+    }
+    thread_->wait();
+    thread_.reset();
+}
+
+bool
+AsyncLogWriter::push(const std::string& logger, const Severity& severity,
+                     std::string& message) {
+    __sync_fetch_and_add(&producers_, 1);
+    if (!running_) {
+        __sync_fetch_and_sub(&producers_, 1);
+        return (false);
+    }
+
+    // Claim a free slot.
+    size_t pos = __sync_fetch_and_add(&enqueue_pos_, 0);
+    Slot* slot = 0;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        const size_t sequence = slot->sequence_;
+        __sync_synchronize();
+        const intptr_t diff = static_cast<intptr_t>(sequence) -
+            static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (__sync_bool_compare_and_swap(&enqueue_pos_, pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The queue is full.
+            if (policy_ != BLOCK) {
+                __sync_fetch_and_add(&dropped_, 1);
+                __sync_fetch_and_add(&dropped_total_, 1);
+                __sync_fetch_and_sub(&producers_, 1);
+                return (true);
+            }
+            notify();
+            sched_yield();
+        }
+        pos = __sync_fetch_and_add(&enqueue_pos_, 0);
+    }
+
+    slot->severity_ = severity;
+    slot->logger_ = logger;
+    slot->message_.swap(message);
+
+    // Publish the message when the slot has been filled.
+    __sync_synchronize();
+    slot->sequence_ = pos + 1;
+    __sync_synchronize();
+
+    notify();
+    __sync_fetch_and_sub(&producers_, 1);
+    return (true);
+}
+
+void
+AsyncLogWriter::notify() {
+    if (__sync_fetch_and_add(&waiting_, 0) != 0) {
+        Mutex::Locker locker(mutex_);
+        cond_.signal();
+    }
+}
+
+size_t
+AsyncLogWriter::take(std::vector<Slot>& batch) {
+    size_t count = 0;
+    while (count < batch.size()) {
+        Slot& slot = slots_[dequeue_pos_ & mask_];
+        const size_t sequence = slot.sequence_;
+        __sync_synchronize();
+        if (sequence != dequeue_pos_ + 1) {
+            break;
+        }
+        batch[count].severity_ = slot.severity_;
+        batch[count].logger_.swap(slot.logger_);
+        batch[count].message_.swap(slot.message_);
+        ++count;
+
+        // Hand the slot back to the producers when it has been emptied.
+        __sync_synchronize();
+        slot.sequence_ = dequeue_pos_ + mask_ + 1;
+        ++dequeue_pos_;
+    }
+    return (count);
+}
+
+void
+AsyncLogWriter::write(const std::vector<Slot>& batch, const size_t count) {
+    Mutex::Locker mutex_locker(LoggerManager::getMutex());
+    interprocess::InterprocessSyncLocker locker(*sync_);
+    const bool locked = locker.lock();
+
+    for (size_t i = 0; i < count; ++i) {
+        log4cplus::Logger logger =
+            log4cplus::Logger::getInstance(batch[i].logger_);
+        if (!locked && (i == 0)) {
+            LOG4CPLUS_ERROR(logger, "Unable to lock logger lockfile");
+        }
+        const std::string& message = batch[i].message_;
+        switch (batch[i].severity_) {
+        case DEBUG:
+            LOG4CPLUS_DEBUG(logger, message);
+            break;
+
+        case INFO:
+            LOG4CPLUS_INFO(logger, message);
+            break;
+
+        case WARN:
+            LOG4CPLUS_WARN(logger, message);
+            break;
+
+        case ERROR:
+            LOG4CPLUS_ERROR(logger, message);
+            break;
+
+        case FATAL:
+            LOG4CPLUS_FATAL(logger, message);
+            break;
+
+        default:
+            ;
+        }
+    }
+
+    if (locked && !locker.unlock()) {
+        LOG4CPLUS_ERROR(log4cplus::Logger::getInstance(getRootLoggerName()),
+                        "Unable to unlock logger lockfile");
+    }
+}
+
+void
+AsyncLogWriter::reportDropped() {
+    if (policy_ != COUNT) {
+        return;
+    }
+    const uint64_t dropped = __sync_fetch_and_and(&dropped_, 0);
+    if (dropped == 0) {
+        return;
+    }
+
+    std::vector<Slot> report(1);
+    report[0].severity_ = WARN;
+    report[0].logger_ = getRootLoggerName();
+    report[0].message_ = std::string(LOG_ASYNC_MESSAGES_DROPPED) + " " +
+        MessageDictionary::globalDictionary().getText(LOG_ASYNC_MESSAGES_DROPPED);
+    replacePlaceholder(&report[0].message_,
+                       boost::lexical_cast<std::string>(dropped), 1);
+    write(report, 1);
+}
+
+void
+AsyncLogWriter::run() {
+    std::vector<Slot> batch(MAX_BATCH_SIZE);
+    for (;;) {
+        size_t count = take(batch);
+        if (count > 0) {
+            write(batch, count);
+            reportDropped();
+            continue;
+        }
+
+        // The queue is empty. Exit if asked to, otherwise wait for the
+        // messages. The flag is set before checking the queue again, so
+        // a producer publishing a message at the same time sees it.
+        if (stopping_) {
+            break;
+        }
+        Mutex::Locker locker(mutex_);
+        __sync_fetch_and_or(&waiting_, 1);
+        const Slot& slot = slots_[dequeue_pos_ & mask_];
+        if ((slot.sequence_ != dequeue_pos_ + 1) && !stopping_) {
+            cond_.timedWait(mutex_, IDLE_WAIT_TIME);
+        }
+        __sync_fetch_and_and(&waiting_, 0);
+    }
+    reportDropped();
+}
+
+} // namespace log
+} // namespace isc
@@ -0,0 +1,231 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef ASYNC_LOG_WRITER_H
+#define ASYNC_LOG_WRITER_H
+
+#include <log/logger_level.h>
+#include <log/interprocess/interprocess_sync.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace log {
+
+/// \brief Writes the log messages in a background thread.
+///
+/// When the asynchronous logging is enabled, \c LoggerImpl::outputRaw
+/// doesn't write the formatted message itself. It puts the message into a
+/// bounded lock-free queue and returns. The background thread takes the
+/// messages from the queue in batches and writes them with log4cplus. The
+/// logger mutex and the lockfile are taken once per batch rather than once
+/// per message, so the threads processing packets don't wait for the
+/// output.
+///
+/// The queue is a ring of slots with sequence numbers, so multiple threads
+/// may put the messages into it without locking. When the queue is full,
+/// the configured overflow policy applies:
+/// - \c BLOCK - the logging thread waits until there is room in the queue,
+/// - \c DROP - the message is dropped,
+/// - \c COUNT - the message is dropped and the background thread logs the
+///   number of dropped messages when there is room in the queue again.
+///
+/// The time of a message is the time when it is written, which may be
+/// slightly later than the time when it has been logged.
+class AsyncLogWriter : public boost::noncopyable {
+public:
+
+    /// \brief Policy applied when the queue is full.
+    enum OverflowPolicy {
+        BLOCK,
+        DROP,
+        COUNT
+    };
+
+    /// \brief Default maximum number of the messages in the queue.
+    static const size_t DEFAULT_QUEUE_SIZE = 4096;
+
+    /// \brief Returns the sole instance of the writer.
+    static AsyncLogWriter& instance();
+
+    /// \brief Starts the background thread.
+    ///
+    /// If the writer is already running, it is stopped first, so as the
+    /// queued messages are written before the queue is replaced.
+    ///
+    /// \param queue_size Maximum number of the messages in the queue. It
+    /// is rounded up to a power of two.
+    /// \param policy Policy applied when the queue is full.
+    ///
+    /// \throw isc::BadValue if the queue size is 0.
+    void start(const size_t queue_size = DEFAULT_QUEUE_SIZE,
+               const OverflowPolicy policy = BLOCK);
+
+    /// \brief Writes the queued messages and stops the background thread.
+    ///
+    /// The messages logged after this call are written synchronously.
+    void stop();
+
+    /// \brief Checks if the background thread is running.
+    bool isRunning() const {
+        return (running_);
+    }
+
+    /// \brief Puts the message into the queue.
+    ///
+    /// \param logger Name of the log4cplus logger writing the message.
+    /// \param severity Severity of the message.
+    /// \param message Text of the message. The contents are moved to the
+    /// queue, so the string is cleared on success.
+    ///
+    /// \return false if the writer is not running, in which case the
+    /// caller should write the message itself. Dropped messages are
+    /// reported as handled.
+    bool push(const std::string& logger, const Severity& severity,
+              std::string& message);
+
+    /// \brief Returns the overflow policy.
+    OverflowPolicy getOverflowPolicy() const {
+        return (policy_);
+    }
+
+    /// \brief Returns the capacity of the queue.
+    size_t getQueueSize() const {
+        return (slots_.size());
+    }
+
+    /// \brief Returns the number of messages dropped since the start.
+    uint64_t getDroppedCount() const {
+        return (__sync_fetch_and_add(const_cast<uint64_t*>(&dropped_total_),
+                                     0));
+    }
+
+    /// \brief Converts the overflow policy name to the policy.
+    ///
+    /// \param name "block", "drop" or "count".
+    ///
+    /// \throw isc::BadValue if the name is not recognized.
+    static OverflowPolicy overflowPolicyFromText(const std::string& name);
+
+    /// \brief Converts the overflow policy to its name.
+    static std::string overflowPolicyToText(const OverflowPolicy policy);
+
+private:
+
+    /// \brief A slot of the queue.
+    struct Slot {
+        /// \brief Constructor.
+        Slot() : sequence_(0), severity_(INFO) {
+        }
+
+        /// \brief Sequence number telling if the slot is free or holds
+        /// a message for the given position in the queue.
+        volatile size_t sequence_;
+        /// \brief Severity of the message.
+        Severity severity_;
+        /// \brief Name of the log4cplus logger.
+        std::string logger_;
+        /// \brief Text of the message.
+        std::string message_;
+    };
+
+    /// \brief Constructor.
+    AsyncLogWriter();
+
+    /// \brief Destructor.
+    ///
+    /// Writes the queued messages.
+    ~AsyncLogWriter();
+
+    /// \brief Takes the ready messages from the queue.
+    ///
+    /// \param [out] batch Vector to which the messages are moved. At most
+    /// as many messages as its size are taken.
+    ///
+    /// \return Number of messages taken.
+    size_t take(std::vector<Slot>& batch);
+
+    /// \brief Writes the messages with log4cplus.
+    ///
+    /// \param batch Messages to be written.
+    /// \param count Number of messages to be written.
+    void write(const std::vector<Slot>& batch, const size_t count);
+
+    /// \brief Logs the number of dropped messages if the policy is
+    /// \c COUNT.
+    void reportDropped();
+
+    /// \brief Wakes up the background thread if it waits for messages.
+    void notify();
+
+    /// \brief Main function of the background thread.
+    void run();
+
+    /// \brief Slots of the queue.
+    std::vector<Slot> slots_;
+
+    /// \brief Mask giving the slot index of a queue position.
+    size_t mask_;
+
+    /// \brief Position of the next message to be put into the queue.
+    volatile size_t enqueue_pos_;
+
+    /// \brief Position of the next message to be taken from the queue.
+    size_t dequeue_pos_;
+
+    /// \brief Overflow policy.
+    OverflowPolicy policy_;
+
+    /// \brief Indicates that the messages should be put into the queue.
+    volatile bool running_;
+
+    /// \brief Indicates that the background thread should exit when the
+    /// queue is empty.
+    volatile bool stopping_;
+
+    /// \brief Number of the threads putting a message into the queue.
+    volatile uint32_t producers_;
+
+    /// \brief Indicates that the background thread waits for messages.
+    volatile uint32_t waiting_;
+
+    /// \brief Number of messages dropped since last report.
+    volatile uint64_t dropped_;
+
+    /// \brief Number of messages dropped since the start.
+    volatile uint64_t dropped_total_;
+
+    /// \brief Mutex used to wait for the messages.
+    isc::util::thread::Mutex mutex_;
+
+    /// \brief Condition variable signalled when a message is queued.
+    isc::util::thread::CondVar cond_;
+
+    /// \brief Lockfile synchronizing the output with other processes.
+    boost::scoped_ptr<interprocess::InterprocessSync> sync_;
+
+    /// \brief Background thread.
+    boost::scoped_ptr<isc::util::thread::Thread> thread_;
+};
+
+} // namespace log
+} // namespace isc
+
+#endif // ASYNC_LOG_WRITER_H
@@ -0,0 +1,120 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <log/async_log_writer.h>
+#include <log/log_messages.h>
+#include <log/logger_manager.h>
+#include <log/logger_specification.h>
+#include <log/logger_support.h>
+#include <log/macros.h>
+#include <log/output_option.h>
+#include <util/threads/thread.h>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <iostream>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+
+using namespace isc::log;
+using namespace isc::util::thread;
+using namespace std;
+
+namespace {
+
+/// \brief Logs the given number of messages.
+void
+logMessages(const int count) {
+    Logger logger("bench");
+    for (int i = 0; i < count; ++i) {
+        LOG_INFO(logger, LOG_NO_SUCH_MESSAGE).arg(i);
+    }
+}
+
+/// \brief Returns current time in seconds.
+double
+now() {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return (tv.tv_sec + tv.tv_usec / 1000000.0);
+}
+
+/// \brief Logs the messages from the threads and returns the rate.
+///
+/// The time includes writing the messages queued by the asynchronous
+/// writer, so as the rates are comparable.
+double
+run(const int threads, const int count, const bool async) {
+    if (async) {
+        AsyncLogWriter::instance().start();
+    }
+    const double start = now();
+    vector<boost::shared_ptr<Thread> > workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(boost::shared_ptr<Thread>
+                          (new Thread(boost::bind(&logMessages, count))));
+    }
+    for (int i = 0; i < threads; ++i) {
+        workers[i]->wait();
+    }
+    const double latency = now() - start;
+    AsyncLogWriter::instance().stop();
+    const double elapsed = now() - start;
+    if (async) {
+        cout << "  time spent in the logging threads: " << latency << "s\n";
+    }
+    return (threads * count / elapsed);
+}
+
+}
+
+/// \brief Logging throughput benchmark
+///
+/// Logs the messages to a file from a number of threads, first writing
+/// them synchronously and then with the asynchronous writer, and prints
+/// the number of messages written per second in both modes.
+///
+/// Usage: async_log_bench [file [threads [messages]]]
+///
+/// By default 100000 messages are logged by each of 4 threads to
+/// /dev/null.
+int
+main(int argc, char** argv) {
+    const string filename = (argc > 1 ? argv[1] : "/dev/null");
+    const int threads = (argc > 2 ? atoi(argv[2]) : 4);
+    const int count = (argc > 3 ? atoi(argv[3]) : 100000);
+    if ((threads <= 0) || (count <= 0)) {
+        cerr << "usage: " << argv[0] << " [file [threads [messages]]]\n";
+        return (1);
+    }
+
+    initLogger();
+    OutputOption option;
+    option.destination = OutputOption::DEST_FILE;
+    option.filename = filename;
+    LoggerSpecification spec("bench");
+    spec.addOutputOption(option);
+    LoggerManager manager;
+    manager.process(spec);
+
+    cout << threads << " threads, " << count << " messages each\n";
+    cout << "synchronous: " << run(threads, count, false)
+         << " messages/s\n";
+    const double rate = run(threads, count, true);
+    cout << "asynchronous: " << rate << " messages/s\n";
+
+    return (0);
+}
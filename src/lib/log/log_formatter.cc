@@ -16,6 +16,7 @@
 #include <log/log_formatter.h>
 
 #include <cassert>
+#include <cstring>
 
 #ifdef ENABLE_LOGGER_CHECKS
 #include <iostream>
@@ -24,6 +25,63 @@
 using namespace std;
 using namespace boost;
 
+namespace {
+
+/// \brief Parses the number of the placeholder
+///
+/// \param text Message text.
+/// \param [in,out] pos Position of the '%' character on input, position
+///     following the placeholder on output.
+///
+/// \return Number of the placeholder, or 0 if there is no number
+///     following the '%'.
+unsigned
+parsePlaceholder(const string& text, size_t& pos) {
+    unsigned placeholder = 0;
+    for (++pos; (pos < text.size()) && (text[pos] >= '0') &&
+             (text[pos] <= '9'); ++pos) {
+        placeholder = placeholder * 10 + (text[pos] - '0');
+    }
+    return (placeholder);
+}
+
+/// \brief Appends the decimal representation of the number
+void
+appendNumber(string& output, uint64_t value) {
+    char digits[20];
+    size_t pos = sizeof(digits);
+    do {
+        digits[--pos] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    output.append(digits + pos, sizeof(digits) - pos);
+}
+
+/// \brief Appends the captured argument
+void
+appendArg(string& output, const isc::log::FormatterArg& arg,
+          const char* buffer) {
+    switch (arg.type_) {
+    case isc::log::FormatterArg::SIGNED:
+        if (static_cast<int64_t>(arg.value_) < 0) {
+            output.push_back('-');
+            appendNumber(output, 0 - arg.value_);
+        } else {
+            appendNumber(output, arg.value_);
+        }
+        break;
+
+    case isc::log::FormatterArg::UNSIGNED:
+        appendNumber(output, arg.value_);
+        break;
+
+    default:
+        output.append(buffer + arg.value_, arg.length_);
+    }
+}
+
+}
+
 namespace isc {
 namespace log {
 
@@ -53,6 +111,78 @@ replacePlaceholder(string* message, const string& arg,
 #endif /* ENABLE_LOGGER_CHECKS */
 }
 
+void
+checkPlaceholder(const string& text, const unsigned placeholder) {
+#ifdef ENABLE_LOGGER_CHECKS
+    for (size_t pos = text.find('%'); pos != string::npos;
+         pos = text.find('%', pos)) {
+        if (parsePlaceholder(text, pos) == placeholder) {
+            return;
+        }
+    }
+    // We're missing the placeholder, so throw an exception
+    isc_throw(MismatchedPlaceholders,
+              "Missing logger placeholder in message: " << text);
+#else
+    static_cast<void>(text);
+    static_cast<void>(placeholder);
+#endif /* ENABLE_LOGGER_CHECKS */
+}
+
+void
+renderMessage(string& output, const MessageID& ident, const string& text,
+              const FormatterArg* args, const unsigned count,
+              const char* buffer, const bool complete)
+{
+    const size_t ident_length = strlen(ident);
+    output.reserve(output.size() + ident_length + text.size() + 64);
+    output.append(ident, ident_length);
+    output.push_back(' ');
+
+    // Replace the placeholders in one pass, remembering which arguments
+    // have been used.
+    unsigned used = 0;
+    bool excess = false;
+    size_t start = 0;
+    for (size_t pos = text.find('%'); pos != string::npos;
+         pos = text.find('%', pos)) {
+        const size_t mark = pos;
+        const unsigned placeholder = parsePlaceholder(text, pos);
+        if ((placeholder == 0) || (placeholder > count)) {
+            excess = excess || (placeholder == count + 1);
+            continue;
+        }
+        output.append(text, start, mark - start);
+        appendArg(output, args[placeholder - 1], buffer);
+        used |= 1 << (placeholder - 1);
+        start = pos;
+    }
+    output.append(text, start, string::npos);
+
+    // The missing placeholders are reported in the order of the arguments.
+    // If the logger checks are enabled, the formatter has thrown already.
+    for (unsigned i = 0; i < count; ++i) {
+        if ((used & (1 << i)) == 0) {
+            output.append(" @@Missing placeholder %");
+            appendNumber(output, i + 1);
+            output.append(" for '");
+            appendArg(output, args[i], buffer);
+            output.append("'@@");
+        }
+    }
+
+    if (complete && excess) {
+#ifdef ENABLE_LOGGER_CHECKS
+        // Make sure we print the message so we can identify which
+        // identifier has the problem.
+        cerr << "Message " << output << endl;
+        assert("Excess logger placeholders still exist in message" == NULL);
+#else
+        output.append(" @@Excess logger placeholders still exist@@");
+#endif /* ENABLE_LOGGER_CHECKS */
+    }
+}
+
 void
 checkExcessPlaceholders(string* message, unsigned int placeholder) {
     const string mark("%" + lexical_cast<string>(placeholder));
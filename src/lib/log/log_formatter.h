@@ -16,12 +16,19 @@
 #define LOG_FORMATTER_H
 
 #include <cstddef>
+#include <cstring>
 #include <string>
 #include <iostream>
+#include <stdint.h>
 
 #include <exceptions/exceptions.h>
 #include <boost/lexical_cast.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/is_signed.hpp>
 #include <log/logger_level.h>
+#include <log/message_types.h>
 
 namespace isc {
 namespace log {
@@ -70,6 +77,61 @@ void
 replacePlaceholder(std::string* message, const std::string& replacement,
                    const unsigned placeholder);
 
+///
+/// \brief Argument captured by the formatter
+///
+/// Integer arguments are kept by value and text arguments are kept in the
+/// buffer of the formatter, until the message is output.
+struct FormatterArg {
+    /// \brief Type of the argument
+    enum Type {
+        SIGNED,
+        UNSIGNED,
+        TEXT
+    };
+
+    /// \brief Type of the argument
+    Type type_;
+
+    /// \brief Value of an integer, or offset of the text in the buffer
+    uint64_t value_;
+
+    /// \brief Length of the text
+    size_t length_;
+};
+
+///
+/// \brief Internal placeholder checker
+///
+/// This is used internally by the Formatter when an argument is captured.
+/// If the logger checks are compiled in, it throws MismatchedPlaceholders
+/// when the message text has no placeholder for the argument. Otherwise
+/// it does nothing.
+void
+checkPlaceholder(const std::string& text, const unsigned placeholder);
+
+///
+/// \brief The internal rendering routine
+///
+/// This is used internally by the Formatter. Appends the message ID and
+/// the text to the output, replacing the placeholders by the captured
+/// arguments in a single pass. The arguments are not searched for the
+/// placeholders.
+///
+/// \param output String to which the message is appended.
+/// \param ident Message ID.
+/// \param text Message text with the placeholders.
+/// \param args Captured arguments.
+/// \param count Number of the captured arguments.
+/// \param buffer Buffer holding the text arguments.
+/// \param complete If false, the message is rendered to capture further
+///     arguments, so the placeholders beyond the captured arguments aren't
+///     reported as excess.
+void
+renderMessage(std::string& output, const MessageID& ident,
+              const std::string& text, const FormatterArg* args,
+              const unsigned count, const char* buffer, const bool complete);
+
 ///
 /// \brief The log message formatter
 ///
@@ -92,6 +154,15 @@ replacePlaceholder(std::string* message, const std::string& replacement,
 /// Of course, if the logging is turned off, we don't bother with any replacing
 /// and just return.
 ///
+/// When the formatter is created with the message ID and the text from
+/// the dictionary, the arguments are not formatted as they are passed.
+/// Integers are captured by value and the text arguments are copied into a
+/// small buffer held by the formatter. The message is rendered in a single
+/// pass over the text when the formatter is destroyed. Only when there are
+/// more arguments or more text than the formatter can hold, the message is
+/// rendered into a string and the remaining placeholders are replaced one
+/// by one.
+///
 /// User of logging code should not really care much about this class, only
 /// call the .arg method to generate the correct output.
 ///
@@ -118,11 +189,134 @@ private:
     Severity severity_;
 
     /// \brief The messages with %1, %2... placeholders
+    ///
+    /// NULL if the arguments are captured.
     std::string* message_;
 
     /// \brief Which will be the next placeholder to replace
     unsigned nextPlaceholder_;
 
+    /// \brief Maximum number of the captured arguments
+    static const unsigned MAX_ARGS = 8;
+
+    /// \brief Size of the buffer holding the text arguments
+    static const size_t BUFFER_SIZE = 256;
+
+    /// \brief The message ID
+    MessageID ident_;
+
+    /// \brief The message text with %1, %2... placeholders
+    ///
+    /// It is not owned by the formatter.
+    const std::string* text_;
+
+    /// \brief The captured arguments
+    FormatterArg args_[MAX_ARGS];
+
+    /// \brief Buffer holding the text arguments
+    char buffer_[BUFFER_SIZE];
+
+    /// \brief Number of bytes used in the buffer
+    size_t bufferUsed_;
+
+    /// \brief Copies the captured arguments from other formatter
+    void copyArgs(const Formatter& other) {
+        ident_ = other.ident_;
+        text_ = other.text_;
+        bufferUsed_ = other.bufferUsed_;
+        if (logger_ && !message_) {
+            std::memcpy(args_, other.args_,
+                        sizeof(FormatterArg) * nextPlaceholder_);
+            std::memcpy(buffer_, other.buffer_, bufferUsed_);
+        }
+    }
+
+    /// \brief Captures an integer argument
+    template<class Arg> Formatter& captureArg(const Arg& value,
+                                              const boost::true_type&) {
+        if (message_ || (nextPlaceholder_ >= MAX_ARGS)) {
+            // An integer is always converted.
+            return (arg(boost::lexical_cast<std::string>(value)));
+        }
+        try {
+            checkPlaceholder(*text_, nextPlaceholder_ + 1);
+        } catch (...) {
+            deactivate();
+            throw;
+        }
+        FormatterArg& captured = args_[nextPlaceholder_++];
+        if (boost::is_signed<Arg>::value) {
+            captured.type_ = FormatterArg::SIGNED;
+            captured.value_ =
+                static_cast<uint64_t>(static_cast<int64_t>(value));
+        } else {
+            captured.type_ = FormatterArg::UNSIGNED;
+            captured.value_ = static_cast<uint64_t>(value);
+        }
+        return (*this);
+    }
+
+    /// \brief Converts other argument to text
+    template<class Arg> Formatter& captureArg(const Arg& value,
+                                              const boost::false_type&) {
+        try {
+            return (arg(boost::lexical_cast<std::string>(value)));
+        } catch (const boost::bad_lexical_cast& ex) {
+            // The formatting of the log message got wrong, we don't want
+            // to output it.
+            deactivate();
+            // A bad_lexical_cast during a conversion to a string is
+            // *extremely* unlikely to fail.  However, there is nothing
+            // in the documentation that rules it out, so we need to handle
+            // it.  As it is a potentially very serious problem, throw the
+            // exception detailing the problem with as much information as
+            // we can.  (Note that this does not include 'value' -
+            // boost::lexical_cast failed to convert it to a string, so an
+            // attempt to do so here would probably fail as well.)
+            isc_throw(FormatFailure, "bad_lexical_cast in call to "
+                      "Formatter::arg(): " << ex.what());
+        }
+    }
+
+    /// \brief Captures a text argument
+    ///
+    /// \return false if there is no room for the argument, in which case
+    ///     the message must be rendered into a string.
+    bool captureText(const char* text, const size_t length) {
+        if ((nextPlaceholder_ >= MAX_ARGS) ||
+            (length > BUFFER_SIZE - bufferUsed_)) {
+            return (false);
+        }
+        try {
+            checkPlaceholder(*text_, nextPlaceholder_ + 1);
+        } catch (...) {
+            deactivate();
+            throw;
+        }
+        FormatterArg& captured = args_[nextPlaceholder_++];
+        captured.type_ = FormatterArg::TEXT;
+        captured.value_ = bufferUsed_;
+        captured.length_ = length;
+        std::memcpy(buffer_ + bufferUsed_, text, length);
+        bufferUsed_ += length;
+        return (true);
+    }
+
+    /// \brief Renders the captured arguments into the message string
+    ///
+    /// Used when the formatter can't capture any more arguments.
+    void renderCaptured() {
+        std::string* message = new std::string();
+        try {
+            renderMessage(*message, ident_, *text_, args_, nextPlaceholder_,
+                          buffer_, false);
+        } catch (...) {
+            delete message;
+            throw;
+        }
+        message_ = message;
+    }
+
 
 public:
     /// \brief Constructor of "active" formatter
@@ -142,7 +336,26 @@ public:
     Formatter(const Severity& severity = NONE, std::string* message = NULL,
               Logger* logger = NULL) :
         logger_(logger), severity_(severity), message_(message),
-        nextPlaceholder_(0)
+        nextPlaceholder_(0), ident_(NULL), text_(NULL), bufferUsed_(0)
+    {
+    }
+
+    /// \brief Constructor of "active" formatter capturing the arguments
+    ///
+    /// This will create an active formatter which captures the arguments
+    /// and renders the message when it is destroyed.
+    ///
+    /// It is not expected to be called by user of logging system directly.
+    ///
+    /// \param severity The severity of the message (DEBUG, ERROR etc.)
+    /// \param ident The message ID.
+    /// \param text The message text with placeholders. It is not copied,
+    ///     so it must exist until the formatter is destroyed.
+    /// \param logger The logger where the final output will go.
+    Formatter(const Severity& severity, const MessageID& ident,
+              const std::string& text, Logger* logger) :
+        logger_(logger), severity_(severity), message_(NULL),
+        nextPlaceholder_(0), ident_(ident), text_(&text), bufferUsed_(0)
     {
     }
 
@@ -155,6 +368,7 @@ public:
         logger_(other.logger_), severity_(other.severity_),
         message_(other.message_), nextPlaceholder_(other.nextPlaceholder_)
     {
+        copyArgs(other);
         other.logger_ = NULL;
     }
 
@@ -164,8 +378,15 @@ public:
     ~ Formatter() {
         if (logger_) {
             try {
-                checkExcessPlaceholders(message_, ++nextPlaceholder_);
-                logger_->output(severity_, *message_);
+                if (message_) {
+                    checkExcessPlaceholders(message_, ++nextPlaceholder_);
+                    logger_->output(severity_, *message_);
+                } else {
+                    std::string message;
+                    renderMessage(message, ident_, *text_, args_,
+                                  nextPlaceholder_, buffer_, true);
+                    logger_->output(severity_, message);
+                }
             } catch (...) {
                 // Catch and ignore all exceptions here.
             }
@@ -183,6 +404,7 @@ public:
             severity_ = other.severity_;
             message_ = other.message_;
             nextPlaceholder_ = other.nextPlaceholder_;
+            copyArgs(other);
             other.logger_ = NULL;
         }
 
@@ -195,36 +417,40 @@ public:
     /// Deactivates the current formatter. In case the formatter is not active,
     /// only produces another inactive formatter.
     ///
+    /// Integers (other than the character types, which are output as
+    /// characters) are captured by value. Other values are converted to
+    /// text with boost::lexical_cast.
+    ///
     /// \param value The argument to place into the placeholder.
     template<class Arg> Formatter& arg(const Arg& value) {
         if (logger_) {
-            try {
-                return (arg(boost::lexical_cast<std::string>(value)));
-            } catch (const boost::bad_lexical_cast& ex) {
-                // The formatting of the log message got wrong, we don't want
-                // to output it.
-                deactivate();
-                // A bad_lexical_cast during a conversion to a string is
-                // *extremely* unlikely to fail.  However, there is nothing
-                // in the documentation that rules it out, so we need to handle
-                // it.  As it is a potentially very serious problem, throw the
-                // exception detailing the problem with as much information as
-                // we can.  (Note that this does not include 'value' -
-                // boost::lexical_cast failed to convert it to a string, so an
-                // attempt to do so here would probably fail as well.)
-                isc_throw(FormatFailure, "bad_lexical_cast in call to "
-                          "Formatter::arg(): " << ex.what());
-            }
+            return (captureArg(value, boost::integral_constant<bool,
+                               boost::is_integral<Arg>::value &&
+                               ((sizeof(Arg) > 1) ||
+                                boost::is_same<Arg, bool>::value)>()));
         } else {
             return (*this);
         }
     }
 
+    /// \brief C string version of arg.
+    ///
+    /// \param arg The text to place into the placeholder.
+    Formatter& arg(const char* arg) {
+        if (logger_ && !message_ && captureText(arg, std::strlen(arg))) {
+            return (*this);
+        }
+        return (this->arg(std::string(arg)));
+    }
+
     /// \brief String version of arg.
     ///
     /// \param arg The text to place into the placeholder.
     Formatter& arg(const std::string& arg) {
         if (logger_) {
+            if (!message_ && captureText(arg.data(), arg.size())) {
+                return (*this);
+            }
             // Note that this method does a replacement and returns the
             // modified string. If there are multiple invocations of arg() (e.g.
             // logger.info(msgid).arg(xxx).arg(yyy)...), each invocation
@@ -234,8 +460,12 @@ public:
             // call replaces the %1" with "%2" and the second replaces all
             // occurrences of "%2" with 42. (Conversely, the sequence
             // .arg(42).arg("%1") would return "42 %1" - there are no recursive
-            // replacements).
+            // replacements). The captured arguments are not searched for
+            // the placeholders at all.
             try {
+                if (!message_) {
+                    renderCaptured();
+                }
                 replacePlaceholder(message_, arg, ++nextPlaceholder_ );
             }
             catch (...) {
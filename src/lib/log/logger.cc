@@ -17,6 +17,7 @@
 
 #include <log/logger.h>
 #include <log/logger_impl.h>
+#include <log/logger_manager.h>
 #include <log/logger_name.h>
 #include <log/logger_support.h>
 #include <log/message_dictionary.h>
@@ -30,9 +31,20 @@ namespace isc {
 namespace log {
 
 // Initialize underlying logger, but only if logging has been initialized.
-void Logger::initLoggerImpl() {
+LoggerImpl* Logger::initLoggerImpl() {
     if (isLoggingInitialized()) {
-        loggerptr_ = new LoggerImpl(name_);
+        // The logger may be used by multiple threads, so make sure that
+        // only one of them creates the underlying logger. The pointer is
+        // set atomically, as getLoggerPtr() reads it without the mutex.
+        isc::util::thread::Mutex::Locker locker(LoggerManager::getMutex());
+        LoggerImpl* loggerptr = __sync_fetch_and_add(&loggerptr_, 0);
+        if (!loggerptr) {
+            loggerptr = new LoggerImpl(name_);
+            __sync_bool_compare_and_swap(&loggerptr_,
+                                         static_cast<LoggerImpl*>(0),
+                                         loggerptr);
+        }
+        return (loggerptr);
     } else {
         isc_throw(LoggingNotInitialized, "attempt to access logging function "
                   "before logging has been initialized");
@@ -137,8 +149,8 @@ Logger::output(const Severity& severity, const std::string& message) {
 Logger::Formatter
 Logger::debug(int dbglevel, const isc::log::MessageID& ident) {
     if (isDebugEnabled(dbglevel)) {
-        return (Formatter(DEBUG, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (Formatter(DEBUG, ident, MessageDictionary::globalDictionary().
+                          getText(ident), this));
     } else {
         return (Formatter());
     }
@@ -147,8 +159,8 @@ Logger::debug(int dbglevel, const isc::log::MessageID& ident) {
 Logger::Formatter
 Logger::info(const isc::log::MessageID& ident) {
     if (isInfoEnabled()) {
-        return (Formatter(INFO, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (Formatter(INFO, ident, MessageDictionary::globalDictionary().
+                          getText(ident), this));
     } else {
         return (Formatter());
     }
@@ -157,8 +169,8 @@ Logger::info(const isc::log::MessageID& ident) {
 Logger::Formatter
 Logger::warn(const isc::log::MessageID& ident) {
     if (isWarnEnabled()) {
-        return (Formatter(WARN, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (Formatter(WARN, ident, MessageDictionary::globalDictionary().
+                          getText(ident), this));
     } else {
         return (Formatter());
     }
@@ -167,8 +179,8 @@ Logger::warn(const isc::log::MessageID& ident) {
 Logger::Formatter
 Logger::error(const isc::log::MessageID& ident) {
     if (isErrorEnabled()) {
-        return (Formatter(ERROR, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (Formatter(ERROR, ident, MessageDictionary::globalDictionary().
+                          getText(ident), this));
     } else {
         return (Formatter());
     }
@@ -177,8 +189,8 @@ Logger::error(const isc::log::MessageID& ident) {
 Logger::Formatter
 Logger::fatal(const isc::log::MessageID& ident) {
     if (isFatalEnabled()) {
-        return (Formatter(FATAL, getLoggerPtr()->lookupMessage(ident),
-                          this));
+        return (Formatter(FATAL, ident, MessageDictionary::globalDictionary().
+                          getText(ident), this));
     } else {
         return (Formatter());
     }
@@ -350,14 +350,19 @@ private:
     ///
     /// \return Returns pointer to implementation
     LoggerImpl* getLoggerPtr() {
-        if (!loggerptr_) {
-            initLoggerImpl();
+        // The pointer is set by the first thread using the logger, so it
+        // is read atomically rather than taking the mutex for each message.
+        LoggerImpl* loggerptr = __sync_fetch_and_add(&loggerptr_, 0);
+        if (!loggerptr) {
+            loggerptr = initLoggerImpl();
         }
-        return (loggerptr_);
+        return (loggerptr);
     }
 
     /// \brief Initialize Underlying Implementation and Set loggerptr_
-    void initLoggerImpl();
+    ///
+    /// \return Returns pointer to implementation
+    LoggerImpl* initLoggerImpl();
 
     LoggerImpl* loggerptr_;                  ///< Pointer to underlying logger
     char        name_[MAX_LOGGER_NAME_SIZE + 1]; ///< Copy of the logger name
@@ -26,6 +26,7 @@
 #include <log4cplus/configurator.h>
 #include <log4cplus/loggingmacros.h>
 
+#include <log/async_log_writer.h>
 #include <log/logger.h>
 #include <log/logger_impl.h>
 #include <log/logger_level.h>
@@ -48,11 +49,7 @@ using namespace std;
 namespace isc {
 namespace log {
 
-/// @brief detects whether file locking is enabled or disabled
-///
-/// The lockfile is enabled by default. The only way to disable it is to
-/// set KEA_LOCKFILE_DIR variable to 'none'.
-/// @return true if lockfile is enabled, false otherwise
+// Check whether file locking is enabled.
 bool lockfileEnabled() {
     const char* const env = getenv("KEA_LOCKFILE_DIR");
     if (env && boost::iequals(string(env), string("none"))) {
@@ -122,13 +119,6 @@ LoggerImpl::getEffectiveDebugLevel() {
 }
 
 
-// Output a general message
-string*
-LoggerImpl::lookupMessage(const MessageID& ident) {
-    return (new string(string(ident) + " " +
-                       MessageDictionary::globalDictionary().getText(ident)));
-}
-
 // Replace the interprocess synchronization object
 
 void
@@ -145,6 +135,16 @@ LoggerImpl::setInterprocessSync(isc::log::interprocess::InterprocessSync* sync)
 
 void
 LoggerImpl::outputRaw(const Severity& severity, const string& message) {
+    // Hand the message over to the background thread if it is running.
+    // The message is written here if the writer has been stopped.
+    AsyncLogWriter& writer = AsyncLogWriter::instance();
+    if (writer.isRunning() && (severity != NONE)) {
+        string record(message);
+        if (writer.push(name_, severity, record)) {
+            return;
+        }
+    }
+
     // Use a mutex locker for mutual exclusion from other threads in
     // this process.
     isc::util::thread::Mutex::Locker mutex_locker(LoggerManager::getMutex());
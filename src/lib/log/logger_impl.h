@@ -37,6 +37,13 @@
 namespace isc {
 namespace log {
 
+/// \brief detects whether file locking is enabled or disabled
+///
+/// The lockfile is enabled by default. The only way to disable it is to
+/// set KEA_LOCKFILE_DIR variable to 'none'.
+/// \return true if lockfile is enabled, false otherwise
+bool lockfileEnabled();
+
 /// \brief Console Logger Implementation
 ///
 /// The logger uses a "pimpl" idiom for implementation, where the base logger
@@ -157,18 +164,14 @@ public:
     /// \brief Raw output
     ///
     /// Writes the message with time into the log. Used by the Formatter
-    /// to produce output.
+    /// to produce output. If the asynchronous logging is enabled, the
+    /// message is handed over to the \c AsyncLogWriter instead.
     ///
     /// \param severity Severity of the message. (This controls the prefix
     ///        label output with the message text.)
     /// \param message Text of the message.
     void outputRaw(const Severity& severity, const std::string& message);
 
-    /// \brief Look up message text in dictionary
-    ///
-    /// This gets you the unformatted text of message for given ID.
-    std::string* lookupMessage(const MessageID& id);
-
     /// \brief Replace the interprocess synchronization object
     ///
     /// If this method is called with NULL as the argument, it throws a
@@ -0,0 +1,182 @@
+// Copyright (C) 2016 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <exceptions/exceptions.h>
+#include <log/async_log_writer.h>
+#include <log/log_messages.h>
+#include <log/logger.h>
+#include <log/logger_manager.h>
+#include <log/logger_specification.h>
+#include <log/macros.h>
+#include <log/output_option.h>
+
+#include "tempdir.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::log;
+using namespace std;
+
+namespace {
+
+/// @brief Test fixture class for the asynchronous log writer.
+///
+/// Directs the output of the "asynclogger" logger to a file, which is
+/// removed when the test ends.
+class AsyncLogWriterTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    AsyncLogWriterTest()
+        : filename_(TEMP_DIR + "/kea_async_log_writer_test.log") {
+        static_cast<void>(unlink(filename_.c_str()));
+
+        OutputOption option;
+        option.destination = OutputOption::DEST_FILE;
+        option.filename = filename_;
+
+        LoggerSpecification spec("asynclogger");
+        spec.addOutputOption(option);
+
+        LoggerManager manager;
+        manager.process(spec);
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Stops the writer and removes the log file.
+    virtual ~AsyncLogWriterTest() {
+        AsyncLogWriter::instance().stop();
+        LoggerManager::reset();
+        static_cast<void>(unlink(filename_.c_str()));
+        static_cast<void>(unlink((filename_ + ".lock").c_str()));
+    }
+
+    /// @brief Counts the lines of the log file holding the message ID.
+    ///
+    /// @param id Message ID.
+    size_t countMessages(const string& id) const {
+        ifstream infile(filename_.c_str());
+        size_t count = 0;
+        string line;
+        while (getline(infile, line)) {
+            if (line.find(id) != string::npos) {
+                ++count;
+            }
+        }
+        return (count);
+    }
+
+    /// @brief Name of the log file.
+    string filename_;
+};
+
+// Checks the conversions of the overflow policy names.
+TEST_F(AsyncLogWriterTest, overflowPolicyText) {
+    EXPECT_EQ(AsyncLogWriter::BLOCK,
+              AsyncLogWriter::overflowPolicyFromText("block"));
+    EXPECT_EQ(AsyncLogWriter::DROP,
+              AsyncLogWriter::overflowPolicyFromText("drop"));
+    EXPECT_EQ(AsyncLogWriter::COUNT,
+              AsyncLogWriter::overflowPolicyFromText("count"));
+    EXPECT_THROW(AsyncLogWriter::overflowPolicyFromText("wait"), BadValue);
+
+    EXPECT_EQ("block", AsyncLogWriter::overflowPolicyToText(AsyncLogWriter::BLOCK));
+    EXPECT_EQ("drop", AsyncLogWriter::overflowPolicyToText(AsyncLogWriter::DROP));
+    EXPECT_EQ("count", AsyncLogWriter::overflowPolicyToText(AsyncLogWriter::COUNT));
+}
+
+// Checks that the writer can be started and stopped.
+TEST_F(AsyncLogWriterTest, startStop) {
+    AsyncLogWriter& writer = AsyncLogWriter::instance();
+    EXPECT_FALSE(writer.isRunning());
+
+    // The queue can't be empty.
+    EXPECT_THROW(writer.start(0), BadValue);
+    EXPECT_FALSE(writer.isRunning());
+
+    // The size of the queue is rounded up to the power of two.
+    ASSERT_NO_THROW(writer.start(100, AsyncLogWriter::DROP));
+    EXPECT_TRUE(writer.isRunning());
+    EXPECT_EQ(128, writer.getQueueSize());
+    EXPECT_EQ(AsyncLogWriter::DROP, writer.getOverflowPolicy());
+
+    // Starting again replaces the queue.
+    ASSERT_NO_THROW(writer.start());
+    EXPECT_TRUE(writer.isRunning());
+    EXPECT_EQ(AsyncLogWriter::DEFAULT_QUEUE_SIZE, writer.getQueueSize());
+    EXPECT_EQ(AsyncLogWriter::BLOCK, writer.getOverflowPolicy());
+
+    ASSERT_NO_THROW(writer.stop());
+    EXPECT_FALSE(writer.isRunning());
+
+    // Stopping twice is fine.
+    EXPECT_NO_THROW(writer.stop());
+}
+
+// Checks that the messages are not queued when the writer is stopped.
+TEST_F(AsyncLogWriterTest, pushNotRunning) {
+    string message("message");
+    EXPECT_FALSE(AsyncLogWriter::instance().push("asynclogger", INFO, message));
+    EXPECT_EQ("message", message);
+}
+
+// Checks that all messages logged by multiple loggers are written when
+// the queue is smaller than the number of messages and the writer blocks.
+TEST_F(AsyncLogWriterTest, writeBlock) {
+    AsyncLogWriter& writer = AsyncLogWriter::instance();
+    ASSERT_NO_THROW(writer.start(16, AsyncLogWriter::BLOCK));
+
+    Logger logger("asynclogger");
+    for (int i = 0; i < 1000; ++i) {
+        LOG_INFO(logger, LOG_NO_SUCH_MESSAGE).arg(i);
+    }
+
+    // Stopping the writer writes the queued messages.
+    writer.stop();
+    EXPECT_EQ(0, writer.getDroppedCount());
+    EXPECT_EQ(1000, countMessages(LOG_NO_SUCH_MESSAGE));
+
+    // The messages are written synchronously when the writer is stopped.
+    LOG_INFO(logger, LOG_NO_SUCH_MESSAGE).arg("sync");
+    EXPECT_EQ(1001, countMessages(LOG_NO_SUCH_MESSAGE));
+}
+
+// Checks that the messages which don't fit into the queue are counted
+// and reported when the policy is "count".
+TEST_F(AsyncLogWriterTest, writeCount) {
+    AsyncLogWriter& writer = AsyncLogWriter::instance();
+    ASSERT_NO_THROW(writer.start(1, AsyncLogWriter::COUNT));
+
+    Logger logger("asynclogger");
+    for (int i = 0; i < 10000; ++i) {
+        LOG_INFO(logger, LOG_NO_SUCH_MESSAGE).arg(i);
+    }
+    writer.stop();
+
+    // The background thread can't keep up with the single slot queue,
+    // so some of the messages must have been dropped. Every message
+    // is either written or dropped.
+    const uint64_t dropped = writer.getDroppedCount();
+    EXPECT_GT(dropped, 0);
+    EXPECT_EQ(10000, countMessages(LOG_NO_SUCH_MESSAGE) + dropped);
+}
+
+}
@@ -41,6 +41,13 @@ public:
     string* s(const char* text) {
         return (new string(text));
     }
+    // Creates a formatter capturing the arguments. The text is kept in
+    // the fixture as the formatter doesn't copy it.
+    Formatter d(const char* text) {
+        text_ = text;
+        return (Formatter(isc::log::INFO, "TEST_ID", text_, this));
+    }
+    string text_;
 };
 
 // Create an inactive formatter and check it doesn't produce any output
@@ -107,6 +114,64 @@ TEST_F(FormatterTest, multiArg) {
     EXPECT_EQ("The arguments are switched", outputs[0].second);
 }
 
+// Captured arguments of various types are rendered when the message is
+// output, the same as they would be converted with lexical_cast.
+TEST_F(FormatterTest, deferredArgs) {
+    d("Text of message");
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(isc::log::INFO, outputs[0].first);
+    EXPECT_EQ("TEST_ID Text of message", outputs[0].second);
+
+    const size_t size = 1500;
+    const uint64_t big = 0xffffffffffffffffULL;
+    const int64_t min = -9223372036854775807LL - 1;
+    d("%1 %2 %3 %4 %5 %6").arg(-42).arg(size).arg(big).arg(true).
+        arg(static_cast<short>(-7)).arg(min);
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ("TEST_ID -42 1500 18446744073709551615 1 -7 "
+              "-9223372036854775808", outputs[1].second);
+
+    // Character types are output as characters and other types are
+    // converted to text.
+    d("%1 %2 %3 %4").arg('x').arg(string("text")).arg("c string").arg(2.5);
+    ASSERT_EQ(3, outputs.size());
+    EXPECT_EQ("TEST_ID x text c string 2.5", outputs[2].second);
+}
+
+// Arguments are placed in the right places and may be used several times.
+TEST_F(FormatterTest, deferredPlaceholders) {
+    d("The %2 are %1, %2 100%").arg("switched").arg("arguments");
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ("TEST_ID The arguments are switched, arguments 100%",
+              outputs[0].second);
+
+    // Captured arguments are not searched for the placeholders.
+    d("%1 %2").arg("%2").arg(42);
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ("TEST_ID %2 42", outputs[1].second);
+}
+
+// When the formatter can't capture any more arguments, it renders the
+// message and replaces the remaining placeholders one by one.
+TEST_F(FormatterTest, deferredOverflow) {
+    d("%1%2%3%4%5%6%7%8%9").arg(1).arg("2").arg(3).arg("4").arg(5).
+        arg("6").arg(7).arg("8").arg(9);
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ("TEST_ID 123456789", outputs[0].second);
+
+    const string long_text(300, 'a');
+    d("%1 %2 %3").arg(1).arg(long_text).arg("b");
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ("TEST_ID 1 " + long_text + " b", outputs[1].second);
+}
+
+// The arguments are captured only by the active formatter.
+TEST_F(FormatterTest, deferredDeactivate) {
+    d("Text of %1").arg(1).deactivate();
+    Formatter().arg(1).arg("text");
+    EXPECT_EQ(0, outputs.size());
+}
+
 #ifdef ENABLE_LOGGER_CHECKS
 
 TEST_F(FormatterTest, mismatchedPlaceholders) {
@@ -135,6 +200,15 @@ TEST_F(FormatterTest, mismatchedPlaceholders) {
                  isc::log::MismatchedPlaceholders);
 }
 
+// The missing placeholder is detected when the argument is captured.
+TEST_F(FormatterTest, deferredMismatchedPlaceholders) {
+    EXPECT_THROW(d("Missing the second %1").arg("argument").arg(42),
+                 isc::log::MismatchedPlaceholders);
+    EXPECT_THROW(d("Missing the first %2").arg("missing"),
+                 isc::log::MismatchedPlaceholders);
+    EXPECT_EQ(0, outputs.size());
+}
+
 #else
 
 // If logger checks are not enabled, nothing is thrown
@@ -163,6 +237,26 @@ TEST_F(FormatterTest, mismatchedPlaceholders) {
               "@@Missing placeholder %1 for 'missing'@@", outputs[2].second);
 }
 
+// The mismatched placeholders are reported the same way when the
+// arguments are captured.
+TEST_F(FormatterTest, deferredMismatchedPlaceholders) {
+    d("Missing the second %1").arg("argument").arg(42);
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ("TEST_ID Missing the second argument "
+              "@@Missing placeholder %2 for '42'@@", outputs[0].second);
+
+    EXPECT_NO_THROW(d("Too many arguments in %1 %2").arg("only one"));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ("TEST_ID Too many arguments in only one %2 "
+              "@@Excess logger placeholders still exist@@",
+              outputs[1].second);
+
+    d("Missing the first %2").arg("missing").arg("argument");
+    ASSERT_EQ(3, outputs.size());
+    EXPECT_EQ("TEST_ID Missing the first argument "
+              "@@Missing placeholder %1 for 'missing'@@", outputs[2].second);
+}
+
 #endif /* ENABLE_LOGGER_CHECKS */
 
 // Can replace multiple placeholders
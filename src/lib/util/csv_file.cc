@@ -16,8 +16,12 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/constants.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace isc {
 namespace util {
@@ -40,6 +44,31 @@ CSVRow::parse(const std::string& line) {
                  boost::algorithm::token_compress_off);
 }
 
+void
+CSVRow::parse(const char* line, const size_t len) {
+    const char* begin = line;
+    const char* end = line + len;
+    size_t count = 0;
+    while (true) {
+        // Find the end of the current value. Two consecutive separators
+        // mark an empty value.
+        const char* separator = static_cast<const char*>
+            (memchr(begin, separator_[0], end - begin));
+        const char* value_end = (separator != NULL ? separator : end);
+        if (count < values_.size()) {
+            values_[count].assign(begin, value_end);
+        } else {
+            values_.push_back(std::string(begin, value_end));
+        }
+        ++count;
+        if (separator == NULL) {
+            break;
+        }
+        begin = separator + 1;
+    }
+    values_.resize(count);
+}
+
 std::string
 CSVRow::readAt(const size_t at) const {
     checkIndex(at);
@@ -80,7 +109,7 @@ CSVRow::checkIndex(const size_t at) const {
 }
 
 CSVFile::CSVFile(const std::string& filename)
-    : filename_(filename), fs_(), cols_(0), read_msg_() {
+    : filename_(filename), fs_(), sync_fd_(-1), cols_(0), read_msg_() {
 }
 
 CSVFile::~CSVFile() {
@@ -95,6 +124,7 @@ CSVFile::close() {
         fs_->close();
         fs_.reset();
     }
+    closeSyncDescriptor();
 }
 
 bool
@@ -111,6 +141,68 @@ CSVFile::flush() const {
     fs_->flush();
 }
 
+void
+CSVFile::sync() const {
+    flush();
+
+#ifdef OS_LINUX
+    const int result = fdatasync(getSyncDescriptor());
+#else
+    const int result = fsync(getSyncDescriptor());
+#endif
+    if (result != 0) {
+        isc_throw(CSVFileError, "unable to sync '" << filename_ << "': "
+                  << strerror(errno));
+    }
+}
+
+int
+CSVFile::dupSyncDescriptor() const {
+    flush();
+
+    const int fd = dup(getSyncDescriptor());
+    if (fd < 0) {
+        isc_throw(CSVFileError, "unable to duplicate the descriptor of '"
+                  << filename_ << "': " << strerror(errno));
+    }
+    return (fd);
+}
+
+int
+CSVFile::syncDescriptor(const int fd) {
+#ifdef OS_LINUX
+    const int result = fdatasync(fd);
+#else
+    const int result = fsync(fd);
+#endif
+    const int err = (result != 0) ? errno : 0;
+    ::close(fd);
+    return (err);
+}
+
+int
+CSVFile::getSyncDescriptor() const {
+    // The stream doesn't expose its descriptor, but the data written
+    // through any descriptor of the file are synced. The descriptor is
+    // opened once and kept until the file is closed.
+    if (sync_fd_ < 0) {
+        sync_fd_ = ::open(filename_.c_str(), O_WRONLY);
+        if (sync_fd_ < 0) {
+            isc_throw(CSVFileError, "unable to open '" << filename_
+                      << "' to sync it: " << strerror(errno));
+        }
+    }
+    return (sync_fd_);
+}
+
+void
+CSVFile::closeSyncDescriptor() const {
+    if (sync_fd_ >= 0) {
+        ::close(sync_fd_);
+        sync_fd_ = -1;
+    }
+}
+
 void
 CSVFile::addColumn(const std::string& col_name) {
     // It is not allowed to add a new column when file is open.
@@ -268,6 +360,7 @@ CSVFile::open(const bool seek_to_end) {
 
     } else {
         // Try to open existing file, holding some data.
+        closeSyncDescriptor();
         fs_.reset(new std::fstream(filename_.c_str()));
 
         // Catch exceptions so as we can close the file if error occurs.
@@ -361,16 +454,24 @@ CSVFile::recreate() {
 
 bool
 CSVFile::validate(const CSVRow& row) {
+    try {
+        checkValuesCount(row);
+
+    } catch (const CSVFileError& ex) {
+        setReadMsg(ex.what());
+        return (false);
+    }
     setReadMsg("success");
-    bool ok = (row.getValuesCount() == getColumnCount());
-    if (!ok) {
-        std::ostringstream s;
-        s << "the size of the row '" << row << "' doesn't match the number of"
-            " columns '" << getColumnCount() << "' of the CSV file '"
-          << filename_ << "'";
-        setReadMsg(s.str());
+    return (true);
+}
+
+void
+CSVFile::checkValuesCount(const CSVRow& row) const {
+    if (row.getValuesCount() != getColumnCount()) {
+        isc_throw(CSVFileError, "the size of the row '" << row << "' doesn't"
+                  " match the number of columns '" << getColumnCount()
+                  << "' of the CSV file '" << filename_ << "'");
     }
-    return (ok);
 }
 
 bool
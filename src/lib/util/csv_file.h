@@ -105,6 +105,21 @@ public:
     /// @param line String holding a row of comma separated values.
     void parse(const std::string& line);
 
+    /// @brief Parse the CSV file row held in a buffer.
+    ///
+    /// This function is equivalent to the @c CSVRow::parse taking a string,
+    /// but it doesn't require that the row is copied to a string first. It
+    /// is meant to be used with the rows of the file mapped into memory.
+    /// The values are assigned to the strings already held by the row, so
+    /// when the same object is used to parse subsequent rows, their values
+    /// typically don't require new memory allocations.
+    ///
+    /// This function is exception-free, unless memory allocation fails.
+    ///
+    /// @param line Pointer to the beginning of the row.
+    /// @param len Length of the row, excluding the end of line character.
+    void parse(const char* line, const size_t len);
+
     /// @brief Retrieves a value from the internal container.
     ///
     /// @param at Index of the value in the container. The values are indexed
@@ -331,6 +346,34 @@ public:
     /// @brief Flushes a file.
     void flush() const;
 
+    /// @brief Flushes a file and writes its data to the storage device.
+    ///
+    /// When this method returns, the rows appended to the file survive
+    /// a crash of the system.
+    ///
+    /// @throw CSVFileError if the data can't be written.
+    void sync() const;
+
+    /// @brief Flushes a file and returns a descriptor for syncing it.
+    ///
+    /// The data of the file may then be written to the storage device
+    /// with @c syncDescriptor without accessing this object, e.g. while
+    /// other threads append rows to the file or close it.
+    ///
+    /// @return Duplicate of the descriptor kept for syncing the file. The
+    /// caller is responsible for closing it.
+    /// @throw CSVFileError if the file is not open or the descriptor can't
+    /// be obtained.
+    int dupSyncDescriptor() const;
+
+    /// @brief Writes the data of the file to the storage device and closes
+    /// the descriptor.
+    ///
+    /// @param fd Descriptor returned by @c dupSyncDescriptor.
+    ///
+    /// @return 0 on success, the error number otherwise.
+    static int syncDescriptor(const int fd);
+
     /// @brief Returns the number of columns in the file.
     size_t getColumnCount() const {
         return (cols_.size());
@@ -458,6 +501,18 @@ protected:
     /// @return true if the column is valid; false otherwise.
     virtual bool validate(const CSVRow& row);
 
+    /// @brief Checks that the row holds a value for each column.
+    ///
+    /// This is the check done by the default @c validate implementation.
+    /// Unlike @c validate, it doesn't set the error message, so it may be
+    /// called by multiple threads concurrently.
+    ///
+    /// @param row A row to be checked.
+    ///
+    /// @throw CSVFileError if the number of values in the row doesn't
+    /// match the number of columns.
+    void checkValuesCount(const CSVRow& row) const;
+
 protected:
 
     /// @brief This function validates the header of the CSV file.
@@ -490,12 +545,25 @@ private:
     /// @brief Returns size of the CSV file.
     std::streampos size() const;
 
+    /// @brief Returns the descriptor used for syncing the file.
+    ///
+    /// The descriptor is opened on the first call.
+    ///
+    /// @throw CSVFileError if the file can't be opened.
+    int getSyncDescriptor() const;
+
+    /// @brief Closes the descriptor used for syncing the file.
+    void closeSyncDescriptor() const;
+
     /// @brief CSV file name.
     std::string filename_;
 
     /// @brief Holds a pointer to the file stream.
     boost::shared_ptr<std::fstream> fs_;
 
+    /// @brief Descriptor used for syncing the file, or -1 if it is not open.
+    mutable int sync_fd_;
+
     /// @brief Holds CSV file columns.
     std::vector<std::string> cols_;
 
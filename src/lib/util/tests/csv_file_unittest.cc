@@ -50,6 +50,44 @@ TEST(CSVRow, parse) {
     EXPECT_TRUE(row1.readAt(0).empty());
 }
 
+// This test checks that the row held in a buffer is parsed and that
+// the values of the previously parsed row are replaced.
+TEST(CSVRow, parseBuffer) {
+    // The buffer holds more than one row, only the first is parsed.
+    const char buf[] = "foo,bar,foo-bar\nabc";
+    CSVRow row;
+    row.parse(buf, 15);
+    ASSERT_EQ(3, row.getValuesCount());
+    EXPECT_EQ("foo", row.readAt(0));
+    EXPECT_EQ("bar", row.readAt(1));
+    EXPECT_EQ("foo-bar", row.readAt(2));
+
+    // The row with fewer values shrinks the row.
+    row.parse(",x", 2);
+    ASSERT_EQ(2, row.getValuesCount());
+    EXPECT_TRUE(row.readAt(0).empty());
+    EXPECT_EQ("x", row.readAt(1));
+
+    // The row with more values grows the row.
+    row.parse("a,b,c,", 6);
+    ASSERT_EQ(4, row.getValuesCount());
+    EXPECT_EQ("a", row.readAt(0));
+    EXPECT_EQ("c", row.readAt(2));
+    EXPECT_TRUE(row.readAt(3).empty());
+
+    // The result is the same as for the string.
+    EXPECT_TRUE(row == CSVRow("a,b,c,"));
+
+    row.parse(buf, 0);
+    ASSERT_EQ(1, row.getValuesCount());
+    EXPECT_TRUE(row.readAt(0).empty());
+
+    CSVRow row1(0, '|');
+    row1.parse("foo|bar", 7);
+    ASSERT_EQ(2, row1.getValuesCount());
+    EXPECT_EQ("bar", row1.readAt(1));
+}
+
 // This test checks that the text representation of the CSV row
 // is created correctly.
 TEST(CSVRow, render) {
@@ -502,5 +540,50 @@ TEST_F(CSVFileTest, exists) {
     EXPECT_FALSE(csv->exists());
 }
 
+// This test checks that the appended rows are synced to the file and that
+// the file which is not open can't be synced.
+TEST_F(CSVFileTest, sync) {
+    boost::scoped_ptr<CSVFile> csv(new CSVFile(testfile_));
+    csv->addColumn("animal");
+    csv->addColumn("age");
+    EXPECT_THROW(csv->sync(), CSVFileError);
+
+    ASSERT_NO_THROW(csv->recreate());
+    CSVRow row(2);
+    row.writeAt(0, "dog");
+    row.writeAt(1, 3);
+    ASSERT_NO_THROW(csv->append(row));
+    ASSERT_NO_THROW(csv->sync());
+
+    EXPECT_EQ("animal,age\n"
+              "dog,3\n",
+              readFile());
+    csv->close();
+}
+
+// This test checks that the file may be synced through the duplicated
+// descriptor after it has been closed.
+TEST_F(CSVFileTest, syncDescriptor) {
+    boost::scoped_ptr<CSVFile> csv(new CSVFile(testfile_));
+    csv->addColumn("animal");
+    csv->addColumn("age");
+    EXPECT_THROW(csv->dupSyncDescriptor(), CSVFileError);
+
+    ASSERT_NO_THROW(csv->recreate());
+    CSVRow row(2);
+    row.writeAt(0, "dog");
+    row.writeAt(1, 3);
+    ASSERT_NO_THROW(csv->append(row));
+    int fd = -1;
+    ASSERT_NO_THROW(fd = csv->dupSyncDescriptor());
+    ASSERT_GE(fd, 0);
+    csv->close();
+
+    EXPECT_EQ(0, CSVFile::syncDescriptor(fd));
+    EXPECT_EQ("animal,age\n"
+              "dog,3\n",
+              readFile());
+}
+
 
 } // end of anonymous namespace
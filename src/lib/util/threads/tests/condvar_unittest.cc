@@ -95,6 +95,32 @@ TEST_F(CondVarTest, waitAndSignal) {
     }
 }
 
+// The timed wait returns when the condition variable is signalled.
+TEST_F(CondVarTest, timedWaitAndSignal) {
+    if (!isc::util::unittests::runningOnValgrind()) {
+        Mutex::Locker locker(mutex_);
+        int shared_var = 0; // let the other thread increment this
+        Thread t(boost::bind(&ringSignal, &condvar_, &mutex_, &shared_var));
+        // The wait may be woken up spuriously, so wait for the change.
+        while (shared_var == 0) {
+            EXPECT_TRUE(condvar_.timedWait(mutex_, 10000));
+        }
+        t.wait();
+        EXPECT_EQ(1, shared_var);
+    }
+}
+
+// The timed wait returns false when the time elapses.
+TEST_F(CondVarTest, timedWaitTimeout) {
+    Mutex::Locker locker(mutex_);
+    // Spurious wake ups are allowed, so retry a few times.
+    bool signalled = true;
+    for (int i = 0; (i < 10) && signalled; ++i) {
+        signalled = condvar_.timedWait(mutex_, 10);
+    }
+    EXPECT_FALSE(signalled);
+}
+
 // Thread's main code for the next test
 void
 signalAndWait(CondVar* condvar1, CondVar* condvar2, Mutex* mutex, int* arg) {
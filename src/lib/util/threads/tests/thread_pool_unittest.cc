@@ -0,0 +1,226 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/bind.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Test fixture class for the @c ThreadPool.
+class ThreadPoolTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ThreadPoolTest()
+        : count_(0), blocked_(true), overlaps_(0) {
+    }
+
+    /// @brief Work item incrementing the counter.
+    void increment() {
+        Mutex::Locker locker(mutex_);
+        ++count_;
+    }
+
+    /// @brief Work item which waits until it is unblocked by the test.
+    void block() {
+        Mutex::Locker locker(mutex_);
+        while (blocked_) {
+            cond_.wait(mutex_);
+        }
+        ++count_;
+    }
+
+    /// @brief Unblocks work items created with @c block.
+    void unblock() {
+        Mutex::Locker locker(mutex_);
+        blocked_ = false;
+        cond_.broadcast();
+    }
+
+    /// @brief Work item recording the order of execution for a key.
+    ///
+    /// It also checks that no other item with the same key is executed
+    /// at the same time.
+    ///
+    /// @param key Key with which the item has been added.
+    /// @param seq Sequence number of the item for this key.
+    void record(const std::string& key, const int seq) {
+        {
+            Mutex::Locker locker(mutex_);
+            if (!in_progress_[key].empty()) {
+                ++overlaps_;
+            }
+            in_progress_[key] = "busy";
+        }
+        // Give other threads a chance to pick the items with the same key.
+        usleep(100);
+        Mutex::Locker locker(mutex_);
+        in_progress_[key].clear();
+        order_[key].push_back(seq);
+    }
+
+    /// @brief Work item throwing an exception.
+    void throwException() {
+        isc_throw(isc::Unexpected, "work item failed");
+    }
+
+    /// @brief Returns current value of the counter.
+    int getCount() {
+        Mutex::Locker locker(mutex_);
+        return (count_);
+    }
+
+    /// @brief Mutex protecting the counter.
+    Mutex mutex_;
+
+    /// @brief Condition variable used to unblock work items.
+    CondVar cond_;
+
+    /// @brief Counter incremented by the work items.
+    int count_;
+
+    /// @brief Indicates if the blocking work items should wait.
+    bool blocked_;
+
+    /// @brief Sequence numbers of the executed items, by key.
+    std::map<std::string, std::vector<int> > order_;
+
+    /// @brief Non-empty for the keys which items are being executed.
+    std::map<std::string, std::string> in_progress_;
+
+    /// @brief Number of times two items with the same key overlapped.
+    int overlaps_;
+};
+
+// Checks that the pool validates parameters and can't be started twice.
+TEST_F(ThreadPoolTest, start) {
+    ThreadPool pool;
+    EXPECT_FALSE(pool.isRunning());
+    EXPECT_THROW(pool.start(0, 10), isc::BadValue);
+    EXPECT_THROW(pool.start(2, 0), isc::BadValue);
+    ASSERT_NO_THROW(pool.start(2, 10));
+    EXPECT_TRUE(pool.isRunning());
+    EXPECT_EQ(2, pool.getThreadCount());
+    EXPECT_EQ(10, pool.getQueueSize());
+    EXPECT_THROW(pool.start(2, 10), isc::InvalidOperation);
+    ASSERT_NO_THROW(pool.stop());
+    EXPECT_FALSE(pool.isRunning());
+    EXPECT_EQ(0, pool.getThreadCount());
+    // Stopping the pool which is not running is a no-op.
+    EXPECT_NO_THROW(pool.stop());
+}
+
+// Checks that all queued work items are executed.
+TEST_F(ThreadPoolTest, execute) {
+    ThreadPool pool;
+    // Items can't be added to the pool which is not running.
+    EXPECT_FALSE(pool.add(boost::bind(&ThreadPoolTest::increment, this)));
+
+    ASSERT_NO_THROW(pool.start(4, 1000));
+    for (int i = 0; i < 500; ++i) {
+        ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::increment, this)));
+    }
+    pool.wait();
+    EXPECT_EQ(500, getCount());
+    EXPECT_EQ(0, pool.count());
+}
+
+// Checks that items are refused when the queue is full.
+TEST_F(ThreadPoolTest, queueFull) {
+    ThreadPool pool;
+    ASSERT_NO_THROW(pool.start(1, 2));
+
+    // The first item occupies the only worker thread. Wait for the worker
+    // to take it from the queue.
+    ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::block, this)));
+    while (pool.count() > 0) {
+        usleep(1000);
+    }
+    // Two more items fit into the queue.
+    EXPECT_TRUE(pool.add(boost::bind(&ThreadPoolTest::block, this)));
+    EXPECT_TRUE(pool.add(boost::bind(&ThreadPoolTest::block, this)));
+    EXPECT_EQ(2, pool.count());
+    // There is no more room in the queue.
+    EXPECT_FALSE(pool.add(boost::bind(&ThreadPoolTest::block, this)));
+
+    unblock();
+    pool.wait();
+    EXPECT_EQ(3, getCount());
+}
+
+// Checks that the exception thrown by a work item doesn't stop the worker.
+TEST_F(ThreadPoolTest, exception) {
+    ThreadPool pool;
+    ASSERT_NO_THROW(pool.start(1, 10));
+    ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::throwException, this)));
+    ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::increment, this)));
+    pool.wait();
+    EXPECT_EQ(1, getCount());
+}
+
+// Checks that the pool can be restarted after being stopped.
+TEST_F(ThreadPoolTest, restart) {
+    ThreadPool pool;
+    ASSERT_NO_THROW(pool.start(2, 10));
+    ASSERT_NO_THROW(pool.stop());
+    ASSERT_NO_THROW(pool.start(3, 10));
+    EXPECT_EQ(3, pool.getThreadCount());
+    ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::increment, this)));
+    pool.wait();
+    EXPECT_EQ(1, getCount());
+}
+
+// Checks that the items added with the same key are executed in order
+// and never concurrently.
+TEST_F(ThreadPoolTest, keyOrdering) {
+    ThreadPool pool;
+    ASSERT_NO_THROW(pool.start(4, 1000));
+
+    const int num_items = 50;
+    for (int i = 0; i < num_items; ++i) {
+        ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::record, this,
+                                         "foo", i), "foo"));
+        ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::record, this,
+                                         "bar", i), "bar"));
+        ASSERT_TRUE(pool.add(boost::bind(&ThreadPoolTest::increment, this)));
+    }
+    pool.wait();
+
+    EXPECT_EQ(0, overlaps_);
+    EXPECT_EQ(num_items, getCount());
+    ASSERT_EQ(num_items, order_["foo"].size());
+    ASSERT_EQ(num_items, order_["bar"].size());
+    for (int i = 0; i < num_items; ++i) {
+        EXPECT_EQ(i, order_["foo"][i]);
+        EXPECT_EQ(i, order_["bar"][i]);
+    }
+}
+
+}
@@ -0,0 +1,186 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include <util/threads/thread_pool.h>
+
+#include <boost/bind.hpp>
+
+namespace isc {
+namespace util {
+namespace thread {
+
+ThreadPool::ThreadPool()
+    : queue_(), queued_(0), threads_(), queue_size_(0), working_(0),
+      busy_keys_(), running_(false) {
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+void
+ThreadPool::start(const size_t thread_count, const size_t queue_size) {
+    if (thread_count == 0) {
+        isc_throw(isc::BadValue, "number of threads in the thread pool"
+                  " must be greater than 0");
+    }
+    if (queue_size == 0) {
+        isc_throw(isc::BadValue, "size of the thread pool queue must be"
+                  " greater than 0");
+    }
+
+    {
+        Mutex::Locker locker(mutex_);
+        if (running_) {
+            isc_throw(isc::InvalidOperation, "thread pool is already running");
+        }
+        queue_size_ = queue_size;
+        running_ = true;
+    }
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.push_back(ThreadPtr(new Thread(boost::bind(&ThreadPool::run,
+                                                            this))));
+    }
+}
+
+void
+ThreadPool::stop() {
+    {
+        Mutex::Locker locker(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        queue_.clear();
+        queued_ = 0;
+        work_cond_.broadcast();
+    }
+
+    for (std::vector<ThreadPtr>::const_iterator thread = threads_.begin();
+         thread != threads_.end(); ++thread) {
+        (*thread)->wait();
+    }
+    threads_.clear();
+}
+
+bool
+ThreadPool::add(const WorkItem& item) {
+    return (add(item, std::string()));
+}
+
+bool
+ThreadPool::add(const WorkItem& item, const std::string& key) {
+    Mutex::Locker locker(mutex_);
+    if (!running_ || (queued_ >= queue_size_)) {
+        return (false);
+    }
+    queue_.push_back(QueuedItem(item, key));
+    ++queued_;
+    work_cond_.signal();
+    return (true);
+}
+
+void
+ThreadPool::wait() {
+    Mutex::Locker locker(mutex_);
+    while (running_ && ((queued_ > 0) || (working_ > 0))) {
+        idle_cond_.wait(mutex_);
+    }
+}
+
+bool
+ThreadPool::isRunning() const {
+    Mutex::Locker locker(mutex_);
+    return (running_);
+}
+
+size_t
+ThreadPool::getThreadCount() const {
+    return (threads_.size());
+}
+
+size_t
+ThreadPool::getQueueSize() const {
+    return (queue_size_);
+}
+
+size_t
+ThreadPool::count() {
+    Mutex::Locker locker(mutex_);
+    return (queued_);
+}
+
+std::list<ThreadPool::QueuedItem>::iterator
+ThreadPool::findReady() {
+    std::list<QueuedItem>::iterator it = queue_.begin();
+    for (; it != queue_.end(); ++it) {
+        if (it->key_.empty() || (busy_keys_.count(it->key_) == 0)) {
+            break;
+        }
+    }
+    return (it);
+}
+
+void
+ThreadPool::run() {
+    for (;;) {
+        WorkItem item;
+        std::string key;
+        {
+            Mutex::Locker locker(mutex_);
+            std::list<QueuedItem>::iterator ready = queue_.end();
+            while (running_ && ((ready = findReady()) == queue_.end())) {
+                work_cond_.wait(mutex_);
+            }
+            if (!running_) {
+                // Wake up the producer if it is waiting for us to finish.
+                idle_cond_.broadcast();
+                return;
+            }
+            item = ready->item_;
+            key = ready->key_;
+            queue_.erase(ready);
+            --queued_;
+            ++working_;
+            if (!key.empty()) {
+                busy_keys_.insert(key);
+            }
+        }
+
+        try {
+            item();
+        } catch (...) {
+            // Work items are expected to handle their own errors. We don't
+            // want a misbehaving item to terminate the worker thread.
+        }
+
+        Mutex::Locker locker(mutex_);
+        --working_;
+        if (!key.empty()) {
+            busy_keys_.erase(key);
+            // Items waiting for this key may be executed now.
+            if (queued_ > 0) {
+                work_cond_.broadcast();
+            }
+        }
+        if ((queued_ == 0) && (working_ == 0)) {
+            idle_cond_.broadcast();
+        }
+    }
+}
+
+} // namespace thread
+} // namespace util
+} // namespace isc
@@ -0,0 +1,202 @@
+// Copyright (C) 2015 Internet Systems Consortium, Inc. ("ISC")
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+// OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef KEA_THREAD_POOL_H
+#define KEA_THREAD_POOL_H
+
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace util {
+namespace thread {
+
+/// \brief Pool of worker threads processing a bounded queue of work items.
+///
+/// The pool is used by the DHCP servers to process received packets on
+/// multiple threads. A single producer (typically the thread receiving
+/// packets) adds work items to the queue with \c add() and the worker
+/// threads execute them in the order in which they were added.
+///
+/// A work item may be added with a key. The items having the same key are
+/// never executed concurrently and they are executed in the order in which
+/// they were added. This is used by the DHCP servers to make sure that the
+/// packets sent by the same client are processed in order, while the packets
+/// from different clients are processed in parallel. The items added without
+/// a key (or with an empty key) are not ordered.
+///
+/// The queue is bounded. When it holds the maximum number of items the
+/// \c add() method refuses new items and returns false, so as the caller
+/// can drop the work (e.g. a DHCP packet which the client will retransmit)
+/// instead of blocking the producer or growing the queue without limit.
+///
+/// The work items must not throw. Any exception thrown by the work item
+/// is caught and ignored by the worker thread, so as the pool remains
+/// operational.
+class ThreadPool : boost::noncopyable {
+public:
+
+    /// \brief Type of the work item executed by the worker threads.
+    typedef boost::function<void()> WorkItem;
+
+    /// \brief Constructor.
+    ///
+    /// Creates the pool with no threads running. The \c start() method
+    /// must be called to start the worker threads.
+    ThreadPool();
+
+    /// \brief Destructor.
+    ///
+    /// Stops the worker threads, discarding all queued work items.
+    ~ThreadPool();
+
+    /// \brief Starts the worker threads.
+    ///
+    /// \param thread_count Number of worker threads to start.
+    /// \param queue_size Maximum number of work items waiting in the queue.
+    ///
+    /// \throw isc::InvalidOperation if the pool is already running.
+    /// \throw isc::BadValue if any of the parameters is 0.
+    void start(const size_t thread_count, const size_t queue_size);
+
+    /// \brief Stops the worker threads.
+    ///
+    /// Work items which are being executed when this method is called are
+    /// completed. Other queued work items are discarded. This method blocks
+    /// until all worker threads terminate. It is a no-op if the pool is
+    /// not running.
+    void stop();
+
+    /// \brief Adds a work item to the queue.
+    ///
+    /// \param item Work item to be executed by one of the worker threads.
+    ///
+    /// \return true if the item has been queued, false if the queue is full
+    /// or the pool is not running.
+    bool add(const WorkItem& item);
+
+    /// \brief Adds a work item with a key to the queue.
+    ///
+    /// The item is not executed until all items previously added with the
+    /// same key have completed.
+    ///
+    /// \param item Work item to be executed by one of the worker threads.
+    /// \param key Key used to order the work items. The item added with
+    /// an empty key is not ordered with respect to other items.
+    ///
+    /// \return true if the item has been queued, false if the queue is full
+    /// or the pool is not running.
+    bool add(const WorkItem& item, const std::string& key);
+
+    /// \brief Waits until the queue is empty and all workers are idle.
+    ///
+    /// This method is used to get a consistent state before the producer
+    /// modifies data used by the work items, e.g. server configuration.
+    /// The producer must not call \c add() concurrently with this method.
+    void wait();
+
+    /// \brief Checks if the worker threads are running.
+    bool isRunning() const;
+
+    /// \brief Returns number of worker threads.
+    size_t getThreadCount() const;
+
+    /// \brief Returns maximum number of queued work items.
+    size_t getQueueSize() const;
+
+    /// \brief Returns number of work items currently in the queue.
+    size_t count();
+
+private:
+
+    /// \brief Work item with the key used for ordering.
+    struct QueuedItem {
+        /// \brief Constructor.
+        ///
+        /// \param item Work item.
+        /// \param key Key used to order the work items.
+        QueuedItem(const WorkItem& item, const std::string& key)
+            : item_(item), key_(key) {
+        }
+
+        /// \brief Work item.
+        WorkItem item_;
+
+        /// \brief Key used to order the work items.
+        std::string key_;
+    };
+
+    /// \brief Main function of each worker thread.
+    void run();
+
+    /// \brief Returns the first item in the queue which may be executed.
+    ///
+    /// The item may be executed if no item with the same key is being
+    /// executed. This method must be called with the mutex locked.
+    ///
+    /// \return Iterator pointing to the item or the end of the queue if no
+    /// item may be executed.
+    std::list<QueuedItem>::iterator findReady();
+
+    /// \brief Pointer to the worker thread.
+    typedef boost::shared_ptr<Thread> ThreadPtr;
+
+    /// \brief Mutex protecting members below.
+    mutable Mutex mutex_;
+
+    /// \brief Condition variable signalled when work is available or the
+    /// pool is stopping.
+    CondVar work_cond_;
+
+    /// \brief Condition variable signalled when the pool becomes idle.
+    CondVar idle_cond_;
+
+    /// \brief Queued work items.
+    std::list<QueuedItem> queue_;
+
+    /// \brief Number of items in the queue.
+    ///
+    /// Held separately because std::list::size() is linear in C++98.
+    size_t queued_;
+
+    /// \brief Worker threads.
+    std::vector<ThreadPtr> threads_;
+
+    /// \brief Maximum number of queued work items.
+    size_t queue_size_;
+
+    /// \brief Number of work items being executed.
+    size_t working_;
+
+    /// \brief Keys of the work items being executed.
+    std::set<std::string> busy_keys_;
+
+    /// \brief Indicates if the worker threads should run.
+    bool running_;
+};
+
+} // namespace thread
+} // namespace util
+} // namespace isc
+
+#endif // KEA_THREAD_POOL_H
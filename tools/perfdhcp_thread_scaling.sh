@@ -0,0 +1,113 @@
+#!/bin/sh
+
+###########################################
+# This script measures how the performance of kea-dhcp4 scales with the
+# number of threads processing packets (the thread-pool-size parameter).
+#
+# For each tested number of threads the script starts kea-dhcp4 with a
+# configuration using the memfile backend (without persistence, so as
+# the disk is not the bottleneck) and runs perfdhcp against it, reporting
+# the achieved rate of DORA exchanges per second. A thread-pool-size of 0
+# means that packets are processed by the main thread.
+#
+# The script must be run as root, because both kea-dhcp4 and perfdhcp
+# open raw sockets. The server and perfdhcp are expected to run on two
+# ends of a veth pair (or two separate machines), because perfdhcp can't
+# talk to the server over the same interface.
+#
+# The behavior is controlled by the following variables:
+# * KEA_DHCP4 - path to the kea-dhcp4 binary (default: kea-dhcp4)
+# * PERFDHCP - path to the perfdhcp binary (default: perfdhcp)
+# * SERVER_IFACE - interface the server listens on (default: veth0)
+# * CLIENT_IFACE - interface perfdhcp sends from (default: veth1)
+# * SUBNET - subnet served by the server (default: 10.0.0.0/8)
+# * POOL - pool of addresses (default: 10.0.0.10 - 10.255.255.250)
+# * THREADS - list of thread pool sizes to test (default: "0 1 2 4 8")
+# * QUEUE_SIZE - value of the packet-queue-size (default: 256)
+# * RATE - rate of exchanges initiated by perfdhcp (default: 100000)
+# * CLIENTS - number of simulated clients (default: 100000)
+# * PERIOD - duration of each test in seconds (default: 30)
+###########################################
+
+KEA_DHCP4=${KEA_DHCP4:-kea-dhcp4}
+PERFDHCP=${PERFDHCP:-perfdhcp}
+SERVER_IFACE=${SERVER_IFACE:-veth0}
+CLIENT_IFACE=${CLIENT_IFACE:-veth1}
+SUBNET=${SUBNET:-10.0.0.0/8}
+POOL=${POOL:-"10.0.0.10 - 10.255.255.250"}
+THREADS=${THREADS:-"0 1 2 4 8"}
+QUEUE_SIZE=${QUEUE_SIZE:-256}
+RATE=${RATE:-100000}
+CLIENTS=${CLIENTS:-100000}
+PERIOD=${PERIOD:-30}
+
+WORKDIR=$(mktemp -d /tmp/perfdhcp_scaling.XXXXXX)
+CFG_FILE=${WORKDIR}/kea.conf
+LOG_FILE=${WORKDIR}/kea.log
+
+cleanup() {
+    if [ -n "${SERVER_PID}" ]; then
+        kill ${SERVER_PID} 2>/dev/null
+        wait ${SERVER_PID} 2>/dev/null
+    fi
+    rm -rf ${WORKDIR}
+}
+
+trap cleanup EXIT INT TERM
+
+# Writes the server configuration using the specified number of threads.
+write_config() {
+    cat > ${CFG_FILE} <<EOF
+{ "Dhcp4": {
+    "interfaces-config": { "interfaces": [ "${SERVER_IFACE}" ] },
+    "lease-database": { "type": "memfile", "persist": false },
+    "thread-pool-size": $1,
+    "packet-queue-size": ${QUEUE_SIZE},
+    "valid-lifetime": 4000,
+    "renew-timer": 1000,
+    "rebind-timer": 2000,
+    "subnet4": [ {
+        "subnet": "${SUBNET}",
+        "pools": [ { "pool": "${POOL}" } ],
+        "interface": "${SERVER_IFACE}"
+    } ]
+  },
+  "Logging": {
+    "loggers": [ {
+        "name": "kea-dhcp4",
+        "severity": "WARN",
+        "output_options": [ { "output": "${LOG_FILE}" } ]
+    } ]
+  }
+}
+EOF
+}
+
+printf "%8s %16s %12s\n" "threads" "exchanges/sec" "drops"
+
+for threads in ${THREADS}; do
+    write_config ${threads}
+
+    ${KEA_DHCP4} -c ${CFG_FILE} &
+    SERVER_PID=$!
+    # Give the server some time to open sockets.
+    sleep 2
+
+    if ! kill -0 ${SERVER_PID} 2>/dev/null; then
+        echo "kea-dhcp4 failed to start, see ${LOG_FILE}"
+        exit 1
+    fi
+
+    output=$(${PERFDHCP} -4 -l ${CLIENT_IFACE} -r ${RATE} -R ${CLIENTS} \
+             -p ${PERIOD} 2>&1)
+
+    rate=$(echo "${output}" | sed -n 's/^Rate: \([0-9.]*\).*/\1/p')
+    drops=$(echo "${output}" | sed -n 's/^drops: \([0-9]*\)/\1/p' | \
+            awk '{ sum += $1 } END { print sum }')
+
+    printf "%8s %16s %12s\n" ${threads} ${rate:-n/a} ${drops:-n/a}
+
+    kill ${SERVER_PID}
+    wait ${SERVER_PID} 2>/dev/null
+    SERVER_PID=
+done